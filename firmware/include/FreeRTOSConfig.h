@@ -72,14 +72,21 @@
 #define configAPPLICATION_ALLOCATED_HEAP        0
 
 /* Hook function related definitions. */
-#define configUSE_IDLE_HOOK                     0
+#define configUSE_IDLE_HOOK                     1 /* see vApplicationIdleHook() in wdog.c */
 #define configUSE_TICK_HOOK                     0
-#define configCHECK_FOR_STACK_OVERFLOW          0
+#define configCHECK_FOR_STACK_OVERFLOW          2 /* see vApplicationStackOverflowHook() in wdog.c */
 #define configUSE_MALLOC_FAILED_HOOK            0
 #define configUSE_DAEMON_TASK_STARTUP_HOOK      0
 
 /* Run time and task stats gathering related definitions. */
-#define configGENERATE_RUN_TIME_STATS           0
+#define configGENERATE_RUN_TIME_STATS           1
+#if defined(__ICCARM__)||defined(__CC_ARM)||defined(__GNUC__)
+    /* Run time counter, derived from the DWT cycle counter (see wdog.c) */
+    extern void watchdogRunTimeCounterInit(void);
+    extern uint32_t watchdogGetRunTimeCounter(void);
+#endif
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() watchdogRunTimeCounterInit()
+#define portGET_RUN_TIME_COUNTER_VALUE()         watchdogGetRunTimeCounter()
 #define configUSE_TRACE_FACILITY                1
 #define configUSE_STATS_FORMATTING_FUNCTIONS    0
 
@@ -105,7 +112,7 @@
 #define INCLUDE_vTaskDelay                      1
 #define INCLUDE_xTaskGetSchedulerState          1
 #define INCLUDE_xTaskGetCurrentTaskHandle       1
-#define INCLUDE_uxTaskGetStackHighWaterMark     0
+#define INCLUDE_uxTaskGetStackHighWaterMark     1
 #define INCLUDE_xTaskGetIdleTaskHandle          0
 #define INCLUDE_eTaskGetState                   0
 #define INCLUDE_xTimerPendFunctionCall          1
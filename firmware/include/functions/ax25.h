@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2024 Roger Clark, VK3KYY / G4KYF
+ *                    Daniel Caujolle-Bert, F1RMB
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+ *    in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. Use of this source code or binary releases for commercial purposes is strictly forbidden. This includes, without limitation,
+ *    incorporation in a commercial product or incorporation into a product or project which allows commercial use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef _OPENGD77_AX25_H_
+#define _OPENGD77_AX25_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define AX25_PACKET_BUFFER_SIZE        256U
+#define AX25_PACKET_BUFFER_BITS        (AX25_PACKET_BUFFER_SIZE * 8U)
+#define AX25_FRAME_BUFFER_SIZE         128U
+
+// The frame octets are queued first, then turned into the keyed tone bitmap in one go (see ax25EncodeFrame()).
+typedef struct
+{
+	uint32_t                     packetBuffer[AX25_PACKET_BUFFER_SIZE / sizeof(uint32_t)]; // NRZI tone bitmap, LSB first
+	uint16_t                     packetBufferBitPosition;
+	uint8_t                      frameBuffer[AX25_FRAME_BUFFER_SIZE]; // address, control, PID, info and FCS octets
+	uint16_t                     frameLength;
+	bool                         baudIs300;
+} AX25Encoder_t;
+
+void ax25EncoderReset(AX25Encoder_t *encoderData);
+void ax25EnqueueChar(AX25Encoder_t *encoderData, uint8_t data);
+void ax25EnqueuePadOfLength(AX25Encoder_t *encoderData, uint32_t len);
+void ax25EnqueueString(AX25Encoder_t *encoderData, const char *str);
+uint32_t ax25EncodeFrame(AX25Encoder_t *encoderData, uint8_t leadingFlags, uint8_t trailingFlags);
+
+#endif /* _OPENGD77_AX25_H_ */
@@ -403,6 +403,9 @@ void codeplugGetBootScreenData(char *line1, char *line2, uint8_t *displayType);
 void codeplugGetVFO_ChannelData(struct_codeplugChannel_t *vfoBuf, Channel_t VFONumber);
 void codeplugSetVFO_ChannelData(struct_codeplugChannel_t *vfoBuf, Channel_t VFONumber);
 bool codeplugAllChannelsIndexIsInUse(int index);
+uint32_t codeplugChannelsGetRevision(void);
+int codeplugAllChannelsGetNextInUse(int index);
+int codeplugAllChannelsGetPreviousInUse(int index);
 void codeplugAllChannelsIndexSetUsed(int index);
 bool codeplugChannelSaveDataForIndex(int index, struct_codeplugChannel_t *channelBuf);
 CodeplugCSSTypes_t codeplugGetCSSType(uint16_t tone);
@@ -424,6 +427,7 @@ bool codeplugGetOpenGD77CustomData(codeplugCustomDataType_t dataType, uint8_t *d
 bool codeplugSetOpenGD77CustomData(codeplugCustomDataType_t dataType, uint8_t *dataBuf, int len);
 
 void codeplugAllChannelsInitCache(void);
+void codeplugInitContactsCache(void);
 void codeplugInitCaches(void);
 
 bool codeplugContactsContainsPC(uint32_t pc);
@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2024 Roger Clark, VK3KYY / G4KYF
+ *                    Daniel Caujolle-Bert, F1RMB
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+ *    in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. Use of this source code or binary releases for commercial purposes is strictly forbidden. This includes, without limitation,
+ *    incorporation in a commercial product or incorporation into a product or project which allows commercial use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef _OPENGD77_DMRDATA_H_
+#define _OPENGD77_DMRDATA_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define DMR_DATA_HEADER_LENGTH            12U
+#define DMR_DATA_RATE_12_BLOCK_LENGTH     12U
+#define DMR_DATA_RATE_34_BLOCK_LENGTH     18U
+#define DMR_DATA_MESSAGE_MAX_BLOCKS       16U
+#define DMR_DATA_MESSAGE_MAX_LENGTH      (DMR_DATA_MESSAGE_MAX_BLOCKS * DMR_DATA_RATE_34_BLOCK_LENGTH)
+
+#define DMR_DATA_SAP_IP                   0x04U
+
+typedef enum
+{
+	DMR_DATA_RESULT_ERROR = 0,
+	DMR_DATA_RESULT_IN_PROGRESS,
+	DMR_DATA_RESULT_MESSAGE_COMPLETE
+} dmrDataResult_t;
+
+typedef struct
+{
+	uint32_t srcId;
+	uint32_t dstId;
+	bool     isGroup;
+	uint8_t  format;  // Data Packet Format, from the data header
+	uint8_t  SAP;     // Service Access Point
+	uint16_t length;  // user data length, without padding and CRC
+	uint8_t  data[DMR_DATA_MESSAGE_MAX_LENGTH];
+} dmrDataMessage_t;
+
+uint8_t dmrDataTrellisDecode(const uint8_t *frame, uint8_t *payload);
+void dmrDataReset(void);
+dmrDataResult_t dmrDataAddHeader(const uint8_t *header);
+dmrDataResult_t dmrDataAddBlock(const uint8_t *block, uint8_t blockLength);
+const dmrDataMessage_t *dmrDataGetMessage(void);
+void dmrDataGetMessageText(const dmrDataMessage_t *message, char *text, size_t textSize);
+
+#endif /* _OPENGD77_DMRDATA_H_ */
@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2024 Roger Clark, VK3KYY / G4KYF
+ *                    Daniel Caujolle-Bert, F1RMB
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+ *    in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. Use of this source code or binary releases for commercial purposes is strictly forbidden. This includes, without limitation,
+ *    incorporation in a commercial product or incorporation into a product or project which allows commercial use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef _OPENGD77_DMRFEC_H_
+#define _OPENGD77_DMRFEC_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define DMR_FEC_BPTC19696_PAYLOAD_LENGTH    12U
+#define DMR_FEC_EMBEDDED_DATA_RAW_LENGTH    16U
+#define DMR_FEC_EMBEDDED_DATA_LC_LENGTH     9U
+
+void dmrFECBPTC19696Decode(const uint8_t *inputData, uint8_t *outputData);
+void dmrFECBPTC19696Encode(const uint8_t *inputData, uint8_t *outputData);
+bool dmrFECEmbeddedDataDecode(const uint8_t *rawData, uint8_t *lcData);
+void dmrFECEmbeddedDataEncode(const uint8_t *lcData, uint8_t *rawData);
+bool dmrFECHamming15113Decode(uint16_t *codeword);
+bool dmrFECHamming16114Decode(uint16_t *codeword);
+uint16_t dmrFECHammingEncode(uint16_t codeword, bool is16114);
+
+#endif /* _OPENGD77_DMRFEC_H_ */
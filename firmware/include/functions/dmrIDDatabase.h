@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2024 Roger Clark, VK3KYY / G4KYF
+ *                    Daniel Caujolle-Bert, F1RMB
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+ *    in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. Use of this source code or binary releases for commercial purposes is strictly forbidden. This includes, without limitation,
+ *    incorporation in a commercial product or incorporation into a product or project which allows commercial use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef _OPENGD77_DMRIDDATABASE_H_
+#define _OPENGD77_DMRIDDATABASE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "user_interface/uiGlobals.h"
+
+typedef struct
+{
+	uint32_t			entries;
+	uint8_t				contactLength;
+	uint32_t			samples[DMRID_INDEX_SAMPLES]; // IDs of the records at positions (n * IDsPerSample)
+	uint32_t			numSamples;
+	uint32_t			IDsPerSample;
+	uint32_t			lastID; // max available ID
+} dmrIDsCache_t;
+
+typedef struct
+{
+	uint32_t			targetId; // 0: unused entry
+	uint32_t			lastUse;
+	bool				found;
+	dmrIdDataStruct_t	record; // Only when found
+} dmrIDsLRUEntry_t;
+
+
+void dmrIDCacheInit(void);
+void dmrIDCacheClear(void);
+uint32_t dmrIDCacheGetCount(void);
+void dmrIDCacheGetLRUStats(uint32_t *hits, uint32_t *misses);
+bool dmrIDLookup(uint32_t targetId, dmrIdDataStruct_t *foundRecord);
+
+#endif /* _OPENGD77_DMRIDDATABASE_H_ */
@@ -34,8 +34,13 @@
 #define DMR_FRAME_LENGTH_BYTES  33U
 #define DT_VOICE_LC_HEADER  	0x01U
 #define DT_TERMINATOR_WITH_LC 	0x02U
+#define DT_DATA_HEADER          0x06U
+#define DT_RATE_12_DATA         0x07U
+#define DT_RATE_34_DATA         0x08U
 #define DMR_SYNC_DATA           0x40U
 
+#define HOTSPOT_DATA_MESSAGE_TEXT_LENGTH   16U
+
 #define HOTSPOT_VERSION_STRING "OpenGD77_HS v0.1.18"
 
 typedef struct
@@ -153,6 +158,8 @@ void mmdvmSendDebug5(const char *text, int16_t n1, int16_t n2, int16_t n3, int16
 #endif
 
 void hotspotRxFrameHandler(uint8_t *frameBuf);
+void hotspotPeekNetFrame(uint8_t *frameBuf);
+bool hotspotGetNetFrame(uint8_t *frameBuf);
 
 void cwProcess(void);
 void cwReset(void);
@@ -174,4 +181,6 @@ extern uint32_t hotspotFreqTx;
 extern volatile MMDVM_STATE hotspotModemState;
 extern uint8_t hotspotPowerLevel;
 extern bool hotspotMmdvmHostIsConnected;
+extern bool hotspotDataMessagePending;
+extern char hotspotDataMessageText[HOTSPOT_DATA_MESSAGE_TEXT_LENGTH];
 #endif
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2024 Roger Clark, VK3KYY / G4KYF
+ *                    Daniel Caujolle-Bert, F1RMB
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+ *    in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. Use of this source code or binary releases for commercial purposes is strictly forbidden. This includes, without limitation,
+ *    incorporation in a commercial product or incorporation into a product or project which allows commercial use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef _OPENGD77_NMEA_H_
+#define _OPENGD77_NMEA_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define NMEA_LINE_LENGTH         81U // NMEA specs is 82 max length, including <CR><LF>, but we need an extra NULL terminator
+#define NMEA_FIELDS_MAX          24U // GSV: header, 3 counters, 4 satellites of 4 fields, signal ID
+
+// Sentence, tokenized while it's received (see nmeaParserProcessChar()).
+// Field N spans from fieldStart[N] to the delimiter (',' or '*') at fieldStart[N + 1] - 1.
+typedef struct
+{
+	char     line[NMEA_LINE_LENGTH]; // As received, from '$' to the checksum, NULL terminated
+	uint8_t  length;
+	uint8_t  fieldsCount;
+	uint8_t  fieldStart[NMEA_FIELDS_MAX + 1];
+	uint16_t hash; // Fletcher-16 of the line, used to drop repeated lines
+	bool     isValid; // "*hh" checksum verified
+} nmeaSentence_t;
+
+typedef enum
+{
+	NMEA_PARSER_STATE_WAIT_START = 0, // Everything is ignored up to the next '$'
+	NMEA_PARSER_STATE_FIELDS,
+	NMEA_PARSER_STATE_CHECKSUM_HIGH,
+	NMEA_PARSER_STATE_CHECKSUM_LOW,
+	NMEA_PARSER_STATE_CHECKSUM_DONE,
+	NMEA_PARSER_STATE_INVALID // Kept up to the end of the line, but won't be valid
+} nmeaParserState_t;
+
+typedef struct
+{
+	nmeaParserState_t state;
+	uint8_t           checksum;
+	uint8_t           receivedChecksum;
+	uint32_t          hashSum0;
+	uint32_t          hashSum1;
+} nmeaParser_t;
+
+void nmeaParserReset(nmeaParser_t *parser);
+bool nmeaParserProcessChar(nmeaParser_t *parser, nmeaSentence_t *sentence, uint8_t rxchar);
+const char *nmeaGetField(const nmeaSentence_t *sentence, uint8_t field);
+uint8_t nmeaGetFieldLength(const nmeaSentence_t *sentence, uint8_t field);
+bool nmeaGetFieldFixedPoint(const nmeaSentence_t *sentence, uint8_t field, uint8_t decimals, int32_t *value);
+
+#endif /* _OPENGD77_NMEA_H_ */
@@ -78,22 +78,28 @@ typedef struct
     bool 			found;
     int 			iterations;
     int 			totalIterations;
-    bool 			foundStart;
-    int 			direction;
+    bool 			foundStart;		// the horizon crossing is bracketed
+    int 			direction;		// side of the bracket which has been moved by the last refinement
+    time_t_custom	beforeDateTimeSecs;	// bracket of the horizon crossing, last sample before it
+    float			beforeElevation;
+    time_t_custom	afterDateTimeSecs;	// and first sample after it
+    float			afterElevation;
     satellitePreductionState_t state;
 } predictionStateMachineData_t;
 
 typedef struct
 {
-	float 		DE;
+	int32_t		DE;		// Epoch day number
 	float		TE_FloatPart;		// Epoch time (days)
 	float		SI;		// Sin Inclination (deg)
 	float		CI;		// Cos Inclination (deg)
 	float		RA;		// R.A.A.N (deg)
 	float		EC;		// Eccentricity
 	float		WP;		// Arg perifee (deg)
-	float		MA;		// Mean anomaly (rev/d)
-	float		MM;		// Mean motion (rev/d)
+	float		MA;		// Mean anomaly at epoch (rev)
+	float		MM;		// Mean motion (rad/d)
+	float		MMRevsHigh;	// Mean motion (rev/d) rounded to 1/512, its product by a whole number of days is exact
+	float		MMRevsLow;	// Mean motion (rev/d) remainder
 	float 		N0; 	// MM / 86400.0;			// Mean motion rads/s
 	float		A0;		// pow(currentSatelliteData_GM / kepData->N0 / kepData->N0, 1.0 / 3.0);	// Semi major axis km
 	float		b0;		// Semi minor axis (km)
@@ -103,10 +109,22 @@ typedef struct
 	float		QD;		// Node precession rate, rad/day
 	float		WD;		// Perigee precession rate, rad/day
 	float		DC;		// Drag coeff. (Angular momentum rate)/(Ang mom)  s^-1
-	float		GHAE;		// GHA Aries, epoch
+	float		ER;		// Maximum elevation rate while below the horizon (rad/s)
 
 } satelliteKeps_t;
 
+typedef struct
+{
+	float		planeT;		// Elapsed time since epoch (days) the plane transformation was computed for
+	float		CXx;		// Plane -> celestial coordinate transformation
+	float		CXy;
+	float		CYx;
+	float		CYy;
+	float		CZx;
+	float		CZy;
+	float		keplerOffset;	// EA - M of the last Kepler solution, seeds the next one
+} satellitePropagatorCache_t;
+
 
 typedef struct
 {
@@ -127,6 +145,7 @@ typedef struct
 {
 	char 				name[17];
 	satelliteKeps_t 	keps;
+	satellitePropagatorCache_t propagatorCache;
 	satellite_txRxFreqs freqs[3];
     char 				AdditionalData[ADDITION_DATA_SIZE];
     satellitePredictions_t predictions;
@@ -202,7 +221,7 @@ extern satelliteFreq_t currentSatelliteFreqIndex;
 
 void satelliteSetObserverLocation(float lat,float lon,int height);
 void satelliteTLE2Native(const char *satelliteName,const uint8_t *kep1,const uint8_t *kep2,satelliteData_t *kepDataOut);
-void satelliteCalculateForDateTimeSecs(const satelliteData_t *satelliteData, time_t_custom dateTimeSecs, satelliteResults_t *currentSatelliteData, satellitePredictionLevel_t predictionLevel);
-bool satellitePredictNextPassFromDateTimeSecs(predictionStateMachineData_t *stateData, const satelliteData_t *satelliteData, time_t_custom startDateTimeSecs, time_t_custom limitDateTimeSecs, int maxIterations, satellitePass_t *nextPass);
+void satelliteCalculateForDateTimeSecs(satelliteData_t *satelliteData, time_t_custom dateTimeSecs, satelliteResults_t *currentSatelliteData, satellitePredictionLevel_t predictionLevel);
+bool satellitePredictNextPassFromDateTimeSecs(predictionStateMachineData_t *stateData, satelliteData_t *satelliteData, time_t_custom startDateTimeSecs, time_t_custom limitDateTimeSecs, int maxIterations, satellitePass_t *nextPass);
 uint16_t satelliteGetMaximumElevation(satelliteData_t *satelliteData, uint32_t passNumber);
 #endif
@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2024 Roger Clark, VK3KYY / G4KYF
+ *                    Daniel Caujolle-Bert, F1RMB
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+ *    in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. Use of this source code or binary releases for commercial purposes is strictly forbidden. This includes, without limitation,
+ *    incorporation in a commercial product or incorporation into a product or project which allows commercial use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef _OPENGD77_SCAN_TABLE_H_
+#define _OPENGD77_SCAN_TABLE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "functions/codeplug.h"
+
+// What the receiver needs to listen on a channel, so a scan hop doesn't have to read the channel record
+typedef struct
+{
+	uint32_t rxFreq;
+	uint16_t rxTone;
+	uint16_t index;      // Codeplug channel index
+	uint8_t  chMode;
+	uint8_t  colourCode;
+	uint8_t  sql;
+	uint8_t  flags;      // SCAN_TABLE_FLAG_xxx
+} scanTableEntry_t;
+
+#define SCAN_TABLE_SIZE                  80 // Largest zone, the All Channels zone is scanned through a window of that size
+
+#define SCAN_TABLE_FLAG_SKIP             0x01 // Zone (or All Channels) skip flag set
+#define SCAN_TABLE_FLAG_NUISANCE         0x02 // Nuisance deleted, until the scan is restarted
+#define SCAN_TABLE_FLAG_BW_25K           0x04
+#define SCAN_TABLE_FLAG_TIMESLOT_TWO     0x08
+#define SCAN_TABLE_FLAG_DMO              0x10 // Simplex or forced DMO
+#define SCAN_TABLE_FLAG_NEEDS_RECORD     0x20 // Can't be tuned from the entry, the channel record has to be read on each hop
+
+void scanTableSetEntry(scanTableEntry_t *entry, uint16_t index, struct_codeplugChannel_t *channel, bool skip);
+int scanTableFindIndex(const scanTableEntry_t *table, int count, uint16_t index);
+int scanTableFindNext(const scanTableEntry_t *table, int count, int position, int direction, bool wrap);
+void scanTableSetNuisance(scanTableEntry_t *table, int count, uint16_t index);
+
+#endif /* _OPENGD77_SCAN_TABLE_H_ */
@@ -36,6 +36,10 @@
 #include <task.h>
 
 typedef void (*timerCallback_t)(void);
+// Identifies one scheduled callback: slot number + 1 in the low byte, schedule sequence number in the upper bits
+typedef uint32_t timerCallbackHandle_t;
+#define TIMER_CALLBACK_INVALID_HANDLE   0U
+#define TIMER_CALLBACK_HANDLE(slot, sequence) ((((uint32_t)(sequence)) << 8) | ((uint32_t)(slot) + 1U))
 
 typedef struct
 {
@@ -46,7 +50,9 @@ typedef struct
 extern uint32_t ticksGetMillis(void);
 
 bool addTimerCallback(timerCallback_t funPtr, uint32_t delayIn_mS, int menuDest, bool updateExistingCallbackTime);
+timerCallbackHandle_t addTimerCallbackWithHandle(timerCallback_t funPtr, uint32_t delayIn_mS, int menuDest, bool updateExistingCallbackTime);
 bool cancelTimerCallback(timerCallback_t funPtr, int menuDest);
+bool cancelTimerCallbackByHandle(timerCallbackHandle_t handle);
 void handleTimerCallbacks(void);
 
 void ticksTimerReset(ticksTimer_t *timer);
@@ -33,13 +33,57 @@
 #include <task.h>
 
 
+// Also used as the write-back sector cache. Reading into it with SPI_Flash_read() writes back and releases the cached sector,
+// so it can then be used as a scratch buffer.
 extern uint8_t SPI_Flash_sectorbuffer[4096];
 extern uint32_t flashChipPartNumber;
 
+// Reads priority, the queued reads are served highest priority first
+typedef enum
+{
+	SPI_FLASH_PRIORITY_VOICE = 0,// Voice prompts AMBE data
+	SPI_FLASH_PRIORITY_UI,// Lookups (DMR IDs, contacts, channels...)
+	SPI_FLASH_PRIORITY_BULK,// CPS and other large transfers
+	SPI_FLASH_PRIORITY_MAX
+} spiFlashPriority_t;
+
+typedef enum
+{
+	SPI_FLASH_REQUEST_IDLE = 0,
+	SPI_FLASH_REQUEST_PENDING,
+	SPI_FLASH_REQUEST_COMPLETED,
+	SPI_FLASH_REQUEST_FAILED// Cancelled
+} spiFlashRequestState_t;
+
+typedef struct spiFlashReadRequest spiFlashReadRequest_t;
+typedef void (*spiFlashReadCallback_t)(spiFlashReadRequest_t *request);
+
+// Asynchronous read, the request and its buffer have to stay valid while its state is SPI_FLASH_REQUEST_PENDING.
+// The callback and the task notification happen in the context of the task which performed the read.
+struct spiFlashReadRequest
+{
+	uint32_t                        address;
+	uint8_t                        *buffer;
+	int                             size;
+	spiFlashPriority_t              priority;
+	spiFlashReadCallback_t          callback;// Optional
+	TaskHandle_t                    notifyTask;// Optional, notified with xTaskNotifyGive()
+	void                           *userData;
+	volatile spiFlashRequestState_t state;
+	// Private
+	int                             position;
+	spiFlashReadRequest_t          *next;
+};
+
 // Public functions
 bool SPI_Flash_init(void);
 bool SPI_Flash_read(uint32_t addrress,uint8_t *buf,int size);
-bool SPI_Flash_write(uint32_t addr, uint8_t *dataBuf, int size);
+bool SPI_Flash_readWithPriority(uint32_t addr, uint8_t *dataBuf, int size, spiFlashPriority_t priority);
+bool SPI_Flash_readAsync(spiFlashReadRequest_t *request);
+bool SPI_Flash_readCancel(spiFlashReadRequest_t *request);
+bool SPI_Flash_write(uint32_t addr, uint8_t *dataBuf, int size);// Cached, see SPI_Flash_flush()
+bool SPI_Flash_flush(void);// Write back the cached sector now
+void SPI_Flash_flushIfNeeded(bool immediately);// Write back the cached sector if it has been left untouched for a while
 bool SPI_Flash_writePage(uint32_t address,uint8_t *dataBuf);// page is 256 bytes
 bool SPI_Flash_eraseSector(uint32_t address);// sector is 16 pages  = 4k bytes
 uint8_t SPI_Flash_readManufacturer(void);// Not necessarily Winbond !
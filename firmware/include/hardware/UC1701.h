@@ -157,6 +157,10 @@ void displayClearRows(int16_t startRow, int16_t endRow, bool isInverted);
 void displayRenderWithoutNotification(void);
 void displayRender(void);
 void displayRenderRows(int16_t startRow, int16_t endRow);
+// The next render sends the whole screen
+void displayMarkAllDirty(void);
+// Low level LCD transfer, sends [startColumns[row], endColumns[row]) of each row (whole rows when the column arrays are NULL)
+void displayTransferRows(const uint8_t *buffer, int16_t startRow, int16_t endRow, const uint8_t *startColumns, const uint8_t *endColumns);
 void displayPrintCentered(uint16_t y, const char *text, ucFont_t fontSize);
 void displayPrintAt(uint16_t x, uint16_t y,const  char *text, ucFont_t fontSize);
 int displayPrintCore(int16_t x, int16_t y, const char *szMsg, ucFont_t fontSize, ucTextAlign_t alignment, bool isInverted);
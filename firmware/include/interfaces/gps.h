@@ -31,7 +31,6 @@
 
 #if defined(HAS_GPS)
 
-#define GPS_LINE_LENGTH         81U // NMEA specs is 82 max length, including <CR><LF>, but we need an extra NULL terminator
 #define GPS_DMA_BUFFER_SIZE     64U
 #define GPS_STORAGE_MAX         32U
 
@@ -34,9 +34,6 @@
 
 #include "fsl_pit.h"
 
-extern volatile uint32_t timer_maintask;
-extern volatile uint32_t timer_beeptask;
-extern volatile uint32_t timer_hrc6000task;
 extern volatile uint32_t timer_keypad;
 extern volatile uint32_t timer_keypad_timeout;
 extern volatile uint32_t PITCounter;
@@ -40,6 +40,8 @@ typedef struct
 	TaskHandle_t   Handle;
 	volatile bool  Running; // Not Suspended
 	volatile uint8_t  AliveCount;
+	uint32_t          Wakeups; // Returns from the task's blocking wait, for the telemetry
+	uint32_t          NotifiedWakeups; // Those which weren't a timeout
 } Task_t;
 
 
@@ -50,4 +52,38 @@ void watchdogRebootNow(void);
 void watchdogTick(void);
 uint32_t GetTimerOutputValue(void);
 
+void watchdogRunTimeCounterInit(void);
+uint32_t watchdogGetRunTimeCounter(void);
+uint32_t watchdogGetTelemetry(uint8_t *buffer, uint32_t bufferSize);
+
+// Optional interrupts latency profiler (build with USING_LATENCY_PROFILER defined):
+// measures, with the DWT cycle counter, how long each site keeps the interrupts (or one of them) masked, or runs for an ISR.
+#if defined(USING_LATENCY_PROFILER)
+typedef enum // tools/telemetry has the sites names, in the same order
+{
+	PROFILER_SITE_SPI_FLASH_READ = 0,
+	PROFILER_SITE_SPI_FLASH_WRITE,
+	PROFILER_SITE_SPI_FLASH_ERASE,
+	PROFILER_SITE_DISPLAY_TRANSFER,
+	PROFILER_SITE_HRC6000_PORTC_DISABLED,
+	PROFILER_SITE_HRC6000_RX_AUDIO,
+	PROFILER_SITE_HOTSPOT_STORE_NET_FRAME,
+	PROFILER_SITE_PORTC_IRQ,
+	PROFILER_SITE_FTM1_IRQ,
+	PROFILER_SITE_PIT0_IRQ,
+	PROFILER_SITE_ADC0_IRQ,
+	PROFILER_SITE_MAX
+} profilerSite_t;
+
+void profilerEnter(profilerSite_t site);
+void profilerExit(profilerSite_t site);
+uint32_t profilerGetDump(uint8_t *buffer, uint32_t bufferSize, bool reset);
+
+#define PROFILER_ENTER(site) profilerEnter(site)
+#define PROFILER_EXIT(site)  profilerExit(site)
+#else
+#define PROFILER_ENTER(site) do {} while (0)
+#define PROFILER_EXIT(site)  do {} while (0)
+#endif
+
 #endif /* _OPENGD77_WDOG_H_ */
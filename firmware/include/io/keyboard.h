@@ -98,7 +98,7 @@
 #define EVENT_KEY_NONE   0
 #define EVENT_KEY_CHANGE 1
 
-#define KEY_DEBOUNCE_COUNTER   20
+#define KEY_DEBOUNCE_TIME      20 // ms, whatever the keyboard scanning rate
 
 #if defined(PLATFORM_MD380) || defined(PLATFORM_MDUV380) || defined(PLATFORM_RT84_DM1701) || defined(PLATFORM_MD2017)
 #if defined(PLATFORM_RT84_DM1701) || defined(PLATFORM_MD2017)
@@ -150,5 +150,6 @@ bool keyboardKeyIsDTMFKey(char key);
 uint32_t keyboardRead(void);
 void keyboardCheckKeyEvent(keyboardCode_t *keys, int *event);
 bool keyboardScanKey(uint32_t scancode, char *keycode);
+bool keyboardIsIdle(void);
 
 #endif /* _OPENGD77_KEYBOARD_H_ */
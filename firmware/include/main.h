@@ -88,6 +88,8 @@ extern ticksTimer_t apoTimer;
 #endif
 
 void mainTaskInit(void);
+void mainTaskWakeUp(void);
+void mainTaskWakeUpFromISR(void);
 void powerOffFinalStage(bool maintainRTC, bool forceSuspend);
 bool batteryIsLowWarning(void);
 
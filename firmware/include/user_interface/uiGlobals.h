@@ -59,6 +59,7 @@ typedef uint32_t time_t_custom;     /* date/time in unix secs past 1-Jan-70 */
 
 #define MAX_ZONE_SCAN_NUISANCE_CHANNELS       16
 #define NUM_LASTHEARD_STORED                  32
+#define LASTHEARD_HASH_BUCKETS                32 // Power of two
 
 #if defined(PLATFORM_RD5R)
 #define DISPLAY_H_EXTRA_PIXELS                 0
@@ -246,8 +247,9 @@ typedef uint32_t time_t_custom;     /* date/time in unix secs past 1-Jan-70 */
 
 #define FREQ_ENTER_DIGITS_MAX                 12
 
-#define MIN_ENTRIES_BEFORE_USING_SLICES       40 // Minimal number of available IDs before using slices stuff
-#define ID_SLICES                             14 // Number of slices in whole DMRIDs DB
+#define DMRID_INDEX_SAMPLES                  256 // Number of IDs, evenly spaced in the DMRIDs DB, kept in RAM
+#define DMRID_LOOKUP_WINDOW_SIZE              64 // Size, in bytes, under which the remaining range of records is read at once while searching the DMRIDs DB
+#define DMRID_LRU_SIZE                         8 // Number of recently looked up DMRIDs kept in RAM
 
 #define TIMESLOT_DURATION                     30
 
@@ -404,6 +406,7 @@ typedef struct LinkItem
     uint8_t				dmrMode;
     uint16_t			rxAGCGain;
     struct LinkItem 	*next;
+    struct LinkItem 	*hashNext;// next item in the same lastHeard hash bucket
 } LinkItem_t;
 
 // MessageBox
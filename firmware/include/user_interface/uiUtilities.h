@@ -32,6 +32,7 @@
 #include "user_interface/uiGlobals.h"
 #include "user_interface/menuSystem.h"
 #include "functions/settings.h"
+#include "functions/dmrIDDatabase.h"
 
 
 #define COMPUTE_BUILD_YEAR \
@@ -172,14 +173,6 @@ typedef enum
 	DISPLAY_INFO_ZONE
 } displayInformation_t;
 
-typedef struct
-{
-	uint32_t			entries;
-	uint8_t				contactLength;
-	uint32_t			slices[ID_SLICES]; // [0] is min availabel ID, [ID_SLICES - 1] is max available ID
-	uint32_t			IDsPerSlice;
-} dmrIDsCache_t;
-
 
 #define TS_NO_OVERRIDE  0
 void tsSetManualOverride(Channel_t chan, int8_t ts);
@@ -195,15 +188,10 @@ bool isQSODataAvailableForCurrentTalker(void);
 //int alignFrequencyToStep(int freq, int step);
 char *chomp(char *str);
 int32_t getFirstSpacePos(char *str);
-void dmrIDCacheInit(void);
-void dmrIDCacheClear(void);
-uint32_t dmrIDCacheGetCount(void);
-bool dmrIDLookup(uint32_t targetId, dmrIdDataStruct_t *foundRecord);
 bool contactIDLookup(uint32_t id, uint32_t calltype, char *buffer);
 void uiUtilityRenderQSOData(void);
 void uiUtilityRenderHeader(bool isVFODualWatchScanning, bool isVFOSweepScanning);
 void uiUtilityRedrawHeaderOnly(bool isVFODualWatchScanning, bool isVFOSweepScanning);
-LinkItem_t *lastHeardFindInList(uint32_t id);
 void lastHeardInitList(void);
 void lastHeardClearWorkingTAData(void);
 bool lastHeardListUpdate(uint8_t *dmrDataBuffer, bool forceOnHotspot);
@@ -44,6 +44,7 @@
 #endif
 #endif // CPU_MK22FN512VLL12
 #include "functions/aprs.h"
+#include "functions/ax25.h"
 #include "hardware/HR-C6000.h"
 #include "functions/satellite.h"
 #if defined(HAS_GPS)
@@ -60,7 +61,6 @@
 #endif
 
 
-#define AX25_PACKET_BUFFER_SIZE        256U
 #define SMART_BEACONING_SPEED_MIN       54U // more than 1km/h (0.5399568034557235 kn == 1km/h)
 #define APRS_DESTINATION            "APOG77" // MAX 6 char (excluding terminator)
 #define APRS_CONFIG_SATELLITE            0U
@@ -166,16 +166,6 @@ double round(double x)
 }
 #endif
 
-typedef struct
-{
-	uint8_t                      packetBuffer[AX25_PACKET_BUFFER_SIZE];
-	uint16_t                     packetBufferBitPosition;
-	uint16_t                     bitStuffingCounter;
-	uint16_t                     crc;
-	bool                         currentBitNRZI;
-	bool                         baudIs300;
-} AX25Encoder_t;
-
 // Beaconing
 
 typedef struct
@@ -261,11 +251,10 @@ aprsBeaconingData_t aprsBcnData =
 const uint16_t initialIntervalsInSecs[APRS_BEACON_INITIAL_INTERVAL_MAX + 1] = { 12, 30, 60, 120, 180, 300, 600, 1200, 1800, 3600 };
 
 static char myCall[16];
-static int lenBytes = 0;
+static int lenBits = 0;
 static volatile uint32_t lastTone;
-static volatile int bytePos = 0;
 static volatile int bitPos = 0;
-static volatile uint8_t dataByte;
+static uint32_t tones[2]; // space, mark
 static AX25Encoder_t encoderData;
 static codeplugAPRS_Config_t *aprsConfig;
 
@@ -274,99 +263,6 @@ volatile aprsSendProgress_t aprsTxProgress = APRS_TX_IDLE; // used in the ISR
 
 static bool aprsBeaconingStateEnabled(aprsBeaconingStates_t s);
 static bool aprsBeaconingLocationIsValid(aprsBeaconingLocation_t *location);
-static void enqueueCharNrzi(AX25Encoder_t *encoderData, uint8_t data, bool useBitStuffing);
-
-static void enqueueBit(AX25Encoder_t *encoderData, bool data)
-{
-	if (data)
-	{
-		encoderData->packetBuffer[encoderData->packetBufferBitPosition / 8U] |= 0x01 << (encoderData->packetBufferBitPosition % 8U);
-	}
-	encoderData->packetBufferBitPosition++;
-}
-
-static void updateCRC(AX25Encoder_t *encoderData, bool dataBit)
-{
-	uint16_t crcXorDataBit = (encoderData->crc ^ dataBit);
-
-	encoderData->crc >>= 1;
-
-	if (crcXorDataBit & 0x01)
-	{
-		encoderData->crc ^= 0x8408;
-	}
-}
-
-static void enqueueCRC(AX25Encoder_t *encoderData)
-{
-	uint8_t crc_lo = (encoderData->crc ^ 0xff);
-	uint8_t crc_hi = ((encoderData->crc >> 8) ^ 0xff);
-
-	enqueueCharNrzi(encoderData, crc_lo, true);
-	enqueueCharNrzi(encoderData, crc_hi, true);
-}
-
-static void enqueuePadOfLength(AX25Encoder_t *encoderData, uint32_t len)
-{
-	for (uint8_t j = 0; j < len; j++)
-	{
-		enqueueCharNrzi(encoderData, (' ' << 1), true);
-	}
-}
-
-static void enqueueCharNrzi(AX25Encoder_t *encoderData, uint8_t data, bool useBitStuffing)
-{
-	bool currentBit;
-
-	for (uint8_t i = 0; i < 8U; i++)
-	{
-		currentBit = (data & 0x01);
-
-		updateCRC(encoderData, currentBit);
-
-		if (currentBit)
-		{
-			enqueueBit(encoderData, encoderData->currentBitNRZI);
-			encoderData->bitStuffingCounter++;
-
-			if (useBitStuffing && (encoderData->bitStuffingCounter == 5))
-			{
-				encoderData->currentBitNRZI ^= 1;
-				enqueueBit(encoderData, encoderData->currentBitNRZI);
-
-				encoderData->bitStuffingCounter = 0U;
-			}
-		}
-		else
-		{
-			encoderData->currentBitNRZI ^= 1;
-			enqueueBit(encoderData, encoderData->currentBitNRZI);
-
-			encoderData->bitStuffingCounter = 0U;
-		}
-
-		data >>= 1;
-	}
-}
-
-static void enqueueString(AX25Encoder_t *encoderData, const char *str)
-{
-	uint8_t i = 0;
-
-	while (str[i] != 0)
-	{
-		enqueueCharNrzi(encoderData, str[i], true);
-		i++;
-	};
-}
-
-static void enqueueFlagOfLength(AX25Encoder_t *encoderData, uint8_t len)
-{
-	for (uint8_t i = 0; i < len; i++)
-	{
-		enqueueCharNrzi(encoderData, 0x7E, false); // 0x7E flag
-	}
-}
 
 static void enqueueHeader(AX25Encoder_t *encoderData)
 {
@@ -374,29 +270,29 @@ static void enqueueHeader(AX25Encoder_t *encoderData)
 
 	for (uint32_t i = 0; i < strlen(APRS_DESTINATION); i++)
 	{
-		enqueueCharNrzi(encoderData, (APRS_DESTINATION[i] << 1), true);
+		ax25EnqueueChar(encoderData, (APRS_DESTINATION[i] << 1));
 	}
 
 	//if (len < 6U)
 	//{
-	//	enqueuePadOfLength(encoderData, (6U - len));
+	//	ax25EnqueuePadOfLength(encoderData, (6U - len));
 	//}
 
-	enqueueCharNrzi(encoderData, ('0' << 1), true);
+	ax25EnqueueChar(encoderData, ('0' << 1));
 
 	uint8_t len = MIN(strlen(myCall), 6U);
 
 	for (uint8_t i = 0; i < len; i++)
 	{
-		enqueueCharNrzi(encoderData, (myCall[i] << 1), true);
+		ax25EnqueueChar(encoderData, (myCall[i] << 1));
 	}
 
 	if (len < 6U)
 	{
-		enqueuePadOfLength(encoderData, (6U - len));
+		ax25EnqueuePadOfLength(encoderData, (6U - len));
 	}
 
-	enqueueCharNrzi(encoderData, ((aprsConfig->senderSSID + '0') << 1), true);
+	ax25EnqueueChar(encoderData, ((aprsConfig->senderSSID + '0') << 1));
 
 	uint8_t numPaths = ((strlen(aprsConfig->paths[1].name) == 0) ? 1U : 2U);
 
@@ -406,21 +302,21 @@ static void enqueueHeader(AX25Encoder_t *encoderData)
 
 		for (uint8_t i = 0; i < len; i++)
 		{
-			enqueueCharNrzi(encoderData, (aprsConfig->paths[p].name[i] << 1), true);
+			ax25EnqueueChar(encoderData, (aprsConfig->paths[p].name[i] << 1));
 		}
 
 		if (len < 6U)
 		{
-			enqueuePadOfLength(encoderData, (6U - len));
+			ax25EnqueuePadOfLength(encoderData, (6U - len));
 		}
 
 		uint8_t isEnd = (p == (numPaths - 1)) ? 1U : 0U;
 
-		enqueueCharNrzi(encoderData, (((aprsConfig->paths[p].SSID + '0') << 1) + isEnd), true);
+		ax25EnqueueChar(encoderData, (((aprsConfig->paths[p].SSID + '0') << 1) + isEnd));
 	}
 
-	enqueueCharNrzi(encoderData, 0x03, true);
-	enqueueCharNrzi(encoderData, 0xF0, true);
+	ax25EnqueueChar(encoderData, 0x03);
+	ax25EnqueueChar(encoderData, 0xF0);
 }
 
 static void enqueuePayload(AX25Encoder_t *encoderData, const char *latStr, const char *lonStr, const char *courseAndSpeed)
@@ -430,33 +326,33 @@ static void enqueuePayload(AX25Encoder_t *encoderData, const char *latStr, const
 	uint8_t symbol = (aprsConfig->iconIndex + '!'); //'+'; // + = cross symbol. Y = yacht etc
 	uint8_t symTable = ((aprsConfig->iconTable == 0) ? '/' : '\\'); //' = secondary table
 
-	enqueueCharNrzi(encoderData, DT_POS, true);
+	ax25EnqueueChar(encoderData, DT_POS);
 
 	if (aprsBeaconingStateEnabled(APRS_BEACONING_STATE_COMPRESSED_FORMAT))
 	{
-		enqueueCharNrzi(encoderData, symTable, true);
-		enqueueString(encoderData, latStr);
-		enqueueString(encoderData, lonStr);
-		enqueueCharNrzi(encoderData, symbol, true);
-		enqueueString(encoderData, (courseAndSpeed ? courseAndSpeed : "  "));
-		enqueueCharNrzi(encoderData, (courseAndSpeed ? (/*0x26 (Other)*/ 0x3E /* (RMC)*/ + '!') : '!'), true);
+		ax25EnqueueChar(encoderData, symTable);
+		ax25EnqueueString(encoderData, latStr);
+		ax25EnqueueString(encoderData, lonStr);
+		ax25EnqueueChar(encoderData, symbol);
+		ax25EnqueueString(encoderData, (courseAndSpeed ? courseAndSpeed : "  "));
+		ax25EnqueueChar(encoderData, (courseAndSpeed ? (/*0x26 (Other)*/ 0x3E /* (RMC)*/ + '!') : '!'));
 	}
 	else
 	{
-		enqueueString(encoderData, latStr);
-		enqueueCharNrzi(encoderData, symTable, true);
-		enqueueString(encoderData, lonStr);
-		enqueueCharNrzi(encoderData, symbol, true);
+		ax25EnqueueString(encoderData, latStr);
+		ax25EnqueueChar(encoderData, symTable);
+		ax25EnqueueString(encoderData, lonStr);
+		ax25EnqueueChar(encoderData, symbol);
 
 		if (courseAndSpeed != NULL)
 		{
-			enqueueString(encoderData, courseAndSpeed);
+			ax25EnqueueString(encoderData, courseAndSpeed);
 		}
 	}
 
 	if (aprsConfig->comment[0] != 0)
 	{
-		enqueueString(encoderData, aprsConfig->comment);
+		ax25EnqueueString(encoderData, aprsConfig->comment);
 	}
 }
 
@@ -544,10 +440,7 @@ static bool aprsSendPacket(codeplugAPRS_Config_t *config, aprsBeaconingLocation_
 
 	aprsConfig = config;
 
-	encoderData.bitStuffingCounter = 0;
-	encoderData.currentBitNRZI = false; // clear
-	memset(encoderData.packetBuffer, 0, AX25_PACKET_BUFFER_SIZE);
-	encoderData.packetBufferBitPosition = 0;
+	ax25EncoderReset(&encoderData);
 
 	codeplugGetRadioName(myCall);
 	myCall[6] = 0; //truncate to 6 chars max
@@ -689,23 +582,22 @@ static bool aprsSendPacket(codeplugAPRS_Config_t *config, aprsBeaconingLocation_
 		}
 	}
 
-	enqueueFlagOfLength(&encoderData, 16U);
-
-	encoderData.crc = 0xFFFF; // Initialise CRC now, after data has been sent as CRC does is only for data bytes
 	enqueueHeader(&encoderData);
 	enqueuePayload(&encoderData, latStr, lonStr, (courseAndSpeed ? courseSpeedStr : NULL));
-	enqueueCRC(&encoderData);
-	enqueueFlagOfLength(&encoderData, 3U);
 
-	lenBytes = encoderData.packetBufferBitPosition / 8;
-	bytePos = 0;
+	// Whole frame is keyed from a precomputed bitmap, the ISR only picks the tone for each bit
+	lenBits = ax25EncodeFrame(&encoderData, 16U, 3U);
 	bitPos = 0;
 	lastTone = 0xFFFFFFFF;
 
 #if defined(PLATFORM_MD9600)
 	encoderData.baudIs300 = false;
+	tones[0] = 1200;
+	tones[1] = 2200;
 #else // PLATFORM_MD9600
 	encoderData.baudIs300 = ((aprsConfig->flags & 0x01) != 0);
+	tones[0] = (encoderData.baudIs300 ? 16000 : 12000);
+	tones[1] = tones[0] + (encoderData.baudIs300 ? 2000 : 10000);
 #endif // PLATFORM_MD9600
 
 #if defined(CPU_MK22FN512VLL12)
@@ -787,38 +679,31 @@ void aprsBitStreamSender(void)
 		return;
 	}
 
-	if (bitPos % 8 == 0)
+	if (bitPos >= lenBits)
 	{
-		dataByte = encoderData.packetBuffer[bytePos];
-		bytePos++;
-
-		if (bytePos == lenBytes)
-		{
-//			radioWriteTone1Reg(0);
-			// just stop the ISR and flag that the data has been sent.
+//		radioWriteTone1Reg(0);
+		// just stop the ISR and flag that the data has been sent.
 
 #if defined(CPU_MK22FN512VLL12)
-			FTM_StopTimer(FTM1);
-			DisableIRQ(FTM1_IRQn);
+		FTM_StopTimer(FTM1);
+		DisableIRQ(FTM1_IRQn);
 #else // CPU_MK22FN512VLL12
-			HAL_TIM_Base_Stop_IT(&htim6);
+		HAL_TIM_Base_Stop_IT(&htim6);
 #endif // CPU_MK22FN512VLL12
 
-			aprsTxProgress = APRS_TX_FINISHED;			// Tell the foreground we've finished, so it can do the speaker and other stuff
-			return;
-		}
+		aprsTxProgress = APRS_TX_FINISHED;			// Tell the foreground we've finished, so it can do the speaker and other stuff
+		return;
 	}
 
-#if defined(CPU_MK22FN512VLL12)
-	newTone = (encoderData.baudIs300 ? 16000 : 12000) + ((dataByte & 0x01) ? (encoderData.baudIs300 ? 2000 : 10000) : 0);
+	newTone = tones[(encoderData.packetBuffer[bitPos >> 5] >> (bitPos & 0x1F)) & 0x01];
 
+#if defined(CPU_MK22FN512VLL12)
 	if (newTone != lastTone)
 	{
 		radioWriteTone1Reg(newTone);
 	}
 #else // CPU_MK22FN512VLL12
 #if defined(PLATFORM_MD9600)
-	newTone = 1200 + ((dataByte & 0x01) ? 1000 : 0);
 	if (newTone != lastTone)
 	{
 		int tval = (newTone * 65536) / 32000;												//calculate the value required to generate this tone
@@ -833,7 +718,6 @@ void aprsBitStreamSender(void)
 		lastTone = newTone;
 	}
 #else // PLATFORM_MD9600
-	newTone = (encoderData.baudIs300 ? 16000 : 12000) + ((dataByte & 0x01) ? (encoderData.baudIs300 ? 2000 : 10000) : 0);
 	if (newTone != lastTone)
 	{
 		radioWriteTone1Reg(newTone);
@@ -842,16 +726,17 @@ void aprsBitStreamSender(void)
 #endif // PLATFORM_MD9600
 #endif // CPU_MK22FN512VLL12
 
-	dataByte >>= 1;
 	bitPos++;
 }
 
 #if defined(CPU_MK22FN512VLL12)
 void FTM1_IRQHandler(void)
 {
+	PROFILER_ENTER(PROFILER_SITE_FTM1_IRQ);
     /* Clear interrupt flag.*/
     FTM_ClearStatusFlags(FTM1, kFTM_TimeOverflowFlag);
 	aprsBitStreamSender();
+	PROFILER_EXIT(PROFILER_SITE_FTM1_IRQ);
     __DSB();
 }
 
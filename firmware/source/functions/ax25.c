@@ -0,0 +1,241 @@
+/*
+ * Copyright (C) 2024 Roger Clark, VK3KYY / G4KYF
+ *                    Daniel Caujolle-Bert, F1RMB
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+ *    in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. Use of this source code or binary releases for commercial purposes is strictly forbidden. This includes, without limitation,
+ *    incorporation in a commercial product or incorporation into a product or project which allows commercial use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <string.h>
+#include "functions/ax25.h"
+#include "utils.h"
+
+
+// CRC-16/X.25 (reflected 0x1021), one octet per lookup
+static const uint16_t AX25_CRC_TABLE[256] =
+{
+	0x0000, 0x1189, 0x2312, 0x329B, 0x4624, 0x57AD, 0x6536, 0x74BF,
+	0x8C48, 0x9DC1, 0xAF5A, 0xBED3, 0xCA6C, 0xDBE5, 0xE97E, 0xF8F7,
+	0x1081, 0x0108, 0x3393, 0x221A, 0x56A5, 0x472C, 0x75B7, 0x643E,
+	0x9CC9, 0x8D40, 0xBFDB, 0xAE52, 0xDAED, 0xCB64, 0xF9FF, 0xE876,
+	0x2102, 0x308B, 0x0210, 0x1399, 0x6726, 0x76AF, 0x4434, 0x55BD,
+	0xAD4A, 0xBCC3, 0x8E58, 0x9FD1, 0xEB6E, 0xFAE7, 0xC87C, 0xD9F5,
+	0x3183, 0x200A, 0x1291, 0x0318, 0x77A7, 0x662E, 0x54B5, 0x453C,
+	0xBDCB, 0xAC42, 0x9ED9, 0x8F50, 0xFBEF, 0xEA66, 0xD8FD, 0xC974,
+	0x4204, 0x538D, 0x6116, 0x709F, 0x0420, 0x15A9, 0x2732, 0x36BB,
+	0xCE4C, 0xDFC5, 0xED5E, 0xFCD7, 0x8868, 0x99E1, 0xAB7A, 0xBAF3,
+	0x5285, 0x430C, 0x7197, 0x601E, 0x14A1, 0x0528, 0x37B3, 0x263A,
+	0xDECD, 0xCF44, 0xFDDF, 0xEC56, 0x98E9, 0x8960, 0xBBFB, 0xAA72,
+	0x6306, 0x728F, 0x4014, 0x519D, 0x2522, 0x34AB, 0x0630, 0x17B9,
+	0xEF4E, 0xFEC7, 0xCC5C, 0xDDD5, 0xA96A, 0xB8E3, 0x8A78, 0x9BF1,
+	0x7387, 0x620E, 0x5095, 0x411C, 0x35A3, 0x242A, 0x16B1, 0x0738,
+	0xFFCF, 0xEE46, 0xDCDD, 0xCD54, 0xB9EB, 0xA862, 0x9AF9, 0x8B70,
+	0x8408, 0x9581, 0xA71A, 0xB693, 0xC22C, 0xD3A5, 0xE13E, 0xF0B7,
+	0x0840, 0x19C9, 0x2B52, 0x3ADB, 0x4E64, 0x5FED, 0x6D76, 0x7CFF,
+	0x9489, 0x8500, 0xB79B, 0xA612, 0xD2AD, 0xC324, 0xF1BF, 0xE036,
+	0x18C1, 0x0948, 0x3BD3, 0x2A5A, 0x5EE5, 0x4F6C, 0x7DF7, 0x6C7E,
+	0xA50A, 0xB483, 0x8618, 0x9791, 0xE32E, 0xF2A7, 0xC03C, 0xD1B5,
+	0x2942, 0x38CB, 0x0A50, 0x1BD9, 0x6F66, 0x7EEF, 0x4C74, 0x5DFD,
+	0xB58B, 0xA402, 0x9699, 0x8710, 0xF3AF, 0xE226, 0xD0BD, 0xC134,
+	0x39C3, 0x284A, 0x1AD1, 0x0B58, 0x7FE7, 0x6E6E, 0x5CF5, 0x4D7C,
+	0xC60C, 0xD785, 0xE51E, 0xF497, 0x8028, 0x91A1, 0xA33A, 0xB2B3,
+	0x4A44, 0x5BCD, 0x6956, 0x78DF, 0x0C60, 0x1DE9, 0x2F72, 0x3EFB,
+	0xD68D, 0xC704, 0xF59F, 0xE416, 0x90A9, 0x8120, 0xB3BB, 0xA232,
+	0x5AC5, 0x4B4C, 0x79D7, 0x685E, 0x1CE1, 0x0D68, 0x3FF3, 0x2E7A,
+	0xE70E, 0xF687, 0xC41C, 0xD595, 0xA12A, 0xB0A3, 0x8238, 0x93B1,
+	0x6B46, 0x7ACF, 0x4854, 0x59DD, 0x2D62, 0x3CEB, 0x0E70, 0x1FF9,
+	0xF78F, 0xE606, 0xD49D, 0xC514, 0xB1AB, 0xA022, 0x92B9, 0x8330,
+	0x7BC7, 0x6A4E, 0x58D5, 0x495C, 0x3DE3, 0x2C6A, 0x1EF1, 0x0F78,
+};
+
+void ax25EnqueueChar(AX25Encoder_t *encoderData, uint8_t data)
+{
+	if (encoderData->frameLength < (AX25_FRAME_BUFFER_SIZE - 2U)) // keep room for the FCS
+	{
+		encoderData->frameBuffer[encoderData->frameLength] = data;
+		encoderData->frameLength++;
+	}
+}
+
+static void ax25EnqueueCRC(AX25Encoder_t *encoderData)
+{
+	uint16_t crc = 0xFFFF;
+
+	for (uint16_t i = 0; i < encoderData->frameLength; i++)
+	{
+		crc = (crc >> 8) ^ AX25_CRC_TABLE[(crc ^ encoderData->frameBuffer[i]) & 0xFF];
+	}
+
+	crc ^= 0xFFFF;
+	encoderData->frameBuffer[encoderData->frameLength++] = (crc & 0xFF);
+	encoderData->frameBuffer[encoderData->frameLength++] = (crc >> 8);
+}
+
+void ax25EnqueuePadOfLength(AX25Encoder_t *encoderData, uint32_t len)
+{
+	for (uint8_t j = 0; j < len; j++)
+	{
+		ax25EnqueueChar(encoderData, (' ' << 1));
+	}
+}
+
+void ax25EnqueueString(AX25Encoder_t *encoderData, const char *str)
+{
+	uint8_t i = 0;
+
+	while (str[i] != 0)
+	{
+		ax25EnqueueChar(encoderData, str[i]);
+		i++;
+	};
+}
+
+// Append up to 32 bits, LSB first, to the tone bitmap
+static void ax25EnqueueBits(AX25Encoder_t *encoderData, uint32_t bits, uint8_t count)
+{
+	uint32_t word = (encoderData->packetBufferBitPosition >> 5);
+	uint32_t shift = (encoderData->packetBufferBitPosition & 0x1F);
+
+	if ((encoderData->packetBufferBitPosition + count) > AX25_PACKET_BUFFER_BITS)
+	{
+		return;
+	}
+
+	if (count < 32U)
+	{
+		bits &= ((1U << count) - 1U);
+	}
+
+	encoderData->packetBuffer[word] |= (bits << shift);
+
+	if ((shift + count) > 32U)
+	{
+		encoderData->packetBuffer[word + 1] |= (bits >> (32U - shift));
+	}
+
+	encoderData->packetBufferBitPosition += count;
+}
+
+static void ax25EnqueueFlagOfLength(AX25Encoder_t *encoderData, uint8_t len)
+{
+	// 0x7E flags are never stuffed
+	while (len >= 4U)
+	{
+		ax25EnqueueBits(encoderData, 0x7E7E7E7E, 32U);
+		len -= 4U;
+	}
+
+	if (len > 0U)
+	{
+		ax25EnqueueBits(encoderData, 0x7E7E7E7E, (len * 8U));
+	}
+}
+
+// Bit stuff the frame octets into the bitmap, 24 bits at a time so the pending run of ones
+// still fits in a 32-bit register along with the chunk.
+static void ax25EnqueueFrameStuffed(AX25Encoder_t *encoderData)
+{
+	uint32_t ones = 0U; // consecutive ones already sent
+
+	for (uint16_t pos = 0; pos < encoderData->frameLength; pos += 3U)
+	{
+		uint32_t n = SAFE_MIN((uint32_t)(encoderData->frameLength - pos), 3U);
+		uint32_t chunk = 0U;
+		uint32_t bits = (n * 8U);
+
+		for (uint32_t i = 0; i < n; i++)
+		{
+			chunk |= (encoderData->frameBuffer[pos + i] << (i * 8U));
+		}
+
+		while (bits > 0U)
+		{
+			uint32_t len = (bits + ones);
+			uint32_t x = ((chunk << ones) | ((1U << ones) - 1U)) & ((1U << len) - 1U);
+			uint32_t fives = (x & (x >> 1) & (x >> 2) & (x >> 3) & (x >> 4));
+
+			if (fives == 0U)
+			{
+				uint32_t zeros = (~x & ((1U << len) - 1U));
+
+				ax25EnqueueBits(encoderData, chunk, bits);
+				ones = ((zeros == 0U) ? len : (uint32_t)(len - 32U + __builtin_clz(zeros)));
+				bits = 0U;
+			}
+			else
+			{
+				// Send up to the fifth one, then the stuffed zero
+				uint32_t count = (__builtin_ctz(fives) + 5U - ones);
+
+				ax25EnqueueBits(encoderData, chunk, count);
+				ax25EnqueueBits(encoderData, 0U, 1U);
+				chunk >>= count;
+				bits -= count;
+				ones = 0U;
+			}
+		}
+	}
+}
+
+// NRZI: a zero toggles the tone, a one keeps it. Done as a prefix XOR over each word.
+static void ax25EncodeNrzi(AX25Encoder_t *encoderData)
+{
+	uint32_t level = 0U;
+	uint32_t words = ((encoderData->packetBufferBitPosition + 31U) >> 5);
+
+	for (uint32_t i = 0; i < words; i++)
+	{
+		uint32_t x = ~encoderData->packetBuffer[i];
+
+		x ^= (x << 1);
+		x ^= (x << 2);
+		x ^= (x << 4);
+		x ^= (x << 8);
+		x ^= (x << 16);
+		x ^= level;
+
+		encoderData->packetBuffer[i] = x;
+		level = ((x & 0x80000000) ? 0xFFFFFFFF : 0U);
+	}
+}
+
+void ax25EncoderReset(AX25Encoder_t *encoderData)
+{
+	memset(encoderData->packetBuffer, 0, AX25_PACKET_BUFFER_SIZE);
+	encoderData->packetBufferBitPosition = 0;
+	encoderData->frameLength = 0;
+}
+
+// Append the FCS, then build the whole keyed bitmap: flags, stuffed frame, flags, NRZI.
+// Returns the number of bits to key, the last octet is trailing flag padding, it's not keyed.
+uint32_t ax25EncodeFrame(AX25Encoder_t *encoderData, uint8_t leadingFlags, uint8_t trailingFlags)
+{
+	ax25EnqueueCRC(encoderData);
+
+	ax25EnqueueFlagOfLength(encoderData, leadingFlags);
+	ax25EnqueueFrameStuffed(encoderData);
+	ax25EnqueueFlagOfLength(encoderData, trailingFlags);
+	ax25EncodeNrzi(encoderData);
+
+	return (((encoderData->packetBufferBitPosition / 8) - 1) * 8);
+}
@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2024 Roger Clark, VK3KYY / G4KYF
+ *                    Daniel Caujolle-Bert, F1RMB
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+ *    in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. Use of this source code or binary releases for commercial purposes is strictly forbidden. This includes, without limitation,
+ *    incorporation in a commercial product or incorporation into a product or project which allows commercial use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <math.h>
+#include "functions/channelDistance.h"
+#include "utils.h"
+
+#define CHANNEL_LOCATION_NONE       UINT64_MAX
+
+
+// Only used when the locations are (re)built, the sorting itself is integer only
+void channelDistancePositionFromLatLong(double latitude, double longitude, int32_t *position)
+{
+	float lat = (float)(latitude * (M_PI / 180.0));
+	float lon = (float)(longitude * (M_PI / 180.0));
+	float cosLat = cosf(lat);
+
+	position[0] = (int32_t)(cosLat * cosf(lon) * CHANNEL_LOCATION_ONE);
+	position[1] = (int32_t)(cosLat * sinf(lon) * CHANNEL_LOCATION_ONE);
+	position[2] = (int32_t)(sinf(lat) * CHANNEL_LOCATION_ONE);
+}
+
+static inline bool channelDistanceIsLower(const uint64_t *distances, uint16_t posA, uint16_t posB)
+{
+	return ((distances[posA] < distances[posB]) || ((distances[posA] == distances[posB]) && (posA < posB)));
+}
+
+static void channelDistanceSiftDown(const uint64_t *distances, uint16_t *order, int root, int end)
+{
+	int child;
+
+	while ((child = ((root * 2) + 1)) < end)
+	{
+		if (((child + 1) < end) && channelDistanceIsLower(distances, order[child], order[child + 1]))
+		{
+			child++;
+		}
+
+		if (channelDistanceIsLower(distances, order[root], order[child]) == false)
+		{
+			return;
+		}
+
+		SAFE_SWAP(order[root], order[child]);
+		root = child;
+	}
+}
+
+// Sorts 'order' (positions in 'locations') by distance from 'ownPosition', nearest first.
+// 'incremental': 'order' holds the order for a nearby previous location, otherwise it is sorted from scratch.
+// 'distances' is scratch space for 'count' values, in 'locations' order.
+void channelDistanceSort(const channelLocation_t *locations, uint16_t *order, uint64_t *distances, uint16_t count, const int32_t *ownPosition, bool incremental)
+{
+	for (uint16_t i = 0; i < count; i++)
+	{
+		const int32_t *position = locations[i].position;
+
+		if ((position[0] | position[1] | position[2]) != 0)
+		{
+			int64_t dx = position[0] - ownPosition[0];
+			int64_t dy = position[1] - ownPosition[1];
+			int64_t dz = position[2] - ownPosition[2];
+
+			// The chord length grows with the great circle distance, so there is no need for the actual distance
+			distances[i] = (uint64_t)((dx * dx) + (dy * dy) + (dz * dz));
+		}
+		else
+		{
+			// Channels without a location are sorted at the end of the list, in 'locations' order (equal distances are ordered by position in 'locations')
+			distances[i] = CHANNEL_LOCATION_NONE;
+		}
+	}
+
+	if (incremental == false)
+	{
+		// In place heap sort. There are no equal keys, so the result is the same as the insertion sort's
+		for (uint16_t i = 0; i < count; i++)
+		{
+			order[i] = i;
+		}
+
+		for (int i = ((count / 2) - 1); i >= 0; i--)
+		{
+			channelDistanceSiftDown(distances, order, i, count);
+		}
+
+		for (int end = (count - 1); end > 0; end--)
+		{
+			SAFE_SWAP(order[0], order[end]);
+			channelDistanceSiftDown(distances, order, 0, end);
+		}
+
+		return;
+	}
+
+	// Insertion sort, starting from the previous order: when the location only moved slightly the order is
+	// already (almost) right, and this costs a single pass over the channels.
+	for (uint16_t i = 1; i < count; i++)
+	{
+		uint16_t pos = order[i];
+		uint16_t j = i;
+
+		while ((j > 0) && channelDistanceIsLower(distances, pos, order[j - 1]))
+		{
+			order[j] = order[j - 1];
+			j--;
+		}
+
+		order[j] = pos;
+	}
+}
@@ -37,6 +37,9 @@
 #include "user_interface/uiLocalisation.h"
 #include "user_interface/uiGlobals.h"
 #include "interfaces/settingsStorage.h"
+#if defined(USING_EXTERNAL_DEBUGGER)
+#include "SeggerRTT/RTT/SEGGER_RTT.h"
+#endif
 
 
 const int CODEPLUG_ADDR_EX_ZONE_BASIC = 0x8000;
@@ -103,6 +106,7 @@ typedef struct
 {
 	uint32_t tgOrPCNum;
 	uint16_t index;
+	uint16_t sortedByTGorPC; // Position of the Nth contact, when ordered by TG/PC number then index (uses the struct padding)
 } codeplugContactCache_t;
 
 
@@ -139,12 +143,27 @@ __attribute__((section(".data.$RAM2"))) uint8_t codeplugAllChannelsCache[128];
 __attribute__((section(".data.$RAM2"))) uint8_t codeplugZonesInUseCache[CODEPLUG_EX_ZONE_INUSE_PACKED_DATA_SIZE];
 __attribute__((section(".data.$RAM2"))) uint16_t quickKeysCache[CODEPLUG_QUICKKEYS_SIZE];
 
+// Rank (number of set bits before each 32 bits word) of the in use bitmaps, for select / next / previous in use lookups
+#define ZONES_IN_USE_WORDS    (CODEPLUG_EX_ZONE_INUSE_PACKED_DATA_SIZE / sizeof(uint32_t))
+#define ALL_CHANNELS_WORDS    (sizeof(codeplugAllChannelsCache) / sizeof(uint32_t))
+static uint16_t codeplugZonesInUseRank[ZONES_IN_USE_WORDS + 1];
+static uint16_t codeplugAllChannelsRank[ALL_CHANNELS_WORDS + 1];
+
+// Bumped on every channel data / in use change, and zone change, so callers caching channel or zone data know when to refresh it
+static uint32_t codeplugChannelsRevision = 0;
+
 __attribute__((section(".data.$RAM2"))) uint8_t lastUsedChannelInZoneData[CODEPLUG_ALL_ZONES_MAX + 1]; // All zones (0..79) + AllChannel 0..1023 (hence one extra byte to store this value)
 static bool lastUsedChannelInZoneHasChanged = false;
 
 __attribute__((section(".data.$RAM2"))) codeplugAPRSConfigsCache_t codeplugAPRSCache;
 
 static bool codeplugContactGetReserve1ByteForIndex(int index, struct_codeplugContact_t *contact);
+static void codeplugContactsCacheSortByTGorPC(void);
+static void bitmapBuildRank(const uint8_t *bitmap, uint16_t *rank, int numWords);
+static int bitmapSelect(const uint8_t *bitmap, const uint16_t *rank, int numWords, int n);
+static int bitmapNextSet(const uint8_t *bitmap, int numWords, int from);
+static int bitmapPreviousSet(const uint8_t *bitmap, int numWords, int from);
+static int codeplugContactsCacheFindFirstTGorPC(uint32_t tgorpc);
 
 uint32_t byteSwap32(uint32_t n)
 {
@@ -275,21 +294,130 @@ void codeplugUtilConvertStringToBuf(char *inBuf, char *outBuf, int len)
 	}
 }
 
-void codeplugZonesInitCache(void)
+// Bit N of the bitmaps is element N, hence (little endian) 32 bits words can be used
+static inline uint32_t bitmapGetWord(const uint8_t *bitmap, int word)
 {
-	EEPROM_Read(CODEPLUG_ADDR_EX_ZONE_INUSE_PACKED_DATA, (uint8_t *)&codeplugZonesInUseCache, CODEPLUG_EX_ZONE_INUSE_PACKED_DATA_SIZE);
+	uint32_t w;
+
+	memcpy(&w, &bitmap[word * sizeof(uint32_t)], sizeof(uint32_t));
+	return w;
 }
 
-int codeplugZonesGetCount(void)
+static void bitmapBuildRank(const uint8_t *bitmap, uint16_t *rank, int numWords)
+{
+	rank[0] = 0;
+	for (int w = 0; w < numWords; w++)
+	{
+		rank[w + 1] = rank[w] + __builtin_popcount(bitmapGetWord(bitmap, w));
+	}
+}
+
+// Returns the position of the Nth (zero based) set bit, or -1
+static int bitmapSelect(const uint8_t *bitmap, const uint16_t *rank, int numWords, int n)
+{
+	int low = 0;
+	int high = numWords - 1;
+	uint32_t word;
+
+	if ((n < 0) || (n >= rank[numWords]))
+	{
+		return -1;
+	}
+
+	// Last word with less than N set bits before it
+	while (low < high)
+	{
+		int mid = ((low + high + 1) >> 1);
+
+		if (rank[mid] <= n)
+		{
+			low = mid;
+		}
+		else
+		{
+			high = mid - 1;
+		}
+	}
+
+	word = bitmapGetWord(bitmap, low);
+	for (n -= rank[low]; n > 0; n--)
+	{
+		word &= (word - 1); // clear the lowest set bit
+	}
+
+	return ((low * 32) + __builtin_ctz(word));
+}
+
+// Returns the position of the first set bit at, or after, 'from', or -1
+static int bitmapNextSet(const uint8_t *bitmap, int numWords, int from)
 {
-	int numZones = 1;// Add one extra zone to allow for the special 'All Channels' Zone
+	int w;
+	uint32_t word;
 
-	for(int i = 0; i < CODEPLUG_EX_ZONE_INUSE_PACKED_DATA_SIZE; i++)
+	if (from < 0)
 	{
-		numZones += __builtin_popcount(codeplugZonesInUseCache[i]);
+		from = 0;
 	}
 
-	return numZones;
+	if ((w = (from >> 5)) >= numWords)
+	{
+		return -1;
+	}
+
+	word = bitmapGetWord(bitmap, w) & (0xFFFFFFFFU << (from & 31));
+	while (word == 0)
+	{
+		if (++w >= numWords)
+		{
+			return -1;
+		}
+		word = bitmapGetWord(bitmap, w);
+	}
+
+	return ((w << 5) + __builtin_ctz(word));
+}
+
+// Returns the position of the last set bit at, or before, 'from', or -1
+static int bitmapPreviousSet(const uint8_t *bitmap, int numWords, int from)
+{
+	int w;
+	uint32_t word;
+
+	if (from >= (numWords * 32))
+	{
+		from = (numWords * 32) - 1;
+	}
+
+	if (from < 0)
+	{
+		return -1;
+	}
+
+	w = (from >> 5);
+	word = bitmapGetWord(bitmap, w) & (0xFFFFFFFFU >> (31 - (from & 31)));
+	while (word == 0)
+	{
+		if (--w < 0)
+		{
+			return -1;
+		}
+		word = bitmapGetWord(bitmap, w);
+	}
+
+	return ((w << 5) + (31 - __builtin_clz(word)));
+}
+
+void codeplugZonesInitCache(void)
+{
+	codeplugChannelsRevision++;
+
+	EEPROM_Read(CODEPLUG_ADDR_EX_ZONE_INUSE_PACKED_DATA, (uint8_t *)&codeplugZonesInUseCache, CODEPLUG_EX_ZONE_INUSE_PACKED_DATA_SIZE);
+	bitmapBuildRank(codeplugZonesInUseCache, codeplugZonesInUseRank, ZONES_IN_USE_WORDS);
+}
+
+int codeplugZonesGetCount(void)
+{
+	return (codeplugZonesInUseRank[ZONES_IN_USE_WORDS] + 1);// Add one extra zone to allow for the special 'All Channels' Zone
 }
 
 bool codeplugZoneGetDataForNumber(int zoneNum, struct_codeplugZone_t *returnBuf)
@@ -314,28 +442,7 @@ bool codeplugZoneGetDataForNumber(int zoneNum, struct_codeplugZone_t *returnBuf)
 	{
 		// Need to find the index into the Zones data for the specific Zone number.
 		// Because the Zones data is not guaranteed to be packed by the CPS (though we should attempt to make the CPS always pack the Zones)
-		int count = -1;// Need to start counting at -1 because the Zone number is zero indexed
-		int foundIndex = -1;
-
-		// Go though each byte in the In Use table
-		for(int i = 0; i < CODEPLUG_EX_ZONE_INUSE_PACKED_DATA_SIZE; i++)
-		{
-			// Go though each binary bit, counting them one by one
-			for(int j = 0; j < 8; j++)
-			{
-				if (((codeplugZonesInUseCache[i] >> j) & 0x01) == 0x01)
-				{
-					count++;
-
-					if (count == zoneNum)
-					{
-						// found it. So save the index before we exit the "for" loops
-						foundIndex = (i * 8) + j;
-						break;// Will break out of this loop, but the outer loop breaks because it also checks for foundIndex
-					}
-				}
-			}
-		}
+		int foundIndex = bitmapSelect(codeplugZonesInUseCache, codeplugZonesInUseRank, ZONES_IN_USE_WORDS, zoneNum);
 
 		if (foundIndex != -1)
 		{
@@ -372,6 +479,7 @@ bool codeplugZoneAddChannelToZoneAndSave(int channelIndex, struct_codeplugZone_t
 	{
 		zoneBuf->channels[zoneBuf->NOT_IN_CODEPLUGDATA_numChannelsInZone++] = channelIndex;// add channel to zone, and increment numb channels in zone
 		zoneBuf->NOT_IN_CODEPLUGDATA_highestIndex = zoneBuf->NOT_IN_CODEPLUGDATA_numChannelsInZone;
+		codeplugChannelsRevision++;
 
 		// IMPORTANT. Write size is different from the size of the data, because it the zone struct contains properties not in the codeplug data
 		return EEPROM_Write(CODEPLUG_ADDR_EX_ZONE_LIST + (zoneBuf->NOT_IN_CODEPLUGDATA_indexNumber * (16 + (sizeof(uint16_t) * codeplugChannelsPerZone))),
@@ -381,19 +489,6 @@ bool codeplugZoneAddChannelToZoneAndSave(int channelIndex, struct_codeplugZone_t
 	return false;
 }
 
-static uint16_t codeplugAllChannelsGetCount(void)
-{
-	uint16_t c = 0;
-
-	//                         v-- This is a bit verbose, but it does make it clear
-	for (uint16_t i = 0; i < ((CODEPLUG_CHANNELS_BANKS_MAX * CODEPLUG_CHANNELS_PER_BANK) / 8); i++)
-	{
-		c += __builtin_popcount(codeplugAllChannelsCache[i]);
-	}
-
-	return c;
-}
-
 static bool codeplugAllChannelsReadHeaderBank(int channelBank, uint8_t *bitArray)
 {
 	if(channelBank == 0)
@@ -416,6 +511,38 @@ bool codeplugAllChannelsIndexIsInUse(int index)
 	return false;
 }
 
+// Current revision of the channels and zones data, see codeplugChannelsRevision
+uint32_t codeplugChannelsGetRevision(void)
+{
+	return codeplugChannelsRevision;
+}
+
+// Returns the next in use channel after 'index', wrapping around, or 'index' if none is in use
+int codeplugAllChannelsGetNextInUse(int index)
+{
+	int bit = bitmapNextSet(codeplugAllChannelsCache, ALL_CHANNELS_WORDS, index); // bit N is channel N + 1
+
+	if (bit < 0)
+	{
+		bit = bitmapNextSet(codeplugAllChannelsCache, ALL_CHANNELS_WORDS, 0);
+	}
+
+	return ((bit < 0) ? index : (bit + 1));
+}
+
+// Returns the previous in use channel before 'index', wrapping around, or 'index' if none is in use
+int codeplugAllChannelsGetPreviousInUse(int index)
+{
+	int bit = bitmapPreviousSet(codeplugAllChannelsCache, ALL_CHANNELS_WORDS, (index - 2)); // bit N is channel N + 1
+
+	if (bit < 0)
+	{
+		bit = bitmapPreviousSet(codeplugAllChannelsCache, ALL_CHANNELS_WORDS, (CODEPLUG_CHANNELS_MAX - 1));
+	}
+
+	return ((bit < 0) ? index : (bit + 1));
+}
+
 void codeplugAllChannelsIndexSetUsed(int index)
 {
 	if ((index >= CODEPLUG_CHANNELS_MIN) && (index <= CODEPLUG_CHANNELS_MAX))
@@ -424,6 +551,9 @@ void codeplugAllChannelsIndexSetUsed(int index)
 		int channelBank = (index / CODEPLUG_CHANNELS_PER_BANK);
 		int byteno = (index % CODEPLUG_CHANNELS_PER_BANK) / 8;
 		int cacheOffset = index / 8;
+		bool alreadyInUse = ((codeplugAllChannelsCache[cacheOffset] & (1 << (index % 8))) != 0);
+
+		codeplugChannelsRevision++;
 
 		codeplugAllChannelsCache[cacheOffset] |= (1 << (index % 8));
 
@@ -437,6 +567,16 @@ void codeplugAllChannelsIndexSetUsed(int index)
 					(CODEPLUG_CHANNELS_PER_BANK * CODEPLUG_CHANNEL_DATA_STRUCT_SIZE + 16))) + byteno, &codeplugAllChannelsCache[cacheOffset], 1);
 		}
 
+		if (alreadyInUse)
+		{
+			return;
+		}
+
+		for (int w = ((index >> 5) + 1); w <= ALL_CHANNELS_WORDS; w++)
+		{
+			codeplugAllChannelsRank[w]++;
+		}
+
 		allChannelsTotalNumOfChannels++;
 		if ((index + 1) > allChannelsHighestChannelIndex)
 		{
@@ -447,6 +587,8 @@ void codeplugAllChannelsIndexSetUsed(int index)
 
 void codeplugAllChannelsInitCache(void)
 {
+	codeplugChannelsRevision++;
+
 	// There are 8 banks
 	for (uint16_t bank = 0; bank < CODEPLUG_CHANNELS_BANKS_MAX; bank++)
 	{
@@ -454,17 +596,9 @@ void codeplugAllChannelsInitCache(void)
 		codeplugAllChannelsReadHeaderBank(bank, &codeplugAllChannelsCache[bank * 16]);
 	}
 
-	allChannelsHighestChannelIndex = 0;
-	for (uint16_t index = CODEPLUG_CHANNELS_MAX; index >= CODEPLUG_CHANNELS_MIN ; index--)
-	{
-		if (codeplugAllChannelsIndexIsInUse(index))
-		{
-			allChannelsHighestChannelIndex = index;
-			break;
-		}
-	}
-
-	allChannelsTotalNumOfChannels = codeplugAllChannelsGetCount();
+	bitmapBuildRank(codeplugAllChannelsCache, codeplugAllChannelsRank, ALL_CHANNELS_WORDS);
+	allChannelsHighestChannelIndex = (bitmapPreviousSet(codeplugAllChannelsCache, ALL_CHANNELS_WORDS, (CODEPLUG_CHANNELS_MAX - 1)) + 1);
+	allChannelsTotalNumOfChannels = codeplugAllChannelsRank[ALL_CHANNELS_WORDS];
 }
 
 uint32_t codeplugChannelGetOptionalDMRID(struct_codeplugChannel_t *channelBuf)
@@ -643,6 +777,8 @@ bool codeplugChannelSaveDataForIndex(int index, struct_codeplugChannel_t *channe
 	channelBuf->LibreDMR_flag1 &= ~CODEPLUG_CHANNEL_LIBREDMR_FLAG1_OUT_OF_BAND;
 #endif
 
+	codeplugChannelsRevision++;
+
 	channelBuf->chMode = (channelBuf->chMode == RADIO_MODE_ANALOG) ? 0 : 1;
 	// Convert normal integers into legacy codeplug tx and rx freq values
 	channelBuf->txFreq = int2bcd(channelBuf->txFreq);
@@ -659,9 +795,6 @@ bool codeplugChannelSaveDataForIndex(int index, struct_codeplugChannel_t *channe
 	else
 	{
 		int flashWritePos = CODEPLUG_ADDR_CHANNEL_FLASH;
-		int flashSector;
-		int flashEndSector;
-		int bytesToWriteInCurrentSector = CODEPLUG_CHANNEL_DATA_STRUCT_SIZE;
 
 		index -= 128;// First 128 channels are in the EEPOM, so subtract 128 from the number when looking in the Flash
 
@@ -669,61 +802,10 @@ bool codeplugChannelSaveDataForIndex(int index, struct_codeplugChannel_t *channe
 		flashWritePos += 16 * (index / 128);// we just need to skip over that these flag bits when calculating the position of the channel data in memory
 		flashWritePos += index * CODEPLUG_CHANNEL_DATA_STRUCT_SIZE;// go to the position of the specific index
 
-		flashSector 	= flashWritePos / 4096;
-		flashEndSector 	= (flashWritePos + CODEPLUG_CHANNEL_DATA_STRUCT_SIZE) / 4096;
-
-		if (flashSector != flashEndSector)
-		{
-			bytesToWriteInCurrentSector = (flashEndSector * 4096) - flashWritePos;
-		}
-
-		SPI_Flash_read(FLASH_ADDRESS_OFFSET + (flashSector * 4096), SPI_Flash_sectorbuffer, 4096);
-		uint8_t *writePos = SPI_Flash_sectorbuffer + flashWritePos - (flashSector * 4096);
-		memcpy(writePos, channelBuf, bytesToWriteInCurrentSector);
-
-		retVal = SPI_Flash_eraseSector(FLASH_ADDRESS_OFFSET + (flashSector * 4096));
-		if (!retVal)
-		{
-			goto errorExit;
-		}
-
-		for (int i = 0; i < 16; i++)
-		{
-			retVal = SPI_Flash_writePage(FLASH_ADDRESS_OFFSET + (flashSector * 4096) + (i * 256), SPI_Flash_sectorbuffer + (i * 256));
-			if (!retVal)
-			{
-				goto errorExit;
-			}
-		}
-
-		if (flashSector != flashEndSector)
-		{
-			uint8_t *channelBufPusOffset = (uint8_t *)channelBuf + bytesToWriteInCurrentSector;
-			bytesToWriteInCurrentSector = CODEPLUG_CHANNEL_DATA_STRUCT_SIZE - bytesToWriteInCurrentSector;
-
-			SPI_Flash_read(FLASH_ADDRESS_OFFSET + (flashEndSector * 4096), SPI_Flash_sectorbuffer, 4096);
-			memcpy(SPI_Flash_sectorbuffer, (uint8_t *)channelBufPusOffset, bytesToWriteInCurrentSector);
-
-			retVal = SPI_Flash_eraseSector(FLASH_ADDRESS_OFFSET + (flashEndSector * 4096));
-
-			if (!retVal)
-			{
-				goto errorExit;
-			}
-			for (int i = 0; i < 16; i++)
-			{
-				retVal = SPI_Flash_writePage(FLASH_ADDRESS_OFFSET + (flashEndSector * 4096) + (i * 256), SPI_Flash_sectorbuffer + (i * 256));
-
-				if (!retVal)
-				{
-					goto errorExit;
-				}
-			}
-
-		}
+		// Sector read/erase/program (also across sector boundaries) is handled by the SPI Flash write-back cache
+		retVal = SPI_Flash_write(FLASH_ADDRESS_OFFSET + flashWritePos, (uint8_t *)channelBuf, CODEPLUG_CHANNEL_DATA_STRUCT_SIZE);
 	}
 
-errorExit:
 #if defined(PLATFORM_MD9600)
 	if (outOfBandFlag)
 	{
@@ -844,26 +926,40 @@ int codeplugContactGetDataForNumberInType(int number, uint32_t callType, struct_
 }
 
 // optionalTS: 0 = no TS checking, 1..2 = TS
+// Note: the returned value (and 'number') is a position in the TG/PC ordered cache, not a contact index
 int codeplugContactIndexByTGorPCFromNumber(int number, uint32_t tgorpc, uint32_t callType, struct_codeplugContact_t *contact, uint8_t optionalTS)
 {
 	int numContacts = codeplugContactsCache.numTGContacts + codeplugContactsCache.numALLContacts + codeplugContactsCache.numPCContacts;
 	int firstMatch = -1;
+	int i = codeplugContactsCacheFindFirstTGorPC(tgorpc);
+
+	if (i < number)
+	{
+		i = number;
+	}
 
-	for (int i = number; i < numContacts; i++)
+	// All the contacts sharing this TG/PC number are contiguous, ordered by index
+	for (; i < numContacts; i++)
 	{
-		if (((codeplugContactsCache.contactsLookupCache[i].tgOrPCNum & 0xFFFFFF) == tgorpc) &&
-				/* All Call, hence ignore callType */
-				((tgorpc == ALL_CALL_VALUE) || ((codeplugContactsCache.contactsLookupCache[i].tgOrPCNum >> 24) == callType)))
+		codeplugContactCache_t *entry = &codeplugContactsCache.contactsLookupCache[codeplugContactsCache.contactsLookupCache[i].sortedByTGorPC];
+
+		if ((entry->tgOrPCNum & 0xFFFFFF) != tgorpc)
+		{
+			break;
+		}
+
+		/* All Call, hence ignore callType */
+		if ((tgorpc == ALL_CALL_VALUE) || ((entry->tgOrPCNum >> 24) == callType))
 		{
 			// Check for the contact TS override
 			if (optionalTS > 0)
 			{
 				// Just read the reserve1 byte for now
-				codeplugContactGetReserve1ByteForIndex(codeplugContactsCache.contactsLookupCache[i].index, contact);
+				codeplugContactGetReserve1ByteForIndex(entry->index, contact);
 
 				if (((contact->reserve1 & CODEPLUG_CONTACT_FLAG_NO_TS_OVERRIDE) == 0x00) && (((contact->reserve1 & CODEPLUG_CONTACT_FLAG_TS_OVERRIDE_TIMESLOT_MASK) >> 1) == (optionalTS - 1)))
 				{
-					codeplugContactGetDataForIndex(codeplugContactsCache.contactsLookupCache[i].index, contact);
+					codeplugContactGetDataForIndex(entry->index, contact);
 					return i;
 				}
 				else
@@ -876,7 +972,7 @@ int codeplugContactIndexByTGorPCFromNumber(int number, uint32_t tgorpc, uint32_t
 			}
 			else
 			{
-				codeplugContactGetDataForIndex(codeplugContactsCache.contactsLookupCache[i].index, contact);
+				codeplugContactGetDataForIndex(entry->index, contact);
 				return i;
 			}
 		}
@@ -884,7 +980,7 @@ int codeplugContactIndexByTGorPCFromNumber(int number, uint32_t tgorpc, uint32_t
 
 	if (firstMatch >= 0)
 	{
-		codeplugContactGetDataForIndex(codeplugContactsCache.contactsLookupCache[firstMatch].index, contact);
+		codeplugContactGetDataForIndex(codeplugContactsCache.contactsLookupCache[codeplugContactsCache.contactsLookupCache[firstMatch].sortedByTGorPC].index, contact);
 		return firstMatch;
 	}
 
@@ -901,11 +997,17 @@ bool codeplugContactsContainsPC(uint32_t pc)
 {
 	int numContacts =  codeplugContactsCache.numTGContacts + codeplugContactsCache.numALLContacts + codeplugContactsCache.numPCContacts;
 	pc = pc & 0x00FFFFFF;
-	pc = pc | (CONTACT_CALLTYPE_PC << 24);
 
-	for (int i = 0; i < numContacts; i++)
+	for (int i = codeplugContactsCacheFindFirstTGorPC(pc); i < numContacts; i++)
 	{
-		if (codeplugContactsCache.contactsLookupCache[i].tgOrPCNum == pc)
+		uint32_t tgOrPCNum = codeplugContactsCache.contactsLookupCache[codeplugContactsCache.contactsLookupCache[i].sortedByTGorPC].tgOrPCNum;
+
+		if ((tgOrPCNum & 0xFFFFFF) != pc)
+		{
+			break;
+		}
+
+		if ((tgOrPCNum >> 24) == CONTACT_CALLTYPE_PC)
 		{
 			return true;
 		}
@@ -913,22 +1015,121 @@ bool codeplugContactsContainsPC(uint32_t pc)
 	return false;
 }
 
-static void codeplugInitContactsCache(void)
+// Compares the contacts at the positions a and b of the TG/PC ordering
+static inline bool codeplugContactsCacheIsLower(int a, int b)
+{
+	codeplugContactCache_t *contactA = &codeplugContactsCache.contactsLookupCache[codeplugContactsCache.contactsLookupCache[a].sortedByTGorPC];
+	codeplugContactCache_t *contactB = &codeplugContactsCache.contactsLookupCache[codeplugContactsCache.contactsLookupCache[b].sortedByTGorPC];
+	uint32_t idA = (contactA->tgOrPCNum & 0xFFFFFF);
+	uint32_t idB = (contactB->tgOrPCNum & 0xFFFFFF);
+
+	return ((idA < idB) || ((idA == idB) && (contactA->index < contactB->index)));
+}
+
+static void codeplugContactsCacheSiftDown(int root, int end)
+{
+	int child;
+
+	while ((child = ((root << 1) + 1)) < end)
+	{
+		if (((child + 1) < end) && codeplugContactsCacheIsLower(child, (child + 1)))
+		{
+			child++;
+		}
+
+		if (codeplugContactsCacheIsLower(root, child) == false)
+		{
+			return;
+		}
+
+		SAFE_SWAP(codeplugContactsCache.contactsLookupCache[root].sortedByTGorPC, codeplugContactsCache.contactsLookupCache[child].sortedByTGorPC);
+		root = child;
+	}
+}
+
+// Rebuilds the TG/PC ordering. Heap sort is used as it's in place, with a bounded run time.
+static void codeplugContactsCacheSortByTGorPC(void)
+{
+	int numContacts = codeplugContactsCache.numTGContacts + codeplugContactsCache.numALLContacts + codeplugContactsCache.numPCContacts;
+
+	for (int i = 0; i < numContacts; i++)
+	{
+		codeplugContactsCache.contactsLookupCache[i].sortedByTGorPC = i;
+	}
+
+	for (int i = ((numContacts >> 1) - 1); i >= 0; i--)
+	{
+		codeplugContactsCacheSiftDown(i, numContacts);
+	}
+
+	for (int end = (numContacts - 1); end > 0; end--)
+	{
+		SAFE_SWAP(codeplugContactsCache.contactsLookupCache[0].sortedByTGorPC, codeplugContactsCache.contactsLookupCache[end].sortedByTGorPC);
+		codeplugContactsCacheSiftDown(0, end);
+	}
+}
+
+// Returns the first position, in the TG/PC ordering, whose TG/PC number is not lower than tgorpc
+static int codeplugContactsCacheFindFirstTGorPC(uint32_t tgorpc)
+{
+	int low = 0;
+	int high = codeplugContactsCache.numTGContacts + codeplugContactsCache.numALLContacts + codeplugContactsCache.numPCContacts;
+
+	while (low < high)
+	{
+		int mid = ((low + high) >> 1);
+
+		if ((codeplugContactsCache.contactsLookupCache[codeplugContactsCache.contactsLookupCache[mid].sortedByTGorPC].tgOrPCNum & 0xFFFFFF) < tgorpc)
+		{
+			low = mid + 1;
+		}
+		else
+		{
+			high = mid;
+		}
+	}
+
+	return low;
+}
+
+// Number of whole contacts read from the Flash at once, in SPI_Flash_sectorbuffer
+#define CODEPLUG_CONTACTS_PER_CHUNK  (sizeof(SPI_Flash_sectorbuffer) / CODEPLUG_CONTACT_DATA_SIZE)
+
+void codeplugInitContactsCache(void)
 {
 	struct_codeplugContact_t contact;
 	uint8_t                  c;
 	int                      codeplugNumContacts = 0;
+#if defined(USING_EXTERNAL_DEBUGGER)
+	uint32_t                 startTime = ticksGetMillis();
+#endif
 
 	codeplugContactsCache.numTGContacts = 0;
 	codeplugContactsCache.numPCContacts = 0;
 	codeplugContactsCache.numALLContacts = 0;
 	codeplugContactsCache.numDTMFContacts = 0;
 
-	for(int i = 0; i < CODEPLUG_CONTACTS_MAX; i++)
+	// Stream the contacts table in large chunks, instead of one read per contact, using the sector buffer as scratch
+	for (int chunkStart = 0; chunkStart < CODEPLUG_CONTACTS_MAX; chunkStart += CODEPLUG_CONTACTS_PER_CHUNK)
 	{
-		if (SPI_Flash_read(FLASH_ADDRESS_OFFSET + (CODEPLUG_ADDR_CONTACTS + (i * CODEPLUG_CONTACT_DATA_SIZE)), (uint8_t *)&contact, 16 + 4 + 1))// Name + TG/ID + Call type
+		int chunkLength = MIN(CODEPLUG_CONTACTS_PER_CHUNK, (CODEPLUG_CONTACTS_MAX - chunkStart));
+
+		bool chunkRead = SPI_Flash_readWithPriority(FLASH_ADDRESS_OFFSET + (CODEPLUG_ADDR_CONTACTS + (chunkStart * CODEPLUG_CONTACT_DATA_SIZE)), SPI_Flash_sectorbuffer,
+				(chunkLength * CODEPLUG_CONTACT_DATA_SIZE), SPI_FLASH_PRIORITY_BULK);
+
+		for (int i = chunkStart; i < (chunkStart + chunkLength); i++)
 		{
-			if (contact.name[0] != 0xFF)
+			if (chunkRead)
+			{
+				memcpy((uint8_t *)&contact, &SPI_Flash_sectorbuffer[(i - chunkStart) * CODEPLUG_CONTACT_DATA_SIZE], 16 + 4 + 1);// Name + TG/ID + Call type
+			}
+			else if (SPI_Flash_read(FLASH_ADDRESS_OFFSET + (CODEPLUG_ADDR_CONTACTS + (i * CODEPLUG_CONTACT_DATA_SIZE)), (uint8_t *)&contact, 16 + 4 + 1) == false)
+			{
+				// The chunk read failed, fall back to a read per contact, so only the unreadable ones are dropped
+				continue;
+			}
+
+			if (contact.name[0] != 0xFF) // 0xFF: empty slot
 			{
 				codeplugContactsCache.contactsLookupCache[codeplugNumContacts].tgOrPCNum = bcd2int(byteSwap32(contact.tgNumber));
 				codeplugContactsCache.contactsLookupCache[codeplugNumContacts].index = i + 1;// Contacts are numbered from 1 to 1024
@@ -951,6 +1152,12 @@ static void codeplugInitContactsCache(void)
 		}
 	}
 
+	codeplugContactsCacheSortByTGorPC();
+
+#if defined(USING_EXTERNAL_DEBUGGER)
+	SEGGER_RTT_printf(0, "Contacts cache: %d contacts in %u ms\n", codeplugNumContacts, (ticksGetMillis() - startTime));
+#endif
+
 	for (int i = 0; i < CODEPLUG_DTMF_CONTACTS_MAX; i++)
 	{
 		if (EEPROM_Read(CODEPLUG_ADDR_DTMF_CONTACTS + (i * CODEPLUG_DTMF_CONTACT_DATA_STRUCT_SIZE), (uint8_t *)&c, 1))
@@ -965,7 +1172,7 @@ static void codeplugInitContactsCache(void)
 	}
 }
 
-void codeplugContactsCacheUpdateOrInsertContactAt(int index, struct_codeplugContact_t *contact)
+static void codeplugContactsCacheUpdateOrInsertContactAtIndex(int index, struct_codeplugContact_t *contact)
 {
 	int numContacts =  codeplugContactsCache.numTGContacts + codeplugContactsCache.numALLContacts + codeplugContactsCache.numPCContacts;
 	int numContactsMinus1 = numContacts - 1;
@@ -1013,7 +1220,18 @@ void codeplugContactsCacheUpdateOrInsertContactAt(int index, struct_codeplugCont
 		}
 		else
 		{
-			if((i < numContactsMinus1) && (codeplugContactsCache.contactsLookupCache[i].index < index) && (codeplugContactsCache.contactsLookupCache[i + 1].index > index))
+			int insertAt = -1;
+
+			if ((i == 0) && (index < codeplugContactsCache.contactsLookupCache[0].index))
+			{
+				insertAt = 0; // Lower than any cached index, it has to go first to keep the cache ordered by index
+			}
+			else if((i < numContactsMinus1) && (codeplugContactsCache.contactsLookupCache[i].index < index) && (codeplugContactsCache.contactsLookupCache[i + 1].index > index))
+			{
+				insertAt = i + 1;
+			}
+
+			if (insertAt >= 0)
 			{
 				if (contact->callType == CONTACT_CALLTYPE_PC)
 				{
@@ -1028,14 +1246,12 @@ void codeplugContactsCacheUpdateOrInsertContactAt(int index, struct_codeplugCont
 					codeplugContactsCache.numALLContacts++;
 				}
 
-				numContacts++;// Total contacts increases by 1
-
 				// Note . Need to use memmove as the source and destination overlap.
-				memmove(&codeplugContactsCache.contactsLookupCache[i + 2], &codeplugContactsCache.contactsLookupCache[i + 1], (numContacts - 2 - i) * sizeof(codeplugContactCache_t));
+				memmove(&codeplugContactsCache.contactsLookupCache[insertAt + 1], &codeplugContactsCache.contactsLookupCache[insertAt], (numContacts - insertAt) * sizeof(codeplugContactCache_t));
 
-				codeplugContactsCache.contactsLookupCache[i + 1].tgOrPCNum = bcd2int(byteSwap32(contact->tgNumber));
-				codeplugContactsCache.contactsLookupCache[i + 1].index = index;// Contacts are numbered from 1 to 1024
-				codeplugContactsCache.contactsLookupCache[i + 1].tgOrPCNum |= (contact->callType << 24);// Store the call type in the upper byte
+				codeplugContactsCache.contactsLookupCache[insertAt].tgOrPCNum = bcd2int(byteSwap32(contact->tgNumber));
+				codeplugContactsCache.contactsLookupCache[insertAt].index = index;// Contacts are numbered from 1 to 1024
+				codeplugContactsCache.contactsLookupCache[insertAt].tgOrPCNum |= (contact->callType << 24);// Store the call type in the upper byte
 				return;
 			}
 		}
@@ -1063,6 +1279,12 @@ void codeplugContactsCacheUpdateOrInsertContactAt(int index, struct_codeplugCont
 	codeplugContactsCache.contactsLookupCache[numContacts].tgOrPCNum |= (contact->callType << 24);// Store the call type in the upper byte
 }
 
+void codeplugContactsCacheUpdateOrInsertContactAt(int index, struct_codeplugContact_t *contact)
+{
+	codeplugContactsCacheUpdateOrInsertContactAtIndex(index, contact);
+	codeplugContactsCacheSortByTGorPC();
+}
+
 void codeplugContactsCacheRemoveContactAt(int index)
 {
 	int numContacts = codeplugContactsCache.numTGContacts + codeplugContactsCache.numALLContacts + codeplugContactsCache.numPCContacts;
@@ -1086,6 +1308,7 @@ void codeplugContactsCacheRemoveContactAt(int index)
 			}
 			// Note memcpy should work here, because memcpy normally copys from the lowest memory location upwards
 			memcpy(&codeplugContactsCache.contactsLookupCache[i], &codeplugContactsCache.contactsLookupCache[i + 1], (numContacts - 1 - i) * sizeof(codeplugContactCache_t));
+			codeplugContactsCacheSortByTGorPC();
 			return;
 		}
 	}
@@ -1174,9 +1397,6 @@ int codeplugContactSaveDataForIndex(int index, struct_codeplugContact_t *contact
 {
 	int retVal;
 	int flashWritePos = CODEPLUG_ADDR_CONTACTS;
-	int flashSector;
-	int flashEndSector;
-	int bytesToWriteInCurrentSector = CODEPLUG_CONTACT_DATA_SIZE;
 	uint32_t unconvertedTgNumber = contact->tgNumber;
 
 	index--;
@@ -1184,59 +1404,13 @@ int codeplugContactSaveDataForIndex(int index, struct_codeplugContact_t *contact
 
 	flashWritePos += index * CODEPLUG_CONTACT_DATA_SIZE;// go to the position of the specific index
 
-	flashSector 	= flashWritePos / 4096;
-	flashEndSector 	= (flashWritePos + CODEPLUG_CONTACT_DATA_SIZE) / 4096;
-
-	if (flashSector != flashEndSector)
-	{
-		bytesToWriteInCurrentSector = (flashEndSector * 4096) - flashWritePos;
-	}
-
-	SPI_Flash_read(FLASH_ADDRESS_OFFSET + (flashSector * 4096), SPI_Flash_sectorbuffer, 4096);
-	uint8_t *writePos = SPI_Flash_sectorbuffer + flashWritePos - (flashSector * 4096);
-	memcpy(writePos, contact, bytesToWriteInCurrentSector);
-
-	retVal = SPI_Flash_eraseSector(FLASH_ADDRESS_OFFSET + (flashSector * 4096));
+	// Sector read/erase/program (also across sector boundaries) is handled by the SPI Flash write-back cache
+	retVal = SPI_Flash_write(FLASH_ADDRESS_OFFSET + flashWritePos, (uint8_t *)contact, CODEPLUG_CONTACT_DATA_SIZE);
 	if (!retVal)
 	{
 		goto hasFailed;
 	}
 
-	for (int i = 0; i < 16; i++)
-	{
-		retVal = SPI_Flash_writePage(FLASH_ADDRESS_OFFSET + (flashSector * 4096) + (i * 256), SPI_Flash_sectorbuffer + (i * 256));
-		if (!retVal)
-		{
-			goto hasFailed;
-		}
-	}
-
-	if (flashSector != flashEndSector)
-	{
-		uint8_t *channelBufPusOffset = (uint8_t *)contact + bytesToWriteInCurrentSector;
-		bytesToWriteInCurrentSector = CODEPLUG_CONTACT_DATA_SIZE - bytesToWriteInCurrentSector;
-
-		SPI_Flash_read(FLASH_ADDRESS_OFFSET + (flashEndSector * 4096), SPI_Flash_sectorbuffer, 4096);
-		memcpy(SPI_Flash_sectorbuffer, (uint8_t *)channelBufPusOffset, bytesToWriteInCurrentSector);
-
-		retVal = SPI_Flash_eraseSector(FLASH_ADDRESS_OFFSET + (flashEndSector * 4096));
-
-		if (!retVal)
-		{
-			goto hasFailed;
-		}
-
-		for (int i = 0; i < 16; i++)
-		{
-			retVal = SPI_Flash_writePage(FLASH_ADDRESS_OFFSET + (flashEndSector * 4096) + (i * 256), SPI_Flash_sectorbuffer + (i * 256));
-
-			if (!retVal)
-			{
-				goto hasFailed;
-			}
-		}
-
-	}
 	if ((contact->name[0] == 0xff) || (contact->callType == 0xFF))
 	{
 		codeplugContactsCacheRemoveContactAt(index + 1);// index was decremented at the start of the function
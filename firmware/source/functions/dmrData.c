@@ -0,0 +1,426 @@
+/*
+ * Copyright (C) 2024 Roger Clark, VK3KYY / G4KYF
+ *                    Daniel Caujolle-Bert, F1RMB
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+ *    in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. Use of this source code or binary releases for commercial purposes is strictly forbidden. This includes, without limitation,
+ *    incorporation in a commercial product or incorporation into a product or project which allows commercial use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <string.h>
+#include "functions/dmrData.h"
+
+#define DMR_DATA_FORMAT_UNCONFIRMED              0x02U
+#define DMR_DATA_FORMAT_CONFIRMED                0x03U
+#define DMR_DATA_FORMAT_DEFINED_SHORT_DATA       0x0DU
+#define DMR_DATA_FORMAT_RAW_SHORT_DATA           0x0EU
+
+#define DMR_DATA_HEADER_CRC_MASK                 0xCCCCU
+#define DMR_DATA_CRC9_MASK_RATE_12               0x0F0U
+#define DMR_DATA_CRC9_MASK_RATE_34               0x1FFU
+#define DMR_DATA_CONFIRMED_BLOCK_HEADER_LENGTH   2U // 7 bits serial number + CRC-9
+#define DMR_DATA_MESSAGE_CRC_LENGTH              4U
+
+#define DMR_DATA_TRELLIS_SYMBOLS                 49U // 48 data tribits + 1 flushing tribit
+#define DMR_DATA_TRELLIS_STATES                  8U
+#define DMR_DATA_LANES_LSB                       0x01010101U
+#define DMR_DATA_LANES_MSB                       0x80808080U
+
+// Rate 3/4 trellis, ETSI TS 102 361-1 Annex B.2.
+// Received dibit index of each deinterleaved dibit (98 dibits, 2 per constellation point).
+static const uint8_t TRELLIS_DIBIT_INDEXES[(DMR_DATA_TRELLIS_SYMBOLS * 2U)] = {
+		 0,  1, 26, 27, 50, 51, 74, 75,  2,  3, 28, 29, 52, 53, 76, 77,  4,  5, 30, 31, 54, 55, 78, 79,
+		 6,  7, 32, 33, 56, 57, 80, 81,  8,  9, 34, 35, 58, 59, 82, 83, 10, 11, 36, 37, 60, 61, 84, 85,
+		12, 13, 38, 39, 62, 63, 86, 87, 14, 15, 40, 41, 64, 65, 88, 89, 16, 17, 42, 43, 66, 67, 90, 91,
+		18, 19, 44, 45, 68, 69, 92, 93, 20, 21, 46, 47, 70, 71, 94, 95, 22, 23, 48, 49, 72, 73, 96, 97,
+		24, 25
+};
+
+// Constellation point sent for each (state, tribit) transition, as its two channel dibits (4 bits, +3 = 01, +1 = 00, -1 = 10, -3 = 11).
+// The next state is the tribit. The 8 tribits of a state are packed as byte lanes: [0] holds tribits 0..3, [1] tribits 4..7.
+static const uint32_t TRELLIS_TRANSITION_POINTS[DMR_DATA_TRELLIS_STATES][2] = {
+		{ 0x010E0D02U, 0x040B0807U },
+		{ 0x0807010EU, 0x0D02040BU },
+		{ 0x0906050AU, 0x0C03000FU },
+		{ 0x000F0906U, 0x050A0C03U },
+		{ 0x0C03000FU, 0x0906050AU },
+		{ 0x050A0C03U, 0x000F0906U },
+		{ 0x040B0807U, 0x010E0D02U },
+		{ 0x0D02040BU, 0x0807010EU }
+};
+
+// Nibble tables: CRC-CCITT (x^16 + x^12 + x^5 + 1), CRC-9 (x^9 + x^6 + x^4 + x^3 + 1) and reflected CRC-32 (0x04C11DB7)
+static const uint16_t CRC_CCITT_TABLE[16] = {
+		0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7, 0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+static const uint16_t CRC9_TABLE[16] = {
+		0x000, 0x059, 0x0B2, 0x0EB, 0x164, 0x13D, 0x1D6, 0x18F, 0x091, 0x0C8, 0x023, 0x07A, 0x1F5, 0x1AC, 0x147, 0x11E
+};
+
+static const uint32_t CRC32_TABLE[16] = {
+		0x00000000U, 0x1DB71064U, 0x3B6E20C8U, 0x26D930ACU, 0x76DC4190U, 0x6B6B51F4U, 0x4DB26158U, 0x5005713CU,
+		0xEDB88320U, 0xF00F9344U, 0xD6D6A3E8U, 0xCB61B38CU, 0x9B64C2B0U, 0x86D3D2D4U, 0xA00AE278U, 0xBDBDF21CU
+};
+
+static struct
+{
+	bool     hasHeader;
+	bool     isConfirmed;
+	bool     isComplete;
+	uint8_t  blocksToFollow;
+	uint8_t  blocksReceived;
+	uint8_t  padLength;
+	uint16_t length;
+} dmrDataReassembly;
+
+static dmrDataMessage_t dmrDataMessage;
+
+
+static inline uint32_t dmrDataTrellisGetDibit(const uint8_t *frame, uint8_t index)
+{
+	uint32_t position = (index * 2U);
+
+	// Skip the SYNC (or EMB) and the slot type, in the middle of the burst
+	if (position >= 98U)
+	{
+		position += 68U;
+	}
+
+	return ((frame[position >> 3] >> (6U - (position & 0x07U))) & 0x03U);
+}
+
+// Number of bits set in each byte lane (4-bit values)
+static inline uint32_t dmrDataLanesBitCount(uint32_t lanes)
+{
+	lanes = (lanes & 0x05050505U) + ((lanes >> 1) & 0x05050505U);
+
+	return ((lanes & 0x03030303U) + ((lanes >> 2) & 0x03030303U));
+}
+
+// Keeps, in each byte lane, the lowest metric and its predecessor state. Metrics are 7-bit values,
+// so the lane MSB of (best | 0x80) - candidate is set when best >= candidate, without any borrow between lanes.
+static inline void dmrDataLanesSelectMinimum(uint32_t *best, uint32_t *predecessors, uint32_t candidate, uint32_t predecessor)
+{
+	uint32_t mask = (((((*best | DMR_DATA_LANES_MSB) - candidate) & DMR_DATA_LANES_MSB) >> 7) * 0xFFU);
+
+	*best = ((*best & ~mask) | (candidate & mask));
+	*predecessors = ((*predecessors & ~mask) | (predecessor & mask));
+}
+
+//
+// Hard decision Viterbi decoder of a rate 3/4 data block.
+// frame: 33 bytes burst, payload: 18 bytes
+//
+// The path metrics of the 8 states are handled in byte lanes, hence all the transitions leaving one state are added,
+// compared and selected at once. The survivors of each step are packed as nibbles in one word.
+// Returns the number of channel bits that disagree with the decoded path.
+//
+uint8_t dmrDataTrellisDecode(const uint8_t *frame, uint8_t *payload)
+{
+	static uint32_t survivors[DMR_DATA_TRELLIS_SYMBOLS];
+	uint8_t metrics[DMR_DATA_TRELLIS_STATES] = { 0U, 64U, 64U, 64U, 64U, 64U, 64U, 64U }; // The encoder starts in state 0
+	uint32_t bitErrors = 0U;
+	uint8_t state;
+
+	for (uint8_t symbol = 0U; symbol < DMR_DATA_TRELLIS_SYMBOLS; symbol++)
+	{
+		uint32_t received = (((dmrDataTrellisGetDibit(frame, TRELLIS_DIBIT_INDEXES[symbol * 2U]) << 2) |
+				dmrDataTrellisGetDibit(frame, TRELLIS_DIBIT_INDEXES[(symbol * 2U) + 1U])) * DMR_DATA_LANES_LSB);
+		uint32_t bestLow = 0x7F7F7F7FU;
+		uint32_t bestHigh = 0x7F7F7F7FU;
+		uint32_t predecessorsLow = 0U;
+		uint32_t predecessorsHigh = 0U;
+		uint8_t minMetric = metrics[0];
+
+		for (uint8_t s = 1U; s < DMR_DATA_TRELLIS_STATES; s++)
+		{
+			if (metrics[s] < minMetric)
+			{
+				minMetric = metrics[s];
+			}
+		}
+
+		for (uint8_t s = 0U; s < DMR_DATA_TRELLIS_STATES; s++)
+		{
+			uint32_t metric = ((metrics[s] - minMetric) * DMR_DATA_LANES_LSB);
+			uint32_t predecessor = (s * DMR_DATA_LANES_LSB);
+
+			dmrDataLanesSelectMinimum(&bestLow, &predecessorsLow, (metric + dmrDataLanesBitCount(received ^ TRELLIS_TRANSITION_POINTS[s][0])), predecessor);
+			dmrDataLanesSelectMinimum(&bestHigh, &predecessorsHigh, (metric + dmrDataLanesBitCount(received ^ TRELLIS_TRANSITION_POINTS[s][1])), predecessor);
+		}
+
+		bitErrors += minMetric;
+		survivors[symbol] = (predecessorsLow | (predecessorsHigh << 4));
+
+		for (uint8_t t = 0U; t < 4U; t++)
+		{
+			metrics[t] = ((bestLow >> (t * 8U)) & 0xFFU);
+			metrics[t + 4U] = ((bestHigh >> (t * 8U)) & 0xFFU);
+		}
+	}
+
+	bitErrors += metrics[0];
+
+	// Trace back from state 0, as the last (flushing) tribit is 0.
+	// The state reached after each step is the tribit sent on this step.
+	memset(payload, 0, DMR_DATA_RATE_34_BLOCK_LENGTH);
+	state = 0U;
+
+	for (uint8_t symbol = (DMR_DATA_TRELLIS_SYMBOLS - 1U); symbol > 0U; symbol--)
+	{
+		uint32_t lane = ((survivors[symbol] >> ((state & 0x03U) * 8U)) & 0xFFU);
+		uint32_t position = ((symbol - 1U) * 3U);
+
+		state = ((state < 4U) ? (lane & 0x0FU) : (lane >> 4));
+
+		for (uint8_t bit = 0U; bit < 3U; bit++, position++)
+		{
+			if (state & (0x04U >> bit))
+			{
+				payload[position >> 3] |= (0x80U >> (position & 0x07U));
+			}
+		}
+	}
+
+	return ((bitErrors > 0xFFU) ? 0xFFU : bitErrors);
+}
+
+static uint16_t dmrDataCRC16CCITT(const uint8_t *data, uint8_t length)
+{
+	uint16_t crc = 0U;
+
+	for (uint8_t i = 0U; i < length; i++)
+	{
+		crc = ((crc << 4) ^ CRC_CCITT_TABLE[((crc >> 12) ^ (data[i] >> 4)) & 0x0FU]);
+		crc = ((crc << 4) ^ CRC_CCITT_TABLE[((crc >> 12) ^ data[i]) & 0x0FU]);
+	}
+
+	return crc;
+}
+
+// The data octets are processed by pairs, least significant octet first (length is always even),
+// followed by the 7 bits of the block serial number.
+static uint16_t dmrDataCRC9(const uint8_t *data, uint8_t length, uint8_t serialNumber)
+{
+	uint16_t crc = 0U;
+
+	for (uint8_t i = 0U; i < length; i++)
+	{
+		uint8_t octet = data[i ^ 1U];
+
+		crc = (((crc << 4) & 0x1FFU) ^ CRC9_TABLE[((crc >> 5) ^ (octet >> 4)) & 0x0FU]);
+		crc = (((crc << 4) & 0x1FFU) ^ CRC9_TABLE[((crc >> 5) ^ octet) & 0x0FU]);
+	}
+
+	for (int8_t bit = 6; bit >= 0; bit--)
+	{
+		bool feedback = ((((crc >> 8) ^ (serialNumber >> bit)) & 0x01U) != 0U);
+
+		crc = ((crc << 1) & 0x1FFU);
+
+		if (feedback)
+		{
+			crc ^= CRC9_TABLE[1];
+		}
+	}
+
+	return crc;
+}
+
+// Message CRC-32, the octets are processed by pairs, least significant octet first (length is always even).
+static uint32_t dmrDataCRC32(const uint8_t *data, uint16_t length)
+{
+	uint32_t crc = 0U;
+
+	for (uint16_t i = 0U; i < length; i++)
+	{
+		uint8_t octet = data[i ^ 1U];
+
+		crc = ((crc >> 4) ^ CRC32_TABLE[(crc ^ octet) & 0x0FU]);
+		crc = ((crc >> 4) ^ CRC32_TABLE[(crc ^ (octet >> 4)) & 0x0FU]);
+	}
+
+	return crc;
+}
+
+void dmrDataReset(void)
+{
+	memset(&dmrDataReassembly, 0, sizeof(dmrDataReassembly));
+}
+
+//
+// header: BPTC decoded data header (12 bytes)
+//
+dmrDataResult_t dmrDataAddHeader(const uint8_t *header)
+{
+	uint16_t crc = (uint16_t)(~dmrDataCRC16CCITT(header, (DMR_DATA_HEADER_LENGTH - 2U)) ^ DMR_DATA_HEADER_CRC_MASK);
+	uint8_t format = (header[0] & 0x0FU);
+
+	dmrDataReset();
+
+	if ((((header[10] << 8) | header[11]) != crc))
+	{
+		return DMR_DATA_RESULT_ERROR;
+	}
+
+	switch (format)
+	{
+		case DMR_DATA_FORMAT_UNCONFIRMED:
+		case DMR_DATA_FORMAT_CONFIRMED:
+			dmrDataReassembly.blocksToFollow = (header[8] & 0x7FU);
+			dmrDataReassembly.padLength = ((header[0] & 0x10U) | (header[1] & 0x0FU)); // pad octets
+			break;
+
+		case DMR_DATA_FORMAT_DEFINED_SHORT_DATA:
+		case DMR_DATA_FORMAT_RAW_SHORT_DATA:
+			dmrDataReassembly.blocksToFollow = ((header[0] & 0x30U) | (header[1] & 0x0FU)); // appended blocks
+			dmrDataReassembly.padLength = (header[9] >> 3); // pad octets
+			break;
+
+		default: // responses and proprietary data aren't handled
+			return DMR_DATA_RESULT_ERROR;
+	}
+
+	if ((dmrDataReassembly.blocksToFollow == 0U) || (dmrDataReassembly.blocksToFollow > DMR_DATA_MESSAGE_MAX_BLOCKS))
+	{
+		return DMR_DATA_RESULT_ERROR;
+	}
+
+	dmrDataReassembly.isConfirmed = (format == DMR_DATA_FORMAT_CONFIRMED);
+	dmrDataReassembly.hasHeader = true;
+
+	dmrDataMessage.isGroup = ((header[0] & 0x80U) != 0U);
+	dmrDataMessage.format = format;
+	dmrDataMessage.SAP = (header[1] >> 4);
+	dmrDataMessage.dstId = ((header[2] << 16) | (header[3] << 8) | header[4]);
+	dmrDataMessage.srcId = ((header[5] << 16) | (header[6] << 8) | header[7]);
+	dmrDataMessage.length = 0U;
+
+	return DMR_DATA_RESULT_IN_PROGRESS;
+}
+
+//
+// block: decoded rate 1/2 (12 bytes) or rate 3/4 (18 bytes) data block.
+// Blocks are expected in sequence, confirmed data retries aren't handled.
+//
+dmrDataResult_t dmrDataAddBlock(const uint8_t *block, uint8_t blockLength)
+{
+	uint8_t offset = 0U;
+	uint8_t dataLength;
+	uint16_t crcLength;
+	uint32_t crc;
+
+	if (dmrDataReassembly.hasHeader == false)
+	{
+		return DMR_DATA_RESULT_ERROR;
+	}
+
+	if (dmrDataReassembly.isConfirmed)
+	{
+		uint16_t mask = ((blockLength == DMR_DATA_RATE_34_BLOCK_LENGTH) ? DMR_DATA_CRC9_MASK_RATE_34 : DMR_DATA_CRC9_MASK_RATE_12);
+
+		offset = DMR_DATA_CONFIRMED_BLOCK_HEADER_LENGTH;
+		crc = ((~dmrDataCRC9(&block[offset], (blockLength - offset), (block[0] >> 1)) ^ mask) & 0x1FFU);
+
+		if ((((block[0] & 0x01U) << 8) | block[1]) != crc)
+		{
+			dmrDataReset();
+			return DMR_DATA_RESULT_ERROR;
+		}
+	}
+
+	dataLength = (blockLength - offset);
+
+	if ((dmrDataReassembly.length + dataLength) > DMR_DATA_MESSAGE_MAX_LENGTH)
+	{
+		dmrDataReset();
+		return DMR_DATA_RESULT_ERROR;
+	}
+
+	memcpy(&dmrDataMessage.data[dmrDataReassembly.length], &block[offset], dataLength);
+	dmrDataReassembly.length += dataLength;
+	dmrDataReassembly.blocksReceived++;
+
+	if (dmrDataReassembly.blocksReceived < dmrDataReassembly.blocksToFollow)
+	{
+		return DMR_DATA_RESULT_IN_PROGRESS;
+	}
+
+	dmrDataReassembly.hasHeader = false;
+
+	// The last block ends with the message CRC-32, least significant octet first
+	if (dmrDataReassembly.length < (DMR_DATA_MESSAGE_CRC_LENGTH + dmrDataReassembly.padLength))
+	{
+		return DMR_DATA_RESULT_ERROR;
+	}
+
+	crcLength = (dmrDataReassembly.length - DMR_DATA_MESSAGE_CRC_LENGTH);
+	crc = (dmrDataMessage.data[crcLength] | (dmrDataMessage.data[crcLength + 1U] << 8) |
+			(dmrDataMessage.data[crcLength + 2U] << 16) | ((uint32_t)dmrDataMessage.data[crcLength + 3U] << 24));
+
+	if (dmrDataCRC32(dmrDataMessage.data, crcLength) != crc)
+	{
+		return DMR_DATA_RESULT_ERROR;
+	}
+
+	dmrDataMessage.length = (crcLength - dmrDataReassembly.padLength);
+	dmrDataReassembly.isComplete = true;
+
+	return DMR_DATA_RESULT_MESSAGE_COMPLETE;
+}
+
+// Last complete message, or NULL
+const dmrDataMessage_t *dmrDataGetMessage(void)
+{
+	return (dmrDataReassembly.isComplete ? &dmrDataMessage : NULL);
+}
+
+//
+// Extracts the printable characters of a message, skipping the IPv4/UDP headers of IP based messages.
+// UTF-16 text (as sent by most radios) is reduced to its ASCII characters.
+//
+void dmrDataGetMessageText(const dmrDataMessage_t *message, char *text, size_t textSize)
+{
+	uint16_t i = 0U;
+	size_t length = 0U;
+
+	if (textSize == 0U)
+	{
+		return;
+	}
+
+	if ((message->SAP == DMR_DATA_SAP_IP) && (message->length > 0U) && ((message->data[0] >> 4) == 4U))
+	{
+		i = (((message->data[0] & 0x0FU) * 4U) + 8U);
+	}
+
+	for (; (i < message->length) && ((length + 1U) < textSize); i++)
+	{
+		if ((message->data[i] >= ' ') && (message->data[i] <= '~'))
+		{
+			text[length++] = message->data[i];
+		}
+	}
+
+	text[length] = 0;
+}
@@ -0,0 +1,420 @@
+/*
+ * Copyright (C) 2024 Roger Clark, VK3KYY / G4KYF
+ *                    Daniel Caujolle-Bert, F1RMB
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+ *    in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. Use of this source code or binary releases for commercial purposes is strictly forbidden. This includes, without limitation,
+ *    incorporation in a commercial product or incorporation into a product or project which allows commercial use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <string.h>
+#include "functions/dmrFEC.h"
+
+// MSB first bit stream, used to pack/unpack the FEC codewords
+typedef struct
+{
+	uint32_t accumulator;
+	uint32_t numBits;
+	uint32_t index;
+} bitStream_t;
+
+static uint32_t parity16(uint32_t value);
+static uint32_t hammingGetSyndrome(uint16_t codeword, bool is16114);
+static uint32_t CRC_encodeFiveBit(const uint8_t *in);
+static uint32_t bitStreamRead(bitStream_t *stream, const uint8_t *in, uint32_t count);
+static void bitStreamWrite(bitStream_t *stream, uint8_t *out, uint32_t value, uint32_t count);
+
+static const uint8_t BIT_MASK_TABLE[] = { 0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01 };
+
+// Codewords are stored MSB first in a uint16_t, so bit 0 of a codeword is 0x8000.
+// Parity check masks of the Hamming (15,11,3) / (16,11,4) codes, including their own check bit.
+static const uint16_t HAMMING_PARITY_CHECK_MASKS[5] = { 0xF590, 0x7AC8, 0x3D64, 0xEB22, 0xA6E1 };
+// Syndrome to error mask, 0x0000 means uncorrectable
+static const uint16_t HAMMING_15113_ERROR_MASKS[16] = {
+		0x0000, 0x0010, 0x0008, 0x0080, 0x0004, 0x0400, 0x0040, 0x1000,
+		0x0002, 0x8000, 0x0200, 0x4000, 0x0020, 0x0100, 0x0800, 0x2000
+};
+static const uint16_t HAMMING_16114_ERROR_MASKS[32] = {
+		0x0000, 0x0010, 0x0008, 0x0000, 0x0004, 0x0000, 0x0000, 0x1000,
+		0x0002, 0x0000, 0x0000, 0x4000, 0x0000, 0x0100, 0x0800, 0x0000,
+		0x0001, 0x0000, 0x0000, 0x0080, 0x0000, 0x0400, 0x0040, 0x0000,
+		0x0000, 0x8000, 0x0200, 0x0000, 0x0020, 0x0000, 0x0000, 0x2000
+};
+// Hamming (13,9,3) column syndrome to row index, 0xFF means don't use this value
+static const uint8_t HAMMING_1393_ERROR_ROWS[16] = { 0xFF, 9, 10, 6, 11, 3, 7, 1, 12, 0xFF, 4, 0xFF, 8, 5, 2, 0 };
+// BPTC (196,96) interleave: deinterleaved bit i is raw bit (i * 181) % 196
+static const uint8_t BPTC19696_INTERLEAVE[196] = {
+		0, 181, 166, 151, 136, 121, 106, 91, 76, 61, 46, 31, 16, 1,
+		182, 167, 152, 137, 122, 107, 92, 77, 62, 47, 32, 17, 2, 183,
+		168, 153, 138, 123, 108, 93, 78, 63, 48, 33, 18, 3, 184, 169,
+		154, 139, 124, 109, 94, 79, 64, 49, 34, 19, 4, 185, 170, 155,
+		140, 125, 110, 95, 80, 65, 50, 35, 20, 5, 186, 171, 156, 141,
+		126, 111, 96, 81, 66, 51, 36, 21, 6, 187, 172, 157, 142, 127,
+		112, 97, 82, 67, 52, 37, 22, 7, 188, 173, 158, 143, 128, 113,
+		98, 83, 68, 53, 38, 23, 8, 189, 174, 159, 144, 129, 114, 99,
+		84, 69, 54, 39, 24, 9, 190, 175, 160, 145, 130, 115, 100, 85,
+		70, 55, 40, 25, 10, 191, 176, 161, 146, 131, 116, 101, 86, 71,
+		56, 41, 26, 11, 192, 177, 162, 147, 132, 117, 102, 87, 72, 57,
+		42, 27, 12, 193, 178, 163, 148, 133, 118, 103, 88, 73, 58, 43,
+		28, 13, 194, 179, 164, 149, 134, 119, 104, 89, 74, 59, 44, 29,
+		14, 195, 180, 165, 150, 135, 120, 105, 90, 75, 60, 45, 30, 15
+};
+
+#define READ_BIT1(p,i)    (p[(i)>>3] & BIT_MASK_TABLE[(i)&7])
+
+// Decodes the BPTC (196,96) info bits of a 33 bytes burst into 12 payload bytes
+void dmrFECBPTC19696Decode(const uint8_t *inputData, uint8_t *outputData)
+{
+	uint8_t rawData[25];
+	uint16_t rows[13];
+	bitStream_t stream = { 0 };
+	bool stillProcessing;
+
+	// Raw bits 0..97 are at the start of the frame, 98..99 at the end of byte 20, then 100..195 from byte 21
+	memcpy(rawData, inputData, 12);
+	rawData[12] = (inputData[12] & 0xC0) | ((inputData[20] & 0x03) << 4) | (inputData[21] >> 4);
+
+	for (int i = 13; i < 24; i++)
+	{
+		rawData[i] = (inputData[i + 8] << 4) | (inputData[i + 9] >> 4);
+	}
+
+	rawData[24] = inputData[32] << 4;
+
+	// De-interleave into 13 rows of 15 bits (deinterleaved bit 0 is reserved)
+	memset(rows, 0, sizeof(rows));
+
+	for (int i = 1, row = 0, column = 0; i < 196; i++)
+	{
+		if (READ_BIT1(rawData, BPTC19696_INTERLEAVE[i]))
+		{
+			rows[row] |= (0x8000 >> column);
+		}
+
+		if (++column == 15)
+		{
+			column = 0;
+			row++;
+		}
+	}
+
+	stillProcessing = true;// Need to initially set this to true to start the for loop
+
+	for (int i = 0; ((i < 5) && stillProcessing); i++)
+	{
+		// Column syndromes, for all the 15 columns at once
+		uint16_t s0 = rows[0] ^ rows[1] ^ rows[3] ^ rows[5] ^ rows[6] ^ rows[9];
+		uint16_t s1 = rows[0] ^ rows[1] ^ rows[2] ^ rows[4] ^ rows[6] ^ rows[7] ^ rows[10];
+		uint16_t s2 = rows[0] ^ rows[1] ^ rows[2] ^ rows[3] ^ rows[5] ^ rows[7] ^ rows[8] ^ rows[11];
+		uint16_t s3 = rows[0] ^ rows[2] ^ rows[4] ^ rows[5] ^ rows[8] ^ rows[12];
+		uint16_t errorColumns = (s0 | s1 | s2 | s3);
+
+		stillProcessing = false;
+
+		while (errorColumns != 0)
+		{
+			uint16_t column = errorColumns & (~errorColumns + 1);
+			uint8_t n = ((s0 & column) ? 0x01 : 0x00) | ((s1 & column) ? 0x02 : 0x00) | ((s2 & column) ? 0x04 : 0x00) | ((s3 & column) ? 0x08 : 0x00);
+			uint8_t row = HAMMING_1393_ERROR_ROWS[n];
+
+			if (row != 0xFF)
+			{
+				rows[row] ^= column;
+				stillProcessing = true;
+			}
+
+			errorColumns &= ~column;
+		}
+
+		for (int j = 0; j < 9; j++)
+		{
+			if (dmrFECHamming15113Decode(&rows[j]))
+			{
+				stillProcessing = true;
+			}
+		}
+	}
+
+	// 8 data bits from the first row, then 11 from each of the next 8 rows
+	bitStreamWrite(&stream, outputData, (rows[0] >> 5) & 0xFF, 8);
+
+	for (int j = 1; j < 9; j++)
+	{
+		bitStreamWrite(&stream, outputData, (rows[j] >> 5), 11);
+	}
+}
+
+// Encodes 12 payload bytes into the info bits of a 33 bytes burst, the slot type and sync bits are left untouched
+void dmrFECBPTC19696Encode(const uint8_t *inputData, uint8_t *outputData)
+{
+	uint8_t rawData[25];
+	uint16_t rows[13];
+	bitStream_t stream = { 0 };
+
+	rows[0] = dmrFECHammingEncode((bitStreamRead(&stream, inputData, 8) << 5), false);
+
+	for (int j = 1; j < 9; j++)
+	{
+		rows[j] = dmrFECHammingEncode((bitStreamRead(&stream, inputData, 11) << 5), false);
+	}
+
+	// Column parities, for all the 15 columns at once
+	rows[9]  = rows[0] ^ rows[1] ^ rows[3] ^ rows[5] ^ rows[6];
+	rows[10] = rows[0] ^ rows[1] ^ rows[2] ^ rows[4] ^ rows[6] ^ rows[7];
+	rows[11] = rows[0] ^ rows[1] ^ rows[2] ^ rows[3] ^ rows[5] ^ rows[7] ^ rows[8];
+	rows[12] = rows[0] ^ rows[2] ^ rows[4] ^ rows[5] ^ rows[8];
+
+	memset(rawData, 0, sizeof(rawData));
+
+	for (int i = 1, row = 0, column = 0; i < 196; i++)
+	{
+		if (rows[row] & (0x8000 >> column))
+		{
+			uint8_t pos = BPTC19696_INTERLEAVE[i];
+
+			rawData[pos >> 3] |= BIT_MASK_TABLE[pos & 0x07];
+		}
+
+		if (++column == 15)
+		{
+			column = 0;
+			row++;
+		}
+	}
+
+	memcpy(outputData, rawData, 12);
+	outputData[12] = (outputData[12] & 0x3F) | (rawData[12] & 0xC0);
+	outputData[20] = (outputData[20] & 0xFC) | ((rawData[12] >> 4) & 0x03);
+
+	for (int i = 0; i < 12; i++)
+	{
+		outputData[i + 21] = (rawData[i + 12] << 4) | (rawData[i + 13] >> 4);
+	}
+}
+
+static uint32_t parity16(uint32_t value)
+{
+	value ^= value >> 8;
+	value ^= value >> 4;
+
+	return (0x6996 >> (value & 0x0F)) & 0x01;
+}
+
+bool dmrFECHamming15113Decode(uint16_t *codeword)
+{
+	uint16_t errorMask = HAMMING_15113_ERROR_MASKS[hammingGetSyndrome(*codeword, false)];
+
+	if (errorMask != 0)
+	{
+		*codeword ^= errorMask;
+		return true;
+	}
+
+	return false;
+}
+
+bool dmrFECHamming16114Decode(uint16_t *codeword)
+{
+	uint32_t syndrome = hammingGetSyndrome(*codeword, true);
+
+	if (syndrome == 0)
+	{
+		return true;
+	}
+
+	uint16_t errorMask = HAMMING_16114_ERROR_MASKS[syndrome];
+	if (errorMask != 0)
+	{
+		*codeword ^= errorMask;
+		return true;
+	}
+
+	return false;
+}
+
+uint16_t dmrFECHammingEncode(uint16_t codeword, bool is16114)
+{
+	uint32_t numChecks = (is16114 ? 5 : 4);
+
+	codeword &= 0xFFE0;
+
+	for (uint32_t i = 0; i < numChecks; i++)
+	{
+		if (parity16(codeword & HAMMING_PARITY_CHECK_MASKS[i]))
+		{
+			codeword |= (0x0010 >> i);
+		}
+	}
+
+	return codeword;
+}
+
+static uint32_t hammingGetSyndrome(uint16_t codeword, bool is16114)
+{
+	uint32_t numChecks = (is16114 ? 5 : 4);
+	uint32_t syndrome = 0;
+
+	for (uint32_t i = 0; i < numChecks; i++)
+	{
+		syndrome |= (parity16(codeword & HAMMING_PARITY_CHECK_MASKS[i]) << i);
+	}
+
+	return syndrome;
+}
+
+// Encodes the 9 LC bytes into the 16 raw bytes (one per matrix column) of the embedded signalling
+void dmrFECEmbeddedDataEncode(const uint8_t *lcData, uint8_t *rawData)
+{
+	uint16_t rows[8];
+	bitStream_t stream = { 0 };
+	uint32_t crc = CRC_encodeFiveBit(lcData);
+
+	rows[0] = (bitStreamRead(&stream, lcData, 11) << 5);
+	rows[1] = (bitStreamRead(&stream, lcData, 11) << 5);
+
+	// Next 5 rows have 10 data bits, followed by one CRC bit (MSB first)
+	for (int i = 2; i < 7; i++)
+	{
+		rows[i] = (bitStreamRead(&stream, lcData, 10) << 6) | (((crc >> (6 - i)) & 0x01) << 5);
+	}
+
+	rows[7] = 0;
+	for (int i = 0; i < 7; i++)
+	{
+		rows[i] = dmrFECHammingEncode(rows[i], true);
+		rows[7] ^= rows[i];
+	}
+
+	// Interleave: each raw byte is one column of the matrix
+	for (int column = 0; column < 16; column++)
+	{
+		uint8_t rawByte = 0;
+
+		for (int row = 0; row < 8; row++)
+		{
+			if (rows[row] & (0x8000 >> column))
+			{
+				rawByte |= BIT_MASK_TABLE[row];
+			}
+		}
+
+		rawData[column] = rawByte;
+	}
+}
+
+// Decodes the 16 raw embedded signalling bytes into the 9 LC bytes, returns false on an uncorrectable error or a bad CRC
+bool dmrFECEmbeddedDataDecode(const uint8_t *rawData, uint8_t *lcData)
+{
+	uint32_t crc = 0;
+	uint16_t rows[8];
+	uint16_t parity = 0;
+	bitStream_t stream = { 0 };
+
+	memset(rows, 0, sizeof(rows));
+
+	for (int column = 0; column < 16; column++)
+	{
+		uint8_t rawByte = rawData[column];
+
+		for (int row = 0; row < 8; row++)
+		{
+			if (rawByte & BIT_MASK_TABLE[row])
+			{
+				rows[row] |= (0x8000 >> column);
+			}
+		}
+	}
+
+	for (int i = 0; i < 7; i++)
+	{
+		if (!dmrFECHamming16114Decode(&rows[i]))
+		{
+			return false;
+		}
+	}
+
+	// Check parity
+	for (int i = 0; i < 8; i++)
+	{
+		parity ^= rows[i];
+	}
+
+	if (parity != 0)
+	{
+		return false;
+	}
+
+	bitStreamWrite(&stream, lcData, (rows[0] >> 5), 11);
+	bitStreamWrite(&stream, lcData, (rows[1] >> 5), 11);
+
+	for (int i = 2; i < 7; i++)
+	{
+		bitStreamWrite(&stream, lcData, (rows[i] >> 6), 10);
+		crc = (crc << 1) | ((rows[i] >> 5) & 0x01);
+	}
+
+	if (crc != CRC_encodeFiveBit(lcData))
+	{
+		return false;
+	}
+
+	return true;
+}
+
+static uint32_t CRC_encodeFiveBit(const uint8_t *in)
+{
+	uint32_t total = 0;
+
+	for (int i = 0; i < 9; i++)
+	{
+		total += in[i];
+	}
+
+	total %= 31;
+
+	return total;
+}
+
+static uint32_t bitStreamRead(bitStream_t *stream, const uint8_t *in, uint32_t count)
+{
+	while (stream->numBits < count)
+	{
+		stream->accumulator = (stream->accumulator << 8) | in[stream->index++];
+		stream->numBits += 8;
+	}
+
+	stream->numBits -= count;
+
+	return ((stream->accumulator >> stream->numBits) & ((1U << count) - 1));
+}
+
+static void bitStreamWrite(bitStream_t *stream, uint8_t *out, uint32_t value, uint32_t count)
+{
+	stream->accumulator = (stream->accumulator << count) | value;
+	stream->numBits += count;
+
+	while (stream->numBits >= 8)
+	{
+		stream->numBits -= 8;
+		out[stream->index++] = (stream->accumulator >> stream->numBits) & 0xFF;
+	}
+}
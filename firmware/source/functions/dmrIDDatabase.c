@@ -0,0 +1,469 @@
+/*
+ * Copyright (C) 2024 Roger Clark, VK3KYY / G4KYF
+ *                    Daniel Caujolle-Bert, F1RMB
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+ *    in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. Use of this source code or binary releases for commercial purposes is strictly forbidden. This includes, without limitation,
+ *    incorporation in a commercial product or incorporation into a product or project which allows commercial use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "functions/dmrIDDatabase.h"
+#include "functions/codeplug.h"
+#include "functions/voicePrompts.h"
+#include "hardware/SPI_Flash.h"
+
+static const uint8_t DECOMPRESS_LUT[64] = { ' ', '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M', 'N', 'O', 'P', 'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z', 'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j', 'k', 'l', 'm', 'n', 'o', 'p', 'q', 'r', 's', 't', 'u', 'v', 'w', 'x', 'y', 'z', '.' };
+
+static uint32_t dmrIdDataArea_1_Size;
+const uint32_t DMRID_HEADER_LENGTH = 0x0C;
+const uint32_t DMRID_MEMORY_LOCATION_1 = 0x30000 + FLASH_ADDRESS_OFFSET;
+const uint32_t DMRID_MEMORY_LOCATION_2 = 0xB8000 + FLASH_ADDRESS_OFFSET;
+uint32_t dmrIDDatabaseMemoryLocation2 = DMRID_MEMORY_LOCATION_2;
+
+static dmrIDsCache_t dmrIDsCache;
+static dmrIDsLRUEntry_t dmrIDsLRU[DMRID_LRU_SIZE];
+static uint32_t dmrIDsLRUClock = 0;
+static uint32_t dmrIDsLRUHits = 0;
+static uint32_t dmrIDsLRUMisses = 0;
+
+static uint32_t DMRID_IdLength = 4U;
+
+
+static bool dmrIDReadContactInFlash(uint32_t contactOffset, uint8_t *data, uint32_t len)
+{
+	uint32_t address;
+
+	if (contactOffset >= dmrIdDataArea_1_Size)
+	{
+		address = dmrIDDatabaseMemoryLocation2 + (contactOffset - dmrIdDataArea_1_Size);
+	}
+	else
+	{
+		address = DMRID_MEMORY_LOCATION_1 + DMRID_HEADER_LENGTH + contactOffset;
+	}
+
+	return SPI_Flash_read(address, data, len);
+}
+
+// Read a block of consecutive records, it could be split across the two storage locations
+static bool dmrIDReadContactsInFlash(uint32_t firstPos, uint32_t count, uint8_t *data)
+{
+	uint32_t contactOffset = dmrIDsCache.contactLength * firstPos;
+	uint32_t len = dmrIDsCache.contactLength * count;
+
+	if ((contactOffset < dmrIdDataArea_1_Size) && ((contactOffset + len) > dmrIdDataArea_1_Size))
+	{
+		uint32_t area1Len = (dmrIdDataArea_1_Size - contactOffset);
+
+		return (dmrIDReadContactInFlash(contactOffset, data, area1Len) &&
+				dmrIDReadContactInFlash(dmrIdDataArea_1_Size, (data + area1Len), (len - area1Len)));
+	}
+
+	return dmrIDReadContactInFlash(contactOffset, data, len);
+}
+
+static inline uint32_t dmrIDGetRecordID(uint8_t *record)
+{
+	uint32_t id = 0;
+
+	memcpy(&id, record, DMRID_IdLength);
+
+	return id;
+}
+
+// Linear value of an ID as stored in the DB (BCD with 4 bytes IDs), used to interpolate the position of a record.
+static inline uint32_t dmrIDToLinear(uint32_t id)
+{
+	return ((DMRID_IdLength == 4U) ? bcd2int(id) : id);
+}
+
+void dmrIDCacheInit(void)
+{
+	uint8_t headerBuf[32];
+
+	dmrIDCacheClear();
+	memset(&headerBuf, 0, sizeof(headerBuf));
+
+	// The format could have changed since the last init (e.g. a new DB uploaded by the CPS)
+	DMRID_IdLength = 4U;
+	dmrIDDatabaseMemoryLocation2 = DMRID_MEMORY_LOCATION_2;
+
+	SPI_Flash_read(DMRID_MEMORY_LOCATION_1, headerBuf, DMRID_HEADER_LENGTH);
+
+	// Break backward compatibility with old "ID{N,n} tag, as we had too
+	// much problems with corrupted database.
+	if ((headerBuf[0] != 'I') || (headerBuf[1] != 'd') )
+	{
+		return;
+	}
+
+	if (headerBuf[2] == 'N' || headerBuf[2] == 'n')
+	{
+		DMRID_IdLength = 3U;// default is 4
+		if (headerBuf[2] == 'n')
+		{
+			dmrIDDatabaseMemoryLocation2 = VOICE_PROMPTS_FLASH_HEADER_ADDRESS; // overwrite the VP
+		}
+	}
+
+	dmrIDsCache.contactLength = (uint8_t)headerBuf[3] - 0x4a;
+	// Check that data in DMR ID DB does not have a larger record size than the code has
+	if ((dmrIDsCache.contactLength > sizeof(dmrIdDataStruct_t)) || (dmrIDsCache.contactLength <= DMRID_IdLength))
+	{
+		return;
+	}
+
+	// Size of number of complete DMR ID records for the first storage location
+	dmrIdDataArea_1_Size = (dmrIDsCache.contactLength * ((0x40000 - DMRID_HEADER_LENGTH) / dmrIDsCache.contactLength));
+
+	uint32_t entries = ((uint32_t)headerBuf[8] | (uint32_t)headerBuf[9] << 8 | (uint32_t)headerBuf[10] << 16 | (uint32_t)headerBuf[11] << 24);
+
+	if (entries > 0)
+	{
+		uint8_t record[4];
+
+		// Sample the IDs evenly across the whole DB, so a lookup only needs to search
+		// a range of IDsPerSample records in the flash.
+		dmrIDsCache.IDsPerSample = ((entries + (DMRID_INDEX_SAMPLES - 1)) / DMRID_INDEX_SAMPLES);
+		dmrIDsCache.numSamples = ((entries + (dmrIDsCache.IDsPerSample - 1)) / dmrIDsCache.IDsPerSample);
+
+		for (uint32_t i = 0; i < dmrIDsCache.numSamples; i++)
+		{
+			if (dmrIDReadContactInFlash((dmrIDsCache.contactLength * (dmrIDsCache.IDsPerSample * i)), record, DMRID_IdLength) == false)
+			{
+				return;
+			}
+			dmrIDsCache.samples[i] = dmrIDGetRecordID(record);
+		}
+
+		// Last available ID
+		if (dmrIDReadContactInFlash((dmrIDsCache.contactLength * (entries - 1)), record, DMRID_IdLength) == false)
+		{
+			return;
+		}
+		dmrIDsCache.lastID = dmrIDGetRecordID(record);
+
+		// Only now the index is complete, make it available to dmrIDLookup()
+		dmrIDsCache.entries = entries;
+	}
+}
+
+void dmrIDCacheClear(void)
+{
+	memset(&dmrIDsCache, 0, sizeof(dmrIDsCache_t));
+	memset(&dmrIDsLRU, 0, sizeof(dmrIDsLRU));
+	dmrIDsLRUClock = 0;
+}
+
+void dmrIDCacheGetLRUStats(uint32_t *hits, uint32_t *misses)
+{
+	*hits = dmrIDsLRUHits;
+	*misses = dmrIDsLRUMisses;
+}
+
+uint32_t dmrIDCacheGetCount(void)
+{
+	return dmrIDsCache.entries;
+}
+
+static void dmrDbTextDecode(uint8_t *decompressedBufOut, uint8_t *compressedBufIn, int compressedSize)
+{
+	uint8_t *outPtr = decompressedBufOut;
+	uint8_t cb1, cb2, cb3;
+	int d = 0;
+	do
+	{
+		cb1 = compressedBufIn[d++];
+		*outPtr++ = DECOMPRESS_LUT[cb1 >> 2];//A
+		if (d == compressedSize)
+		{
+			break;
+		}
+		cb2 = compressedBufIn[d++];
+		*outPtr++ = DECOMPRESS_LUT[((cb1 & 0x03) << 4) + (cb2 >> 4)];//B
+		if (d == compressedSize)
+		{
+			break;
+		}
+		cb3 = compressedBufIn[d++];
+		*outPtr++ = DECOMPRESS_LUT[((cb2 & 0x0F) << 2) + (cb3 >> 6)];//C
+		*outPtr++ = DECOMPRESS_LUT[cb3 & 0x3F];//D
+
+	} while (d < compressedSize);
+
+	// algorithm can result in a extra space at the end of the decompressed string
+	// so trim the string
+	uint32_t l = (outPtr - decompressedBufOut);
+	if (l)
+	{
+		uint8_t *p = ((decompressedBufOut + l) - 1);
+		while ((p >= decompressedBufOut) && (*p == ' '))
+		{
+			*p-- = 0;
+		}
+	}
+}
+
+// Contact's text length == (dmrIDsCache.contactLength - DMRID_IdLength) aren't NULL terminated,
+// so clearing the whole destination array is mandatory
+static void dmrIDDecodeRecord(uint32_t idBCD, uint8_t *record, dmrIdDataStruct_t *foundRecord)
+{
+	memset(foundRecord->text, 0, sizeof(foundRecord->text));
+	foundRecord->id = idBCD;
+
+	if (DMRID_IdLength == 3U)
+	{
+		dmrDbTextDecode((uint8_t *)foundRecord->text, (record + DMRID_IdLength), (dmrIDsCache.contactLength - DMRID_IdLength));
+	}
+	else
+	{
+		memcpy((uint8_t *)foundRecord->text, (record + DMRID_IdLength), (dmrIDsCache.contactLength - DMRID_IdLength));
+	}
+}
+
+static bool dmrIDReadRecord(uint32_t position, uint32_t idBCD, dmrIdDataStruct_t *foundRecord)
+{
+	uint8_t record[sizeof(dmrIdDataStruct_t)];
+
+	if (dmrIDReadContactInFlash((dmrIDsCache.contactLength * position), record, dmrIDsCache.contactLength) == false)
+	{
+		return false;
+	}
+
+	dmrIDDecodeRecord(idBCD, record, foundRecord);
+
+	return true;
+}
+
+// Not in the DB (or SPI read failure): same key as a found record, the ID as text
+static bool dmrIDSetNotFound(uint32_t targetId, dmrIdDataStruct_t *foundRecord)
+{
+	foundRecord->id = ((DMRID_IdLength == 4U) ? int2bcd(targetId) : targetId);
+	snprintf(foundRecord->text, MAX_DMR_ID_CONTACT_TEXT_LENGTH, "ID:%d", targetId);
+
+	return false;
+}
+
+static bool dmrIDLookupInFlash(uint32_t targetId, dmrIdDataStruct_t *foundRecord, bool *readFailure)
+{
+	static uint8_t recordsBuf[DMRID_LOOKUP_WINDOW_SIZE];
+	uint32_t targetIdBCD;
+
+	if (DMRID_IdLength == 4U)
+	{
+		targetIdBCD = int2bcd(targetId);
+	}
+	else
+	{
+		targetIdBCD = targetId;
+	}
+
+	if ((dmrIDsCache.entries > 0) && (targetIdBCD >= dmrIDsCache.samples[0]) && (targetIdBCD <= dmrIDsCache.lastID))
+	{
+		uint32_t sampleStart = 0;
+		uint32_t sampleEnd = dmrIDsCache.numSamples - 1;
+		uint32_t startPos, endPos;
+		uint32_t startKey, endKey; // Linear IDs at startPos and endPos, used to interpolate the target position
+		uint32_t targetKey = dmrIDToLinear(targetIdBCD);
+		uint32_t interpolationFailures = 0;
+		bool interpolate = true;
+		uint8_t record[4];
+
+		// Find the sample range holding the target ID, in RAM.
+		while (sampleStart < sampleEnd)
+		{
+			uint32_t mid = (sampleStart + sampleEnd + 1) >> 1;
+
+			if (dmrIDsCache.samples[mid] <= targetIdBCD)
+			{
+				sampleStart = mid;
+			}
+			else
+			{
+				sampleEnd = mid - 1;
+			}
+		}
+
+		startPos = dmrIDsCache.IDsPerSample * sampleStart;
+		startKey = dmrIDToLinear(dmrIDsCache.samples[sampleStart]);
+
+		if (dmrIDsCache.samples[sampleStart] == targetIdBCD)
+		{
+			if (dmrIDReadRecord(startPos, targetIdBCD, foundRecord))
+			{
+				return true;
+			}
+
+			*readFailure = true;
+			goto spiReadFailure;
+		}
+
+		if ((sampleStart + 1) < dmrIDsCache.numSamples)
+		{
+			endPos = (startPos + dmrIDsCache.IDsPerSample) - 1;
+			endKey = dmrIDToLinear(dmrIDsCache.samples[sampleStart + 1]); // Key at (endPos + 1), close enough
+		}
+		else
+		{
+			endPos = dmrIDsCache.entries - 1;
+			endKey = dmrIDToLinear(dmrIDsCache.lastID);
+		}
+
+		// Search the range, only reading the ID of the probed record. The probed position is interpolated,
+		// as IDs are quite evenly distributed in a sample range, until that failed to halve the range 3 times
+		// (e.g. gaps between countries), then bisection bounds the number of reads.
+		// Once the range fits in DMRID_LOOKUP_WINDOW_SIZE, all its records are read at once.
+		while (startPos <= endPos)
+		{
+			uint32_t count = (endPos - startPos) + 1;
+			uint32_t probe;
+			uint32_t probeID;
+
+			if ((count * dmrIDsCache.contactLength) <= DMRID_LOOKUP_WINDOW_SIZE)
+			{
+				if (dmrIDReadContactsInFlash(startPos, count, recordsBuf) == false)
+				{
+					*readFailure = true;
+					goto spiReadFailure;
+				}
+
+				for (uint32_t i = 0; i < count; i++)
+				{
+					uint8_t *windowRecord = recordsBuf + (dmrIDsCache.contactLength * i);
+
+					if (dmrIDGetRecordID(windowRecord) == targetIdBCD)
+					{
+						dmrIDDecodeRecord(targetIdBCD, windowRecord, foundRecord);
+						return true;
+					}
+				}
+
+				break; // Not in the DB
+			}
+
+			if (interpolate && (endKey > startKey) && (targetKey >= startKey) && (targetKey <= endKey))
+			{
+				probe = startPos + (uint32_t)(((uint64_t)(targetKey - startKey) * (endPos - startPos)) / (endKey - startKey));
+			}
+			else
+			{
+				probe = (startPos + endPos) >> 1;
+			}
+
+			if (dmrIDReadContactInFlash((dmrIDsCache.contactLength * probe), record, DMRID_IdLength) == false)
+			{
+				*readFailure = true;
+				goto spiReadFailure;
+			}
+
+			probeID = dmrIDGetRecordID(record);
+
+			if (probeID < targetIdBCD)
+			{
+				startPos = probe + 1;
+				startKey = dmrIDToLinear(probeID);
+			}
+			else if (probeID > targetIdBCD)
+			{
+				endPos = probe - 1;
+				endKey = dmrIDToLinear(probeID);
+			}
+			else
+			{
+				if (dmrIDReadRecord(probe, targetIdBCD, foundRecord))
+				{
+					return true;
+				}
+
+				*readFailure = true;
+				goto spiReadFailure;
+			}
+
+			if (interpolate && ((((endPos - startPos) + 1) << 1) > count))
+			{
+				interpolationFailures++;
+				interpolate = (interpolationFailures < 3);
+			}
+		}
+	}
+
+	spiReadFailure:
+	return dmrIDSetNotFound(targetId, foundRecord);
+}
+
+// The same IDs keep coming back on a net, so the last looked up ones (found or not) are kept
+// in RAM, avoiding any flash access on repeated talkers.
+bool dmrIDLookup(uint32_t targetId, dmrIdDataStruct_t *foundRecord)
+{
+	dmrIDsLRUEntry_t *oldestEntry = &dmrIDsLRU[0];
+	bool readFailure = false;
+	bool found;
+
+	if (targetId == 0)
+	{
+		return dmrIDLookupInFlash(targetId, foundRecord, &readFailure);
+	}
+
+	for (int i = 0; i < DMRID_LRU_SIZE; i++)
+	{
+		dmrIDsLRUEntry_t *entry = &dmrIDsLRU[i];
+
+		if (entry->targetId == targetId)
+		{
+			dmrIDsLRUHits++;
+			entry->lastUse = ++dmrIDsLRUClock;
+
+			if (entry->found == false)
+			{
+				return dmrIDSetNotFound(targetId, foundRecord);
+			}
+
+			memcpy(foundRecord, &entry->record, sizeof(dmrIdDataStruct_t));
+			return true;
+		}
+
+		if (entry->lastUse < oldestEntry->lastUse)
+		{
+			oldestEntry = entry;
+		}
+	}
+
+	dmrIDsLRUMisses++;
+	found = dmrIDLookupInFlash(targetId, foundRecord, &readFailure);
+
+	// Don't keep SPI read failures, only DB hits and misses.
+	if (readFailure == false)
+	{
+		oldestEntry->targetId = targetId;
+		oldestEntry->lastUse = ++dmrIDsLRUClock;
+		oldestEntry->found = found;
+
+		if (found)
+		{
+			memcpy(&oldestEntry->record, foundRecord, sizeof(dmrIdDataStruct_t));
+		}
+	}
+
+	return found;
+}
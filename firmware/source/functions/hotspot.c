@@ -40,6 +40,8 @@
 #include <ctype.h>
 
 #include "functions/calibration.h"
+#include "functions/dmrData.h"
+#include "functions/dmrFEC.h"
 #include "functions/hotspot.h"
 #include "user_interface/menuSystem.h"
 #include "user_interface/uiUtilities.h"
@@ -61,35 +63,51 @@
 #define WRITE_BIT1(p,i,b) p[(i)>>3] = (b) ? (p[(i)>>3] | BIT_MASK_TABLE[(i)&7]) : (p[(i)>>3] & ~BIT_MASK_TABLE[(i)&7])
 #define READ_BIT1(p,i)    (p[(i)>>3] & BIT_MASK_TABLE[(i)&7])
 
+// Single producer / single consumer queues, using free running indexes (count is head - tail).
+// head is only written by the producer, tail only by the consumer, so no critical section is needed.
+typedef struct
+{
+	volatile uint32_t head;
+	volatile uint32_t tail;
+	uint32_t          highWatermark; // written by the producer
+	uint32_t          overflows;     // written by the producer
+	uint32_t          underflows;    // written by the consumer
+} hotspotQueue_t;
+
+#define HOTSPOT_USB_QUEUE_SIZE      1024U // in bytes, stored in usbComSendBuf
+#define HOTSPOT_USB_QUEUE_PADDING   0x00  // zero length record: the next record is at the start of the queue
+
+#if ((HOTSPOT_BUFFER_COUNT & (HOTSPOT_BUFFER_COUNT - 1)) != 0) || ((HOTSPOT_USB_QUEUE_SIZE & (HOTSPOT_USB_QUEUE_SIZE - 1)) != 0)
+#error "Hotspot queue sizes have to be a power of two"
+#endif
+#if (HOTSPOT_USB_QUEUE_SIZE > COM_BUFFER_SIZE)
+#error "HOTSPOT_USB_QUEUE_SIZE is larger than usbComSendBuf"
+#endif
 
 static void ReedSolomonDMREncode(const uint8_t *inputData, uint8_t *outputData);
 static uint8_t LUT_Mult(uint8_t a, uint8_t b);
-static void BPTCglobalsInit(void);
-static void BPTCdecode(const uint8_t *inputData, uint8_t *outputData);
-static void BPTCencode(const uint8_t *inputData, uint8_t *outputData);
 static void DMRLC2Bytes(const DMRLC_t *LC_DataInput, uint8_t *outputBytes);
-static uint8_t hammingGetBits(bool *inputOutputBooleanBitsArray, bool is16114);
-static void hammingEncode(bool *inputOutputBooleanBitsArray,bool is16114);
-static bool hammingDecodeType1(bool *inputOutputBooleanBitsArray);
-static bool hammingDecodeType2(bool *inputOutputBooleanBitsArray);
 static void embeddedDataDecodeEmbeddedData(void);
 static void embeddedDataEncodeEmbeddedData(void);
-static uint32_t CRC_encodeFiveBit(const bool *in);
-static void byteToBooleanBitsArray(uint8_t byteIn, bool *bitsOut);
-static uint8_t BooleanBitsArrayToByte(const bool *bitsIn);
 static uint8_t setFreq(const uint8_t *data, uint8_t length);
 static void sendNAK(uint8_t cmd, uint8_t err);
 static void sendACK(uint8_t cmd);
 static uint8_t hotspotModeReceiveNetFrame(const uint8_t *comBuffer, uint8_t timeSlot);
+static void hotspotModeReceiveNetDataFrame(const uint8_t *frame, uint8_t dataType);
 static bool voiceLCHeaderDecode(const uint8_t *data, uint8_t type, DMRLC_t *lc);
 static bool DMRFullLC_encode(DMRLC_t *lc, uint8_t *data, uint8_t type);
 static void embeddedDataBuffersInt(void);
+static void embeddedDataSetRawFragment(uint8_t fragment, uint32_t rawData);
 static bool embeddedDataAddData(const uint8_t *data, uint8_t lcss);
 static void embeddedDataGetData(uint8_t sequenceNumber, uint8_t *outputData);
 static bool embeddedDataGetRawData(uint8_t *outputData);
 static void embeddedDataSetLC(const DMRLC_t *lc);
 static bool hasTXOverflow(void);
 static bool hasRXOverflow(void);
+static void queuePublish(hotspotQueue_t *queue, uint32_t head);
+static void queueRelease(hotspotQueue_t *queue, uint32_t tail);
+static void queueReset(hotspotQueue_t *queue);
+static void netQueueFlush(void);
 
 
 extern LinkItem_t *LinkHead;
@@ -178,21 +196,15 @@ static const struct
 static const uint8_t VOICE_LC_HEADER_CRC_MASK[]    = {0x96, 0x96, 0x96};
 static const uint8_t TERMINATOR_WITH_LC_CRC_MASK[] = {0x99, 0x99, 0x99};
 
-static const int BPTC19696CopyRanges[][2] = {{4,11},{16,26},{31,41},{46,56},{61,71},{76,86},{91,101},{106,116},{121,131}};
-static const int embedddataCopyRanges[][2] = {{0,10},{16,26},{32,41},{48,57},{64,73},{80,89},{96,105}};
-
 static uint8_t hotspotTxLC[9];
 static bool startedEmbeddedSearch = false;
 
-// USB TX read/write positions and count
-static volatile uint16_t usbComSendBufWritePosition = 0;
-static volatile uint16_t usbComSendBufReadPosition = 0;
-static volatile uint16_t usbComSendBufCount = 0;
-
-// RF data read/write positions and count
-static volatile uint32_t rfFrameBufReadIdx = 0;
-static volatile uint32_t rfFrameBufWriteIdx = 0;
-static volatile uint32_t rfFrameBufCount = 0;
+static hotspotQueue_t usbQueue; // MMDVM frames to USB, in bytes (main task -> main task)
+static hotspotQueue_t rfQueue;  // RF frames, in slots of hotspotBuffer (HR-C6000 -> main task)
+static hotspotQueue_t netQueue; // Network frames, in slots of hotspotBuffer (main task -> HR-C6000)
+static volatile bool netQueueRanDry = false;
+static uint32_t rfQueueReportedOverflows = 0;
+static uint32_t netQueueReportedOverflows = 0;
 
 static uint8_t lastRxState = HOTSPOT_RX_IDLE;
 static const int TX_BUFFERING_TIMEOUT = 360;
@@ -222,20 +234,11 @@ static bool overriddenLCAvailable = false;
 static uint32_t hotspotTxDelay = 0;
 static uint8_t overriddenBlocksTA = 0x00;
 static LC_STATE_t embeddedDataSequenceState;
-static bool	embeddedDataRaw[128];
-static bool	embeddedDataProcessed[72];
+static uint8_t	embeddedDataRaw[16];
+static uint8_t	embeddedDataProcessed[9];
 static int	embeddedDataFLCO;
 static bool	embeddedDataIsValid;
 
-#if defined(PLATFORM_GD77) || defined(PLATFORM_GD77S) || defined(PLATFORM_DM1801) || defined(PLATFORM_DM1801A) || defined(PLATFORM_RD5R)
-#define BPTRAMLOCATION ".data.$RAM2"
-#else
-#define BPTRAMLOCATION ".ccmram"
-#endif
-
-__attribute__((section(BPTRAMLOCATION))) static bool BPTCRaw[196];
-__attribute__((section(BPTRAMLOCATION))) static bool BPTCDeInterleaved[196];
-
 static const uint32_t cwDOTDuration = 60; // 60ms per DOT
 static ticksTimer_t cwNextPeriodTimer = { 0, 0 };
 static uint8_t cwBuffer[64];
@@ -256,6 +259,8 @@ uint8_t hotspotSavedPowerLevel = POWER_UNSET;// no power level saved yet
 bool hotspotMmdvmHostIsConnected = false;
 uint8_t hotspotPowerLevel = 0;// no power level saved yet
 volatile MMDVM_STATE hotspotModemState = STATE_IDLE;
+bool hotspotDataMessagePending = false; // Shown by the UI, out of the frame handling
+char hotspotDataMessageText[HOTSPOT_DATA_MESSAGE_TEXT_LENGTH];
 
 static volatile MMDVMHOST_RX_STATE MMDVMHostRxState;
 
@@ -263,8 +268,7 @@ static bool voiceLCHeaderDecode(const uint8_t *data, uint8_t type, DMRLC_t *lc)
 {
 	uint8_t parityCheckArray[4];
 
-	BPTCglobalsInit();
-	BPTCdecode(data, lc->rawData);
+	dmrFECBPTC19696Decode(data, lc->rawData);
 
 	lc->rawData[9]  ^= VOICE_LC_HEADER_CRC_MASK[0];
 	lc->rawData[10] ^= VOICE_LC_HEADER_CRC_MASK[1];
@@ -311,8 +315,7 @@ bool DMRFullLC_encode(DMRLC_t *lc, uint8_t *data, uint8_t type)
 		lcData[11] = parity[0] ^ TERMINATOR_WITH_LC_CRC_MASK[2];
 	}
 
-	BPTCglobalsInit();
-	BPTCencode(lcData, data);
+	dmrFECBPTC19696Encode(lcData, data);
 
 	return true;
 }
@@ -325,22 +328,25 @@ static void embeddedDataBuffersInt(void)
 	embeddedDataIsValid = false;
 }
 
-static bool embeddedDataAddData(const uint8_t *data, uint8_t lcss)
+static void embeddedDataSetRawFragment(uint8_t fragment, uint32_t rawData)
 {
-	bool rawData[36];
+	uint8_t *p = embeddedDataRaw + (fragment << 2);
 
-	for (int i = 0; i < 5; i++)
-	{
-		byteToBooleanBitsArray(data[i + 14], rawData + (i << 3));
-	}
+	p[0] = (rawData >> 24) & 0xFF;
+	p[1] = (rawData >> 16) & 0xFF;
+	p[2] = (rawData >> 8) & 0xFF;
+	p[3] = rawData & 0xFF;
+}
+
+static bool embeddedDataAddData(const uint8_t *data, uint8_t lcss)
+{
+	// 32 bits of embedded data, starting at the low nibble of byte 14
+	uint32_t rawData = (((uint32_t)data[14] & 0x0F) << 28) | (((uint32_t)data[15]) << 20) | (((uint32_t)data[16]) << 12) | (((uint32_t)data[17]) << 4) | (((uint32_t)data[18]) >> 4);
 
 	switch (lcss)
 	{
 		case 1:
-			for (int i = 0; i < 32; i++)
-			{
-				embeddedDataRaw[i] = rawData[i + 4];
-			}
+			embeddedDataSetRawFragment(0, rawData);
 			embeddedDataSequenceState = LCS_1;
 			embeddedDataIsValid = false;
 
@@ -349,10 +355,7 @@ static bool embeddedDataAddData(const uint8_t *data, uint8_t lcss)
 		case 2:
 			if (embeddedDataSequenceState == LCS_3)
 			{
-				for (int i = 0; i < 32; i++)
-				{
-					embeddedDataRaw[i + 96] = rawData[i + 4];
-				}
+				embeddedDataSetRawFragment(3, rawData);
 
 				embeddedDataSequenceState = LCS_0;
 
@@ -368,20 +371,14 @@ static bool embeddedDataAddData(const uint8_t *data, uint8_t lcss)
 			switch (embeddedDataSequenceState)
 			{
 				case LCS_1:
-					for (int i = 4; i < 36; i++)
-					{
-						embeddedDataRaw[i + 28] = rawData[i];
-					}
+					embeddedDataSetRawFragment(1, rawData);
 
 					embeddedDataSequenceState = LCS_2;
 
 					return false;
 					break;
 				case LCS_2:
-					for (int i = 0; i < 32; i++)
-					{
-						embeddedDataRaw[i + 64] = rawData[i + 4];
-					}
+					embeddedDataSetRawFragment(2, rawData);
 
 					embeddedDataSequenceState = LCS_3;
 
@@ -402,24 +399,13 @@ static void embeddedDataGetData(uint8_t sequenceNumber, uint8_t *outputData)
 
 	if ((sequenceNumber >= 1) && (sequenceNumber < 5))
 	{
-		bool bits[40];
-		uint8_t bytes[5];
+		const uint8_t *rawData = embeddedDataRaw + ((sequenceNumber - 1) << 2);
 
-		sequenceNumber--;
-
-		memset(bits, 0, 40 * sizeof(bool));
-		memcpy(bits + 4, embeddedDataRaw + (sequenceNumber * 32), 32 * sizeof(bool));
-
-		for (int i = 0; i < 5; i++)
-		{
-			bytes[i] = BooleanBitsArrayToByte(bits + (i << 3));
-		}
-
-		outputData[14] = (outputData[14] & 0xF0) | (bytes[0] & 0x0F);
-		outputData[15] = bytes[1];
-		outputData[16] = bytes[2];
-		outputData[17] = bytes[3];
-		outputData[18] = (outputData[18] & 0x0F) | (bytes[4] & 0xF0);
+		outputData[14] = (outputData[14] & 0xF0) | (rawData[0] >> 4);
+		outputData[15] = (rawData[0] << 4) | (rawData[1] >> 4);
+		outputData[16] = (rawData[1] << 4) | (rawData[2] >> 4);
+		outputData[17] = (rawData[2] << 4) | (rawData[3] >> 4);
+		outputData[18] = (outputData[18] & 0x0F) | (rawData[3] << 4);
 
 		return;
 	}
@@ -438,24 +424,14 @@ static bool embeddedDataGetRawData(uint8_t *outputData)
 		return false;
 	}
 
-	for (int i = 0; i < 9; i++)
-	{
-		outputData[i] = BooleanBitsArrayToByte(embeddedDataProcessed + (i << 3));
-	}
+	memcpy(outputData, embeddedDataProcessed, sizeof(embeddedDataProcessed));
 
 	return true;
 }
 
 static void embeddedDataSetLC(const DMRLC_t *lc)
 {
-	uint8_t bytes[9];
-
-	DMRLC2Bytes(lc, bytes);
-
-	for (int i = 0; i < 9; i++)
-	{
-		byteToBooleanBitsArray(bytes[i], embeddedDataProcessed + (i << 3));
-	}
+	DMRLC2Bytes(lc, embeddedDataProcessed);
 
 	embeddedDataFLCO  = lc->FLCO;
 	embeddedDataIsValid = true;
@@ -542,178 +518,6 @@ static void ReedSolomonDMREncode(const uint8_t *inputData, uint8_t *outputData)
 	}
 }
 
-static void BPTCglobalsInit(void)
-{
-	memset(BPTCRaw, 0, sizeof(BPTCRaw));
-	memset(BPTCDeInterleaved, 0, sizeof(BPTCDeInterleaved));
-}
-
-static void BPTCdecode(const uint8_t *inputData, uint8_t *outputData)
-{
-	// 0xFF means don't use this value
-	const uint8_t BITS_LOOKUP[16] = {0xFF, 9, 10, 6, 11, 3, 7, 1, 12, 0xFF, 4, 0xFF, 8, 5, 2, 0};
-	bool bitData[96];
-	bool tmpArray[13];
-	uint32_t bitDataIndex = 0;
-	bool stillProcessing;
-	uint8_t n;
-
-	for (int i = 0; i < 13; i++)
-	{
-		byteToBooleanBitsArray(inputData[i], BPTCRaw + (i << 3));
-	}
-
-	byteToBooleanBitsArray(inputData[20], tmpArray);
-	BPTCRaw[98] = tmpArray[6];
-	BPTCRaw[99] = tmpArray[7];
-
-	for (int i = 0; i < 13; i++)
-	{
-		byteToBooleanBitsArray(inputData[i + 21], BPTCRaw + (100 + (i << 3)));
-	}
-
-	for (int i = 0; i < 196; i++)
-	{
-		BPTCDeInterleaved[i] = BPTCRaw[(i * 181) % 196];// interleave
-	}
-
-	stillProcessing = true;// Need to initially set this to true to start the for loop
-
-	for (int i = 0; ((i < 5) && stillProcessing); i++)
-	{
-		stillProcessing = false;
-
-		for (int j = 0; j < 15; j++)
-		{
-			int pos = j + 1;
-			for (int k = 0; k < 13; k++)
-			{
-				tmpArray[k] = BPTCDeInterleaved[pos];
-				pos += 15;
-			}
-
-			bool hammingOK = false;
-
-			n  = ((tmpArray[0] ^ tmpArray[1] ^ tmpArray[3] ^ tmpArray[5] ^ tmpArray[6]) != tmpArray[9])  ? 0x01 : 0x00;
-			n |= ((tmpArray[0] ^ tmpArray[1] ^ tmpArray[2] ^ tmpArray[4] ^ tmpArray[6] ^ tmpArray[7]) != tmpArray[10]) ? 0x02 : 0x00;
-			n |= ((tmpArray[0] ^ tmpArray[1] ^ tmpArray[2] ^ tmpArray[3] ^ tmpArray[5] ^ tmpArray[7] ^ tmpArray[8]) != tmpArray[11]) ? 0x04 : 0x00;
-			n |= ((tmpArray[0] ^ tmpArray[2] ^ tmpArray[4] ^ tmpArray[5] ^ tmpArray[8]) != tmpArray[12]) ? 0x08 : 0x00;
-
-			if (n < 16)
-			{
-				uint8_t bitLocation = BITS_LOOKUP[n];
-				if (bitLocation != 0xFF)
-				{
-					tmpArray[bitLocation] = !tmpArray[bitLocation];
-					hammingOK = true;
-				}
-			}
-
-			if (hammingOK)
-			{
-				pos = j + 1;
-				for (int k = 0; k < 13; k++)
-				{
-					BPTCDeInterleaved[pos] = tmpArray[k];
-					pos += 15;
-				}
-				stillProcessing = true;
-			}
-		}
-
-		for (int j = 0; j < 9; j++)
-		{
-			uint32_t pos = (j * 15) + 1;
-			if (hammingDecodeType2(BPTCDeInterleaved + pos))
-			{
-				stillProcessing = true;
-			}
-		}
-	}
-
-	for (int range = 0; range < 9; range++)
-	{
-		for (uint32_t a = BPTC19696CopyRanges[range][0]; a <= BPTC19696CopyRanges[range][1]; a++, bitDataIndex++)
-		{
-			bitData[bitDataIndex] = BPTCDeInterleaved[a];
-		}
-	}
-
-	for (int i = 0; i < LC_DATA_LENGTH; i++)
-	{
-		outputData[i] = BooleanBitsArrayToByte(bitData + (i << 3));
-	}
-}
-
-static void BPTCencode(const uint8_t *inputData, uint8_t *outputData)
-{
-	uint8_t byteData;
-	uint32_t bitDataPosition = 0;
-	bool bitData[96];
-	bool hammingBits[13];
-
-	for (int i = 0; i < LC_DATA_LENGTH; i++)
-	{
-		byteToBooleanBitsArray(inputData[i], bitData + (i << 3));
-	}
-
-	memset(BPTCDeInterleaved, 0, 196 * sizeof(bool));
-
-	for (int range = 0; range < 9; range++)
-	{
-		for (uint32_t a = BPTC19696CopyRanges[range][0]; a <= BPTC19696CopyRanges[range][1]; a++, bitDataPosition++)
-		{
-			BPTCDeInterleaved[a] = bitData[bitDataPosition];
-		}
-	}
-
-	for (int i = 0; i < 9; i++)
-	{
-		hammingEncode(BPTCDeInterleaved + ((i * 15) + 1), false);
-	}
-
-	for (int i = 0; i < 15; i++)
-	{
-		int pos = i + 1;
-		for (int j = 0; j < 13; j++)
-		{
-			hammingBits[j] = BPTCDeInterleaved[pos];
-			pos += 15;
-		}
-
-		hammingBits[9]  = hammingBits[0] ^ hammingBits[1] ^ hammingBits[3] ^ hammingBits[5] ^ hammingBits[6];
-		hammingBits[10] = hammingBits[0] ^ hammingBits[1] ^ hammingBits[2] ^ hammingBits[4] ^ hammingBits[6] ^ hammingBits[7];
-		hammingBits[11] = hammingBits[0] ^ hammingBits[1] ^ hammingBits[2] ^ hammingBits[3] ^ hammingBits[5] ^ hammingBits[7] ^ hammingBits[8];
-		hammingBits[12] = hammingBits[0] ^ hammingBits[2] ^ hammingBits[4] ^ hammingBits[5] ^ hammingBits[8];
-
-		pos = i + 1;
-		for (int j = 0; j < 13; j++)
-		{
-			BPTCDeInterleaved[pos] = hammingBits[j];
-			pos += 15;
-		}
-	}
-
-	for (int i = 0; i < 196; i++)
-	{
-		BPTCRaw[(i * 181) % 196] = BPTCDeInterleaved[i];// interleave
-	}
-
-	for (int i = 0; i < LC_DATA_LENGTH; i++)
-	{
-		outputData[i] = BooleanBitsArrayToByte(BPTCRaw + (i << 3));
-	}
-
-	byteData = BooleanBitsArrayToByte(BPTCRaw + 96);
-	outputData[12] = (outputData[12] & 0x3F) | ((byteData >> 0) & 0xC0);
-	outputData[20] = (outputData[20] & 0xFC) | ((byteData >> 4) & 0x03);
-
-	for (int i = 0; i < 12; i++)
-	{
-		outputData[i + 21] = BooleanBitsArrayToByte(BPTCRaw + 100 + (i << 3));
-	}
-}
-
 static void DMRLC2Bytes(const DMRLC_t *LC_DataInput, uint8_t *outputBytes)
 {
 	outputBytes[0] = (uint8_t)LC_DataInput->FLCO;
@@ -740,237 +544,20 @@ static void DMRLC2Bytes(const DMRLC_t *LC_DataInput, uint8_t *outputBytes)
 	outputBytes[8] = (LC_DataInput->srcId  & 0xFF);
 }
 
-static bool hammingDecodeType2(bool *inputOutputBooleanBitsArray)
-{
-	const uint8_t BITS_LOOKUP[16] = {0xFF, 11, 12, 8, 13, 5, 9, 3, 14, 0, 6, 1, 10, 7, 4, 2};
-	uint8_t numBits = hammingGetBits(inputOutputBooleanBitsArray, false);
-
-	if (numBits < 16)
-	{
-		uint8_t bitLocation = BITS_LOOKUP[numBits];
-		if (bitLocation != 0xFF)
-		{
-			inputOutputBooleanBitsArray[bitLocation] = !inputOutputBooleanBitsArray[bitLocation];
-			return true;
-		}
-	}
-
-	return false;
-}
-
-static bool hammingDecodeType1(bool *inputOutputBooleanBitsArray)
-{
-	// 0xFF means don't use this value. Also Index 0 is never used, its only here to reduce the number of if's
-	const uint8_t BITS_LOOKUP[32] = { 0xFF, 11, 12, 0xFF, 13, 0xFF, 0xFF, 3, 14, 0xFF, 0xFF, 1, 0xFF, 7, 4, 0xFF, 15, 0xFF, 0xFF, 8, 0xFF, 5, 9, 0xFF, 0xFF, 0, 6, 0xFF, 10, 0xFF ,0xFF, 2};
-
-	uint8_t c = hammingGetBits(inputOutputBooleanBitsArray, true);
-	if (c == 0)
-	{
-		return true;
-	}
-
-	if (c < 32)
-	{
-		uint8_t bitLocation = BITS_LOOKUP[c];
-		if (bitLocation != 0xFF)
-		{
-			inputOutputBooleanBitsArray[bitLocation] = !inputOutputBooleanBitsArray[bitLocation];
-			return true;
-		}
-	}
-
-	return false;
-}
-
-static void hammingEncode(bool *inputOutputBooleanBitsArray,bool is16114)
-{
-	inputOutputBooleanBitsArray[11] = inputOutputBooleanBitsArray[0] ^ inputOutputBooleanBitsArray[1] ^ inputOutputBooleanBitsArray[2] ^ inputOutputBooleanBitsArray[3] ^ inputOutputBooleanBitsArray[5] ^ inputOutputBooleanBitsArray[7] ^ inputOutputBooleanBitsArray[8];
-	inputOutputBooleanBitsArray[12] = inputOutputBooleanBitsArray[1] ^ inputOutputBooleanBitsArray[2] ^ inputOutputBooleanBitsArray[3] ^ inputOutputBooleanBitsArray[4] ^ inputOutputBooleanBitsArray[6] ^ inputOutputBooleanBitsArray[8] ^ inputOutputBooleanBitsArray[9];
-	inputOutputBooleanBitsArray[13] = inputOutputBooleanBitsArray[2] ^ inputOutputBooleanBitsArray[3] ^ inputOutputBooleanBitsArray[4] ^ inputOutputBooleanBitsArray[5] ^ inputOutputBooleanBitsArray[7] ^ inputOutputBooleanBitsArray[9] ^ inputOutputBooleanBitsArray[10];
-	inputOutputBooleanBitsArray[14] = inputOutputBooleanBitsArray[0] ^ inputOutputBooleanBitsArray[1] ^ inputOutputBooleanBitsArray[2] ^ inputOutputBooleanBitsArray[4] ^ inputOutputBooleanBitsArray[6] ^ inputOutputBooleanBitsArray[7] ^ inputOutputBooleanBitsArray[10];
-
-	if (is16114)
-	{
-		inputOutputBooleanBitsArray[15] = inputOutputBooleanBitsArray[0] ^ inputOutputBooleanBitsArray[2] ^ inputOutputBooleanBitsArray[5] ^ inputOutputBooleanBitsArray[6] ^ inputOutputBooleanBitsArray[8] ^ inputOutputBooleanBitsArray[9] ^ inputOutputBooleanBitsArray[10];
-	}
-}
-
-static uint8_t hammingGetBits(bool *inputOutputBooleanBitsArray, bool is16114)
-{
-	uint8_t n;
-
-	n  = ((inputOutputBooleanBitsArray[0] ^ inputOutputBooleanBitsArray[1] ^ inputOutputBooleanBitsArray[2] ^ inputOutputBooleanBitsArray[3] ^ inputOutputBooleanBitsArray[5] ^ inputOutputBooleanBitsArray[7] ^ inputOutputBooleanBitsArray[8]) != inputOutputBooleanBitsArray[11]) ? 0x01 : 0x00;
-	n |= ((inputOutputBooleanBitsArray[1] ^ inputOutputBooleanBitsArray[2] ^ inputOutputBooleanBitsArray[3] ^ inputOutputBooleanBitsArray[4] ^ inputOutputBooleanBitsArray[6] ^ inputOutputBooleanBitsArray[8] ^ inputOutputBooleanBitsArray[9]) != inputOutputBooleanBitsArray[12]) ? 0x02 : 0x00;
-	n |= ((inputOutputBooleanBitsArray[2] ^ inputOutputBooleanBitsArray[3] ^ inputOutputBooleanBitsArray[4] ^ inputOutputBooleanBitsArray[5] ^ inputOutputBooleanBitsArray[7] ^ inputOutputBooleanBitsArray[9] ^ inputOutputBooleanBitsArray[10]) != inputOutputBooleanBitsArray[13]) ? 0x04 : 0x00;
-	n |= ((inputOutputBooleanBitsArray[0] ^ inputOutputBooleanBitsArray[1] ^ inputOutputBooleanBitsArray[2] ^ inputOutputBooleanBitsArray[4] ^ inputOutputBooleanBitsArray[6] ^ inputOutputBooleanBitsArray[7] ^ inputOutputBooleanBitsArray[10]) != inputOutputBooleanBitsArray[14]) ? 0x08 : 0x00;
-
-	if (is16114)
-	{
-		n |= ((inputOutputBooleanBitsArray[0] ^ inputOutputBooleanBitsArray[2] ^ inputOutputBooleanBitsArray[5] ^ inputOutputBooleanBitsArray[6] ^ inputOutputBooleanBitsArray[8] ^ inputOutputBooleanBitsArray[9] ^ inputOutputBooleanBitsArray[10]) != inputOutputBooleanBitsArray[15]) ? 0x10 : 0x00;
-	}
-
-	return n;
-}
-
 static void embeddedDataEncodeEmbeddedData(void)
 {
-	bool data[128];
-	uint32_t arrayIndex = 0;
-
-	uint32_t crc = CRC_encodeFiveBit(embeddedDataProcessed);
-
-	memset(data, 0, 128 * sizeof(bool));
-
-	data[106] = (crc & 0x01) == 0x01;
-	data[90]  = (crc & 0x02) == 0x02;
-	data[74]  = (crc & 0x04) == 0x04;
-	data[58]  = (crc & 0x08) == 0x08;
-	data[42]  = (crc & 0x10) == 0x10;
-
-	for (int range = 0; range < 7; range++)
-	{
-		for (uint32_t i = embedddataCopyRanges[range][0]; i <= embedddataCopyRanges[range][1]; i++, arrayIndex++)
-		{
-			data[i] = embeddedDataProcessed[arrayIndex];
-		}
-	}
-
-	for (int i = 0; i < 112; i += 16)
-	{
-		hammingEncode(data + i, true);
-	}
-
-	for (int i = 0; i < 16; i++)
-	{
-		data[i + 112] = data[i + 0] ^ data[i + 16] ^ data[i + 32] ^ data[i + 48] ^ data[i + 64] ^ data[i + 80] ^ data[i + 96];
-	}
-
-	arrayIndex = 0;
-	for (int i = 0; i < 128; i++)
-	{
-		embeddedDataRaw[i] = data[arrayIndex];
-		arrayIndex += 16;
-		if (arrayIndex > 127)
-		{
-			arrayIndex -= 127;
-		}
-	}
+	dmrFECEmbeddedDataEncode(embeddedDataProcessed, embeddedDataRaw);
 }
 
 static void embeddedDataDecodeEmbeddedData(void)
 {
-	uint32_t crc = 0;
-	bool tmpBooleanBitsArray[128];
-	int bitArrayIndex = 0;
-
-	memset(tmpBooleanBitsArray, 0, 128 * sizeof(bool));
-
-	for (int i = 0; i < 128; i++)
-	{
-		tmpBooleanBitsArray[bitArrayIndex] = embeddedDataRaw[i];
-		bitArrayIndex += 16;
-		if (bitArrayIndex > 127)
-		{
-			bitArrayIndex -= 127;
-		}
-	}
-
-	for (int i = 0; i < 112; i += 16)
-	{
-		if (!hammingDecodeType1(tmpBooleanBitsArray + i))
-		{
-			return;
-		}
-	}
-
-	// Check parity
-	for (int i = 0; i < 16; i++)
-	{
-		bool parity = tmpBooleanBitsArray[i + 0] ^ tmpBooleanBitsArray[i + 16] ^ tmpBooleanBitsArray[i + 32] ^ tmpBooleanBitsArray[i + 48] ^ tmpBooleanBitsArray[i + 64] ^ tmpBooleanBitsArray[i + 80] ^ tmpBooleanBitsArray[i + 96] ^ tmpBooleanBitsArray[i + 112];
-		if (parity)
-		{
-			return;
-		}
-	}
-
-	bitArrayIndex = 0;
-
-	for (int range = 0; range < 7; range++)
-	{
-		for (uint32_t i = embedddataCopyRanges[range][0]; i <= embedddataCopyRanges[range][1]; i++, bitArrayIndex++)
-		{
-			embeddedDataProcessed[bitArrayIndex] = tmpBooleanBitsArray[i];
-		}
-	}
-
-	if (tmpBooleanBitsArray[42])
-	{
-		crc += 16;
-	}
-
-	if (tmpBooleanBitsArray[58])
-	{
-		crc += 8;
-	}
-
-	if (tmpBooleanBitsArray[74])
-	{
-		crc += 4;
-	}
-
-	if (tmpBooleanBitsArray[90])
-	{
-		crc += 2;
-	}
-
-	if (tmpBooleanBitsArray[106])
-	{
-		crc += 1;
-	}
-
-	if (crc != CRC_encodeFiveBit(embeddedDataProcessed))
-	{
-		return;
-	}
-
-	embeddedDataIsValid = true;
-
-	uint8_t flco = BooleanBitsArrayToByte(embeddedDataProcessed + 0);
-	embeddedDataFLCO = (int)(flco & 0x3F);
-}
-
-static uint32_t CRC_encodeFiveBit(const bool *in)
-{
-	uint32_t total = 0;
-
-	for (int i = 0; i < 72; i += 8)
-	{
-		total += BooleanBitsArrayToByte(in + i);
-	}
-
-	total %= 31;
-
-	return total;
-}
-
-static void byteToBooleanBitsArray(uint8_t byteIn, bool *bitsOut)
-{
-	for (int i = 0, shift = 7; i < 8; i++, shift--)
+	if (dmrFECEmbeddedDataDecode(embeddedDataRaw, embeddedDataProcessed))
 	{
-		bitsOut[i] = (byteIn >> shift) & 0x01;
+		embeddedDataIsValid = true;
+		embeddedDataFLCO = (int)(embeddedDataProcessed[0] & 0x3F);
 	}
 }
 
-static uint8_t BooleanBitsArrayToByte(const bool *bitsIn)
-{
-	uint8_t out = 0;
-	for (int i = 0, shift = 7; i < 8; i++, shift--)
-	{
-		out  |= bitsIn[i] << shift;
-	}
-	return out;
-}
-
 void cwProcess(void)
 {
 	if (hotspotCwpoLen == 0)
@@ -1094,7 +681,7 @@ static void getStatus(void)
 	buf[6]  = 0; // No DSTAR space
 
 	buf[7]  = 10; // DMR Simplex
-	buf[8]  = (HOTSPOT_BUFFER_COUNT - wavbuffer_count); // DMR space
+	buf[8]  = (HOTSPOT_BUFFER_COUNT - (netQueue.head - netQueue.tail)); // DMR space
 
 	buf[9]  = 0; // No YSF space
 	buf[10] = 0; // No P25 space
@@ -1728,65 +1315,122 @@ void handleHotspotRequest(void)
 }
 
 
-// Queue system is a single byte header containing the length of the item, followed by the data
-// if the block won't fit in the space between the current write location and the end of the buffer,
-// a zero is written to the length for that block and the data and its length byte is put at the beginning of the buffer
+static void queuePublish(hotspotQueue_t *queue, uint32_t head)
+{
+	uint32_t count;
+
+	__DMB(); // The data has to be written before the consumer can see the new head
+	queue->head = head;
+
+	count = (head - queue->tail);
+	if (count > queue->highWatermark)
+	{
+		queue->highWatermark = count;
+	}
+}
+
+static void queueRelease(hotspotQueue_t *queue, uint32_t tail)
+{
+	__DMB(); // The data has to be read before the producer can reuse the space
+	queue->tail = tail;
+}
+
+// Only to be used when neither the producer nor the consumer is running
+static void queueReset(hotspotQueue_t *queue)
+{
+	memset(queue, 0, sizeof(hotspotQueue_t));
+}
+
+// The network queue is flushed by its producer, when the HR-C6000 is not transmitting.
+static void netQueueFlush(void)
+{
+	taskENTER_CRITICAL();
+	netQueue.tail = netQueue.head;
+	netQueueRanDry = false;
+	taskEXIT_CRITICAL();
+}
+
+// Queue system is a single byte header containing the length of the item, followed by the data.
+// If the block won't fit in the space between the current write location and the end of the queue,
+// a zero length record is written there and the block is put at the beginning of the queue.
+// Hence a genuine zero length record can't be queued, it would be taken for that padding.
 void enqueueUSBData(uint8_t *data, uint8_t length)
 {
-	if ((usbComSendBufWritePosition + (length + 1)) > (COM_BUFFER_SIZE - 1))
+	uint32_t head = usbQueue.head;
+	uint32_t pos = (head & (HOTSPOT_USB_QUEUE_SIZE - 1));
+	uint32_t padding = 0;
+
+	if (length == 0)
 	{
-		usbComSendBuf[usbComSendBufWritePosition] = 0xFF; // flag that the data block won't fit and will be put at the start of the buffer
-		usbComSendBufWritePosition = 0;
+		return;
 	}
 
-	usbComSendBuf[usbComSendBufWritePosition] = length;
-	memcpy((uint8_t *)&usbComSendBuf[usbComSendBufWritePosition + 1], data, length);
-	usbComSendBufWritePosition += (length + 1);
-	usbComSendBufCount++;
+	if ((pos + length + 1) > HOTSPOT_USB_QUEUE_SIZE)
+	{
+		padding = (HOTSPOT_USB_QUEUE_SIZE - pos);
+	}
 
-	if (length <= 1)
+	if ((HOTSPOT_USB_QUEUE_SIZE - (head - usbQueue.tail)) < (padding + length + 1))
 	{
-		// Blah
+		usbQueue.overflows++;
+		return;
 	}
 
+	if (padding > 0)
+	{
+		usbComSendBuf[pos] = HOTSPOT_USB_QUEUE_PADDING;
+		head += padding;
+		pos = 0;
+	}
+
+	usbComSendBuf[pos] = length;
+	memcpy((uint8_t *)&usbComSendBuf[pos + 1], data, length);
+	queuePublish(&usbQueue, (head + length + 1));
 }
 
 void processUSBDataQueue(void)
 {
-	if (usbComSendBufCount > 0)
+	uint32_t tail = usbQueue.tail;
+
+	if (usbQueue.head != tail)
 	{
-		if (usbComSendBuf[usbComSendBufReadPosition] == 0xFF) // End marker
+		uint32_t pos = (tail & (HOTSPOT_USB_QUEUE_SIZE - 1));
+
+		__DMB();
+
+		if (usbComSendBuf[pos] == HOTSPOT_USB_QUEUE_PADDING)
 		{
-			usbComSendBuf[usbComSendBufReadPosition] = 0;
-			usbComSendBufReadPosition = 0;
+			tail += (HOTSPOT_USB_QUEUE_SIZE - pos);
+			queueRelease(&usbQueue, tail);
+
+			if (usbQueue.head == tail)
+			{
+				return;
+			}
+
+			pos = 0;
+			__DMB();
 		}
 
-		uint8_t len = usbComSendBuf[usbComSendBufReadPosition] + 1;
+		uint8_t len = usbComSendBuf[pos] + 1;
 
 		if (len < (3 + 1)) // the shortest MMDVM frame length (3 = DMRLost)
 		{
-			usbComSendBufCount--;
+			queueRelease(&usbQueue, (tail + len));
 		}
 		else
 		{
 #if defined(STM32F405xx)
-			uint8_t status = CDC_Transmit_FS((uint8_t *)&usbComSendBuf[usbComSendBufReadPosition + 1], usbComSendBuf[usbComSendBufReadPosition]);
+			uint8_t status = CDC_Transmit_FS((uint8_t *)&usbComSendBuf[pos + 1], usbComSendBuf[pos]);
 
 			if (status == USBD_OK)
 #else
-			usb_status_t status = USB_DeviceCdcAcmSend(s_cdcVcom.cdcAcmHandle, USB_CDC_VCOM_BULK_IN_ENDPOINT, &usbComSendBuf[usbComSendBufReadPosition + 1], usbComSendBuf[usbComSendBufReadPosition]);
+			usb_status_t status = USB_DeviceCdcAcmSend(s_cdcVcom.cdcAcmHandle, USB_CDC_VCOM_BULK_IN_ENDPOINT, &usbComSendBuf[pos + 1], usbComSendBuf[pos]);
 
 			if (status == kStatus_USB_Success)
 #endif
 			{
-				usbComSendBufReadPosition += len;
-
-				if (usbComSendBufReadPosition >= (COM_BUFFER_SIZE - 1)) // reaching the end of the buffer
-				{
-					usbComSendBufReadPosition = 0;
-				}
-
-				usbComSendBufCount--;
+				queueRelease(&usbQueue, (tail + len));
 			}
 			else
 			{
@@ -1927,9 +1571,48 @@ static void sendTerminator_LC_Frame(volatile const uint8_t *receivedDMRDataAndAu
 
 void hotspotRxFrameHandler(uint8_t* frameBuf) // It's called by and ISR in HRC-6000 code.
 {
-	memcpy((uint8_t *)&audioAndHotspotDataBuffer.hotspotBuffer[rfFrameBufWriteIdx], frameBuf, AMBE_AUDIO_LENGTH + LC_DATA_LENGTH + 2);// 27 audio + 0x0c header + 2 hotspot signalling bytes
-	rfFrameBufCount++;
-	rfFrameBufWriteIdx = ((rfFrameBufWriteIdx + 1) % HOTSPOT_BUFFER_COUNT);
+	uint32_t head = rfQueue.head;
+
+	if ((head - rfQueue.tail) >= HOTSPOT_BUFFER_COUNT)
+	{
+		rfQueue.overflows++;
+		return;
+	}
+
+	memcpy((uint8_t *)&audioAndHotspotDataBuffer.hotspotBuffer[head & (HOTSPOT_BUFFER_COUNT - 1)], frameBuf, AMBE_AUDIO_LENGTH + LC_DATA_LENGTH + 2);// 27 audio + 0x0c header + 2 hotspot signalling bytes
+	queuePublish(&rfQueue, (head + 1));
+}
+
+// Called by the HR-C6000 code, to get the first frame to transmit without removing it from the queue
+void hotspotPeekNetFrame(uint8_t *frameBuf)
+{
+	__DMB();
+	memcpy(frameBuf, (uint8_t *)&audioAndHotspotDataBuffer.hotspotBuffer[netQueue.tail & (HOTSPOT_BUFFER_COUNT - 1)], AMBE_AUDIO_LENGTH + LC_DATA_LENGTH);
+}
+
+// Called by the HR-C6000 code, to get the next frame to transmit
+bool hotspotGetNetFrame(uint8_t *frameBuf)
+{
+	uint32_t tail = netQueue.tail;
+
+	if (netQueue.head == tail)
+	{
+		netQueueRanDry = true;
+		return false;
+	}
+
+	// The queue ran dry in the middle of the transmission
+	if (netQueueRanDry)
+	{
+		netQueue.underflows++;
+		netQueueRanDry = false;
+	}
+
+	__DMB();
+	memcpy(frameBuf, (uint8_t *)&audioAndHotspotDataBuffer.hotspotBuffer[tail & (HOTSPOT_BUFFER_COUNT - 1)], AMBE_AUDIO_LENGTH + LC_DATA_LENGTH);
+	queueRelease(&netQueue, (tail + 1));
+
+	return true;
 }
 
 static bool getEmbeddedData(volatile const uint8_t *comBuffer)
@@ -2051,20 +1734,23 @@ static void storeNetFrame(volatile const uint8_t *comBuffer)
 		hotspotState == HOTSPOT_STATE_TX_SHUTDOWN  ||
 		hotspotState == HOTSPOT_STATE_TX_START_BUFFERING)
 	{
-		if (wavbuffer_count >= HOTSPOT_BUFFER_COUNT)
+		uint32_t head = netQueue.head;
+
+		if ((head - netQueue.tail) >= HOTSPOT_BUFFER_COUNT)
 		{
-			// Buffer overflow
+			// Buffer overflow, MMDVMHost is sending faster than we transmit
+			netQueue.overflows++;
+			return;
 		}
 
-		taskENTER_CRITICAL();
-		memcpy((uint8_t *)&audioAndHotspotDataBuffer.hotspotBuffer[wavbuffer_write_idx][LC_DATA_LENGTH], (uint8_t *)comBuffer + 4, 13);//copy the first 13, whole bytes of audio
-		audioAndHotspotDataBuffer.hotspotBuffer[wavbuffer_write_idx][LC_DATA_LENGTH + 13] = (comBuffer[17] & 0xF0) | (comBuffer[23] & 0x0F);
-		memcpy((uint8_t *)&audioAndHotspotDataBuffer.hotspotBuffer[wavbuffer_write_idx][LC_DATA_LENGTH + 14], (uint8_t *)&comBuffer[24], 13);//copy the last 13, whole bytes of audio
+		volatile uint8_t *frame = audioAndHotspotDataBuffer.hotspotBuffer[head & (HOTSPOT_BUFFER_COUNT - 1)];
+
+		memcpy((uint8_t *)&frame[LC_DATA_LENGTH], (uint8_t *)comBuffer + 4, 13);//copy the first 13, whole bytes of audio
+		frame[LC_DATA_LENGTH + 13] = (comBuffer[17] & 0xF0) | (comBuffer[23] & 0x0F);
+		memcpy((uint8_t *)&frame[LC_DATA_LENGTH + 14], (uint8_t *)&comBuffer[24], 13);//copy the last 13, whole bytes of audio
 
-		memcpy((uint8_t *)&audioAndHotspotDataBuffer.hotspotBuffer[wavbuffer_write_idx], hotspotTxLC, 9);// copy the current LC into the data (mainly for use with the embedded data);
-		wavbuffer_count++;
-		wavbuffer_write_idx = ((wavbuffer_write_idx + 1) % HOTSPOT_BUFFER_COUNT);
-		taskEXIT_CRITICAL();
+		memcpy((uint8_t *)frame, hotspotTxLC, 9);// copy the current LC into the data (mainly for use with the embedded data);
+		queuePublish(&netQueue, (head + 1));
 	}
 }
 
@@ -2081,6 +1767,11 @@ static uint8_t hotspotModeReceiveNetFrame(const uint8_t *comBuffer, uint8_t time
 
 	netRXDataTimer = RX_NET_FRAME_TIMEOUT;
 
+	if (comBuffer[3] & DMR_SYNC_DATA)
+	{
+		hotspotModeReceiveNetDataFrame((uint8_t *)comBuffer + MMDVM_HEADER_LENGTH, (comBuffer[3] & 0x0F));
+	}
+
 	lc.srcId = 0;// zero these values as they are checked later in the function, but only updated if the data type is DT_VOICE_LC_HEADER
 	lc.dstId = 0;
 
@@ -2105,12 +1796,48 @@ static uint8_t hotspotModeReceiveNetFrame(const uint8_t *comBuffer, uint8_t time
 	}
 	else
 	{
+		PROFILER_ENTER(PROFILER_SITE_HOTSPOT_STORE_NET_FRAME);
 		storeNetFrame(comBuffer);
+		PROFILER_EXIT(PROFILER_SITE_HOTSPOT_STORE_NET_FRAME);
 	}
 
 	return 0;
 }
 
+// Reassembles the data messages (SMS, short data) sent by the network, and shows their text.
+static void hotspotModeReceiveNetDataFrame(const uint8_t *frame, uint8_t dataType)
+{
+	uint8_t payload[DMR_DATA_RATE_34_BLOCK_LENGTH];
+	dmrDataResult_t result;
+
+	switch (dataType)
+	{
+		case DT_DATA_HEADER:
+			dmrFECBPTC19696Decode(frame, payload);
+			dmrDataAddHeader(payload);
+			return;
+
+		case DT_RATE_12_DATA:
+			dmrFECBPTC19696Decode(frame, payload);
+			result = dmrDataAddBlock(payload, DMR_DATA_RATE_12_BLOCK_LENGTH);
+			break;
+
+		case DT_RATE_34_DATA:
+			dmrDataTrellisDecode(frame, payload);
+			result = dmrDataAddBlock(payload, DMR_DATA_RATE_34_BLOCK_LENGTH);
+			break;
+
+		default:
+			return;
+	}
+
+	if (result == DMR_DATA_RESULT_MESSAGE_COMPLETE)
+	{
+		dmrDataGetMessageText(dmrDataGetMessage(), hotspotDataMessageText, sizeof(hotspotDataMessageText));
+		hotspotDataMessagePending = (hotspotDataMessageText[0] != 0);
+	}
+}
+
 #if defined(MMDVM_SEND_DEBUG)
 #warning MMDVM_SEND_DEBUG is defined
 void mmdvmSendDebug1(const char *text)
@@ -2227,6 +1954,12 @@ void mmdvmSendDebug5(const char *text, int16_t n1, int16_t n2, int16_t n3, int16
 
 	enqueueUSBData(buf, buf[1]);
 }
+
+// The queue counters are 32-bit, saturate them instead of wrapping to negative values
+static int16_t mmdvmDebugCounter(uint32_t counter)
+{
+	return ((counter > INT16_MAX) ? INT16_MAX : (int16_t)counter);
+}
 #endif
 
 static void sendDMRLost(void)
@@ -2282,7 +2015,7 @@ void hotspotStateMachine(void)
 				trxDisableTransmission();
 			}
 
-			rfFrameBufCount = 0;
+			queueRelease(&rfQueue, rfQueue.head);
 			if (hotspotMmdvmHostIsConnected)
 			{
 				hotspotState = HOTSPOT_STATE_INITIALISE;
@@ -2292,7 +2025,7 @@ void hotspotStateMachine(void)
 				if ((nonVolatileSettings.hotspotType == HOTSPOT_TYPE_MMDVM) &&
 						((ticksGetMillis() - mmdvmHostLastActiveTime) > MMDVMHOST_TIMEOUT))
 				{
-					wavbuffer_count = 0;
+					netQueueFlush();
 
 					hotspotExit();
 					break;
@@ -2301,10 +2034,8 @@ void hotspotStateMachine(void)
 			break;
 
 		case HOTSPOT_STATE_INITIALISE:
-			wavbuffer_read_idx = 0;
-			wavbuffer_write_idx = 0;
-			wavbuffer_count = 0;
-			rfFrameBufCount = 0;
+			netQueueFlush();
+			queueRelease(&rfQueue, rfQueue.head);
 
 			overriddenLCAvailable = false;
 
@@ -2321,11 +2052,15 @@ void hotspotStateMachine(void)
 			}
 
 			rxLCFrameSent = false;
-			wavbuffer_read_idx = 0;
-			wavbuffer_write_idx = 0;
-			wavbuffer_count = 0;
+			netQueueFlush();
 			rxFrameTime = ticksGetMillis();
 
+#if defined(MMDVM_SEND_DEBUG)
+			mmdvmSendDebug5("RF Q ovf/max/size", mmdvmDebugCounter(rfQueue.overflows), mmdvmDebugCounter(rfQueue.highWatermark), HOTSPOT_BUFFER_COUNT, 0);
+			mmdvmSendDebug5("Net Q ovf/unf/max/size", mmdvmDebugCounter(netQueue.overflows), mmdvmDebugCounter(netQueue.underflows), mmdvmDebugCounter(netQueue.highWatermark), HOTSPOT_BUFFER_COUNT);
+			mmdvmSendDebug5("USB Q ovf/max/size", mmdvmDebugCounter(usbQueue.overflows), mmdvmDebugCounter(usbQueue.highWatermark), HOTSPOT_USB_QUEUE_SIZE, 0);
+#endif
+
 			hotspotState = HOTSPOT_STATE_RX_PROCESS;
 			break;
 
@@ -2338,8 +2073,8 @@ void hotspotStateMachine(void)
 				{
 					hotspotMmdvmHostIsConnected = false;
 					hotspotState = HOTSPOT_STATE_NOT_CONNECTED;
-					rfFrameBufCount = 0;
-					wavbuffer_count = 0;
+					queueRelease(&rfQueue, rfQueue.head);
+					netQueueFlush();
 
 					hotspotExit();
 					break;
@@ -2348,8 +2083,8 @@ void hotspotStateMachine(void)
 			else
 			{
 				hotspotState = HOTSPOT_STATE_NOT_CONNECTED;
-				rfFrameBufCount = 0;
-				wavbuffer_count = 0;
+				queueRelease(&rfQueue, rfQueue.head);
+				netQueueFlush();
 
 				if (trxTransmissionEnabled)
 				{
@@ -2361,18 +2096,23 @@ void hotspotStateMachine(void)
 				break;
 			}
 
-			if (rfFrameBufCount > 0)
+			if (rfQueue.head != rfQueue.tail)
 			{
+				uint32_t rfQueueTail = rfQueue.tail;
+				volatile uint8_t *rfFrame = audioAndHotspotDataBuffer.hotspotBuffer[rfQueueTail & (HOTSPOT_BUFFER_COUNT - 1)];
+
+				__DMB();
+
 				// We have pending data in RF side, but don't process it when MMDVMHost
 				// set the hotspot in POCSAG mode. Just trash it.
 				if (hotspotModemState == STATE_POCSAG)
 				{
-					memset((void *)&audioAndHotspotDataBuffer.hotspotBuffer[rfFrameBufReadIdx], 0, HOTSPOT_BUFFER_SIZE);
+					memset((void *)rfFrame, 0, HOTSPOT_BUFFER_SIZE);
 				}
 
 				if (MMDVMHostRxState == MMDVMHOST_RX_READY)
 				{
-					uint8_t rx_command = audioAndHotspotDataBuffer.hotspotBuffer[rfFrameBufReadIdx][AMBE_AUDIO_LENGTH + LC_DATA_LENGTH];
+					uint8_t rx_command = rfFrame[AMBE_AUDIO_LENGTH + LC_DATA_LENGTH];
 
 					switch(rx_command)
 					{
@@ -2380,7 +2120,7 @@ void hotspotStateMachine(void)
 							break;
 
 						case HOTSPOT_RX_START:
-							if (sendVoiceHeaderLC_Frame(audioAndHotspotDataBuffer.hotspotBuffer[rfFrameBufReadIdx]))
+							if (sendVoiceHeaderLC_Frame(rfFrame))
 							{
 								rxLCFrameSent = true;
 								uiHotspotUpdateScreen(rx_command);
@@ -2390,7 +2130,7 @@ void hotspotStateMachine(void)
 							break;
 
 						case HOTSPOT_RX_START_LATE:
-							if (sendVoiceHeaderLC_Frame(audioAndHotspotDataBuffer.hotspotBuffer[rfFrameBufReadIdx]))
+							if (sendVoiceHeaderLC_Frame(rfFrame))
 							{
 								rxLCFrameSent = true;
 								uiHotspotUpdateScreen(rx_command);
@@ -2402,7 +2142,7 @@ void hotspotStateMachine(void)
 						case HOTSPOT_RX_AUDIO_FRAME:
 							if (rxLCFrameSent)
 							{
-								if (hotspotSendVoiceFrame(audioAndHotspotDataBuffer.hotspotBuffer[rfFrameBufReadIdx]))
+								if (hotspotSendVoiceFrame(rfFrame))
 								{
 									lastRxState = HOTSPOT_RX_AUDIO_FRAME;
 									rxFrameTime = ticksGetMillis();
@@ -2412,7 +2152,7 @@ void hotspotStateMachine(void)
 							{
 								// Under some conditions, starting frames were missed, probably due to frequency instabilities.
 								// This will pick the LC data from this voice frame, and send a voice frame header to MMDVMHost.
-								if (sendVoiceHeaderLC_Frame(audioAndHotspotDataBuffer.hotspotBuffer[rfFrameBufReadIdx]))
+								if (sendVoiceHeaderLC_Frame(rfFrame))
 								{
 									rxLCFrameSent = true;
 									uiHotspotUpdateScreen(HOTSPOT_RX_START_LATE);
@@ -2426,7 +2166,7 @@ void hotspotStateMachine(void)
 							uiHotspotUpdateScreen(rx_command);
 							if (rxLCFrameSent)
 							{
-								sendTerminator_LC_Frame(audioAndHotspotDataBuffer.hotspotBuffer[rfFrameBufReadIdx]);
+								sendTerminator_LC_Frame(rfFrame);
 							}
 							lastRxState = HOTSPOT_RX_STOP;
 							hotspotState = HOTSPOT_STATE_RX_END;
@@ -2437,13 +2177,8 @@ void hotspotStateMachine(void)
 							break;
 					}
 
-					memset((void *)&audioAndHotspotDataBuffer.hotspotBuffer[rfFrameBufReadIdx], 0, HOTSPOT_BUFFER_SIZE);
-					rfFrameBufReadIdx = ((rfFrameBufReadIdx + 1) % HOTSPOT_BUFFER_COUNT);
-
-					if (rfFrameBufCount > 0)
-					{
-						rfFrameBufCount--;
-					}
+					memset((void *)rfFrame, 0, HOTSPOT_BUFFER_SIZE);
+					queueRelease(&rfQueue, (rfQueueTail + 1));
 				}
 				else
 				{
@@ -2461,7 +2196,7 @@ void hotspotStateMachine(void)
 					uiHotspotUpdateScreen(HOTSPOT_RX_IDLE);
 					lastRxState = HOTSPOT_RX_STOP;
 					hotspotState = HOTSPOT_STATE_RX_END;
-					rfFrameBufCount = 0;
+					queueRelease(&rfQueue, rfQueue.head);
 					return;
 				}
 			}
@@ -2480,7 +2215,7 @@ void hotspotStateMachine(void)
 				//wavbuffer_read_idx = 0;
 				//wavbuffer_write_idx = 0;
 				//wavbuffer_count = 0;
-				rfFrameBufCount = 0;
+				queueRelease(&rfQueue, rfQueue.head);
 				lastRxState = HOTSPOT_RX_IDLE;
 				hotspotState = HOTSPOT_STATE_TX_SHUTDOWN;
 				hotspotMmdvmHostIsConnected = false;
@@ -2490,7 +2225,7 @@ void hotspotStateMachine(void)
 			}
 			else
 			{
-				if (wavbuffer_count > TX_BUFFER_MIN_BEFORE_TRANSMISSION)
+				if ((netQueue.head - netQueue.tail) > TX_BUFFER_MIN_BEFORE_TRANSMISSION)
 				{
 					if (hotspotCwKeying == false)
 					{
@@ -2516,7 +2251,7 @@ void hotspotStateMachine(void)
 
 		case HOTSPOT_STATE_TRANSMITTING:
 			// Stop transmitting when there is no data in the buffer or if MMDVMHost sends the idle command
-			if (((wavbuffer_count == 0) && (--netRXDataTimer <= 0)) || (hotspotModemState == STATE_IDLE))
+			if (((netQueue.head == netQueue.tail) && (--netRXDataTimer <= 0)) || (hotspotModemState == STATE_IDLE))
 			{
 				hotspotState = HOTSPOT_STATE_TX_SHUTDOWN;
 				txStopDelay = ((hotspotModemState == STATE_IDLE) ? TX_BUFFERING_TIMEOUT : (TX_BUFFERING_TIMEOUT * 2));
@@ -2530,7 +2265,7 @@ void hotspotStateMachine(void)
 				txStopDelay--;
 
 				// Some data appeared in the buffer while shutting down, restart buffering.
-				if (wavbuffer_count > 0)
+				if (netQueue.head != netQueue.tail)
 				{
 					// restart
 					timeoutCounter = TX_BUFFERING_TIMEOUT;
@@ -2626,14 +2361,25 @@ static uint8_t setFreq(const uint8_t *data, uint8_t length)
   return 0;
 }
 
+// Overflow flags are reported once, like MMDVM does
 static bool hasRXOverflow(void)
 {
-	return ((HOTSPOT_BUFFER_SIZE - rfFrameBufCount) <= 0);
+	uint32_t overflows = rfQueue.overflows;
+	bool overflowed = (overflows != rfQueueReportedOverflows);
+
+	rfQueueReportedOverflows = overflows;
+
+	return overflowed;
 }
 
 static bool hasTXOverflow(void)
 {
-	return ((HOTSPOT_BUFFER_COUNT - wavbuffer_count) <= 0);
+	uint32_t overflows = netQueue.overflows;
+	bool overflowed = (overflows != netQueueReportedOverflows);
+
+	netQueueReportedOverflows = overflows;
+
+	return overflowed;
 }
 
 void hotspotInit(void)
@@ -2653,19 +2399,19 @@ void hotspotInit(void)
 
 	rxLCFrameSent = false;
 
-	// Clear RF buffers
-	rfFrameBufCount = 0;
-	rfFrameBufReadIdx = 0;
-	rfFrameBufWriteIdx = 0;
+	// Clear RF and network buffers
+	queueReset(&rfQueue);
+	queueReset(&netQueue);
+	netQueueRanDry = false;
+	rfQueueReportedOverflows = 0;
+	netQueueReportedOverflows = 0;
 	for (uint8_t i = 0; i < HOTSPOT_BUFFER_COUNT; i++)
 	{
 		memset((void *)&audioAndHotspotDataBuffer.hotspotBuffer[i], 0, HOTSPOT_BUFFER_SIZE);
 	}
 
 	// Clear USB TX buffers
-	usbComSendBufWritePosition = 0;
-	usbComSendBufReadPosition = 0;
-	usbComSendBufCount = 0;
+	queueReset(&usbQueue);
 	memset((uint8_t *)&usbComSendBuf, 0, sizeof(usbComSendBuf));
 
 	trxSetModeAndBandwidth(RADIO_MODE_DIGITAL, false);// hotspot mode is for DMR i.e Digital mode
@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2024 Roger Clark, VK3KYY / G4KYF
+ *                    Daniel Caujolle-Bert, F1RMB
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+ *    in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. Use of this source code or binary releases for commercial purposes is strictly forbidden. This includes, without limitation,
+ *    incorporation in a commercial product or incorporation into a product or project which allows commercial use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <string.h>
+#include "functions/lastHeardList.h"
+
+// DMR ID hash index over callsList (items with a 0 ID are not indexed)
+static LinkItem_t *lastHeardHashBuckets[LASTHEARD_HASH_BUCKETS];
+
+
+static inline uint32_t lastHeardHashBucket(uint32_t id)
+{
+	return ((id * 2654435761U) >> 16) & (LASTHEARD_HASH_BUCKETS - 1);
+}
+
+static void lastHeardHashInsert(LinkItem_t *item)
+{
+	uint32_t bucket = lastHeardHashBucket(item->id);
+
+	item->hashNext = lastHeardHashBuckets[bucket];
+	lastHeardHashBuckets[bucket] = item;
+}
+
+static void lastHeardHashRemove(LinkItem_t *item)
+{
+	LinkItem_t **link = &lastHeardHashBuckets[lastHeardHashBucket(item->id)];
+
+	while (*link != NULL)
+	{
+		if (*link == item)
+		{
+			*link = item->hashNext;
+			break;
+		}
+
+		link = &(*link)->hashNext;
+	}
+
+	item->hashNext = NULL;
+}
+
+void lastHeardListClearIndex(void)
+{
+	memset(lastHeardHashBuckets, 0, sizeof(lastHeardHashBuckets));
+}
+
+LinkItem_t *lastHeardFindInList(uint32_t id)
+{
+	if (id != 0)
+	{
+		LinkItem_t *item = lastHeardHashBuckets[lastHeardHashBucket(id)];
+
+		while (item != NULL)
+		{
+			if (item->id == id)
+			{
+				// found it
+				return item;
+			}
+			item = item->hashNext;
+		}
+	}
+
+	return NULL;
+}
+
+// Move an item already in the list to the top of the list
+void lastHeardListMoveToHead(LinkItem_t **head, LinkItem_t *item)
+{
+	if (item == *head)
+	{
+		return;
+	}
+
+	LinkItem_t *next = item->next;
+	LinkItem_t *prev = item->prev;
+
+	// set the previous item to skip this item and link to 'items' next item.
+	prev->next = next;
+
+	if (item->next != NULL)
+	{
+		// not the last in the list
+		next->prev = prev;// backwards link the next item to the item before us in the list.
+	}
+
+	item->next = *head;// link our next item to the item at the head of the list
+
+	(*head)->prev = item;// backwards link the hold head item to the item moving to the top of the list.
+
+	item->prev = NULL;// change the items prev to NULL now we are at teh top of the list
+	*head = item;// Change the global for the head of the link to the item that is to be at the top of the list.
+}
+
+// Evict the last item of the list, and reuse it at the top of the list for the given ID
+LinkItem_t *lastHeardListReuseTail(LinkItem_t **head, uint32_t id)
+{
+	LinkItem_t *item = *head;// setup to traverse the list from the top.
+
+	// need to use the last item in the list as the new item at the top of the list.
+	// find last item in the list
+	while(item->next != NULL)
+	{
+		item = item->next;
+	}
+	//item is now the last
+
+	(item->prev)->next = NULL;// make the previous item the last
+
+	(*head)->prev = item;// set the current head item to back reference this item.
+	item->next = *head;// set this items next to the current head
+	item->prev = NULL;
+	*head = item;// Make this item the new head
+
+	if (item->id != 0)
+	{
+		lastHeardHashRemove(item);// evicted
+	}
+
+	item->id = id;
+	lastHeardHashInsert(item);
+
+	return item;
+}
@@ -0,0 +1,231 @@
+/*
+ * Copyright (C) 2024 Roger Clark, VK3KYY / G4KYF
+ *                    Daniel Caujolle-Bert, F1RMB
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+ *    in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. Use of this source code or binary releases for commercial purposes is strictly forbidden. This includes, without limitation,
+ *    incorporation in a commercial product or incorporation into a product or project which allows commercial use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "functions/nmea.h"
+
+
+static int8_t nmeaHexDigitValue(uint8_t c)
+{
+	if ((c >= '0') && (c <= '9'))
+	{
+		return (c - '0');
+	}
+	else if ((c >= 'A') && (c <= 'F'))
+	{
+		return (c - 'A' + 10);
+	}
+	else if ((c >= 'a') && (c <= 'f'))
+	{
+		return (c - 'a' + 10);
+	}
+
+	return -1;
+}
+
+void nmeaParserReset(nmeaParser_t *parser)
+{
+	parser->state = NMEA_PARSER_STATE_WAIT_START;
+}
+
+//
+// Streaming parser, fed with the received characters: the sentence fields are located and the "*hh" checksum
+// is verified on the fly, so the completed sentence is ready to be used (no second pass over the line).
+// The line hash, used to drop repeated lines, is computed on the way (Fletcher-16, https://en.wikipedia.org/wiki/Fletcher%27s_checksum).
+// A '$' (re)starts a sentence, a <CR> or <LF> ends it. Other control characters and spaces are ignored.
+// Returns true when a sentence is completed, the sentence line is kept even if it isn't valid, as it's also forwarded/logged as is.
+//
+bool nmeaParserProcessChar(nmeaParser_t *parser, nmeaSentence_t *sentence, uint8_t rxchar)
+{
+	if (rxchar == '$')
+	{
+		sentence->line[0] = '$';
+		sentence->length = 1U;
+		sentence->fieldsCount = 1U;
+		sentence->fieldStart[0] = 1U;
+		parser->state = NMEA_PARSER_STATE_FIELDS;
+		parser->checksum = 0U;
+		parser->hashSum0 = rxchar;
+		parser->hashSum1 = rxchar;
+		return false;
+	}
+
+	if (parser->state == NMEA_PARSER_STATE_WAIT_START)
+	{
+		return false;
+	}
+
+	if ((rxchar == '\r') || (rxchar == '\n'))
+	{
+		sentence->line[sentence->length] = 0;
+		sentence->hash = (uint16_t)(((parser->hashSum1 % 255) << 8) | (parser->hashSum0 % 255));
+		sentence->isValid = ((parser->state == NMEA_PARSER_STATE_CHECKSUM_DONE) && (parser->checksum == parser->receivedChecksum));
+		parser->state = NMEA_PARSER_STATE_WAIT_START;
+		return true;
+	}
+
+	if (rxchar < '!')
+	{
+		return false;
+	}
+
+	if (sentence->length >= (NMEA_LINE_LENGTH - 1))
+	{
+		// Too long to be a NMEA sentence, dropped
+		parser->state = NMEA_PARSER_STATE_WAIT_START;
+		return false;
+	}
+
+	sentence->line[sentence->length++] = rxchar;
+	parser->hashSum0 += rxchar;
+	parser->hashSum1 += parser->hashSum0;
+
+	switch (parser->state)
+	{
+		case NMEA_PARSER_STATE_FIELDS:
+			if (rxchar == '*')
+			{
+				sentence->fieldStart[sentence->fieldsCount] = sentence->length;
+				parser->state = NMEA_PARSER_STATE_CHECKSUM_HIGH;
+			}
+			else
+			{
+				parser->checksum ^= rxchar;
+
+				if (rxchar == ',')
+				{
+					if (sentence->fieldsCount < NMEA_FIELDS_MAX)
+					{
+						sentence->fieldStart[sentence->fieldsCount++] = sentence->length;
+					}
+					else
+					{
+						parser->state = NMEA_PARSER_STATE_INVALID;
+					}
+				}
+			}
+			break;
+
+		case NMEA_PARSER_STATE_CHECKSUM_HIGH:
+		case NMEA_PARSER_STATE_CHECKSUM_LOW:
+		{
+			int8_t digit = nmeaHexDigitValue(rxchar);
+
+			if (digit < 0)
+			{
+				parser->state = NMEA_PARSER_STATE_INVALID;
+			}
+			else if (parser->state == NMEA_PARSER_STATE_CHECKSUM_HIGH)
+			{
+				parser->receivedChecksum = (digit << 4);
+				parser->state = NMEA_PARSER_STATE_CHECKSUM_LOW;
+			}
+			else
+			{
+				parser->receivedChecksum |= digit;
+				parser->state = NMEA_PARSER_STATE_CHECKSUM_DONE;
+			}
+		}
+		break;
+
+		case NMEA_PARSER_STATE_CHECKSUM_DONE: // Trailing characters
+			parser->state = NMEA_PARSER_STATE_INVALID;
+			break;
+
+		default:
+			break;
+	}
+
+	return false;
+}
+
+const char *nmeaGetField(const nmeaSentence_t *sentence, uint8_t field)
+{
+	return ((field < sentence->fieldsCount) ? &sentence->line[sentence->fieldStart[field]] : "");
+}
+
+uint8_t nmeaGetFieldLength(const nmeaSentence_t *sentence, uint8_t field)
+{
+	return ((field < sentence->fieldsCount) ? (sentence->fieldStart[field + 1] - sentence->fieldStart[field] - 1) : 0U);
+}
+
+// Parses a decimal field as a fixed point value with the given number of decimals (extra decimals are truncated).
+// Returns false if the field is empty or isn't a number.
+bool nmeaGetFieldFixedPoint(const nmeaSentence_t *sentence, uint8_t field, uint8_t decimals, int32_t *value)
+{
+	const char *p = nmeaGetField(sentence, field);
+	uint8_t length = nmeaGetFieldLength(sentence, field);
+	bool isNegative = false;
+	bool hasDigits = false;
+	bool inFraction = false;
+	uint32_t v = 0U;
+
+	if ((length > 0U) && ((*p == '-') || (*p == '+')))
+	{
+		isNegative = (*p == '-');
+		p++;
+		length--;
+	}
+
+	while (length > 0U)
+	{
+		if ((*p >= '0') && (*p <= '9'))
+		{
+			if ((inFraction == false) || (decimals > 0U))
+			{
+				v = (v * 10U) + (*p - '0');
+
+				if (inFraction)
+				{
+					decimals--;
+				}
+			}
+			hasDigits = true;
+		}
+		else if ((*p == '.') && (inFraction == false))
+		{
+			inFraction = true;
+		}
+		else
+		{
+			return false;
+		}
+
+		p++;
+		length--;
+	}
+
+	while (decimals > 0U)
+	{
+		v *= 10U;
+		decimals--;
+	}
+
+	*value = (isNegative ? -((int32_t)v) : (int32_t)v);
+
+	return hasDigits;
+}
@@ -30,11 +30,9 @@
 #include <string.h>
 #include <ctype.h>
 #include <math.h>
+#include <float.h>
 #include "functions/satellite.h"
-#include "interfaces/pit.h"
 #include "user_interface/uiGlobals.h"
-#include "user_interface/menuSystem.h"
-#include "user_interface/uiUtilities.h"
 
 #if defined(USING_EXTERNAL_DEBUGGER)
 #include "SeggerRTT/RTT/SEGGER_RTT.h"
@@ -52,9 +50,33 @@ static void satelliteSetElementsTLE2Native(float YE_in,  float TE_in,  float M2_
 // Tropical year, days
 #define SATELLITE_YT 365.2421970
 
-const int SATELLITE_PREDICTION_INITIAL_TIME_STEP = 256;
+// Horizon crossing search steps (secs). Passes shorter than the minimum step may be missed.
+#define SATELLITE_PREDICTION_MIN_TIME_STEP   60
+#define SATELLITE_PREDICTION_MAX_TIME_STEP   3600
+// LOS search step, as a fraction of the orbital period
+#define SATELLITE_PREDICTION_LOS_PERIOD_DIVIDER  16
+// Maximum elevation search iteration limit
+#define SATELLITE_MAX_ELEVATION_MAX_ITERATIONS   20
+// Maximum elevation coarse sampling step (secs) and sample count limit, to bracket the maximum of long (skewed) passes
+#define SATELLITE_MAX_ELEVATION_SAMPLE_STEP      600
+#define SATELLITE_MAX_ELEVATION_MAX_SAMPLES      16
 
-#define FLOAT_ROUNDING_CONSTANT 0.4999999
+#define FLOAT_ROUNDING_CONSTANT 0.4999999f
+
+// Single precision constants, the propagator must not be promoted to (software emulated) double
+#define SATELLITE_TWO_PI            (2.0f * (float)M_PI)
+#define SATELLITE_RAD_TO_DEG        (180.0f / (float)M_PI)
+#define SATELLITE_SECONDS_PER_DAY   86400U
+
+// satelliteDayFn(1970, 1, 1), day number of the unix epoch
+#define SATELLITE_DAY_NUMBER_UNIX_EPOCH 719178
+
+// Newton's method iteration limit, when solving Kepler's equation
+#define SATELLITE_KEPLER_MAX_ITERATIONS 10
+
+// The orbit plane transformation only drifts with the node and perigee precession (a few deg/day),
+// it's recomputed when the elapsed time moves by more than a minute
+#define SATELLITE_PLANE_CACHE_DAYS  (60.0f / SATELLITE_SECONDS_PER_DAY)
 
 
 // WGS-84 Earth Ellipsoid
@@ -91,6 +113,8 @@ const int SATELLITE_PREDICTION_INITIAL_TIME_STEP = 256;
 #define currentSatelliteData_YG  2010
 
 #define currentSatelliteData_G0  99.5578
+// satelliteDayFn(currentSatelliteData_YG, 1, 0)
+#define currentSatelliteData_DAY_NUMBER_YG  733787
 // MA Sun and rate, deg, deg/day
 #define currentSatelliteData_MAS0  356.4485
 #define currentSatelliteData_MASD  0.98560028
@@ -104,6 +128,12 @@ satelliteData_t satelliteDataNative[NUM_SATELLITES];// Store native format Keps
 
 satelliteObserver_t observerData;
 
+// Earth rotation (GHA Aries) for the last calculated time, it's the same for all satellites
+static bool earthRotationIsValid = false;
+static time_t_custom earthRotationDateTimeSecs = 0;
+static float earthRotationCos = 1.0f;
+static float earthRotationSin = 0.0f;
+
 satelliteData_t *currentActiveSatellite;
 static const int MAX_TOTAL_ITERATIONS = 1000;
 
@@ -158,6 +188,8 @@ void satelliteTLE2Native(const char *satelliteName,const uint8_t *kep1,const uin
 		0,					// ALON: Sat attitude (deg)
 		&kepDataOut->keps);
 
+	kepDataOut->propagatorCache.planeT = -FLT_MAX;// forces the plane transformation to be computed
+	kepDataOut->propagatorCache.keplerOffset = 0.0f;
 }
 
 uint32_t satelliteDayFn(int year,int month,int day)
@@ -173,62 +205,37 @@ uint32_t satelliteDayFn(int year,int month,int day)
 
 float satelliteAtnFn(float y,float x)
 {
-	float a;
+	float a = atan2f(y, x);
 
-	if (x != 0.0 )
-    {
-        a = atan(y / x);
-    }
-	else
+	if (a < 0.0f)
 	{
-        a = M_PI / 2.0 * sin(y);
-	}
-
-
-	if (x < 0.0 )
-    {
-		a = a + M_PI;
+		a += SATELLITE_TWO_PI;
 	}
 
-	if (a < 0.0 )
-	{
-		a = a + 2.0 * M_PI;
-	}
 	return a;
 }
 
 static int satelliteGetDoppler(float dopplerFactor, uint32_t freq)
 {
-	int digit;
-	float tally = 0.0;
-	float inBetween;
-	long bare;
-	long factor = dopplerFactor * 1E11;
+	long factor = dopplerFactor * 1E11f;
 
 	freq = (freq + 50000L) / 100000L;
-	for (int x = 4; x > -1; x--)
-	{
-		digit = freq/pow(10,x);
-		bare = digit * pow(10,x);
-		freq = freq - bare;
-		inBetween =  (factor * (float)bare) / 1E6;
-		tally += inBetween;
-	}
-	return (int)(tally + 0.5);
+
+	return (int)((((float)factor * (float)freq) / 1E6f) + 0.5f);
 }
 
 void satelliteSetObserverLocation(float lat,float lon,int height)
 {
 	observerData.LatInRadians = deg2rad(lat);
 	observerData.LonInRadians = deg2rad(lon);
-	observerData.HeightInKilometers = ((float) height)/1000.0; // this needs to be in km
+	observerData.HeightInKilometers = ((float) height)/1000.0f; // this needs to be in km
 
-	float ObserverCosLat = cos(observerData.LatInRadians);
-	float ObserverSinLat = sin(observerData.LatInRadians);
-	float ObserverCosLon = cos(observerData.LonInRadians);
-	float ObserverSineLon = sin(observerData.LonInRadians);
+	float ObserverCosLat = cosf(observerData.LatInRadians);
+	float ObserverSinLat = sinf(observerData.LatInRadians);
+	float ObserverCosLon = cosf(observerData.LonInRadians);
+	float ObserverSineLon = sinf(observerData.LonInRadians);
 
-	float D = sqrt(currentSatelliteData_XX * ObserverCosLat * ObserverCosLat + currentSatelliteData_ZZ * ObserverSinLat * ObserverSinLat);
+	float D = sqrtf(currentSatelliteData_XX * ObserverCosLat * ObserverCosLat + currentSatelliteData_ZZ * ObserverSinLat * ObserverSinLat);
 	float observerRx  = currentSatelliteData_XX / D + observerData.HeightInKilometers;
 	float observerRz = currentSatelliteData_ZZ / D + observerData.HeightInKilometers;
 
@@ -261,8 +268,10 @@ static void satelliteSetElementsTLE2Native(float YE_in,  float TE_in,  float M2_
 	kepDataOut->RA = deg2rad(RA_in);
 	kepDataOut->EC = EC_in;
 	kepDataOut->WP = deg2rad(WP_in);
-	kepDataOut->MA = deg2rad(MA_in);
+	kepDataOut->MA = MA_in / 360.0f;
 	kepDataOut->MM = MM_in * 2.0 * M_PI;
+	kepDataOut->MMRevsHigh = floorf(MM_in * 512.0f) / 512.0f;
+	kepDataOut->MMRevsLow = MM_in - kepDataOut->MMRevsHigh;
 	kepDataOut->N0 = kepDataOut->MM / 86400.0;			// Mean motion rads/s
 	kepDataOut->A0 = pow(currentSatelliteData_GM / kepDataOut->N0 / kepDataOut->N0, 1.0 / 3.0);	// Semi major axis km
 
@@ -271,7 +280,7 @@ static void satelliteSetElementsTLE2Native(float YE_in,  float TE_in,  float M2_
 
 	int TE_IntPart = (int)TE_in;
 	kepDataOut->TE_FloatPart = TE_in - TE_IntPart;
-	kepDataOut->DE = satelliteDayFn(YE_in, 1, 0) + TE_IntPart;
+	kepDataOut->DE = (int32_t)satelliteDayFn(YE_in, 1, 0) + TE_IntPart;
 
 	float IN = deg2rad(IN_in);
 	kepDataOut->SI = sin(IN);
@@ -284,84 +293,106 @@ static void satelliteSetElementsTLE2Native(float YE_in,  float TE_in,  float M2_
 	kepDataOut->WD = PC *(5.0 * kepDataOut->CI * kepDataOut->CI - 1.0) / 2.0;	// Perigee Precession rate, rad/day
 	kepDataOut->DC = -2.0 * kepDataOut->M2 / kepDataOut->MM / 3.0;		// Drag coeff
 
-	// Bring Sun data to satellite epoch
-	float TEG = (kepDataOut->DE - satelliteDayFn(currentSatelliteData_YG, 1, 0)) + kepDataOut->TE_FloatPart;	// Elapsed Time: Epoch - YG
-	kepDataOut->GHAE = deg2rad(currentSatelliteData_G0) + TEG * currentSatelliteData_WE;		// GHA Aries, epoch
+	// Below the horizon, the elevation can't change faster than the satellite angular rate at perigee, plus the earth rotation
+	kepDataOut->ER = kepDataOut->N0 * (1.0 + kepDataOut->EC) * (1.0 + kepDataOut->EC) / pow(1.0 - kepDataOut->EC * kepDataOut->EC, 1.5) + currentSatelliteData_W0;
 }
 
 
-void satelliteCalculateForDateTimeSecs(const satelliteData_t *satelliteData, time_t_custom dateTimeSecs, satelliteResults_t *currentSatelliteData, satellitePredictionLevel_t predictionLevel)
+void satelliteCalculateForDateTimeSecs(satelliteData_t *satelliteData, time_t_custom dateTimeSecs, satelliteResults_t *currentSatelliteData, satellitePredictionLevel_t predictionLevel)
 {
-	struct tm timeAndDate;
-	gmtime_r_Custom(&dateTimeSecs, &timeAndDate);
-
-	uint32_t tmpDN = (uint32_t)satelliteDayFn((timeAndDate.tm_year + 1900),(timeAndDate.tm_mon + 1),timeAndDate.tm_mday);
-	float tmpTN = ((float)timeAndDate.tm_hour + ((float)timeAndDate.tm_min + ((float)timeAndDate.tm_sec/60.0)) /60.0)/24.0;
-
-	float tmpT = (tmpDN - satelliteData->keps.DE) + (tmpTN - satelliteData->keps.TE_FloatPart);//83.848;	// Elapsed T since epoch
-	float tmpDT = satelliteData->keps.DC * tmpT / 2.0;			// Linear drag terms
-	float tmpKD = 1.0 + 4.0 * tmpDT;
-	float tmpKDP = 1.0 - 7.0 * tmpDT;
-	float tmpM = satelliteData->keps.MA + satelliteData->keps.MM * tmpT * (1.0 - 3.0 * tmpDT); 	// Mean anomaly at YR,/ TN
-	int tmpDR = (int)(tmpM / (2.0 * M_PI));		// Strip out whole no of revs
-	tmpM = tmpM - tmpDR * 2.0 * M_PI;              	// M now in range 0 - 2PI
+	const satelliteKeps_t *keps = &satelliteData->keps;
+	satellitePropagatorCache_t *cache = &satelliteData->propagatorCache;
+	int32_t tmpDN = SATELLITE_DAY_NUMBER_UNIX_EPOCH + (int32_t)(dateTimeSecs / SATELLITE_SECONDS_PER_DAY);
+	float tmpTN = (float)(dateTimeSecs % SATELLITE_SECONDS_PER_DAY) / SATELLITE_SECONDS_PER_DAY;
+
+	int32_t tmpTDays = tmpDN - keps->DE;				// Whole days since epoch
+	float tmpTFloatPart = tmpTN - keps->TE_FloatPart;
+	float tmpT = (float)tmpTDays + tmpTFloatPart;		// Elapsed T since epoch
+	float tmpDT = keps->DC * tmpT * 0.5f;			// Linear drag terms
+	float tmpKD = 1.0f + 4.0f * tmpDT;
+	float tmpKDP = 1.0f - 7.0f * tmpDT;
+
+	// Mean anomaly at DN, TN, in revolutions. The whole days product is exact, and its whole revs are
+	// stripped before anything else gets added, otherwise the fraction of rev would lose most of its precision.
+	float tmpM = keps->MMRevsHigh * (float)tmpTDays;
+	tmpM -= truncf(tmpM);
+	tmpM += keps->MA + keps->MMRevsLow * (float)tmpTDays + (keps->MMRevsHigh + keps->MMRevsLow) * (tmpTFloatPart - 3.0f * tmpT * tmpDT);
+	tmpM = (tmpM - floorf(tmpM)) * SATELLITE_TWO_PI;	// M now in range 0 - 2PI
 	//currentSatelliteData.RN = satelliteData->keps.RV + tmpDR + 1;                   	// VK3KYY We don't need to know the Current orbit number
 
-	// Solve M = EA - EC * sin(EA) for EA given M, by Newton's method
-	float tmpEA = tmpM;					// Initail solution
+	// Solve M = EA - EC * sin(EA) for EA given M, by Newton's method.
+	// EA - M varies slowly along the orbit, the previous solution gives the initial one.
+	float tmpEA = tmpM + cache->keplerOffset;
 	float tmp;
 	float tmpDNOM;
 	float tmpC,tmpS;
+	int iterations = 0;
 	do	{
-		tmpC = cos(tmpEA);
-		tmpS = sin(tmpEA);
-		tmpDNOM = 1.0 - satelliteData->keps.EC * tmpC;
-		tmp = (tmpEA - satelliteData->keps.EC * tmpS - tmpM) / tmpDNOM;	// Change EA to better resolution
+		tmpC = cosf(tmpEA);
+		tmpS = sinf(tmpEA);
+		tmpDNOM = 1.0f - keps->EC * tmpC;
+		tmp = (tmpEA - keps->EC * tmpS - tmpM) / tmpDNOM;	// Change EA to better resolution
 		tmpEA = tmpEA - tmp;			// by this amount until converged
-	} while (fabs(tmp) > 1.0E-5 );
+	} while ((fabsf(tmp) > 1.0E-5f) && (++iterations < SATELLITE_KEPLER_MAX_ITERATIONS));
+	cache->keplerOffset = tmpEA - tmpM;
 
 	// Distances
-	float tmpA = satelliteData->keps.A0 * tmpKD;
-	float tmpB = satelliteData->keps.b0 * tmpKD;
+	float tmpA = keps->A0 * tmpKD;
+	float tmpB = keps->b0 * tmpKD;
 #if NEEDS_SATELLITE_LAT_LONG
 	float tmpRS = tmpA * tmpDNOM;
 #endif
 	// Calculate satellite position and velocity in plane of ellipse
-	float tmpSx = tmpA * (tmpC - satelliteData->keps.EC);
-	float tmpVx = -tmpA * tmpS / tmpDNOM * satelliteData->keps.N0;
+	float tmpSx = tmpA * (tmpC - keps->EC);
+	float tmpVx = -tmpA * tmpS / tmpDNOM * keps->N0;
 	float tmpSy = tmpB * tmpS;
-	float tmpVy = tmpB * tmpC / tmpDNOM * satelliteData->keps.N0;
+	float tmpVy = tmpB * tmpC / tmpDNOM * keps->N0;
 
-	float tmpAP = satelliteData->keps.WP + satelliteData->keps.WD * tmpT * tmpKDP;
-	float tmpCWw = cos(tmpAP);
-	float tmpSW = sin(tmpAP);
-	float tmpRAAN =  satelliteData->keps.RA + satelliteData->keps.QD * tmpT * tmpKDP;
-	float tmpCO = cos(tmpRAAN);
-	float tmpSO = sin(tmpRAAN);
+	if (fabsf(tmpT - cache->planeT) > SATELLITE_PLANE_CACHE_DAYS)
+	{
+		float tmpAP = keps->WP + keps->WD * tmpT * tmpKDP;
+		float tmpCWw = cosf(tmpAP);
+		float tmpSW = sinf(tmpAP);
+		float tmpRAAN =  keps->RA + keps->QD * tmpT * tmpKDP;
+		float tmpCO = cosf(tmpRAAN);
+		float tmpSO = sinf(tmpRAAN);
+
+		// Plane -> celestial coordinate transformation, [C] = [RAAN]*[IN]*[AP]
+		cache->CXx = tmpCWw * tmpCO - tmpSW * keps->CI * tmpSO;
+		cache->CXy = -tmpSW * tmpCO - tmpCWw * keps->CI * tmpSO;
 
-	// Plane -> celestial coordinate transformation, [C] = [RAAN]*[IN]*[AP]
-	float tmpCXx = tmpCWw * tmpCO - tmpSW * satelliteData->keps.CI * tmpSO;
-	float tmpCXy = -tmpSW * tmpCO - tmpCWw * satelliteData->keps.CI * tmpSO;
+		cache->CYx = tmpCWw * tmpSO + tmpSW * keps->CI * tmpCO;
+		cache->CYy = -tmpSW * tmpSO + tmpCWw * keps->CI * tmpCO;
 
-	float tmpCYx = tmpCWw * tmpSO + tmpSW * satelliteData->keps.CI * tmpCO;
-	float tmpCYy = -tmpSW * tmpSO + tmpCWw * satelliteData->keps.CI * tmpCO;
+		cache->CZx = tmpSW * keps->SI;
+		cache->CZy = tmpCWw * keps->SI;
 
-	float tmpCZx = tmpSW * satelliteData->keps.SI;
-	float tmpCZy = tmpCWw * satelliteData->keps.SI;
+		cache->planeT = tmpT;
+	}
 
 	// Compute satellite's position vector, ANTenna axis unit vector
 	// and velocity  in celestial coordinates. (Note: Sz = 0, Vz = 0)
-	float tmpSATx = tmpSx * tmpCXx + tmpSy * tmpCXy;
-	float tmpVELx = tmpVx * tmpCXx + tmpVy * tmpCXy;
-	float tmpSATy = tmpSx * tmpCYx + tmpSy * tmpCYy;
-	float tmpVELy = tmpVx * tmpCYx + tmpVy * tmpCYy;
-	float tmpSATz = tmpSx * tmpCZx + tmpSy * tmpCZy;
-	float tmpVELz = tmpVx * tmpCZx + tmpVy * tmpCZy;
+	float tmpSATx = tmpSx * cache->CXx + tmpSy * cache->CXy;
+	float tmpVELx = tmpVx * cache->CXx + tmpVy * cache->CXy;
+	float tmpSATy = tmpSx * cache->CYx + tmpSy * cache->CYy;
+	float tmpVELy = tmpVx * cache->CYx + tmpVy * cache->CYy;
+	float tmpSATz = tmpSx * cache->CZx + tmpSy * cache->CZy;
+	float tmpVELz = tmpVx * cache->CZx + tmpVy * cache->CZy;
 
 	// Also express SAT, ANT, and VEL in geocentric coordinates
-	float tmpGHAA = satelliteData->keps.GHAE + currentSatelliteData_WE * tmpT;		// GHA Aries at elaprsed time T
-	tmpC = cos(-tmpGHAA);
-	tmpS = sin(-tmpGHAA);
+	if ((earthRotationIsValid == false) || (dateTimeSecs != earthRotationDateTimeSecs))
+	{
+		// GHA Aries at DN, TN. The earth does a whole turn plus WW per whole day, only the WW part matters
+		float tmpGHAA = (float)(currentSatelliteData_G0 * M_PI / 180.0) + (float)currentSatelliteData_WW * (float)(tmpDN - currentSatelliteData_DAY_NUMBER_YG) +
+				(float)currentSatelliteData_WE * tmpTN;
+
+		earthRotationCos = cosf(-tmpGHAA);
+		earthRotationSin = sinf(-tmpGHAA);
+		earthRotationDateTimeSecs = dateTimeSecs;
+		earthRotationIsValid = true;
+	}
+	tmpC = earthRotationCos;
+	tmpS = earthRotationSin;
 	tmpSx = tmpSATx * tmpC - tmpSATy * tmpS;
 	tmpVx = tmpVELx * tmpC - tmpVELy * tmpS;
 	tmpSy = tmpSATx * tmpS + tmpSATy * tmpC;
@@ -371,7 +402,7 @@ void satelliteCalculateForDateTimeSecs(const satelliteData_t *satelliteData, tim
 	float tmpRy = tmpSy - observerData.Oy;
 	float tmpRz = tmpSATz - observerData.Oz;
 
-	float tmpR = sqrt(tmpRx * tmpRx + tmpRy * tmpRy + tmpRz * tmpRz);    /* Range Magnitute */
+	float tmpR = sqrtf(tmpRx * tmpRx + tmpRy * tmpRy + tmpRz * tmpRz);    /* Range Magnitute */
 
 	// Normalize range vector
 	tmpRx = tmpRx / tmpR;
@@ -379,7 +410,7 @@ void satelliteCalculateForDateTimeSecs(const satelliteData_t *satelliteData, tim
 	tmpRz = tmpRz / tmpR;
 
 	float tmpU = tmpRx * observerData.Ux + tmpRy * observerData.Uy + tmpRz * observerData.Uz;
-	currentSatelliteData->elevation = rad2deg(asin(tmpU));
+	currentSatelliteData->elevation = asinf(tmpU) * SATELLITE_RAD_TO_DEG;
 
 	if (predictionLevel == SATELLITE_PREDICTION_LEVEL_TIME_AND_ELEVATION_ONLY)
 	{
@@ -389,9 +420,9 @@ void satelliteCalculateForDateTimeSecs(const satelliteData_t *satelliteData, tim
 	float tmpE = tmpRx * observerData.Ex + tmpRy * observerData.Ey;
 	float tmpN = tmpRx * observerData.Nx + tmpRy * observerData.Ny + tmpRz * observerData.Nz;
 
-	currentSatelliteData->azimuth = rad2deg(satelliteAtnFn(tmpE, tmpN));
+	currentSatelliteData->azimuth = satelliteAtnFn(tmpE, tmpN) * SATELLITE_RAD_TO_DEG;
 	currentSatelliteData->azimuthAsInteger = (int)(currentSatelliteData->azimuth + FLOAT_ROUNDING_CONSTANT);// round
-	currentSatelliteData->elevationAsInteger =  (currentSatelliteData->elevation < 0.0)?((int)(currentSatelliteData->elevation - FLOAT_ROUNDING_CONSTANT)):((int)(currentSatelliteData->elevation + FLOAT_ROUNDING_CONSTANT));
+	currentSatelliteData->elevationAsInteger =  (currentSatelliteData->elevation < 0.0f)?((int)(currentSatelliteData->elevation - FLOAT_ROUNDING_CONSTANT)):((int)(currentSatelliteData->elevation + FLOAT_ROUNDING_CONSTANT));
 	// Solve antenna vector along unit range vector, -r.a = cos(SQ)
 	// SQ = deg(acos(-(Ax * Rx + Ay * Ry + Az * Rz)));
 
@@ -403,18 +434,18 @@ void satelliteCalculateForDateTimeSecs(const satelliteData_t *satelliteData, tim
 
 #if NEEDS_SATELLITE_LAT_LONG
 	// Calculate sub-satellite Lat/Lon
-    currentSatelliteData->longitude = rad2deg(satelliteAtnFn(tmpSy, tmpSx));		// Lon, + East
-	currentSatelliteData->latitude = rad2deg(asin(tmpSATz / tmpRS));		// Lat, + North
+    currentSatelliteData->longitude = satelliteAtnFn(tmpSy, tmpSx) * SATELLITE_RAD_TO_DEG;		// Lon, + East
+	currentSatelliteData->latitude = asinf(tmpSATz / tmpRS) * SATELLITE_RAD_TO_DEG;		// Lat, + North
 
-	if (currentSatelliteData->longitude > 180.0 )
+	if (currentSatelliteData->longitude > 180.0f )
     {
-   		currentSatelliteData->longitude -= 360.0;			// -ve is degrees West
+   		currentSatelliteData->longitude -= 360.0f;			// -ve is degrees West
     }
 #endif
 
 	// Resolve Sat-Obs velocity vector along unit range vector. (VOz = 0)
 	float rangeRate = (tmpVx - observerData.VOx) * tmpRx + (tmpVy - observerData.VOy) * tmpRy + tmpVELz * tmpRz; // Range rate, km/sec
-	float dopplerFactor = rangeRate / 299792.0;
+	float dopplerFactor = rangeRate / 299792.0f;
 
 
 	currentSatelliteData->freqs[SATELLITE_VOICE_FREQ].rxFreq = satelliteData->freqs[SATELLITE_VOICE_FREQ].rxFreq - satelliteGetDoppler(dopplerFactor, satelliteData->freqs[SATELLITE_VOICE_FREQ].rxFreq);
@@ -430,19 +461,146 @@ void satelliteCalculateForDateTimeSecs(const satelliteData_t *satelliteData, tim
 
 }
 
-bool satellitePredictNextPassFromDateTimeSecs(predictionStateMachineData_t *stateData, const satelliteData_t *satelliteData, time_t_custom startDateTimeSecs, time_t_custom limitDateTimeSecs, int maxIterations, satellitePass_t *nextPass)
+// Elevation at the given time, accounted in the prediction iterations
+static float satelliteGetElevation(predictionStateMachineData_t *stateData, satelliteData_t *satelliteData, time_t_custom dateTimeSecs)
 {
 	satelliteResults_t currentSatelliteData;
 
+	satelliteCalculateForDateTimeSecs(satelliteData, dateTimeSecs, &currentSatelliteData, SATELLITE_PREDICTION_LEVEL_TIME_AND_ELEVATION_ONLY);
+	stateData->iterations++;
+	stateData->totalIterations++;
+
+	return currentSatelliteData.elevation;
+}
+
+// Time step from the given elevation (deg): the longest one which can't reach the horizon, plus the minimum step
+static int satelliteGetHorizonTimeStep(const satelliteData_t *satelliteData, float elevation)
+{
+	float step = (fabsf(elevation) / (satelliteData->keps.ER * SATELLITE_RAD_TO_DEG)) + SATELLITE_PREDICTION_MIN_TIME_STEP;
+
+	return ((step > SATELLITE_PREDICTION_MAX_TIME_STEP) ? SATELLITE_PREDICTION_MAX_TIME_STEP : (int)step);
+}
+
+//
+// Locates the next AOS (elevation going >= 0) or LOS (elevation going < 0) from stateData->currentDateTimeSecs.
+// Coarse samples are first taken to bracket the horizon crossing, forward (or backward if the first sample
+// is already past the crossing), then the bracket is narrowed down to a second using the regula falsi (Illinois variant).
+// On success, stateData->found is set and stateData->currentDateTimeSecs holds the first second past the crossing.
+//
+static void satelliteFindHorizonCrossing(predictionStateMachineData_t *stateData, satelliteData_t *satelliteData, bool isAOS, time_t_custom limitDateTimeSecs, int maxIterations)
+{
+	do
+	{
+		if (stateData->foundStart == false)
+		{
+			float elevation = satelliteGetElevation(stateData, satelliteData, stateData->currentDateTimeSecs);
+
+			if (isAOS ? (elevation < 0.0f) : (elevation >= 0.0f))
+			{
+				stateData->beforeDateTimeSecs = stateData->currentDateTimeSecs;
+				stateData->beforeElevation = elevation;
+
+				if (stateData->direction < 0)
+				{
+					stateData->foundStart = true;
+				}
+				else
+				{
+					int step = satelliteGetHorizonTimeStep(satelliteData, elevation);
+
+					if (isAOS == false)
+					{
+						// Going past the LOS doesn't matter, as long as the whole time below the horizon isn't skipped
+						int periodStep = (int)((SATELLITE_TWO_PI / satelliteData->keps.N0) / SATELLITE_PREDICTION_LOS_PERIOD_DIVIDER);
+
+						step = ((periodStep > step) ? periodStep : step);
+					}
+
+					stateData->direction = 1;
+					stateData->currentDateTimeSecs += step;
+				}
+			}
+			else
+			{
+				stateData->afterDateTimeSecs = stateData->currentDateTimeSecs;
+				stateData->afterElevation = elevation;
+
+				if (stateData->direction > 0)
+				{
+					stateData->foundStart = true;
+				}
+				else
+				{
+					// Already past the crossing, go back in time
+					stateData->direction = -1;
+					stateData->currentDateTimeSecs -= satelliteGetHorizonTimeStep(satelliteData, elevation);
+				}
+			}
+
+			if (stateData->foundStart)
+			{
+				stateData->direction = 0;
+			}
+		}
+		else
+		{
+			time_t_custom width = (stateData->afterDateTimeSecs - stateData->beforeDateTimeSecs);
+
+			if (width <= 1)
+			{
+				stateData->currentDateTimeSecs = stateData->afterDateTimeSecs;
+				stateData->found = true;
+				break;
+			}
+
+			// Interpolate the crossing time, keeping it strictly inside the bracket
+			float ratio = stateData->beforeElevation / (stateData->beforeElevation - stateData->afterElevation);
+			time_t_custom offset = (time_t_custom)((float)width * ratio + 0.5f);
+
+			offset = ((offset < 1) ? 1 : ((offset > (width - 1)) ? (width - 1) : offset));
+			stateData->currentDateTimeSecs = stateData->beforeDateTimeSecs + offset;
+
+			float elevation = satelliteGetElevation(stateData, satelliteData, stateData->currentDateTimeSecs);
+
+			// When the same side of the bracket moves twice in a row, the weight of the other one is halved
+			if (isAOS ? (elevation < 0.0f) : (elevation >= 0.0f))
+			{
+				stateData->beforeDateTimeSecs = stateData->currentDateTimeSecs;
+				stateData->beforeElevation = elevation;
+
+				if (stateData->direction < 0)
+				{
+					stateData->afterElevation *= 0.5f;
+				}
+				stateData->direction = -1;
+			}
+			else
+			{
+				stateData->afterDateTimeSecs = stateData->currentDateTimeSecs;
+				stateData->afterElevation = elevation;
+
+				if (stateData->direction > 0)
+				{
+					stateData->beforeElevation *= 0.5f;
+				}
+				stateData->direction = 1;
+			}
+		}
+	} while ((stateData->iterations < maxIterations) &&
+			(stateData->totalIterations < MAX_TOTAL_ITERATIONS) &&
+			(stateData->currentDateTimeSecs < limitDateTimeSecs));
+}
+
+bool satellitePredictNextPassFromDateTimeSecs(predictionStateMachineData_t *stateData, satelliteData_t *satelliteData, time_t_custom startDateTimeSecs, time_t_custom limitDateTimeSecs, int maxIterations, satellitePass_t *nextPass)
+{
     switch(stateData->state)
     {
     	case PREDICTION_STATE_INIT_AOS:
     		stateData->currentDateTimeSecs = startDateTimeSecs;
-        	stateData->timeStep = SATELLITE_PREDICTION_INITIAL_TIME_STEP;
         	stateData->found = false;
     		stateData->totalIterations = 0;
     		stateData->foundStart = false;
-    		stateData->direction = 1;
+    		stateData->direction = 0;
     		stateData->state = PREDICTION_STATE_FIND_AOS;
     		nextPass->valid = PREDICTION_RESULT_NONE;
 			nextPass->satelliteMaxElevation = -1;// not yet calculated
@@ -452,64 +610,7 @@ bool satellitePredictNextPassFromDateTimeSecs(predictionStateMachineData_t *stat
     	case PREDICTION_STATE_FIND_AOS:
 			stateData->iterations = 0;
 
-    		do
-    		{
-    			stateData->currentDateTimeSecs += (stateData->timeStep * stateData->direction); // move  forward
-    			satelliteCalculateForDateTimeSecs(satelliteData, stateData->currentDateTimeSecs, &currentSatelliteData, SATELLITE_PREDICTION_LEVEL_TIME_AND_ELEVATION_ONLY);
-
-    			if (!stateData->foundStart && currentSatelliteData.elevation >= 0)
-    			{
-    				stateData->foundStart = true;
-    			}
-    			if (stateData->foundStart)
-    			{
-    				if (stateData->timeStep == 1)
-    				{
-    					if (currentSatelliteData.elevation >= 0)
-    					{
-    						stateData->found = true;
-    					}
-    					else
-    					{
-    						stateData->direction = 1;
-    					}
-    				}
-    				else
-    				{
-    					stateData->timeStep /= 2;
-    					if (currentSatelliteData.elevation >= 0)
-    					{
-    						stateData->direction = -1;
-    					}
-    					else
-    					{
-    						stateData->direction = 1;
-    					}
-    				}
-    			}
-    			else
-    			{
-    				if (currentSatelliteData.elevation < -30)
-					{
-    					if (stateData->timeStep == SATELLITE_PREDICTION_INITIAL_TIME_STEP)
-						{
-    						stateData->timeStep = SATELLITE_PREDICTION_INITIAL_TIME_STEP * 4;
-						}
-					}
-    				else
-    				{
-    					if (stateData->timeStep == (SATELLITE_PREDICTION_INITIAL_TIME_STEP * 4))
-						{
-							stateData->timeStep = SATELLITE_PREDICTION_INITIAL_TIME_STEP;
-						}
-    				}
-    			}
-    			stateData->iterations++;
-    			stateData->totalIterations++;
-    		} while (	!stateData->found &&
-    					(stateData->iterations < maxIterations) &&
-						(stateData->totalIterations < MAX_TOTAL_ITERATIONS) &&
-						stateData->currentDateTimeSecs < limitDateTimeSecs);
+			satelliteFindHorizonCrossing(stateData, satelliteData, true, limitDateTimeSecs, maxIterations);
 
     		if (stateData->currentDateTimeSecs >= limitDateTimeSecs)
     		{
@@ -517,73 +618,30 @@ bool satellitePredictNextPassFromDateTimeSecs(predictionStateMachineData_t *stat
     			return false;
     		}
 
-    		if (!(stateData->iterations < maxIterations) || !(stateData->totalIterations < MAX_TOTAL_ITERATIONS))
+    		if (!stateData->found)
     		{
     			stateData->state = PREDICTION_STATE_ITERATION_LIMIT;
     			return false;
     		}
 
-    		if (stateData->found)
-    		{
-				nextPass->satelliteAOS = stateData->currentDateTimeSecs;
+			nextPass->satelliteAOS = stateData->currentDateTimeSecs;
 
-				stateData->state = PREDICTION_STATE_INIT_LOS;
-    		}
+			stateData->state = PREDICTION_STATE_INIT_LOS;
     		break;
 
     	case PREDICTION_STATE_INIT_LOS:
     		stateData->found = false;
 			stateData->foundStart = false;
-			stateData->timeStep = SATELLITE_PREDICTION_INITIAL_TIME_STEP;
-			stateData->direction = 1;
+			// The AOS is the first sample before the LOS
+			stateData->direction = 0;
+			stateData->currentDateTimeSecs = nextPass->satelliteAOS;
 
 			// deliberate drop through
 
     	case PREDICTION_STATE_FIND_LOS:
 			stateData->iterations = 0;
 
-    		do
-    		{
-    			stateData->currentDateTimeSecs += (stateData->timeStep * stateData->direction); // move  forward
-    			satelliteCalculateForDateTimeSecs(satelliteData, stateData->currentDateTimeSecs, &currentSatelliteData, SATELLITE_PREDICTION_LEVEL_TIME_AND_ELEVATION_ONLY);
-
-    			if (!stateData->foundStart && currentSatelliteData.elevation < 0)
-    			{
-    				stateData->foundStart = true;
-    			}
-    			if (stateData->foundStart)
-    			{
-    				if (stateData->timeStep == 1)
-    				{
-    					if (currentSatelliteData.elevation < 0)
-    					{
-    						stateData->found = true;
-    					}
-    					else
-    					{
-    						stateData->direction = 1;
-    					}
-    				}
-    				else
-    				{
-    					stateData->timeStep /= 2;
-    					if (currentSatelliteData.elevation < 0)
-    					{
-    						stateData->direction = -1;
-    					}
-    					else
-    					{
-    						stateData->direction = 1;
-    					}
-    				}
-
-    			}
-    			stateData->iterations++;
-
-    		} while (	!stateData->found &&
-    					(stateData->iterations < maxIterations) &&
-						(stateData->totalIterations < MAX_TOTAL_ITERATIONS) &&
-						 stateData->currentDateTimeSecs < limitDateTimeSecs);
+			satelliteFindHorizonCrossing(stateData, satelliteData, false, limitDateTimeSecs, maxIterations);
 
     		if (stateData->currentDateTimeSecs >= limitDateTimeSecs)
     		{
@@ -591,22 +649,19 @@ bool satellitePredictNextPassFromDateTimeSecs(predictionStateMachineData_t *stat
     			return false;
     		}
 
-    		if (!(stateData->iterations < maxIterations) || !(stateData->totalIterations < MAX_TOTAL_ITERATIONS))
+    		if (!stateData->found)
     		{
     			stateData->state = PREDICTION_STATE_ITERATION_LIMIT;
     			return false;
     		}
 
-    		if (stateData->found)
-    		{
-    			nextPass->satelliteLOS = stateData->currentDateTimeSecs;
+			nextPass->satelliteLOS = stateData->currentDateTimeSecs;
 
-				nextPass->satellitePassDuration = nextPass->satelliteLOS - nextPass->satelliteAOS;
+			nextPass->satellitePassDuration = nextPass->satelliteLOS - nextPass->satelliteAOS;
 
-				//satelliteGetMaximumElevation(satelliteData , nextPass);// Use lazy calculation now
+			//satelliteGetMaximumElevation(satelliteData , nextPass);// Use lazy calculation now
 
-				stateData->state = PREDICTION_STATE_COMPLETE;
-    		}
+			stateData->state = PREDICTION_STATE_COMPLETE;
     		break;
 
     	case PREDICTION_STATE_NONE:
@@ -624,14 +679,11 @@ bool satellitePredictNextPassFromDateTimeSecs(predictionStateMachineData_t *stat
 
 uint16_t satelliteGetMaximumElevation(satelliteData_t *satelliteData, uint32_t passNumber)
 {
-	float lastEl, halfPointElevation;
 	satelliteResults_t resultsData;
 	satellitePass_t *pass;
-	time_t_custom dataTime;
 
-// Step size of 1 does not seem to be needed even for passes which are directly overhead within less than 1.0 deg
-#define MAX_ELE_FIND_STEP  2
-#define MAX_ELE_MIN_STEP_CHANGE_DEG 0.01
+// Precision on the time of the maximum elevation, the elevation is flat around it
+#define MAX_ELE_FIND_STEP  2.0f
 
 	pass = &satelliteData->predictions.passes[passNumber];
 
@@ -640,44 +692,96 @@ uint16_t satelliteGetMaximumElevation(satelliteData_t *satelliteData, uint32_t p
 		return pass->satelliteMaxElevation;
 	}
 
-	dataTime = (pass->satelliteAOS + pass->satelliteLOS)/2;// max height will be in middle of the pass... Probably
-	satelliteCalculateForDateTimeSecs(satelliteData, dataTime, &resultsData, SATELLITE_PREDICTION_LEVEL_TIME_AND_ELEVATION_ONLY);
+	// The maximum is bracketed by the AOS and LOS (where the elevation is ~0). Long passes (e.g. HEO) can peak
+	// far from their middle, so they are coarsely sampled first, the highest sample and its neighbours giving a
+	// tighter bracket. Then the vertex of the parabola going through the bracket and the highest point found so far
+	// converges on the maximum, until the bracket is narrowed down to MAX_ELE_FIND_STEP each side.
+	float duration = (float)pass->satellitePassDuration;
+	int numSamples = pass->satellitePassDuration / SATELLITE_MAX_ELEVATION_SAMPLE_STEP;
+	float a = 0.0f, fa = 0.0f;
+	float c = duration, fc = 0.0f;
+	float b = 0.0f, fb = 0.0f;
+
+	if (numSamples < 1)
+	{
+		numSamples = 1;
+	}
+	else if (numSamples > SATELLITE_MAX_ELEVATION_MAX_SAMPLES)
+	{
+		numSamples = SATELLITE_MAX_ELEVATION_MAX_SAMPLES;
+	}
 
-	pass->satelliteMaxElevation = (int16_t)(resultsData.elevation + FLOAT_ROUNDING_CONSTANT);
+	for (int i = 1; i <= numSamples; i++)
+	{
+		float x = duration * (float)i / (float)(numSamples + 1);
 
-	halfPointElevation = resultsData.elevation;
+		satelliteCalculateForDateTimeSecs(satelliteData, pass->satelliteAOS + (time_t_custom)x, &resultsData, SATELLITE_PREDICTION_LEVEL_TIME_AND_ELEVATION_ONLY);
 
-	dataTime -= MAX_ELE_FIND_STEP;// try prior to mid point time
+		if ((i > 1) && (resultsData.elevation <= fb))
+		{
+			// Past the maximum
+			c = x;
+			fc = resultsData.elevation;
+			break;
+		}
 
-	satelliteCalculateForDateTimeSecs(satelliteData, dataTime, &resultsData, SATELLITE_PREDICTION_LEVEL_TIME_AND_ELEVATION_ONLY);
+		a = b;
+		fa = fb;
+		b = x;
+		fb = resultsData.elevation;
+	}
 
-	if ((resultsData.elevation - halfPointElevation) > MAX_ELE_MIN_STEP_CHANGE_DEG)
+	for (int i = 0; ((i < SATELLITE_MAX_ELEVATION_MAX_ITERATIONS) && ((c - a) > (2.0f * MAX_ELE_FIND_STEP))); i++)
 	{
-		do
+		float p = (b - a) * (b - a) * (fb - fc) - (b - c) * (b - c) * (fb - fa);
+		float q = (b - a) * (fb - fc) - (b - c) * (fb - fa);
+		float x = ((q != 0.0f) ? (b - 0.5f * p / q) : b);
+
+		if ((x <= a) || (x >= c))
 		{
-			lastEl = resultsData.elevation;
-			pass->satelliteMaxElevation = (int16_t)(resultsData.elevation + FLOAT_ROUNDING_CONSTANT);
-			dataTime -= MAX_ELE_FIND_STEP;
-			satelliteCalculateForDateTimeSecs(satelliteData, dataTime, &resultsData, SATELLITE_PREDICTION_LEVEL_TIME_AND_ELEVATION_ONLY);
+			// Not a usable vertex, halve the widest side instead
+			x = (((b - a) > (c - b)) ? ((a + b) * 0.5f) : ((b + c) * 0.5f));
+		}
 
-		} while ((resultsData.elevation - lastEl) > MAX_ELE_MIN_STEP_CHANGE_DEG);
-	}
-	else
-	{
-		dataTime += MAX_ELE_FIND_STEP * 2;// step in twice the direction because the previous test set the dateTime to one second before the mid time point.
-		satelliteCalculateForDateTimeSecs(satelliteData, dataTime, &resultsData, SATELLITE_PREDICTION_LEVEL_TIME_AND_ELEVATION_ONLY);
-		if ((resultsData.elevation - halfPointElevation) > MAX_ELE_MIN_STEP_CHANGE_DEG)
+		if (fabsf(x - b) < MAX_ELE_FIND_STEP)
 		{
-			do
-			{
-				lastEl = resultsData.elevation;
-				pass->satelliteMaxElevation = (int16_t)(resultsData.elevation + FLOAT_ROUNDING_CONSTANT);
-				dataTime += MAX_ELE_FIND_STEP;
-				satelliteCalculateForDateTimeSecs(satelliteData, dataTime, &resultsData, SATELLITE_PREDICTION_LEVEL_TIME_AND_ELEVATION_ONLY);
+			// Too close to the current maximum, probe next to it on the widest side instead, narrowing down the bracket.
+			x = b + (((c - b) > (b - a)) ? MAX_ELE_FIND_STEP : -MAX_ELE_FIND_STEP);
+		}
+
+		satelliteCalculateForDateTimeSecs(satelliteData, pass->satelliteAOS + (time_t_custom)x, &resultsData, SATELLITE_PREDICTION_LEVEL_TIME_AND_ELEVATION_ONLY);
 
-			} while ((resultsData.elevation - lastEl) > MAX_ELE_MIN_STEP_CHANGE_DEG);
+		if (resultsData.elevation > fb)
+		{
+			if (x < b)
+			{
+				c = b;
+				fc = fb;
+			}
+			else
+			{
+				a = b;
+				fa = fb;
+			}
+			b = x;
+			fb = resultsData.elevation;
+		}
+		else
+		{
+			if (x < b)
+			{
+				a = x;
+				fa = resultsData.elevation;
+			}
+			else
+			{
+				c = x;
+				fc = resultsData.elevation;
+			}
 		}
 	}
 
+	pass->satelliteMaxElevation = (int16_t)(fb + FLOAT_ROUNDING_CONSTANT);
+
 	return pass->satelliteMaxElevation;
 }
@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2024 Roger Clark, VK3KYY / G4KYF
+ *                    Daniel Caujolle-Bert, F1RMB
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+ *    in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. Use of this source code or binary releases for commercial purposes is strictly forbidden. This includes, without limitation,
+ *    incorporation in a commercial product or incorporation into a product or project which allows commercial use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "functions/scanTable.h"
+#include "functions/trx.h"
+
+
+void scanTableSetEntry(scanTableEntry_t *entry, uint16_t index, struct_codeplugChannel_t *channel, bool skip)
+{
+	entry->rxFreq = channel->rxFreq;
+	// The APRS channels are received without CSS (see uiChannelModeLoadChannelData())
+	entry->rxTone = (((channel->chMode == RADIO_MODE_ANALOG) && (channel->aprsConfigIndex != 0)) ? CODEPLUG_CSS_TONE_NONE : channel->rxTone);
+	entry->index = index;
+	entry->chMode = channel->chMode;
+	entry->colourCode = channel->txColor;
+	entry->sql = channel->sql;
+	entry->flags = (skip ? SCAN_TABLE_FLAG_SKIP : 0);
+
+	if (codeplugChannelGetFlag(channel, CHANNEL_FLAG_BW_25K) != 0)
+	{
+		entry->flags |= SCAN_TABLE_FLAG_BW_25K;
+	}
+
+	if (codeplugChannelGetFlag(channel, CHANNEL_FLAG_TIMESLOT_TWO) != 0)
+	{
+		entry->flags |= SCAN_TABLE_FLAG_TIMESLOT_TWO;
+	}
+
+	if ((channel->rxFreq == channel->txFreq) || (codeplugChannelGetFlag(channel, CHANNEL_FLAG_FORCE_DMO) != 0))
+	{
+		entry->flags |= SCAN_TABLE_FLAG_DMO;
+	}
+}
+
+int scanTableFindIndex(const scanTableEntry_t *table, int count, uint16_t index)
+{
+	for (int i = 0; i < count; i++)
+	{
+		if (table[i].index == index)
+		{
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+// Next position, from position (which may be one step outside of the table), that isn't skipped or nuisance deleted.
+// Without wrap, -1 is returned once the end of the table is reached in that direction, and with it when nothing is left to scan.
+int scanTableFindNext(const scanTableEntry_t *table, int count, int position, int direction, bool wrap)
+{
+	for (int hops = 0; hops < count; hops++)
+	{
+		position += direction;
+
+		if ((position < 0) || (position >= count))
+		{
+			if (wrap == false)
+			{
+				return -1;
+			}
+
+			position = ((position < 0) ? (count - 1) : 0);
+		}
+
+		if ((table[position].flags & (SCAN_TABLE_FLAG_SKIP | SCAN_TABLE_FLAG_NUISANCE)) == 0)
+		{
+			return position;
+		}
+	}
+
+	return -1;
+}
+
+void scanTableSetNuisance(scanTableEntry_t *table, int count, uint16_t index)
+{
+	int position = scanTableFindIndex(table, count, index);
+
+	if (position != -1)
+	{
+		table[position].flags |= SCAN_TABLE_FLAG_NUISANCE;
+	}
+}
@@ -34,6 +34,8 @@
 
 
 #define MIC_AVERAGE_COUNTER_RELOAD     10
+#define BEEP_TASK_TICK_PERIOD_MS        1 // Playing, a block of 16 samples every tick
+#define BEEP_TASK_IDLE_PERIOD_MS      100 // Nothing to play but keeping the alive count
 
 static void soundBeepTaskFunction(void *data);
 
@@ -449,6 +451,8 @@ bool soundMelodyIsPlaying(void)
 
 void soundTickMelody(void)
 {
+	bool newNote = false;
+
 	taskENTER_CRITICAL();
 	if (melody_play != NULL)
 	{
@@ -471,10 +475,17 @@ void soundTickMelody(void)
 				sine_beep_freq = melody_play[melody_idx];
 				sine_beep_duration = melody_play[melody_idx + 1];
 				melody_idx = melody_idx + 2;
+				newNote = true;
 			}
 		}
 	}
 	taskEXIT_CRITICAL();
+
+	// Wake the beep task up from its idle wait, it plays the first note without delay
+	if (newNote && (beepTask.Handle != NULL))
+	{
+		xTaskNotifyGive(beepTask.Handle);
+	}
 }
 
 static void soundBeepTaskFunction(void *data)
@@ -485,93 +496,97 @@ static void soundBeepTaskFunction(void *data)
 	bool beep = false;
 	uint8_t task_spi_sound[32];
 	int waitTimeout;
+	uint32_t notified;
 
 	while (1U)
 	{
-		if (timer_beeptask == 0)
-		{
-			beepTask.AliveCount = TASK_FLAGGED_ALIVE;
+		beepTask.AliveCount = TASK_FLAGGED_ALIVE;
 
-			if (sine_beep_duration > 0)
+		if (sine_beep_duration > 0)
+		{
+			if (rxPowerSavingIsRxOn() == false)
 			{
-				if (rxPowerSavingIsRxOn() == false)
-				{
-					rxPowerSavingSetState(ECOPHASE_POWERSAVE_INACTIVE);
-				}
-
-				if (!beep)
-				{
-					waitTimeout = WAIT_TIMEOUT_COUNT;
-#warning ERRR NO
-					NVIC_DisableIRQ(PORTC_IRQn);
-					// Set C6000 audio path to "OpenMusic" for beep
-					while ((SPI0ClearPageRegByteWithMask(0x04, 0x06, 0xFD, 0x02) == -1) &&  ((waitTimeout--) > 0))
-					{
-						vTaskDelay((0 / portTICK_PERIOD_MS));
-					}
-					NVIC_EnableIRQ(PORTC_IRQn);
-					beep = true;
-				}
+				rxPowerSavingSetState(ECOPHASE_POWERSAVE_INACTIVE);
+			}
 
+			if (!beep)
+			{
 				waitTimeout = WAIT_TIMEOUT_COUNT;
 #warning ERRR NO
 				NVIC_DisableIRQ(PORTC_IRQn);
-				while ((SPI0ReadPageRegByte(0x04, 0x88, &tmp_val) == -1) &&  ((waitTimeout--) > 0))
+				// Set C6000 audio path to "OpenMusic" for beep
+				while ((SPI0ClearPageRegByteWithMask(0x04, 0x06, 0xFD, 0x02) == -1) &&  ((waitTimeout--) > 0))
 				{
 					vTaskDelay((0 / portTICK_PERIOD_MS));
 				}
 				NVIC_EnableIRQ(PORTC_IRQn);
+				beep = true;
+			}
+
+			waitTimeout = WAIT_TIMEOUT_COUNT;
+#warning ERRR NO
+			NVIC_DisableIRQ(PORTC_IRQn);
+			while ((SPI0ReadPageRegByte(0x04, 0x88, &tmp_val) == -1) &&  ((waitTimeout--) > 0))
+			{
+				vTaskDelay((0 / portTICK_PERIOD_MS));
+			}
+			NVIC_EnableIRQ(PORTC_IRQn);
 
-				if ( !(tmp_val & 1))
+			if ( !(tmp_val & 1))
+			{
+				for (int i = 0; i < 16; i++)
 				{
-					for (int i = 0; i < 16; i++)
+					swapper.byte16 = ((int)sine_beep16[beep_idx]) >> soundBeepVolumeDivider;
+					task_spi_sound[(2 * i) + 1] = swapper.bytes8[0];// low byte
+					task_spi_sound[2 * i] = swapper.bytes8[1];// high byte
+
+					if (sine_beep_freq != 0)
 					{
-						swapper.byte16 = ((int)sine_beep16[beep_idx]) >> soundBeepVolumeDivider;
-						task_spi_sound[(2 * i) + 1] = swapper.bytes8[0];// low byte
-						task_spi_sound[2 * i] = swapper.bytes8[1];// high byte
+						beep_idx = beep_idx + (int)(sine_beep_freq / 3.915f);
 
-						if (sine_beep_freq != 0)
+						// Stay in sine_beep16[] boundaries.
+						while (beep_idx >= 0x0800)
 						{
-							beep_idx = beep_idx + (int)(sine_beep_freq / 3.915f);
-
-							// Stay in sine_beep16[] boundaries.
-							while (beep_idx >= 0x0800)
-							{
-								beep_idx = beep_idx - 0x0800;
-							}
+							beep_idx = beep_idx - 0x0800;
 						}
 					}
+				}
 #warning ERRR NO
-					NVIC_DisableIRQ(PORTC_IRQn);
-					waitTimeout = WAIT_TIMEOUT_COUNT;
-					while ((SPI0WritePageRegByteArray(0x03, 0x00, task_spi_sound, 0x20) == -1) &&  ((waitTimeout--) > 0))
-					{
-						vTaskDelay((0 / portTICK_PERIOD_MS));
-					}
-					NVIC_EnableIRQ(PORTC_IRQn);
+				NVIC_DisableIRQ(PORTC_IRQn);
+				waitTimeout = WAIT_TIMEOUT_COUNT;
+				while ((SPI0WritePageRegByteArray(0x03, 0x00, task_spi_sound, 0x20) == -1) &&  ((waitTimeout--) > 0))
+				{
+					vTaskDelay((0 / portTICK_PERIOD_MS));
 				}
-
-				sine_beep_duration--;
+				NVIC_EnableIRQ(PORTC_IRQn);
 			}
-			else
+
+			sine_beep_duration--;
+		}
+		else
+		{
+			if (beep)
 			{
-				if (beep)
-				{
-					waitTimeout = WAIT_TIMEOUT_COUNT;
+				waitTimeout = WAIT_TIMEOUT_COUNT;
 #warning ERRR NO
-					NVIC_DisableIRQ(PORTC_IRQn);
-					while ((SPI0ClearPageRegByteWithMask(0x04, 0x06, 0xFD, 0x00) == -1) &&  ((waitTimeout--) >> 0))
-					{
-						vTaskDelay((0 / portTICK_PERIOD_MS));
-					}
-					NVIC_EnableIRQ(PORTC_IRQn);
-					beep = false;
+				NVIC_DisableIRQ(PORTC_IRQn);
+				while ((SPI0ClearPageRegByteWithMask(0x04, 0x06, 0xFD, 0x00) == -1) &&  ((waitTimeout--) >> 0))
+				{
+					vTaskDelay((0 / portTICK_PERIOD_MS));
 				}
+				NVIC_EnableIRQ(PORTC_IRQn);
+				beep = false;
 			}
-
-			timer_beeptask = 1; // Reset PIT Counter
 		}
 
-		vTaskDelay((0 / portTICK_PERIOD_MS));
+		// One block of samples per tick while a note plays (or the beep path has to be switched off),
+		// otherwise sleep until soundTickMelody() starts a note.
+		notified = ulTaskNotifyTake(pdTRUE, ((((sine_beep_duration > 0) || beep) ? BEEP_TASK_TICK_PERIOD_MS : BEEP_TASK_IDLE_PERIOD_MS) / portTICK_PERIOD_MS));
+
+		beepTask.Wakeups++;
+		if (notified != 0)
+		{
+			beepTask.NotifiedWakeups++;
+		}
 	}
 }
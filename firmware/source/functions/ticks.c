@@ -26,7 +26,6 @@
  *
  */
 
-#include <string.h>
 #include "functions/ticks.h"
 #include "user_interface/menuSystem.h"
 
@@ -36,108 +35,222 @@ extern volatile uint32_t PITCounter; // 1ms granularity
 
 typedef struct
 {
-	timerCallback_t  funPtr;
+	timerCallback_t  funPtr;// NULL when the slot is free
 	int              menuDestination;
-	ticksTimer_t     PIT_TriggerTimer;
+	uint32_t         dueTime;
+	uint32_t         sequence;// Insertion order, callbacks due at the same time are called in that order
+	uint8_t          heapPosition;
 } timerCallbackbackStruct_t;
 
-#define MAX_NUM_TIMER_CALLBACKS 8
+#define MAX_NUM_TIMER_CALLBACKS 16
 static timerCallbackbackStruct_t callbacksArray[MAX_NUM_TIMER_CALLBACKS];// As a global this will get cleared by the compiler
+// Binary min-heap of callbacksArray slots, ordered by due time
+static uint8_t callbacksHeap[MAX_NUM_TIMER_CALLBACKS];
+static uint8_t callbacksCount = 0;
+static uint32_t callbacksSequence = 0;
 
 inline uint32_t ticksGetMillis(void)
 {
 	return PITCounter;
 }
 
-void handleTimerCallbacks(void)
+static bool timerCallbackIsBefore(timerCallbackbackStruct_t *a, timerCallbackbackStruct_t *b)
+{
+	int32_t diff = (int32_t)(a->dueTime - b->dueTime);// PITCounter rollover safe
+
+	return ((diff < 0) || ((diff == 0) && ((int32_t)(a->sequence - b->sequence) < 0)));
+}
+
+static void timerCallbackHeapSet(uint8_t position, uint8_t slot)
+{
+	callbacksHeap[position] = slot;
+	callbacksArray[slot].heapPosition = position;
+}
+
+static void timerCallbackHeapSiftUp(uint8_t position)
 {
-	int i = 0;
+	uint8_t slot = callbacksHeap[position];
 
-	while((callbacksArray[i].funPtr != NULL) && (i < MAX_NUM_TIMER_CALLBACKS))
+	while (position > 0)
 	{
-		timerCallback_t cbFunction = NULL;
+		uint8_t parent = (position - 1) / 2;
 
-		if (ticksTimerHasExpired(&callbacksArray[i].PIT_TriggerTimer))
+		if (timerCallbackIsBefore(&callbacksArray[slot], &callbacksArray[callbacksHeap[parent]]) == false)
 		{
-			// Does the current menu matches the desired destination menu
-			if ((callbacksArray[i].menuDestination == MENU_ANY) || (callbacksArray[i].menuDestination == menuSystemGetCurrentMenuNumber()))
-			{
-				// Postpone the call to callback function, as it could add/delete/update a TimerCallback in its code.
-				cbFunction = callbacksArray[i].funPtr;
-			}
+			break;
+		}
 
-			if (i != (MAX_NUM_TIMER_CALLBACKS - 1))
-			{
-				memmove(&callbacksArray[i], &callbacksArray[i + 1], ((MAX_NUM_TIMER_CALLBACKS - 1) - i) * sizeof(timerCallbackbackStruct_t));
-			}
+		timerCallbackHeapSet(position, callbacksHeap[parent]);
+		position = parent;
+	}
 
-			callbacksArray[MAX_NUM_TIMER_CALLBACKS - 1].funPtr = NULL;
+	timerCallbackHeapSet(position, slot);
+}
+
+static void timerCallbackHeapSiftDown(uint8_t position)
+{
+	uint8_t slot = callbacksHeap[position];
+
+	while (true)
+	{
+		uint8_t child = (position * 2) + 1;
+
+		if (child >= callbacksCount)
+		{
+			break;
 		}
-		else
+
+		if (((child + 1) < callbacksCount) && timerCallbackIsBefore(&callbacksArray[callbacksHeap[child + 1]], &callbacksArray[callbacksHeap[child]]))
 		{
-			i++;
+			child++;
 		}
 
-		if (cbFunction != NULL)
+		if (timerCallbackIsBefore(&callbacksArray[callbacksHeap[child]], &callbacksArray[slot]) == false)
 		{
-			cbFunction();
-			i = 0; // Restart from the beginning of the array
+			break;
 		}
+
+		timerCallbackHeapSet(position, callbacksHeap[child]);
+		position = child;
 	}
+
+	timerCallbackHeapSet(position, slot);
 }
 
-bool addTimerCallback(timerCallback_t funPtr, uint32_t delayIn_mS, int menuDest, bool updateExistingCallbackTime)
+static void timerCallbackSchedule(uint8_t slot, uint32_t delayIn_mS, int menuDest, bool isQueued)
 {
-	uint32_t callBackTime = (delayIn_mS * PIT_COUNTS_PER_MS);
+	callbacksArray[slot].menuDestination = menuDest;
+	callbacksArray[slot].dueTime = ticksGetMillis() + (delayIn_mS * PIT_COUNTS_PER_MS);
+	callbacksArray[slot].sequence = callbacksSequence++;
 
-	for(int i = 0; i < MAX_NUM_TIMER_CALLBACKS; i++)
+	if (isQueued)
 	{
-		if (callbacksArray[i].funPtr == NULL)
+		// Rescheduled, the due time could be earlier or later
+		timerCallbackHeapSiftUp(callbacksArray[slot].heapPosition);
+		timerCallbackHeapSiftDown(callbacksArray[slot].heapPosition);
+	}
+	else
+	{
+		timerCallbackHeapSet(callbacksCount, slot);
+		callbacksCount++;
+		timerCallbackHeapSiftUp(callbacksCount - 1);
+	}
+}
+
+static void timerCallbackRemove(uint8_t slot)
+{
+	uint8_t position = callbacksArray[slot].heapPosition;
+
+	callbacksArray[slot].funPtr = NULL;
+	callbacksCount--;
+
+	if (position != callbacksCount)
+	{
+		uint8_t lastSlot = callbacksHeap[callbacksCount];
+
+		// Move the last heap entry in the hole
+		timerCallbackHeapSet(position, lastSlot);
+		timerCallbackHeapSiftUp(position);
+		timerCallbackHeapSiftDown(callbacksArray[lastSlot].heapPosition);
+	}
+}
+
+void handleTimerCallbacks(void)
+{
+	uint32_t sequenceLimit = callbacksSequence;
+
+	while (callbacksCount > 0)
+	{
+		uint8_t slot = callbacksHeap[0];
+		timerCallback_t cbFunction = NULL;
+
+		// Not expired yet, or (re)added by a callback called from this loop
+		if (((int32_t)(ticksGetMillis() - callbacksArray[slot].dueTime) < 0) || ((int32_t)(callbacksArray[slot].sequence - sequenceLimit) >= 0))
 		{
-			callbacksArray[i].funPtr = funPtr;
-			callbacksArray[i].menuDestination = menuDest;
-			ticksTimerStart(&callbacksArray[i].PIT_TriggerTimer, callBackTime);
-			return true;
+			break;
 		}
 
-		if ((callbacksArray[i].funPtr == funPtr) && updateExistingCallbackTime)
+		// Does the current menu matches the desired destination menu
+		if ((callbacksArray[slot].menuDestination == MENU_ANY) || (callbacksArray[slot].menuDestination == menuSystemGetCurrentMenuNumber()))
 		{
-			callbacksArray[i].menuDestination = menuDest;
-			ticksTimerStart(&callbacksArray[i].PIT_TriggerTimer, callBackTime);
-			return true;
+			// Postpone the call to callback function, as it could add/delete/update a TimerCallback in its code.
+			cbFunction = callbacksArray[slot].funPtr;
+		}
+
+		timerCallbackRemove(slot);
+
+		if (cbFunction != NULL)
+		{
+			cbFunction();
 		}
+	}
+}
+
+timerCallbackHandle_t addTimerCallbackWithHandle(timerCallback_t funPtr, uint32_t delayIn_mS, int menuDest, bool updateExistingCallbackTime)
+{
+	int freeSlot = -1;
 
-		// callbacksArray[i] must be non-null pointer
-		if (ticksTimerHasExpired(&callbacksArray[i].PIT_TriggerTimer))
+	for (int i = 0; i < MAX_NUM_TIMER_CALLBACKS; i++)
+	{
+		if (callbacksArray[i].funPtr == NULL)
 		{
-			if (i != (MAX_NUM_TIMER_CALLBACKS - 1))
+			if (freeSlot == -1)
 			{
-				// shuffle all other callbacks down in the list if there is space
-				memmove(&callbacksArray[i+1], &callbacksArray[i], ((MAX_NUM_TIMER_CALLBACKS - 1) - i) * sizeof(timerCallbackbackStruct_t));
+				freeSlot = i;
 			}
-			callbacksArray[i].funPtr = funPtr;
-			callbacksArray[i].menuDestination = menuDest;
-			ticksTimerStart(&callbacksArray[i].PIT_TriggerTimer, callBackTime);
-			return true;
+		}
+		else if ((callbacksArray[i].funPtr == funPtr) && updateExistingCallbackTime)
+		{
+			timerCallbackSchedule(i, delayIn_mS, menuDest, true);
+			return TIMER_CALLBACK_HANDLE(i, callbacksArray[i].sequence);
 		}
 	}
-	return false;
+
+	if (freeSlot == -1)
+	{
+		return TIMER_CALLBACK_INVALID_HANDLE;
+	}
+
+	callbacksArray[freeSlot].funPtr = funPtr;
+	timerCallbackSchedule(freeSlot, delayIn_mS, menuDest, false);
+
+	return TIMER_CALLBACK_HANDLE(freeSlot, callbacksArray[freeSlot].sequence);
+}
+
+bool addTimerCallback(timerCallback_t funPtr, uint32_t delayIn_mS, int menuDest, bool updateExistingCallbackTime)
+{
+	return (addTimerCallbackWithHandle(funPtr, delayIn_mS, menuDest, updateExistingCallbackTime) != TIMER_CALLBACK_INVALID_HANDLE);
 }
 
 bool cancelTimerCallback(timerCallback_t funPtr, int menuDest)
 {
-	for(int i = 0; i < MAX_NUM_TIMER_CALLBACKS; i++)
+	for (int i = 0; i < MAX_NUM_TIMER_CALLBACKS; i++)
 	{
 		if ((callbacksArray[i].funPtr == funPtr) && (callbacksArray[i].menuDestination == menuDest))
 		{
-			if (i != (MAX_NUM_TIMER_CALLBACKS - 1))
-			{
-				memmove(&callbacksArray[i], &callbacksArray[i + 1], ((MAX_NUM_TIMER_CALLBACKS - 1) - i) * sizeof(timerCallbackbackStruct_t));
-			}
-			callbacksArray[MAX_NUM_TIMER_CALLBACKS - 1].funPtr = NULL;
+			timerCallbackRemove(i);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// Returns false if the callback has already been called, cancelled or rescheduled
+bool cancelTimerCallbackByHandle(timerCallbackHandle_t handle)
+{
+	if (handle != TIMER_CALLBACK_INVALID_HANDLE)
+	{
+		uint8_t slot = (handle & 0xFF) - 1;
+
+		if ((slot < MAX_NUM_TIMER_CALLBACKS) && (callbacksArray[slot].funPtr != NULL) &&
+				(TIMER_CALLBACK_HANDLE(slot, callbacksArray[slot].sequence) == handle))
+		{
+			timerCallbackRemove(slot);
 			return true;
 		}
 	}
+
 	return false;
 }
 
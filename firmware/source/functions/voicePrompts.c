@@ -67,6 +67,9 @@ static int currentPromptLength = -1;
 static volatile uint32_t promptTail = 0; // used within ISR
 
 static __attribute__((section(".data.$RAM2"))) uint8_t ambeData[AMBE_DATA_BUFFER_SIZE];
+// AMBE data is read asynchronously, ahead of the other Flash reads (see getAmbeData())
+static spiFlashReadRequest_t ambeReadRequests[2];
+static spiFlashReadRequest_t *ambeReadRequest = &ambeReadRequests[0];
 
 #define VOICE_PROMPTS_SEQUENCE_BUFFER_SIZE 128
 
@@ -129,11 +132,27 @@ bool voicePromptsCheckMagicAndVersion(uint32_t *bufferAddress)
 	return ((header->magic == VOICE_PROMPTS_DATA_MAGIC) && (header->version == VOICE_PROMPTS_DATA_VERSION));
 }
 
+// Served straight away if the Flash is free, otherwise as soon as the chunk currently read by another task has been transferred.
 static void getAmbeData(int offset, int length)
 {
 	if (length <= AMBE_DATA_BUFFER_SIZE)
 	{
-		SPI_Flash_read(voicePromptsFlashDataAddress + offset, (uint8_t *)&ambeData, length);
+		spiFlashReadRequest_t *request = ambeReadRequest;
+
+		// A previous read still queued is superseded. If it's being transferred, it will complete first (same priority, FIFO), use the other request.
+		if ((SPI_Flash_readCancel(request) == false) && (request->state == SPI_FLASH_REQUEST_PENDING))
+		{
+			request = ((request == &ambeReadRequests[0]) ? &ambeReadRequests[1] : &ambeReadRequests[0]);
+			SPI_Flash_readCancel(request);
+		}
+
+		request->address = (voicePromptsFlashDataAddress + offset);
+		request->buffer = ambeData;
+		request->size = length;
+		request->priority = SPI_FLASH_PRIORITY_VOICE;
+		ambeReadRequest = request;
+
+		SPI_Flash_readAsync(request);
 	}
 }
 
@@ -159,7 +178,11 @@ void voicePromptsTick(void)
 {
 	if (voicePromptIsActive)
 	{
-		if (promptDataPosition < currentPromptLength)
+		if (ambeReadRequest->state == SPI_FLASH_REQUEST_PENDING)
+		{
+			// Wait for the AMBE data
+		}
+		else if (promptDataPosition < currentPromptLength)
 		{
 			taskENTER_CRITICAL();
 			if (wavbuffer_count <= WAV_BUFFER_AMBE_PREBUFFERING_COUNT)
@@ -83,6 +83,9 @@
 #define CC_PROBE_MAX_COUNT                 (4 * 2)
 #define CC_PROBE_LOCKED                    (CC_PROBE_MAX_COUNT + 1)
 
+#define HRC6000_TASK_TICK_PERIOD_MS         1 // DMR mode, maximum time between two hrc6000Tick() calls
+#define HRC6000_TASK_IDLE_PERIOD_MS        10 // FM mode, nothing to do but keeping the alive count
+
 
 Task_t hrc6000Task;
 
@@ -784,6 +787,9 @@ static void hrc6000HandleLCData(void)
 
 void PORTC_IRQHandler(void)
 {
+	bool wakeUpTask = false;
+
+	PROFILER_ENTER(PROFILER_SITE_PORTC_IRQ);
 	hrc.inIRQHandler = true;
 
 	if (interruptsWasPinTriggered(Port_INT_C6000_SYS, Pin_INT_C6000_SYS))
@@ -791,6 +797,7 @@ void PORTC_IRQHandler(void)
 		if (rxPowerSavingIsRxOn())
 		{
 			hrc6000SysInterruptHandler();
+			wakeUpTask = true;
 		}
 		interruptsClearPinFlags(Port_INT_C6000_SYS, Pin_INT_C6000_SYS);
 	}
@@ -798,6 +805,7 @@ void PORTC_IRQHandler(void)
 	if (interruptsWasPinTriggered(Port_INT_C6000_RF_RX, Pin_INT_C6000_TS))
 	{
 		hrc6000TimeslotInterruptHandler();
+		wakeUpTask = true;
 		interruptsClearPinFlags(Port_INT_C6000_RF_RX, Pin_INT_C6000_TS);
 	}
 
@@ -816,6 +824,17 @@ void PORTC_IRQHandler(void)
 	hrc.interruptTimeout = 0;
 	hrc.inIRQHandler = false;
 
+	// Let the HR-C6000 task handle what the Sys and Timeslot interrupts have done
+	if (wakeUpTask && (hrc6000Task.Handle != NULL))
+	{
+		BaseType_t higherPriorityTaskWoken = pdFALSE;
+
+		vTaskNotifyGiveFromISR(hrc6000Task.Handle, &higherPriorityTaskWoken);
+		portYIELD_FROM_ISR(higherPriorityTaskWoken);
+	}
+
+	PROFILER_EXIT(PROFILER_SITE_PORTC_IRQ);
+
 	/* Add for ARM errata 838869, affects Cortex-M4, Cortex-M4F Store immediate overlapping
     exception return operation might vector to incorrect interrupt */
 	__DSB();
@@ -1440,7 +1459,6 @@ static inline void hrc6000SysInterruptHandler(void)
 	}
 
 	SPI0WritePageRegByte(0x04, 0x83, reg_0x82);  // Clear all Interrupt flags set for this run
-	timer_hrc6000task = 0;
 }
 
 static void hrc6000TransitionToTx(void)
@@ -1468,7 +1486,6 @@ static inline void hrc6000TimeslotInterruptHandler(void)
 
 	if (reg52Result == false)
 	{
-		timer_hrc6000task = 0;
 		return;
 	}
 
@@ -1498,7 +1515,6 @@ static inline void hrc6000TimeslotInterruptHandler(void)
 			codecInit(false);
 		}
 
-		timer_hrc6000task = 0;
 		return;
 	}
 
@@ -1932,8 +1948,6 @@ static inline void hrc6000TimeslotInterruptHandler(void)
 			hrc.keepMonitorCapturedTSAfterTxing = false;
 		}
 	}
-
-	timer_hrc6000task = 0; // I don't think this actually does anything. Its probably redundant legacy code
 }
 
 static inline void hrc6000RxInterruptHandler(void)
@@ -2166,6 +2180,7 @@ static void hrc6000Tick(void)
 			// This is possibly not the ideal solution, and a better solution may be found at a later date
 			// But at least it should prevent things going too badly wrong
 			NVIC_DisableIRQ(PORTC_IRQn);
+			PROFILER_ENTER(PROFILER_SITE_HRC6000_PORTC_DISABLED);
 
 			// Ensure the ISR has exited
 			while (hrc.inIRQHandler);
@@ -2180,7 +2195,7 @@ static void hrc6000Tick(void)
 				{
 					hrc.hotspotPostponedFrameHandling = (HS_NUM_OF_SILENCE_SEQ_ON_STARTUP * 6);
 					// LC and Frame data will be uplodaded in hrc6000TimeslotInterruptHandler(), DMR_STATE_TX_2 case.
-					memcpy((uint8_t *)deferredUpdateBuffer, (uint8_t *)&audioAndHotspotDataBuffer.hotspotBuffer[wavbuffer_read_idx], AMBE_AUDIO_LENGTH + LC_DATA_LENGTH);
+					hotspotPeekNetFrame((uint8_t *)deferredUpdateBuffer);
 					// Note:
 					//       We don't increment the buffer indexes, because this is also the first frame of audio and we need
 					// it later, and LC data are needed for the silent frames
@@ -2224,6 +2239,7 @@ static void hrc6000Tick(void)
 			SPI0WritePageRegByte(0x04, 0x21, 0xA2); // Set Polite to Color Code and Reset vocoder encodingbuffer
 			SPI0WritePageRegByte(0x04, 0x22, 0x86); // Start Vocoder Encode, I2S mode
 
+			PROFILER_EXIT(PROFILER_SITE_HRC6000_PORTC_DISABLED);
 			NVIC_EnableIRQ(PORTC_IRQn);
 
 			SPI0WritePageRegByte(0x04, 0x40, 0xE3); // TX and RX enable, Active Timing.
@@ -2298,6 +2314,7 @@ static void hrc6000Tick(void)
 				{
 					// Retry. Stop everything and restart.
 					NVIC_DisableIRQ(PORTC_IRQn);
+					PROFILER_ENTER(PROFILER_SITE_HRC6000_PORTC_DISABLED);
 
 					// Ensure the ISR has exited
 					while (hrc.inIRQHandler);
@@ -2323,6 +2340,7 @@ static void hrc6000Tick(void)
 					SPI0WritePageRegByte(0x04, 0x21, 0xA2); // Set Polite to Color Code and Reset vocoder encodingbuffer
 					SPI0WritePageRegByte(0x04, 0x22, 0x86); // Start Vocoder Encode, I2S mode
 
+					PROFILER_EXIT(PROFILER_SITE_HRC6000_PORTC_DISABLED);
 					NVIC_EnableIRQ(PORTC_IRQn);
 
 					SPI0WritePageRegByte(0x04, 0x40, 0xE3); // TX and RX enable, Active Timing.
@@ -2335,13 +2353,8 @@ static void hrc6000Tick(void)
 			// normal operation. Not waking the repeater
 			if (settingsUsbMode == USB_MODE_HOTSPOT)
 			{
-				if ((hrc.hotspotPostponedFrameHandling == 0) && (hrc.hotspotDMRTxFrameBufferEmpty == true) && (wavbuffer_count > 0))
+				if ((hrc.hotspotPostponedFrameHandling == 0) && (hrc.hotspotDMRTxFrameBufferEmpty == true) && hotspotGetNetFrame((uint8_t *)deferredUpdateBuffer))
 				{
-					memcpy((uint8_t *)deferredUpdateBuffer, (uint8_t *)&audioAndHotspotDataBuffer.hotspotBuffer[wavbuffer_read_idx], AMBE_AUDIO_LENGTH + LC_DATA_LENGTH);
-
-					wavbuffer_read_idx = ((wavbuffer_read_idx + 1) % HOTSPOT_BUFFER_COUNT);
-
-					wavbuffer_count--;
 					hrc.hotspotDMRTxFrameBufferEmpty = false;
 				}
 			}
@@ -2426,6 +2439,7 @@ static void hrc6000Tick(void)
 			}
 
 			taskENTER_CRITICAL();
+			PROFILER_ENTER(PROFILER_SITE_HRC6000_RX_AUDIO);
 			if (hrc.hasEncodedAudio || hrc.insertSilenceFrame)
 			{
 				// voice prompts take priority over incoming DMR audio
@@ -2456,6 +2470,7 @@ static void hrc6000Tick(void)
 				hrc.hasAbnormalExit = false; // Clear abnormal exit
 			}
 			soundTickRXBuffer();
+			PROFILER_EXIT(PROFILER_SITE_HRC6000_RX_AUDIO);
 			taskEXIT_CRITICAL();
 		}
 
@@ -2525,34 +2540,43 @@ static void hrc6000Tick(void)
 	hrc.rxCRCisValid = false;// Reset this
 }
 
+// The task sleeps until PORTC_IRQHandler() notifies it, or the tick period has elapsed
+// (the CC hold and the various timeouts are counted in ticks).
 static void hrc6000TaskFunction(void *data)
 {
+	uint32_t notified;
+	int previousSlotState = slotState;
+
 	while (1U)
 	{
 		hrc6000Task.AliveCount = TASK_FLAGGED_ALIVE;
 
-		if (timer_hrc6000task == 0)
-		{
-			// Update our atomic transmission state
-			hrc.transmissionEnabled = trxTransmissionEnabled;
+		// Update our atomic transmission state
+		hrc.transmissionEnabled = trxTransmissionEnabled;
 
-			// If DIGITAL mode is active, we must handle it ;-)
-			if (trxGetMode() == RADIO_MODE_DIGITAL)
-			{
-				hrc6000Tick();
-			}
-
-			timer_hrc6000task = 1; // Reset ISR activity marker
+		// If DIGITAL mode is active, we must handle it ;-)
+		if (trxGetMode() == RADIO_MODE_DIGITAL)
+		{
+			hrc6000Tick();
+			notified = ulTaskNotifyTake(pdTRUE, (HRC6000_TASK_TICK_PERIOD_MS / portTICK_PERIOD_MS));
 		}
 		else
 		{
-			if (trxGetMode() == RADIO_MODE_DIGITAL)
-			{
-				hrc6000ManageCCHoldState();
-			}
+			notified = ulTaskNotifyTake(pdTRUE, (HRC6000_TASK_IDLE_PERIOD_MS / portTICK_PERIOD_MS));
 		}
 
-		vTaskDelay((0 / portTICK_PERIOD_MS));
+		hrc6000Task.Wakeups++;
+		if (notified != 0)
+		{
+			hrc6000Task.NotifiedWakeups++;
+		}
+
+		// A DMR call started or ended, the UI doesn't have to wait for the end of its idle period
+		if (slotState != previousSlotState)
+		{
+			previousSlotState = slotState;
+			mainTaskWakeUp();
+		}
 	}
 }
 
@@ -28,6 +28,7 @@
 #include "hardware/SPI_Flash.h"
 #include "interfaces/gpio.h"
 #include "functions/ticks.h"
+#include "interfaces/wdog.h"
 
 __attribute__((section(".data.$RAM2"))) uint8_t SPI_Flash_sectorbuffer[4096];
 
@@ -60,9 +61,32 @@ __attribute__((section(".data.$RAM2"))) uint8_t SPI_Flash_sectorbuffer[4096];
 #define SR1_WEN_MASK	0x02
 #define WINBOND_MANUF	0xef
 
+#define SECTOR_SIZE                 4096
+#define PAGE_SIZE                   256
+#define PAGES_PER_SECTOR            (SECTOR_SIZE / PAGE_SIZE)
+#define SECTOR_CACHE_INVALID        0xFFFFFFFF
+#define SECTOR_CACHE_FLUSH_DELAY_MS 1000 // Idle time after the last write, before the cached sector is written back
+#define READ_CHUNK_SIZE             32   // Bytes transferred per critical section while reading
+#define LOCK_TIMEOUT_MS             20   // Max time spent waiting for another task to release the flash
+
 uint32_t flashChipPartNumber;
 volatile static bool flashIsBusy = false;
 
+// Asynchronous reads, one FIFO per priority. They are served by the task holding the flash, see spi_flash_unlock().
+static spiFlashReadRequest_t *readQueueHead[SPI_FLASH_PRIORITY_MAX];
+static spiFlashReadRequest_t *readQueueTail[SPI_FLASH_PRIORITY_MAX];
+static spiFlashReadRequest_t *readQueueCurrent = NULL;// Request being transferred
+
+static void spi_flash_cacheOverlay(uint32_t addr, uint8_t *dataBuf, int size);
+
+// Write-back sector cache.
+// SPI_Flash_sectorbuffer holds the content of the sector at sectorCacheAddress,
+// each bit of sectorCacheDirtyPages flags a page which has been modified since the sector was loaded.
+static uint32_t sectorCacheAddress = SECTOR_CACHE_INVALID;
+static uint16_t sectorCacheDirtyPages = 0;
+static uint32_t sectorCacheDirtyTime = 0;
+static uint8_t sectorCachePageBuffer[PAGE_SIZE];
+
 
 static inline void spi_flash_enable(void)
 {
@@ -158,17 +182,37 @@ static bool SPI_Flash_eraseSector_UNLOCKED(uint32_t addr_start)
 
 // Returns false for failed
 // Note. There is no error checking that the device is not initially busy.
+// The transfer is split into READ_CHUNK_SIZE chunks, each one in its own critical section.
+// Chip select stays asserted in between, so the flash keeps streaming from the current address,
+// while pending interrupts (e.g. HR-C6000) get serviced between chunks.
 static bool SPI_Flash_read_UNLOCKED(uint32_t addr, uint8_t *dataBuf, int size)
 {
 	uint8_t commandBuf[4]= { READ, addr >> 16, addr >> 8, addr };// command
 
+	taskENTER_CRITICAL();
 	spi_flash_enable();
 	spi_flash_transfer_buf(commandBuf, commandBuf, 4);
-	for(int i = 0; i < size; i++)
+	taskEXIT_CRITICAL();
+
+	while (size > 0)
 	{
-		*dataBuf++ = spi_flash_transfer(0x00);
+		int chunkSize = ((size > READ_CHUNK_SIZE) ? READ_CHUNK_SIZE : size);
+
+		size -= chunkSize;
+
+		taskENTER_CRITICAL();
+		PROFILER_ENTER(PROFILER_SITE_SPI_FLASH_READ);
+		while (chunkSize-- > 0)
+		{
+			*dataBuf++ = spi_flash_transfer(0x00);
+		}
+		PROFILER_EXIT(PROFILER_SITE_SPI_FLASH_READ);
+		taskEXIT_CRITICAL();
 	}
+
+	taskENTER_CRITICAL();
 	spi_flash_disable();
+	taskEXIT_CRITICAL();
 
 	return true;
 }
@@ -202,6 +246,434 @@ static bool SPI_Flash_writePage_UNLOCKED(uint32_t addr_start, uint8_t *dataBuf)
 }
 
 
+// Read queue helpers, to be called with the interrupts masked.
+// Returns the first queued request with a priority higher than 'priority' (SPI_FLASH_PRIORITY_MAX: any priority), NULL if none.
+static spiFlashReadRequest_t *spi_flash_readQueueFirst(spiFlashPriority_t priority)
+{
+	for (int p = 0; p < priority; p++)
+	{
+		if (readQueueHead[p] != NULL)
+		{
+			return readQueueHead[p];
+		}
+	}
+
+	return NULL;
+}
+
+static bool spi_flash_readQueueRemove(spiFlashReadRequest_t *request)
+{
+	spiFlashReadRequest_t *previous = NULL;
+	spiFlashReadRequest_t *r = readQueueHead[request->priority];
+
+	while ((r != NULL) && (r != request))
+	{
+		previous = r;
+		r = r->next;
+	}
+
+	if (r == NULL)
+	{
+		return false;
+	}
+
+	if (previous == NULL)
+	{
+		readQueueHead[request->priority] = request->next;
+	}
+	else
+	{
+		previous->next = request->next;
+	}
+
+	if (readQueueTail[request->priority] == request)
+	{
+		readQueueTail[request->priority] = previous;
+	}
+
+	request->next = NULL;
+
+	return true;
+}
+
+static bool spi_flash_higherPriorityReadIsQueued(spiFlashPriority_t priority)
+{
+	bool queued;
+
+	taskENTER_CRITICAL();
+	queued = (spi_flash_readQueueFirst(priority) != NULL);
+	taskEXIT_CRITICAL();
+
+	return queued;
+}
+
+static void spi_flash_readCompleted(spiFlashReadRequest_t *request, spiFlashRequestState_t state)
+{
+	spiFlashReadCallback_t callback = request->callback;
+	TaskHandle_t notifyTask = request->notifyTask;
+
+	// From now on, the request belongs to its owner again (it could even be reused by the callback)
+	request->state = state;
+
+	if (callback != NULL)
+	{
+		callback(request);
+	}
+
+	if (notifyTask != NULL)
+	{
+		xTaskNotifyGive(notifyTask);
+	}
+}
+
+// Serves the queued reads, highest priority first (the flash has to be locked). Each request is transferred in READ_CHUNK_SIZE chunks,
+// and set aside, keeping its position, as soon as a higher priority one gets queued (e.g. voice prompt data during a CPS read).
+static void spi_flash_processReadQueue(void)
+{
+	while (true)
+	{
+		spiFlashReadRequest_t *request;
+		uint8_t commandBuf[4];
+		uint32_t addr;
+		bool completed = true;
+
+		taskENTER_CRITICAL();
+		request = readQueueCurrent = spi_flash_readQueueFirst(SPI_FLASH_PRIORITY_MAX);
+		taskEXIT_CRITICAL();
+
+		if (request == NULL)
+		{
+			break;
+		}
+
+		addr = (request->address + request->position);
+		commandBuf[0] = READ;
+		commandBuf[1] = (addr >> 16);
+		commandBuf[2] = (addr >> 8);
+		commandBuf[3] = addr;
+
+		taskENTER_CRITICAL();
+		spi_flash_enable();
+		spi_flash_transfer_buf(commandBuf, commandBuf, 4);
+		taskEXIT_CRITICAL();
+
+		while (request->position < request->size)
+		{
+			int chunkSize = (((request->size - request->position) > READ_CHUNK_SIZE) ? READ_CHUNK_SIZE : (request->size - request->position));
+			uint8_t *dataBuf = (request->buffer + request->position);
+
+			request->position += chunkSize;
+
+			taskENTER_CRITICAL();
+			PROFILER_ENTER(PROFILER_SITE_SPI_FLASH_READ);
+			while (chunkSize-- > 0)
+			{
+				*dataBuf++ = spi_flash_transfer(0x00);
+			}
+			PROFILER_EXIT(PROFILER_SITE_SPI_FLASH_READ);
+			taskEXIT_CRITICAL();
+
+			if ((request->position < request->size) && spi_flash_higherPriorityReadIsQueued(request->priority))
+			{
+				completed = false;
+				break;
+			}
+		}
+
+		taskENTER_CRITICAL();
+		spi_flash_disable();
+		if (completed)
+		{
+			spi_flash_readQueueRemove(request);
+		}
+		readQueueCurrent = NULL;
+		taskEXIT_CRITICAL();
+
+		if (completed)
+		{
+			spi_flash_cacheOverlay(request->address, request->buffer, request->size);
+			spi_flash_readCompleted(request, SPI_FLASH_REQUEST_COMPLETED);
+		}
+	}
+}
+
+static bool spi_flash_tryLock(void)
+{
+	bool locked = false;
+
+	taskENTER_CRITICAL();
+	if (flashIsBusy == false)
+	{
+		flashIsBusy = true;
+		locked = true;
+	}
+	taskEXIT_CRITICAL();
+
+	return locked;
+}
+
+// As reads and writes are preemptible, another task could be using the flash.
+// Wait for it to finish (only from a task, once the scheduler is running), instead of failing straight away.
+static bool spi_flash_lock(void)
+{
+	uint32_t waitCounter = LOCK_TIMEOUT_MS;
+
+	while (spi_flash_tryLock() == false)
+	{
+		if ((waitCounter-- == 0) || (xTaskGetSchedulerState() != taskSCHEDULER_RUNNING) || xPortIsInsideInterrupt())
+		{
+			return false;
+		}
+
+		vTaskDelay((1 / portTICK_PERIOD_MS));
+	}
+
+	return true;
+}
+
+// Serves the reads queued in the meantime, then releases the flash. As checking the queue and releasing happen with
+// the interrupts masked, a read queued by another task is either served here, or finds the flash free and serves itself.
+static void spi_flash_unlock(void)
+{
+	while (true)
+	{
+		spi_flash_processReadQueue();
+
+		taskENTER_CRITICAL();
+		if (spi_flash_readQueueFirst(SPI_FLASH_PRIORITY_MAX) == NULL)
+		{
+			flashIsBusy = false;
+			taskEXIT_CRITICAL();
+			break;
+		}
+		taskEXIT_CRITICAL();
+	}
+}
+
+static void spi_flash_readQueueAppend(spiFlashReadRequest_t *request)
+{
+	request->position = 0;
+	request->next = NULL;
+	request->state = SPI_FLASH_REQUEST_PENDING;
+
+	taskENTER_CRITICAL();
+	if (readQueueTail[request->priority] == NULL)
+	{
+		readQueueHead[request->priority] = request;
+	}
+	else
+	{
+		readQueueTail[request->priority]->next = request;
+	}
+	readQueueTail[request->priority] = request;
+	taskEXIT_CRITICAL();
+}
+
+// Each flash operation has its own critical section, so the interrupts are not masked for the whole sector write.
+static bool spi_flash_eraseSectorLocked(uint32_t addr_start)
+{
+	bool ret;
+
+	taskENTER_CRITICAL();
+	PROFILER_ENTER(PROFILER_SITE_SPI_FLASH_ERASE);
+	ret = SPI_Flash_eraseSector_UNLOCKED(addr_start);
+	PROFILER_EXIT(PROFILER_SITE_SPI_FLASH_ERASE);
+	taskEXIT_CRITICAL();
+
+	return ret;
+}
+
+static bool spi_flash_writePageLocked(uint32_t addr_start, uint8_t *dataBuf)
+{
+	bool ret;
+
+	taskENTER_CRITICAL();
+	PROFILER_ENTER(PROFILER_SITE_SPI_FLASH_WRITE);
+	ret = SPI_Flash_writePage_UNLOCKED(addr_start, dataBuf);
+	PROFILER_EXIT(PROFILER_SITE_SPI_FLASH_WRITE);
+	taskEXIT_CRITICAL();
+
+	return ret;
+}
+
+static bool spi_flash_pageIsErased(uint8_t *page)
+{
+	for (int i = 0; i < PAGE_SIZE; i++)
+	{
+		if (page[i] != 0xFF)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Write back the dirty pages of the cached sector.
+// Pages which are identical to the flash content are skipped, and the sector is only erased
+// if some bit of the dirty pages has to go from 0 to 1 (programming can only clear bits).
+static bool spi_flash_cacheFlush(void)
+{
+	bool needsErase = false;
+
+	if ((sectorCacheAddress == SECTOR_CACHE_INVALID) || (sectorCacheDirtyPages == 0))
+	{
+		return true;
+	}
+
+	for (int p = 0; p < PAGES_PER_SECTOR; p++)
+	{
+		if (sectorCacheDirtyPages & (1U << p))
+		{
+			uint8_t *cachedPage = SPI_Flash_sectorbuffer + (p * PAGE_SIZE);
+
+			if (SPI_Flash_read_UNLOCKED(sectorCacheAddress + (p * PAGE_SIZE), sectorCachePageBuffer, PAGE_SIZE) == false)
+			{
+				return false;
+			}
+
+			if (memcmp(cachedPage, sectorCachePageBuffer, PAGE_SIZE) == 0)
+			{
+				sectorCacheDirtyPages &= ~(1U << p);
+				continue;
+			}
+
+			for (int i = 0; i < PAGE_SIZE; i++)
+			{
+				if (cachedPage[i] & ~sectorCachePageBuffer[i])
+				{
+					needsErase = true;
+					break;
+				}
+			}
+		}
+	}
+
+	if (sectorCacheDirtyPages != 0)
+	{
+		uint32_t retries = 3;
+		bool retVal;
+
+		do
+		{
+			retVal = true;
+
+			if (needsErase)
+			{
+				retVal = spi_flash_eraseSectorLocked(sectorCacheAddress);
+			}
+
+			for (int p = 0; (p < PAGES_PER_SECTOR) && retVal; p++)
+			{
+				uint8_t *cachedPage = SPI_Flash_sectorbuffer + (p * PAGE_SIZE);
+
+				// After an erase, every page holding data has to be programmed again, otherwise only the dirty ones.
+				if (needsErase ? (spi_flash_pageIsErased(cachedPage) == false) : ((sectorCacheDirtyPages & (1U << p)) != 0))
+				{
+					retVal = spi_flash_writePageLocked(sectorCacheAddress + (p * PAGE_SIZE), cachedPage);
+				}
+			}
+
+			if (retVal == false)
+			{
+				// A partially written sector can only be recovered by an erase.
+				needsErase = true;
+			}
+		} while ((retVal == false) && (--retries > 0));
+
+		if (retVal == false)
+		{
+			return false;
+		}
+
+		sectorCacheDirtyPages = 0;
+	}
+
+	return true;
+}
+
+// Load the sector at sectorAddress into the cache, writing back the currently cached sector beforehand.
+// If the whole sector is going to be overwritten, its content doesn't need to be read.
+static bool spi_flash_cacheLoad(uint32_t sectorAddress, bool overwritten)
+{
+	if (sectorCacheAddress == sectorAddress)
+	{
+		return true;
+	}
+
+	if (spi_flash_cacheFlush() == false)
+	{
+		return false;
+	}
+
+	sectorCacheAddress = SECTOR_CACHE_INVALID;
+
+	if (overwritten == false)
+	{
+		uint32_t retries = 3;
+		bool retVal;
+
+		do
+		{
+			retVal = SPI_Flash_read_UNLOCKED(sectorAddress, SPI_Flash_sectorbuffer, SECTOR_SIZE);
+		} while ((retVal == false) && (--retries > 0));
+
+		if (retVal == false)
+		{
+			return false;
+		}
+	}
+
+	sectorCacheAddress = sectorAddress;
+
+	return true;
+}
+
+static void spi_flash_cacheUpdate(uint32_t offset, uint8_t *dataBuf, int size, bool overwritten)
+{
+	uint8_t *cachePos = SPI_Flash_sectorbuffer + offset;
+	int firstPage = offset / PAGE_SIZE;
+	int lastPage = (offset + size - 1) / PAGE_SIZE;
+
+	for (int p = firstPage; p <= lastPage; p++)
+	{
+		uint32_t start = ((p == firstPage) ? offset : (p * PAGE_SIZE));
+		uint32_t end = ((p == lastPage) ? (offset + size) : ((p + 1) * PAGE_SIZE));
+		uint8_t *src = dataBuf + (start - offset);
+
+		// The previous content is unknown when the sector wasn't read, so flag it dirty unconditionally.
+		if (overwritten || (memcmp(SPI_Flash_sectorbuffer + start, src, (end - start)) != 0))
+		{
+			sectorCacheDirtyPages |= (1U << p);
+		}
+	}
+
+	memcpy(cachePos, dataBuf, size);
+
+	if (sectorCacheDirtyPages != 0)
+	{
+		sectorCacheDirtyTime = ticksGetMillis();
+	}
+}
+
+// Copy the cached (and potentially not yet written) data over a buffer just read from the flash.
+static void spi_flash_cacheOverlay(uint32_t addr, uint8_t *dataBuf, int size)
+{
+	if ((sectorCacheAddress != SECTOR_CACHE_INVALID) && (sectorCacheDirtyPages != 0) && (dataBuf != SPI_Flash_sectorbuffer) &&
+			(addr < (sectorCacheAddress + SECTOR_SIZE)) && ((addr + size) > sectorCacheAddress))
+	{
+		uint32_t start = ((addr > sectorCacheAddress) ? addr : sectorCacheAddress);
+		uint32_t end = (((addr + size) < (sectorCacheAddress + SECTOR_SIZE)) ? (addr + size) : (sectorCacheAddress + SECTOR_SIZE));
+
+		memcpy(dataBuf + (start - addr), SPI_Flash_sectorbuffer + (start - sectorCacheAddress), (end - start));
+	}
+}
+
+static bool spi_flash_addressIsInCachedSector(uint32_t addr)
+{
+	return ((sectorCacheAddress != SECTOR_CACHE_INVALID) && ((addr & ~(SECTOR_SIZE - 1)) == sectorCacheAddress));
+}
+
 /*
  *  ----- public functions ---
  */
@@ -235,150 +707,206 @@ bool SPI_Flash_init(void)
 
 bool SPI_Flash_read(uint32_t addr, uint8_t *dataBuf, int size)
 {
-	bool ret = false;
-	uint32_t retries = 3;
-
-	if (flashIsBusy)
-	{
-		return false;
-	}
-	taskENTER_CRITICAL();
-	flashIsBusy = true;
-
-	do
-	{
-		ret = SPI_Flash_read_UNLOCKED(addr, dataBuf, size);
-	} while ((ret == false) && (retries-- > 0));
-
-	flashIsBusy = false;
-	taskEXIT_CRITICAL();
-
-	return ret;
+	return SPI_Flash_readWithPriority(addr, dataBuf, size, SPI_FLASH_PRIORITY_UI);
 }
 
-bool SPI_Flash_write(uint32_t addr, uint8_t *dataBuf, int size)
+// Waits for the read to complete, behind the higher priority ones. Fails if it couldn't start within LOCK_TIMEOUT_MS.
+bool SPI_Flash_readWithPriority(uint32_t addr, uint8_t *dataBuf, int size, spiFlashPriority_t priority)
 {
-	bool retVal = false;
-	int flashWritePos;
-	int flashSector;
-	int flashEndSector;
-	int bytesToWriteInCurrentSector;
-	uint32_t retries = 3;
-
-	if (flashIsBusy)
+	spiFlashReadRequest_t request =
 	{
-		return false;
+		.address = addr,
+		.buffer = dataBuf,
+		.size = size,
+		.priority = priority,
+		.callback = NULL,
+		.notifyTask = NULL,
+		.userData = NULL,
+		.state = SPI_FLASH_REQUEST_IDLE
+	};
+	uint32_t waitCounter = LOCK_TIMEOUT_MS;
+
+	if (size <= 0)
+	{
+		return true;
 	}
-	taskENTER_CRITICAL();
-	flashIsBusy = true;
 
-	do
+	// The sector buffer is about to be used as scratch buffer by the caller (e.g. the CPS),
+	// write back and release the cached sector.
+	if (dataBuf == SPI_Flash_sectorbuffer)
 	{
-		flashWritePos = addr;
-		flashSector	= flashWritePos / 4096;
-		flashEndSector = (flashWritePos + size) / 4096;
-		bytesToWriteInCurrentSector = size;
+		bool flushed;
 
-		if (flashSector != flashEndSector)
+		if (spi_flash_lock() == false)
 		{
-			bytesToWriteInCurrentSector = (flashEndSector * 4096) - flashWritePos;
+			return false;
 		}
 
-		if (bytesToWriteInCurrentSector != 4096)
+		if ((flushed = spi_flash_cacheFlush()))
 		{
-			retVal = SPI_Flash_read_UNLOCKED(flashSector * 4096, SPI_Flash_sectorbuffer, 4096);
-			if (!retVal)
-			{
-				goto tryAgain;
-			}
+			sectorCacheAddress = SECTOR_CACHE_INVALID;
+			spi_flash_readQueueAppend(&request);
 		}
 
-		uint8_t *writePos = SPI_Flash_sectorbuffer + flashWritePos - (flashSector * 4096);
-		memcpy(writePos, dataBuf, bytesToWriteInCurrentSector);
+		spi_flash_unlock();// Serves the request
 
-		retVal = SPI_Flash_eraseSector_UNLOCKED(flashSector * 4096);
-		if (!retVal)
+		if (flushed == false)
 		{
-			goto tryAgain;
+			return false;
 		}
+	}
+	else if (SPI_Flash_readAsync(&request) == false)
+	{
+		return false;
+	}
 
-		for (int i = 0; i < 16; i++)
+	while (request.state == SPI_FLASH_REQUEST_PENDING)
+	{
+		// Can't wait (no scheduler, or inside an ISR) or waited long enough: withdraw the request, unless it's being transferred.
+		if ((waitCounter == 0) || (xTaskGetSchedulerState() != taskSCHEDULER_RUNNING) || xPortIsInsideInterrupt())
 		{
-			retVal = SPI_Flash_writePage_UNLOCKED(flashSector * 4096 + i * 256, SPI_Flash_sectorbuffer + i * 256);
-			if (!retVal)
+			if (SPI_Flash_readCancel(&request))
 			{
-				goto tryAgain;
+				return false;
 			}
 		}
-
-		if (flashSector != flashEndSector)
+		else
 		{
-			uint8_t *bufPusOffset = (uint8_t *) dataBuf + bytesToWriteInCurrentSector;
-			bytesToWriteInCurrentSector = size - bytesToWriteInCurrentSector;
+			waitCounter--;
+		}
 
-			retVal = SPI_Flash_read_UNLOCKED(flashEndSector * 4096, SPI_Flash_sectorbuffer, 4096);
-			if (!retVal)
-			{
-				goto tryAgain;
-			}
+		vTaskDelay((1 / portTICK_PERIOD_MS));
+	}
 
-			memcpy(SPI_Flash_sectorbuffer, (uint8_t *) bufPusOffset, bytesToWriteInCurrentSector);
+	return (request.state == SPI_FLASH_REQUEST_COMPLETED);
+}
 
-			retVal = SPI_Flash_eraseSector_UNLOCKED(flashEndSector * 4096);
-			if (!retVal)
-			{
-				goto tryAgain;
-			}
+// Queues the request, which is served straight away if the flash is free, otherwise by the task holding the flash.
+bool SPI_Flash_readAsync(spiFlashReadRequest_t *request)
+{
+	if ((request->size <= 0) || (request->priority >= SPI_FLASH_PRIORITY_MAX) || (request->state == SPI_FLASH_REQUEST_PENDING))
+	{
+		return false;
+	}
 
-			for (int i = 0; i < 16; i++)
-			{
-				retVal = SPI_Flash_writePage_UNLOCKED(flashEndSector * 4096 + i * 256, SPI_Flash_sectorbuffer + i * 256);
-				if (!retVal)
-				{
-					goto tryAgain;
-				}
-			}
+	spi_flash_readQueueAppend(request);
 
-			retVal = true;
-			break;
-		}
-		else
+	if (spi_flash_tryLock())
+	{
+		spi_flash_unlock();
+	}
+
+	return true;
+}
+
+// Withdraws a pending request. Fails if it's being transferred, or not pending anymore.
+bool SPI_Flash_readCancel(spiFlashReadRequest_t *request)
+{
+	bool cancelled = false;
+
+	taskENTER_CRITICAL();
+	if ((request->state == SPI_FLASH_REQUEST_PENDING) && (request != readQueueCurrent) && spi_flash_readQueueRemove(request))
+	{
+		request->state = SPI_FLASH_REQUEST_FAILED;
+		cancelled = true;
+	}
+	taskEXIT_CRITICAL();
+
+	return cancelled;
+}
+
+// The data is stored in the write-back sector cache, which is written to the flash
+// when another sector is accessed, or by SPI_Flash_flush()/SPI_Flash_flushIfNeeded().
+bool SPI_Flash_write(uint32_t addr, uint8_t *dataBuf, int size)
+{
+	bool retVal = true;
+
+	if (spi_flash_lock() == false)
+	{
+		return false;
+	}
+
+	while (size > 0)
+	{
+		uint32_t sectorAddress = (addr & ~(SECTOR_SIZE - 1));
+		uint32_t offset = (addr - sectorAddress);
+		int bytesToWriteInCurrentSector = (((offset + size) > SECTOR_SIZE) ? (SECTOR_SIZE - offset) : size);
+		bool overwritten = ((bytesToWriteInCurrentSector == SECTOR_SIZE) && (sectorCacheAddress != sectorAddress));
+
+		if ((retVal = spi_flash_cacheLoad(sectorAddress, overwritten)) == false)
 		{
-			retVal = true;
 			break;
 		}
 
-		tryAgain:
-		retries--;
+		spi_flash_cacheUpdate(offset, dataBuf, bytesToWriteInCurrentSector, overwritten);
 
-	} while ((retVal == false) && (retries > 0));
+		addr += bytesToWriteInCurrentSector;
+		dataBuf += bytesToWriteInCurrentSector;
+		size -= bytesToWriteInCurrentSector;
+	}
 
-	flashIsBusy = false;
-	taskEXIT_CRITICAL();
+	spi_flash_unlock();
 
 	return retVal;
 }
 
+bool SPI_Flash_flush(void)
+{
+	bool ret;
+
+	if (spi_flash_lock() == false)
+	{
+		return false;
+	}
+
+	ret = spi_flash_cacheFlush();
+
+	spi_flash_unlock();
+
+	return ret;
+}
+
+void SPI_Flash_flushIfNeeded(bool immediately)
+{
+	if ((sectorCacheDirtyPages != 0) &&
+			(immediately || ((ticksGetMillis() - sectorCacheDirtyTime) > SECTOR_CACHE_FLUSH_DELAY_MS)))
+	{
+		(void)SPI_Flash_flush();
+	}
+}
+
 bool SPI_Flash_writePage(uint32_t addr_start, uint8_t *dataBuf)
 {
 	bool ret = false;
 	uint32_t retries = 3;
 
-	if (flashIsBusy)
+	if (spi_flash_lock() == false)
 	{
 		return false;
 	}
-	taskENTER_CRITICAL();
-	flashIsBusy = true;
 
+	// Raw page access to the cached sector, write the pending data back and forget about it.
+	if (spi_flash_addressIsInCachedSector(addr_start))
+	{
+		if (spi_flash_cacheFlush() == false)
+		{
+			spi_flash_unlock();
+			return false;
+		}
+		sectorCacheAddress = SECTOR_CACHE_INVALID;
+	}
+
+	taskENTER_CRITICAL();
+	PROFILER_ENTER(PROFILER_SITE_SPI_FLASH_WRITE);
 	do
 	{
 		ret = SPI_Flash_writePage_UNLOCKED(addr_start, dataBuf);
 	} while ((ret == false) && (retries-- > 0));
-
-	flashIsBusy = false;
+	PROFILER_EXIT(PROFILER_SITE_SPI_FLASH_WRITE);
 	taskEXIT_CRITICAL();
 
+	spi_flash_unlock();
+
 	return ret;
 }
 
@@ -387,21 +915,29 @@ bool SPI_Flash_eraseSector(uint32_t addr_start)
 	bool ret = false;
 	uint32_t retries = 3;
 
-	if (flashIsBusy)
+	if (spi_flash_lock() == false)
 	{
 		return false;
 	}
-	taskENTER_CRITICAL();
-	flashIsBusy = true;
 
+	// The sector content is going to be lost anyway, no need to write the pending data.
+	if (spi_flash_addressIsInCachedSector(addr_start))
+	{
+		sectorCacheAddress = SECTOR_CACHE_INVALID;
+		sectorCacheDirtyPages = 0;
+	}
+
+	taskENTER_CRITICAL();
+	PROFILER_ENTER(PROFILER_SITE_SPI_FLASH_ERASE);
 	do
 	{
 		ret = SPI_Flash_eraseSector_UNLOCKED(addr_start);
 	} while ((ret == false) && (retries-- > 0));
-
-	flashIsBusy = false;
+	PROFILER_EXIT(PROFILER_SITE_SPI_FLASH_ERASE);
 	taskEXIT_CRITICAL();
 
+	spi_flash_unlock();
+
 	return ret;
 }
 
@@ -60,11 +60,126 @@ uint8_t *screenBuf = screenBufData;
 static const uint8_t *screenBufEnd = screenBuf + sizeof(screenBuf);
 #endif
 
+// Columns of each row (page) modified since they were last sent to the LCD, as [start, end).
+// An empty span (start >= end) means the row is in sync with the LCD.
+static uint8_t dirtyColumnStart[DISPLAY_NUMBER_OF_ROWS];
+static uint8_t dirtyColumnEnd[DISPLAY_NUMBER_OF_ROWS];
+
 #if defined(HAS_COLOURS)
 DayTime_t themeDaytime = DAY;
 uint16_t themeItems[NIGHT + 1][THEME_ITEM_MAX]; // Theme storage
 #endif
 
+static void displayMarkDirty(int16_t x, int16_t y, int16_t width, int16_t height);
+static void displayMarkRowsClean(int16_t startRow, int16_t endRow);
+static void displayRenderDirtyRows(void);
+
+static inline void displayMarkColumnDirty(uint16_t row, uint16_t column)
+{
+	if (column < dirtyColumnStart[row])
+	{
+		dirtyColumnStart[row] = column;
+	}
+
+	if (column >= dirtyColumnEnd[row])
+	{
+		dirtyColumnEnd[row] = column + 1;
+	}
+}
+
+static void displayMarkDirty(int16_t x, int16_t y, int16_t width, int16_t height)
+{
+	int16_t endX = x + width;
+	int16_t endY = y + height;
+
+	// Clip to the screen
+	if (x < 0)
+	{
+		x = 0;
+	}
+
+	if (y < 0)
+	{
+		y = 0;
+	}
+
+	if (endX > DISPLAY_SIZE_X)
+	{
+		endX = DISPLAY_SIZE_X;
+	}
+
+	if (endY > DISPLAY_SIZE_Y)
+	{
+		endY = DISPLAY_SIZE_Y;
+	}
+
+	if ((x >= endX) || (y >= endY))
+	{
+		return;
+	}
+
+	for (int16_t row = (y >> 3); row <= ((endY - 1) >> 3); row++)
+	{
+		if (x < dirtyColumnStart[row])
+		{
+			dirtyColumnStart[row] = x;
+		}
+
+		if (endX > dirtyColumnEnd[row])
+		{
+			dirtyColumnEnd[row] = endX;
+		}
+	}
+}
+
+void displayMarkAllDirty(void)
+{
+	memset(dirtyColumnStart, 0, sizeof(dirtyColumnStart));
+	memset(dirtyColumnEnd, DISPLAY_SIZE_X, sizeof(dirtyColumnEnd));
+}
+
+static void displayMarkRowsClean(int16_t startRow, int16_t endRow)
+{
+	if (startRow < 0)
+	{
+		startRow = 0;
+	}
+
+	if (endRow > DISPLAY_NUMBER_OF_ROWS)
+	{
+		endRow = DISPLAY_NUMBER_OF_ROWS;
+	}
+
+	for (int16_t row = startRow; row < endRow; row++)
+	{
+		dirtyColumnStart[row] = DISPLAY_SIZE_X;
+		dirtyColumnEnd[row] = 0;
+	}
+}
+
+// Only send the changed column spans of the changed rows
+static void displayRenderDirtyRows(void)
+{
+	int16_t startRow = 0;
+	int16_t endRow = DISPLAY_NUMBER_OF_ROWS;
+
+	while ((startRow < endRow) && (dirtyColumnStart[startRow] >= dirtyColumnEnd[startRow]))
+	{
+		startRow++;
+	}
+
+	while ((endRow > startRow) && (dirtyColumnStart[endRow - 1] >= dirtyColumnEnd[endRow - 1]))
+	{
+		endRow--;
+	}
+
+	if (startRow < endRow)
+	{
+		displayTransferRows(screenBuf, startRow, endRow, dirtyColumnStart, dirtyColumnEnd);
+		displayMarkRowsClean(startRow, endRow);
+	}
+}
+
 int16_t displaySetPixel(int16_t x, int16_t y, bool isInverted)
 {
 	int16_t i = ((y >> 3) * DISPLAY_SIZE_X) + x;
@@ -74,6 +189,8 @@ int16_t displaySetPixel(int16_t x, int16_t y, bool isInverted)
 		return -1;// off the screen
 	}
 
+	displayMarkColumnDirty(((uint16_t)i / DISPLAY_SIZE_X), ((uint16_t)i % DISPLAY_SIZE_X));
+
 	if (isInverted)
 	{
 		screenBuf[i] |= (0x1 << (y & 7));
@@ -88,7 +205,7 @@ int16_t displaySetPixel(int16_t x, int16_t y, bool isInverted)
 
 void displayRenderWithoutNotification(void)
 {
-	displayRenderRows(0, DISPLAY_NUMBER_OF_ROWS);
+	displayRenderDirtyRows();
 	headerRowIsDirty = false;
 }
 
@@ -100,11 +217,18 @@ void displayRender(void)
 	}
 	else
 	{
-		displayRenderRows(0, DISPLAY_NUMBER_OF_ROWS);
+		displayRenderDirtyRows();
 	}
 	headerRowIsDirty = false;
 }
 
+// Unconditionally send whole rows, whatever their dirty state
+void displayRenderRows(int16_t startRow, int16_t endRow)
+{
+	displayTransferRows(screenBuf, startRow, endRow, NULL, NULL);
+	displayMarkRowsClean(startRow, endRow);
+}
+
 //#define DISPLAY_CHECK_BOUNDS
 #ifdef DISPLAY_CHECK_BOUNDS
 static inline bool checkWritePos(uint8_t * writePos)
@@ -121,45 +245,93 @@ static inline bool checkWritePos(uint8_t * writePos)
 #endif
 
 #if ! defined(PLATFORM_GD77S)
-static uint8_t *getUncompressedChar(uint8_t *dest, uint8_t *currentFont, uint8_t charOffset)
+// Compressed (RLE8) glyphs have a variable size, the offset of one glyph out of GLYPH_INDEX_STEP
+// is indexed, so finding a glyph costs at most GLYPH_INDEX_STEP - 1 skips instead of a walk from the first one.
+#define GLYPH_INDEX_STEP          8
+#define GLYPH_INDEX_SIZE          ((CHARS_PER_FONT + GLYPH_INDEX_STEP - 1) / GLYPH_INDEX_STEP)
+#define GLYPH_CACHE_SIZE          4
+#define GLYPH_MAX_BYTES_PER_CHAR  64
+
+typedef struct
 {
-	if (charOffset < CHARS_PER_FONT)
+	const uint8_t *font;
+	uint8_t        charOffset;
+	uint8_t        data[GLYPH_MAX_BYTES_PER_CHAR];
+} glyphCacheEntry_t;
+
+static const uint8_t *glyphIndexFont = NULL;
+static uint16_t glyphIndex[GLYPH_INDEX_SIZE];
+static __attribute__((section(".data.$RAM2"))) glyphCacheEntry_t glyphCache[GLYPH_CACHE_SIZE];
+static uint8_t glyphCacheNext = 0;
+
+static void buildGlyphIndex(const uint8_t *font)
+{
+	const uint8_t *p = font + 8; // skip the header
+
+	for (uint16_t charOffset = 0; charOffset < CHARS_PER_FONT; charOffset++)
 	{
-		uint8_t count = 0;
-		uint8_t *p = currentFont + 8; // skip the header
-		uint8_t numOfPairs = *p;
+		if ((charOffset % GLYPH_INDEX_STEP) == 0)
+		{
+			glyphIndex[charOffset / GLYPH_INDEX_STEP] = (p - font);
+		}
+
+		p += ((*p * 2) + 1); // number of pairs, followed by the pairs
+	}
+
+	glyphIndexFont = font;
+}
 
-		do
+static uint8_t *getUncompressedChar(uint8_t *currentFont, uint8_t charOffset)
+{
+	glyphCacheEntry_t *entry;
+
+	for (uint8_t i = 0; i < GLYPH_CACHE_SIZE; i++)
+	{
+		if ((glyphCache[i].font == currentFont) && (glyphCache[i].charOffset == charOffset))
 		{
-			if (count == charOffset)
-			{
-				uint8_t *pSrc = p + 1;
-				uint8_t *pDest = dest;
+			return glyphCache[i].data;
+		}
+	}
 
-				// decode RLE8
-				while (numOfPairs > 0)
-				{
-					uint8_t l = (*(pSrc + 1) + 1);
+	entry = &glyphCache[glyphCacheNext];
+	glyphCacheNext = ((glyphCacheNext + 1) % GLYPH_CACHE_SIZE);
 
-					memset(pDest, *pSrc, l);
+	entry->font = currentFont;
+	entry->charOffset = charOffset;
+	memset(entry->data, 0x00, sizeof(entry->data));
 
-					pDest += l;
-					pSrc += 2;
-					numOfPairs--;
-				}
+	if (charOffset < CHARS_PER_FONT)
+	{
+		if (glyphIndexFont != currentFont)
+		{
+			buildGlyphIndex(currentFont);
+		}
 
-				break;
-			}
+		uint8_t *p = currentFont + glyphIndex[charOffset / GLYPH_INDEX_STEP];
+
+		for (uint8_t count = (charOffset % GLYPH_INDEX_STEP); count > 0; count--)
+		{
+			p += ((*p * 2) + 1);
+		}
 
-			p += ((numOfPairs * 2) + 1);
-			numOfPairs = *p;
+		uint8_t numOfPairs = *p;
+		uint8_t *pSrc = p + 1;
+		uint8_t *pDest = entry->data;
+
+		// decode RLE8
+		while (numOfPairs > 0)
+		{
+			uint8_t l = (*(pSrc + 1) + 1);
 
-			count++;
+			memset(pDest, *pSrc, l);
 
-		} while (count < CHARS_PER_FONT);
+			pDest += l;
+			pSrc += 2;
+			numOfPairs--;
+		}
 	}
 
-	return dest;
+	return entry->data;
 }
 #endif
 
@@ -177,7 +349,6 @@ int displayPrintCore(int16_t x, int16_t y, const char *szMsg, ucFont_t fontSize,
 	uint8_t *writePos;
 	uint8_t *readPos;
 	bool fontIsCompressed = false;
-	uint8_t uncompressChar[64];
 
     sLen = strlen(szMsg);
 
@@ -251,6 +422,8 @@ int displayPrintCore(int16_t x, int16_t y, const char *szMsg, ucFont_t fontSize,
 			break;
 	}
 
+	displayMarkDirty(x, y, (charWidthPixels * sLen), charHeightPixels);
+
 	for (int16_t i = 0; i < sLen; i++)
 	{
 		// Skip space character as it's empty (and no more part of the fonts).
@@ -269,7 +442,7 @@ int displayPrintCore(int16_t x, int16_t y, const char *szMsg, ucFont_t fontSize,
 
 		if (fontIsCompressed)
 		{
-			currentCharData = getUncompressedChar(&uncompressChar[0], currentFont, charOffset);
+			currentCharData = getUncompressedChar(currentFont, charOffset);
 		}
 		else
 		{
@@ -355,6 +528,7 @@ int displayPrintCore(int16_t x, int16_t y, const char *szMsg, ucFont_t fontSize,
 void displayClearBuf(void)
 {
 	memset(screenBuf, 0x00, ((DISPLAY_SIZE_X * DISPLAY_SIZE_Y) >> 3));
+	displayMarkAllDirty();
 }
 
 void displayClearRows(int16_t startRow, int16_t endRow, bool isInverted)
@@ -371,6 +545,7 @@ void displayClearRows(int16_t startRow, int16_t endRow, bool isInverted)
 	// memset would be faster than ucFillRect
 	//ucFillRect(0, (startRow * 8), 128, (8 * (endRow - startRow)), true);
     memset(screenBuf + (DISPLAY_SIZE_X * startRow), (isInverted ? 0xFF : 0x00), (DISPLAY_SIZE_X * (endRow - startRow)));
+	displayMarkDirty(0, (startRow * 8), DISPLAY_SIZE_X, ((endRow - startRow) * 8));
 }
 
 void displayPrintCentered(uint16_t y, const char *text, ucFont_t fontSize)
@@ -1063,6 +1238,8 @@ void displayFillRect(int16_t x, int16_t y, int16_t width, int16_t height, bool i
 	uint8_t bitPatten;
 	int16_t shiftNum;
 
+	displayMarkDirty(x, y, width, height);
+
 	if (startRow == endRow)
 	{
 		addPtr = screenBuf + (startRow * DISPLAY_SIZE_X);
@@ -1282,11 +1459,15 @@ void displayDrawChoice(ucChoice_t choice, bool clearRegion)
 	displayThemeResetToDefault();
 }
 
+// The caller may write straight into the buffer, so the whole screen can't be trusted anymore
 uint8_t *displayGetScreenBuffer(void)
 {
+	displayMarkAllDirty();
 	return screenBuf;
 }
 
+// The LCD keeps showing what was rendered from the override buffer, and the dirty spans stay those of
+// the primary buffer: drawing over the overridden area again is the caller's job (see uiNotificationHide())
 void displayRestorePrimaryScreenBuffer(void)
 {
 	screenBuf = screenBufData;
@@ -1297,6 +1478,7 @@ uint8_t *displayGetPrimaryScreenBuffer(void)
 	return &screenBufData[0];
 }
 
+// The buffer must start as a copy of the primary one, so that its pending dirty spans still apply
 void displayOverrideScreenBuffer(uint8_t *buffer)
 {
 	screenBuf = buffer;
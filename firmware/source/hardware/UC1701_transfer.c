@@ -30,6 +30,7 @@
 #include "hardware/UC1701.h"
 #include "functions/settings.h"
 #include "interfaces/gpio.h"
+#include "interfaces/wdog.h"
 #include "user_interface/menuSystem.h"
 
 /*
@@ -47,6 +48,13 @@ static void UC1701_setDataMode(void);
 static bool isAwake = true;
 static bool isInverted = false;
 
+// Note there are 4 pixels at the left which are no in the hardware of the LCD panel, but are in the RAM buffer of the controller
+#if defined(PLATFORM_RD5R)
+#define DISPLAY_CONTROLLER_X_OFFSET  0
+#else
+#define DISPLAY_CONTROLLER_X_OFFSET  4
+#endif
+
 static void UC1701_setCommandMode(void)
 {
 	GPIO_Display_RS->PCOR = 1U << Pin_Display_RS;// set the command / data pin low to signify Command mode
@@ -58,74 +66,67 @@ static void UC1701_setDataMode(void)
 }
 #endif // ! PLATFORM_GD77S
 
-void displayRenderRows(int16_t startRow, int16_t endRow)
+void displayTransferRows(const uint8_t *buffer, int16_t startRow, int16_t endRow, const uint8_t *startColumns, const uint8_t *endColumns)
 {
 #if ! defined(PLATFORM_GD77S)
-	taskENTER_CRITICAL();
-	uint8_t *rowPos = (displayGetScreenBuffer() + startRow * DISPLAY_SIZE_X);
-
+	// Only the display is driven from the main task, hence only the page addressing needs
+	// to be atomic, the column data is streamed with the interrupts enabled.
 	GPIO_PinWrite(GPIO_Display_CS, Pin_Display_CS, 0);// Enable CS
 
 	for(int16_t row = startRow; row < endRow; row++)
 	{
-		UC1701_setCommandMode();
-		UC1701_transfer(0xb0 | row); // set Y
-		UC1701_transfer(0x10 | 0); // set X (high MSB)
+		int16_t startColumn = (startColumns ? startColumns[row] : 0);
+		int16_t endColumn = (endColumns ? endColumns[row] : DISPLAY_SIZE_X);
 
-		// Note there are 4 pixels at the left which are no in the hardware of the LCD panel, but are in the RAM buffer of the controller
-#if !defined(PLATFORM_RD5R)
-		UC1701_transfer(0x00 | 4); // set X (low MSB).
-#endif
-
-		UC1701_setDataMode();
-		uint8_t data1;
-		for(int16_t line = 0; line < DISPLAY_SIZE_X; line++)
+		if (startColumn >= endColumn)
 		{
-			data1 = *rowPos;
-			for (register int i = 0; i < 8; i++)
-			{
-				GPIO_Display_SCK->PCOR = 1U << Pin_Display_SCK;
+			continue; // This page is already in sync with the LCD
+		}
 
-				if ((data1 & 0x80) == 0U)
-				{
-					GPIO_Display_SDA->PCOR = 1U << Pin_Display_SDA;// Hopefully the compiler will optimise this to a value rather than using a shift
-				}
-				else
-				{
-					GPIO_Display_SDA->PSOR = 1U << Pin_Display_SDA;// Hopefully the compiler will optimise this to a value rather than using a shift
-				}
+		const uint8_t *rowPos = (buffer + (row * DISPLAY_SIZE_X) + startColumn);
+		const uint8_t *rowEnd = (buffer + (row * DISPLAY_SIZE_X) + endColumn);
+		uint8_t controllerColumn = (startColumn + DISPLAY_CONTROLLER_X_OFFSET);
 
-				GPIO_Display_SCK->PSOR = 1U << Pin_Display_SCK;// Hopefully the compiler will optimise this to a value rather than using a shift
+		taskENTER_CRITICAL();
+		PROFILER_ENTER(PROFILER_SITE_DISPLAY_TRANSFER);
+		UC1701_setCommandMode();
+		UC1701_transfer(0xb0 | row); // set Y
+		UC1701_transfer(0x10 | (controllerColumn >> 4)); // set X (high MSB)
+		UC1701_transfer(0x00 | (controllerColumn & 0x0F)); // set X (low MSB).
+		UC1701_setDataMode();
+		PROFILER_EXIT(PROFILER_SITE_DISPLAY_TRANSFER);
+		taskEXIT_CRITICAL();
 
-				data1 = data1 << 1;
-			}
-			rowPos++;
+		while (rowPos < rowEnd)
+		{
+			UC1701_transfer(*rowPos++);
 		}
 	}
 
 	GPIO_PinWrite(GPIO_Display_CS, Pin_Display_CS, 1);// Disable CS
-	taskEXIT_CRITICAL();
 #endif // ! PLATFORM_GD77S
 }
+
 #if ! defined(PLATFORM_GD77S)
+// PSOR and PCOR are adjacent in GPIO_Type, so the data bit selects the register SDA is written to, without any branch.
+#define UC1701_SEND_BIT(data, bit) \
+	do { \
+		GPIO_Display_SCK->PCOR = 1U << Pin_Display_SCK; \
+		(&GPIO_Display_SDA->PSOR)[(((data) >> (bit)) & 0x01) ^ 0x01] = 1U << Pin_Display_SDA; \
+		GPIO_Display_SCK->PSOR = 1U << Pin_Display_SCK; \
+	} while(0)
+
 static void UC1701_transfer(register uint8_t data1)
 {
-	for (register int i = 0; i < 8; i++)
-	{
-		GPIO_Display_SCK->PCOR = 1U << Pin_Display_SCK;
-
-		if ((data1 & 0x80) == 0U)
-		{
-			GPIO_Display_SDA->PCOR = 1U << Pin_Display_SDA;// Hopefully the compiler will otimise this to a value rather than using a shift
-		}
-		else
-		{
-			GPIO_Display_SDA->PSOR = 1U << Pin_Display_SDA;// Hopefully the compiler will otimise this to a value rather than using a shift
-		}
-		GPIO_Display_SCK->PSOR = 1U << Pin_Display_SCK;// Hopefully the compiler will otimise this to a value rather than using a shift
-
-		data1 = data1 << 1;
-	}
+	// MSB first
+	UC1701_SEND_BIT(data1, 7);
+	UC1701_SEND_BIT(data1, 6);
+	UC1701_SEND_BIT(data1, 5);
+	UC1701_SEND_BIT(data1, 4);
+	UC1701_SEND_BIT(data1, 3);
+	UC1701_SEND_BIT(data1, 2);
+	UC1701_SEND_BIT(data1, 1);
+	UC1701_SEND_BIT(data1, 0);
 }
 #endif // ! PLATFORM_GD77S
 
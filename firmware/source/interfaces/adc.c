@@ -104,6 +104,7 @@ void approxRollingAverage (unsigned int newSample)
 
 void ADC0_IRQHandler(void)
 {
+	PROFILER_ENTER(PROFILER_SITE_ADC0_IRQ);
 	uint32_t result = ADC16_GetChannelConversionValue(ADC0, 0);
 
     switch (adc_channel)
@@ -122,6 +123,8 @@ void ADC0_IRQHandler(void)
     	break;
     }
 
+	PROFILER_EXIT(PROFILER_SITE_ADC0_IRQ);
+
     /* Add for ARM errata 838869, affects Cortex-M4, Cortex-M4F Store immediate overlapping
     exception return operation might vector to incorrect interrupt */
     __DSB();
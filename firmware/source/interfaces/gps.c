@@ -29,6 +29,7 @@
 #include "user_interface/uiGlobals.h"
 #include "user_interface/uiUtilities.h"
 #include "interfaces/gps.h"
+#include "functions/nmea.h"
 #include "user_interface/uiLocalisation.h"
 #include "usb/usb_com.h"
 #if defined(PLATFORM_MD9600)
@@ -38,6 +39,7 @@
 #if defined(HAS_GPS)
 
 #define GPS_RX_BUFFERS_MAX                  3U
+#define GPS_DATA_INPUT_CHECK_PERIOD        500U
 
 #if defined(LOG_GPS_DATA)
 #define LOG_RAM_BUF_SIZE                 4096U
@@ -65,17 +67,19 @@ static bool gpsIsLogging = false;
 
 typedef struct
 {
-	uint8_t data[GPS_LINE_LENGTH];
-	uint8_t length;
-} gpsReceiveBuffer_t;
+	nmeaSentence_t sentences[GPS_RX_BUFFERS_MAX];
+	nmeaParser_t   parser;
+	uint8_t        linesCount;
+	uint8_t        bufferIndex;
+} gpsReceiveData_t;
+
+typedef void (*gpsSentenceHandler_t)(const nmeaSentence_t *sentence);
 
 typedef struct
 {
-	gpsReceiveBuffer_t rxBuffers[GPS_RX_BUFFERS_MAX];
-	uint8_t linesCount;
-	uint8_t bufferIndex;
-	uint8_t charPosition;
-} gpsReceiveData_t;
+	char                 type[4];
+	gpsSentenceHandler_t handler;
+} gpsSentenceType_t;
 
 gpsData_t gpsData =
 {
@@ -102,6 +106,7 @@ static gpsReceiveData_t gpsRxData;
 
 
 static uint8_t gpsBufferIndexProcessing = 0U;
+static ticksTimer_t gpsDataInputCheckTimer = { 0, 0 };
 #if defined(STM32F405xx)
 static uint8_t gpsDMABuf[GPS_DMA_BUFFER_SIZE]; // double buffer (two halves) for GPS UART DMA receive
 #endif
@@ -118,28 +123,28 @@ static uint8_t gpsFixGraceCount = 0U;
 #if USE_CHECKSUM
 static uint16_t gpsLineChecksum = 0xDEAD;
 #else
-static char gpsLastLine[GPS_LINE_LENGTH];
+static char gpsLastLine[NMEA_LINE_LENGTH];
 #endif
 
 //#define USE_DUMMY_GPS_DATA
 #ifdef USE_DUMMY_GPS_DATA
 const char *DUMMY_GPS_DATA[] = {
 		"$GNZDA,074101.000,20,09,2022,,*42",
-		"$GNGGA,074102.000,3858.1,N,14602.1,E,1,03,4.38,51.4,M,-1.5,M,,*4F",
+		"$GNGGA,074102.000,3858.1,N,14602.1,E,1,03,4.38,51.4,M,-1.5,M,,*50",
 		"$GPGSA,A,2,29,25,12,,,,,,,,,,4.49,4.38,1.00,1*16",
 		"$BDGSA,A,2,,,,,,,,,,,,,4.49,4.38,1.00,4*0D",
 		"$GPGSV,2,1,07,29,63,203,24,2,62,148,,25,61,339,24,20,33,129,*48",
 		"$GPGSV,2,2,07,12,32,18,25,26,7,220,,23,1,340,*76",
 		"$BDGSV,1,1,04,1,47,0,,4,44,22,,3,34,313,,2,12,289,*5D",
-		"$GNRMC,074102.000,A,3758.10000,N,14502.10000,E,5.000,275.00,200922,,,A*53",
+		"$GNRMC,074102.000,A,3758.10000,N,14502.10000,E,5.000,275.00,200922,,,A*45",
 		"$GNZDA,074101.000,20,09,2022,,*42",
-		"$GNGGA,074102.000,3858.10000,S,14502.10000,E,1,03,4.38,51.4,M,-1.5,M,,*4F",
+		"$GNGGA,074102.000,3858.10000,S,14502.10000,E,1,03,4.38,51.4,M,-1.5,M,,*4E",
 		"$GPGSA,A,2,29,25,12,,,,,,,,,,4.49,4.38,1.00,1*16",
 		"$BDGSA,A,2,,,,,,,,,,,,,4.49,4.38,1.00,4*0D",
 		"$GPGSV,2,1,07,29,63,203,24,2,62,148,,25,61,339,24,20,33,129,*48",
 		"$GPGSV,2,2,07,12,32,18,25,26,7,220,,23,1,340,*76",
 		"$BDGSV,1,1,04,1,47,0,,4,44,22,,3,34,313,,2,12,289,*5D",
-		"$GNRMC,074102.000,A,3758.00000,N,14502.00000,E,5.000,275.00,200922,,,A*53"
+		"$GNRMC,074102.000,A,3758.00000,N,14502.00000,E,5.000,275.00,200922,,,A*45"
 };
 int32_t dummyGpsDataIndex = 0;
 #endif
@@ -148,13 +153,23 @@ int32_t dummyGpsDataIndex = 0;
 #include "fsl_uart.h"
 
 static bool gpsIrqIsEnabled = false;
-
-extern double round(double); // implementation in aprs.c
 #endif
 
 #if defined(LOG_GPS_DATA)
 static void gpsLogNMEAData(const char *nmea, uint8_t length);
 #endif
+static void gpsProcessGGA(const nmeaSentence_t *sentence);
+static void gpsProcessRMC(const nmeaSentence_t *sentence);
+static void gpsProcessGSA(const nmeaSentence_t *sentence);
+static void gpsProcessGSV(const nmeaSentence_t *sentence);
+
+static const gpsSentenceType_t GPS_SENTENCE_TYPES[] =
+{
+		{ "GGA", gpsProcessGGA }, // accuracy (HDOP) and altitude
+		{ "RMC", gpsProcessRMC }, // time, position, speed and course
+		{ "GSA", gpsProcessGSA }, // DOP and active satellites
+		{ "GSV", gpsProcessGSV }  // satellites in view
+};
 
 
 void gpsInit(void)
@@ -228,23 +243,50 @@ void UART0_RX_TX_IRQHandler (void)
 }
 #endif
 
-// Converts the GPS data from the format DDDmm.mmmm into our custom format Int<<23 + frac*1000
-static uint32_t gpsLatLongConvert(const char *input, double *dValue)
+static int32_t gpsGetFieldFixedPointOrZero(const nmeaSentence_t *sentence, uint8_t field, uint8_t decimals)
 {
-	double value = strtod(input, NULL);
-	double degrees = (int32_t)(value * 1E-2); // get degrees
+	int32_t value;
+
+	return (nmeaGetFieldFixedPoint(sentence, field, decimals, &value) ? value : 0);
+}
+
+// Integer field, or -1 if empty
+static int gpsGetFieldInt(const nmeaSentence_t *sentence, uint8_t field)
+{
+	int32_t value;
+
+	return (nmeaGetFieldFixedPoint(sentence, field, 0U, &value) ? value : -1);
+}
+
+// Converts the GPS data from the format DDDmm.mmmmm into our custom format Int<<23 + frac*1000
+static uint32_t gpsLatLongConvert(const nmeaSentence_t *sentence, uint8_t field, double *dValue)
+{
+	int32_t value = gpsGetFieldFixedPointOrZero(sentence, field, 5U); // DDDmm.mmmmm * 1E5
+
+	if (value < 0)
+	{
+		value = 0;
+	}
 
-	value -= (degrees * 1E2);
-	degrees += (value / 60.0);
+	uint32_t degrees = ((uint32_t)value / 10000000U);
+	uint32_t minutes = ((uint32_t)value % 10000000U); // mm.mmmmm * 1E5
 
-	*dValue = degrees;
+	*dValue = (degrees + (minutes / 6E6));
 
-	return ((((uint32_t)degrees) << 23) + ((uint32_t)(round(((degrees - (uint32_t)degrees) * 1E5)))));
+	// Degree fraction * 1E5, rounded
+	return ((degrees << 23) + ((minutes + 30U) / 60U));
 }
 
-static time_t_custom gpsTimeConvert(const char *time, const char *date)
+static uint8_t gpsGetTwoDigits(const char *str)
+{
+	return (((str[0] - '0') * 10) + (str[1] - '0'));
+}
+
+static time_t_custom gpsTimeConvert(const nmeaSentence_t *sentence, uint8_t timeField, uint8_t dateField)
 {
 	struct tm gpsDateTime;
+	const char *time = nmeaGetField(sentence, timeField);
+	const char *date = nmeaGetField(sentence, dateField);
 	uint8_t Date;
 	uint8_t Month;
 	uint8_t Year;
@@ -252,11 +294,11 @@ static time_t_custom gpsTimeConvert(const char *time, const char *date)
 	uint8_t Minutes;
 	uint8_t Seconds;
 
-	if (strlen(date) == 6)
+	if (nmeaGetFieldLength(sentence, dateField) == 6)
 	{
-		Year = ((date[4] - '0') * 10) + (date[5] - '0');
-		Month = ((date[2] - '0') * 10) + (date[3] - '0');
-		Date = ((date[0] - '0') * 10) + (date[1] - '0');
+		Year = gpsGetTwoDigits(&date[4]);
+		Month = gpsGetTwoDigits(&date[2]);
+		Date = gpsGetTwoDigits(&date[0]);
 	}
 	else
 	{
@@ -270,11 +312,11 @@ static time_t_custom gpsTimeConvert(const char *time, const char *date)
 		Year = Year + 100;
 	}
 
-	if (strlen(time) >= 6)
+	if (nmeaGetFieldLength(sentence, timeField) >= 6)
 	{
-		Seconds = ((time[4] - '0') * 10) + (time[5] - '0');
-		Minutes = ((time[2] - '0') * 10) + (time[3] - '0');
-		Hours = ((time[0] - '0') * 10) + (time[1] - '0');
+		Seconds = gpsGetTwoDigits(&time[4]);
+		Minutes = gpsGetTwoDigits(&time[2]);
+		Hours = gpsGetTwoDigits(&time[0]);
 	}
 	else
 	{
@@ -294,60 +336,22 @@ static time_t_custom gpsTimeConvert(const char *time, const char *date)
 	return mktime_custom(&gpsDateTime);
 }
 
-static void getParam(const char *line, char *result, int entryno, int reslen)
-{
-	int count = 0;
-	int respoint = 0;
-
-	for (size_t i = 0; i < strlen(line); i++)
-	{
-		if (line[i] == ',')
-		{
-			count++;
-			if (count == entryno)
-			{
-				result[respoint] = 0;
-				return;
-			}
-			else
-			{
-				respoint = 0;
-			}
-		}
-		else
-		{
-			result[respoint++] = line[i];
-			if (respoint > (reslen - 1))
-			{
-				result[0] = 0;
-				return;
-			}
-		}
-	}
-
-	result[0] = 0;
-}
-
 #if !(defined(PLATFORM_MD9600) || defined(CPU_MK22FN512VLL12))
 static
 #endif
 void gpsProcessChar(uint8_t rxchar)
 {
-	if ((rxchar != '\r') && (gpsRxData.charPosition < GPS_LINE_LENGTH))
+	// No free buffer, the sentence is dropped
+	if ((rxchar == '$') && (gpsRxData.linesCount >= GPS_RX_BUFFERS_MAX))
 	{
-		if (rxchar >= '!') // Ignore '\n'
-		{
-			gpsRxData.rxBuffers[gpsRxData.bufferIndex].data[gpsRxData.charPosition++] = rxchar;
-		}
+		nmeaParserReset((nmeaParser_t *)&gpsRxData.parser);
+		return;
 	}
-	else
+
+	if (nmeaParserProcessChar((nmeaParser_t *)&gpsRxData.parser, (nmeaSentence_t *)&gpsRxData.sentences[gpsRxData.bufferIndex], rxchar))
 	{
-		gpsRxData.rxBuffers[gpsRxData.bufferIndex].data[gpsRxData.charPosition] = 0;
-		gpsRxData.rxBuffers[gpsRxData.bufferIndex].length = gpsRxData.charPosition;
 		gpsRxData.linesCount++;
 		gpsRxData.bufferIndex = (gpsRxData.bufferIndex + 1) % GPS_RX_BUFFERS_MAX;
-		gpsRxData.rxBuffers[gpsRxData.bufferIndex].length = 0U;
-		gpsRxData.charPosition = 0U;
 	}
 }
 
@@ -579,52 +583,10 @@ void gpsPower(bool on)
 #endif // STM32F405xx
 }
 
-static bool jumpToNextField(char **pField, uint8_t *curLength)
-{
-	// Searching end of the current field.
-	while (**pField != '\0' && (*curLength > 0))
-	{
-		(*pField)++;
-		(*curLength)--;
-	}
-
-	// Another field exists, position *pField on it.
-	if (*curLength > 0)
-	{
-		(*pField)++;
-		(*curLength)--;
-
-		return true;
-	}
-
-	return false;
-}
-
-static void convertCommasToDelimiters(char *line, uint8_t len)
-{
-	for (uint8_t i = 0; i < len ; i++)
-	{
-		if ((line[i] == ',') || (line[i] == '*'))
-		{
-			line[i] = '\0';
-		}
-	}
-}
-
-static int getNmeaInt(const char *str)
-{
-	if (*str != '\0')
-	{
-		return atoi(str);
-	}
-
-	return -1;
-}
-
 #if defined(GNSS_MULTI_GSV)
-static bool populateSatelliteData(char **NMEA, uint8_t *curLength, gpsSatellitesData_t *sat, uint8_t *counter, bool *isDifferent, int8_t sub)
+static void gpsPopulateSatelliteData(const nmeaSentence_t *sentence, uint8_t field, gpsSatellitesData_t *sat, bool *isDifferent, int8_t sub)
 #else
-static bool populateSatelliteData(char **NMEA, uint8_t *curLength, gpsSatellitesData_t *sat, uint8_t *counter, bool *isDifferent)
+static void gpsPopulateSatelliteData(const nmeaSentence_t *sentence, uint8_t field, gpsSatellitesData_t *sat, bool *isDifferent)
 #endif
 {
 	gpsSatellitesData_t pSat;
@@ -632,130 +594,320 @@ static bool populateSatelliteData(char **NMEA, uint8_t *curLength, gpsSatellites
 
 	memcpy(&pSat, sat, sizeof(gpsSatellitesData_t));
 
-	prn = getNmeaInt(*NMEA);
+	prn = gpsGetFieldInt(sentence, field);
 	sat->Number =
 #if defined(GNSS_MULTI_GSV)
 			((sub && (prn > sub)) ? (prn - sub) : prn);
 #else
 			prn;
 #endif
-	jumpToNextField(NMEA, curLength);
-
-	sat->El = getNmeaInt(*NMEA);
-	jumpToNextField(NMEA, curLength);
-
-	sat->Az = getNmeaInt(*NMEA);
-	jumpToNextField(NMEA, curLength);
-
-	sat->RSSI = getNmeaInt(*NMEA);
-
-	(*counter)++;
+	sat->El = gpsGetFieldInt(sentence, (field + 1));
+	sat->Az = gpsGetFieldInt(sentence, (field + 2));
+	sat->RSSI = gpsGetFieldInt(sentence, (field + 3));
 
 	*isDifferent = (memcmp(&pSat, sat, sizeof(gpsSatellitesData_t)) != 0);
-
-	return ((*counter < GPS_STORAGE_MAX) && jumpToNextField(NMEA, curLength));
 }
 
 #if defined(GNSS_MULTI_GSV)
-static uint16_t processGSV(char *line, uint8_t lineLength, gpsSatellitesData_t *satsStorage, uint8_t *counter, bool *satsAreDifferents, int8_t sub)
+static uint16_t gpsProcessGSVSatellites(const nmeaSentence_t *sentence, gpsSatellitesData_t *satsStorage, uint8_t *counter, bool *satsAreDifferents, int8_t sub)
 #else
-static uint16_t processGSV(char *line, uint8_t lineLength, gpsSatellitesData_t *satsStorage, uint8_t *counter, bool *satsAreDifferents)
+static uint16_t gpsProcessGSVSatellites(const nmeaSentence_t *sentence, gpsSatellitesData_t *satsStorage, uint8_t *counter, bool *satsAreDifferents)
 #endif
 {
-	uint16_t totalSatsInView = 0;
+	// Fields: 1 total messages, 2 message number, 3 satellites in view, then 4 fields (PRN, El, Az, SNR) per satellite.
+	// NMEA 4.1+ appends a signal ID field, which is ignored as it doesn't fill a whole satellite group.
+	if (gpsGetFieldInt(sentence, 2) == 1)
+	{
+		// Reset storage counter
+		*counter = 0;
+	}
 
-	if (lineLength > 7)
+	for (uint8_t field = 4U; ((field + 4U) <= sentence->fieldsCount) && (*counter < GPS_STORAGE_MAX); field += 4U)
 	{
-		int msgNumber;
 		bool satIsDifferent;
-		char *pos = &line[7]; // skip message header
 
-		convertCommasToDelimiters(line, lineLength);
+#if defined(GNSS_MULTI_GSV)
+		gpsPopulateSatelliteData(sentence, field, (satsStorage + *counter), &satIsDifferent, sub);
+#else
+		gpsPopulateSatelliteData(sentence, field, (satsStorage + *counter), &satIsDifferent);
+#endif
+		(*counter)++;
+
+		*satsAreDifferents |= satIsDifferent;
+	}
+
+	return (uint16_t)gpsGetFieldFixedPointOrZero(sentence, 3, 0U);
+}
+
+// Accuracy (HDOP) and altitude
+static void gpsProcessGGA(const nmeaSentence_t *sentence)
+{
+	uint16_t hdop = (uint16_t)gpsGetFieldFixedPointOrZero(sentence, 8, 2U);
+	if (hdop != gpsData.AccuracyInCm)
+	{
+		gpsData.AccuracyInCm = hdop;
+		gpsData.Status |= (GPS_STATUS_HDOP_UPDATED | GPS_STATUS_HAS_HDOP);
+	}
 
-		lineLength -= 7; // take care of header skipping
+	int16_t height = (int16_t)gpsGetFieldFixedPointOrZero(sentence, 9, 0U);
+	if (height != gpsData.HeightInM)
+	{
+		gpsData.HeightInM = height;
+		gpsData.Status |= (GPS_STATUS_HEIGHT_UPDATED | GPS_STATUS_HAS_HEIGHT);
+	}
+}
 
-		// Skip total messages
-		jumpToNextField(&pos, &lineLength);
-		msgNumber = atoi(pos);
+// Speed or course, in hundredth. An empty field clears the value.
+static void gpsUpdateHundredthValue(const nmeaSentence_t *sentence, uint8_t field, uint16_t *value, uint32_t hasStatus, uint32_t updatedStatus)
+{
+	int32_t v;
 
-		if (msgNumber == 1)
+	if (nmeaGetFieldFixedPoint(sentence, field, 2U, &v)) // There is a value
+	{
+		if ((uint16_t)v != *value)
 		{
-			// Reset storage counter
-			*counter = 0;
+			*value = (uint16_t)v;
+			gpsData.Status |= (updatedStatus | hasStatus);
 		}
+	}
+	else if (gpsData.Status & hasStatus) // Value cleared
+	{
+		*value = 0U;
+		gpsData.Status &= ~hasStatus;
+		gpsData.Status |= updatedStatus;
+	}
+}
 
-		jumpToNextField(&pos, &lineLength);
-		totalSatsInView = atoi(pos);
+// Time, position, speed and course
+static void gpsProcessRMC(const nmeaSentence_t *sentence)
+{
+	int currentMenu = menuSystemGetCurrentMenuNumber();
 
-		jumpToNextField(&pos, &lineLength);
+#if defined(LOG_GPS_DATA)
+	if ((gpsData.Time % 60) != 0)
+	{
+		gpsLogNMEAData(sentence->line, sentence->length);
+	}
+#endif
+	// check if it has the date and time (hhmmss.sss and ddmmyy).
+	if ((nmeaGetFieldLength(sentence, 1) > 0U) && (nmeaGetFieldLength(sentence, 9) > 0U))
+	{
+		gpsData.Time = gpsTimeConvert(sentence, 1, 9);
 
-		while(*counter < GPS_STORAGE_MAX)
+		// Clock skew ?
+		if (((gpsData.Status & (GPS_STATUS_HAS_FIX | GPS_STATUS_3D_FIX)) == (GPS_STATUS_HAS_FIX | GPS_STATUS_3D_FIX)) &&
+				(abs(uiDataGlobal.dateTimeSecs - gpsData.Time) > 5))
 		{
-#if defined(GNSS_MULTI_GSV)
-			bool res = (populateSatelliteData(&pos, &lineLength, (satsStorage + *counter), counter, &satIsDifferent, sub) && (lineLength > 4));
-#else
-			bool res = (populateSatelliteData(&pos, &lineLength, (satsStorage + *counter), counter, &satIsDifferent) && (lineLength > 4));
+			uiSetUTCDateTimeInSecs(gpsData.Time);
+#if defined(STM32F405xx)
+			setRtc_custom(uiDataGlobal.dateTimeSecs);
 #endif
+			// Update Satellite screen (re-enter)
+			bool restartSatMenu = (currentMenu == MENU_SATELLITE);
+			if (restartSatMenu)
+			{
+				menuDataGlobal.currentItemIndex = 0; // will restart in prediction list
+				menuSystemPopPreviousMenu();
+				menuSatelliteSetFullReload();
+			}
 
-			*satsAreDifferents |= satIsDifferent;
+			menuSatelliteScreenClearPredictions(false);
 
-			if (!res) // we have to stop the parsing here
+			if (restartSatMenu)
 			{
-				break;
+				menuSystemPushNewMenu(MENU_SATELLITE);
 			}
+		}
 
+		gpsData.Status |= (GPS_STATUS_TIME_UPDATED | GPS_STATUS_HAS_TIME);
+	}
+
+	// Have a fix
+	//
+	if (*nmeaGetField(sentence, 2) == 'A')
+	{
+		gpsFixGraceCount = GPS_FIX_GRACE_MAX;
+
+		if ((gpsData.Status & GPS_STATUS_HAS_FIX) == 0)
+		{
+			gpsData.Status |= (GPS_STATUS_HAS_FIX | GPS_STATUS_FIX_UPDATED);
 		}
 	}
+	else // Have no fix
+	{
+		if (gpsFixGraceCount > 0U)
+		{
+			gpsFixGraceCount--;
+		}
+		else
+		{
+			// Clear fix type status
+			if (gpsData.Status & (GPS_STATUS_2D_FIX | GPS_STATUS_3D_FIX))
+			{
+				gpsData.Status &= ~(GPS_STATUS_2D_FIX | GPS_STATUS_3D_FIX);
+				gpsData.Status |= GPS_STATUS_FIXTYPE_UPDATED;
+			}
+
+			// Loosing fix status
+			if (gpsData.Status & GPS_STATUS_HAS_FIX)
+			{
+				gpsData.Status &= ~(GPS_STATUS_HAS_FIX | GPS_STATUS_HAS_POSITION | GPS_STATUS_HAS_HDOP | GPS_STATUS_HAS_COURSE | GPS_STATUS_HAS_SPEED | GPS_STATUS_HAS_HEIGHT | GPS_STATUS_HAS_TIME);
+				gpsData.Status |= GPS_STATUS_FIX_UPDATED;
+			}
+		}
+
+		return;
+	}
+
+	// Latitude as ddmm.mmmmm, N/S, Longitude as dddmm.mmmmm, E/W
+	gpsData.Latitude = gpsLatLongConvert(sentence, 3, &gpsData.LatitudeHiRes);
+
+	if (*nmeaGetField(sentence, 4) == 'S')
+	{
+		gpsData.Latitude = gpsData.Latitude | 0x80000000;
+		gpsData.LatitudeHiRes = -gpsData.LatitudeHiRes;
+	}
+
+	gpsData.Longitude = gpsLatLongConvert(sentence, 5, &gpsData.LongitudeHiRes);
+
+	if (*nmeaGetField(sentence, 6) == 'W')
+	{
+		gpsData.Longitude = gpsData.Longitude | 0x80000000;
+		gpsData.LongitudeHiRes = -gpsData.LongitudeHiRes;
+	}
+
+	if (((currentMenu != UI_TX_SCREEN) && (currentMenu != MENU_SATELLITE)) &&
+			(nonVolatileSettings.locationLat != gpsData.Latitude || nonVolatileSettings.locationLon != gpsData.Longitude))
+	{
+		nonVolatileSettings.locationLat = gpsData.Latitude;
+		nonVolatileSettings.locationLon = gpsData.Longitude;
+
+		menuSatelliteScreenClearPredictions(false);
 
-	return totalSatsInView;
+		gpsData.Status |= (GPS_STATUS_POSITION_UPDATED | GPS_STATUS_HAS_POSITION);
+	}
+
+	gpsUpdateHundredthValue(sentence, 7, &gpsData.SpeedInHundredthKn, GPS_STATUS_HAS_SPEED, GPS_STATUS_SPEED_UPDATED);
+	gpsUpdateHundredthValue(sentence, 8, &gpsData.CourseInHundredthDeg, GPS_STATUS_HAS_COURSE, GPS_STATUS_COURSE_UPDATED);
 }
 
-#if USE_CHECKSUM
-// https://en.wikipedia.org/wiki/Fletcher%27s_checksum
-// Slightly modified, as length will never be > GPS_LINE_LENGTH
-static uint16_t fletcher16(const uint8_t *data, uint8_t len)
+// DOP and active satellites
+static void gpsProcessGSA(const nmeaSentence_t *sentence)
 {
-	uint32_t c0 = 0;
-	uint32_t c1 = 0;
+	char fixType = *nmeaGetField(sentence, 2);
 
-	do
+	if (*nmeaGetField(sentence, 1) == 'A') // Mode 'A' or 'M'
 	{
-		c0 = c0 + *data++;
-		c1 = c1 + c0;
-	} while (--len);
+		if (gpsData.Status & GPS_STATUS_HAS_FIX)
+		{
+			// We just got a 3D fix
+			if ((fixType == '3') && ((gpsData.Status & GPS_STATUS_3D_FIX) == 0))
+			{
+				gpsData.Status &= ~GPS_STATUS_2D_FIX;
+				gpsData.Status |= (GPS_STATUS_3D_FIX | GPS_STATUS_FIXTYPE_UPDATED);
+			} // We just got a 2D fix
+			else if ((fixType == '2') && ((gpsData.Status & GPS_STATUS_2D_FIX) == 0))
+			{
+				gpsData.Status &= ~GPS_STATUS_3D_FIX;
+				gpsData.Status |= (GPS_STATUS_2D_FIX | GPS_STATUS_FIXTYPE_UPDATED);
+			}
+		}
+	}
+	else
+	{
+		// Clear 2D and 3D fix, if any sets
+		if (gpsData.Status & (GPS_STATUS_2D_FIX | GPS_STATUS_3D_FIX))
+		{
+			gpsData.Status &= ~(GPS_STATUS_2D_FIX | GPS_STATUS_3D_FIX);
+			gpsData.Status |= GPS_STATUS_FIXTYPE_UPDATED;
+		}
+	}
+}
 
-	c0 = c0 % 255;
-	c1 = c1 % 255;
+// Satellites in view
+static void gpsProcessGSV(const nmeaSentence_t *sentence)
+{
+	const char          *talker = &sentence->line[1];
+	uint16_t            *pSatsInView = NULL;
+	gpsSatellitesData_t *pSats = NULL;
+	uint8_t             *pCurrentGPSIndex = NULL;
+	uint16_t             prevSatsInView = 0;
+	uint32_t             gpsStatus;
+#if defined(GNSS_MULTI_GSV)
+	int8_t               prnSub = 0;
+	bool                 gbSatSub = false;
+	bool                 glSatSub = false;
+#endif
 
-   return (c1 << 8 | c0);
-}
+	if ((talker[0] == 'G') && (talker[1] == 'P')) // GPS GSV
+	{
+		pSatsInView      = &gpsData.SatsInViewGP;
+		pSats            = &gpsData.GPSatellites[0];
+		pCurrentGPSIndex = &gpsData.currentGPSIndex;
+		gpsStatus        = GPS_STATUS_GPS_SATS_UPDATED;
+	}
+	else if((talker[0] == 'B') // (BD) BeiDou GSV`
+#if defined(GNSS_MULTI_GSV)
+			|| ((talker[0] == 'G') &&
+					((gbSatSub = (talker[1] == 'B'))  // (GB) BeiDou GSV (100 should be subtracted to the PRN number to determine the BeiDou PRN number)
+							|| (talker[1] == 'A') // (GA) Galileo GSV
+							|| ((glSatSub = (talker[1] == 'L'))) // (GL) GLONASS GSV (64 should be subtracted to the PRN number to determine the GLONASS PRN number)
+					)
+			)
 #endif
+	)
+	{
+		pSatsInView      = &gpsData.SatsInViewBD;
+		pSats            = &gpsData.BDSatellites[0];
+		pCurrentGPSIndex = &gpsData.currentBDIndex;
+		gpsStatus        = GPS_STATUS_BD_SATS_UPDATED;
+#if defined(GNSS_MULTI_GSV)
+		prnSub           = (gbSatSub ? 100 : (glSatSub ? 64 : 0));
+#endif
+	}
+
+	if (pSatsInView && pSats && pCurrentGPSIndex)
+	{
+		bool satsAreDifferents = false;
+
+		prevSatsInView = *pSatsInView;
+
+#if defined(GNSS_MULTI_GSV)
+		*pSatsInView = gpsProcessGSVSatellites(sentence, pSats, pCurrentGPSIndex, &satsAreDifferents, prnSub);
+#else
+		*pSatsInView = gpsProcessGSVSatellites(sentence, pSats, pCurrentGPSIndex, &satsAreDifferents);
+#endif
+		if ((*pSatsInView != prevSatsInView) || satsAreDifferents)
+		{
+			gpsData.Status |= gpsStatus;
+		}
+	}
+}
 
 void gpsTick(void)
 {
-	char gpsLine[GPS_LINE_LENGTH] = { 0 };
-	char param[6][20];
-	char line[20];
-	char *p;
-	uint8_t lineLength = 0U;
-
 	if ((menuSystemGetCurrentMenuNumber() != UI_TX_SCREEN) &&
 			(nonVolatileSettings.gps >= GPS_MODE_OFF) &&
-			((ticksGetMillis() % 500) == 0)
+			ticksTimerHasExpired(&gpsDataInputCheckTimer))
+	{
+		ticksTimerStart(&gpsDataInputCheckTimer, GPS_DATA_INPUT_CHECK_PERIOD);
+
 #if defined(STM32F405xx)
-			&& (HAL_DMA_GetState(&hdma_usart1_rx) != HAL_DMA_STATE_BUSY)
+		if (HAL_DMA_GetState(&hdma_usart1_rx) != HAL_DMA_STATE_BUSY)
 #elif defined(CPU_MK22FN512VLL12)
-			&& (gpsIrqIsEnabled == false)
+		if (gpsIrqIsEnabled == false)
 #endif
-	)
-	{
-		gpsDataInputStartStop(true);
+		{
+			gpsDataInputStartStop(true);
+		}
 	}
 
 	if (gpsRxData.linesCount > 0U)
 	{
-		lineLength = gpsRxData.rxBuffers[gpsBufferIndexProcessing].length;
-		memcpy(gpsLine, (uint8_t *)&gpsRxData.rxBuffers[gpsBufferIndexProcessing].data[0], (lineLength + 1));
+		nmeaSentence_t sentence;
+
+		// Already tokenized and checked by gpsProcessChar()
+		memcpy(&sentence, (nmeaSentence_t *)&gpsRxData.sentences[gpsBufferIndexProcessing], sizeof(nmeaSentence_t));
 		gpsRxData.linesCount--;
 		gpsBufferIndexProcessing = (gpsBufferIndexProcessing + 1) % GPS_RX_BUFFERS_MAX;
 
@@ -767,301 +919,51 @@ void gpsTick(void)
 		}
 
 #ifdef USE_DUMMY_GPS_DATA
-		strcpy(gpsLine, DUMMY_GPS_DATA[dummyGpsDataIndex % 16]);
+		nmeaParser_t dummyParser = { .state = NMEA_PARSER_STATE_WAIT_START };
+		const char *dummyLine = DUMMY_GPS_DATA[dummyGpsDataIndex % 16];
+
+		while (*dummyLine != 0)
+		{
+			nmeaParserProcessChar(&dummyParser, &sentence, *dummyLine++);
+		}
+		nmeaParserProcessChar(&dummyParser, &sentence, '\r');
 		dummyGpsDataIndex++;
 #endif
 
 #if USE_CHECKSUM
-		uint16_t checksum = fletcher16((const uint8_t *)gpsLine, lineLength);
-		if (checksum != gpsLineChecksum) // New line
+		if (sentence.hash != gpsLineChecksum) // New line
 		{
-			gpsLineChecksum = checksum; // Store new checksum
+			gpsLineChecksum = sentence.hash; // Store new checksum
 #else
-		if (memcmp(gpsLine, gpsLastLine, lineLength) != 0) // New line
+		if (memcmp(sentence.line, gpsLastLine, sentence.length) != 0) // New line
 		{
-			memcpy(gpsLastLine, gpsLine, GPS_LINE_LENGTH); // backup last gps line
+			memcpy(gpsLastLine, sentence.line, NMEA_LINE_LENGTH); // backup last gps line
 #endif
 
 			//gpsData.MessageCount++;
 
-			if (gpsLine[0] == '$')
+			if (nonVolatileSettings.gps >= GPS_MODE_ON_NMEA)
 			{
-				if (nonVolatileSettings.gps >= GPS_MODE_ON_NMEA)
-				{
-					USB_DEBUG_printf("%s\r\n", gpsLine);// Note. NMEA protocol requires CR LF
+				USB_DEBUG_printf("%s\r\n", sentence.line);// Note. NMEA protocol requires CR LF
 
 #if defined(LOG_GPS_DATA)
-					// log everything once per minute
-					if ((gpsData.Time % 60) == 0)
-					{
-						gpsLogNMEAData(gpsLine, lineLength);
-					}
-#endif
-				}
-
-				if (memcmp(&gpsLine[3], "GGA", 3) == 0)// message that contains accuracy (HDOP) and altitude
+				// log everything once per minute
+				if ((gpsData.Time % 60) == 0)
 				{
-					getParam(gpsLine, line, 9, 20);// get accuracy (HDOP)
-
-					uint16_t hdop = (uint16_t)((strtod(line, NULL)) * 1E2);
-					if (hdop != gpsData.AccuracyInCm)
-					{
-						gpsData.AccuracyInCm = hdop;
-						gpsData.Status |= (GPS_STATUS_HDOP_UPDATED | GPS_STATUS_HAS_HDOP);
-					}
-
-					getParam(gpsLine, line, 10, 20);// get height
-					p = strchr(line, '.');
-					if (p != NULL)
-					{
-						*p = '\0';
-					}
-
-					int16_t height = atoi(line);
-					if (height != gpsData.HeightInM)
-					{
-						gpsData.HeightInM = height;
-						gpsData.Status |= (GPS_STATUS_HEIGHT_UPDATED | GPS_STATUS_HAS_HEIGHT);
-					}
+					gpsLogNMEAData(sentence.line, sentence.length);
 				}
-				else if (memcmp(&gpsLine[3], "RMC", 3) == 0)			//is this the LAT Long and Time Message?
-				{
-					char statusLetter[20];
-					int currentMenu = menuSystemGetCurrentMenuNumber();
-
-#if defined(LOG_GPS_DATA)
-					if ((gpsData.Time % 60) != 0)
-					{
-						gpsLogNMEAData(gpsLine, lineLength);
-					}
-#endif
-					// check if it has the date and time.
-					getParam(gpsLine, param[0], 2, 20);			//get parameter 2 which is GMT Time as hhmmss.sss
-					getParam(gpsLine, statusLetter, 3, 20);
-					getParam(gpsLine, param[5], 10, 20);	    	//get parameter 10 which is Date as ddmmyy
-
-					if ((param[0][0] != 0) && (param[5][0] != 0))
-					{
-						gpsData.Time = gpsTimeConvert(param[0], param[5]);
-
-						// Clock skew ?
-						if (((gpsData.Status & (GPS_STATUS_HAS_FIX | GPS_STATUS_3D_FIX)) == (GPS_STATUS_HAS_FIX | GPS_STATUS_3D_FIX)) &&
-								(abs(uiDataGlobal.dateTimeSecs - gpsData.Time) > 5))
-						{
-							uiSetUTCDateTimeInSecs(gpsData.Time);
-#if defined(STM32F405xx)
-							setRtc_custom(uiDataGlobal.dateTimeSecs);
 #endif
-							// Update Satellite screen (re-enter)
-							bool restartSatMenu = (currentMenu == MENU_SATELLITE);
-							if (restartSatMenu)
-							{
-								menuDataGlobal.currentItemIndex = 0; // will restart in prediction list
-								menuSystemPopPreviousMenu();
-								menuSatelliteSetFullReload();
-							}
-
-							menuSatelliteScreenClearPredictions(false);
-
-							if (restartSatMenu)
-							{
-								menuSystemPushNewMenu(MENU_SATELLITE);
-							}
-						}
-
-						gpsData.Status |= (GPS_STATUS_TIME_UPDATED | GPS_STATUS_HAS_TIME);
-					}
-
-					// Have a fix
-					//
-					if (statusLetter[0] == 'A')
-					{
-						gpsFixGraceCount = GPS_FIX_GRACE_MAX;
-
-						if ((gpsData.Status & GPS_STATUS_HAS_FIX) == 0)
-						{
-							gpsData.Status |= (GPS_STATUS_HAS_FIX | GPS_STATUS_FIX_UPDATED);
-						}
-					}
-					else // Have no fix
-					{
-						if (gpsFixGraceCount > 0U)
-						{
-							gpsFixGraceCount--;
-						}
-						else
-						{
-							// Clear fix type status
-							if (gpsData.Status & (GPS_STATUS_2D_FIX | GPS_STATUS_3D_FIX))
-							{
-								gpsData.Status &= ~(GPS_STATUS_2D_FIX | GPS_STATUS_3D_FIX);
-								gpsData.Status |= GPS_STATUS_FIXTYPE_UPDATED;
-							}
-
-							// Loosing fix status
-							if (gpsData.Status & GPS_STATUS_HAS_FIX)
-							{
-								gpsData.Status &= ~(GPS_STATUS_HAS_FIX | GPS_STATUS_HAS_POSITION | GPS_STATUS_HAS_HDOP | GPS_STATUS_HAS_COURSE | GPS_STATUS_HAS_SPEED | GPS_STATUS_HAS_HEIGHT | GPS_STATUS_HAS_TIME);
-								gpsData.Status |= GPS_STATUS_FIX_UPDATED;
-							}
-						}
-
-						return;
-					}
-
-					getParam(gpsLine, param[1] , 4, 20);			//get parameter 4 which is Latitude a ddmm.mmmm
-					getParam(gpsLine, param[2] , 5, 20);			//get parameter 5 which is N/S
-					getParam(gpsLine, param[3] , 6, 20);			//get parameter 6 which is Longitude a dddmm.mmmm
-					getParam(gpsLine, param[4] , 7, 20);			//get parameter 7 which is E/W
-
-					gpsData.Latitude = gpsLatLongConvert(param[1], &gpsData.LatitudeHiRes);
-
-					if (param[2][0] == 'S')
-					{
-						gpsData.Latitude = gpsData.Latitude | 0x80000000;
-						gpsData.LatitudeHiRes = -gpsData.LatitudeHiRes;
-					}
-
-					gpsData.Longitude = gpsLatLongConvert(param[3], &gpsData.LongitudeHiRes);
-
-					if (param[4][0] == 'W')
-					{
-						gpsData.Longitude = gpsData.Longitude | 0x80000000;
-						gpsData.LongitudeHiRes = -gpsData.LongitudeHiRes;
-					}
-
-					if (((currentMenu != UI_TX_SCREEN) && (currentMenu != MENU_SATELLITE)) &&
-							(nonVolatileSettings.locationLat != gpsData.Latitude || nonVolatileSettings.locationLon != gpsData.Longitude))
-					{
-						nonVolatileSettings.locationLat = gpsData.Latitude;
-						nonVolatileSettings.locationLon = gpsData.Longitude;
-
-						menuSatelliteScreenClearPredictions(false);
-
-						gpsData.Status |= (GPS_STATUS_POSITION_UPDATED | GPS_STATUS_HAS_POSITION);
-					}
-
-					getParam(gpsLine, line, 8, 20);
-					if (strchr(line, '.') != NULL) // There is a value
-					{
-						uint16_t v = (uint16_t)((strtod(line, NULL)) * 1E2);
-						if (v != gpsData.SpeedInHundredthKn)
-						{
-							gpsData.SpeedInHundredthKn = v;
-							gpsData.Status |= (GPS_STATUS_SPEED_UPDATED | GPS_STATUS_HAS_SPEED);
-						}
-					}
-					else if (gpsData.Status & GPS_STATUS_HAS_SPEED) // Value cleared
-					{
-						gpsData.SpeedInHundredthKn = 0U;
-						gpsData.Status &= ~GPS_STATUS_HAS_SPEED;
-						gpsData.Status |= GPS_STATUS_SPEED_UPDATED;
-					}
+			}
 
-					getParam(gpsLine, line, 9, 20);
-					if (strchr(line, '.') != NULL) // There is a value
-					{
-						uint16_t v = (uint16_t)((strtod(line, NULL)) * 1E2);
-						if (v != gpsData.CourseInHundredthDeg)
-						{
-							gpsData.CourseInHundredthDeg = v;
-							gpsData.Status |= (GPS_STATUS_COURSE_UPDATED | GPS_STATUS_HAS_COURSE);
-						}
-					}
-					else if (gpsData.Status & GPS_STATUS_HAS_COURSE) // Value cleared
-					{
-						gpsData.CourseInHundredthDeg = 0U;
-						gpsData.Status &= ~GPS_STATUS_HAS_COURSE;
-						gpsData.Status |= GPS_STATUS_COURSE_UPDATED;
-					}
-				}
-				else if (memcmp(&gpsLine[3], "GSA", 3) == 0) // DOP and active satellites
+			// Dispatch on the sentence type ("$ttSSS"), the talker ID is checked by the handler, if needed.
+			if (sentence.isValid && (nmeaGetFieldLength(&sentence, 0) >= 5U))
+			{
+				for (uint8_t i = 0U; i < (sizeof(GPS_SENTENCE_TYPES) / sizeof(GPS_SENTENCE_TYPES[0])); i++)
 				{
-					getParam(gpsLine, param[0], 2, 20);	// get parameter 2 which is mode 'A' or 'M'
-					getParam(gpsLine, param[1], 3, 20);	// get parameter 3 which is Fix type
-
-					if (param[0][0] == 'A')
+					if (memcmp(&sentence.line[3], GPS_SENTENCE_TYPES[i].type, 3) == 0)
 					{
-						if (gpsData.Status & GPS_STATUS_HAS_FIX)
-						{
-							// We just got a 3D fix
-							if ((param[1][0] == '3') && ((gpsData.Status & GPS_STATUS_3D_FIX) == 0))
-							{
-								gpsData.Status &= ~GPS_STATUS_2D_FIX;
-								gpsData.Status |= (GPS_STATUS_3D_FIX | GPS_STATUS_FIXTYPE_UPDATED);
-							} // We just got a 2D fix
-							else if ((param[1][0] == '2') && ((gpsData.Status & GPS_STATUS_2D_FIX) == 0))
-							{
-								gpsData.Status &= ~GPS_STATUS_3D_FIX;
-								gpsData.Status |= (GPS_STATUS_2D_FIX | GPS_STATUS_FIXTYPE_UPDATED);
-							}
-						}
-					}
-					else
-					{
-						// Clear 2D and 3D fix, if any sets
-						if (gpsData.Status & (GPS_STATUS_2D_FIX | GPS_STATUS_3D_FIX))
-						{
-							gpsData.Status &= ~(GPS_STATUS_2D_FIX | GPS_STATUS_3D_FIX);
-							gpsData.Status |= GPS_STATUS_FIXTYPE_UPDATED;
-						}
-					}
-				}
-				else if (memcmp(&gpsLine[3], "GSV", 3) == 0)
-				{
-					uint16_t            *pSatsInView = NULL;
-					gpsSatellitesData_t *pSats = NULL;
-					uint8_t             *pCurrentGPSIndex = NULL;
-					uint16_t             prevSatsInView = 0;
-					uint32_t             gpsStatus;
-#if defined(GNSS_MULTI_GSV)
-					int8_t               prnSub = 0;
-					bool                 gbSatSub = false;
-					bool                 glSatSub = false;
-#endif
-
-					if ((gpsLine[1] == 'G') && (gpsLine[2] == 'P')) // GPS GSV
-					{
-						pSatsInView      = &gpsData.SatsInViewGP;
-						pSats            = &gpsData.GPSatellites[0];
-						pCurrentGPSIndex = &gpsData.currentGPSIndex;
-						gpsStatus        = GPS_STATUS_GPS_SATS_UPDATED;
-					}
-					else if((gpsLine[1] == 'B') // (BD) BeiDou GSV`
-#if defined(GNSS_MULTI_GSV)
-							|| ((gpsLine[1] == 'G') &&
-									((gbSatSub = (gpsLine[2] == 'B'))  // (GB) BeiDou GSV (100 should be subtracted to the PRN number to determine the BeiDou PRN number)
-											|| (gpsLine[2] == 'A') // (GA) Galileo GSV
-											|| ((glSatSub = (gpsLine[2] == 'L'))) // (GL) GLONASS GSV (64 should be subtracted to the PRN number to determine the GLONASS PRN number)
-									)
-							)
-#endif
-					)
-					{
-						pSatsInView      = &gpsData.SatsInViewBD;
-						pSats            = &gpsData.BDSatellites[0];
-						pCurrentGPSIndex = &gpsData.currentBDIndex;
-						gpsStatus        = GPS_STATUS_BD_SATS_UPDATED;
-#if defined(GNSS_MULTI_GSV)
-						prnSub           = (gbSatSub ? 100 : (glSatSub ? 64 : 0));
-#endif
-					}
-
-					if (pSatsInView && pSats && pCurrentGPSIndex)
-					{
-						bool satsAreDifferents = false;
-
-						prevSatsInView = *pSatsInView;
-
-#if defined(GNSS_MULTI_GSV)
-						*pSatsInView = processGSV(gpsLine, lineLength, pSats, pCurrentGPSIndex, &satsAreDifferents, prnSub);
-#else
-						*pSatsInView = processGSV(gpsLine, lineLength, pSats, pCurrentGPSIndex, &satsAreDifferents);
-#endif
-						if ((*pSatsInView != prevSatsInView) || satsAreDifferents)
-						{
-							gpsData.Status |= gpsStatus;
-						}
+						GPS_SENTENCE_TYPES[i].handler(&sentence);
+						break;
 					}
 				}
 			}
@@ -1112,7 +1014,7 @@ void gpsLoggingStart(void)
 #endif
 			// Load the last stored flash block
 			gpsLogMemOffset = nonVolatileSettings.gpsLogMemOffset;
-			SPI_Flash_read((((gpsLogFlashStartAddress + gpsLogMemOffset) / LOG_RAM_BUF_SIZE) * LOG_RAM_BUF_SIZE), NMEARecordingBuffer, LOG_RAM_BUF_SIZE);
+			SPI_Flash_readWithPriority((((gpsLogFlashStartAddress + gpsLogMemOffset) / LOG_RAM_BUF_SIZE) * LOG_RAM_BUF_SIZE), NMEARecordingBuffer, LOG_RAM_BUF_SIZE, SPI_FLASH_PRIORITY_BULK);
 			// write start marker that can be read as text
 			gpsLogByte('A');
 			gpsLogByte('A');
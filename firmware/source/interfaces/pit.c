@@ -29,9 +29,6 @@
 #include "interfaces/pit.h"
 #include "user_interface/uiGlobals.h"
 
-volatile uint32_t timer_maintask;
-volatile uint32_t timer_beeptask;
-volatile uint32_t timer_hrc6000task;
 volatile uint32_t timer_keypad;
 volatile uint32_t timer_keypad_timeout;
 volatile uint32_t PITCounter = 0;
@@ -41,9 +38,6 @@ volatile uint32_t timer_mbuttons[3];
 
 void pitInit(void)
 {
-	timer_maintask = 0;
-	timer_beeptask = 0;
-	timer_hrc6000task = 0;
 	timer_keypad = 0;
 	timer_keypad_timeout = 0;
 	timer_mbuttons[0] = timer_mbuttons[1] = timer_mbuttons[2] = 0;
@@ -62,6 +56,7 @@ void pitInit(void)
 
 void PIT0_IRQHandler(void)
 {
+	PROFILER_ENTER(PROFILER_SITE_PIT0_IRQ);
 	PITCounter++;// is unsigned so will wrap around
 	PIT2SecondsCounter++;
 	if (PIT2SecondsCounter == 1000)
@@ -70,18 +65,6 @@ void PIT0_IRQHandler(void)
 		uiDataGlobal.dateTimeSecs++;
 	}
 
-	if (timer_maintask > 0)
-	{
-		timer_maintask--;
-	}
-	if (timer_beeptask > 0)
-	{
-		timer_beeptask--;
-	}
-	if (timer_hrc6000task > 0)
-	{
-		timer_hrc6000task--;
-	}
 
 	if (timer_keypad > 0)
 	{
@@ -110,5 +93,6 @@ void PIT0_IRQHandler(void)
 
     /* Clear interrupt flag.*/
     PIT_ClearStatusFlags(PIT, kPIT_Chnl_0, kPIT_TimerFlag);
+	PROFILER_EXIT(PROFILER_SITE_PIT0_IRQ);
     __DSB();
 }
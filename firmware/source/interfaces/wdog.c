@@ -26,6 +26,7 @@
  *
  */
 
+#include <string.h>
 #include "interfaces/wdog.h"
 #include "interfaces/pit.h"
 #include "functions/ticks.h"
@@ -38,12 +39,68 @@
 
 #define WDOG_WCT_INSTRUCITON_COUNT (256U)
 
+// The FreeRTOS run time counter counts units of (1 << RUN_TIME_COUNTER_SHIFT) CPU cycles
+#define RUN_TIME_COUNTER_SHIFT      7U
+#define TELEMETRY_MAX_TASKS         8U
+#define TELEMETRY_WAKEUPS_TASKS     3U
+#define STACK_OVERFLOW_RECORD_MAGIC 0x534F5652U // "SOVR"
+
+typedef struct
+{
+	uint32_t magic;
+	uint32_t count;
+	uint32_t time;// PITCounter when the last overflow was detected
+	char     taskName[configMAX_TASK_NAME_LEN];
+} stackOverflowRecord_t;
+
+// Telemetry snapshot sent to the CPS, all little endian (decoded by tools/telemetry, keep them in sync)
+typedef struct __attribute__((__packed__))
+{
+	char     name[configMAX_TASK_NAME_LEN];
+	uint32_t runTime;// in run time counter units
+	uint32_t stackHighWaterMark;// in bytes
+	uint8_t  taskNumber;
+	uint8_t  priority;
+	uint8_t  state;// eTaskState
+	uint8_t  reserved;
+} telemetryTask_t;
+
+typedef struct __attribute__((__packed__))
+{
+	uint32_t total;
+	uint32_t notified;
+} telemetryWakeups_t;
+
+typedef struct __attribute__((__packed__))
+{
+	uint32_t structVersion;
+	uint32_t coreClock;
+	uint32_t runTimeCounterShift;
+	uint32_t totalRunTime;
+	uint32_t uptime;// ms
+	uint32_t freeHeap;
+	uint32_t minimumEverFreeHeap;
+	uint32_t stackOverflowCount;// since power up (kept across resets)
+	uint32_t stackOverflowTime;
+	char     stackOverflowTaskName[configMAX_TASK_NAME_LEN];
+	telemetryWakeups_t wakeups[TELEMETRY_WAKEUPS_TASKS];// main, beep and hrc6000 tasks, since power up
+	uint32_t numberOfTasks;
+	telemetryTask_t tasks[];
+} telemetryHeader_t;
+
 volatile static bool runState = false;
 
 static WDOG_Type *wdog_base = WDOG;
 volatile static int watchdog_refresh_tick = 0;
 volatile static bool reboot = false;
 
+static uint32_t runTimeCounterLastCycles = 0;
+static uint32_t runTimeCounterCycles = 0;// cycles not yet accounted in runTimeCounter
+static uint32_t runTimeCounter = 0;
+
+// Not initialised by the startup code, hence survives a reset
+__attribute__((section(".noinit.$RAM2"))) static stackOverflowRecord_t stackOverflowRecord;
+
 void watchdogTick(void) // called each 1ms my PIT callback
 {
 	watchdog_refresh_tick++;
@@ -84,9 +141,10 @@ void watchdogReboot(void)
 	reboot = true;
 }
 
+// Never returns: NVIC_SystemReset() completes the pending memory accesses before requesting the reset (DSB), then waits for it
 void watchdogRebootNow(void)
 {
-	SCB->AIRCR = (0x5FA << SCB_AIRCR_VECTKEY_Pos) | SCB_AIRCR_SYSRESETREQ_Msk;
+	NVIC_SystemReset();
 }
 
 void watchdogRun(bool run)
@@ -115,6 +173,12 @@ void watchdogRun(bool run)
 
 void watchdogInit(void)
 {
+	if (stackOverflowRecord.magic != STACK_OVERFLOW_RECORD_MAGIC)
+	{
+		memset(&stackOverflowRecord, 0, sizeof(stackOverflowRecord));
+		stackOverflowRecord.magic = STACK_OVERFLOW_RECORD_MAGIC;
+	}
+
 	runState = false;
 	watchdogRun(true);
 }
@@ -138,3 +202,203 @@ uint32_t GetTimerOutputValue(void)
 {
 	return (uint32_t)((((uint32_t)wdog_base->TMROUTH) << 16U) | (wdog_base->TMROUTL));
 }
+
+// Called by the kernel when the scheduler starts
+void watchdogRunTimeCounterInit(void)
+{
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	runTimeCounterLastCycles = 0;
+	runTimeCounterCycles = 0;
+	runTimeCounter = 0;
+}
+
+// Called by the kernel on each context switch (or with the scheduler suspended), the 32 bits
+// cycle counter wraps after a few tens of seconds, hence it's scaled down and accumulated here.
+uint32_t watchdogGetRunTimeCounter(void)
+{
+	uint32_t cycles = DWT->CYCCNT;
+
+	runTimeCounterCycles += (cycles - runTimeCounterLastCycles);
+	runTimeCounterLastCycles = cycles;
+
+	runTimeCounter += (runTimeCounterCycles >> RUN_TIME_COUNTER_SHIFT);
+	runTimeCounterCycles &= ((1U << RUN_TIME_COUNTER_SHIFT) - 1);
+
+	return runTimeCounter;
+}
+
+void vApplicationStackOverflowHook(TaskHandle_t xTask, char *pcTaskName)
+{
+	UNUSED_PARAMETER(xTask);
+
+	stackOverflowRecord.count++;
+	stackOverflowRecord.time = PITCounter;
+	strncpy(stackOverflowRecord.taskName, pcTaskName, (configMAX_TASK_NAME_LEN - 1));
+	stackOverflowRecord.taskName[configMAX_TASK_NAME_LEN - 1] = 0;
+
+#if defined(USING_EXTERNAL_DEBUGGER)
+	SEGGER_RTT_printf(0, "Stack overflow in %s\n", stackOverflowRecord.taskName);
+#endif
+
+	// The memory around that stack is now corrupted, there is no safe way to carry on.
+	watchdogRebootNow();
+}
+
+// Called by the idle task when no other task is ready: sleep the core until the next interrupt
+// (at the latest the next PIT/SysTick millisecond). The cycle counter is stopped while sleeping,
+// so the time spent in WFI is measured with PIT0 and credited to the idle task.
+void vApplicationIdleHook(void)
+{
+	uint32_t coreToBusRatio = (CLOCK_GetCoreSysClkFreq() / CLOCK_GetBusClkFreq());
+	uint32_t reload = (PIT->CHANNEL[kPIT_Chnl_0].LDVAL + 1);
+	uint32_t before;
+	uint32_t after;
+
+	// Interrupts stay masked so that the ISR which wakes us up isn't accounted twice, WFI still wakes on any pending one
+	__disable_irq();
+	before = PIT->CHANNEL[kPIT_Chnl_0].CVAL;
+	__DSB();
+	__WFI();
+	after = PIT->CHANNEL[kPIT_Chnl_0].CVAL;
+
+	// PIT counts down, and has reloaded (at most once, it fires every millisecond) if the value went up
+	runTimeCounterCycles += (((after <= before) ? (before - after) : (before + (reload - after))) * coreToBusRatio);
+	__enable_irq();
+}
+
+static void telemetryGetWakeups(telemetryWakeups_t *wakeups, const Task_t *task)
+{
+	wakeups->total = task->Wakeups;
+	wakeups->notified = task->NotifiedWakeups;
+}
+
+// Fills the buffer with a telemetryHeader_t snapshot, and returns its length (0 if it doesn't fit)
+uint32_t watchdogGetTelemetry(uint8_t *buffer, uint32_t bufferSize)
+{
+	TaskStatus_t taskStatus[TELEMETRY_MAX_TASKS];
+	telemetryHeader_t header;
+	uint32_t totalRunTime;
+	UBaseType_t numberOfTasks = uxTaskGetSystemState(taskStatus, TELEMETRY_MAX_TASKS, &totalRunTime);
+	uint32_t length = sizeof(telemetryHeader_t) + (numberOfTasks * sizeof(telemetryTask_t));
+
+	if (length > bufferSize)
+	{
+		return 0;
+	}
+
+	header.structVersion = 0x02;
+	header.coreClock = SystemCoreClock;
+	header.runTimeCounterShift = RUN_TIME_COUNTER_SHIFT;
+	header.totalRunTime = totalRunTime;
+	header.uptime = PITCounter;
+	header.freeHeap = xPortGetFreeHeapSize();
+	header.minimumEverFreeHeap = xPortGetMinimumEverFreeHeapSize();
+	header.stackOverflowCount = stackOverflowRecord.count;
+	header.stackOverflowTime = stackOverflowRecord.time;
+	memcpy(header.stackOverflowTaskName, stackOverflowRecord.taskName, configMAX_TASK_NAME_LEN);
+	telemetryGetWakeups(&header.wakeups[0], &mainTask);
+	telemetryGetWakeups(&header.wakeups[1], &beepTask);
+	telemetryGetWakeups(&header.wakeups[2], &hrc6000Task);
+	header.numberOfTasks = numberOfTasks;
+	memcpy(buffer, &header, sizeof(telemetryHeader_t));
+
+	for (UBaseType_t i = 0; i < numberOfTasks; i++)
+	{
+		telemetryTask_t task;
+
+		memset(task.name, 0, sizeof(task.name));
+		strncpy(task.name, taskStatus[i].pcTaskName, (configMAX_TASK_NAME_LEN - 1));
+		task.runTime = taskStatus[i].ulRunTimeCounter;
+		task.stackHighWaterMark = taskStatus[i].usStackHighWaterMark * sizeof(StackType_t);
+		task.taskNumber = taskStatus[i].xTaskNumber;
+		task.priority = taskStatus[i].uxCurrentPriority;
+		task.state = taskStatus[i].eCurrentState;
+		task.reserved = 0;
+
+		memcpy(&buffer[sizeof(telemetryHeader_t) + (i * sizeof(telemetryTask_t))], &task, sizeof(telemetryTask_t));
+	}
+
+	return length;
+}
+
+#if defined(USING_LATENCY_PROFILER)
+// Histogram bucket 0: < (1 << PROFILER_BUCKET_SHIFT) cycles, bucket N: [1 << (PROFILER_BUCKET_SHIFT + N - 1), 1 << (PROFILER_BUCKET_SHIFT + N)) cycles,
+// the last bucket also gets everything longer.
+#define PROFILER_BUCKET_SHIFT       6U
+#define PROFILER_NUMBER_OF_BUCKETS  16U
+
+typedef struct __attribute__((__packed__))
+{
+	uint32_t count;
+	uint32_t maxCycles;
+	uint64_t totalCycles;
+	uint32_t buckets[PROFILER_NUMBER_OF_BUCKETS];
+} profilerSiteStats_t;
+
+// Dump sent to the CPS, all little endian, followed by numberOfSites profilerSiteStats_t (profilerSite_t order).
+// Analysed by tools/telemetry, keep them in sync.
+typedef struct __attribute__((__packed__))
+{
+	uint32_t structVersion;
+	uint32_t coreClock;
+	uint32_t numberOfSites;
+	uint32_t numberOfBuckets;
+	uint32_t bucketShift;
+} profilerHeader_t;
+
+static uint32_t profilerEnterCycles[PROFILER_SITE_MAX];
+static profilerSiteStats_t profilerStats[PROFILER_SITE_MAX];
+
+void profilerEnter(profilerSite_t site)
+{
+	profilerEnterCycles[site] = DWT->CYCCNT;
+}
+
+void profilerExit(profilerSite_t site)
+{
+	uint32_t cycles = (DWT->CYCCNT - profilerEnterCycles[site]);
+	uint32_t scaled = (cycles >> PROFILER_BUCKET_SHIFT);
+	uint32_t bucket = ((scaled == 0) ? 0 : (32U - __CLZ(scaled)));
+	profilerSiteStats_t *stats = &profilerStats[site];
+
+	stats->count++;
+	stats->totalCycles += cycles;
+	if (cycles > stats->maxCycles)
+	{
+		stats->maxCycles = cycles;
+	}
+	stats->buckets[((bucket < PROFILER_NUMBER_OF_BUCKETS) ? bucket : (PROFILER_NUMBER_OF_BUCKETS - 1))]++;
+}
+
+// Returns the dump length (0 if it doesn't fit)
+uint32_t profilerGetDump(uint8_t *buffer, uint32_t bufferSize, bool reset)
+{
+	profilerHeader_t header;
+	uint32_t length = sizeof(profilerHeader_t) + sizeof(profilerStats);
+
+	if (length > bufferSize)
+	{
+		return 0;
+	}
+
+	header.structVersion = 0x01;
+	header.coreClock = SystemCoreClock;
+	header.numberOfSites = PROFILER_SITE_MAX;
+	header.numberOfBuckets = PROFILER_NUMBER_OF_BUCKETS;
+	header.bucketShift = PROFILER_BUCKET_SHIFT;
+	memcpy(buffer, &header, sizeof(profilerHeader_t));
+
+	taskENTER_CRITICAL();
+	memcpy(&buffer[sizeof(profilerHeader_t)], profilerStats, sizeof(profilerStats));
+	if (reset)
+	{
+		memset(profilerStats, 0, sizeof(profilerStats));
+	}
+	taskEXIT_CRITICAL();
+
+	return length;
+}
+#endif
@@ -30,12 +30,13 @@
 
 #include "io/keyboard.h"
 #include "interfaces/pit.h"
+#include "functions/ticks.h"
 #include "functions/settings.h"
 #include "interfaces/gpio.h"
 
 static char oldKeyboardCode;
 static uint32_t keyDebounceScancode;
-static int keyDebounceCounter;
+static ticksTimer_t keyDebounceTimer;
 static uint8_t keyState;
 
 static char keypadAlphaKey;
@@ -122,7 +123,7 @@ void keyboardInit(void)
 
 	oldKeyboardCode = 0;
 	keyDebounceScancode = 0;
-	keyDebounceCounter = 0;
+	ticksTimerReset(&keyDebounceTimer);
 	keypadAlphaEnable = false;
 	keypadAlphaIndex = 0;
 	keypadAlphaKey = 0;
@@ -139,6 +140,12 @@ void keyboardReset(void)
 	keyState = KEY_WAIT_RELEASED;
 }
 
+// No key down nor being debounced, the keyboard doesn't need to be scanned every tick
+bool keyboardIsIdle(void)
+{
+	return (keyState == KEY_IDLE);
+}
+
 bool keyboardKeyIsDTMFKey(char key)
 {
 	switch (key)
@@ -250,7 +257,7 @@ void keyboardCheckKeyEvent(keyboardCode_t *keys, int *event)
 		if (scancode != 0)
 		{
 			keyState = KEY_DEBOUNCE;
-			keyDebounceCounter = 0;
+			ticksTimerStart(&keyDebounceTimer, KEY_DEBOUNCE_TIME);
 			keyDebounceScancode = scancode;
 			oldKeyboardCode = 0;
 		}
@@ -267,8 +274,7 @@ void keyboardCheckKeyEvent(keyboardCode_t *keys, int *event)
 		}
 		break;
 	case KEY_DEBOUNCE:
-		keyDebounceCounter++;
-		if (keyDebounceCounter > KEY_DEBOUNCE_COUNTER)
+		if (ticksTimerHasExpired(&keyDebounceTimer))
 		{
 			if (keyDebounceScancode == scancode)
 			{
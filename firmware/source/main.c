@@ -69,14 +69,17 @@ static uint32_t lowBatteryCount = 0;
 #define SUSPEND_LOW_BATTERY_RATE                   1000 // 1 second
 #define LOW_BATTERY_SUSPEND_TO_POWEROFF            69
 
-static const int BATTERY_VOLTAGE_TICK_RELOAD = 100;
+#define MAIN_TASK_TICK_PERIOD_MS                    1 // Operator, audio or radio activity
+#define MAIN_TASK_IDLE_PERIOD_MS                   10 // Channel/VFO screen with nothing going on, events wake the task up earlier
+
+static const int BATTERY_VOLTAGE_TICK_RELOAD = 100;// ms
 static const int BATTERY_VOLTAGE_CALLBACK_TICK_RELOAD = 20;
 static const int AVERAGE_BATTERY_VOLTAGE_SAMPLE_WINDOW = 60.0f;// 120 secs = Sample window * BATTERY_VOLTAGE_TICK_RELOAD in milliseconds
 static const int BATTERY_VOLTAGE_STABILISATION_TIME = 1500;// time in PIT ticks for the battery voltage from the ADC to stabilise
 float averageBatteryVoltage;
 static float previousAverageBatteryVoltage;
 int batteryVoltage = 0;
-static int batteryVoltageTick = BATTERY_VOLTAGE_TICK_RELOAD;
+static ticksTimer_t batteryVoltageTimer = { 0, 0 };// expired, the first call reads the voltage
 static int batteryVoltageCallbackTick = 0;
 bool batteryOverrideSampling = false;
 
@@ -114,10 +117,47 @@ void mainTaskInit(void)
 	vTaskStartScheduler();
 }
 
+// Wake the main task up before the end of its period, something has to be handled now
+void mainTaskWakeUp(void)
+{
+	if (mainTask.Handle != NULL)
+	{
+		xTaskNotifyGive(mainTask.Handle);
+	}
+}
+
+void mainTaskWakeUpFromISR(void)
+{
+	if (mainTask.Handle != NULL)
+	{
+		BaseType_t higherPriorityTaskWoken = pdFALSE;
+
+		vTaskNotifyGiveFromISR(mainTask.Handle, &higherPriorityTaskWoken);
+		portYIELD_FROM_ISR(higherPriorityTaskWoken);
+	}
+}
+
+// Nothing needs the UI every tick: no key or button down, the Channel/VFO screen shown without any
+// notification, scan, transmission, DMR call, audio or USB traffic.
+static bool mainTaskIsIdle(uint32_t buttons)
+{
+	int currentMenu = menuSystemGetCurrentMenuNumber();
+
+	return (keyboardIsIdle() && (buttons == 0) &&
+			((currentMenu == UI_CHANNEL_MODE) || (currentMenu == UI_VFO_MODE)) && (uiNotificationIsVisible() == false) &&
+			(uiDataGlobal.Scan.active == false) &&
+			((trxTransmissionEnabled || trxIsTransmitting || txPAEnabled) == false) && (slotState == DMR_STATE_IDLE) &&
+			(getAudioAmpStatus() == AUDIO_AMP_MODE_NONE) && (melody_play == NULL) && (voicePromptsIsPlaying() == false) &&
+			(voxIsEnabled() == false) && // VOX levels are sampled by the ADC conversions triggered every tick
+#if !defined(PLATFORM_GD77S)
+			(aprsTxProgress == APRS_TX_IDLE) &&
+#endif
+			(com_request == 0) && (settingsUsbMode != USB_MODE_HOTSPOT));
+}
+
 static void batteryUpdate(void)
 {
-	batteryVoltageTick++;
-	if (batteryVoltageTick >= BATTERY_VOLTAGE_TICK_RELOAD)
+	if (ticksTimerHasExpired(&batteryVoltageTimer))
 	{
 		batteryVoltage = adcGetBatteryVoltage();
 //		SEGGER_RTT_printf(0,"%d\t%d,PIT\n",batteryVoltage,PITCounter);
@@ -143,7 +183,7 @@ static void batteryUpdate(void)
 			menuRadioInfosPushBackVoltage(averageBatteryVoltage);
 			batteryVoltageCallbackTick = 0;
 		}
-		batteryVoltageTick = 0;
+		ticksTimerStart(&batteryVoltageTimer, BATTERY_VOLTAGE_TICK_RELOAD);
 	}
 	adcTriggerConversion(NO_ADC_CHANNEL_OVERRIDE);// need the ADC value next time though, so request conversion now, so that its ready by the time we need it
 }
@@ -180,7 +220,7 @@ static bool batteryisLowVoltageSuspendToPoweroff(void)
 }
 #endif
 
-static void batteryChecking(uiEvent_t *ev)
+static void batteryChecking(uiEvent_t *ev, uint32_t elapsedMs)
 {
 	static ticksTimer_t lowBatteryBeepTimer = { 0, 0 };
 	static ticksTimer_t lowBatteryHeaderRedrawTimer = { 0, 0 };
@@ -190,9 +230,24 @@ static void batteryChecking(uiEvent_t *ev)
 
 	// Low battery threshold is reached after 30 seconds, in total, of lowBatteryWarning.
 	// Once reached, another 30 seconds is added to the counter to avoid retriggering on voltage fluctuations.
-	lowBatteryCount += (lowBatteryWarning
-			? ((lowBatteryCount <= (LOW_BATTERY_VOLTAGE_RECOVERY_TIME * 2)) ? ((lowBatteryCount == LOW_BATTERY_VOLTAGE_RECOVERY_TIME) ? LOW_BATTERY_VOLTAGE_RECOVERY_TIME : 1) : 0)
-			: (lowBatteryCount ? -1 : 0));
+	if (lowBatteryWarning)
+	{
+		if (lowBatteryCount <= (LOW_BATTERY_VOLTAGE_RECOVERY_TIME * 2))
+		{
+			uint32_t previousCount = lowBatteryCount;
+
+			lowBatteryCount += elapsedMs;
+
+			if ((previousCount <= LOW_BATTERY_VOLTAGE_RECOVERY_TIME) && (lowBatteryCount > LOW_BATTERY_VOLTAGE_RECOVERY_TIME))
+			{
+				lowBatteryCount += LOW_BATTERY_VOLTAGE_RECOVERY_TIME;
+			}
+		}
+	}
+	else
+	{
+		lowBatteryCount -= ((elapsedMs < lowBatteryCount) ? elapsedMs : lowBatteryCount);
+	}
 
 	// Do we need to redraw the header row now ?
 	if ((batIsLow = batteryIsLowWarning()) && ticksTimerHasExpired(&lowBatteryHeaderRedrawTimer))
@@ -250,7 +305,14 @@ static void batteryChecking(uiEvent_t *ev)
 	bool lowBatteryCritical = batteryIsLowCriticalVoltage();
 
 	// Critical battery threshold is reached after 30 seconds, in total, of lowBatteryCritical.
-	lowBatteryCriticalCount += (lowBatteryCritical ? 1 : (lowBatteryCriticalCount ? -1 : 0));
+	if (lowBatteryCritical)
+	{
+		lowBatteryCriticalCount += elapsedMs;
+	}
+	else
+	{
+		lowBatteryCriticalCount -= ((elapsedMs < lowBatteryCriticalCount) ? elapsedMs : lowBatteryCriticalCount);
+	}
 
 	// Low battery or poweroff (non RD-5R)
 	bool powerSwitchIsOff =
@@ -801,6 +863,8 @@ void powerOffFinalStage(bool maintainRTC, bool forceSuspend)
 	gpsLoggingStop();
 #endif
 
+	SPI_Flash_flushIfNeeded(true);
+
 	m = ticksGetMillis();
 	settingsSaveSettings(true);
 
@@ -1259,844 +1323,853 @@ void mainTaskFunction(void *data)
 	aprsBeaconingStart();
 #endif
 
+	TickType_t mainTaskLastTick = (xTaskGetTickCount() - 1);
+	uint32_t notified;
+
 	while (true)
 	{
-		if (timer_maintask == 0)
-		{
-			bool syntheticEvent = false; // used to not trigger the backlight on faked key/button events
+		// Each pass is a tick period timeout or a notified event, the elapsed time is what the countdowns rely on
+		TickType_t mainTaskTick = xTaskGetTickCount();
+		uint32_t elapsedMs = ((mainTaskTick - mainTaskLastTick) * portTICK_PERIOD_MS);
+		bool syntheticEvent = false; // used to not trigger the backlight on faked key/button events
 
-			mainTask.AliveCount = TASK_FLAGGED_ALIVE;
+		mainTask.AliveCount = TASK_FLAGGED_ALIVE;
 
-			batteryUpdate();
+		batteryUpdate();
 
-			tick_com_request();
+		tick_com_request();
 
-			handleTimerCallbacks();
+		handleTimerCallbacks();
 
 #if ! defined(PLATFORM_GD77S)
-			// Ignore any input when APRS is TXing (avoiding changing the channel in the middle of a packet).
-			if ((currentChannelData->aprsConfigIndex == 0) ||
-					((currentChannelData->aprsConfigIndex != 0) && (aprsTxProgress == APRS_TX_IDLE)))
+		// Ignore any input when APRS is TXing (avoiding changing the channel in the middle of a packet).
+		if ((currentChannelData->aprsConfigIndex == 0) ||
+				((currentChannelData->aprsConfigIndex != 0) && (aprsTxProgress == APRS_TX_IDLE)))
 #endif
+		{
+			keyboardCheckKeyEvent(&keys, &key_event); // Read keyboard state and event
+			buttonsCheckButtonsEvent(&buttons, &button_event, (keys.key != 0)); // Read button state and event
+			rotarySwitchCheckRotaryEvent(&rotary, &rotary_event); // Rotary switch state and event (GD-77S only)
+		}
+#if ! defined(PLATFORM_GD77S)
+		else
+		{
+			if (aprsTxProgress == APRS_TX_FINISHED)
 			{
-				keyboardCheckKeyEvent(&keys, &key_event); // Read keyboard state and event
-				buttonsCheckButtonsEvent(&buttons, &button_event, (keys.key != 0)); // Read button state and event
-				rotarySwitchCheckRotaryEvent(&rotary, &rotary_event); // Rotary switch state and event (GD-77S only)
+				// Force the UI to handle the button release.
+				button_event = EVENT_BUTTON_CHANGE;
+				key_event = EVENT_KEY_CHANGE;
+				keyboardReset();
+				syntheticEvent = true;
 			}
-#if ! defined(PLATFORM_GD77S)
 			else
 			{
-				if (aprsTxProgress == APRS_TX_FINISHED)
-				{
-					// Force the UI to handle the button release.
-					button_event = EVENT_BUTTON_CHANGE;
-					key_event = EVENT_KEY_CHANGE;
-					keyboardReset();
-					syntheticEvent = true;
-				}
-				else
-				{
-					button_event = EVENT_BUTTON_NONE;
-					key_event = EVENT_KEY_NONE;
-					keyboardReset();
-				}
+				button_event = EVENT_BUTTON_NONE;
+				key_event = EVENT_KEY_NONE;
+				keyboardReset();
 			}
+		}
 #endif
 
 #if !defined(PLATFORM_RD5R)
-			// Circumvent defective/weak Orange button, using SK1 + GREEN combination
-			if (buttons & BUTTON_SK1)
+		// Circumvent defective/weak Orange button, using SK1 + GREEN combination
+		if (buttons & BUTTON_SK1)
+		{
+			bool clearSK1 = false;
+
+			if (keys.key == KEY_GREEN)
 			{
-				bool clearSK1 = false;
+				buttons |= BUTTON_ORANGE;
+				button_event = EVENT_BUTTON_CHANGE;
+				clearSK1 = true;
 
-				if (keys.key == KEY_GREEN)
+				if ((keys.event & (KEY_MOD_PRESS | KEY_MOD_LONG)) == (KEY_MOD_PRESS | KEY_MOD_LONG))
 				{
-					buttons |= BUTTON_ORANGE;
-					button_event = EVENT_BUTTON_CHANGE;
-					clearSK1 = true;
+					buttons |= BUTTON_ORANGE_EXTRA_LONG_DOWN;
+				}
+				else if ((keys.event & (KEY_MOD_DOWN | KEY_MOD_LONG)) == (KEY_MOD_DOWN | KEY_MOD_LONG))
+				{
+					buttons |= BUTTON_ORANGE_LONG_DOWN;
+				}
+				else if ((keys.event & (KEY_MOD_UP | KEY_MOD_LONG)) == KEY_MOD_UP)
+				{
+					buttons |= BUTTON_ORANGE_SHORT_UP;
+				}
+				else if (keys.event & KEY_MOD_UP)
+				{
+					buttons = EVENT_BUTTON_NONE;
+				}
 
-					if ((keys.event & (KEY_MOD_PRESS | KEY_MOD_LONG)) == (KEY_MOD_PRESS | KEY_MOD_LONG))
-					{
-						buttons |= BUTTON_ORANGE_EXTRA_LONG_DOWN;
-					}
-					else if ((keys.event & (KEY_MOD_DOWN | KEY_MOD_LONG)) == (KEY_MOD_DOWN | KEY_MOD_LONG))
-					{
-						buttons |= BUTTON_ORANGE_LONG_DOWN;
-					}
-					else if ((keys.event & (KEY_MOD_UP | KEY_MOD_LONG)) == KEY_MOD_UP)
-					{
-						buttons |= BUTTON_ORANGE_SHORT_UP;
-					}
-					else if (keys.event & KEY_MOD_UP)
-					{
-						buttons = EVENT_BUTTON_NONE;
-					}
+				keys.event = EVENT_KEY_NONE;
+				keys.key = 0;
+			}
 
-					keys.event = EVENT_KEY_NONE;
-					keys.key = 0;
-				}
+			if (clearSK1)
+			{
+				// Clear all SK1 flags
+				buttons &= ~(BUTTON_SK1 | BUTTON_SK1_SHORT_UP | BUTTON_SK1_LONG_DOWN | BUTTON_SK1_EXTRA_LONG_DOWN);
 
-				if (clearSK1)
+				if (buttons == BUTTON_NONE)
 				{
-					// Clear all SK1 flags
-					buttons &= ~(BUTTON_SK1 | BUTTON_SK1_SHORT_UP | BUTTON_SK1_LONG_DOWN | BUTTON_SK1_EXTRA_LONG_DOWN);
-
-					if (buttons == BUTTON_NONE)
-					{
-						button_event = EVENT_BUTTON_NONE;
-					}
+					button_event = EVENT_BUTTON_NONE;
 				}
 			}
+		}
 #endif
 
-			if (uiDataGlobal.SatelliteAndAlarmData.alarmType != ALARM_TYPE_NONE && (buttons & BUTTON_SK1 & BUTTON_SK2))
-			{
-				wakeFromSleep();
-			}
+		if (uiDataGlobal.SatelliteAndAlarmData.alarmType != ALARM_TYPE_NONE && (buttons & BUTTON_SK1 & BUTTON_SK2))
+		{
+			wakeFromSleep();
+		}
 
 #if !defined(PLATFORM_GD77S)
-			if (wasRestoringDefaultsettings && (menuSystemGetRootMenuNumber() != UI_SPLASH_SCREEN))
-			{
-				wasRestoringDefaultsettings = false;
-				updateMessageOnScreen = true;
+		if (wasRestoringDefaultsettings && (menuSystemGetRootMenuNumber() != UI_SPLASH_SCREEN))
+		{
+			wasRestoringDefaultsettings = false;
+			updateMessageOnScreen = true;
 
-				menuSystemPushNewMenu(MENU_LANGUAGE);
+			menuSystemPushNewMenu(MENU_LANGUAGE);
 
-				snprintf(uiDataGlobal.MessageBox.message, MESSAGEBOX_MESSAGE_LEN_MAX, "%s", "Settings\nUpdated");
-				uiDataGlobal.MessageBox.type = MESSAGEBOX_TYPE_INFO;
-				uiDataGlobal.MessageBox.decoration = MESSAGEBOX_DECORATION_FRAME;
-				uiDataGlobal.MessageBox.buttons =
+			snprintf(uiDataGlobal.MessageBox.message, MESSAGEBOX_MESSAGE_LEN_MAX, "%s", "Settings\nUpdated");
+			uiDataGlobal.MessageBox.type = MESSAGEBOX_TYPE_INFO;
+			uiDataGlobal.MessageBox.decoration = MESSAGEBOX_DECORATION_FRAME;
+			uiDataGlobal.MessageBox.buttons =
 #if defined(PLATFORM_MD9600)
-						MESSAGEBOX_BUTTONS_ENT;
+					MESSAGEBOX_BUTTONS_ENT;
 #else
-						MESSAGEBOX_BUTTONS_OK;
+					MESSAGEBOX_BUTTONS_OK;
 #endif
-				uiDataGlobal.MessageBox.validatorCallback = validateUpdateCallback;
-				menuSystemPushNewMenu(UI_MESSAGE_BOX);
+			uiDataGlobal.MessageBox.validatorCallback = validateUpdateCallback;
+			menuSystemPushNewMenu(UI_MESSAGE_BOX);
 
-				(void)addTimerCallback(settingsUpdateAudioAlert, 100, UI_MESSAGE_BOX, false);// Need to delay playing this for a while, because otherwise it may get played before the volume is turned up enough to hear it.
-			}
+			(void)addTimerCallback(settingsUpdateAudioAlert, 100, UI_MESSAGE_BOX, false);// Need to delay playing this for a while, because otherwise it may get played before the volume is turned up enough to hear it.
+		}
 #endif
 
-			// VOX Checking
-			if (voxIsEnabled())
+		// VOX Checking
+		if (voxIsEnabled())
+		{
+			// if a key/button event happen, reset the VOX.
+			if ((key_event == EVENT_KEY_CHANGE) || (button_event == EVENT_BUTTON_CHANGE) || (keys.key != 0) || (buttons != BUTTON_NONE))
 			{
-				// if a key/button event happen, reset the VOX.
-				if ((key_event == EVENT_KEY_CHANGE) || (button_event == EVENT_BUTTON_CHANGE) || (keys.key != 0) || (buttons != BUTTON_NONE))
+				voxReset();
+			}
+			else
+			{
+				if (!trxTransmissionEnabled && voxIsTriggered() && ((buttons & BUTTON_PTT) == 0))
+				{
+					button_event = EVENT_BUTTON_CHANGE;
+					buttons |= BUTTON_PTT;
+				}
+				else if (trxTransmissionEnabled && ((voxIsTriggered() == false) || (keys.event & KEY_MOD_PRESS)))
 				{
-					voxReset();
+					button_event = EVENT_BUTTON_CHANGE;
+					buttons &= ~BUTTON_PTT;
 				}
-				else
+				else if (trxTransmissionEnabled && voxIsTriggered())
 				{
-					if (!trxTransmissionEnabled && voxIsTriggered() && ((buttons & BUTTON_PTT) == 0))
-					{
-						button_event = EVENT_BUTTON_CHANGE;
-						buttons |= BUTTON_PTT;
-					}
-					else if (trxTransmissionEnabled && ((voxIsTriggered() == false) || (keys.event & KEY_MOD_PRESS)))
+					// Any key/button event reset the vox
+					if ((button_event != EVENT_BUTTON_NONE) || (keys.event != EVENT_KEY_NONE))
 					{
+						voxReset();
 						button_event = EVENT_BUTTON_CHANGE;
 						buttons &= ~BUTTON_PTT;
 					}
-					else if (trxTransmissionEnabled && voxIsTriggered())
+					else
 					{
-						// Any key/button event reset the vox
-						if ((button_event != EVENT_BUTTON_NONE) || (keys.event != EVENT_KEY_NONE))
-						{
-							voxReset();
-							button_event = EVENT_BUTTON_CHANGE;
-							buttons &= ~BUTTON_PTT;
-						}
-						else
-						{
-							buttons |= BUTTON_PTT;
-						}
+						buttons |= BUTTON_PTT;
 					}
 				}
 			}
+		}
 
 
-			// If the settings update message is still on screen, don't permit to start xmitting.
-			if (updateMessageOnScreen && (buttons & BUTTON_PTT))
-			{
-				button_event = EVENT_BUTTON_CHANGE;
-				buttons &= ~BUTTON_PTT;
-			}
+		// If the settings update message is still on screen, don't permit to start xmitting.
+		if (updateMessageOnScreen && (buttons & BUTTON_PTT))
+		{
+			button_event = EVENT_BUTTON_CHANGE;
+			buttons &= ~BUTTON_PTT;
+		}
 
-			// EVENT_*_CHANGED can be cleared later, so check this now as hasEvent has to be set anyway.
-			keyOrButtonChanged = ((key_event != EVENT_KEY_NONE) || (button_event != EVENT_BUTTON_NONE) || (rotary_event != EVENT_ROTARY_NONE));
+		// EVENT_*_CHANGED can be cleared later, so check this now as hasEvent has to be set anyway.
+		keyOrButtonChanged = ((key_event != EVENT_KEY_NONE) || (button_event != EVENT_BUTTON_NONE) || (rotary_event != EVENT_ROTARY_NONE));
 
-			if (headerRowIsDirty == true)
-			{
-				int currentMenu = menuSystemGetCurrentMenuNumber();
+		if (headerRowIsDirty == true)
+		{
+			int currentMenu = menuSystemGetCurrentMenuNumber();
 
-				if ((currentMenu == UI_CHANNEL_MODE) || (currentMenu == UI_VFO_MODE) ||
-						((currentMenu == MENU_SATELLITE) && menuSatelliteIsDisplayingHeader()))
+			if ((currentMenu == UI_CHANNEL_MODE) || (currentMenu == UI_VFO_MODE) ||
+					((currentMenu == MENU_SATELLITE) && menuSatelliteIsDisplayingHeader()))
+			{
+				bool sweeping;
+				if ((sweeping = uiVFOModeSweepScanning(true)))
+				{
+					displayFillRect(0, 0, DISPLAY_SIZE_X, 9, true);
+				}
+				else
 				{
-					bool sweeping;
-					if ((sweeping = uiVFOModeSweepScanning(true)))
-					{
-						displayFillRect(0, 0, DISPLAY_SIZE_X, 9, true);
-					}
-					else
-					{
 #if defined(PLATFORM_RD5R)
-						displayFillRect(0, 0, DISPLAY_SIZE_X, 9, true);
+					displayFillRect(0, 0, DISPLAY_SIZE_X, 9, true);
 #else
-						displayFillRect(0, 0, DISPLAY_SIZE_X, 14, true); // 2 rows are two much (16 pixels), switched to FillRect.
+					displayFillRect(0, 0, DISPLAY_SIZE_X, 14, true); // 2 rows are two much (16 pixels), switched to FillRect.
 #endif
-					}
-					uiUtilityRenderHeader(uiVFOModeDualWatchIsScanning(), sweeping);
-					displayRenderRows(0, 2);
 				}
-
-				headerRowIsDirty = false;
+				uiUtilityRenderHeader(uiVFOModeDualWatchIsScanning(), sweeping);
+				displayRender(); // dirty tracking limits the transfer to the redrawn header
 			}
 
-			if (keypadLocked || PTTLocked)
+			headerRowIsDirty = false;
+		}
+
+		if (keypadLocked || PTTLocked)
+		{
+			if (keypadLocked && ((buttons & BUTTON_PTT) == 0))
 			{
-				if (keypadLocked && ((buttons & BUTTON_PTT) == 0))
+				if ((key_event == EVENT_KEY_CHANGE) && (syntheticEvent == false))
 				{
-					if ((key_event == EVENT_KEY_CHANGE) && (syntheticEvent == false))
-					{
-						bool continueToFilterKeys = true;
+					bool continueToFilterKeys = true;
 
-						// A key is pressed, but a message box is currently displayed (probably a private call notification)
-						if (menuSystemGetCurrentMenuNumber() == UI_MESSAGE_BOX)
-						{
-							// Clear any key but RED and GREEN
-							if ((keys.key == KEY_RED) || (keys.key == KEY_GREEN))
-							{
-								continueToFilterKeys = false;
-							}
-						}
-
-						if (continueToFilterKeys)
-						{
-							if ((PTTToggledDown == false) && (menuSystemGetCurrentMenuNumber() != UI_LOCK_SCREEN))
-							{
-								menuSystemPushNewMenu(UI_LOCK_SCREEN);
-							}
-
-							key_event = EVENT_KEY_NONE;
-						}
-
-						if (settingsIsOptionBitSet(BIT_PTT_LATCH) && PTTToggledDown)
+					// A key is pressed, but a message box is currently displayed (probably a private call notification)
+					if (menuSystemGetCurrentMenuNumber() == UI_MESSAGE_BOX)
+					{
+						// Clear any key but RED and GREEN
+						if ((keys.key == KEY_RED) || (keys.key == KEY_GREEN))
 						{
-							PTTToggledDown = false;
+							continueToFilterKeys = false;
 						}
 					}
 
-					// Lockout ORANGE AND BLUE (BLACK stay active regardless lock status, useful to trigger backlight)
-#if defined(PLATFORM_RD5R)
-					if ((button_event == EVENT_BUTTON_CHANGE) && (buttons & BUTTON_SK2))
-#else
-					if ((button_event == EVENT_BUTTON_CHANGE) && ((buttons & BUTTON_ORANGE) || (buttons & BUTTON_SK2)))
-#endif
+					if (continueToFilterKeys)
 					{
 						if ((PTTToggledDown == false) && (menuSystemGetCurrentMenuNumber() != UI_LOCK_SCREEN))
 						{
 							menuSystemPushNewMenu(UI_LOCK_SCREEN);
 						}
 
-						button_event = EVENT_BUTTON_NONE;
+						key_event = EVENT_KEY_NONE;
+					}
 
-						if (settingsIsOptionBitSet(BIT_PTT_LATCH) && PTTToggledDown)
-						{
-							PTTToggledDown = false;
-						}
+					if (settingsIsOptionBitSet(BIT_PTT_LATCH) && PTTToggledDown)
+					{
+						PTTToggledDown = false;
 					}
 				}
-				else if (PTTLocked)
+
+				// Lockout ORANGE AND BLUE (BLACK stay active regardless lock status, useful to trigger backlight)
+#if defined(PLATFORM_RD5R)
+				if ((button_event == EVENT_BUTTON_CHANGE) && (buttons & BUTTON_SK2))
+#else
+				if ((button_event == EVENT_BUTTON_CHANGE) && ((buttons & BUTTON_ORANGE) || (buttons & BUTTON_SK2)))
+#endif
 				{
-					if ((buttons & BUTTON_PTT) && (button_event == EVENT_BUTTON_CHANGE))
+					if ((PTTToggledDown == false) && (menuSystemGetCurrentMenuNumber() != UI_LOCK_SCREEN))
 					{
-						// PTT button is pressed, but a message box is currently displayed, and PC allowance is set to PTT,
-						// hence it's probably a private call accept, so let the PTT button being handled later in the code
-						if (((menuSystemGetCurrentMenuNumber() == UI_MESSAGE_BOX) && (nonVolatileSettings.privateCalls == ALLOW_PRIVATE_CALLS_PTT)) == false)
-						{
-							soundSetMelody(MELODY_ERROR_BEEP);
+						menuSystemPushNewMenu(UI_LOCK_SCREEN);
+					}
 
-							if (menuSystemGetCurrentMenuNumber() != UI_LOCK_SCREEN)
-							{
-								menuSystemPushNewMenu(UI_LOCK_SCREEN);
-							}
+					button_event = EVENT_BUTTON_NONE;
 
-							button_event = EVENT_BUTTON_NONE;
-							// Clear PTT button
-							buttons &= ~BUTTON_PTT;
-						}
+					if (settingsIsOptionBitSet(BIT_PTT_LATCH) && PTTToggledDown)
+					{
+						PTTToggledDown = false;
 					}
-					else if ((buttons & BUTTON_SK2) && KEYCHECK_DOWN(keys, KEY_STAR))
+				}
+			}
+			else if (PTTLocked)
+			{
+				if ((buttons & BUTTON_PTT) && (button_event == EVENT_BUTTON_CHANGE))
+				{
+					// PTT button is pressed, but a message box is currently displayed, and PC allowance is set to PTT,
+					// hence it's probably a private call accept, so let the PTT button being handled later in the code
+					if (((menuSystemGetCurrentMenuNumber() == UI_MESSAGE_BOX) && (nonVolatileSettings.privateCalls == ALLOW_PRIVATE_CALLS_PTT)) == false)
 					{
+						soundSetMelody(MELODY_ERROR_BEEP);
+
 						if (menuSystemGetCurrentMenuNumber() != UI_LOCK_SCREEN)
 						{
 							menuSystemPushNewMenu(UI_LOCK_SCREEN);
 						}
+
+						button_event = EVENT_BUTTON_NONE;
+						// Clear PTT button
+						buttons &= ~BUTTON_PTT;
+					}
+				}
+				else if ((buttons & BUTTON_SK2) && KEYCHECK_DOWN(keys, KEY_STAR))
+				{
+					if (menuSystemGetCurrentMenuNumber() != UI_LOCK_SCREEN)
+					{
+						menuSystemPushNewMenu(UI_LOCK_SCREEN);
 					}
 				}
 			}
+		}
 
-			int trxMode = trxGetMode();
+		int trxMode = trxGetMode();
 
 #if ! defined(PLATFORM_GD77S)
-			if ((key_event == EVENT_KEY_CHANGE) && ((buttons & BUTTON_PTT) == 0) && (keys.key != 0))
-			{
-				int currentMenu = menuSystemGetCurrentMenuNumber();
+		if ((key_event == EVENT_KEY_CHANGE) && ((buttons & BUTTON_PTT) == 0) && (keys.key != 0))
+		{
+			int currentMenu = menuSystemGetCurrentMenuNumber();
 
-				// Longpress RED send back to root menu, it's only available from
-				// any menu but VFO, Channel and CPS
-				if (((currentMenu != UI_CHANNEL_MODE) && (currentMenu != UI_VFO_MODE) && (currentMenu != UI_CPS) && (currentMenu != UI_MESSAGE_BOX)) &&
-						KEYCHECK_LONGDOWN(keys, KEY_RED) && (uiVFOModeIsScanning() == false) && (uiChannelModeIsScanning() == false))
+			// Longpress RED send back to root menu, it's only available from
+			// any menu but VFO, Channel and CPS
+			if (((currentMenu != UI_CHANNEL_MODE) && (currentMenu != UI_VFO_MODE) && (currentMenu != UI_CPS) && (currentMenu != UI_MESSAGE_BOX)) &&
+					KEYCHECK_LONGDOWN(keys, KEY_RED) && (uiVFOModeIsScanning() == false) && (uiChannelModeIsScanning() == false))
+			{
+				if (currentMenu != MENU_SATELLITE)
 				{
-					if (currentMenu != MENU_SATELLITE)
-					{
-						// If an option menu is currently running, ensure the
-						// settings copy is reset.
-						resetOriginalSettingsData();
-					}
-
-					uiDataGlobal.currentSelectedContactIndex = 0;
-					menuSystemPopAllAndDisplayRootMenu();
-					soundSetMelody(MELODY_KEY_BEEP);
-
-					// Clear button/key event/state.
-					buttons = BUTTON_NONE;
-					rotary = 0;
-					key_event = EVENT_KEY_NONE;
-					button_event = EVENT_BUTTON_NONE;
-					rotary_event = EVENT_ROTARY_NONE;
-					keys.key = 0;
-					keys.event = 0;
+					// If an option menu is currently running, ensure the
+					// settings copy is reset.
+					resetOriginalSettingsData();
 				}
-			}
 
-			//
-			// PTT toggle feature
-			//
-			// PTT is locked down, but any button, except SK1 or SK2(1750Hz in FM) or DTMF Key in Analog,
-			// or Up/Down with LH on screen in Digital, is pressed, virtually release PTT
-			if ((settingsIsOptionBitSet(BIT_PTT_LATCH) && PTTToggledDown) &&
-					(((button_event & EVENT_BUTTON_CHANGE) && (
-#if ! defined(PLATFORM_RD5R)
-							(buttons & BUTTON_ORANGE) ||
-#endif
-							((trxMode != RADIO_MODE_ANALOG) && (buttons & BUTTON_SK2)))) ||
-							((keys.key != 0) && (keys.event & KEY_MOD_UP) &&
-									(((trxMode == RADIO_MODE_ANALOG) && keyboardKeyIsDTMFKey(keys.key)) == false) &&
-									(((trxMode == RADIO_MODE_DIGITAL) && menuTxScreenDisplaysLastHeard() && ((keys.key == KEY_UP) || (keys.key == KEY_DOWN))) == false))))
-			{
-				PTTToggledDown = false;
-				button_event = EVENT_BUTTON_CHANGE;
+				uiDataGlobal.currentSelectedContactIndex = 0;
+				menuSystemPopAllAndDisplayRootMenu();
+				soundSetMelody(MELODY_KEY_BEEP);
+
+				// Clear button/key event/state.
 				buttons = BUTTON_NONE;
+				rotary = 0;
 				key_event = EVENT_KEY_NONE;
+				button_event = EVENT_BUTTON_NONE;
+				rotary_event = EVENT_ROTARY_NONE;
 				keys.key = 0;
+				keys.event = 0;
 			}
+		}
+
+		//
+		// PTT toggle feature
+		//
+		// PTT is locked down, but any button, except SK1 or SK2(1750Hz in FM) or DTMF Key in Analog,
+		// or Up/Down with LH on screen in Digital, is pressed, virtually release PTT
+		if ((settingsIsOptionBitSet(BIT_PTT_LATCH) && PTTToggledDown) &&
+				(((button_event & EVENT_BUTTON_CHANGE) && (
+#if ! defined(PLATFORM_RD5R)
+						(buttons & BUTTON_ORANGE) ||
+#endif
+						((trxMode != RADIO_MODE_ANALOG) && (buttons & BUTTON_SK2)))) ||
+						((keys.key != 0) && (keys.event & KEY_MOD_UP) &&
+								(((trxMode == RADIO_MODE_ANALOG) && keyboardKeyIsDTMFKey(keys.key)) == false) &&
+								(((trxMode == RADIO_MODE_DIGITAL) && menuTxScreenDisplaysLastHeard() && ((keys.key == KEY_UP) || (keys.key == KEY_DOWN))) == false))))
+		{
+			PTTToggledDown = false;
+			button_event = EVENT_BUTTON_CHANGE;
+			buttons = BUTTON_NONE;
+			key_event = EVENT_KEY_NONE;
+			keys.key = 0;
+		}
 
-			// PTT toggle action
-			if (settingsIsOptionBitSet(BIT_PTT_LATCH))
+		// PTT toggle action
+		if (settingsIsOptionBitSet(BIT_PTT_LATCH))
+		{
+			if (button_event == EVENT_BUTTON_CHANGE)
 			{
-				if (button_event == EVENT_BUTTON_CHANGE)
+				if (buttons & BUTTON_PTT)
 				{
-					if (buttons & BUTTON_PTT)
+					if (PTTToggledDown == false)
 					{
-						if (PTTToggledDown == false)
-						{
-							// PTT toggle works only if a TOT value is defined.
-							if (currentChannelData->tot != 0)
-							{
-								PTTToggledDown = true;
-							}
-						}
-						else
+						// PTT toggle works only if a TOT value is defined.
+						if (currentChannelData->tot != 0)
 						{
-							PTTToggledDown = false;
+							PTTToggledDown = true;
 						}
 					}
+					else
+					{
+						PTTToggledDown = false;
+					}
 				}
+			}
 
-				if (PTTToggledDown && ((buttons & BUTTON_PTT) == 0))
-				{
-					buttons |= BUTTON_PTT;
-				}
+			if (PTTToggledDown && ((buttons & BUTTON_PTT) == 0))
+			{
+				buttons |= BUTTON_PTT;
 			}
-			else
+		}
+		else
+		{
+			if (PTTToggledDown)
 			{
-				if (PTTToggledDown)
-				{
-					PTTToggledDown = false;
-				}
+				PTTToggledDown = false;
 			}
+		}
 #endif
 
-			if (button_event == EVENT_BUTTON_CHANGE)
+		if (button_event == EVENT_BUTTON_CHANGE)
+		{
+			// Toggle backlight
+			if (nonVolatileSettings.backlightMode == BACKLIGHT_MODE_MANUAL)
 			{
-				// Toggle backlight
-				if (nonVolatileSettings.backlightMode == BACKLIGHT_MODE_MANUAL)
+				if (buttons == BUTTON_SK1) // SK1 alone
 				{
-					if (buttons == BUTTON_SK1) // SK1 alone
-					{
-						displayEnableBacklight(! displayIsBacklightLit(), nonVolatileSettings.displayBacklightPercentageOff);
-					}
+					displayEnableBacklight(! displayIsBacklightLit(), nonVolatileSettings.displayBacklightPercentageOff);
 				}
-				else
+			}
+			else
+			{
+				if (syntheticEvent == false)
 				{
-					if (syntheticEvent == false)
-					{
-						displayLightTrigger(true);
-					}
+					displayLightTrigger(true);
 				}
+			}
 
-				if ((buttons & BUTTON_PTT) != 0)
+			if ((buttons & BUTTON_PTT) != 0)
+			{
+				int currentMenu = menuSystemGetCurrentMenuNumber();
+
+				/*
+				 * This code would prevent transmission on simplex if the radio is receiving a DMR signal.
+				 * if ((slotState == DMR_STATE_IDLE || trxDMRMode == DMR_MODE_PASSIVE)  &&
+				 *
+				 */
+				if ((trxMode != RADIO_MODE_NONE) &&
+						(settingsUsbMode != USB_MODE_HOTSPOT) &&
+						(currentMenu != UI_POWER_OFF) &&
+						(currentMenu != UI_SPLASH_SCREEN) &&
+						(currentMenu != UI_TX_SCREEN) &&
+						(currentMenu != MENU_CALIBRATION))
 				{
-					int currentMenu = menuSystemGetCurrentMenuNumber();
-
-					/*
-					 * This code would prevent transmission on simplex if the radio is receiving a DMR signal.
-					 * if ((slotState == DMR_STATE_IDLE || trxDMRMode == DMR_MODE_PASSIVE)  &&
-					 *
-					 */
-					if ((trxMode != RADIO_MODE_NONE) &&
-							(settingsUsbMode != USB_MODE_HOTSPOT) &&
-							(currentMenu != UI_POWER_OFF) &&
-							(currentMenu != UI_SPLASH_SCREEN) &&
-							(currentMenu != UI_TX_SCREEN) &&
-							(currentMenu != MENU_CALIBRATION))
-					{
-						bool wasScanning = false;
+					bool wasScanning = false;
 
-						if (uiDataGlobal.Scan.active || uiDataGlobal.Scan.toneActive)
+					if (uiDataGlobal.Scan.active || uiDataGlobal.Scan.toneActive)
+					{
+						if (currentMenu == UI_VFO_MODE)
 						{
-							if (currentMenu == UI_VFO_MODE)
-							{
-								uiVFOModeStopScanning();
-							}
-							else
-							{
-								uiChannelModeStopScanning();
-							}
-							wasScanning = true;
+							uiVFOModeStopScanning();
 						}
 						else
 						{
-							if (currentMenu == UI_LOCK_SCREEN)
-							{
-								menuLockScreenPop();
-							}
+							uiChannelModeStopScanning();
 						}
+						wasScanning = true;
+					}
+					else
+					{
+						if (currentMenu == UI_LOCK_SCREEN)
+						{
+							menuLockScreenPop();
+						}
+					}
 
-						currentMenu = menuSystemGetCurrentMenuNumber();
+					currentMenu = menuSystemGetCurrentMenuNumber();
 
-						if (wasScanning)
+					if (wasScanning)
+					{
+						// Mode was blinking, hence it needs to be redrawn as it could be in its hidden phase.
+						uiUtilityRedrawHeaderOnly(false, false);
+					}
+					else
+					{
+						if (((currentMenu == UI_MESSAGE_BOX) && (menuSystemGetPreviousMenuNumber() == UI_PRIVATE_CALL))
+								&& (nonVolatileSettings.privateCalls == ALLOW_PRIVATE_CALLS_PTT))
 						{
-							// Mode was blinking, hence it needs to be redrawn as it could be in its hidden phase.
-							uiUtilityRedrawHeaderOnly(false, false);
+							acceptPrivateCall(uiDataGlobal.receivedPcId, uiDataGlobal.receivedPcTS);
+							menuPrivateCallDismiss();
 						}
-						else
+						else if (((currentMenu == MENU_CONTACT_LIST_SUBMENU) || (currentMenu == MENU_CONTACT_QUICKLIST)) && dtmfSequenceIsKeying())
+						{
+							dtmfSequenceReset();
+						}
+
+						// Need to call menuSystemGetCurrentMenuNumber() again, as something has probably
+						// changed since last above calls
+						if (menuSystemGetCurrentMenuNumber() != UI_MESSAGE_BOX)
 						{
-							if (((currentMenu == UI_MESSAGE_BOX) && (menuSystemGetPreviousMenuNumber() == UI_PRIVATE_CALL))
-									&& (nonVolatileSettings.privateCalls == ALLOW_PRIVATE_CALLS_PTT))
+#if defined(PLATFORM_GD77S)
+							if (uiChannelModeTransmitDTMFContactForGD77S())
 							{
-								acceptPrivateCall(uiDataGlobal.receivedPcId, uiDataGlobal.receivedPcTS);
-								menuPrivateCallDismiss();
+								button_event = EVENT_BUTTON_NONE;
+								buttons &= ~BUTTON_PTT;
 							}
-							else if (((currentMenu == MENU_CONTACT_LIST_SUBMENU) || (currentMenu == MENU_CONTACT_QUICKLIST)) && dtmfSequenceIsKeying())
+							else
 							{
-								dtmfSequenceReset();
-							}
+#endif
 
-							// Need to call menuSystemGetCurrentMenuNumber() again, as something has probably
-							// changed since last above calls
-							if (menuSystemGetCurrentMenuNumber() != UI_MESSAGE_BOX)
-							{
-#if defined(PLATFORM_GD77S)
-								if (uiChannelModeTransmitDTMFContactForGD77S())
+								rxPowerSavingSetState(ECOPHASE_POWERSAVE_INACTIVE);
+
+								if (currentChannelData->txFreq != 0)
 								{
-									button_event = EVENT_BUTTON_NONE;
-									buttons &= ~BUTTON_PTT;
+									menuSystemPushNewMenu(UI_TX_SCREEN);
 								}
 								else
 								{
-#endif
-
-									rxPowerSavingSetState(ECOPHASE_POWERSAVE_INACTIVE);
-
-									if (currentChannelData->txFreq != 0)
-									{
-										menuSystemPushNewMenu(UI_TX_SCREEN);
-									}
-									else
-									{
-										soundSetMelody(MELODY_NACK_BEEP);
-									}
-#if defined(PLATFORM_GD77S)
+									soundSetMelody(MELODY_NACK_BEEP);
 								}
-#endif
-							}
-							else
-							{
-								button_event = EVENT_BUTTON_NONE;
-								buttons &= ~BUTTON_PTT;
+#if defined(PLATFORM_GD77S)
 							}
+#endif
+						}
+						else
+						{
+							button_event = EVENT_BUTTON_NONE;
+							buttons &= ~BUTTON_PTT;
 						}
 					}
 				}
+			}
 
 #if (! defined(PLATFORM_GD77S)) && (! defined(PLATFORM_RD5R))
-				if ((buttons & (BUTTON_SK1 | BUTTON_ORANGE | BUTTON_ORANGE_EXTRA_LONG_DOWN)) == (BUTTON_SK1 | BUTTON_ORANGE | BUTTON_ORANGE_EXTRA_LONG_DOWN))
-				{
-					settingsSaveSettings(true);
-					soundSetMelody(MELODY_ACK_BEEP);
-				}
-#endif
+			if ((buttons & (BUTTON_SK1 | BUTTON_ORANGE | BUTTON_ORANGE_EXTRA_LONG_DOWN)) == (BUTTON_SK1 | BUTTON_ORANGE | BUTTON_ORANGE_EXTRA_LONG_DOWN))
+			{
+				settingsSaveSettings(true);
+				soundSetMelody(MELODY_ACK_BEEP);
 			}
+#endif
+		}
 
-			if (!trxTransmissionEnabled && (updateLastHeard == true))
+		if (!trxTransmissionEnabled && (updateLastHeard == true))
+		{
+			lastHeardListUpdate((uint8_t *)DMR_frame_buffer, false);
+			updateLastHeard = false;
+		}
+
+		if ((nonVolatileSettings.hotspotType == HOTSPOT_TYPE_OFF) ||
+				((nonVolatileSettings.hotspotType != HOTSPOT_TYPE_OFF) && (settingsUsbMode != USB_MODE_HOTSPOT))) // Do not filter anything in HS mode.
+		{
+			if ((uiDataGlobal.PrivateCall.state == PRIVATE_CALL_DECLINED) &&
+					(slotState == DMR_STATE_IDLE))
 			{
-				lastHeardListUpdate((uint8_t *)DMR_frame_buffer, false);
-				updateLastHeard = false;
+				menuPrivateCallClear();
 			}
 
-			if ((nonVolatileSettings.hotspotType == HOTSPOT_TYPE_OFF) ||
-					((nonVolatileSettings.hotspotType != HOTSPOT_TYPE_OFF) && (settingsUsbMode != USB_MODE_HOTSPOT))) // Do not filter anything in HS mode.
+			if ((trxTransmissionEnabled == false) && (trxIsTransmitting == false) &&
+					(uiDataGlobal.displayQSOState == QSO_DISPLAY_CALLER_DATA) && (nonVolatileSettings.privateCalls > ALLOW_PRIVATE_CALLS_OFF))
 			{
-				if ((uiDataGlobal.PrivateCall.state == PRIVATE_CALL_DECLINED) &&
-						(slotState == DMR_STATE_IDLE))
+				if (HRC6000GetReceivedTgOrPcId() == (trxDMRID | (PC_CALL_FLAG << 24)))
 				{
-					menuPrivateCallClear();
-				}
+					int receivedSrcId = HRC6000GetReceivedSrcId();
 
-				if ((trxTransmissionEnabled == false) && (trxIsTransmitting == false) &&
-						(uiDataGlobal.displayQSOState == QSO_DISPLAY_CALLER_DATA) && (nonVolatileSettings.privateCalls > ALLOW_PRIVATE_CALLS_OFF))
-				{
-					if (HRC6000GetReceivedTgOrPcId() == (trxDMRID | (PC_CALL_FLAG << 24)))
+					if ((uiDataGlobal.PrivateCall.state == PRIVATE_CALL_NOT_IN_CALL) &&
+							(trxTalkGroupOrPcId != (receivedSrcId | (PC_CALL_FLAG << 24))) &&
+							(receivedSrcId != uiDataGlobal.PrivateCall.lastID))
 					{
-						int receivedSrcId = HRC6000GetReceivedSrcId();
-
-						if ((uiDataGlobal.PrivateCall.state == PRIVATE_CALL_NOT_IN_CALL) &&
-								(trxTalkGroupOrPcId != (receivedSrcId | (PC_CALL_FLAG << 24))) &&
-								(receivedSrcId != uiDataGlobal.PrivateCall.lastID))
+						if ((receivedSrcId & 0xFFFFFF) >= 1000000)
 						{
-							if ((receivedSrcId & 0xFFFFFF) >= 1000000)
-							{
-								menuSystemPushNewMenu(UI_PRIVATE_CALL);
-							}
+							menuSystemPushNewMenu(UI_PRIVATE_CALL);
 						}
 					}
 				}
 			}
+		}
 
 #if defined(PLATFORM_GD77S) && defined(READ_CPUID)
-			if ((buttons & (BUTTON_SK1 | BUTTON_ORANGE | BUTTON_PTT)) == (BUTTON_SK1 | BUTTON_ORANGE | BUTTON_PTT))
-			{
-				debugReadCPUID();
-			}
+		if ((buttons & (BUTTON_SK1 | BUTTON_ORANGE | BUTTON_PTT)) == (BUTTON_SK1 | BUTTON_ORANGE | BUTTON_PTT))
+		{
+			debugReadCPUID();
+		}
 #endif
 
-			ev.function = 0;
-			function_event = NO_EVENT;
-			keyFunction = NO_EVENT;
-			int currentMenu = menuSystemGetCurrentMenuNumber();
-			if (KEYCHECK_SHORTUP_NUMBER(keys) && (buttons & BUTTON_SK2) && ((currentMenu == UI_VFO_MODE) || (currentMenu == UI_CHANNEL_MODE)))
-			{
-				keyFunction = codeplugGetQuickkeyFunctionID(keys.key);
-				int menuFunction = QUICKKEY_MENUID(keyFunction);
+		ev.function = 0;
+		function_event = NO_EVENT;
+		keyFunction = NO_EVENT;
+		int currentMenu = menuSystemGetCurrentMenuNumber();
+		if (KEYCHECK_SHORTUP_NUMBER(keys) && (buttons & BUTTON_SK2) && ((currentMenu == UI_VFO_MODE) || (currentMenu == UI_CHANNEL_MODE)))
+		{
+			keyFunction = codeplugGetQuickkeyFunctionID(keys.key);
+			int menuFunction = QUICKKEY_MENUID(keyFunction);
 
 #if 0 // For demo screen
-				if (keys.key == '0')
-				{
-						static uint8_t demo = 90;
-						keyFunction = (UI_HOTSPOT_MODE << 8) | demo; // Hotspot demo mode (able to take screengrabs)
+			if (keys.key == '0')
+			{
+					static uint8_t demo = 90;
+					keyFunction = (UI_HOTSPOT_MODE << 8) | demo; // Hotspot demo mode (able to take screengrabs)
 
-						if (++demo > 99)
-						{
-							demo = 90;
-						}
-				}
+					if (++demo > 99)
+					{
+						demo = 90;
+					}
+			}
 #endif
 
 #if defined(PLATFORM_RD5R)
-				if (keys.key == '5')
-				{
-					menuFunction = 0;
-					keyFunction = FUNC_TOGGLE_TORCH;
-					keyboardReset();
-				}
-				else
-				{
+			if (keys.key == '5')
+			{
+				menuFunction = 0;
+				keyFunction = FUNC_TOGGLE_TORCH;
+				keyboardReset();
+			}
+			else
+			{
 #endif
-					if ((keyFunction != 0) &&
-							((currentMenu == UI_CHANNEL_MODE) || (currentMenu == UI_VFO_MODE) || (currentMenu == menuFunction)))
+				if ((keyFunction != 0) &&
+						((currentMenu == UI_CHANNEL_MODE) || (currentMenu == UI_VFO_MODE) || (currentMenu == menuFunction)))
+				{
+					if (QUICKKEY_TYPE(keyFunction) == QUICKKEY_MENU)
 					{
-						if (QUICKKEY_TYPE(keyFunction) == QUICKKEY_MENU)
+						bool inChannelMenu;
+						bool qkIsValid = true;
+
+						//
+						// QuickMenu special cases:
+						//
+						//   It's permited to share filter quickkeys between Channels and VFO screen.
+						//   For this, the itemIndex value needs to be tweaked.
+						//
+						//   Other QuickMenu entries will simply be ignored if the current Channel/VFO screen doesn't
+						//   match the QuickKey menuId.
+						//
+						if ((inChannelMenu = (currentMenu == UI_CHANNEL_MODE)) || (currentMenu == UI_VFO_MODE))
 						{
-							bool inChannelMenu;
-							bool qkIsValid = true;
-
-							//
-							// QuickMenu special cases:
-							//
-							//   It's permited to share filter quickkeys between Channels and VFO screen.
-							//   For this, the itemIndex value needs to be tweaked.
-							//
-							//   Other QuickMenu entries will simply be ignored if the current Channel/VFO screen doesn't
-							//   match the QuickKey menuId.
-							//
-							if ((inChannelMenu = (currentMenu == UI_CHANNEL_MODE)) || (currentMenu == UI_VFO_MODE))
+							// The current QuickKey menu destination doesn't match the current menu (Channel or VFO)
+							if (menuFunction == (inChannelMenu ? UI_VFO_QUICK_MENU : UI_CHANNEL_QUICK_MENU))
 							{
-								// The current QuickKey menu destination doesn't match the current menu (Channel or VFO)
-								if (menuFunction == (inChannelMenu ? UI_VFO_QUICK_MENU : UI_CHANNEL_QUICK_MENU))
-								{
-									int entryId = QUICKKEY_ENTRYID(keyFunction);
+								int entryId = QUICKKEY_ENTRYID(keyFunction);
 
-									// Convert filters positions
-									if ((entryId >= (inChannelMenu ? VFO_SCREEN_QUICK_MENU_FILTER_FM : CH_SCREEN_QUICK_MENU_FILTER_FM))
-											&& (entryId <= (inChannelMenu ? VFO_SCREEN_QUICK_MENU_FILTER_DMR_TS : CH_SCREEN_QUICK_MENU_FILTER_DMR_TS)))
+								// Convert filters positions
+								if ((entryId >= (inChannelMenu ? VFO_SCREEN_QUICK_MENU_FILTER_FM : CH_SCREEN_QUICK_MENU_FILTER_FM))
+										&& (entryId <= (inChannelMenu ? VFO_SCREEN_QUICK_MENU_FILTER_DMR_TS : CH_SCREEN_QUICK_MENU_FILTER_DMR_TS)))
+								{
+									// Apply entry offset to match the filter position on the opposite screen
+									if (inChannelMenu)
 									{
-										// Apply entry offset to match the filter position on the opposite screen
-										if (inChannelMenu)
-										{
-#if defined(PLATFORM_DM1801)
-											entryId -= 1;
-#else
-											entryId -= 2;
-#endif
-										}
-										else
-										{
 #if defined(PLATFORM_DM1801)
-											entryId += 1;
+										entryId -= 1;
 #else
-											entryId += 2;
+										entryId -= 2;
 #endif
-										}
-
-										int kf = QUICKKEY_MENUVALUE((inChannelMenu ? UI_CHANNEL_QUICK_MENU : UI_VFO_QUICK_MENU), entryId, QUICKKEY_FUNCTIONID(keyFunction));
-										keyFunction = kf;
-										menuFunction = (inChannelMenu ? UI_CHANNEL_QUICK_MENU : UI_VFO_QUICK_MENU);
 									}
 									else
 									{
-										// We can't use other VFO/Channel QuickMenu entry in a mismatching screen.
-										qkIsValid = false;
-										keyFunction = NO_EVENT;
+#if defined(PLATFORM_DM1801)
+										entryId += 1;
+#else
+										entryId += 2;
+#endif
 									}
+
+									int kf = QUICKKEY_MENUVALUE((inChannelMenu ? UI_CHANNEL_QUICK_MENU : UI_VFO_QUICK_MENU), entryId, QUICKKEY_FUNCTIONID(keyFunction));
+									keyFunction = kf;
+									menuFunction = (inChannelMenu ? UI_CHANNEL_QUICK_MENU : UI_VFO_QUICK_MENU);
+								}
+								else
+								{
+									// We can't use other VFO/Channel QuickMenu entry in a mismatching screen.
+									qkIsValid = false;
+									keyFunction = NO_EVENT;
 								}
 							}
+						}
 
-							if (qkIsValid)
+						if (qkIsValid)
+						{
+							if ((menuFunction > 0) && (menuFunction < NUM_MENU_ENTRIES))
 							{
-								if ((menuFunction > 0) && (menuFunction < NUM_MENU_ENTRIES))
+								if (currentMenu != menuFunction)
 								{
-									if (currentMenu != menuFunction)
-									{
-										menuSystemPushNewMenu(menuFunction);
+									menuSystemPushNewMenu(menuFunction);
 
-										// Store the beep build by the new menu status. It will be restored after
-										// the call of menuSystemCallCurrentMenuTick(), below
-										quickkeyPushedMenuMelody = nextKeyBeepMelody;
-									}
+									// Store the beep build by the new menu status. It will be restored after
+									// the call of menuSystemCallCurrentMenuTick(), below
+									quickkeyPushedMenuMelody = nextKeyBeepMelody;
 								}
-								ev.function = keyFunction;
-								buttons = BUTTON_NONE;
-								rotary = 0;
-								key_event = EVENT_KEY_NONE;
-								button_event = EVENT_BUTTON_NONE;
-								rotary_event = EVENT_ROTARY_NONE;
-								keys.key = 0;
-								keys.event = 0;
-								function_event = FUNCTION_EVENT;
-							}
-							else
-							{
-								menuFunction = 0;
 							}
+							ev.function = keyFunction;
+							buttons = BUTTON_NONE;
+							rotary = 0;
+							key_event = EVENT_KEY_NONE;
+							button_event = EVENT_BUTTON_NONE;
+							rotary_event = EVENT_ROTARY_NONE;
+							keys.key = 0;
+							keys.event = 0;
+							function_event = FUNCTION_EVENT;
 						}
-						else if ((QUICKKEY_TYPE(keyFunction) == QUICKKEY_CONTACT) && (currentMenu != menuFunction))
+						else
 						{
-							int contactIndex = QUICKKEY_CONTACTVALUE(keyFunction);
+							menuFunction = 0;
+						}
+					}
+					else if ((QUICKKEY_TYPE(keyFunction) == QUICKKEY_CONTACT) && (currentMenu != menuFunction))
+					{
+						int contactIndex = QUICKKEY_CONTACTVALUE(keyFunction);
 
-							if ((contactIndex >= CODEPLUG_CONTACTS_MIN) && (contactIndex <= CODEPLUG_CONTACTS_MAX))
+						if ((contactIndex >= CODEPLUG_CONTACTS_MIN) && (contactIndex <= CODEPLUG_CONTACTS_MAX))
+						{
+							if (codeplugContactGetDataForIndex(contactIndex, &currentContactData))
 							{
-								if (codeplugContactGetDataForIndex(contactIndex, &currentContactData))
-								{
-									// Use quickkey contact as overrides (contact and its TS, if any)
-									menuPrivateCallClear();
-									setOverrideTGorPC(currentContactData.tgNumber, (currentContactData.callType == CONTACT_CALLTYPE_PC));
+								// Use quickkey contact as overrides (contact and its TS, if any)
+								menuPrivateCallClear();
+								setOverrideTGorPC(currentContactData.tgNumber, (currentContactData.callType == CONTACT_CALLTYPE_PC));
 
-									trxTalkGroupOrPcId = currentContactData.tgNumber;
-									if (currentContactData.callType == CONTACT_CALLTYPE_PC)
-									{
-										trxTalkGroupOrPcId |= (PC_CALL_FLAG << 24);
-									}
+								trxTalkGroupOrPcId = currentContactData.tgNumber;
+								if (currentContactData.callType == CONTACT_CALLTYPE_PC)
+								{
+									trxTalkGroupOrPcId |= (PC_CALL_FLAG << 24);
+								}
 
-									// Contact has a TS override set
-									if ((currentContactData.reserve1 & CODEPLUG_CONTACT_FLAG_NO_TS_OVERRIDE) == 0x00)
-									{
-										int ts = ((currentContactData.reserve1 & CODEPLUG_CONTACT_FLAG_TS_OVERRIDE_TIMESLOT_MASK) >> 1);
-										trxSetDMRTimeSlot(ts, true);
-										tsSetManualOverride(((menuSystemGetRootMenuNumber() == UI_CHANNEL_MODE) ? CHANNEL_CHANNEL : (CHANNEL_VFO_A + nonVolatileSettings.currentVFONumber)), (ts + 1));
-									}
-									ev.function = FUNC_REDRAW;
-									function_event = FUNCTION_EVENT;
+								// Contact has a TS override set
+								if ((currentContactData.reserve1 & CODEPLUG_CONTACT_FLAG_NO_TS_OVERRIDE) == 0x00)
+								{
+									int ts = ((currentContactData.reserve1 & CODEPLUG_CONTACT_FLAG_TS_OVERRIDE_TIMESLOT_MASK) >> 1);
+									trxSetDMRTimeSlot(ts, true);
+									tsSetManualOverride(((menuSystemGetRootMenuNumber() == UI_CHANNEL_MODE) ? CHANNEL_CHANNEL : (CHANNEL_VFO_A + nonVolatileSettings.currentVFONumber)), (ts + 1));
 								}
+								ev.function = FUNC_REDRAW;
+								function_event = FUNCTION_EVENT;
 							}
 						}
 					}
-					keyboardReset();
-#if defined(PLATFORM_RD5R)
 				}
+				keyboardReset();
+#if defined(PLATFORM_RD5R)
+			}
 #endif
+		}
+		ev.buttons = buttons;
+		ev.keys = keys;
+		ev.rotary = rotary;
+		ev.events = function_event | (button_event << 1) | (rotary_event << 3) | key_event | (syntheticEvent ? SYNTHETIC_EVENT : 0);
+		ev.hasEvent = keyOrButtonChanged || (function_event != NO_EVENT);
+		ev.time = ticksGetMillis();
+
+		/*
+		 * We probably can't terminate voice prompt playback in main, because some screens need to a follow-on playback if the prompt was playing when a button was pressed
+		 *
+		if ((nonVolatileSettings.audioPromptMode == AUDIO_PROMPT_MODE_SILENT || voicePromptIsActive)   && (ev.keys.event & KEY_MOD_DOWN))
+		{
+			voicePromptsTerminate();
+		}
+		*/
+		//if (((ev.keys.key >='0' && ev.keys.key <='9') && (((ev.keys.event & (KEY_MOD_DOWN | KEY_MOD_LONG)) == (KEY_MOD_DOWN | KEY_MOD_LONG))) && (ev.buttons & BUTTON_SK2)))
+
+		// Clear the Quickkey slot on SK2 + longdown 0..9 KEY
+		if (KEYCHECK_LONGDOWN_NUMBER(ev.keys) && BUTTONCHECK_DOWN(&ev, BUTTON_SK2))
+		{
+			// Only allow quick keys to be cleared on the 2 main screens
+			if (currentMenu == UI_CHANNEL_MODE || currentMenu == UI_VFO_MODE)
+			{
+				saveQuickkeyMenuLongValue(ev.keys.key, 0, 0);
+				soundSetMelody(MELODY_QUICKKEYS_CLEAR_ACK_BEEP);
 			}
-			ev.buttons = buttons;
-			ev.keys = keys;
-			ev.rotary = rotary;
-			ev.events = function_event | (button_event << 1) | (rotary_event << 3) | key_event | (syntheticEvent ? SYNTHETIC_EVENT : 0);
-			ev.hasEvent = keyOrButtonChanged || (function_event != NO_EVENT);
-			ev.time = ticksGetMillis();
-
-			/*
-			 * We probably can't terminate voice prompt playback in main, because some screens need to a follow-on playback if the prompt was playing when a button was pressed
-			 *
-			if ((nonVolatileSettings.audioPromptMode == AUDIO_PROMPT_MODE_SILENT || voicePromptIsActive)   && (ev.keys.event & KEY_MOD_DOWN))
+			else
 			{
-				voicePromptsTerminate();
+				soundSetMelody(MELODY_NACK_BEEP);
 			}
-			*/
-			//if (((ev.keys.key >='0' && ev.keys.key <='9') && (((ev.keys.event & (KEY_MOD_DOWN | KEY_MOD_LONG)) == (KEY_MOD_DOWN | KEY_MOD_LONG))) && (ev.buttons & BUTTON_SK2)))
 
-			// Clear the Quickkey slot on SK2 + longdown 0..9 KEY
-			if (KEYCHECK_LONGDOWN_NUMBER(ev.keys) && BUTTONCHECK_DOWN(&ev, BUTTON_SK2))
-			{
-				// Only allow quick keys to be cleared on the 2 main screens
-				if (currentMenu == UI_CHANNEL_MODE || currentMenu == UI_VFO_MODE)
-				{
-					saveQuickkeyMenuLongValue(ev.keys.key, 0, 0);
-					soundSetMelody(MELODY_QUICKKEYS_CLEAR_ACK_BEEP);
-				}
-				else
-				{
-					soundSetMelody(MELODY_NACK_BEEP);
-				}
+			// Reset keyboard and event, as this keyboard event HAVE to
+			// be ignore by the current menu.
+			keyboardReset();
+			ev.buttons = BUTTON_NONE;
+			ev.keys.event = 0;
+			ev.keys.key = 0;
+			ev.rotary = 0;
+			ev.events = NO_EVENT;
+			ev.hasEvent = false;
+		}
 
-				// Reset keyboard and event, as this keyboard event HAVE to
-				// be ignore by the current menu.
-				keyboardReset();
-				ev.buttons = BUTTON_NONE;
-				ev.keys.event = 0;
-				ev.keys.key = 0;
-				ev.rotary = 0;
-				ev.events = NO_EVENT;
-				ev.hasEvent = false;
-			}
+		menuSystemCallCurrentMenuTick(&ev);
 
-			menuSystemCallCurrentMenuTick(&ev);
+		// Restore the beep built when a menu was pushed by the quickkey above.
+		if (quickkeyPushedMenuMelody)
+		{
+			nextKeyBeepMelody = quickkeyPushedMenuMelody;
+			quickkeyPushedMenuMelody = NULL;
+			ev.keys.event = KEY_MOD_UP; // Trick to force keyBeepHandler() to set that beep
+		}
 
-			// Restore the beep built when a menu was pushed by the quickkey above.
-			if (quickkeyPushedMenuMelody)
+		// Beep sounds aren't allowed in these modes.
+		if (((nonVolatileSettings.audioPromptMode == AUDIO_PROMPT_MODE_SILENT) || voicePromptsIsPlaying()) /*|| (nonVolatileSettings.audioPromptMode == AUDIO_PROMPT_MODE_VOICE)*/)
+		{
+			if (melody_play != NULL)
 			{
-				nextKeyBeepMelody = quickkeyPushedMenuMelody;
-				quickkeyPushedMenuMelody = NULL;
-				ev.keys.event = KEY_MOD_UP; // Trick to force keyBeepHandler() to set that beep
+				soundStopMelody();
 			}
 
-			// Beep sounds aren't allowed in these modes.
-			if (((nonVolatileSettings.audioPromptMode == AUDIO_PROMPT_MODE_SILENT) || voicePromptsIsPlaying()) /*|| (nonVolatileSettings.audioPromptMode == AUDIO_PROMPT_MODE_VOICE)*/)
-			{
-				if (melody_play != NULL)
-				{
-					soundStopMelody();
-				}
-
-				(void)rxBeepsHandler(); // It will remain silent, only clearing the rxToneState bits.
-			}
-			else
+			(void)rxBeepsHandler(); // It will remain silent, only clearing the rxToneState bits.
+		}
+		else
+		{
+			if (rxBeepsHandler() == false)
 			{
-				if (rxBeepsHandler() == false)
+				if ((menuSystemGetCurrentMenuNumber() != UI_SPLASH_SCREEN) &&
+						((((key_event == EVENT_KEY_CHANGE) || (button_event == EVENT_BUTTON_CHANGE))
+								&& ((buttons & BUTTON_PTT) == 0) && (ev.keys.key != 0))
+								|| (function_event == FUNCTION_EVENT)))
 				{
-					if ((menuSystemGetCurrentMenuNumber() != UI_SPLASH_SCREEN) &&
-							((((key_event == EVENT_KEY_CHANGE) || (button_event == EVENT_BUTTON_CHANGE))
-									&& ((buttons & BUTTON_PTT) == 0) && (ev.keys.key != 0))
-									|| (function_event == FUNCTION_EVENT)))
-					{
-						keyBeepHandler(&ev, PTTToggledDown);
-					}
+					keyBeepHandler(&ev, PTTToggledDown);
 				}
 			}
+		}
 
 #if defined(PLATFORM_RD5R)
-			if (keyFunction == FUNC_TOGGLE_TORCH)
-			{
-				torchToggle();
-			}
+		if (keyFunction == FUNC_TOGGLE_TORCH)
+		{
+			torchToggle();
+		}
 #endif
 
-			// Check battery's warning/critical voltages
-			batteryChecking(&ev);
+		// Check battery's warning/critical voltages
+		batteryChecking(&ev, elapsedMs);
 
-			if (((nonVolatileSettings.backlightMode == BACKLIGHT_MODE_AUTO)
-					|| (nonVolatileSettings.backlightMode == BACKLIGHT_MODE_BUTTONS)
-					|| (nonVolatileSettings.backlightMode == BACKLIGHT_MODE_SQUELCH)) && (menuDataGlobal.lightTimer > 0))
+		if (((nonVolatileSettings.backlightMode == BACKLIGHT_MODE_AUTO)
+				|| (nonVolatileSettings.backlightMode == BACKLIGHT_MODE_BUTTONS)
+				|| (nonVolatileSettings.backlightMode == BACKLIGHT_MODE_SQUELCH)) && (menuDataGlobal.lightTimer > 0))
+		{
+			// Countdown only in (AUTO), (BUTTONS) or (SQUELCH + no audio)
+			if ((nonVolatileSettings.backlightMode == BACKLIGHT_MODE_AUTO) || (nonVolatileSettings.backlightMode == BACKLIGHT_MODE_BUTTONS) ||
+					((nonVolatileSettings.backlightMode == BACKLIGHT_MODE_SQUELCH) && ((getAudioAmpStatus() & AUDIO_AMP_MODE_RF) == 0)))
 			{
-				// Countdown only in (AUTO), (BUTTONS) or (SQUELCH + no audio)
-				if ((nonVolatileSettings.backlightMode == BACKLIGHT_MODE_AUTO) || (nonVolatileSettings.backlightMode == BACKLIGHT_MODE_BUTTONS) ||
-						((nonVolatileSettings.backlightMode == BACKLIGHT_MODE_SQUELCH) && ((getAudioAmpStatus() & AUDIO_AMP_MODE_RF) == 0)))
-				{
-					menuDataGlobal.lightTimer--;
-				}
+				menuDataGlobal.lightTimer -= (((int)elapsedMs < menuDataGlobal.lightTimer) ? (int)elapsedMs : menuDataGlobal.lightTimer);
+			}
 
-				if (menuDataGlobal.lightTimer == 0)
-				{
-					displayEnableBacklight(false, nonVolatileSettings.displayBacklightPercentageOff);
-				}
+			if (menuDataGlobal.lightTimer == 0)
+			{
+				displayEnableBacklight(false, nonVolatileSettings.displayBacklightPercentageOff);
 			}
+		}
 
-			voicePromptsTick();
-			soundTickMelody();
-			voxTick();
+		voicePromptsTick();
+		soundTickMelody();
+		voxTick();
 #if defined(HAS_GPS)
-			gpsTick();
+		gpsTick();
 #endif
 #if !defined(PLATFORM_GD77S)
-			aprsBeaconingTick(&ev);
+		aprsBeaconingTick(&ev);
 #endif
 
 #if defined(PLATFORM_RD5R) // Needed for platforms which can't control the poweroff
-			settingsSaveIfNeeded(false);
+		settingsSaveIfNeeded(false);
 #endif
 
-			if (uiNotificationHasTimedOut())
-			{
-				uiNotificationHide(true);
-			}
+		// Write back the SPI Flash cached sector, avoiding to mask the interrupts while TXing or receiving DMR
+		if ((trxTransmissionEnabled == false) && (slotState == DMR_STATE_IDLE))
+		{
+			SPI_Flash_flushIfNeeded(false);
+		}
+
+		if (uiNotificationHasTimedOut())
+		{
+			uiNotificationHide(true);
+		}
 
 #if !defined(PLATFORM_GD77S)
-			// APO checkings
-			apoTick((keyOrButtonChanged || (function_event != NO_EVENT) ||
-					(settingsIsOptionBitSet(BIT_APO_WITH_RF) ? (getAudioAmpStatus() & AUDIO_AMP_MODE_RF) : false)));
+		// APO checkings
+		apoTick((keyOrButtonChanged || (function_event != NO_EVENT) ||
+				(settingsIsOptionBitSet(BIT_APO_WITH_RF) ? (getAudioAmpStatus() & AUDIO_AMP_MODE_RF) : false)));
 
-			// Autolock trigger/reset
-			if (ticksTimerIsEnabled(&autolockTimer))
+		// Autolock trigger/reset
+		if (ticksTimerIsEnabled(&autolockTimer))
+		{
+			if (((keyOrButtonChanged || (function_event != NO_EVENT)) && (syntheticEvent == false)) || // key event resets the timer
+					((currentMenu != UI_CHANNEL_MODE) && (currentMenu != UI_VFO_MODE))) // and could only auto locks while in Channel/VFO menus
 			{
-				if (((keyOrButtonChanged || (function_event != NO_EVENT)) && (syntheticEvent == false)) || // key event resets the timer
-						((currentMenu != UI_CHANNEL_MODE) && (currentMenu != UI_VFO_MODE))) // and could only auto locks while in Channel/VFO menus
-				{
-					ticksTimerStart(&autolockTimer, (nonVolatileSettings.autolockTimer * 30000U));
-				}
-				else
+				ticksTimerStart(&autolockTimer, (nonVolatileSettings.autolockTimer * 30000U));
+			}
+			else
+			{
+				if (ticksTimerHasExpired(&autolockTimer))
 				{
-					if (ticksTimerHasExpired(&autolockTimer))
-					{
-						keypadLocked = PTTLocked = true;
-						ticksTimerReset(&autolockTimer);
-						uiNotificationShow(NOTIFICATION_TYPE_MESSAGE, NOTIFICATION_ID_MESSAGE, 1000, currentLanguage->auto_lock, true);
-					}
+					keypadLocked = PTTLocked = true;
+					ticksTimerReset(&autolockTimer);
+					uiNotificationShow(NOTIFICATION_TYPE_MESSAGE, NOTIFICATION_ID_MESSAGE, 1000, currentLanguage->auto_lock, true);
 				}
 			}
+		}
 #endif
 
-			timer_maintask = 1; // Reset PIT Counter
-		}
+		mainTaskLastTick = mainTaskTick;
 
 		if (((trxTransmissionEnabled || trxIsTransmitting) == false))
 		{
@@ -2164,7 +2237,15 @@ void mainTaskFunction(void *data)
 				rxPowerSavingTick(&ev, hasSignal);
 			}
 		}
-		vTaskDelay((0 / portTICK_PERIOD_MS));
+
+		// Block until the next tick (or, when idle, the next event or the end of the idle period), so the idle task gets to sleep the core
+		notified = ulTaskNotifyTake(pdTRUE, ((mainTaskIsIdle(buttons) ? MAIN_TASK_IDLE_PERIOD_MS : MAIN_TASK_TICK_PERIOD_MS) / portTICK_PERIOD_MS));
+
+		mainTask.Wakeups++;
+		if (notified != 0)
+		{
+			mainTask.NotifiedWakeups++;
+		}
 	}
 }
 
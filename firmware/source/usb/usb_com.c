@@ -52,6 +52,11 @@ enum CPS_ACCESS_AREA
 	CPS_ACCESS_RADIO_INFO = 9,
 #if ! defined(CPU_MK22FN512VLL12)
 	CPS_ACCESS_FLASH_SECURITY_REGISTERS = 10,
+#endif
+	CPS_ACCESS_DMRID_CACHE_STATS = 11,
+	CPS_ACCESS_TASKS_TELEMETRY = 12,
+#if defined(USING_LATENCY_PROFILER)
+	CPS_ACCESS_LATENCY_PROFILER = 13,
 #endif
 };
 
@@ -141,7 +146,7 @@ static void cpsHandleReadCommand(void)
 	switch(com_requestbuffer[1])
 	{
 		case CPS_ACCESS_FLASH:
-			result = SPI_Flash_read(address, &usbComSendBuf[3], length);
+			result = SPI_Flash_readWithPriority(address, &usbComSendBuf[3], length, SPI_FLASH_PRIORITY_BULK);
 			break;
 		case CPS_ACCESS_EEPROM:
 			result = EEPROM_Read(address, &usbComSendBuf[3], length);
@@ -219,6 +224,44 @@ static void cpsHandleReadCommand(void)
 			}
 			break;
 
+		case CPS_ACCESS_DMRID_CACHE_STATS:
+			{
+				struct __attribute__((__packed__))
+				{
+					uint32_t structVersion;
+					uint32_t hits;
+					uint32_t misses;
+					uint32_t lruSize;
+					uint32_t dbEntries;
+				} dmrIDCacheStats;
+
+				uint32_t hits, misses;
+
+				dmrIDCacheGetLRUStats(&hits, &misses);
+				dmrIDCacheStats.structVersion = 0x01;
+				dmrIDCacheStats.hits = hits;
+				dmrIDCacheStats.misses = misses;
+				dmrIDCacheStats.lruSize = DMRID_LRU_SIZE;
+				dmrIDCacheStats.dbEntries = dmrIDCacheGetCount();
+
+				length = sizeof(dmrIDCacheStats);
+				memcpy(&usbComSendBuf[3], &dmrIDCacheStats, length);
+				result = true;
+			}
+			break;
+
+		case CPS_ACCESS_TASKS_TELEMETRY:
+			length = watchdogGetTelemetry(&usbComSendBuf[3], (COM_REQUESTBUFFER_SIZE - 3));
+			result = (length > 0);
+			break;
+
+#if defined(USING_LATENCY_PROFILER)
+		case CPS_ACCESS_LATENCY_PROFILER: // address != 0: clear the statistics once read
+			length = profilerGetDump(&usbComSendBuf[3], (COM_REQUESTBUFFER_SIZE - 3), (address != 0));
+			result = (length > 0);
+			break;
+#endif
+
 #if ! defined(CPU_MK22FN512VLL12)
 		case CPS_ACCESS_FLASH_SECURITY_REGISTERS:
 			TASK_UNLOCK_WRITE();
@@ -260,9 +303,10 @@ static void cpsHandleWriteCommand(void)
 				if ((sector * 4096) == 0x30000) // start address of DMRIDs DB
 				{
 					flashingDMRIDs = true;
+					dmrIDCacheClear(); // The DB is being rewritten, forget about the index and recently looked up IDs
 				}
 
-				ok = SPI_Flash_read(sector * 4096, SPI_Flash_sectorbuffer, 4096);
+				ok = SPI_Flash_readWithPriority(sector * 4096, SPI_Flash_sectorbuffer, 4096, SPI_FLASH_PRIORITY_BULK);
 			}
 			break;
 
@@ -681,6 +725,9 @@ static void cpsHandleCommand(void)
 								break;
 							}
 						}
+						TASK_UNLOCK_WRITE();
+						SPI_Flash_flushIfNeeded(true);
+						TASK_LOCK_WRITE();
 						watchdogReboot();
 					break;
 					case 1:
@@ -690,6 +737,9 @@ static void cpsHandleCommand(void)
 							nonVolatileSettings.gps = previousGPSState;
 						}
 #endif
+						TASK_UNLOCK_WRITE();
+						SPI_Flash_flushIfNeeded(true);
+						TASK_LOCK_WRITE();
 						watchdogReboot();
 						break;
 					case 2:
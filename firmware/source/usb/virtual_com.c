@@ -233,6 +233,7 @@ usb_status_t USB_DeviceCdcVcomCallback(class_handle_t handle, uint32_t event, vo
         				if (com_request == 0)
         				{
         					com_request = 1;
+        					mainTaskWakeUpFromISR();
         				}
         			}
         			s_receivingBufferOffset = 0;
@@ -290,6 +291,7 @@ usb_status_t USB_DeviceCdcVcomCallback(class_handle_t handle, uint32_t event, vo
         					if ((s_receivingBufferOffset + recvSize) > sizeof(com_requestbuffer))
         					{
         						com_request = 1;
+        						mainTaskWakeUpFromISR();
         						s_receivingBufferOffset = 0;
         						s_recvCount = 0;
 
@@ -419,6 +421,7 @@ usb_status_t USB_DeviceCdcVcomCallback(class_handle_t handle, uint32_t event, vo
         							s_receivingBufferOffset = 0;
         							s_recvCount = 0;
         							com_request = 1;
+        							mainTaskWakeUpFromISR();
         						}
         						else
         						{
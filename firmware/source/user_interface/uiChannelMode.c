@@ -32,6 +32,8 @@
 #include "user_interface/uiLocalisation.h"
 #include "functions/voicePrompts.h"
 #include "functions/rxPowerSaving.h"
+#include "functions/channelDistance.h"
+#include "functions/scanTable.h"
 
 
 #if defined(HAS_COLOURS)
@@ -40,12 +42,6 @@
 #define NAME_BUFFER_LEN   22
 #endif
 
-typedef struct
-{
-	uint16_t index;
-	int32_t	 distance;
-} channelDistance_t;
-
 #if defined(PLATFORM_GD77S)
 typedef enum
 {
@@ -103,25 +99,47 @@ static void scanStart(bool longPressBeep);
 static void scanSearchForNextChannel(void);
 static void scanApplyNextChannel(void);
 static void scanStop(bool loadChannel);
+static void scanTableLoadEntry(int position, int index, ChannelFlag_t skipFlag);
+static void scanTableFillAllChannels(int fromIndex, int direction);
+static void scanTableApplyNuisanceList(void);
+static void scanTuneFromTable(const scanTableEntry_t *entry);
+static void scanLoadCurrentChannel(void);
 static void updateTrxID(void);
 static void initSortedChannels(void);
+static bool channelGetLocation(struct_codeplugChannel_t *channelData, double *latitude, double *longitude);
+static bool zoneChannelLocationsAreValid(void);
 
 static char currentZoneName[SCREEN_LINE_BUFFER_SIZE];
 static int directChannelNumber = 0;
 
-static struct_codeplugChannel_t scanNextChannelData = { .rxFreq = 0 };
+static struct_codeplugChannel_t scanChannelData = { .rxFreq = 0 }; // Only used to fill the scan table
 static bool scanNextChannelReady = false;
-static int scanNextChannelIndex = 0;
+static int scanNextChannelIndex = 0; // Zone position, or channel index in the All Channels zone
+// Scan table of the current zone, built by canCurrentZoneBeScanned() (entry N: zone position N, or a window of the All Channels zone)
+__attribute__((section(".data.$RAM2"))) static scanTableEntry_t scanTable[SCAN_TABLE_SIZE];
+static int scanTableCount = 0;
+static bool scanTableIsWindow = false; // All Channels zone larger than the table, it only holds the channels following (or preceding) the one it was filled from
+static int scanTableWindowFrom = 0;
+static int scanTableWindowDirection = 1;
+static uint32_t scanTableRevision = 0;
+static bool scanTableIsValid = false;// Cleared when currentZone is reloaded or re-sorted, as the entries are stored by zone position
+static bool scanChannelIsPartial = false; // Channel tuned from the scan table, only the RX settings are set in channelScreenChannelData
 static bool scobAlreadyTriggered = false;
 static bool quickmenuChannelFromVFOHandled = false; // Quickmenu new channel confirmation window
 
+// Locations of the current zone channels (in zone order), and their order by distance, kept to re-sort the zone without reading the codeplug
+__attribute__((section(".data.$RAM2"))) static channelLocation_t zoneChannelLocations[80];
+__attribute__((section(".data.$RAM2"))) static uint16_t zoneChannelLocationsOrder[80];
+static uint16_t zoneChannelLocationsCount = 0;
+static uint32_t zoneChannelLocationsRevision = 0;
+
 static menuStatus_t menuChannelExitStatus = MENU_STATUS_SUCCESS;
 static menuStatus_t menuQuickChannelExitStatus = MENU_STATUS_SUCCESS;
 
 
-static void checkChannelLocation(struct_codeplugChannel_t *channelData)
+static bool channelGetLocation(struct_codeplugChannel_t *channelData, double *latitude, double *longitude)
 {
-	if (nonVolatileSettings.locationLat != SETTINGS_UNITIALISED_LOCATION_LAT && codeplugChannelGetFlag(channelData, CHANNEL_FLAG_USE_LOCATION))
+	if (codeplugChannelGetFlag(channelData, CHANNEL_FLAG_USE_LOCATION))
 	{
 		uint32_t tmp1 = channelData->locationLat2;
 		tmp1 = (tmp1 << 8) + channelData->locationLat1;
@@ -135,15 +153,27 @@ static void checkChannelLocation(struct_codeplugChannel_t *channelData)
 
 			if (tmp2 != 0)
 			{
-				double lat = latLongFixed24ToDouble(tmp1);
-				double lon = latLongFixed24ToDouble(tmp2);
-
-				channelData->NOT_IN_CODEPLUG_CALCULATED_DISTANCE_X10 = distanceToLocation(lat, lon) * 10;
-				return;
+				*latitude = latLongFixed24ToDouble(tmp1);
+				*longitude = latLongFixed24ToDouble(tmp2);
+				return true;
 			}
 		}
 	}
 
+	return false;
+}
+
+static void checkChannelLocation(struct_codeplugChannel_t *channelData)
+{
+	double lat;
+	double lon;
+
+	if ((nonVolatileSettings.locationLat != SETTINGS_UNITIALISED_LOCATION_LAT) && channelGetLocation(channelData, &lat, &lon))
+	{
+		channelData->NOT_IN_CODEPLUG_CALCULATED_DISTANCE_X10 = distanceToLocation(lat, lon) * 10;
+		return;
+	}
+
 	channelData->NOT_IN_CODEPLUG_CALCULATED_DISTANCE_X10 = -1;
 }
 
@@ -369,51 +399,114 @@ static void hidesChannelDetails(void)
 	}
 }
 
+static void scanTableLoadEntry(int position, int index, ChannelFlag_t skipFlag)
+{
+	codeplugChannelGetDataForIndex(index, &scanChannelData);
+	scanTableSetEntry(&scanTable[position], index, &scanChannelData, (codeplugChannelGetFlag(&scanChannelData, skipFlag) != 0));
+
+#if defined(PLATFORM_MD9600)
+	// Out of band channels are handled by uiChannelModeLoadChannelData()
+	if ((trxGetBandFromFrequency(scanChannelData.rxFreq) == FREQUENCY_OUT_OF_BAND) || (trxGetBandFromFrequency(scanChannelData.txFreq) == FREQUENCY_OUT_OF_BAND))
+	{
+		scanTable[position].flags |= SCAN_TABLE_FLAG_NEEDS_RECORD;
+	}
+#endif
+}
+
+// Fills the table with the channels following (or preceding) fromIndex, in channel order.
+// When the whole zone fits in the table, fromIndex ends up in its last entry.
+static void scanTableFillAllChannels(int fromIndex, int direction)
+{
+	int count = SAFE_MIN(currentZone.NOT_IN_CODEPLUGDATA_numChannelsInZone, SCAN_TABLE_SIZE);
+	int chanIdx = fromIndex;
+
+	for (int i = 0; i < count; i++)
+	{
+		chanIdx = ((direction == 1) ? codeplugAllChannelsGetNextInUse(chanIdx) : codeplugAllChannelsGetPreviousInUse(chanIdx));
+
+		scanTableLoadEntry(((direction == 1) ? i : (count - 1 - i)), chanIdx, CHANNEL_FLAG_ALL_SKIP);
+	}
+
+	scanTableCount = count;
+	scanTableWindowFrom = fromIndex;
+	scanTableWindowDirection = direction;
+	scanTableApplyNuisanceList();
+}
+
+static void scanTableApplyNuisanceList(void)
+{
+	for (int i = 0; i < MAX_ZONE_SCAN_NUISANCE_CHANNELS; i++)
+	{
+		if (uiDataGlobal.Scan.nuisanceDelete[i] == -1)
+		{
+			break;
+		}
+
+		scanTableSetNuisance(scanTable, scanTableCount, uiDataGlobal.Scan.nuisanceDelete[i]);
+	}
+}
+
 static bool canCurrentZoneBeScanned(int *availableChannels)
 {
 	int enabledChannels = 0;
-	int chanIdx = codeplugGetLastUsedChannelNumberInCurrentZone();
+
+	scanTableCount = 0;
+	scanTableIsWindow = false;
+	scanTableRevision = codeplugChannelsGetRevision();
+	scanTableIsValid = true;
 
 	if (currentZone.NOT_IN_CODEPLUGDATA_numChannelsInZone > 1)
 	{
-		int chansInZone = currentZone.NOT_IN_CODEPLUGDATA_numChannelsInZone;
-
 		if (CODEPLUG_ZONE_IS_ALLCHANNELS(currentZone))
 		{
-			do
+			int chanIdx = codeplugGetLastUsedChannelNumberInCurrentZone();
+
+			if (currentZone.NOT_IN_CODEPLUGDATA_numChannelsInZone > SCAN_TABLE_SIZE)
 			{
+				int chansInZone = currentZone.NOT_IN_CODEPLUGDATA_numChannelsInZone;
+				int nextIdx = chanIdx;
+
+				// Too many channels for the table, only count the scannable ones here, the table follows the scan through the zone
 				do
 				{
-					chanIdx = ((chanIdx % currentZone.NOT_IN_CODEPLUGDATA_highestIndex) + 1);
-				} while (!codeplugAllChannelsIndexIsInUse(chanIdx));
+					nextIdx = codeplugAllChannelsGetNextInUse(nextIdx);
 
-				chansInZone--;
-				// Get flag4 only
-				codeplugChannelGetDataWithOffsetAndLengthForIndex(chanIdx, &scanNextChannelData, CODEPLUG_CHANNEL_FLAG4_OFFSET, 1);
+					chansInZone--;
+					// Get flag4 only
+					codeplugChannelGetDataWithOffsetAndLengthForIndex(nextIdx, &scanChannelData, CODEPLUG_CHANNEL_FLAG4_OFFSET, 1);
 
-				if (codeplugChannelGetFlag(&scanNextChannelData, CHANNEL_FLAG_ALL_SKIP) == 0)
-				{
-					enabledChannels++;
-				}
+					if (codeplugChannelGetFlag(&scanChannelData, CHANNEL_FLAG_ALL_SKIP) == 0)
+					{
+						enabledChannels++;
+					}
+
+				} while (chansInZone > 0);
 
-			} while (chansInZone > 0);
+				scanTableIsWindow = true;
+			}
+
+			scanTableFillAllChannels(chanIdx, 1);
 		}
 		else
 		{
-			do
+			for (int i = 0; i < currentZone.NOT_IN_CODEPLUGDATA_numChannelsInZone; i++)
 			{
-				chanIdx = ((chanIdx + 1) % currentZone.NOT_IN_CODEPLUGDATA_numChannelsInZone);
+				scanTableLoadEntry(i, currentZone.channels[i], CHANNEL_FLAG_ZONE_SKIP);
+			}
 
-				chansInZone--;
-				// Get flag4 only
-				codeplugChannelGetDataWithOffsetAndLengthForIndex(currentZone.channels[chanIdx], &scanNextChannelData, CODEPLUG_CHANNEL_FLAG4_OFFSET, 1);
+			scanTableCount = currentZone.NOT_IN_CODEPLUGDATA_numChannelsInZone;
+			scanTableApplyNuisanceList();
+		}
 
-				if (codeplugChannelGetFlag(&scanNextChannelData, CHANNEL_FLAG_ZONE_SKIP) == 0)
+		if (scanTableIsWindow == false)
+		{
+			for (int i = 0; i < scanTableCount; i++)
+			{
+				if ((scanTable[i].flags & SCAN_TABLE_FLAG_SKIP) == 0)
 				{
 					enabledChannels++;
 				}
-
-			} while (chansInZone > 0);
+			}
 		}
 	}
 
@@ -424,77 +517,135 @@ static bool canCurrentZoneBeScanned(int *availableChannels)
 
 static void scanSearchForNextChannel(void)
 {
-	int channel = 0;
+	int position;
+
+	// A channel or the zone has been edited, or the zone reloaded, since the scan table was built
+	if ((scanTableIsValid == false) || (scanTableRevision != codeplugChannelsGetRevision()))
+	{
+		canCurrentZoneBeScanned(&uiDataGlobal.Scan.availableChannelsCount);
+	}
 
-	// All Channels virtual zone
+	// The skipped and nuisance deleted channels are flagged in the table, no codeplug access is needed to find the next channel
 	if (CODEPLUG_ZONE_IS_ALLCHANNELS(currentZone))
 	{
-		do
+		position = scanTableFindIndex(scanTable, scanTableCount, scanNextChannelIndex);
+
+		if (scanTableIsWindow)
 		{
-			do
+			int fills = ((currentZone.NOT_IN_CODEPLUGDATA_numChannelsInZone + SCAN_TABLE_SIZE - 1) / SCAN_TABLE_SIZE);
+
+			if (position == -1)
 			{
-				// rollover (up/down) CODEPLUG_CHANNELS_MIN .. currentZone.NOT_IN_CODEPLUGDATA_highestIndex
-				scanNextChannelIndex = ((uiDataGlobal.Scan.direction == 1) ?
-						((scanNextChannelIndex % currentZone.NOT_IN_CODEPLUGDATA_highestIndex) + 1) :
-						((((scanNextChannelIndex - 1) + currentZone.NOT_IN_CODEPLUGDATA_highestIndex - 1) % currentZone.NOT_IN_CODEPLUGDATA_highestIndex) + 1));
-			} while (!codeplugAllChannelsIndexIsInUse(scanNextChannelIndex));
+				// The window has been filled from this channel in the other direction, or the channel has been picked outside of it
+				if ((scanNextChannelIndex != scanTableWindowFrom) || (uiDataGlobal.Scan.direction != scanTableWindowDirection))
+				{
+					scanTableFillAllChannels(scanNextChannelIndex, uiDataGlobal.Scan.direction);
+				}
 
-			// Check if the channel is skipped.
-			// Get flag4 only
-			codeplugChannelGetDataWithOffsetAndLengthForIndex(scanNextChannelIndex, &scanNextChannelData, CODEPLUG_CHANNEL_FLAG4_OFFSET, 1);
+				position = ((uiDataGlobal.Scan.direction == 1) ? -1 : scanTableCount);
+			}
 
-		} while ((codeplugChannelGetFlag(&scanNextChannelData, CHANNEL_FLAG_ALL_SKIP) != 0));
+			// Fill the next window from the last channel of the current one, until a scannable channel is found
+			while (((position = scanTableFindNext(scanTable, scanTableCount, position, uiDataGlobal.Scan.direction, false)) == -1) && (fills-- > 0))
+			{
+				scanTableFillAllChannels(scanTable[((uiDataGlobal.Scan.direction == 1) ? (scanTableCount - 1) : 0)].index, uiDataGlobal.Scan.direction);
+				position = ((uiDataGlobal.Scan.direction == 1) ? -1 : scanTableCount);
+			}
+		}
+		else
+		{
+			position = scanTableFindNext(scanTable, scanTableCount, position, uiDataGlobal.Scan.direction, true);
+		}
 
-		channel = scanNextChannelIndex;
-		codeplugChannelGetDataForIndex(scanNextChannelIndex, &scanNextChannelData);
+		if (position != -1)
+		{
+			scanNextChannelIndex = scanTable[position].index;
+		}
 	}
 	else
 	{
-		do
+		position = scanTableFindNext(scanTable, scanTableCount, scanNextChannelIndex, uiDataGlobal.Scan.direction, true);
+
+		if (position != -1)
 		{
-			// rollover (up/down) 0 .. (currentZone.NOT_IN_CODEPLUGDATA_highestIndex - 1)
-			scanNextChannelIndex = ((uiDataGlobal.Scan.direction == 1) ?
-					((scanNextChannelIndex + 1) % currentZone.NOT_IN_CODEPLUGDATA_numChannelsInZone) :
-					((scanNextChannelIndex + currentZone.NOT_IN_CODEPLUGDATA_numChannelsInZone - 1) % currentZone.NOT_IN_CODEPLUGDATA_numChannelsInZone));
+			scanNextChannelIndex = position;
+		}
+	}
 
-			// Check if the channel is skipped.
-			// Get flag4 only
-			codeplugChannelGetDataWithOffsetAndLengthForIndex(currentZone.channels[scanNextChannelIndex], &scanNextChannelData, CODEPLUG_CHANNEL_FLAG4_OFFSET, 1);
+	// Nothing left to scan, stay on the current channel
+	if (position == -1)
+	{
+		return;
+	}
 
-		} while ((codeplugChannelGetFlag(&scanNextChannelData, CHANNEL_FLAG_ZONE_SKIP) != 0));
+	scanNextChannelReady = true;
+}
 
-		channel = currentZone.channels[scanNextChannelIndex];
-		codeplugChannelGetDataForIndex(currentZone.channels[scanNextChannelIndex], &scanNextChannelData);
-	}
+// Tunes the receiver from a scan table entry. The channel record is read once a signal is found, or when the scan stops,
+// until then channelScreenChannelData is an RX only channel named after its frequency.
+static void scanTuneFromTable(const scanTableEntry_t *entry)
+{
+	char buffer[SCREEN_LINE_BUFFER_SIZE];
+	int val_before_dp = entry->rxFreq / 100000;
+	int val_after_dp = entry->rxFreq - val_before_dp * 100000;
+
+	uiDataGlobal.currentSelectedChannelNumber = entry->index;
+
+	memset(&channelScreenChannelData, 0x00, sizeof(struct_codeplugChannel_t));
+	snprintf(buffer, SCREEN_LINE_BUFFER_SIZE, "%d.%05d MHz", val_before_dp, val_after_dp);
+	codeplugUtilConvertStringToBuf(buffer, (char *)&channelScreenChannelData.name, 16);
+	channelScreenChannelData.chMode = entry->chMode;
+	channelScreenChannelData.rxFreq = entry->rxFreq;
+	channelScreenChannelData.rxTone = entry->rxTone;
+	channelScreenChannelData.txTone = CODEPLUG_CSS_TONE_NONE;
+	channelScreenChannelData.txColor = entry->colourCode;
+	channelScreenChannelData.sql = entry->sql;
+	channelScreenChannelData.flag4 = CODEPLUG_CHANNEL_FLAG4_RX_ONLY;
+	codeplugChannelSetFlag(&channelScreenChannelData, CHANNEL_FLAG_BW_25K, (((entry->flags & SCAN_TABLE_FLAG_BW_25K) != 0) ? 1 : 0));
+	codeplugChannelSetFlag(&channelScreenChannelData, CHANNEL_FLAG_TIMESLOT_TWO, (((entry->flags & SCAN_TABLE_FLAG_TIMESLOT_TWO) != 0) ? 1 : 0));
+	channelScreenChannelData.NOT_IN_CODEPLUG_CALCULATED_DISTANCE_X10 = -1;
+	scanChannelIsPartial = true;
 
-	//check all nuisance delete entries and skip channel if there is a match
-	for (int i = 0; i < MAX_ZONE_SCAN_NUISANCE_CHANNELS; i++)
+	HRC6000ClearActiveDMRID();
+
+	trxSetFrequency(entry->rxFreq, entry->rxFreq, (((entry->flags & SCAN_TABLE_FLAG_DMO) != 0) ? DMR_MODE_DMO : DMR_MODE_RMO));
+	trxSetModeAndBandwidth(entry->chMode, ((entry->flags & SCAN_TABLE_FLAG_BW_25K) != 0));
+
+	if (entry->chMode == RADIO_MODE_ANALOG)
 	{
-		if (uiDataGlobal.Scan.nuisanceDelete[i] == -1)
-		{
-			break;
-		}
-		else
-		{
-			if(uiDataGlobal.Scan.nuisanceDelete[i] == channel)
-			{
-				return;
-			}
-		}
+		trxSetRxCSS(entry->rxTone);
 	}
+	else
+	{
+		int8_t overriddenTS = tsGetManualOverrideFromCurrentChannel();
 
-	scanNextChannelReady = true;
+		trxSetDMRColourCode(entry->colourCode);
+		HRC6000ClearColorCodeSynchronisation();
+
+		// The contact TS override is applied when the channel is loaded
+		trxSetDMRTimeSlot(((overriddenTS != 0) ? (overriddenTS - 1) : (((entry->flags & SCAN_TABLE_FLAG_TIMESLOT_TWO) != 0) ? 1 : 0)), false);
+	}
 }
 
 static void scanApplyNextChannel(void)
 {
+	int position = (CODEPLUG_ZONE_IS_ALLCHANNELS(currentZone) ? scanTableFindIndex(scanTable, scanTableCount, scanNextChannelIndex) : scanNextChannelIndex);
+
 	codeplugSetLastUsedChannelInZone(currentZone.NOT_IN_CODEPLUGDATA_indexNumber, scanNextChannelIndex);
 
 	lastHeardClearLastID();
 
-	memcpy(&channelScreenChannelData, &scanNextChannelData, CODEPLUG_CHANNEL_DATA_STRUCT_SIZE);
+	// The channel could also have been picked with the keys, while paused
+	if (scanTableIsValid && (scanTableRevision == codeplugChannelsGetRevision()) && (position >= 0) && (position < scanTableCount) &&
+			((scanTable[position].flags & SCAN_TABLE_FLAG_NEEDS_RECORD) == 0) && (uiDataGlobal.reverseRepeaterChannel == false))
+	{
+		scanTuneFromTable(&scanTable[position]);
+	}
+	else
+	{
+		uiChannelModeLoadChannelData(false, false);
+	}
 
-	uiChannelModeLoadChannelData(true, false);
 	uiDataGlobal.displayQSOState = QSO_DISPLAY_DEFAULT_SCREEN;
 	uiChannelModeUpdateScreen(0);
 
@@ -531,6 +682,13 @@ void uiChannelModeLoadChannelData(bool useChannelDataInMemory, bool loadVoicePro
 #endif
 	int previousSelectedChannelNumber = uiDataGlobal.currentSelectedChannelNumber;
 
+	// Only tuned from the scan table, the channel record has to be read
+	if (scanChannelIsPartial)
+	{
+		useChannelDataInMemory = false;
+		scanChannelIsPartial = false;
+	}
+
 	uiDataGlobal.currentSelectedChannelNumber = codeplugGetLastUsedChannelNumberInCurrentZone();
 
 	if (!useChannelDataInMemory)
@@ -827,7 +985,8 @@ void uiChannelModeUpdateScreen(int txTimeSecs)
 				uiUtilityDisplayInformation(nameBuf, ((uiDataGlobal.reverseRepeaterChannel == true) ? DISPLAY_INFO_CHANNEL_INVERTED : DISPLAY_INFO_CHANNEL), (trxTransmissionEnabled ? DISPLAY_Y_POS_CHANNEL_SECOND_LINE : -1));
 			}
 
-			if (trxGetMode() == RADIO_MODE_DIGITAL)
+			// The contact isn't known yet while the scan hops from the scan table
+			if ((trxGetMode() == RADIO_MODE_DIGITAL) && (scanChannelIsPartial == false))
 			{
 				if (!uiDataGlobal.displayChannelSettings)
 				{
@@ -894,6 +1053,7 @@ static void handleEvent(uiEvent_t *ev)
 				}
 
 				uiDataGlobal.Scan.nuisanceDelete[uiDataGlobal.Scan.nuisanceDeleteIndex] = uiDataGlobal.currentSelectedChannelNumber;
+				scanTableSetNuisance(scanTable, scanTableCount, uiDataGlobal.currentSelectedChannelNumber);
 				uiDataGlobal.Scan.nuisanceDeleteIndex = (uiDataGlobal.Scan.nuisanceDeleteIndex + 1) % MAX_ZONE_SCAN_NUISANCE_CHANNELS;
 				uiDataGlobal.Scan.timer.timeout = SCAN_SKIP_CHANNEL_INTERVAL;	//force scan to continue;
 				uiDataGlobal.Scan.state = SCAN_STATE_SCANNING;
@@ -1647,11 +1807,7 @@ static void handleUpKey(uiEvent_t *ev)
 				nextChan = codeplugGetLastUsedChannelInCurrentZone();
 
 				// All Channels virtual zone
-				do
-				{
-					nextChan = ((nextChan % currentZone.NOT_IN_CODEPLUGDATA_highestIndex) + 1);
-
-				} while (!codeplugAllChannelsIndexIsInUse(nextChan));
+				nextChan = codeplugAllChannelsGetNextInUse(nextChan);
 
 				if (codeplugSetLastUsedChannelInZone(currentZone.NOT_IN_CODEPLUGDATA_indexNumber, nextChan) == CODEPLUG_CHANNELS_MIN)
 				{
@@ -1734,11 +1890,7 @@ static void handleDownKey(uiEvent_t *ev)
 				prevChan = codeplugGetLastUsedChannelInCurrentZone();
 
 				// All Channels virtual zone
-				do
-				{
-					prevChan = ((((prevChan - 1) + currentZone.NOT_IN_CODEPLUGDATA_highestIndex - 1) % currentZone.NOT_IN_CODEPLUGDATA_highestIndex) + 1);
-
-				} while (!codeplugAllChannelsIndexIsInUse(prevChan));
+				prevChan = codeplugAllChannelsGetPreviousInUse(prevChan);
 
 				if (codeplugSetLastUsedChannelInZone(currentZone.NOT_IN_CODEPLUGDATA_indexNumber, prevChan) == CODEPLUG_CHANNELS_MIN)
 				{
@@ -2359,6 +2511,13 @@ static void handleQuickMenuEvent(uiEvent_t *ev)
 //Scan Mode
 static void scanStart(bool longPressBeep)
 {
+	// Clear all nuisance delete channels at start of scanning (before the scan table is built, as they are flagged in it)
+	for (int i = 0; i < MAX_ZONE_SCAN_NUISANCE_CHANNELS; i++)
+	{
+		uiDataGlobal.Scan.nuisanceDelete[i] = -1;
+	}
+	uiDataGlobal.Scan.nuisanceDeleteIndex = 0;
+
 	// At least two channels are needed to run a scan process.
 	if (canCurrentZoneBeScanned(&uiDataGlobal.Scan.availableChannelsCount) == false)
 	{
@@ -2375,13 +2534,6 @@ static void scanStart(bool longPressBeep)
 	uiDataGlobal.Scan.direction = 1;
 	uiDataGlobal.talkaround = false;
 
-	// Clear all nuisance delete channels at start of scanning
-	for (int i = 0; i < MAX_ZONE_SCAN_NUISANCE_CHANNELS; i++)
-	{
-		uiDataGlobal.Scan.nuisanceDelete[i] = -1;
-	}
-	uiDataGlobal.Scan.nuisanceDeleteIndex = 0;
-
 	uiDataGlobal.Scan.active = true;
 	uiDataGlobal.Scan.state = SCAN_STATE_SCANNING;
 	uiDataGlobal.Scan.lastIteration = false;
@@ -2418,8 +2570,8 @@ static void scanStart(bool longPressBeep)
 		soundSetMelody(MELODY_KEY_LONG_BEEP);
 	}
 
-	// Set current channel index
-	scanNextChannelIndex = codeplugGetLastUsedChannelNumberInCurrentZone();
+	// Set current zone position (channel index in the All Channels zone)
+	scanNextChannelIndex = codeplugGetLastUsedChannelInCurrentZone();
 	scanNextChannelReady = false;
 }
 
@@ -2480,13 +2632,7 @@ static void scanning(void)
 					uiDataGlobal.Scan.clickDiscriminator = CLICK_DISCRIMINATOR;
 #endif
 
-#if ! defined(PLATFORM_GD77S) // GD77S handle voice prompts on its own
-					// Reload the channel as voice prompts aren't set while scanning
-					if (nonVolatileSettings.audioPromptMode >= AUDIO_PROMPT_MODE_VOICE_THRESHOLD)
-					{
-						uiChannelModeLoadChannelData(false, true);
-					}
-#endif
+					scanLoadCurrentChannel();
 					uiDataGlobal.displayQSOState = QSO_DISPLAY_DEFAULT_SCREEN; // Force screen refresh
 					uiDataGlobal.Scan.timer.timeout = ((TIMESLOT_DURATION * 12) + TIMESLOT_DURATION) * 4; // (1 superframe + 1 TS) * 4 = TS Sync + incoming audio
 				}
@@ -2495,13 +2641,7 @@ static void scanning(void)
 			{
 				if(trxCarrierDetected())
 				{
-#if ! defined(PLATFORM_GD77S) // GD77S handle voice prompts on its own
-					// Reload the channel as voice prompts aren't set while scanning
-					if (nonVolatileSettings.audioPromptMode >= AUDIO_PROMPT_MODE_VOICE_THRESHOLD)
-					{
-						uiChannelModeLoadChannelData(false, true);
-					}
-#endif
+					scanLoadCurrentChannel();
 					uiDataGlobal.displayQSOState = QSO_DISPLAY_DEFAULT_SCREEN; // Force screen refresh
 
 					if (((nonVolatileSettings.dmrCcTsFilter & DMR_TS_FILTER_PATTERN) == 0))
@@ -2524,13 +2664,7 @@ static void scanning(void)
 		{
 			if(trxCarrierDetected())
 			{
-#if ! defined(PLATFORM_GD77S) // GD77S handle voice prompts on its own
-				// Reload the channel as voice prompts aren't set while scanning
-				if (nonVolatileSettings.audioPromptMode >= AUDIO_PROMPT_MODE_VOICE_THRESHOLD)
-				{
-					uiChannelModeLoadChannelData(false, true);
-				}
-#endif
+				scanLoadCurrentChannel();
 				uiDataGlobal.displayQSOState = QSO_DISPLAY_DEFAULT_SCREEN; // Force screen refresh
 
 				uiDataGlobal.Scan.timer.timeout = SCAN_SHORT_PAUSE_TIME;	//start short delay to allow full detection of signal
@@ -2650,13 +2784,24 @@ void uiChannelModeStopScanning(void)
 	uiDataGlobal.Scan.active = false;
 	uiDataGlobal.displayQSOState = QSO_DISPLAY_DEFAULT_SCREEN; // Force screen refresh
 
+	scanLoadCurrentChannel();
+}
+
+// Reload the channel as voice prompts aren't set while scanning, and as the hop may only have tuned the receiver from the scan table
+static void scanLoadCurrentChannel(void)
+{
 #if ! defined(PLATFORM_GD77S) // GD77S handle voice prompts on its own
-	// Reload the channel as voice prompts aren't set while scanning
 	if (nonVolatileSettings.audioPromptMode >= AUDIO_PROMPT_MODE_VOICE_THRESHOLD)
 	{
 		uiChannelModeLoadChannelData(false, true);
+		return;
 	}
 #endif
+
+	if (scanChannelIsPartial)
+	{
+		uiChannelModeLoadChannelData(false, false);
+	}
 }
 
 bool uiChannelModeIsScanning(void)
@@ -2674,6 +2819,7 @@ void uiChannelInitializeCurrentZone(void)
 {
 	codeplugZoneGetDataForNumber(nonVolatileSettings.currentZone, &currentZone);
 	codeplugUtilConvertBufToString(currentZone.name, currentZoneName, 16);// need to convert to zero terminated string
+	scanTableIsValid = false;
 
 	if (settingsIsOptionBitSet(BIT_SORT_CHANNEL_DISTANCE) &&
 			(nonVolatileSettings.locationLat != SETTINGS_UNITIALISED_LOCATION_LAT) &&
@@ -2683,84 +2829,66 @@ void uiChannelInitializeCurrentZone(void)
 	}
 }
 
-static void quicksortChannelByDistance(channelDistance_t *channelDistances, uint16_t first, uint16_t last)
+static bool zoneChannelLocationsAreValid(void)
 {
-	channelDistance_t temp;
-	uint16_t i, j, pivot;
-
-	if(first < last)
+	if ((zoneChannelLocationsCount != currentZone.NOT_IN_CODEPLUGDATA_highestIndex) || (zoneChannelLocationsRevision != codeplugChannelsGetRevision()))
 	{
-		pivot = first;
-		i = first;
-		j = last;
-
-		while (i < j)
-		{
-			while ((channelDistances[i].distance <= channelDistances[pivot].distance) && (i < last))
-			{
-				i++;
-			}
-
-			while (channelDistances[j].distance > channelDistances[pivot].distance)
-			{
-				j--;
-			}
-
-			if (i < j)
-			{
-				memcpy(&temp, &channelDistances[i], sizeof(channelDistance_t));
-				memcpy(&channelDistances[i], &channelDistances[j], sizeof(channelDistance_t));
-				memcpy(&channelDistances[j], &temp, sizeof(channelDistance_t));
-			}
-		}
-
-		memcpy(&temp, &channelDistances[pivot], sizeof(channelDistance_t));
-		memcpy(&channelDistances[pivot], &channelDistances[j], sizeof(channelDistance_t));
-		memcpy(&channelDistances[j], &temp, sizeof(channelDistance_t));
+		return false;
+	}
 
-		if (j > 0)
+	for (uint16_t i = 0; i < zoneChannelLocationsCount; i++)
+	{
+		if (zoneChannelLocations[i].index != currentZone.channels[i])
 		{
-			quicksortChannelByDistance(channelDistances, first, (j - 1));
+			return false;
 		}
-
-		quicksortChannelByDistance(channelDistances, (j + 1), last);
 	}
+
+	return true;
 }
 
 static void initSortedChannels(void)
 {
 	if (currentZone.NOT_IN_CODEPLUGDATA_numChannelsInZone > 0)
 	{
-		channelDistance_t channelDistances[80];// Temporary storage while sorting a zone
-		struct_codeplugChannel_t channelData;
+		uint64_t distances[80];// Squared chord length (Q58) from the current location, in zone order
+		int32_t ownPosition[3];
+		bool locationsAreValid = zoneChannelLocationsAreValid();
 
-		for (uint16_t i = 0; i < currentZone.NOT_IN_CODEPLUGDATA_highestIndex; i++)
+		if (locationsAreValid == false)
 		{
-			channelDistances[i].index = currentZone.channels[i];
-
-			codeplugChannelGetDataForIndex(channelDistances[i].index, &channelData);
-			checkChannelLocation(&channelData);
+			struct_codeplugChannel_t channelData;
+			double lat;
+			double lon;
 
-			if ((channelData.NOT_IN_CODEPLUG_CALCULATED_DISTANCE_X10 != -1) && (channelData.NOT_IN_CODEPLUG_CALCULATED_DISTANCE_X10 < 65535))
+			// Read every channel once, then the zone can be re-sorted, for any new location, from the cached positions
+			for (uint16_t i = 0; i < currentZone.NOT_IN_CODEPLUGDATA_highestIndex; i++)
 			{
-				channelDistances[i].distance = channelData.NOT_IN_CODEPLUG_CALCULATED_DISTANCE_X10;
-			}
-			else
-			{
-				// Use large positive value for any channel which does not have a location, so that is sorted to be at the end of the list
-				// Max real value is the radius of the Earth at the equator 40,075
-				// This value is in steps of 0.1km   hence 50,000 * 10 is outside of the actual possible range and is used to indicate a channel with no location
-				// the index value is added so that each channel with no location, is sorted correctly to retain its position in the zone, relatative to the other channels with no location
+				zoneChannelLocations[i].index = currentZone.channels[i];
+
+				codeplugChannelGetDataForIndex(currentZone.channels[i], &channelData);
+
+				if (channelGetLocation(&channelData, &lat, &lon))
+				{
+					channelDistancePositionFromLatLong(lat, lon, zoneChannelLocations[i].position);
+				}
+				else
+				{
+					memset(zoneChannelLocations[i].position, 0x00, sizeof(zoneChannelLocations[i].position));
+				}
 
-				channelDistances[i].distance = (500000 + i);
 			}
+
+			zoneChannelLocationsCount = currentZone.NOT_IN_CODEPLUGDATA_highestIndex;
+			zoneChannelLocationsRevision = codeplugChannelsGetRevision();
 		}
 
-		quicksortChannelByDistance(channelDistances, 0U, (uint16_t)(currentZone.NOT_IN_CODEPLUGDATA_highestIndex - 1));
+		channelDistancePositionFromLatLong(latLongFixed32ToDouble(nonVolatileSettings.locationLat), latLongFixed32ToDouble(nonVolatileSettings.locationLon), ownPosition);
+		channelDistanceSort(zoneChannelLocations, zoneChannelLocationsOrder, distances, zoneChannelLocationsCount, ownPosition, locationsAreValid);
 
-		for (uint16_t i = 0; i < currentZone.NOT_IN_CODEPLUGDATA_highestIndex; i++)
+		for (uint16_t i = 0; i < zoneChannelLocationsCount; i++)
 		{
-			currentZone.channels[i] = channelDistances[i].index;
+			currentZone.channels[i] = zoneChannelLocations[zoneChannelLocationsOrder[i]].index;
 		}
 	}
 }
@@ -3541,6 +3669,7 @@ static void handleEventForGD77S(uiEvent_t *ev)
 							}
 
 							uiDataGlobal.Scan.nuisanceDelete[uiDataGlobal.Scan.nuisanceDeleteIndex] = uiDataGlobal.currentSelectedChannelNumber;
+							scanTableSetNuisance(scanTable, scanTableCount, uiDataGlobal.currentSelectedChannelNumber);
 							uiDataGlobal.Scan.nuisanceDeleteIndex = (uiDataGlobal.Scan.nuisanceDeleteIndex + 1) % MAX_ZONE_SCAN_NUISANCE_CHANNELS;
 							uiDataGlobal.Scan.timer.timeout = SCAN_SKIP_CHANNEL_INTERVAL;	//force scan to continue;
 							uiDataGlobal.Scan.state = SCAN_STATE_SCANNING;
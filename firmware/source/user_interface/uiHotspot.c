@@ -170,6 +170,13 @@ menuStatus_t menuHotspotMode(uiEvent_t *ev, bool isFirstRun)
 		}
 		hotspotStateMachine();
 
+		// Data message (SMS) received from the network
+		if (hotspotDataMessagePending)
+		{
+			hotspotDataMessagePending = false;
+			uiNotificationShow(NOTIFICATION_TYPE_MESSAGE, NOTIFICATION_ID_MESSAGE, 5000, hotspotDataMessageText, true);
+		}
+
 		// CW beaconing
 		if (hotspotCwKeying)
 		{
@@ -79,6 +79,7 @@ void uiNotificationShow(uiNotificationType_t type, uiNotificationID_t id, uint32
 		if (notificationData.id != id)
 		{
 			notificationData.visible = false;
+			displayMarkAllDirty();
 			displayRender();
 		}
 	}
@@ -122,6 +123,8 @@ void uiNotificationShow(uiNotificationType_t type, uiNotificationID_t id, uint32
 	}
 }
 
+// Only the primary screen changes and the notification box are sent to the LCD, the whole
+// screen gets rendered again once the notification is hidden.
 void uiNotificationRefresh(void)
 {
 	if (notificationData.visible)
@@ -225,6 +228,12 @@ bool uiNotificationIsVisible(void)
 
 void uiNotificationHide(bool immediateRender)
 {
+	// The notification box is still on the LCD, but not in the screen buffer
+	if (notificationData.visible)
+	{
+		displayMarkAllDirty();
+	}
+
 	notificationData.visible = false;
 	uiDataGlobal.displayQSOState = uiDataGlobal.displayQSOStatePrev;
 
@@ -34,9 +34,9 @@
 #include "user_interface/menuSystem.h"
 #include "user_interface/uiUtilities.h"
 #include "user_interface/uiLocalisation.h"
-#include "hardware/SPI_Flash.h"
 #include "functions/trx.h"
 #include "functions/rxPowerSaving.h"
+#include "functions/lastHeardList.h"
 #if defined(PLATFORM_MD9600) || defined(PLATFORM_MD380) || defined(PLATFORM_MDUV380) || defined(PLATFORM_RT84_DM1701) || defined(PLATFORM_MD2017)
 #include "interfaces/batteryAndPowerManagement.h"
 #include "hardware/radioHardwareInterface.h"
@@ -48,8 +48,6 @@
 #endif
 #endif
 
-static const uint8_t DECOMPRESS_LUT[64] = { ' ', '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M', 'N', 'O', 'P', 'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z', 'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j', 'k', 'l', 'm', 'n', 'o', 'p', 'q', 'r', 's', 't', 'u', 'v', 'w', 'x', 'y', 'z', '.' };
-
 #if defined(PLATFORM_MDUV380) || defined(PLATFORM_MD380) || defined(PLATFORM_RT84_DM1701) || defined(PLATFORM_MD2017)
 static  __attribute__((section(".ccmram")))
 #else // MD9600 and MK22
@@ -57,13 +55,6 @@ static  __attribute__((section(".data.$RAM2")))
 #endif
 LinkItem_t callsList[NUM_LASTHEARD_STORED];
 
-static uint32_t dmrIdDataArea_1_Size;
-const uint32_t DMRID_HEADER_LENGTH = 0x0C;
-const uint32_t DMRID_MEMORY_LOCATION_1 = 0x30000 + FLASH_ADDRESS_OFFSET;
-const uint32_t DMRID_MEMORY_LOCATION_2 = 0xB8000 + FLASH_ADDRESS_OFFSET;
-uint32_t dmrIDDatabaseMemoryLocation2 = DMRID_MEMORY_LOCATION_2;
-
-static dmrIDsCache_t dmrIDsCache;
 static uint32_t lastTG = 0;
 
 volatile uint32_t lastID = 0;// This needs to be volatile as lastHeardClearLastID() is called from an ISR
@@ -71,15 +62,12 @@ LinkItem_t *LinkHead = callsList;
 
 DECLARE_SMETER_ARRAY(rssiMeterHeaderBar, DISPLAY_SIZE_X);
 
-static uint32_t DMRID_IdLength = 4U;
-
 static uint8_t bufferTA[32] = { 0 };
 static uint8_t blocksTA = 0x00;
 static bool overrideTA = false;
 static bool contactDefinedForTA = false; // lockout TA data storage until a valid DMR ID is received.
 
 static void announceChannelNameOrVFOFrequency(bool voicePromptWasPlaying, bool announceVFOName);
-static void dmrDbTextDecode(uint8_t *compressedBufIn, uint8_t *decompressedBufOut, int compressedSize);
 
 // Set TS manual override
 // chan: CHANNEL_VFO_A, CHANNEL_VFO_B, CHANNEL_CHANNEL
@@ -262,6 +250,8 @@ void lastHeardInitList(void)
 {
 	LinkHead = callsList;
 
+	lastHeardListClearIndex();
+
 	for(int i = 0; i < NUM_LASTHEARD_STORED; i++)
 	{
 		callsList[i].id = 0;
@@ -275,6 +265,7 @@ void lastHeardInitList(void)
 		callsList[i].receivedTS = 0;
 		callsList[i].dmrMode = DMR_MODE_AUTO;
 		callsList[i].rxAGCGain = 0;
+		callsList[i].hashNext = NULL;
 
 		if (i == 0)
 		{
@@ -298,22 +289,6 @@ void lastHeardInitList(void)
 	uiDataGlobal.lastHeardCount = 0;
 }
 
-LinkItem_t *lastHeardFindInList(uint32_t id)
-{
-	LinkItem_t *item = LinkHead;
-
-	while (item->next != NULL)
-	{
-		if (item->id == id)
-		{
-			// found it
-			return item;
-		}
-		item = item->next;
-	}
-	return NULL;
-}
-
 // returns pointer to maidenheadBuffer
 uint8_t *coordsToMaidenhead(uint8_t *maidenheadBuffer, double latitude, double longitude)
 {
@@ -801,25 +776,8 @@ bool lastHeardListUpdate(uint8_t *dmrDataBuffer, bool forceOnHotspot)
 						else
 						{
 							// not at top of the list
-							// Move this item to the top of the list
-							LinkItem_t *next = item->next;
-							LinkItem_t *prev = item->prev;
-
-							// set the previous item to skip this item and link to 'items' next item.
-							prev->next = next;
-
-							if (item->next != NULL)
-							{
-								// not the last in the list
-								next->prev = prev;// backwards link the next item to the item before us in the list.
-							}
+							lastHeardListMoveToHead(&LinkHead, item);
 
-							item->next = LinkHead;// link our next item to the item at the head of the list
-
-							LinkHead->prev = item;// backwards link the hold head item to the item moving to the top of the list.
-
-							item->prev = NULL;// change the items prev to NULL now we are at teh top of the list
-							LinkHead = item;// Change the global for the head of the link to the item that is to be at the top of the list.
 							if (item->talkGroupOrPcId != 0)
 							{
 								uiDataGlobal.displayQSOState = QSO_DISPLAY_CALLER_DATA;// flag that the display needs to update
@@ -829,28 +787,12 @@ bool lastHeardListUpdate(uint8_t *dmrDataBuffer, bool forceOnHotspot)
 					else
 					{
 						// Not in the list
-						item = LinkHead;// setup to traverse the list from the top.
-
 						if (uiDataGlobal.lastHeardCount < NUM_LASTHEARD_STORED)
 						{
 							uiDataGlobal.lastHeardCount++;
 						}
 
-						// need to use the last item in the list as the new item at the top of the list.
-						// find last item in the list
-						while(item->next != NULL)
-						{
-							item = item->next;
-						}
-						//item is now the last
-
-						(item->prev)->next = NULL;// make the previous item the last
-
-						LinkHead->prev = item;// set the current head item to back reference this item.
-						item->next = LinkHead;// set this items next to the current head
-						LinkHead = item;// Make this item the new head
-
-						item->id = id;
+						item = lastHeardListReuseTail(&LinkHead, id);
 						item->talkGroupOrPcId = talkGroupOrPcId;
 						item->time = ticksGetMillis();
 						item->receivedTS = (dmrMonitorCapturedTS != -1) ? dmrMonitorCapturedTS : trxGetDMRTimeSlot();
@@ -1008,274 +950,6 @@ bool lastHeardListUpdate(uint8_t *dmrDataBuffer, bool forceOnHotspot)
 	return true;
 }
 
-static bool dmrIDReadContactInFlash(uint32_t contactOffset, uint8_t *data, uint32_t len)
-{
-	uint32_t address;
-
-	if (contactOffset >= dmrIdDataArea_1_Size)
-	{
-		address = dmrIDDatabaseMemoryLocation2 + (contactOffset - dmrIdDataArea_1_Size);
-	}
-	else
-	{
-		address = DMRID_MEMORY_LOCATION_1 + DMRID_HEADER_LENGTH + contactOffset;
-	}
-
-	return SPI_Flash_read(address, data, len);
-}
-
-void dmrIDCacheInit(void)
-{
-	uint8_t headerBuf[32];
-
-	dmrIDCacheClear();
-	memset(&headerBuf, 0, sizeof(headerBuf));
-
-	SPI_Flash_read(DMRID_MEMORY_LOCATION_1, headerBuf, DMRID_HEADER_LENGTH);
-
-	// Break backward compatibility with old "ID{N,n} tag, as we had too
-	// much problems with corrupted database.
-	if ((headerBuf[0] != 'I') || (headerBuf[1] != 'd') )
-	{
-		return;
-	}
-
-	if (headerBuf[2] == 'N' || headerBuf[2] == 'n')
-	{
-		DMRID_IdLength = 3U;// default is 4
-		if (headerBuf[2] == 'n')
-		{
-			dmrIDDatabaseMemoryLocation2 = VOICE_PROMPTS_FLASH_HEADER_ADDRESS; // overwrite the VP
-		}
-	}
-
-	dmrIDsCache.contactLength = (uint8_t)headerBuf[3] - 0x4a;
-	// Check that data in DMR ID DB does not have a larger record size than the code has
-	if (dmrIDsCache.contactLength > sizeof(dmrIdDataStruct_t))
-	{
-		return;
-	}
-
-	dmrIDsCache.entries = ((uint32_t)headerBuf[8] | (uint32_t)headerBuf[9] << 8 | (uint32_t)headerBuf[10] << 16 | (uint32_t)headerBuf[11] << 24);
-
-	// Size of number of complete DMR ID records for the first storage location
-	dmrIdDataArea_1_Size = (dmrIDsCache.contactLength * ((0x40000 - DMRID_HEADER_LENGTH) / dmrIDsCache.contactLength));
-
-	if (dmrIDsCache.entries > 0)
-	{
-		dmrIdDataStruct_t dmrIDContact;
-
-		// Set Min and Max IDs boundaries
-		// First available ID
-
-		dmrIDContact.id = 0;
-		dmrIDReadContactInFlash(0, (uint8_t *)&dmrIDContact, DMRID_IdLength);
-		dmrIDsCache.slices[0] = dmrIDContact.id;
-
-		// Last available ID
-		dmrIDContact.id = 0;
-		dmrIDReadContactInFlash((dmrIDsCache.contactLength * (dmrIDsCache.entries - 1)), (uint8_t *)&dmrIDContact, DMRID_IdLength);
-		dmrIDsCache.slices[ID_SLICES - 1] = dmrIDContact.id;
-
-		if (dmrIDsCache.entries > MIN_ENTRIES_BEFORE_USING_SLICES)
-		{
-			dmrIDsCache.IDsPerSlice = dmrIDsCache.entries / (ID_SLICES - 1);
-
-			for (uint8_t i = 0; i < (ID_SLICES - 2); i++)
-			{
-				dmrIDContact.id = 0;
-				dmrIDReadContactInFlash((dmrIDsCache.contactLength * ((dmrIDsCache.IDsPerSlice * i) + dmrIDsCache.IDsPerSlice)), (uint8_t *)&dmrIDContact, DMRID_IdLength);
-				dmrIDsCache.slices[i + 1] = dmrIDContact.id;
-			}
-		}
-	}
-}
-
-void dmrIDCacheClear(void)
-{
-	memset(&dmrIDsCache, 0, sizeof(dmrIDsCache_t));
-}
-
-uint32_t dmrIDCacheGetCount(void)
-{
-	return dmrIDsCache.entries;
-}
-
-static void dmrDbTextDecode(uint8_t *decompressedBufOut, uint8_t *compressedBufIn, int compressedSize)
-{
-	uint8_t *outPtr = decompressedBufOut;
-	uint8_t cb1, cb2, cb3;
-	int d = 0;
-	do
-	{
-		cb1 = compressedBufIn[d++];
-		*outPtr++ = DECOMPRESS_LUT[cb1 >> 2];//A
-		if (d == compressedSize)
-		{
-			break;
-		}
-		cb2 = compressedBufIn[d++];
-		*outPtr++ = DECOMPRESS_LUT[((cb1 & 0x03) << 4) + (cb2 >> 4)];//B
-		if (d == compressedSize)
-		{
-			break;
-		}
-		cb3 = compressedBufIn[d++];
-		*outPtr++ = DECOMPRESS_LUT[((cb2 & 0x0F) << 2) + (cb3 >> 6)];//C
-		*outPtr++ = DECOMPRESS_LUT[cb3 & 0x3F];//D
-
-	} while (d < compressedSize);
-
-	// algorithm can result in a extra space at the end of the decompressed string
-	// so trim the string
-	uint32_t l = (outPtr - decompressedBufOut);
-	if (l)
-	{
-		uint8_t *p = ((decompressedBufOut + l) - 1);
-		while ((p >= decompressedBufOut) && (*p == ' '))
-		{
-			*p-- = 0;
-		}
-	}
-}
-
-bool dmrIDLookup(uint32_t targetId, dmrIdDataStruct_t *foundRecord)
-{
-	uint32_t targetIdBCD;
-
-	if (DMRID_IdLength == 4U)
-	{
-		targetIdBCD = int2bcd(targetId);
-	}
-	else
-	{
-		targetIdBCD = targetId;
-	}
-
-	if ((dmrIDsCache.entries > 0) && (targetIdBCD >= dmrIDsCache.slices[0]) && (targetIdBCD <= dmrIDsCache.slices[ID_SLICES - 1]))
-	{
-		uint32_t startPos = 0;
-		uint32_t endPos = dmrIDsCache.entries - 1;
-		uint32_t curPos;
-
-		// Contact's text length == (dmrIDsCache.contactLength - DMRID_IdLength) aren't NULL terminated,
-		// so clearing the whole destination array is mandatory
-		memset(foundRecord->text, 0, sizeof(foundRecord->text));
-
-		uint8_t compressedBuf[MAX_DMR_ID_CONTACT_TEXT_LENGTH];// worst case length with no compression
-
-		if (dmrIDsCache.entries > MIN_ENTRIES_BEFORE_USING_SLICES) // Use slices
-		{
-			for (uint8_t i = 0; i < ID_SLICES - 1; i++)
-			{
-				// Check if ID is in slices boundaries, with a special case for the last slice as [ID_SLICES - 1] is the last ID
-				if ((targetIdBCD >= dmrIDsCache.slices[i]) &&
-						((i == ID_SLICES - 2) ? (targetIdBCD <= dmrIDsCache.slices[i + 1]) : (targetIdBCD < dmrIDsCache.slices[i + 1])))
-				{
-					// targetID is the min slice limit, don't go further
-					if (targetIdBCD == dmrIDsCache.slices[i])
-					{
-						foundRecord->id = dmrIDsCache.slices[i];
-
-						if (dmrIDReadContactInFlash((dmrIDsCache.contactLength * (dmrIDsCache.IDsPerSlice * i)) + DMRID_IdLength, (uint8_t *)&compressedBuf, (dmrIDsCache.contactLength - DMRID_IdLength)))
-						{
-							if (DMRID_IdLength == 3U)
-							{
-								dmrDbTextDecode((uint8_t *)foundRecord->text, (uint8_t *)&compressedBuf, (dmrIDsCache.contactLength - DMRID_IdLength));
-							}
-							else
-							{
-								memcpy((uint8_t *)foundRecord->text, (uint8_t *)&compressedBuf, (dmrIDsCache.contactLength - DMRID_IdLength));
-							}
-							return true;
-						}
-						else
-						{
-							goto spiReadFailure;
-						}
-					}
-
-					startPos = dmrIDsCache.IDsPerSlice * i;
-					endPos = (i == ID_SLICES - 2) ? (dmrIDsCache.entries - 1) : dmrIDsCache.IDsPerSlice * (i + 1);
-
-					break;
-				}
-			}
-		}
-		else // Not enough contact to use slices
-		{
-			bool isMin;
-
-			// Check if targetID is equal to the first or the last in the IDs list
-			if ((isMin = (targetIdBCD == dmrIDsCache.slices[0])) || (targetIdBCD == dmrIDsCache.slices[ID_SLICES - 1]))
-			{
-				foundRecord->id = dmrIDsCache.slices[(isMin ? 0 : (ID_SLICES - 1))];
-
-				if (dmrIDReadContactInFlash((dmrIDsCache.contactLength * (dmrIDsCache.IDsPerSlice * (isMin ? 0 : (ID_SLICES - 1)))) + DMRID_IdLength, (uint8_t *) &compressedBuf, (dmrIDsCache.contactLength - DMRID_IdLength)))
-				{
-					if (DMRID_IdLength == 3U)
-					{
-						dmrDbTextDecode((uint8_t *)foundRecord->text, (uint8_t *)&compressedBuf, (dmrIDsCache.contactLength - DMRID_IdLength));
-					}
-					else
-					{
-						memcpy((uint8_t *)foundRecord->text, (uint8_t *)&compressedBuf, (dmrIDsCache.contactLength - DMRID_IdLength));
-					}
-
-					return true;
-				}
-				else
-				{
-					goto spiReadFailure;
-				}
-			}
-		}
-
-		// Look for the ID now
-		while (startPos <= endPos)
-		{
-			curPos = (startPos + endPos) >> 1;
-
-			foundRecord->id = 0;
-
-			if (dmrIDReadContactInFlash((dmrIDsCache.contactLength * curPos), (uint8_t *)foundRecord, DMRID_IdLength))
-			{
-				if (foundRecord->id < targetIdBCD)
-				{
-					startPos = curPos + 1;
-				}
-				else if (foundRecord->id > targetIdBCD)
-				{
-					endPos = curPos - 1;
-				}
-				else
-				{
-					dmrIDReadContactInFlash((dmrIDsCache.contactLength * curPos) + DMRID_IdLength, (uint8_t *)&compressedBuf, (dmrIDsCache.contactLength - DMRID_IdLength));
-
-					if (DMRID_IdLength == 3U)
-					{
-						dmrDbTextDecode((uint8_t *)foundRecord->text, (uint8_t *)&compressedBuf, (dmrIDsCache.contactLength - DMRID_IdLength));
-					}
-					else
-					{
-						memcpy((uint8_t *)foundRecord->text, (uint8_t *)&compressedBuf, (dmrIDsCache.contactLength - DMRID_IdLength));
-					}
-
-					return true;
-				}
-			}
-			else
-			{
-				goto spiReadFailure;
-			}
-		}
-	}
-
-	spiReadFailure:
-	snprintf(foundRecord->text, MAX_DMR_ID_CONTACT_TEXT_LENGTH, "ID:%d", targetId);
-	return false;
-}
-
 bool contactIDLookup(uint32_t id, uint32_t calltype, char *buffer)
 {
 	struct_codeplugContact_t contact;
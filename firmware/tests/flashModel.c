@@ -0,0 +1,264 @@
+/*
+ * Copyright (C) 2024 Roger Clark, VK3KYY / G4KYF
+ *                    Daniel Caujolle-Bert, F1RMB
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+ *    in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. Use of this source code or binary releases for commercial purposes is strictly forbidden. This includes, without limitation,
+ *    incorporation in a commercial product or incorporation into a product or project which allows commercial use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <string.h>
+#include "flashModel.h"
+#include "interfaces/gpio.h"
+
+#define CMD_W_EN     0x06
+#define CMD_W_DE     0x04
+#define CMD_R_SR1    0x05
+#define CMD_R_SR2    0x35
+#define CMD_PAGE_PGM 0x02
+#define CMD_SECTOR_E 0x20
+#define CMD_READ     0x03
+#define CMD_JEDEC_ID 0x9f
+
+uint8_t flashModelMemory[FLASH_MODEL_SIZE];
+flashModelStats_t flashModelStats;
+
+static uint16_t sectorErases[FLASH_MODEL_SIZE / FLASH_MODEL_SECTOR_SIZE];
+static uint8_t pageBuffer[FLASH_MODEL_PAGE_SIZE];
+static bool pageBufferUsed[FLASH_MODEL_PAGE_SIZE];
+static bool selected;
+static bool clockHigh;
+static bool writeEnabled;
+static uint8_t inByte;
+static uint8_t outByte;
+static int bitCount;
+static uint32_t byteCount;
+static uint8_t command;
+static uint32_t address;
+
+
+static void endOfTransaction(void)
+{
+	if (byteCount == 0)
+	{
+		return;
+	}
+
+	switch (command)
+	{
+		case CMD_W_EN:
+			writeEnabled = true;
+			break;
+
+		case CMD_W_DE:
+			writeEnabled = false;
+			break;
+
+		case CMD_PAGE_PGM:
+			if (writeEnabled && (byteCount > 4))
+			{
+				uint32_t page = (address & ~(FLASH_MODEL_PAGE_SIZE - 1));
+
+				for (uint32_t i = 0; i < FLASH_MODEL_PAGE_SIZE; i++)
+				{
+					if (pageBufferUsed[i])
+					{
+						if (pageBuffer[i] & ~flashModelMemory[page + i])
+						{
+							flashModelStats.programWithoutErase++;
+						}
+						flashModelMemory[page + i] &= pageBuffer[i];
+						flashModelStats.bytesProgrammed++;
+					}
+				}
+				flashModelStats.pagePrograms++;
+			}
+			else
+			{
+				flashModelStats.protocolErrors++;
+			}
+			writeEnabled = false;
+			break;
+
+		case CMD_SECTOR_E:
+			if (writeEnabled && (byteCount == 4))
+			{
+				uint32_t sector = (address / FLASH_MODEL_SECTOR_SIZE);
+
+				memset(&flashModelMemory[sector * FLASH_MODEL_SECTOR_SIZE], 0xFF, FLASH_MODEL_SECTOR_SIZE);
+				flashModelStats.sectorErases++;
+				if (++sectorErases[sector] > flashModelStats.maxSectorErases)
+				{
+					flashModelStats.maxSectorErases = sectorErases[sector];
+				}
+			}
+			else
+			{
+				flashModelStats.protocolErrors++;
+			}
+			writeEnabled = false;
+			break;
+
+		default:
+			break;
+	}
+}
+
+// Called once a whole byte has been clocked in, prepares the byte to be clocked out next
+static void byteReceived(uint8_t data)
+{
+	uint32_t index = byteCount++;
+
+	outByte = 0xFF;
+
+	if (index == 0)
+	{
+		command = data;
+		address = 0;
+		memset(pageBufferUsed, 0, sizeof(pageBufferUsed));
+	}
+
+	switch (command)
+	{
+		case CMD_R_SR1:
+			outByte = (writeEnabled ? 0x02 : 0x00);// Never busy
+			break;
+
+		case CMD_R_SR2:
+			outByte = 0x00;
+			break;
+
+		case CMD_JEDEC_ID:
+			outByte = ((index == 0) ? 0xEF : ((index == 1) ? 0x40 : __builtin_ctz(FLASH_MODEL_SIZE)));// 0x14: 25Q80, 0x18: 25Q128
+			break;
+
+		case CMD_READ:
+		case CMD_PAGE_PGM:
+		case CMD_SECTOR_E:
+			if ((index >= 1) && (index <= 3))
+			{
+				address = ((address << 8) | data);
+			}
+
+			if (command == CMD_READ)
+			{
+				if (index >= 3)
+				{
+					outByte = flashModelMemory[address % FLASH_MODEL_SIZE];
+					address++;
+					flashModelStats.bytesRead += ((index >= 4) ? 1 : 0);
+				}
+			}
+			else if (command == CMD_PAGE_PGM)
+			{
+				if (index >= 4)
+				{
+					// Like the real chip, the address wraps within the page
+					uint32_t offset = ((address + (index - 4)) & (FLASH_MODEL_PAGE_SIZE - 1));
+
+					pageBuffer[offset] = data;
+					pageBufferUsed[offset] = true;
+				}
+			}
+			else if (index >= 4)
+			{
+				flashModelStats.protocolErrors++;
+			}
+			break;
+
+		default:
+			break;
+	}
+}
+
+static void flashModelGpio(GPIO_Type *port)
+{
+	uint32_t pins = ((port->PDOR | port->PSOR) & ~port->PCOR);
+	bool nowSelected = ((pins & (1U << Pin_SPI_FLASH_CS_U)) == 0);
+	bool nowClockHigh = ((pins & (1U << Pin_SPI_FLASH_CLK_U)) != 0);
+
+	port->PDOR = pins;
+	port->PSOR = 0;
+	port->PCOR = 0;
+
+	if (nowSelected && (selected == false))
+	{
+		bitCount = 0;
+		byteCount = 0;
+		outByte = 0xFF;
+		flashModelStats.transactions++;
+	}
+	else if ((nowSelected == false) && selected)
+	{
+		if (bitCount != 0)
+		{
+			flashModelStats.protocolErrors++;
+		}
+		endOfTransaction();
+	}
+
+	// Data in (from the MCU DO pin) is sampled on the rising edge
+	if (nowSelected && nowClockHigh && (clockHigh == false))
+	{
+		inByte = ((inByte << 1) | ((pins >> Pin_SPI_FLASH_DO_U) & 0x01));
+		hostCycles++;
+
+		if (++bitCount == 8)
+		{
+			bitCount = 0;
+			byteReceived(inByte);
+		}
+	}
+
+	selected = nowSelected;
+	clockHigh = nowClockHigh;
+
+	// Data out is valid while the clock is low, MSB first
+	port->PDIR = (((outByte >> (7 - bitCount)) & 0x01) << Pin_SPI_FLASH_DI_U);
+}
+
+void flashModelInit(uint8_t fill)
+{
+	memset(flashModelMemory, fill, sizeof(flashModelMemory));
+	memset(sectorErases, 0, sizeof(sectorErases));
+	memset(&hostGpioPort, 0, sizeof(hostGpioPort));
+	hostGpioPort.PDOR = (1U << Pin_SPI_FLASH_CS_U);
+	selected = false;
+	clockHigh = false;
+	writeEnabled = false;
+	bitCount = 0;
+	byteCount = 0;
+	flashModelResetStats();
+	hostGpioModel = flashModelGpio;
+}
+
+void flashModelResetStats(void)
+{
+	memset(&flashModelStats, 0, sizeof(flashModelStats));
+}
+
+bool flashModelIsIdle(void)
+{
+	hostGpioAccess();
+
+	return ((selected == false) && (bitCount == 0));
+}
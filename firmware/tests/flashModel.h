@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2024 Roger Clark, VK3KYY / G4KYF
+ *                    Daniel Caujolle-Bert, F1RMB
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+ *    in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. Use of this source code or binary releases for commercial purposes is strictly forbidden. This includes, without limitation,
+ *    incorporation in a commercial product or incorporation into a product or project which allows commercial use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// W25Qxx NOR flash, bit-banged over the simulated GPIO pins.
+
+#ifndef _FLASH_MODEL_H_
+#define _FLASH_MODEL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef FLASH_MODEL_SIZE
+#define FLASH_MODEL_SIZE        (1024U * 1024U) // 25Q80, as in the GD-77
+#endif
+#define FLASH_MODEL_SECTOR_SIZE 4096U
+#define FLASH_MODEL_PAGE_SIZE   256U
+
+typedef struct
+{
+	uint32_t transactions;// Chip select cycles
+	uint32_t bytesRead;
+	uint32_t pagePrograms;
+	uint32_t bytesProgrammed;
+	uint32_t sectorErases;
+	uint32_t maxSectorErases;// Wear of the most erased sector
+	uint32_t programWithoutErase;// Page programs which tried to set bits to 1
+	uint32_t protocolErrors;// Program/erase without write enable, data after a complete command...
+} flashModelStats_t;
+
+extern uint8_t flashModelMemory[FLASH_MODEL_SIZE];
+extern flashModelStats_t flashModelStats;
+
+void flashModelInit(uint8_t fill);
+void flashModelResetStats(void);
+bool flashModelIsIdle(void);// Chip not selected, and clock high or low without a pending partial byte
+
+#endif /* _FLASH_MODEL_H_ */
@@ -0,0 +1,219 @@
+/*
+ * Copyright (C) 2024 Roger Clark, VK3KYY / G4KYF
+ *                    Daniel Caujolle-Bert, F1RMB
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+ *    in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. Use of this source code or binary releases for commercial purposes is strictly forbidden. This includes, without limitation,
+ *    incorporation in a commercial product or incorporation into a product or project which allows commercial use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <stdio.h>
+#include <time.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "interfaces/gpio.h"
+
+uint64_t hostCycles = 0;
+uint32_t hostMillis = 0;
+
+int hostCriticalNesting = 0;
+uint32_t hostCriticalSections = 0;
+uint64_t hostCriticalMaxCycles = 0;
+void (*hostInterruptHook)(void) = NULL;
+void (*hostPreemptionHook)(void) = NULL;
+
+bool hostSchedulerRunning = true;
+bool hostInsideInterrupt = false;
+void (*hostDelayHook)(void) = NULL;
+uint32_t hostNotifications = 0;
+
+GPIO_Type hostGpioPort;
+void (*hostGpioModel)(GPIO_Type *port) = NULL;
+
+gpio_pin_config_t pin_config_input = { kGPIO_DigitalInput, 0 };
+gpio_pin_config_t pin_config_output = { kGPIO_DigitalOutput, 0 };
+
+static uint64_t criticalStartCycles;
+static int checkFailures = 0;
+static int currentTask;
+static bool preempting = false;
+
+
+void hostEnterCritical(void)
+{
+	if (hostCriticalNesting++ == 0)
+	{
+		criticalStartCycles = hostCycles;
+		hostCriticalSections++;
+	}
+}
+
+void hostExitCritical(void)
+{
+	if (--hostCriticalNesting == 0)
+	{
+		uint64_t span = (hostCycles - criticalStartCycles);
+
+		if (span > hostCriticalMaxCycles)
+		{
+			hostCriticalMaxCycles = span;
+		}
+
+		// Pending interrupts are serviced as soon as they are unmasked
+		if ((hostInterruptHook != NULL) && (hostInsideInterrupt == false))
+		{
+			hostInsideInterrupt = true;
+			hostInterruptHook();
+			hostInsideInterrupt = false;
+		}
+
+		// Then the tasks it made ready, not while one of them is already running
+		if ((hostPreemptionHook != NULL) && (hostInsideInterrupt == false) && (preempting == false))
+		{
+			preempting = true;
+			hostPreemptionHook();
+			preempting = false;
+		}
+	}
+}
+
+void hostResetCriticalStats(void)
+{
+	hostCriticalSections = 0;
+	hostCriticalMaxCycles = 0;
+}
+
+BaseType_t xTaskGetSchedulerState(void)
+{
+	return (hostSchedulerRunning ? taskSCHEDULER_RUNNING : taskSCHEDULER_NOT_STARTED);
+}
+
+BaseType_t xPortIsInsideInterrupt(void)
+{
+	return (hostInsideInterrupt ? pdTRUE : pdFALSE);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+	return &currentTask;
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+	return hostMillis;
+}
+
+void vTaskDelay(const TickType_t xTicksToDelay)
+{
+	hostMillis += ((xTicksToDelay > 0) ? xTicksToDelay : 1);
+
+	if (hostDelayHook != NULL)
+	{
+		hostDelayHook();
+	}
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t xTaskToNotify)
+{
+	(void)xTaskToNotify;
+	hostNotifications++;
+
+	return pdPASS;
+}
+
+// Busy loops waiting for the next millisecond have to end (weak, the timer callbacks test links the real one over PITCounter)
+__attribute__((weak)) uint32_t ticksGetMillis(void)
+{
+	return hostMillis++;
+}
+
+GPIO_Type *hostGpioAccess(void)
+{
+	if (hostGpioModel != NULL)
+	{
+		hostGpioModel(&hostGpioPort);
+	}
+
+	return &hostGpioPort;
+}
+
+void GPIO_PinInit(GPIO_Type *base, uint32_t pin, const gpio_pin_config_t *config)
+{
+	// As the SDK does, an output pin is driven to config->outputLogic straight away
+	if (config->pinDirection == kGPIO_DigitalOutput)
+	{
+		GPIO_PinWrite(base, pin, config->outputLogic);
+		base->PDDR |= (1U << pin);
+	}
+	else
+	{
+		base->PDDR &= ~(1U << pin);
+	}
+	hostGpioAccess();
+}
+
+void GPIO_PinWrite(GPIO_Type *base, uint32_t pin, uint8_t output)
+{
+	if (output)
+	{
+		base->PDOR |= (1U << pin);
+	}
+	else
+	{
+		base->PDOR &= ~(1U << pin);
+	}
+	hostGpioAccess();
+}
+
+uint32_t GPIO_PinRead(GPIO_Type *base, uint32_t pin)
+{
+	return ((hostGpioAccess()->PDIR >> pin) & 0x01U);
+}
+
+void gpioInitFlash(void)
+{
+}
+
+void hostCheck(bool cond, const char *expression, const char *file, int line)
+{
+	if (cond == false)
+	{
+		if (checkFailures++ < 20)
+		{
+			fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+		}
+	}
+}
+
+int hostCheckFailures(void)
+{
+	return checkFailures;
+}
+
+double hostSeconds(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (ts.tv_sec + (ts.tv_nsec * 1E-9));
+}
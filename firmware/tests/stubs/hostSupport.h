@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2024 Roger Clark, VK3KYY / G4KYF
+ *                    Daniel Caujolle-Bert, F1RMB
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+ *    in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. Use of this source code or binary releases for commercial purposes is strictly forbidden. This includes, without limitation,
+ *    incorporation in a commercial product or incorporation into a product or project which allows commercial use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// Services shared by the host tests: simulated time, interrupts masking accounting and GPIO port.
+
+#ifndef _HOST_SUPPORT_H_
+#define _HOST_SUPPORT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define HOST_CHECK(cond) hostCheck((cond), #cond, __FILE__, __LINE__)
+
+typedef struct
+{
+	uint32_t PDOR;
+	uint32_t PSOR;
+	uint32_t PCOR;
+	uint32_t PTOR;
+	uint32_t PDIR;
+	uint32_t PDDR;
+} GPIO_Type;
+
+// Simulated time base, advanced by the hardware models (e.g. one unit per SPI clock)
+extern uint64_t hostCycles;
+extern uint32_t hostMillis;
+
+// Interrupts masking
+extern int hostCriticalNesting;
+extern uint32_t hostCriticalSections;
+extern uint64_t hostCriticalMaxCycles;// Longest span, in hostCycles, spent with the interrupts masked
+extern void (*hostInterruptHook)(void);// Run whenever the interrupts get unmasked, to inject an ISR
+extern void (*hostPreemptionHook)(void);// Run next, from task context, to inject a higher priority task
+
+// Scheduler
+extern bool hostSchedulerRunning;
+extern bool hostInsideInterrupt;
+extern void (*hostDelayHook)(void);// Run by vTaskDelay(), as another task would while the caller sleeps
+extern uint32_t hostNotifications;
+
+// GPIO port shared by all the simulated pins, hostGpioModel is called before every access
+// so it sees the previous register writes in order.
+extern GPIO_Type hostGpioPort;
+extern void (*hostGpioModel)(GPIO_Type *port);
+GPIO_Type *hostGpioAccess(void);
+
+void hostEnterCritical(void);
+void hostExitCritical(void);
+void hostResetCriticalStats(void);
+
+void hostCheck(bool cond, const char *expression, const char *file, int line);
+int hostCheckFailures(void);
+double hostSeconds(void);
+
+#endif /* _HOST_SUPPORT_H_ */
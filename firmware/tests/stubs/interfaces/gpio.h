@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2024 Roger Clark, VK3KYY / G4KYF
+ *                    Daniel Caujolle-Bert, F1RMB
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+ *    in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. Use of this source code or binary releases for commercial purposes is strictly forbidden. This includes, without limitation,
+ *    incorporation in a commercial product or incorporation into a product or project which allows commercial use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// Host build stand-in for the GPIO definitions: every pin lives in hostGpioPort,
+// each access to a port goes through the test model (see hostSupport.h).
+
+#ifndef _OPENGD77_GPIO_H_
+#define _OPENGD77_GPIO_H_
+
+#include <stdint.h>
+#include <string.h>
+#include "hostSupport.h"
+
+typedef enum
+{
+	kGPIO_DigitalInput = 0U,
+	kGPIO_DigitalOutput = 1U
+} gpio_pin_direction_t;
+
+typedef struct
+{
+	gpio_pin_direction_t pinDirection;
+	uint8_t outputLogic;
+} gpio_pin_config_t;
+
+extern gpio_pin_config_t pin_config_input;
+extern gpio_pin_config_t pin_config_output;
+
+#define GPIO_SPI_FLASH_CS_U   hostGpioAccess()
+#define Pin_SPI_FLASH_CS_U    0
+#define GPIO_SPI_FLASH_CLK_U  hostGpioAccess()
+#define Pin_SPI_FLASH_CLK_U   1
+#define GPIO_SPI_FLASH_DI_U   hostGpioAccess()
+#define Pin_SPI_FLASH_DI_U    2
+#define GPIO_SPI_FLASH_DO_U   hostGpioAccess()
+#define Pin_SPI_FLASH_DO_U    3
+
+#define GPIO_Display_CS       hostGpioAccess()
+#define Pin_Display_CS        8
+#define GPIO_Display_RS       hostGpioAccess()
+#define Pin_Display_RS        10
+#define GPIO_Display_SCK      hostGpioAccess()
+#define Pin_Display_SCK       11
+#define GPIO_Display_SDA      hostGpioAccess()
+#define Pin_Display_SDA       12
+
+void GPIO_PinInit(GPIO_Type *base, uint32_t pin, const gpio_pin_config_t *config);
+void GPIO_PinWrite(GPIO_Type *base, uint32_t pin, uint8_t output);
+uint32_t GPIO_PinRead(GPIO_Type *base, uint32_t pin);
+void gpioInitFlash(void);
+
+#endif /* _OPENGD77_GPIO_H_ */
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2024 Roger Clark, VK3KYY / G4KYF
+ *                    Daniel Caujolle-Bert, F1RMB
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+ *    in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. Use of this source code or binary releases for commercial purposes is strictly forbidden. This includes, without limitation,
+ *    incorporation in a commercial product or incorporation into a product or project which allows commercial use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// Host build stand-in for the UI globals: only the DMR ID database, last heard list, date/time and codeplug definitions, which have to match the real ones.
+
+#ifndef _OPENGD77_UIGLOBALS_H_
+#define _OPENGD77_UIGLOBALS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "functions/codeplug.h"
+#include "utils.h"
+
+#define DMRID_INDEX_SAMPLES                  256
+#define DMRID_LOOKUP_WINDOW_SIZE              64
+#define DMRID_LRU_SIZE                         8
+
+#define MAX_DMR_ID_CONTACT_TEXT_LENGTH 51
+
+#define NUM_LASTHEARD_STORED                  32
+#define LASTHEARD_HASH_BUCKETS                32 // Power of two
+
+#define MIN_TG_OR_PC_VALUE                     1
+#define MAX_TG_OR_PC_VALUE              16777215
+#define ALL_CALL_VALUE                  16777215 // 0xFFFFFF
+#define PC_CALL_FLAG                        0x03 // from HR-C6000.h
+
+#define SCREEN_LINE_BUFFER_SIZE               17 // 16 characters (for a 8 pixels font width) + NULL
+
+typedef uint32_t time_t_custom;     /* date/time in unix secs past 1-Jan-70 */
+
+typedef struct
+{
+	uint32_t			id;
+	char 				text[MAX_DMR_ID_CONTACT_TEXT_LENGTH];
+} dmrIdDataStruct_t;
+
+typedef struct LinkItem
+{
+    struct LinkItem 	*prev;
+    uint32_t 			id;
+    uint32_t 			talkGroupOrPcId;
+    char        		contact[MAX_DMR_ID_CONTACT_TEXT_LENGTH];
+    char        		talkgroup[17];
+    char 				talkerAlias[32];
+    double				locationLat;
+    double				locationLon;
+    uint32_t			time;
+    uint8_t				receivedTS;
+    uint8_t				dmrMode;
+    uint16_t			rxAGCGain;
+    struct LinkItem 	*next;
+    struct LinkItem 	*hashNext;
+} LinkItem_t;
+
+extern const uint32_t DMRID_HEADER_LENGTH;
+extern const uint32_t DMRID_MEMORY_LOCATION_1;
+extern const uint32_t DMRID_MEMORY_LOCATION_2;
+extern uint32_t dmrIDDatabaseMemoryLocation2;
+
+extern struct_codeplugZone_t currentZone;
+
+#endif
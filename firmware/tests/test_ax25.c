@@ -0,0 +1,605 @@
+/*
+ * Copyright (C) 2024 Roger Clark, VK3KYY / G4KYF
+ *                    Daniel Caujolle-Bert, F1RMB
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+ *    in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. Use of this source code or binary releases for commercial purposes is strictly forbidden. This includes, without limitation,
+ *    incorporation in a commercial product or incorporation into a product or project which allows commercial use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// AX.25 frame builder (ax25.c): APRS position packets, compressed or not, with or without the course and speed of
+// SmartBeaconing, are composed the way aprs.c does it and encoded. The keyed bitstream (flags, bit stuffing, FCS and
+// NRZI) must be identical, bit for bit, to the one of the previous bit serial encoder, kept below as the reference,
+// as must the number of keyed bits. Frames made of random and 0xFF heavy octets are checked the same way, to exercise
+// the bit stuffing across the chunk boundaries. Then the packets/s of both encoders on the host.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "functions/ax25.h"
+#include "utils.h"
+#include "hostSupport.h"
+
+#define APRS_DESTINATION          "APOG77"
+#define LEADING_FLAGS              16U
+#define TRAILING_FLAGS              3U
+#define RANDOM_PACKETS          20000U
+#define RANDOM_FRAMES           50000U
+#define RANDOM_FRAME_LENGTH_MAX   126U // AX25_FRAME_BUFFER_SIZE, minus the FCS
+#define BENCHMARK_PACKETS      200000U
+
+// What aprs.c gets from the codeplug, the settings and the location
+typedef struct
+{
+	char        callsign[8];
+	uint8_t     senderSSID;
+	char        pathNames[2][8];
+	uint8_t     pathSSIDs[2];
+	bool        compressed;
+	uint8_t     iconTable;
+	uint8_t     iconIndex;
+	char        latStr[16];
+	char        lonStr[16];
+	char        courseSpeedStr[16];
+	bool        courseAndSpeed;
+	char        comment[48];
+} testPacket_t;
+
+// The previous encoder: every octet is pushed bit by bit, with the CRC, bit stuffing and NRZI done on the fly
+typedef struct
+{
+	uint8_t     packetBuffer[AX25_PACKET_BUFFER_SIZE];
+	uint16_t    packetBufferBitPosition;
+	uint16_t    bitStuffingCounter;
+	uint16_t    crc;
+	bool        currentBitNRZI;
+} refEncoder_t;
+
+static uint32_t randomState = 0x13579BDF;
+
+
+static uint32_t randomNext(void)
+{
+	randomState ^= (randomState << 13);
+	randomState ^= (randomState >> 17);
+	randomState ^= (randomState << 5);
+
+	return randomState;
+}
+
+static void refEnqueueBit(refEncoder_t *encoderData, bool data)
+{
+	if (data)
+	{
+		encoderData->packetBuffer[encoderData->packetBufferBitPosition / 8U] |= 0x01 << (encoderData->packetBufferBitPosition % 8U);
+	}
+	encoderData->packetBufferBitPosition++;
+}
+
+static void refUpdateCRC(refEncoder_t *encoderData, bool dataBit)
+{
+	uint16_t crcXorDataBit = (encoderData->crc ^ dataBit);
+
+	encoderData->crc >>= 1;
+
+	if (crcXorDataBit & 0x01)
+	{
+		encoderData->crc ^= 0x8408;
+	}
+}
+
+static void refEnqueueCharNrzi(refEncoder_t *encoderData, uint8_t data, bool useBitStuffing)
+{
+	bool currentBit;
+
+	for (uint8_t i = 0; i < 8U; i++)
+	{
+		currentBit = (data & 0x01);
+
+		refUpdateCRC(encoderData, currentBit);
+
+		if (currentBit)
+		{
+			refEnqueueBit(encoderData, encoderData->currentBitNRZI);
+			encoderData->bitStuffingCounter++;
+
+			if (useBitStuffing && (encoderData->bitStuffingCounter == 5))
+			{
+				encoderData->currentBitNRZI ^= 1;
+				refEnqueueBit(encoderData, encoderData->currentBitNRZI);
+
+				encoderData->bitStuffingCounter = 0U;
+			}
+		}
+		else
+		{
+			encoderData->currentBitNRZI ^= 1;
+			refEnqueueBit(encoderData, encoderData->currentBitNRZI);
+
+			encoderData->bitStuffingCounter = 0U;
+		}
+
+		data >>= 1;
+	}
+}
+
+static void refEnqueueCRC(refEncoder_t *encoderData)
+{
+	uint8_t crc_lo = (encoderData->crc ^ 0xff);
+	uint8_t crc_hi = ((encoderData->crc >> 8) ^ 0xff);
+
+	refEnqueueCharNrzi(encoderData, crc_lo, true);
+	refEnqueueCharNrzi(encoderData, crc_hi, true);
+}
+
+static void refEnqueuePadOfLength(refEncoder_t *encoderData, uint32_t len)
+{
+	for (uint8_t j = 0; j < len; j++)
+	{
+		refEnqueueCharNrzi(encoderData, (' ' << 1), true);
+	}
+}
+
+static void refEnqueueString(refEncoder_t *encoderData, const char *str)
+{
+	uint8_t i = 0;
+
+	while (str[i] != 0)
+	{
+		refEnqueueCharNrzi(encoderData, str[i], true);
+		i++;
+	};
+}
+
+static void refEnqueueFlagOfLength(refEncoder_t *encoderData, uint8_t len)
+{
+	for (uint8_t i = 0; i < len; i++)
+	{
+		refEnqueueCharNrzi(encoderData, 0x7E, false); // 0x7E flag
+	}
+}
+
+static void refEncoderReset(refEncoder_t *encoderData)
+{
+	encoderData->packetBufferBitPosition = 0;
+	encoderData->bitStuffingCounter = 0;
+	encoderData->currentBitNRZI = false;
+	memset(encoderData->packetBuffer, 0, AX25_PACKET_BUFFER_SIZE);
+	refEnqueueFlagOfLength(encoderData, LEADING_FLAGS);
+	encoderData->crc = 0xFFFF;
+}
+
+static uint32_t refEncodeFrame(refEncoder_t *encoderData)
+{
+	refEnqueueCRC(encoderData);
+	refEnqueueFlagOfLength(encoderData, TRAILING_FLAGS);
+
+	return (((encoderData->packetBufferBitPosition / 8) - 1) * 8);
+}
+
+// Header and payload, as the previous aprs.c composed them
+static void refEnqueuePacket(refEncoder_t *encoderData, const testPacket_t *packet)
+{
+	for (uint32_t i = 0; i < strlen(APRS_DESTINATION); i++)
+	{
+		refEnqueueCharNrzi(encoderData, (APRS_DESTINATION[i] << 1), true);
+	}
+	refEnqueueCharNrzi(encoderData, ('0' << 1), true);
+
+	uint8_t len = SAFE_MIN(strlen(packet->callsign), 6U);
+
+	for (uint8_t i = 0; i < len; i++)
+	{
+		refEnqueueCharNrzi(encoderData, (packet->callsign[i] << 1), true);
+	}
+
+	if (len < 6U)
+	{
+		refEnqueuePadOfLength(encoderData, (6U - len));
+	}
+
+	refEnqueueCharNrzi(encoderData, ((packet->senderSSID + '0') << 1), true);
+
+	uint8_t numPaths = ((strlen(packet->pathNames[1]) == 0) ? 1U : 2U);
+
+	for (uint8_t p = 0; p < numPaths; p++)
+	{
+		len = SAFE_MIN(strlen(packet->pathNames[p]), 6U);
+
+		for (uint8_t i = 0; i < len; i++)
+		{
+			refEnqueueCharNrzi(encoderData, (packet->pathNames[p][i] << 1), true);
+		}
+
+		if (len < 6U)
+		{
+			refEnqueuePadOfLength(encoderData, (6U - len));
+		}
+
+		uint8_t isEnd = (p == (numPaths - 1)) ? 1U : 0U;
+
+		refEnqueueCharNrzi(encoderData, (((packet->pathSSIDs[p] + '0') << 1) + isEnd), true);
+	}
+
+	refEnqueueCharNrzi(encoderData, 0x03, true);
+	refEnqueueCharNrzi(encoderData, 0xF0, true);
+
+	uint8_t symbol = (packet->iconIndex + '!');
+	uint8_t symTable = ((packet->iconTable == 0) ? '/' : '\\');
+	const char *courseAndSpeed = (packet->courseAndSpeed ? packet->courseSpeedStr : NULL);
+
+	refEnqueueCharNrzi(encoderData, '!', true);
+
+	if (packet->compressed)
+	{
+		refEnqueueCharNrzi(encoderData, symTable, true);
+		refEnqueueString(encoderData, packet->latStr);
+		refEnqueueString(encoderData, packet->lonStr);
+		refEnqueueCharNrzi(encoderData, symbol, true);
+		refEnqueueString(encoderData, (courseAndSpeed ? courseAndSpeed : "  "));
+		refEnqueueCharNrzi(encoderData, (courseAndSpeed ? (0x3E + '!') : '!'), true);
+	}
+	else
+	{
+		refEnqueueString(encoderData, packet->latStr);
+		refEnqueueCharNrzi(encoderData, symTable, true);
+		refEnqueueString(encoderData, packet->lonStr);
+		refEnqueueCharNrzi(encoderData, symbol, true);
+
+		if (courseAndSpeed != NULL)
+		{
+			refEnqueueString(encoderData, courseAndSpeed);
+		}
+	}
+
+	if (packet->comment[0] != 0)
+	{
+		refEnqueueString(encoderData, packet->comment);
+	}
+}
+
+// Header and payload, as aprs.c composes them now
+static void enqueuePacket(AX25Encoder_t *encoderData, const testPacket_t *packet)
+{
+	for (uint32_t i = 0; i < strlen(APRS_DESTINATION); i++)
+	{
+		ax25EnqueueChar(encoderData, (APRS_DESTINATION[i] << 1));
+	}
+	ax25EnqueueChar(encoderData, ('0' << 1));
+
+	uint8_t len = SAFE_MIN(strlen(packet->callsign), 6U);
+
+	for (uint8_t i = 0; i < len; i++)
+	{
+		ax25EnqueueChar(encoderData, (packet->callsign[i] << 1));
+	}
+
+	if (len < 6U)
+	{
+		ax25EnqueuePadOfLength(encoderData, (6U - len));
+	}
+
+	ax25EnqueueChar(encoderData, ((packet->senderSSID + '0') << 1));
+
+	uint8_t numPaths = ((strlen(packet->pathNames[1]) == 0) ? 1U : 2U);
+
+	for (uint8_t p = 0; p < numPaths; p++)
+	{
+		len = SAFE_MIN(strlen(packet->pathNames[p]), 6U);
+
+		for (uint8_t i = 0; i < len; i++)
+		{
+			ax25EnqueueChar(encoderData, (packet->pathNames[p][i] << 1));
+		}
+
+		if (len < 6U)
+		{
+			ax25EnqueuePadOfLength(encoderData, (6U - len));
+		}
+
+		uint8_t isEnd = (p == (numPaths - 1)) ? 1U : 0U;
+
+		ax25EnqueueChar(encoderData, (((packet->pathSSIDs[p] + '0') << 1) + isEnd));
+	}
+
+	ax25EnqueueChar(encoderData, 0x03);
+	ax25EnqueueChar(encoderData, 0xF0);
+
+	uint8_t symbol = (packet->iconIndex + '!');
+	uint8_t symTable = ((packet->iconTable == 0) ? '/' : '\\');
+	const char *courseAndSpeed = (packet->courseAndSpeed ? packet->courseSpeedStr : NULL);
+
+	ax25EnqueueChar(encoderData, '!');
+
+	if (packet->compressed)
+	{
+		ax25EnqueueChar(encoderData, symTable);
+		ax25EnqueueString(encoderData, packet->latStr);
+		ax25EnqueueString(encoderData, packet->lonStr);
+		ax25EnqueueChar(encoderData, symbol);
+		ax25EnqueueString(encoderData, (courseAndSpeed ? courseAndSpeed : "  "));
+		ax25EnqueueChar(encoderData, (courseAndSpeed ? (0x3E + '!') : '!'));
+	}
+	else
+	{
+		ax25EnqueueString(encoderData, packet->latStr);
+		ax25EnqueueChar(encoderData, symTable);
+		ax25EnqueueString(encoderData, packet->lonStr);
+		ax25EnqueueChar(encoderData, symbol);
+
+		if (courseAndSpeed != NULL)
+		{
+			ax25EnqueueString(encoderData, courseAndSpeed);
+		}
+	}
+
+	if (packet->comment[0] != 0)
+	{
+		ax25EnqueueString(encoderData, packet->comment);
+	}
+}
+
+static void randomString(char *str, uint32_t length, const char *alphabet)
+{
+	uint32_t alphabetLength = strlen(alphabet);
+
+	for (uint32_t i = 0U; i < length; i++)
+	{
+		str[i] = alphabet[randomNext() % alphabetLength];
+	}
+	str[length] = 0;
+}
+
+// Base 91 digits of the compressed position format
+static void randomBase91(char *str, uint32_t length)
+{
+	for (uint32_t i = 0U; i < length; i++)
+	{
+		str[i] = ('!' + (randomNext() % 91U));
+	}
+	str[length] = 0;
+}
+
+static void randomPacket(testPacket_t *packet)
+{
+	static const char *paths[] = { "WIDE1", "WIDE2", "RELAY", "TRACE3", "ARISS", "SGATE", "" };
+	static const char CALLSIGN_CHARS[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+	static const char COMMENT_CHARS[] = " !\"#$%&'()*+,-./0123456789:;<=>?@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_`abcdefghijklmnopqrstuvwxyz{|}~";
+
+	memset(packet, 0, sizeof(testPacket_t));
+
+	randomString(packet->callsign, (3U + (randomNext() % 4U)), CALLSIGN_CHARS);
+	packet->senderSSID = (randomNext() % 16U);
+	strcpy(packet->pathNames[0], paths[randomNext() % 6U]);
+	packet->pathSSIDs[0] = (randomNext() % 8U);
+	strcpy(packet->pathNames[1], paths[randomNext() % 7U]);
+	packet->pathSSIDs[1] = (randomNext() % 8U);
+	packet->compressed = (randomNext() & 1U);
+	packet->iconTable = (randomNext() & 1U);
+	packet->iconIndex = (randomNext() % 94U);
+	packet->courseAndSpeed = (randomNext() & 1U); // SmartBeaconing, when moving
+
+	if (packet->compressed)
+	{
+		randomBase91(packet->latStr, 4U);
+		randomBase91(packet->lonStr, 4U);
+		randomBase91(packet->courseSpeedStr, 2U);
+	}
+	else
+	{
+		uint32_t lat = (randomNext() % 90U);
+		uint32_t lon = (randomNext() % 180U);
+
+		// 1/100 of minute, and the ambiguity of aprs.c blanks out the last digits
+		snprintf(packet->latStr, sizeof(packet->latStr), "%02u%02u.%02u%c", lat, (randomNext() % 60U), (randomNext() % 100U), ((randomNext() & 1U) ? 'N' : 'S'));
+		snprintf(packet->lonStr, sizeof(packet->lonStr), "%03u%02u.%02u%c", lon, (randomNext() % 60U), (randomNext() % 100U), ((randomNext() & 1U) ? 'E' : 'W'));
+		for (uint32_t i = (7U - (randomNext() % 5U)); i < 7U; i++)
+		{
+			if (packet->latStr[i] != '.')
+			{
+				packet->latStr[i] = ' ';
+				packet->lonStr[i + 1] = ' ';
+			}
+		}
+		snprintf(packet->courseSpeedStr, sizeof(packet->courseSpeedStr), "%03u/%03u", (randomNext() % 360U), (randomNext() % 200U));
+	}
+
+	randomString(packet->comment, ((randomNext() & 3U) ? (randomNext() % 41U) : 0U), COMMENT_CHARS);
+}
+
+// Compare both bitmaps over the keyed bits, the tone bitmap is LSB first in 32-bit words now, in octets before
+static bool sameBitstream(const refEncoder_t *refEncoder, uint32_t refBits, const AX25Encoder_t *encoder, uint32_t bits)
+{
+	if ((refBits != bits) || (refEncoder->packetBufferBitPosition != encoder->packetBufferBitPosition))
+	{
+		return false;
+	}
+
+	for (uint32_t i = 0U; i < bits; i++)
+	{
+		if (((refEncoder->packetBuffer[i >> 3] >> (i & 0x07U)) & 0x01U) != ((encoder->packetBuffer[i >> 5] >> (i & 0x1FU)) & 0x01U))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static void testPackets(void)
+{
+	static refEncoder_t refEncoder;
+	static AX25Encoder_t encoder;
+	static const testPacket_t corpus[] =
+	{
+		// Fixed station, uncompressed, one path
+		{ "VK3KYY", 9U, { "WIDE2", "" }, { 2U, 0U }, false, 0U, ('-' - '!'), "3749.  S", "14458.  E", "", false, "OpenGD77" },
+		// Mobile, uncompressed with course and speed, two paths
+		{ "F1RMB", 7U, { "WIDE1", "WIDE2" }, { 1U, 1U }, false, 0U, ('>' - '!'), "4851.23N", "00221.51E", "088/036", true, "" },
+		// SmartBeaconing, compressed with course and speed
+		{ "G4KYF", 0U, { "WIDE1", "" }, { 1U, 0U }, true, 1U, ('k' - '!'), "5L!!", "<*e7", "7P", true, "Hello" },
+		// Compressed without course and speed, short callsign, ISS path
+		{ "K1A", 15U, { "ARISS", "" }, { 0U, 0U }, true, 0U, ('[' - '!'), "~~~~", "~~~~", "", false, "~~~~~~~~~~~~~~~~~~~~" },
+	};
+	uint32_t mismatches = 0U, totalBits = 0U;
+	testPacket_t packet;
+
+	// FCS of the CRC-16/X.25 check string
+	ax25EncoderReset(&encoder);
+	ax25EnqueueString(&encoder, "123456789");
+	ax25EncodeFrame(&encoder, LEADING_FLAGS, TRAILING_FLAGS);
+	HOST_CHECK((encoder.frameLength == 11U) && (encoder.frameBuffer[9] == 0x6E) && (encoder.frameBuffer[10] == 0x90));
+
+	for (uint32_t n = 0U; n < ((sizeof(corpus) / sizeof(corpus[0])) + RANDOM_PACKETS); n++)
+	{
+		uint32_t refBits, bits;
+
+		if (n < (sizeof(corpus) / sizeof(corpus[0])))
+		{
+			memcpy(&packet, &corpus[n], sizeof(testPacket_t));
+		}
+		else
+		{
+			randomPacket(&packet);
+		}
+
+		refEncoderReset(&refEncoder);
+		refEnqueuePacket(&refEncoder, &packet);
+		refBits = refEncodeFrame(&refEncoder);
+
+		ax25EncoderReset(&encoder);
+		enqueuePacket(&encoder, &packet);
+		bits = ax25EncodeFrame(&encoder, LEADING_FLAGS, TRAILING_FLAGS);
+
+		totalBits += bits;
+		if (sameBitstream(&refEncoder, refBits, &encoder, bits) == false)
+		{
+			if (mismatches < 4U)
+			{
+				printf("  mismatch on packet %u (%s, %u bits, %u by the reference)\n", n, packet.comment, bits, refBits);
+			}
+			mismatches++;
+		}
+	}
+
+	printf("  %u position packets (%u keyed bits): %u bitstream mismatches\n", (uint32_t)((sizeof(corpus) / sizeof(corpus[0])) + RANDOM_PACKETS), totalBits, mismatches);
+	HOST_CHECK(mismatches == 0U);
+}
+
+static void testFrames(void)
+{
+	static refEncoder_t refEncoder;
+	static AX25Encoder_t encoder;
+	uint32_t mismatches = 0U;
+
+	for (uint32_t n = 0U; n < RANDOM_FRAMES; n++)
+	{
+		uint32_t length = (1U + (randomNext() % RANDOM_FRAME_LENGTH_MAX));
+		uint32_t mode = (n % 3U);
+		uint32_t refBits, bits;
+
+		refEncoderReset(&refEncoder);
+		ax25EncoderReset(&encoder);
+
+		for (uint32_t i = 0U; i < length; i++)
+		{
+			uint8_t octet = randomNext();
+
+			if (mode == 1U)
+			{
+				octet |= 0xF0; // runs of ones across the octets
+			}
+			else if (mode == 2U)
+			{
+				octet = ((randomNext() & 3U) ? 0xFF : octet); // runs of ones across the 24-bit chunks
+			}
+
+			refEnqueueCharNrzi(&refEncoder, octet, true);
+			ax25EnqueueChar(&encoder, octet);
+		}
+
+		refBits = refEncodeFrame(&refEncoder);
+		bits = ax25EncodeFrame(&encoder, LEADING_FLAGS, TRAILING_FLAGS);
+
+		if (sameBitstream(&refEncoder, refBits, &encoder, bits) == false)
+		{
+			mismatches++;
+		}
+	}
+
+	printf("  %u random frames: %u bitstream mismatches\n", RANDOM_FRAMES, mismatches);
+	HOST_CHECK(mismatches == 0U);
+}
+
+static void benchmark(void)
+{
+	static refEncoder_t refEncoder;
+	static AX25Encoder_t encoder;
+	static testPacket_t packets[16];
+	uint32_t check = 0U;
+	double start, rate, refRate;
+
+	for (uint32_t i = 0U; i < 16U; i++)
+	{
+		randomPacket(&packets[i]);
+	}
+
+	start = hostSeconds();
+	for (uint32_t n = 0U; n < BENCHMARK_PACKETS; n++)
+	{
+		refEncoderReset(&refEncoder);
+		refEnqueuePacket(&refEncoder, &packets[n % 16U]);
+		check += refEncodeFrame(&refEncoder) + refEncoder.packetBuffer[n % 64U];
+	}
+	refRate = BENCHMARK_PACKETS / (hostSeconds() - start);
+
+	start = hostSeconds();
+	for (uint32_t n = 0U; n < BENCHMARK_PACKETS; n++)
+	{
+		ax25EncoderReset(&encoder);
+		enqueuePacket(&encoder, &packets[n % 16U]);
+		check += ax25EncodeFrame(&encoder, LEADING_FLAGS, TRAILING_FLAGS) + encoder.packetBuffer[n % 16U];
+	}
+	rate = BENCHMARK_PACKETS / (hostSeconds() - start);
+
+	printf("  position packet encode: %.0f packets/s (%.1f us) by the reference, %.0f packets/s (%.1f us) now (x%.1f) [%u]\n",
+			refRate, (1E6 / refRate), rate, (1E6 / rate), (rate / refRate), check);
+	HOST_CHECK(rate > refRate);
+}
+
+int main(void)
+{
+	printf("AX.25 frame builder\n");
+
+	testPackets();
+	testFrames();
+	benchmark();
+
+	if (hostCheckFailures() != 0)
+	{
+		printf("FAILED (%d)\n", hostCheckFailures());
+		return 1;
+	}
+
+	printf("OK\n");
+	return 0;
+}
@@ -0,0 +1,385 @@
+/*
+ * Copyright (C) 2024 Roger Clark, VK3KYY / G4KYF
+ *                    Daniel Caujolle-Bert, F1RMB
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+ *    in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. Use of this source code or binary releases for commercial purposes is strictly forbidden. This includes, without limitation,
+ *    incorporation in a commercial product or incorporation into a product or project which allows commercial use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// Channels sorted by distance (channelDistance.c): the order is checked against the great circle distances, and the
+// incremental re-sort along a GPS track against sorts from scratch. Then it is timed against the previous sort,
+// kept below (haversine distance of every channel, then a recursive quicksort), for 80 and 1024 channels.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "functions/channelDistance.h"
+#include "hostSupport.h"
+
+#define CHANNELS_MAX          1024U
+#define TRACK_STEPS           2000U
+#define BENCHMARK_SORTS       2000U
+#define DISTANCE_TOLERANCE_KM 0.01 // Q29 positions from float trigonometry
+
+// Previous temporary storage while sorting a zone
+typedef struct
+{
+	uint16_t index;
+	int32_t	 distance;
+} channelDistance_t;
+
+typedef struct
+{
+	double latitude;
+	double longitude;
+	bool   hasLocation;
+} testChannel_t;
+
+static testChannel_t channels[CHANNELS_MAX];
+static channelLocation_t locations[CHANNELS_MAX];
+static uint16_t order[CHANNELS_MAX];
+static uint16_t freshOrder[CHANNELS_MAX];
+static uint64_t distances[CHANNELS_MAX];
+static channelDistance_t channelDistances[CHANNELS_MAX];
+static uint32_t randomState = 0x600DF00D;
+
+
+static uint32_t randomNext(void)
+{
+	randomState ^= (randomState << 13);
+	randomState ^= (randomState >> 17);
+	randomState ^= (randomState << 5);
+
+	return randomState;
+}
+
+static double randomUniform(double low, double high)
+{
+	return (low + ((high - low) * ((double)randomNext() / 4294967296.0)));
+}
+
+// Previous distanceToLocation()
+static double refDistanceToLocation(double latitude, double longitude, double ownLatitude, double ownLongitude)
+{
+	double lat1 = latitude;
+	double lon1 = longitude;
+	double lat2 = ownLatitude;
+	double lon2 = ownLongitude;
+
+	double r = 6371; //radius of Earth (KM)
+	double p = 0.017453292519943295;//  Pi/180
+	double a = 0.5 - cos((lat2 - lat1)*p)/2 + cos(lat1 * p)*cos(lat2 * p) * (1 - cos((lon2 - lon1) * p )) / 2;
+
+	double d = 2 * r * asin(sqrt(a));
+
+	return d;
+}
+
+// Previous quicksortChannelByDistance()
+static void refQuicksortChannelByDistance(channelDistance_t *channelDistances, uint16_t first, uint16_t last)
+{
+	channelDistance_t temp;
+	uint16_t i, j, pivot;
+
+	if(first < last)
+	{
+		pivot = first;
+		i = first;
+		j = last;
+
+		while (i < j)
+		{
+			while ((channelDistances[i].distance <= channelDistances[pivot].distance) && (i < last))
+			{
+				i++;
+			}
+
+			while (channelDistances[j].distance > channelDistances[pivot].distance)
+			{
+				j--;
+			}
+
+			if (i < j)
+			{
+				memcpy(&temp, &channelDistances[i], sizeof(channelDistance_t));
+				memcpy(&channelDistances[i], &channelDistances[j], sizeof(channelDistance_t));
+				memcpy(&channelDistances[j], &temp, sizeof(channelDistance_t));
+			}
+		}
+
+		memcpy(&temp, &channelDistances[pivot], sizeof(channelDistance_t));
+		memcpy(&channelDistances[pivot], &channelDistances[j], sizeof(channelDistance_t));
+		memcpy(&channelDistances[j], &temp, sizeof(channelDistance_t));
+
+		if (j > 0)
+		{
+			refQuicksortChannelByDistance(channelDistances, first, (j - 1));
+		}
+
+		refQuicksortChannelByDistance(channelDistances, (j + 1), last);
+	}
+}
+
+// Previous initSortedChannels(), without the codeplug reads
+static void refSortChannels(uint16_t count, double ownLatitude, double ownLongitude)
+{
+	for (uint16_t i = 0; i < count; i++)
+	{
+		int32_t distanceX10 = -1;
+
+		channelDistances[i].index = i;
+
+		if (channels[i].hasLocation)
+		{
+			distanceX10 = refDistanceToLocation(channels[i].latitude, channels[i].longitude, ownLatitude, ownLongitude) * 10;
+		}
+
+		if ((distanceX10 != -1) && (distanceX10 < 65535))
+		{
+			channelDistances[i].distance = distanceX10;
+		}
+		else
+		{
+			channelDistances[i].distance = (500000 + i);
+		}
+	}
+
+	refQuicksortChannelByDistance(channelDistances, 0U, (count - 1));
+}
+
+static void sortFromScratch(uint16_t count, double latitude, double longitude, uint16_t *sortOrder)
+{
+	int32_t ownPosition[3];
+
+	channelDistancePositionFromLatLong(latitude, longitude, ownPosition);
+	channelDistanceSort(locations, sortOrder, distances, count, ownPosition, false);
+}
+
+// A repeaters zone around a town, some far away channels, a few sharing a location, and some without a location
+static void buildChannels(uint16_t count, double latitude, double longitude)
+{
+	for (uint16_t i = 0; i < count; i++)
+	{
+		uint32_t r = (randomNext() % 100);
+
+		channels[i].hasLocation = (r >= 10);
+
+		if (r < 75)
+		{
+			channels[i].latitude = (latitude + randomUniform(-1.5, 1.5));
+			channels[i].longitude = (longitude + randomUniform(-2.0, 2.0));
+		}
+		else if ((r < 85) && (i > 0))
+		{
+			channels[i] = channels[randomNext() % i];
+		}
+		else
+		{
+			channels[i].latitude = randomUniform(-85.0, 85.0);
+			channels[i].longitude = randomUniform(-180.0, 180.0);
+		}
+
+		locations[i].index = (i + 1);
+		if (channels[i].hasLocation)
+		{
+			channelDistancePositionFromLatLong(channels[i].latitude, channels[i].longitude, locations[i].position);
+		}
+		else
+		{
+			memset(locations[i].position, 0x00, sizeof(locations[i].position));
+		}
+	}
+
+	sortFromScratch(count, latitude, longitude, order);
+}
+
+// Nearest first, then the channels without a location in zone order
+static void checkOrder(uint16_t count, double latitude, double longitude, const uint16_t *sortOrder, uint32_t *misordered)
+{
+	bool seen[CHANNELS_MAX] = { false };
+	uint16_t i;
+	double previous = 0.0;
+
+	for (i = 0; i < count; i++)
+	{
+		HOST_CHECK(sortOrder[i] < count);
+		HOST_CHECK(seen[sortOrder[i]] == false);
+		seen[sortOrder[i]] = true;
+	}
+
+	for (i = 0; (i < count) && channels[sortOrder[i]].hasLocation; i++)
+	{
+		double distance = refDistanceToLocation(channels[sortOrder[i]].latitude, channels[sortOrder[i]].longitude, latitude, longitude);
+
+		if (distance < (previous - DISTANCE_TOLERANCE_KM))
+		{
+			(*misordered)++;
+		}
+		previous = distance;
+	}
+
+	for (uint16_t first = i; i < count; i++)
+	{
+		HOST_CHECK(channels[sortOrder[i]].hasLocation == false);
+		HOST_CHECK((i == first) || (sortOrder[i] > sortOrder[i - 1]));
+	}
+}
+
+// The previous sort agrees, apart from the distances within its 0.1 km resolution, and the channels beyond 6553.5 km
+// which it grouped with the ones without a location
+static uint32_t compareWithPrevious(uint16_t count, double latitude, double longitude, const uint16_t *sortOrder)
+{
+	uint32_t differences = 0;
+
+	refSortChannels(count, latitude, longitude);
+
+	for (uint16_t i = 0; i < count; i++)
+	{
+		if ((channelDistances[i].index != sortOrder[i]) && (channelDistances[i].distance < 65535))
+		{
+			double expected = refDistanceToLocation(channels[channelDistances[i].index].latitude, channels[channelDistances[i].index].longitude, latitude, longitude);
+			double found = refDistanceToLocation(channels[sortOrder[i]].latitude, channels[sortOrder[i]].longitude, latitude, longitude);
+
+			if (fabs(expected - found) > 0.1)
+			{
+				differences++;
+			}
+		}
+	}
+
+	return differences;
+}
+
+// Driving around, one GPS fix every 50 m or so: the zone is re-sorted from its previous order, and must match the heap sort from scratch
+static void testTrack(uint16_t count)
+{
+	double latitude = 45.0;
+	double longitude = 5.0;
+	double heading = 0.0;
+	uint32_t misordered = 0;
+	uint32_t differences = 0;
+	uint32_t mismatches = 0;
+	int32_t ownPosition[3];
+
+	buildChannels(count, latitude, longitude);
+
+	for (uint32_t step = 0; step < TRACK_STEPS; step++)
+	{
+		heading += randomUniform(-0.3, 0.3);
+		latitude += (0.00045 * cos(heading));
+		longitude += (0.00064 * sin(heading));
+
+		// Sometimes a jump, e.g. the location entered by hand
+		if ((randomNext() % 200) == 0)
+		{
+			latitude = (45.0 + randomUniform(-2.0, 2.0));
+			longitude = (5.0 + randomUniform(-2.5, 2.5));
+		}
+
+		channelDistancePositionFromLatLong(latitude, longitude, ownPosition);
+		channelDistanceSort(locations, order, distances, count, ownPosition, true);
+
+		sortFromScratch(count, latitude, longitude, freshOrder);
+		if (memcmp(order, freshOrder, (count * sizeof(uint16_t))) != 0)
+		{
+			mismatches++;
+		}
+
+		checkOrder(count, latitude, longitude, order, &misordered);
+		if ((step % 20) == 0)
+		{
+			differences += compareWithPrevious(count, latitude, longitude, order);
+		}
+	}
+
+	printf("  %4u channels, %u locations: %u incremental/from scratch mismatches, %u misordered, %u differences with the previous sort\n",
+			count, TRACK_STEPS, mismatches, misordered, differences);
+	HOST_CHECK(mismatches == 0);
+	HOST_CHECK(misordered == 0);
+	HOST_CHECK(differences == 0);
+}
+
+static void benchmark(uint16_t count)
+{
+	double latitude = 45.0;
+	double longitude = 5.0;
+	uint32_t check = 0;
+	int32_t ownPosition[3];
+	double start;
+	double refRate;
+	double scratchRate;
+	double incrementalRate;
+
+	buildChannels(count, latitude, longitude);
+
+	start = hostSeconds();
+	for (uint32_t i = 0; i < BENCHMARK_SORTS; i++)
+	{
+		refSortChannels(count, (latitude + (i * 0.00001)), longitude);
+		check += channelDistances[0].index;
+	}
+	refRate = BENCHMARK_SORTS / (hostSeconds() - start);
+
+	start = hostSeconds();
+	for (uint32_t i = 0; i < BENCHMARK_SORTS; i++)
+	{
+		sortFromScratch(count, (latitude + (i * 0.00001)), longitude, freshOrder);
+		check += freshOrder[0];
+	}
+	scratchRate = BENCHMARK_SORTS / (hostSeconds() - start);
+
+	start = hostSeconds();
+	for (uint32_t i = 0; i < BENCHMARK_SORTS; i++)
+	{
+		channelDistancePositionFromLatLong((latitude + (i * 0.00001)), longitude, ownPosition);
+		channelDistanceSort(locations, order, distances, count, ownPosition, true);
+		check += order[0];
+	}
+	incrementalRate = BENCHMARK_SORTS / (hostSeconds() - start);
+
+	printf("  %4u channels: %.0f sorts/s previously, %.0f sorts/s now from scratch (x%.1f), %.0f sorts/s after a 1 m move (x%.1f) [%u]\n",
+			count, refRate, scratchRate, (scratchRate / refRate), incrementalRate, (incrementalRate / refRate), (check & 0x01));
+	// On the host, double maths costs about as much as integer maths: 1024 channels from scratch is close to the previous sort
+	HOST_CHECK((count > 80) || (scratchRate > refRate));
+	HOST_CHECK(incrementalRate > refRate);
+}
+
+int main(void)
+{
+	printf("Channels sorted by distance\n");
+
+	testTrack(80);
+	testTrack(1024);
+	benchmark(80);
+	benchmark(1024);
+
+	if (hostCheckFailures() != 0)
+	{
+		printf("FAILED (%d)\n", hostCheckFailures());
+		return EXIT_FAILURE;
+	}
+
+	printf("OK\n");
+	return EXIT_SUCCESS;
+}
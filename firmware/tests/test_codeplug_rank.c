@@ -0,0 +1,454 @@
+/*
+ * Copyright (C) 2024 Roger Clark, VK3KYY / G4KYF
+ *                    Daniel Caujolle-Bert, F1RMB
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+ *    in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. Use of this source code or binary releases for commercial purposes is strictly forbidden. This includes, without limitation,
+ *    incorporation in a commercial product or incorporation into a product or project which allows commercial use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// Rank/select over the zones and All Channels in use bitmaps of the codeplug (codeplugZoneGetDataForNumber(),
+// codeplugAllChannelsGetNextInUse()/GetPreviousInUse(), codeplugAllChannelsIndexSetUsed()) checked against the
+// previous bit by bit scans, kept below, on random codeplug images. Then both are timed.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hardware/SPI_Flash.h"
+#include "functions/codeplug.h"
+#include "functions/settings.h"
+#include "user_interface/uiGlobals.h"
+#include "user_interface/uiLocalisation.h"
+#include "flashModel.h"
+
+#define ZONES_MAX          250
+#define ZONES_BITMAP_SIZE  32U
+#define BENCHMARK_LOOPS    2000U
+
+extern const int CODEPLUG_ADDR_EX_ZONE_INUSE_PACKED_DATA;
+extern const int CODEPLUG_ADDR_EX_ZONE_LIST;
+extern const int CODEPLUG_ADDR_CHANNEL_HEADER_EEPROM;
+extern const int CODEPLUG_ADDR_CHANNEL_HEADER_FLASH;
+
+static const stringsTable_t testLanguage = { .all_channels = "All Channels" };
+const stringsTable_t *currentLanguage = &testLanguage;
+struct_codeplugZone_t currentZone;
+settingsStruct_t nonVolatileSettings;
+
+static uint8_t eeprom[0x20000];
+static uint8_t zonesInUse[ZONES_BITMAP_SIZE];
+static bool channelsInUse[CODEPLUG_CHANNELS_MAX + 1];// Numbered from 1
+static uint32_t randomState = 0x0BADCAFE;
+
+
+static uint32_t randomNext(void)
+{
+	randomState ^= (randomState << 13);
+	randomState ^= (randomState >> 17);
+	randomState ^= (randomState << 5);
+
+	return randomState;
+}
+
+bool EEPROM_Read(int address, uint8_t *buf, int size)
+{
+	memcpy(buf, &eeprom[address], size);
+	return true;
+}
+
+bool EEPROM_Write(int address, uint8_t *buf, int size)
+{
+	memcpy(&eeprom[address], buf, size);
+	return true;
+}
+
+// Previous codeplugZonesGetCount()
+static int refZonesGetCount(void)
+{
+	int numZones = 1;// Add one extra zone to allow for the special 'All Channels' Zone
+
+	for(int i = 0; i < ZONES_BITMAP_SIZE; i++)
+	{
+		numZones += __builtin_popcount(zonesInUse[i]);
+	}
+
+	return numZones;
+}
+
+// Previous codeplugZoneGetDataForNumber(), for the real zones
+static bool refZoneGetDataForNumber(int zoneNum, struct_codeplugZone_t *returnBuf)
+{
+	// Need to find the index into the Zones data for the specific Zone number.
+	// Because the Zones data is not guaranteed to be packed by the CPS (though we should attempt to make the CPS always pack the Zones)
+	int count = -1;// Need to start counting at -1 because the Zone number is zero indexed
+	int foundIndex = -1;
+
+	// Go though each byte in the In Use table
+	for(int i = 0; i < ZONES_BITMAP_SIZE; i++)
+	{
+		// Go though each binary bit, counting them one by one
+		for(int j = 0; j < 8; j++)
+		{
+			if (((zonesInUse[i] >> j) & 0x01) == 0x01)
+			{
+				count++;
+
+				if (count == zoneNum)
+				{
+					// found it. So save the index before we exit the "for" loops
+					foundIndex = (i * 8) + j;
+					break;// Will break out of this loop, but the outer loop breaks because it also checks for foundIndex
+				}
+			}
+		}
+	}
+
+	if (foundIndex != -1)
+	{
+		// Save this in case we need to add channels to a zone and hence need the index number so it can be saved back to the codeplug memory
+		returnBuf->NOT_IN_CODEPLUGDATA_indexNumber = foundIndex;
+
+		// IMPORTANT. Write size is different from the size of the data, because it the zone struct contains properties not in the codeplug data
+		EEPROM_Read(CODEPLUG_ADDR_EX_ZONE_LIST + (foundIndex * (16 + (sizeof(uint16_t) * codeplugChannelsPerZone))),
+				(uint8_t *)returnBuf, ((codeplugChannelsPerZone == 16) ? CODEPLUG_ZONE_DATA_ORIGINAL_STRUCT_SIZE : CODEPLUG_ZONE_DATA_OPENGD77_STRUCT_SIZE));
+
+
+		for(int i = 0; i < codeplugChannelsPerZone; i++)
+		{
+			// Empty channels seem to be filled with zeros, and zone could be full of channels.
+			if ((returnBuf->channels[i] == 0) || (i == (codeplugChannelsPerZone - 1)))
+			{
+				returnBuf->NOT_IN_CODEPLUGDATA_highestIndex = returnBuf->NOT_IN_CODEPLUGDATA_numChannelsInZone = (i + ((returnBuf->channels[i] == 0) ? 0 : 1));
+				return true;
+			}
+		}
+	}
+
+	memset(returnBuf->channels, 0, codeplugChannelsPerZone);
+	returnBuf->NOT_IN_CODEPLUGDATA_highestIndex = returnBuf->NOT_IN_CODEPLUGDATA_numChannelsInZone = 0;
+	returnBuf->NOT_IN_CODEPLUGDATA_indexNumber = -2; // we could not use '-1' on error, as -1 is All Channel zone
+
+	return false;
+}
+
+// Previous All Channels stepping, in the channel screen: up/down keys and scan
+static int refNextInUse(int index, int highestIndex)
+{
+	do
+	{
+		index = ((index % highestIndex) + 1);
+	} while (!codeplugAllChannelsIndexIsInUse(index));
+
+	return index;
+}
+
+static int refPreviousInUse(int index, int highestIndex)
+{
+	do
+	{
+		index = ((((index - 1) + highestIndex - 1) % highestIndex) + 1);
+	} while (!codeplugAllChannelsIndexIsInUse(index));
+
+	return index;
+}
+
+// 'density' percent of the bits set, in runs as the CPS tends to write them
+static void randomBitmap(bool *bits, int length, int density)
+{
+	for (int i = 0; i < length; i++)
+	{
+		if ((i % 16) == 0)
+		{
+			uint32_t r = (randomNext() % 100);
+
+			// Some whole empty or full areas
+			if ((density > 0) && (density < 100) && (r < 10))
+			{
+				int runEnd = (i + 16 + (randomNext() % 64));
+				bool value = (r < 5);
+
+				for (; (i < length) && (i < runEnd); i++)
+				{
+					bits[i] = value;
+				}
+
+				if (i >= length)
+				{
+					break;
+				}
+			}
+		}
+
+		bits[i] = ((int)(randomNext() % 100) < density);
+	}
+}
+
+static void buildImage(int zonesDensity, int channelsDensity)
+{
+	bool zoneBits[ZONES_BITMAP_SIZE * 8] = { false };
+
+	// Release the write-back cache, as the CPS does by reading into the sector buffer: the previous image sector must not land on the new one
+	SPI_Flash_read(0, SPI_Flash_sectorbuffer, 1);
+	flashModelInit(0xFF);
+	memset(eeprom, 0xFF, sizeof(eeprom));
+
+	// Zones, with a random channels count
+	randomBitmap(zoneBits, ZONES_MAX, zonesDensity);
+	memset(zonesInUse, 0, sizeof(zonesInUse));
+	for (int i = 0; i < ZONES_MAX; i++)
+	{
+		uint16_t channels[80] = { 0 };
+		int numChannels = (randomNext() % 81);
+
+		if (zoneBits[i])
+		{
+			zonesInUse[i / 8] |= (1 << (i % 8));
+		}
+
+		for (int c = 0; c < numChannels; c++)
+		{
+			channels[c] = (CODEPLUG_CHANNELS_MIN + (randomNext() % CODEPLUG_CHANNELS_MAX));
+		}
+		memset(&eeprom[CODEPLUG_ADDR_EX_ZONE_LIST + (i * CODEPLUG_ZONE_DATA_OPENGD77_STRUCT_SIZE)], 'Z', 16);
+		memcpy(&eeprom[CODEPLUG_ADDR_EX_ZONE_LIST + (i * CODEPLUG_ZONE_DATA_OPENGD77_STRUCT_SIZE) + 16], channels, sizeof(channels));
+	}
+	memcpy(&eeprom[CODEPLUG_ADDR_EX_ZONE_INUSE_PACKED_DATA], zonesInUse, sizeof(zonesInUse));
+
+	// Channels: bank 0 header is in the EEPROM, the 7 other ones in the Flash
+	randomBitmap(&channelsInUse[CODEPLUG_CHANNELS_MIN], CODEPLUG_CHANNELS_MAX, channelsDensity);
+	for (int bank = 0; bank < CODEPLUG_CHANNELS_BANKS_MAX; bank++)
+	{
+		uint8_t header[16] = { 0 };
+
+		for (int i = 0; i < CODEPLUG_CHANNELS_PER_BANK; i++)
+		{
+			if (channelsInUse[CODEPLUG_CHANNELS_MIN + (bank * CODEPLUG_CHANNELS_PER_BANK) + i])
+			{
+				header[i / 8] |= (1 << (i % 8));
+			}
+		}
+
+		if (bank == 0)
+		{
+			memcpy(&eeprom[CODEPLUG_ADDR_CHANNEL_HEADER_EEPROM], header, sizeof(header));
+		}
+		else
+		{
+			memcpy(&flashModelMemory[FLASH_ADDRESS_OFFSET + CODEPLUG_ADDR_CHANNEL_HEADER_FLASH +
+									 ((bank - 1) * ((CODEPLUG_CHANNELS_PER_BANK * CODEPLUG_CHANNEL_DATA_STRUCT_SIZE) + 16))], header, sizeof(header));
+		}
+	}
+
+	HOST_CHECK(SPI_Flash_init());
+	codeplugChannelsPerZone = 80;
+	codeplugZonesInitCache();
+	codeplugAllChannelsInitCache();
+}
+
+static void checkZones(void)
+{
+	struct_codeplugZone_t zone;
+	struct_codeplugZone_t refZone;
+	int numZones = codeplugZonesGetCount();
+
+	HOST_CHECK(numZones == refZonesGetCount());
+
+	// Every zone, out of range ones included
+	for (int n = -1; n <= (numZones + 1); n++)
+	{
+		bool result;
+		bool refResult;
+
+		if (n == (numZones - 1))
+		{
+			continue;// All Channels
+		}
+
+		memset(&zone, 0, sizeof(zone));
+		memset(&refZone, 0, sizeof(refZone));
+		result = codeplugZoneGetDataForNumber(n, &zone);
+		refResult = refZoneGetDataForNumber(n, &refZone);
+
+		HOST_CHECK(result == refResult);
+		HOST_CHECK(memcmp(&zone, &refZone, sizeof(zone)) == 0);
+	}
+}
+
+// All Channels: count, highest channel, and stepping up and down from every channel, in use or not
+static void checkAllChannels(void)
+{
+	struct_codeplugZone_t zone;
+	int numChannels = 0;
+	int highestIndex = 0;
+
+	for (int i = CODEPLUG_CHANNELS_MIN; i <= CODEPLUG_CHANNELS_MAX; i++)
+	{
+		HOST_CHECK(codeplugAllChannelsIndexIsInUse(i) == channelsInUse[i]);
+		if (channelsInUse[i])
+		{
+			numChannels++;
+			highestIndex = i;
+		}
+	}
+
+	HOST_CHECK(codeplugZoneGetDataForNumber((codeplugZonesGetCount() - 1), &zone));
+	HOST_CHECK(zone.NOT_IN_CODEPLUGDATA_indexNumber == -1);
+	HOST_CHECK(zone.NOT_IN_CODEPLUGDATA_numChannelsInZone == numChannels);
+	HOST_CHECK(zone.NOT_IN_CODEPLUGDATA_highestIndex == highestIndex);
+
+	// The previous stepping never ends without any channel in use
+	if (numChannels == 0)
+	{
+		HOST_CHECK(codeplugAllChannelsGetNextInUse(1) == 1);
+		HOST_CHECK(codeplugAllChannelsGetPreviousInUse(1) == 1);
+		return;
+	}
+
+	for (int i = CODEPLUG_CHANNELS_MIN; i <= highestIndex; i++)
+	{
+		HOST_CHECK(codeplugAllChannelsGetNextInUse(i) == refNextInUse(i, highestIndex));
+		HOST_CHECK(codeplugAllChannelsGetPreviousInUse(i) == refPreviousInUse(i, highestIndex));
+	}
+}
+
+static void testImage(int zonesDensity, int channelsDensity)
+{
+	struct_codeplugZone_t zone;
+	int added = 0;
+
+	buildImage(zonesDensity, channelsDensity);
+	checkZones();
+	checkAllChannels();
+
+	// New channels, some of them already in use, as when saving a VFO to a new channel
+	for (int n = 0; n < 200; n++)
+	{
+		int index = (CODEPLUG_CHANNELS_MIN + (randomNext() % CODEPLUG_CHANNELS_MAX));
+
+		added += (channelsInUse[index] ? 0 : 1);
+		channelsInUse[index] = true;
+		codeplugAllChannelsIndexSetUsed(index);
+
+		if ((n % 20) == 0)
+		{
+			checkAllChannels();
+		}
+	}
+	checkAllChannels();
+
+	// The bitmaps were written back
+	HOST_CHECK(SPI_Flash_flush());
+	codeplugAllChannelsInitCache();
+	checkAllChannels();
+
+	codeplugZoneGetDataForNumber((codeplugZonesGetCount() - 1), &zone);
+	printf("  %3d%% zones, %3d%% channels: %3d zones, %4d channels after %3d added\n", zonesDensity, channelsDensity,
+			(codeplugZonesGetCount() - 1), zone.NOT_IN_CODEPLUGDATA_numChannelsInZone, added);
+}
+
+static void benchmark(void)
+{
+	struct_codeplugZone_t zone;
+	int numZones;
+	int highestIndex;
+	uint32_t check = 0;
+	double start;
+	double refZonesRate;
+	double zonesRate;
+	double refStepRate;
+	double stepRate;
+
+	buildImage(100, 5);
+	numZones = (codeplugZonesGetCount() - 1);
+	codeplugZoneGetDataForNumber(numZones, &zone);
+	highestIndex = zone.NOT_IN_CODEPLUGDATA_highestIndex;
+
+	// Zone menu listing all the zones
+	start = hostSeconds();
+	for (uint32_t l = 0; l < BENCHMARK_LOOPS; l++)
+	{
+		for (int n = 0; n < numZones; n++)
+		{
+			check += refZoneGetDataForNumber(n, &zone);
+		}
+	}
+	refZonesRate = (BENCHMARK_LOOPS * numZones) / (hostSeconds() - start);
+
+	start = hostSeconds();
+	for (uint32_t l = 0; l < BENCHMARK_LOOPS; l++)
+	{
+		for (int n = 0; n < numZones; n++)
+		{
+			check += codeplugZoneGetDataForNumber(n, &zone);
+		}
+	}
+	zonesRate = (BENCHMARK_LOOPS * numZones) / (hostSeconds() - start);
+
+	// Scanning the All Channels zone, a few channels in use
+	start = hostSeconds();
+	for (uint32_t l = 0; l < BENCHMARK_LOOPS; l++)
+	{
+		for (int i = CODEPLUG_CHANNELS_MIN; i <= highestIndex; i += 7)
+		{
+			check += refNextInUse(i, highestIndex);
+		}
+	}
+	refStepRate = (BENCHMARK_LOOPS * ((highestIndex + 6) / 7)) / (hostSeconds() - start);
+
+	start = hostSeconds();
+	for (uint32_t l = 0; l < BENCHMARK_LOOPS; l++)
+	{
+		for (int i = CODEPLUG_CHANNELS_MIN; i <= highestIndex; i += 7)
+		{
+			check += codeplugAllChannelsGetNextInUse(i);
+		}
+	}
+	stepRate = (BENCHMARK_LOOPS * ((highestIndex + 6) / 7)) / (hostSeconds() - start);
+
+	printf("  %d zones, Nth zone:               %.0f lookups/s previously, %.0f lookups/s now (x%.1f)\n", numZones, refZonesRate, zonesRate,
+			(zonesRate / refZonesRate));
+	printf("  5%% channels in use, next channel: %.0f steps/s previously, %.0f steps/s now (x%.1f) [%u]\n", refStepRate, stepRate,
+			(stepRate / refStepRate), (check & 0x01));
+	HOST_CHECK(zonesRate > refZonesRate);
+	HOST_CHECK(stepRate > refStepRate);
+}
+
+int main(void)
+{
+	printf("Codeplug zones and All Channels rank/select\n");
+
+	testImage(0, 0);
+	testImage(3, 1);
+	testImage(50, 50);
+	testImage(90, 97);
+	testImage(100, 100);
+	benchmark();
+
+	if (hostCheckFailures() != 0)
+	{
+		printf("FAILED (%d)\n", hostCheckFailures());
+		return EXIT_FAILURE;
+	}
+
+	printf("OK\n");
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,639 @@
+/*
+ * Copyright (C) 2024 Roger Clark, VK3KYY / G4KYF
+ *                    Daniel Caujolle-Bert, F1RMB
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+ *    in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. Use of this source code or binary releases for commercial purposes is strictly forbidden. This includes, without limitation,
+ *    incorporation in a commercial product or incorporation into a product or project which allows commercial use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// Contact lookups of the codeplug (codeplug.c), over randomized 1024 contacts codeplug images in the simulated
+// flash: the binary searched TG/PC lookups, the index ordered ones and the free index search are checked against
+// a linear scan of the image, after loading it and along random edits, insertions and removals.
+// The contacts cache built from chunked flash reads is compared, entry by entry, with the one of the previous read
+// per contact slot, kept below, along with the flash transactions and SPI clocks of both.
+// Then the TG/PC lookups are timed against the previous linear scan of the cache, kept below.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hardware/SPI_Flash.h"
+#include "functions/codeplug.h"
+#include "functions/settings.h"
+#include "user_interface/uiGlobals.h"
+#include "user_interface/uiLocalisation.h"
+#include "flashModel.h"
+
+#define NUMBERS_POOL_SIZE   300U // Plenty of contacts share their number
+#define EDITS_PER_IMAGE     1500U
+#define EDITS_PER_CHECK     250U
+#define BENCHMARK_LOOKUPS   200000U
+
+typedef struct
+{
+	bool     used;
+	uint32_t number;
+	uint8_t  callType;
+	uint8_t  reserve1;
+} testContact_t;
+
+// The cache entry of the previous implementation, ordered by contact index
+typedef struct
+{
+	uint32_t tgOrPCNum;
+	uint16_t index;
+} refContactCache_t;
+
+// Same layout as the contacts cache of codeplug.c
+typedef struct
+{
+	uint32_t tgOrPCNum;
+	uint16_t index;
+	uint16_t sortedByTGorPC;
+} testContactCache_t;
+
+typedef struct
+{
+	int numTGContacts;
+	int numPCContacts;
+	int numALLContacts;
+	int numDTMFContacts;
+	testContactCache_t contactsLookupCache[CODEPLUG_CONTACTS_MAX];
+	uint8_t contactsDTMFLookupCache[CODEPLUG_DTMF_CONTACTS_MAX];
+} testContactsCache_t;
+
+extern const int CODEPLUG_ADDR_CONTACTS;
+extern testContactsCache_t codeplugContactsCache;
+
+static const stringsTable_t testLanguage = { .tg = "TG" };
+const stringsTable_t *currentLanguage = &testLanguage;
+struct_codeplugZone_t currentZone;
+settingsStruct_t nonVolatileSettings;
+
+static uint8_t eeprom[0x20000];
+static testContact_t contacts[CODEPLUG_CONTACTS_MAX + 1];// Numbered from 1
+static uint32_t numbersPool[NUMBERS_POOL_SIZE];
+static refContactCache_t refCache[CODEPLUG_CONTACTS_MAX];
+static int refNumContacts;
+static uint32_t randomState = 0x1F2E3D4C;
+
+
+static uint32_t randomNext(void)
+{
+	randomState ^= (randomState << 13);
+	randomState ^= (randomState >> 17);
+	randomState ^= (randomState << 5);
+
+	return randomState;
+}
+
+bool EEPROM_Read(int address, uint8_t *buf, int size)
+{
+	memcpy(buf, &eeprom[address], size);
+	return true;
+}
+
+bool EEPROM_Write(int address, uint8_t *buf, int size)
+{
+	memcpy(&eeprom[address], buf, size);
+	return true;
+}
+
+static void randomContact(testContact_t *contact)
+{
+	static const uint8_t reserve1Values[] = { 0xFF, 0x01, 0x00, 0x02 };// No override, TS1, TS2
+	uint32_t r = (randomNext() % 100);
+
+	contact->used = true;
+	contact->number = numbersPool[randomNext() % NUMBERS_POOL_SIZE];
+	contact->callType = ((r < 55) ? CONTACT_CALLTYPE_TG : CONTACT_CALLTYPE_PC);
+	contact->reserve1 = reserve1Values[randomNext() % 4];
+
+	if (r >= 97)
+	{
+		contact->number = ALL_CALL_VALUE;
+		contact->callType = CONTACT_CALLTYPE_ALL;
+	}
+}
+
+static void contactToCodeplug(int index, const testContact_t *contact, struct_codeplugContact_t *codeplugContact)
+{
+	memset(codeplugContact, 0xFF, sizeof(struct_codeplugContact_t));
+	if (contact->used)
+	{
+		snprintf(codeplugContact->name, sizeof(codeplugContact->name), "C%d", index);
+		codeplugContact->tgNumber = contact->number;
+		codeplugContact->callType = contact->callType;
+		codeplugContact->reserve1 = contact->reserve1;
+	}
+	else
+	{
+		codeplugContact->tgNumber = 0;
+	}
+}
+
+// A codeplug image as written by the CPS: 'fill' percent of the slots are in use
+static void buildImage(int fill)
+{
+	// Release the write-back cache, as the CPS does by reading into the sector buffer: the previous image sector must not land on the new one
+	SPI_Flash_read(0, SPI_Flash_sectorbuffer, 1);
+	flashModelInit(0xFF);
+	memset(eeprom, 0xFF, sizeof(eeprom));
+
+	for (uint32_t i = 0; i < NUMBERS_POOL_SIZE; i++)
+	{
+		uint32_t r = (randomNext() % 3);
+
+		numbersPool[i] = ((r == 0) ? (1 + (randomNext() % 100)) : ((r == 1) ? (1 + (randomNext() % 999999)) : (1000000 + (randomNext() % 8999999))));
+	}
+
+	for (int i = CODEPLUG_CONTACTS_MIN; i <= CODEPLUG_CONTACTS_MAX; i++)
+	{
+		memset(&contacts[i], 0, sizeof(testContact_t));
+
+		if ((int)(randomNext() % 100) < fill)
+		{
+			struct_codeplugContact_t codeplugContact;
+
+			randomContact(&contacts[i]);
+			contactToCodeplug(i, &contacts[i], &codeplugContact);
+			codeplugContact.tgNumber = byteSwap32(int2bcd(codeplugContact.tgNumber));
+			memcpy(&flashModelMemory[FLASH_ADDRESS_OFFSET + CODEPLUG_ADDR_CONTACTS + ((i - 1) * CODEPLUG_CONTACT_DATA_SIZE)], &codeplugContact, CODEPLUG_CONTACT_DATA_SIZE);
+		}
+	}
+
+	HOST_CHECK(SPI_Flash_init());
+	codeplugInitCaches();
+}
+
+static void refCacheBuild(void)
+{
+	refNumContacts = 0;
+
+	for (int i = CODEPLUG_CONTACTS_MIN; i <= CODEPLUG_CONTACTS_MAX; i++)
+	{
+		if (contacts[i].used)
+		{
+			refCache[refNumContacts].tgOrPCNum = (contacts[i].number | (contacts[i].callType << 24));
+			refCache[refNumContacts].index = i;
+			refNumContacts++;
+		}
+	}
+}
+
+// Previous codeplugInitContactsCache() contacts loop, one flash read per slot (the sort is left out)
+static int refInitContactsCache(testContactsCache_t *cache)
+{
+	struct_codeplugContact_t contact;
+	int codeplugNumContacts = 0;
+
+	memset(cache, 0, sizeof(testContactsCache_t));
+
+	for (int i = 0; i < CODEPLUG_CONTACTS_MAX; i++)
+	{
+		if (SPI_Flash_read(FLASH_ADDRESS_OFFSET + (CODEPLUG_ADDR_CONTACTS + (i * CODEPLUG_CONTACT_DATA_SIZE)), (uint8_t *)&contact, 16 + 4 + 1))// Name + TG/ID + Call type
+		{
+			if (contact.name[0] != 0xFF)
+			{
+				cache->contactsLookupCache[codeplugNumContacts].tgOrPCNum = bcd2int(byteSwap32(contact.tgNumber));
+				cache->contactsLookupCache[codeplugNumContacts].index = i + 1;// Contacts are numbered from 1 to 1024
+				cache->contactsLookupCache[codeplugNumContacts].tgOrPCNum |= (contact.callType << 24);// Store the call type in the upper byte
+				if (contact.callType == CONTACT_CALLTYPE_PC)
+				{
+					cache->numPCContacts++;
+				}
+				else if (contact.callType == CONTACT_CALLTYPE_TG)
+				{
+					cache->numTGContacts++;
+				}
+				else if (contact.callType == CONTACT_CALLTYPE_ALL)
+				{
+					cache->numALLContacts++;
+				}
+
+				codeplugNumContacts++;
+			}
+		}
+	}
+
+	return codeplugNumContacts;
+}
+
+// Previous codeplugContactIndexByTGorPCFromNumber(), without the flash reads: the benchmark only looks up numbers
+// which are not in the cache, hence both implementations read nothing
+static int refContactIndexByTGorPCFromNumber(int number, uint32_t tgorpc, uint32_t callType)
+{
+	int numContacts = refNumContacts;
+
+	for (int i = number; i < numContacts; i++)
+	{
+		if (((refCache[i].tgOrPCNum & 0xFFFFFF) == tgorpc) &&
+				/* All Call, hence ignore callType */
+				((tgorpc == ALL_CALL_VALUE) || ((refCache[i].tgOrPCNum >> 24) == callType)))
+		{
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+// Previous codeplugContactsContainsPC()
+static bool refContactsContainsPC(uint32_t pc)
+{
+	int numContacts = refNumContacts;
+	pc = pc & 0x00FFFFFF;
+	pc = pc | (CONTACT_CALLTYPE_PC << 24);
+
+	for (int i = 0; i < numContacts; i++)
+	{
+		if (refCache[i].tgOrPCNum == pc)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool contactMatches(const testContact_t *contact, uint32_t tgorpc, uint32_t callType)
+{
+	return (contact->used && (contact->number == tgorpc) && ((tgorpc == ALL_CALL_VALUE) || (contact->callType == callType)));
+}
+
+static bool contactHasTS(const testContact_t *contact, uint8_t optionalTS)
+{
+	return (((contact->reserve1 & CODEPLUG_CONTACT_FLAG_NO_TS_OVERRIDE) == 0x00) &&
+			(((contact->reserve1 & CODEPLUG_CONTACT_FLAG_TS_OVERRIDE_TIMESLOT_MASK) >> 1) == (optionalTS - 1)));
+}
+
+static void checkReturnedContact(int index, const struct_codeplugContact_t *codeplugContact)
+{
+	HOST_CHECK(codeplugContact->NOT_IN_CODEPLUGDATA_indexNumber == index);
+	HOST_CHECK(codeplugContact->tgNumber == contacts[index].number);
+	HOST_CHECK(codeplugContact->callType == contacts[index].callType);
+	HOST_CHECK(codeplugContact->reserve1 == contacts[index].reserve1);
+}
+
+// The contact found for each time slot, then all the matches in index order
+static void checkTGorPC(uint32_t tgorpc, uint32_t callType)
+{
+	struct_codeplugContact_t codeplugContact;
+	int firstMatch = 0;
+	int position = -1;
+
+	for (uint8_t optionalTS = 0; optionalTS <= 2; optionalTS++)
+	{
+		int expected = 0;
+
+		for (int i = CODEPLUG_CONTACTS_MIN; i <= CODEPLUG_CONTACTS_MAX; i++)
+		{
+			if (contactMatches(&contacts[i], tgorpc, callType))
+			{
+				if (firstMatch == 0)
+				{
+					firstMatch = i;
+				}
+
+				if ((optionalTS == 0) || contactHasTS(&contacts[i], optionalTS))
+				{
+					expected = i;
+					break;
+				}
+			}
+		}
+
+		if (expected == 0)
+		{
+			expected = firstMatch;
+		}
+
+		position = codeplugContactIndexByTGorPC(tgorpc, callType, &codeplugContact, optionalTS);
+		if (expected == 0)
+		{
+			HOST_CHECK(position == -1);
+		}
+		else
+		{
+			HOST_CHECK(position >= 0);
+			checkReturnedContact(expected, &codeplugContact);
+		}
+	}
+
+	position = -1;
+	for (int i = CODEPLUG_CONTACTS_MIN; i <= CODEPLUG_CONTACTS_MAX; i++)
+	{
+		if (contactMatches(&contacts[i], tgorpc, callType))
+		{
+			position = codeplugContactIndexByTGorPCFromNumber((position + 1), tgorpc, callType, &codeplugContact, 0);
+			HOST_CHECK(position >= 0);
+			checkReturnedContact(i, &codeplugContact);
+		}
+	}
+	HOST_CHECK(codeplugContactIndexByTGorPCFromNumber((position + 1), tgorpc, callType, &codeplugContact, 0) == -1);
+}
+
+static void checkContainsPC(uint32_t pc)
+{
+	bool expected = false;
+
+	for (int i = CODEPLUG_CONTACTS_MIN; i <= CODEPLUG_CONTACTS_MAX; i++)
+	{
+		if (contacts[i].used && (contacts[i].callType == CONTACT_CALLTYPE_PC) && (contacts[i].number == pc))
+		{
+			expected = true;
+			break;
+		}
+	}
+
+	HOST_CHECK(codeplugContactsContainsPC(pc) == expected);
+	HOST_CHECK(codeplugContactsContainsPC(pc | (PC_CALL_FLAG << 24)) == expected);
+}
+
+// The menus walk the cache in index order: Nth contact of a call type, counts and free index
+static void checkIndexOrder(void)
+{
+	struct_codeplugContact_t codeplugContact;
+	int counts[3] = { 0, 0, 0 };
+	int freeIndex = 0;
+
+	for (int i = CODEPLUG_CONTACTS_MIN; i <= CODEPLUG_CONTACTS_MAX; i++)
+	{
+		if (contacts[i].used)
+		{
+			counts[contacts[i].callType]++;
+			HOST_CHECK(codeplugContactGetDataForNumberInType(counts[contacts[i].callType], contacts[i].callType, &codeplugContact) == i);
+			checkReturnedContact(i, &codeplugContact);
+		}
+		else if (freeIndex == 0)
+		{
+			freeIndex = i;
+		}
+	}
+
+	for (uint32_t callType = CONTACT_CALLTYPE_TG; callType <= CONTACT_CALLTYPE_ALL; callType++)
+	{
+		HOST_CHECK(codeplugContactsGetCount(callType) == counts[callType]);
+		HOST_CHECK(codeplugContactGetDataForNumberInType((counts[callType] + 1), callType, &codeplugContact) == 0);
+	}
+
+	HOST_CHECK(codeplugContactGetFreeIndex() == freeIndex);
+}
+
+static int checkAll(void)
+{
+	int lookups = 0;
+
+	checkIndexOrder();
+
+	for (uint32_t i = 0; i < NUMBERS_POOL_SIZE; i++)
+	{
+		checkTGorPC(numbersPool[i], CONTACT_CALLTYPE_TG);
+		checkTGorPC(numbersPool[i], CONTACT_CALLTYPE_PC);
+		checkContainsPC(numbersPool[i]);
+		lookups += 3;
+	}
+
+	// All Call, numbers around the used ones and out of the pool
+	checkTGorPC(ALL_CALL_VALUE, CONTACT_CALLTYPE_ALL);
+	for (uint32_t i = 0; i < 100; i++)
+	{
+		uint32_t number = ((i & 0x01) ? (numbersPool[randomNext() % NUMBERS_POOL_SIZE] + 1) : (randomNext() & 0xFFFFFF));
+
+		checkTGorPC(number, (randomNext() % 2));
+		checkContainsPC(number);
+		lookups += 2;
+	}
+	checkTGorPC(0, CONTACT_CALLTYPE_TG);
+	checkContainsPC(0);
+
+	return (lookups + 3);
+}
+
+static void saveContact(int index)
+{
+	struct_codeplugContact_t codeplugContact;
+
+	contactToCodeplug(index, &contacts[index], &codeplugContact);
+	HOST_CHECK(codeplugContactSaveDataForIndex(index, &codeplugContact) != 0);
+}
+
+// A random contact slot in use, or free. Some of them at the ends of the index range.
+static int randomIndex(bool used)
+{
+	for (int tries = 0; tries < 100000; tries++)
+	{
+		uint32_t r = (randomNext() % 100);
+		int index = (CODEPLUG_CONTACTS_MIN + (randomNext() % CODEPLUG_CONTACTS_MAX));
+
+		if (r < 10)
+		{
+			index = ((r < 5) ? (CODEPLUG_CONTACTS_MIN + (randomNext() % 4)) : (CODEPLUG_CONTACTS_MAX - (randomNext() % 4)));
+		}
+
+		if (contacts[index].used == used)
+		{
+			return index;
+		}
+	}
+
+	return 0;
+}
+
+// Edits of existing contacts (number, call type and TS override), new ones (also before the first and after the last
+// cached index) and removals, as done from the contacts menus
+static void testImage(int fill)
+{
+	int lookups = 0;
+	int edits = 0;
+
+	buildImage(fill);
+	lookups += checkAll();
+
+	for (uint32_t e = 1; e <= EDITS_PER_IMAGE; e++)
+	{
+		uint32_t r = (randomNext() % 100);
+		int index = randomIndex(r < 70);
+
+		// Full cache: remove one instead
+		if (index == 0)
+		{
+			index = randomIndex(true);
+			r = 0;
+		}
+
+		if (r < 30)
+		{
+			memset(&contacts[index], 0, sizeof(testContact_t));
+		}
+		else
+		{
+			randomContact(&contacts[index]);
+		}
+		saveContact(index);
+		edits++;
+
+		if ((e % EDITS_PER_CHECK) == 0)
+		{
+			lookups += checkAll();
+		}
+	}
+
+	// Reloading the edited image gives the same results
+	HOST_CHECK(SPI_Flash_flush());
+	codeplugInitCaches();
+	lookups += checkAll();
+
+	printf("  %3d%% full image: %4d contacts after %d edits and removals, %d lookups checked\n", fill,
+			(codeplugContactsGetCount(CONTACT_CALLTYPE_TG) + codeplugContactsGetCount(CONTACT_CALLTYPE_PC) + codeplugContactsGetCount(CONTACT_CALLTYPE_ALL)),
+			edits, lookups);
+}
+
+// The chunked builder against the read per slot one, on the same images, empty slots included
+static void testCacheBuild(void)
+{
+	static const int fills[] = { 0, 30, 70, 100 };
+	static testContactsCache_t refContactsCache;
+
+	for (uint32_t f = 0; f < (sizeof(fills) / sizeof(fills[0])); f++)
+	{
+		uint32_t refTransactions, transactions, refCriticalSections, criticalSections;
+		uint64_t refClocks, clocks;
+		int numContacts, mismatches = 0;
+
+		buildImage(fills[f]);
+		HOST_CHECK(SPI_Flash_flush());
+
+		flashModelResetStats();
+		hostResetCriticalStats();
+		refClocks = hostCycles;
+		numContacts = refInitContactsCache(&refContactsCache);
+		refClocks = (hostCycles - refClocks);
+		refTransactions = flashModelStats.transactions;
+		refCriticalSections = hostCriticalSections;
+
+		flashModelResetStats();
+		hostResetCriticalStats();
+		clocks = hostCycles;
+		codeplugInitContactsCache();
+		clocks = (hostCycles - clocks);
+		transactions = flashModelStats.transactions;
+		criticalSections = hostCriticalSections;
+
+		HOST_CHECK(codeplugContactsCache.numTGContacts == refContactsCache.numTGContacts);
+		HOST_CHECK(codeplugContactsCache.numPCContacts == refContactsCache.numPCContacts);
+		HOST_CHECK(codeplugContactsCache.numALLContacts == refContactsCache.numALLContacts);
+		HOST_CHECK((codeplugContactsCache.numTGContacts + codeplugContactsCache.numPCContacts + codeplugContactsCache.numALLContacts) == numContacts);
+
+		for (int i = 0; i < numContacts; i++)
+		{
+			if ((codeplugContactsCache.contactsLookupCache[i].tgOrPCNum != refContactsCache.contactsLookupCache[i].tgOrPCNum) ||
+					(codeplugContactsCache.contactsLookupCache[i].index != refContactsCache.contactsLookupCache[i].index))
+			{
+				mismatches++;
+			}
+		}
+
+		printf("  %3d%% full image cache build: %4d contacts, %d mismatches, flash transactions/critical sections/SPI clocks %u/%u/%u previously, %u/%u/%u now\n",
+				fills[f], numContacts, mismatches, refTransactions, refCriticalSections, (uint32_t)refClocks, transactions, criticalSections, (uint32_t)clocks);
+		HOST_CHECK(mismatches == 0);
+		HOST_CHECK(transactions < refTransactions);
+		HOST_CHECK(clocks < refClocks);
+	}
+}
+
+static void benchmark(void)
+{
+	struct_codeplugContact_t codeplugContact;
+	uint32_t misses[256];
+	uint32_t check = 0;
+	double start;
+	double refRate;
+	double rate;
+	double refPCRate;
+	double pcRate;
+
+	buildImage(100);
+	refCacheBuild();
+
+	// Numbers not in the codeplug, e.g. the talker of a TG without a contact: both implementations end up without reading the flash
+	for (int i = 0; i < 256; i++)
+	{
+		do
+		{
+			misses[i] = (randomNext() & 0xFFFFFF);
+		} while (refContactIndexByTGorPCFromNumber(0, misses[i], CONTACT_CALLTYPE_TG) >= 0);
+	}
+
+	start = hostSeconds();
+	for (uint32_t i = 0; i < BENCHMARK_LOOKUPS; i++)
+	{
+		check += refContactIndexByTGorPCFromNumber(0, misses[i & 0xFF], CONTACT_CALLTYPE_TG);
+	}
+	refRate = BENCHMARK_LOOKUPS / (hostSeconds() - start);
+
+	start = hostSeconds();
+	for (uint32_t i = 0; i < BENCHMARK_LOOKUPS; i++)
+	{
+		check += codeplugContactIndexByTGorPC(misses[i & 0xFF], CONTACT_CALLTYPE_TG, &codeplugContact, 0);
+	}
+	rate = BENCHMARK_LOOKUPS / (hostSeconds() - start);
+
+	start = hostSeconds();
+	for (uint32_t i = 0; i < BENCHMARK_LOOKUPS; i++)
+	{
+		check += refContactsContainsPC(numbersPool[i % NUMBERS_POOL_SIZE]);
+	}
+	refPCRate = BENCHMARK_LOOKUPS / (hostSeconds() - start);
+
+	start = hostSeconds();
+	for (uint32_t i = 0; i < BENCHMARK_LOOKUPS; i++)
+	{
+		check += codeplugContactsContainsPC(numbersPool[i % NUMBERS_POOL_SIZE]);
+	}
+	pcRate = BENCHMARK_LOOKUPS / (hostSeconds() - start);
+
+	printf("  %d contacts, TG lookup (not found): %.0f lookups/s previously, %.0f lookups/s now (x%.1f)\n", refNumContacts, refRate, rate, (rate / refRate));
+	printf("  %d contacts, PC check:              %.0f lookups/s previously, %.0f lookups/s now (x%.1f) [%u]\n", refNumContacts, refPCRate, pcRate,
+			(pcRate / refPCRate), (check & 0x01));
+	HOST_CHECK(rate > refRate);
+	HOST_CHECK(pcRate > refPCRate);
+}
+
+int main(void)
+{
+	printf("Codeplug contact lookups\n");
+
+	testImage(30);
+	testImage(70);
+	testImage(100);
+	testCacheBuild();
+	benchmark();
+
+	if (hostCheckFailures() != 0)
+	{
+		printf("FAILED (%d)\n", hostCheckFailures());
+		return EXIT_FAILURE;
+	}
+
+	printf("OK\n");
+	return EXIT_SUCCESS;
+}
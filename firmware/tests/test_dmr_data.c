@@ -0,0 +1,629 @@
+/*
+ * Copyright (C) 2024 Roger Clark, VK3KYY / G4KYF
+ *                    Daniel Caujolle-Bert, F1RMB
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+ *    in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. Use of this source code or binary releases for commercial purposes is strictly forbidden. This includes, without limitation,
+ *    incorporation in a commercial product or incorporation into a product or project which allows commercial use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// DMR data bursts (dmrData.c): the rate 3/4 trellis decoder against a straightforward Viterbi decoder, kept below
+// as the reference, over random blocks with injected bit errors. The CRC-CCITT, CRC-9 and CRC-32 tables are checked
+// through the reassembly of random data messages (headers and blocks protected by bitwise reference CRCs), which must
+// be rejected whenever a bit is flipped. Then the blocks/s of both decoders on the host.
+// Cortex-M4 cycle counts are measured on the radio, with the DWT cycle counter of the profiler build.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "functions/dmrData.h"
+#include "hostSupport.h"
+
+#define BURST_LENGTH          33U
+#define TRELLIS_DIBITS        98U
+#define TRELLIS_MAX_ERRORS     8U
+#define RANDOM_BLOCKS      20000U
+#define RANDOM_MESSAGES    20000U
+#define BENCHMARK_BLOCKS  200000U
+
+#define FORMAT_UNCONFIRMED     0x02U
+#define FORMAT_CONFIRMED       0x03U
+#define FORMAT_DEFINED_SHORT   0x0DU
+
+// ETSI TS 102 361-1 Annex B.2: deinterleaved position of each received dibit
+static const uint8_t refInterleave[TRELLIS_DIBITS] = {
+		 0,  1,  8,  9, 16, 17, 24, 25, 32, 33, 40, 41, 48, 49, 56, 57, 64, 65, 72, 73, 80, 81, 88, 89, 96, 97,
+		 2,  3, 10, 11, 18, 19, 26, 27, 34, 35, 42, 43, 50, 51, 58, 59, 66, 67, 74, 75, 82, 83, 90, 91,
+		 4,  5, 12, 13, 20, 21, 28, 29, 36, 37, 44, 45, 52, 53, 60, 61, 68, 69, 76, 77, 84, 85, 92, 93,
+		 6,  7, 14, 15, 22, 23, 30, 31, 38, 39, 46, 47, 54, 55, 62, 63, 70, 71, 78, 79, 86, 87, 94, 95
+};
+
+// Constellation point of each (state, tribit) transition
+static const uint8_t refEncoderPoints[64] = {
+		0,  8, 4, 12, 2, 10, 6, 14,   4, 12, 2, 10, 6, 14, 0,  8,   1,  9, 5, 13, 3, 11, 7, 15,   5, 13, 3, 11, 7, 15, 1,  9,
+		3, 11, 7, 15, 1,  9, 5, 13,   7, 15, 1,  9, 5, 13, 3, 11,   2, 10, 6, 14, 0,  8, 4, 12,   6, 14, 0,  8, 4, 12, 2, 10
+};
+
+// Dibit symbols of each constellation point
+static const int8_t refPointSymbols[16][2] = {
+		{  1, -1 }, { -1, -1 }, {  3, -3 }, { -3, -3 }, { -3, -1 }, {  3, -1 }, { -1, -3 }, {  1, -3 },
+		{ -3,  3 }, {  3,  3 }, { -1,  1 }, {  1,  1 }, {  1,  3 }, { -1,  3 }, {  3,  1 }, { -3,  1 }
+};
+
+static uint32_t randomState = 0x2468ACE1;
+
+
+static uint32_t randomNext(void)
+{
+	randomState ^= (randomState << 13);
+	randomState ^= (randomState >> 17);
+	randomState ^= (randomState << 5);
+
+	return randomState;
+}
+
+static void randomFill(uint8_t *data, uint32_t length)
+{
+	for (uint32_t i = 0U; i < length; i++)
+	{
+		data[i] = randomNext();
+	}
+}
+
+// Burst bit position of the Nth payload bit, the SYNC (or EMB) and the slot type are in the middle
+static uint32_t refBurstBitPosition(uint32_t n)
+{
+	return ((n >= 98U) ? (n + 68U) : n);
+}
+
+static uint8_t refGetBit(const uint8_t *data, uint32_t n)
+{
+	return ((data[n >> 3] >> (7U - (n & 0x07U))) & 0x01U);
+}
+
+static void refSetBit(uint8_t *data, uint32_t n, uint8_t bit)
+{
+	if (bit)
+	{
+		data[n >> 3] |= (0x80U >> (n & 0x07U));
+	}
+	else
+	{
+		data[n >> 3] &= ~(0x80U >> (n & 0x07U));
+	}
+}
+
+static uint8_t refSymbolToDibit(int8_t symbol)
+{
+	switch (symbol)
+	{
+		case 3:
+			return 0x01U;
+		case 1:
+			return 0x00U;
+		case -1:
+			return 0x02U;
+		default:
+			return 0x03U;
+	}
+}
+
+// 18 bytes payload into the 196 payload bits of a burst (the other bits are left as they are)
+static void refTrellisEncode(const uint8_t *payload, uint8_t *burst)
+{
+	uint8_t tribits[49];
+	uint8_t dibits[TRELLIS_DIBITS];
+	uint8_t state = 0U;
+
+	for (uint32_t i = 0U; i < 48U; i++)
+	{
+		tribits[i] = ((refGetBit(payload, (i * 3U)) << 2) | (refGetBit(payload, (i * 3U) + 1U) << 1) | refGetBit(payload, (i * 3U) + 2U));
+	}
+	tribits[48] = 0U; // flushing tribit
+
+	for (uint32_t i = 0U; i < 49U; i++)
+	{
+		uint8_t point = refEncoderPoints[(state * 8U) + tribits[i]];
+
+		dibits[i * 2U] = refSymbolToDibit(refPointSymbols[point][0]);
+		dibits[(i * 2U) + 1U] = refSymbolToDibit(refPointSymbols[point][1]);
+		state = tribits[i];
+	}
+
+	for (uint32_t i = 0U; i < TRELLIS_DIBITS; i++)
+	{
+		uint8_t dibit = dibits[refInterleave[i]];
+
+		refSetBit(burst, refBurstBitPosition(i * 2U), (dibit >> 1));
+		refSetBit(burst, refBurstBitPosition((i * 2U) + 1U), (dibit & 0x01U));
+	}
+}
+
+// Straightforward hard decision Viterbi decoder: scalar metrics, bitwise distances and full survivor paths.
+// Returns the path metric
+static uint32_t refTrellisDecode(const uint8_t *burst, uint8_t *payload)
+{
+	uint8_t dibits[TRELLIS_DIBITS];
+	uint8_t pointDibits[16];
+	uint32_t metrics[8];
+	uint32_t newMetrics[8];
+	uint8_t paths[49][8];
+	uint8_t state = 0U;
+
+	for (uint32_t p = 0U; p < 16U; p++)
+	{
+		pointDibits[p] = ((refSymbolToDibit(refPointSymbols[p][0]) << 2) | refSymbolToDibit(refPointSymbols[p][1]));
+	}
+
+	for (uint32_t i = 0U; i < TRELLIS_DIBITS; i++)
+	{
+		dibits[refInterleave[i]] = ((refGetBit(burst, refBurstBitPosition(i * 2U)) << 1) | refGetBit(burst, refBurstBitPosition((i * 2U) + 1U)));
+	}
+
+	for (uint32_t s = 0U; s < 8U; s++)
+	{
+		metrics[s] = ((s == 0U) ? 0U : 1000U);
+	}
+
+	for (uint32_t k = 0U; k < 49U; k++)
+	{
+		uint8_t received = ((dibits[k * 2U] << 2) | dibits[(k * 2U) + 1U]);
+
+		for (uint32_t t = 0U; t < 8U; t++)
+		{
+			uint32_t best = UINT32_MAX;
+
+			for (uint32_t s = 0U; s < 8U; s++)
+			{
+				uint8_t difference = (received ^ pointDibits[refEncoderPoints[(s * 8U) + t]]);
+				uint32_t distance = 0U;
+
+				for (uint32_t b = 0U; b < 4U; b++)
+				{
+					distance += ((difference >> b) & 0x01U);
+				}
+
+				if ((metrics[s] + distance) < best)
+				{
+					best = (metrics[s] + distance);
+					paths[k][t] = s;
+				}
+			}
+
+			newMetrics[t] = best;
+		}
+
+		memcpy(metrics, newMetrics, sizeof(metrics));
+	}
+
+	memset(payload, 0, DMR_DATA_RATE_34_BLOCK_LENGTH);
+
+	for (uint32_t k = 48U; k > 0U; k--)
+	{
+		state = paths[k][state];
+
+		for (uint32_t b = 0U; b < 3U; b++)
+		{
+			refSetBit(payload, (((k - 1U) * 3U) + b), ((state >> (2U - b)) & 0x01U));
+		}
+	}
+
+	return metrics[0];
+}
+
+// Payload bits that differ between two bursts
+static uint32_t burstDistance(const uint8_t *a, const uint8_t *b)
+{
+	uint32_t distance = 0U;
+
+	for (uint32_t n = 0U; n < (TRELLIS_DIBITS * 2U); n++)
+	{
+		uint32_t position = refBurstBitPosition(n);
+
+		distance += (refGetBit(a, position) ^ refGetBit(b, position));
+	}
+
+	return distance;
+}
+
+static void injectBitErrors(uint8_t *burst, uint32_t count)
+{
+	for (uint32_t i = 0U; i < count; i++)
+	{
+		uint32_t position = refBurstBitPosition(randomNext() % (TRELLIS_DIBITS * 2U));
+
+		burst[position >> 3] ^= (0x80U >> (position & 0x07U));
+	}
+}
+
+static uint16_t refCRC16CCITT(const uint8_t *data, uint32_t length)
+{
+	uint16_t crc = 0U;
+
+	for (uint32_t i = 0U; i < length; i++)
+	{
+		for (int b = 7; b >= 0; b--)
+		{
+			bool feedback = ((((crc >> 15) ^ (data[i] >> b)) & 0x01U) != 0U);
+
+			crc <<= 1;
+			if (feedback)
+			{
+				crc ^= 0x1021U;
+			}
+		}
+	}
+
+	return crc;
+}
+
+// Octets by pairs, least significant octet first, then the 7 bits serial number
+static uint16_t refCRC9(const uint8_t *data, uint32_t length, uint8_t serialNumber)
+{
+	uint16_t crc = 0U;
+
+	for (uint32_t i = 0U; i <= length; i++)
+	{
+		uint8_t octet = ((i < length) ? data[i ^ 1U] : (serialNumber << 1));
+		int lastBit = ((i < length) ? 0 : 1);
+
+		for (int b = 7; b >= lastBit; b--)
+		{
+			bool feedback = ((((crc >> 8) ^ (octet >> b)) & 0x01U) != 0U);
+
+			crc = ((crc << 1) & 0x1FFU);
+			if (feedback)
+			{
+				crc ^= 0x059U;
+			}
+		}
+	}
+
+	return crc;
+}
+
+// Reflected, octets by pairs, least significant octet first
+static uint32_t refCRC32(const uint8_t *data, uint32_t length)
+{
+	uint32_t crc = 0U;
+
+	for (uint32_t i = 0U; i < length; i++)
+	{
+		uint8_t octet = data[i ^ 1U];
+
+		for (uint32_t b = 0U; b < 8U; b++)
+		{
+			bool feedback = (((crc ^ (octet >> b)) & 0x01U) != 0U);
+
+			crc >>= 1;
+			if (feedback)
+			{
+				crc ^= 0xEDB88320U;
+			}
+		}
+	}
+
+	return crc;
+}
+
+static void testTrellis(void)
+{
+	uint8_t payload[DMR_DATA_RATE_34_BLOCK_LENGTH];
+	uint8_t decoded[DMR_DATA_RATE_34_BLOCK_LENGTH];
+	uint8_t refDecoded[DMR_DATA_RATE_34_BLOCK_LENGTH];
+	uint8_t burst[BURST_LENGTH];
+	uint8_t reencoded[BURST_LENGTH];
+	uint32_t metricMismatches = 0U, notOnPath = 0U;
+
+	for (uint32_t errors = 0U; errors <= TRELLIS_MAX_ERRORS; errors++)
+	{
+		uint32_t decodedBack = 0U, refDecodedBack = 0U;
+
+		for (uint32_t n = 0U; n < RANDOM_BLOCKS; n++)
+		{
+			randomFill(payload, sizeof(payload));
+			randomFill(burst, sizeof(burst));
+			refTrellisEncode(payload, burst);
+			injectBitErrors(burst, errors);
+
+			uint32_t metric = dmrDataTrellisDecode(burst, decoded);
+			uint32_t refMetric = refTrellisDecode(burst, refDecoded);
+
+			// Both are maximum likelihood: same metric, ties may pick different paths.
+			// The metric is the distance to the decoded path.
+			memcpy(reencoded, burst, sizeof(burst));
+			refTrellisEncode(decoded, reencoded);
+
+			metricMismatches += ((metric != refMetric) ? 1U : 0U);
+			notOnPath += ((burstDistance(burst, reencoded) != metric) ? 1U : 0U);
+			decodedBack += ((memcmp(decoded, payload, sizeof(payload)) == 0) ? 1U : 0U);
+			refDecodedBack += ((memcmp(refDecoded, payload, sizeof(payload)) == 0) ? 1U : 0U);
+		}
+
+		printf("  rate 3/4, %u bit errors: %6.2f%% decoded back, %6.2f%% by the reference decoder\n", errors,
+				((100.0 * decodedBack) / RANDOM_BLOCKS), ((100.0 * refDecodedBack) / RANDOM_BLOCKS));
+
+		if (errors <= 1U)
+		{
+			HOST_CHECK(decodedBack == RANDOM_BLOCKS);
+		}
+	}
+
+	printf("  %u blocks: %u metric mismatches with the reference decoder, %u metrics not matching the decoded path\n",
+			((TRELLIS_MAX_ERRORS + 1U) * RANDOM_BLOCKS), metricMismatches, notOnPath);
+	HOST_CHECK(metricMismatches == 0U);
+	HOST_CHECK(notOnPath == 0U);
+}
+
+typedef struct
+{
+	uint8_t  header[DMR_DATA_HEADER_LENGTH];
+	uint8_t  blocks[DMR_DATA_MESSAGE_MAX_BLOCKS][DMR_DATA_RATE_34_BLOCK_LENGTH];
+	uint8_t  blockLength;
+	uint8_t  numBlocks;
+	uint8_t  format;
+	uint16_t userLength;
+	uint8_t  userData[DMR_DATA_MESSAGE_MAX_LENGTH];
+	uint32_t srcId;
+	uint32_t dstId;
+	bool     isGroup;
+} testMessage_t;
+
+// Random unconfirmed, confirmed or defined short data message, with its header and blocks
+static void buildMessage(testMessage_t *message)
+{
+	static const uint8_t formats[] = { FORMAT_UNCONFIRMED, FORMAT_CONFIRMED, FORMAT_DEFINED_SHORT };
+	uint8_t data[DMR_DATA_MESSAGE_MAX_LENGTH];
+	bool isRate34 = (randomNext() & 1U);
+	uint8_t dataPerBlock;
+	uint16_t totalLength;
+	uint8_t padLength;
+	uint8_t *h = message->header;
+
+	message->format = formats[randomNext() % sizeof(formats)];
+	message->blockLength = (isRate34 ? DMR_DATA_RATE_34_BLOCK_LENGTH : DMR_DATA_RATE_12_BLOCK_LENGTH);
+	message->numBlocks = (1U + (randomNext() % DMR_DATA_MESSAGE_MAX_BLOCKS));
+	message->srcId = (randomNext() & 0xFFFFFFU);
+	message->dstId = (randomNext() & 0xFFFFFFU);
+	message->isGroup = (randomNext() & 1U);
+
+	dataPerBlock = (message->blockLength - ((message->format == FORMAT_CONFIRMED) ? 2U : 0U));
+	totalLength = (message->numBlocks * dataPerBlock);
+	padLength = (randomNext() % (((dataPerBlock - 4U) < 32U) ? (dataPerBlock - 4U) : 32U));
+	message->userLength = (totalLength - 4U - padLength);
+
+	randomFill(message->userData, message->userLength);
+	memcpy(data, message->userData, message->userLength);
+	memset(&data[message->userLength], 0, padLength);
+
+	uint32_t crc = refCRC32(data, (totalLength - 4U));
+
+	data[totalLength - 4U] = crc;
+	data[totalLength - 3U] = (crc >> 8);
+	data[totalLength - 2U] = (crc >> 16);
+	data[totalLength - 1U] = (crc >> 24);
+
+	memset(h, 0, DMR_DATA_HEADER_LENGTH);
+	h[0] = ((message->isGroup ? 0x80U : 0x00U) | message->format);
+	h[1] = (DMR_DATA_SAP_IP << 4);
+	h[2] = (message->dstId >> 16);
+	h[3] = (message->dstId >> 8);
+	h[4] = message->dstId;
+	h[5] = (message->srcId >> 16);
+	h[6] = (message->srcId >> 8);
+	h[7] = message->srcId;
+
+	if (message->format == FORMAT_DEFINED_SHORT)
+	{
+		h[0] |= (message->numBlocks & 0x30U);
+		h[1] |= (message->numBlocks & 0x0FU);
+		h[9] = (padLength << 3);
+	}
+	else
+	{
+		h[0] |= (padLength & 0x10U);
+		h[1] |= (padLength & 0x0FU);
+		h[8] = (0x80U | message->numBlocks);
+	}
+
+	uint16_t headerCrc = (uint16_t)(~refCRC16CCITT(h, 10U) ^ 0xCCCCU);
+
+	h[10] = (headerCrc >> 8);
+	h[11] = headerCrc;
+
+	for (uint8_t b = 0U; b < message->numBlocks; b++)
+	{
+		uint8_t *block = message->blocks[b];
+
+		if (message->format == FORMAT_CONFIRMED)
+		{
+			uint16_t crc9 = ((~refCRC9(&data[b * dataPerBlock], dataPerBlock, b) ^ (isRate34 ? 0x1FFU : 0x0F0U)) & 0x1FFU);
+
+			block[0] = ((b << 1) | (crc9 >> 8));
+			block[1] = crc9;
+			memcpy(&block[2], &data[b * dataPerBlock], dataPerBlock);
+		}
+		else
+		{
+			memcpy(block, &data[b * dataPerBlock], dataPerBlock);
+		}
+	}
+}
+
+// Header then blocks, the rate 3/4 ones going through the trellis with a correctable bit error.
+// Returns the result of the last step
+static dmrDataResult_t sendMessage(const testMessage_t *message)
+{
+	dmrDataResult_t result = dmrDataAddHeader(message->header);
+
+	for (uint8_t b = 0U; (b < message->numBlocks) && (result == DMR_DATA_RESULT_IN_PROGRESS); b++)
+	{
+		if (message->blockLength == DMR_DATA_RATE_34_BLOCK_LENGTH)
+		{
+			uint8_t burst[BURST_LENGTH];
+			uint8_t decoded[DMR_DATA_RATE_34_BLOCK_LENGTH];
+
+			randomFill(burst, sizeof(burst));
+			refTrellisEncode(message->blocks[b], burst);
+			injectBitErrors(burst, (randomNext() & 1U));
+			dmrDataTrellisDecode(burst, decoded);
+			result = dmrDataAddBlock(decoded, message->blockLength);
+		}
+		else
+		{
+			result = dmrDataAddBlock(message->blocks[b], message->blockLength);
+		}
+	}
+
+	return result;
+}
+
+static void testReassembly(void)
+{
+	static testMessage_t message;
+	static testMessage_t corrupted;
+	uint32_t completed = 0U, contentErrors = 0U, corruptedAccepted = 0U;
+	char text[32];
+
+	for (uint32_t n = 0U; n < RANDOM_MESSAGES; n++)
+	{
+		buildMessage(&message);
+
+		if (sendMessage(&message) == DMR_DATA_RESULT_MESSAGE_COMPLETE)
+		{
+			const dmrDataMessage_t *received = dmrDataGetMessage();
+
+			completed++;
+
+			if ((received == NULL) || (received->length != message.userLength) || (memcmp(received->data, message.userData, message.userLength) != 0) ||
+					(received->srcId != message.srcId) || (received->dstId != message.dstId) || (received->isGroup != message.isGroup) ||
+					(received->format != message.format) || (received->SAP != DMR_DATA_SAP_IP))
+			{
+				contentErrors++;
+			}
+		}
+
+		// One bit flipped in the header or a block
+		memcpy(&corrupted, &message, sizeof(message));
+
+		uint32_t position = (randomNext() % ((DMR_DATA_HEADER_LENGTH + (message.numBlocks * message.blockLength)) * 8U));
+
+		if (position < (DMR_DATA_HEADER_LENGTH * 8U))
+		{
+			corrupted.header[position >> 3] ^= (0x80U >> (position & 0x07U));
+		}
+		else
+		{
+			position -= (DMR_DATA_HEADER_LENGTH * 8U);
+			corrupted.blocks[position / (message.blockLength * 8U)][(position >> 3) % message.blockLength] ^= (0x80U >> (position & 0x07U));
+		}
+
+		if (sendMessage(&corrupted) == DMR_DATA_RESULT_MESSAGE_COMPLETE)
+		{
+			corruptedAccepted++;
+		}
+	}
+
+	// IPv4/UDP SMS, as UTF-16 text
+	static const char sms[] = "Hello hotspot";
+
+	memset(&message, 0, sizeof(message));
+	message.blockLength = DMR_DATA_RATE_34_BLOCK_LENGTH;
+	message.numBlocks = 1U;
+	{
+		dmrDataMessage_t ipMessage = { .SAP = DMR_DATA_SAP_IP, .length = (28U + (2U * strlen(sms))) };
+
+		ipMessage.data[0] = 0x45U; // IPv4, 20 bytes header, then 8 bytes UDP header
+		for (uint32_t i = 0U; i < strlen(sms); i++)
+		{
+			ipMessage.data[28U + (2U * i)] = sms[i];
+		}
+
+		dmrDataGetMessageText(&ipMessage, text, sizeof(text));
+		HOST_CHECK(strcmp(text, sms) == 0);
+		dmrDataGetMessageText(&ipMessage, text, 6U);
+		HOST_CHECK(strcmp(text, "Hello") == 0);
+	}
+
+	// A block without its header
+	dmrDataReset();
+	HOST_CHECK(dmrDataAddBlock(message.blocks[0], DMR_DATA_RATE_34_BLOCK_LENGTH) == DMR_DATA_RESULT_ERROR);
+	HOST_CHECK(dmrDataGetMessage() == NULL);
+
+	printf("  %u random messages: %u completed, %u content errors, %u accepted with a bit flipped\n", RANDOM_MESSAGES, completed, contentErrors, corruptedAccepted);
+	HOST_CHECK(completed == RANDOM_MESSAGES);
+	HOST_CHECK(contentErrors == 0U);
+	HOST_CHECK(corruptedAccepted == 0U);
+}
+
+static void benchmark(void)
+{
+	uint8_t payload[DMR_DATA_RATE_34_BLOCK_LENGTH];
+	uint8_t decoded[DMR_DATA_RATE_34_BLOCK_LENGTH];
+	uint8_t bursts[16][BURST_LENGTH];
+	uint32_t check = 0U;
+	double start, rate, refRate;
+
+	for (uint32_t i = 0U; i < 16U; i++)
+	{
+		randomFill(payload, sizeof(payload));
+		randomFill(bursts[i], BURST_LENGTH);
+		refTrellisEncode(payload, bursts[i]);
+		injectBitErrors(bursts[i], (i % 3U));
+	}
+
+	start = hostSeconds();
+	for (uint32_t n = 0U; n < BENCHMARK_BLOCKS; n++)
+	{
+		check += refTrellisDecode(bursts[n % 16U], decoded) + decoded[n % DMR_DATA_RATE_34_BLOCK_LENGTH];
+	}
+	refRate = BENCHMARK_BLOCKS / (hostSeconds() - start);
+
+	start = hostSeconds();
+	for (uint32_t n = 0U; n < BENCHMARK_BLOCKS; n++)
+	{
+		check += dmrDataTrellisDecode(bursts[n % 16U], decoded) + decoded[n % DMR_DATA_RATE_34_BLOCK_LENGTH];
+	}
+	rate = BENCHMARK_BLOCKS / (hostSeconds() - start);
+
+	printf("  rate 3/4 decode: %.0f blocks/s (%.0f ns) by the reference, %.0f blocks/s (%.0f ns) now (x%.1f) [%u]\n",
+			refRate, (1E9 / refRate), rate, (1E9 / rate), (rate / refRate), check);
+	HOST_CHECK(rate > refRate);
+}
+
+int main(void)
+{
+	printf("DMR data bursts\n");
+
+	testTrellis();
+	testReassembly();
+	benchmark();
+
+	if (hostCheckFailures() != 0)
+	{
+		printf("FAILED (%d)\n", hostCheckFailures());
+		return 1;
+	}
+
+	printf("OK\n");
+	return 0;
+}
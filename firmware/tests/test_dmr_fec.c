@@ -0,0 +1,791 @@
+/*
+ * Copyright (C) 2024 Roger Clark, VK3KYY / G4KYF
+ *                    Daniel Caujolle-Bert, F1RMB
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+ *    in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. Use of this source code or binary releases for commercial purposes is strictly forbidden. This includes, without limitation,
+ *    incorporation in a commercial product or incorporation into a product or project which allows commercial use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// DMR FEC codecs (dmrFEC.c): bit exactness against the previous bool array implementation, kept below
+// as the reference, over every Hamming codeword and random BPTC (196,96) / embedded LC frames with
+// injected bit errors, then the throughput of both on the host.
+// Cortex-M4 cycle counts are measured on the radio, with the DWT cycle counter of the profiler build.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "functions/dmrFEC.h"
+#include "hostSupport.h"
+
+#define BURST_LENGTH       34U // 33 bytes burst, the reference decoder reads one byte past its end
+#define RANDOM_FRAMES      200000U
+#define BENCHMARK_FRAMES   500000U
+
+static const int BPTC19696CopyRanges[][2] = {{4,11},{16,26},{31,41},{46,56},{61,71},{76,86},{91,101},{106,116},{121,131}};
+static const int embedddataCopyRanges[][2] = {{0,10},{16,26},{32,41},{48,57},{64,73},{80,89},{96,105}};
+
+static bool refEmbeddedDataRaw[128];
+static bool refEmbeddedDataProcessed[72];
+static bool refBPTCRaw[208];// The reference decoder writes up to bit 203
+static bool refBPTCDeInterleaved[196];
+static uint32_t randomState = 0x13579BDF;
+
+static bool refHammingDecodeType1(bool *inputOutputBooleanBitsArray);
+static bool refHammingDecodeType2(bool *inputOutputBooleanBitsArray);
+static void refHammingEncode(bool *inputOutputBooleanBitsArray,bool is16114);
+static uint8_t refHammingGetBits(bool *inputOutputBooleanBitsArray, bool is16114);
+static uint32_t refCRCEncodeFiveBit(const bool *in);
+static void refByteToBooleanBitsArray(uint8_t byteIn, bool *bitsOut);
+static uint8_t refBooleanBitsArrayToByte(const bool *bitsIn);
+
+
+// Previous implementation, one bool per bit (hotspot.c before the codecs were bit packed)
+
+static void refBPTCdecode(const uint8_t *inputData, uint8_t *outputData)
+{
+	// 0xFF means don't use this value
+	const uint8_t BITS_LOOKUP[16] = {0xFF, 9, 10, 6, 11, 3, 7, 1, 12, 0xFF, 4, 0xFF, 8, 5, 2, 0};
+	bool bitData[96];
+	bool tmpArray[13];
+	uint32_t bitDataIndex = 0;
+	bool stillProcessing;
+	uint8_t n;
+
+	for (int i = 0; i < 13; i++)
+	{
+		refByteToBooleanBitsArray(inputData[i], refBPTCRaw + (i << 3));
+	}
+
+	refByteToBooleanBitsArray(inputData[20], tmpArray);
+	refBPTCRaw[98] = tmpArray[6];
+	refBPTCRaw[99] = tmpArray[7];
+
+	for (int i = 0; i < 13; i++)
+	{
+		refByteToBooleanBitsArray(inputData[i + 21], refBPTCRaw + (100 + (i << 3)));
+	}
+
+	for (int i = 0; i < 196; i++)
+	{
+		refBPTCDeInterleaved[i] = refBPTCRaw[(i * 181) % 196];// interleave
+	}
+
+	stillProcessing = true;// Need to initially set this to true to start the for loop
+
+	for (int i = 0; ((i < 5) && stillProcessing); i++)
+	{
+		stillProcessing = false;
+
+		for (int j = 0; j < 15; j++)
+		{
+			int pos = j + 1;
+			for (int k = 0; k < 13; k++)
+			{
+				tmpArray[k] = refBPTCDeInterleaved[pos];
+				pos += 15;
+			}
+
+			bool hammingOK = false;
+
+			n  = ((tmpArray[0] ^ tmpArray[1] ^ tmpArray[3] ^ tmpArray[5] ^ tmpArray[6]) != tmpArray[9])  ? 0x01 : 0x00;
+			n |= ((tmpArray[0] ^ tmpArray[1] ^ tmpArray[2] ^ tmpArray[4] ^ tmpArray[6] ^ tmpArray[7]) != tmpArray[10]) ? 0x02 : 0x00;
+			n |= ((tmpArray[0] ^ tmpArray[1] ^ tmpArray[2] ^ tmpArray[3] ^ tmpArray[5] ^ tmpArray[7] ^ tmpArray[8]) != tmpArray[11]) ? 0x04 : 0x00;
+			n |= ((tmpArray[0] ^ tmpArray[2] ^ tmpArray[4] ^ tmpArray[5] ^ tmpArray[8]) != tmpArray[12]) ? 0x08 : 0x00;
+
+			if (n < 16)
+			{
+				uint8_t bitLocation = BITS_LOOKUP[n];
+				if (bitLocation != 0xFF)
+				{
+					tmpArray[bitLocation] = !tmpArray[bitLocation];
+					hammingOK = true;
+				}
+			}
+
+			if (hammingOK)
+			{
+				pos = j + 1;
+				for (int k = 0; k < 13; k++)
+				{
+					refBPTCDeInterleaved[pos] = tmpArray[k];
+					pos += 15;
+				}
+				stillProcessing = true;
+			}
+		}
+
+		for (int j = 0; j < 9; j++)
+		{
+			uint32_t pos = (j * 15) + 1;
+			if (refHammingDecodeType2(refBPTCDeInterleaved + pos))
+			{
+				stillProcessing = true;
+			}
+		}
+	}
+
+	for (int range = 0; range < 9; range++)
+	{
+		for (uint32_t a = BPTC19696CopyRanges[range][0]; a <= BPTC19696CopyRanges[range][1]; a++, bitDataIndex++)
+		{
+			bitData[bitDataIndex] = refBPTCDeInterleaved[a];
+		}
+	}
+
+	for (int i = 0; i < 12; i++)
+	{
+		outputData[i] = refBooleanBitsArrayToByte(bitData + (i << 3));
+	}
+}
+
+static void refBPTCencode(const uint8_t *inputData, uint8_t *outputData)
+{
+	uint8_t byteData;
+	uint32_t bitDataPosition = 0;
+	bool bitData[96];
+	bool hammingBits[13];
+
+	for (int i = 0; i < 12; i++)
+	{
+		refByteToBooleanBitsArray(inputData[i], bitData + (i << 3));
+	}
+
+	memset(refBPTCDeInterleaved, 0, 196 * sizeof(bool));
+
+	for (int range = 0; range < 9; range++)
+	{
+		for (uint32_t a = BPTC19696CopyRanges[range][0]; a <= BPTC19696CopyRanges[range][1]; a++, bitDataPosition++)
+		{
+			refBPTCDeInterleaved[a] = bitData[bitDataPosition];
+		}
+	}
+
+	for (int i = 0; i < 9; i++)
+	{
+		refHammingEncode(refBPTCDeInterleaved + ((i * 15) + 1), false);
+	}
+
+	for (int i = 0; i < 15; i++)
+	{
+		int pos = i + 1;
+		for (int j = 0; j < 13; j++)
+		{
+			hammingBits[j] = refBPTCDeInterleaved[pos];
+			pos += 15;
+		}
+
+		hammingBits[9]  = hammingBits[0] ^ hammingBits[1] ^ hammingBits[3] ^ hammingBits[5] ^ hammingBits[6];
+		hammingBits[10] = hammingBits[0] ^ hammingBits[1] ^ hammingBits[2] ^ hammingBits[4] ^ hammingBits[6] ^ hammingBits[7];
+		hammingBits[11] = hammingBits[0] ^ hammingBits[1] ^ hammingBits[2] ^ hammingBits[3] ^ hammingBits[5] ^ hammingBits[7] ^ hammingBits[8];
+		hammingBits[12] = hammingBits[0] ^ hammingBits[2] ^ hammingBits[4] ^ hammingBits[5] ^ hammingBits[8];
+
+		pos = i + 1;
+		for (int j = 0; j < 13; j++)
+		{
+			refBPTCDeInterleaved[pos] = hammingBits[j];
+			pos += 15;
+		}
+	}
+
+	for (int i = 0; i < 196; i++)
+	{
+		refBPTCRaw[(i * 181) % 196] = refBPTCDeInterleaved[i];// interleave
+	}
+
+	for (int i = 0; i < 12; i++)
+	{
+		outputData[i] = refBooleanBitsArrayToByte(refBPTCRaw + (i << 3));
+	}
+
+	byteData = refBooleanBitsArrayToByte(refBPTCRaw + 96);
+	outputData[12] = (outputData[12] & 0x3F) | ((byteData >> 0) & 0xC0);
+	outputData[20] = (outputData[20] & 0xFC) | ((byteData >> 4) & 0x03);
+
+	for (int i = 0; i < 12; i++)
+	{
+		outputData[i + 21] = refBooleanBitsArrayToByte(refBPTCRaw + 100 + (i << 3));
+	}
+}
+
+static bool refHammingDecodeType2(bool *inputOutputBooleanBitsArray)
+{
+	const uint8_t BITS_LOOKUP[16] = {0xFF, 11, 12, 8, 13, 5, 9, 3, 14, 0, 6, 1, 10, 7, 4, 2};
+	uint8_t numBits = refHammingGetBits(inputOutputBooleanBitsArray, false);
+
+	if (numBits < 16)
+	{
+		uint8_t bitLocation = BITS_LOOKUP[numBits];
+		if (bitLocation != 0xFF)
+		{
+			inputOutputBooleanBitsArray[bitLocation] = !inputOutputBooleanBitsArray[bitLocation];
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static bool refHammingDecodeType1(bool *inputOutputBooleanBitsArray)
+{
+	// 0xFF means don't use this value. Also Index 0 is never used, its only here to reduce the number of if's
+	const uint8_t BITS_LOOKUP[32] = { 0xFF, 11, 12, 0xFF, 13, 0xFF, 0xFF, 3, 14, 0xFF, 0xFF, 1, 0xFF, 7, 4, 0xFF, 15, 0xFF, 0xFF, 8, 0xFF, 5, 9, 0xFF, 0xFF, 0, 6, 0xFF, 10, 0xFF ,0xFF, 2};
+
+	uint8_t c = refHammingGetBits(inputOutputBooleanBitsArray, true);
+	if (c == 0)
+	{
+		return true;
+	}
+
+	if (c < 32)
+	{
+		uint8_t bitLocation = BITS_LOOKUP[c];
+		if (bitLocation != 0xFF)
+		{
+			inputOutputBooleanBitsArray[bitLocation] = !inputOutputBooleanBitsArray[bitLocation];
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static void refHammingEncode(bool *inputOutputBooleanBitsArray,bool is16114)
+{
+	inputOutputBooleanBitsArray[11] = inputOutputBooleanBitsArray[0] ^ inputOutputBooleanBitsArray[1] ^ inputOutputBooleanBitsArray[2] ^ inputOutputBooleanBitsArray[3] ^ inputOutputBooleanBitsArray[5] ^ inputOutputBooleanBitsArray[7] ^ inputOutputBooleanBitsArray[8];
+	inputOutputBooleanBitsArray[12] = inputOutputBooleanBitsArray[1] ^ inputOutputBooleanBitsArray[2] ^ inputOutputBooleanBitsArray[3] ^ inputOutputBooleanBitsArray[4] ^ inputOutputBooleanBitsArray[6] ^ inputOutputBooleanBitsArray[8] ^ inputOutputBooleanBitsArray[9];
+	inputOutputBooleanBitsArray[13] = inputOutputBooleanBitsArray[2] ^ inputOutputBooleanBitsArray[3] ^ inputOutputBooleanBitsArray[4] ^ inputOutputBooleanBitsArray[5] ^ inputOutputBooleanBitsArray[7] ^ inputOutputBooleanBitsArray[9] ^ inputOutputBooleanBitsArray[10];
+	inputOutputBooleanBitsArray[14] = inputOutputBooleanBitsArray[0] ^ inputOutputBooleanBitsArray[1] ^ inputOutputBooleanBitsArray[2] ^ inputOutputBooleanBitsArray[4] ^ inputOutputBooleanBitsArray[6] ^ inputOutputBooleanBitsArray[7] ^ inputOutputBooleanBitsArray[10];
+
+	if (is16114)
+	{
+		inputOutputBooleanBitsArray[15] = inputOutputBooleanBitsArray[0] ^ inputOutputBooleanBitsArray[2] ^ inputOutputBooleanBitsArray[5] ^ inputOutputBooleanBitsArray[6] ^ inputOutputBooleanBitsArray[8] ^ inputOutputBooleanBitsArray[9] ^ inputOutputBooleanBitsArray[10];
+	}
+}
+
+static uint8_t refHammingGetBits(bool *inputOutputBooleanBitsArray, bool is16114)
+{
+	uint8_t n;
+
+	n  = ((inputOutputBooleanBitsArray[0] ^ inputOutputBooleanBitsArray[1] ^ inputOutputBooleanBitsArray[2] ^ inputOutputBooleanBitsArray[3] ^ inputOutputBooleanBitsArray[5] ^ inputOutputBooleanBitsArray[7] ^ inputOutputBooleanBitsArray[8]) != inputOutputBooleanBitsArray[11]) ? 0x01 : 0x00;
+	n |= ((inputOutputBooleanBitsArray[1] ^ inputOutputBooleanBitsArray[2] ^ inputOutputBooleanBitsArray[3] ^ inputOutputBooleanBitsArray[4] ^ inputOutputBooleanBitsArray[6] ^ inputOutputBooleanBitsArray[8] ^ inputOutputBooleanBitsArray[9]) != inputOutputBooleanBitsArray[12]) ? 0x02 : 0x00;
+	n |= ((inputOutputBooleanBitsArray[2] ^ inputOutputBooleanBitsArray[3] ^ inputOutputBooleanBitsArray[4] ^ inputOutputBooleanBitsArray[5] ^ inputOutputBooleanBitsArray[7] ^ inputOutputBooleanBitsArray[9] ^ inputOutputBooleanBitsArray[10]) != inputOutputBooleanBitsArray[13]) ? 0x04 : 0x00;
+	n |= ((inputOutputBooleanBitsArray[0] ^ inputOutputBooleanBitsArray[1] ^ inputOutputBooleanBitsArray[2] ^ inputOutputBooleanBitsArray[4] ^ inputOutputBooleanBitsArray[6] ^ inputOutputBooleanBitsArray[7] ^ inputOutputBooleanBitsArray[10]) != inputOutputBooleanBitsArray[14]) ? 0x08 : 0x00;
+
+	if (is16114)
+	{
+		n |= ((inputOutputBooleanBitsArray[0] ^ inputOutputBooleanBitsArray[2] ^ inputOutputBooleanBitsArray[5] ^ inputOutputBooleanBitsArray[6] ^ inputOutputBooleanBitsArray[8] ^ inputOutputBooleanBitsArray[9] ^ inputOutputBooleanBitsArray[10]) != inputOutputBooleanBitsArray[15]) ? 0x10 : 0x00;
+	}
+
+	return n;
+}
+
+static void refEmbeddedDataEncode(void)
+{
+	bool data[128];
+	uint32_t arrayIndex = 0;
+
+	uint32_t crc = refCRCEncodeFiveBit(refEmbeddedDataProcessed);
+
+	memset(data, 0, 128 * sizeof(bool));
+
+	data[106] = (crc & 0x01) == 0x01;
+	data[90]  = (crc & 0x02) == 0x02;
+	data[74]  = (crc & 0x04) == 0x04;
+	data[58]  = (crc & 0x08) == 0x08;
+	data[42]  = (crc & 0x10) == 0x10;
+
+	for (int range = 0; range < 7; range++)
+	{
+		for (uint32_t i = embedddataCopyRanges[range][0]; i <= embedddataCopyRanges[range][1]; i++, arrayIndex++)
+		{
+			data[i] = refEmbeddedDataProcessed[arrayIndex];
+		}
+	}
+
+	for (int i = 0; i < 112; i += 16)
+	{
+		refHammingEncode(data + i, true);
+	}
+
+	for (int i = 0; i < 16; i++)
+	{
+		data[i + 112] = data[i + 0] ^ data[i + 16] ^ data[i + 32] ^ data[i + 48] ^ data[i + 64] ^ data[i + 80] ^ data[i + 96];
+	}
+
+	arrayIndex = 0;
+	for (int i = 0; i < 128; i++)
+	{
+		refEmbeddedDataRaw[i] = data[arrayIndex];
+		arrayIndex += 16;
+		if (arrayIndex > 127)
+		{
+			arrayIndex -= 127;
+		}
+	}
+}
+
+static bool refEmbeddedDataDecode(void)
+{
+	uint32_t crc = 0;
+	bool tmpBooleanBitsArray[128];
+	int bitArrayIndex = 0;
+
+	memset(tmpBooleanBitsArray, 0, 128 * sizeof(bool));
+
+	for (int i = 0; i < 128; i++)
+	{
+		tmpBooleanBitsArray[bitArrayIndex] = refEmbeddedDataRaw[i];
+		bitArrayIndex += 16;
+		if (bitArrayIndex > 127)
+		{
+			bitArrayIndex -= 127;
+		}
+	}
+
+	for (int i = 0; i < 112; i += 16)
+	{
+		if (!refHammingDecodeType1(tmpBooleanBitsArray + i))
+		{
+			return false;
+		}
+	}
+
+	// Check parity
+	for (int i = 0; i < 16; i++)
+	{
+		bool parity = tmpBooleanBitsArray[i + 0] ^ tmpBooleanBitsArray[i + 16] ^ tmpBooleanBitsArray[i + 32] ^ tmpBooleanBitsArray[i + 48] ^ tmpBooleanBitsArray[i + 64] ^ tmpBooleanBitsArray[i + 80] ^ tmpBooleanBitsArray[i + 96] ^ tmpBooleanBitsArray[i + 112];
+		if (parity)
+		{
+			return false;
+		}
+	}
+
+	bitArrayIndex = 0;
+
+	for (int range = 0; range < 7; range++)
+	{
+		for (uint32_t i = embedddataCopyRanges[range][0]; i <= embedddataCopyRanges[range][1]; i++, bitArrayIndex++)
+		{
+			refEmbeddedDataProcessed[bitArrayIndex] = tmpBooleanBitsArray[i];
+		}
+	}
+
+	if (tmpBooleanBitsArray[42])
+	{
+		crc += 16;
+	}
+
+	if (tmpBooleanBitsArray[58])
+	{
+		crc += 8;
+	}
+
+	if (tmpBooleanBitsArray[74])
+	{
+		crc += 4;
+	}
+
+	if (tmpBooleanBitsArray[90])
+	{
+		crc += 2;
+	}
+
+	if (tmpBooleanBitsArray[106])
+	{
+		crc += 1;
+	}
+
+	if (crc != refCRCEncodeFiveBit(refEmbeddedDataProcessed))
+	{
+		return false;
+	}
+
+	return true;
+}
+
+static uint32_t refCRCEncodeFiveBit(const bool *in)
+{
+	uint32_t total = 0;
+
+	for (int i = 0; i < 72; i += 8)
+	{
+		total += refBooleanBitsArrayToByte(in + i);
+	}
+
+	total %= 31;
+
+	return total;
+}
+
+static void refByteToBooleanBitsArray(uint8_t byteIn, bool *bitsOut)
+{
+	for (int i = 0, shift = 7; i < 8; i++, shift--)
+	{
+		bitsOut[i] = (byteIn >> shift) & 0x01;
+	}
+}
+
+static uint8_t refBooleanBitsArrayToByte(const bool *bitsIn)
+{
+	uint8_t out = 0;
+	for (int i = 0, shift = 7; i < 8; i++, shift--)
+	{
+		out  |= bitsIn[i] << shift;
+	}
+	return out;
+}
+
+
+static uint32_t randomNext(void)
+{
+	randomState ^= (randomState << 13);
+	randomState ^= (randomState >> 17);
+	randomState ^= (randomState << 5);
+
+	return randomState;
+}
+
+static void randomFill(uint8_t *data, uint32_t length)
+{
+	for (uint32_t i = 0; i < length; i++)
+	{
+		data[i] = randomNext() & 0xFF;
+	}
+}
+
+// Flips up to 3 bits of the BPTC info bits (raw bits 0..97 and 98..195 are around the slot type / sync)
+static void injectBurstErrors(uint8_t *burst)
+{
+	uint32_t errors = randomNext() % 4;
+
+	for (uint32_t i = 0; i < errors; i++)
+	{
+		uint32_t bit = randomNext() % 196;
+		uint32_t pos = (bit < 98) ? bit : (bit + 68);
+
+		burst[pos >> 3] ^= (0x80 >> (pos & 0x07));
+	}
+}
+
+static uint16_t boolsToCodeword(const bool *bits)
+{
+	uint16_t codeword = 0;
+
+	for (int i = 0; i < 16; i++)
+	{
+		if (bits[i])
+		{
+			codeword |= (0x8000 >> i);
+		}
+	}
+
+	return codeword;
+}
+
+static void codewordToBools(uint16_t codeword, bool *bits)
+{
+	for (int i = 0; i < 16; i++)
+	{
+		bits[i] = ((codeword & (0x8000 >> i)) != 0);
+	}
+}
+
+static void testHamming(void)
+{
+	uint32_t mismatches = 0;
+
+	for (uint32_t value = 0; value < 0x10000; value++)
+	{
+		bool bits[16];
+		uint16_t codeword;
+		bool refResult;
+		bool result;
+
+		// (15,11,3), bit 15 is not part of the codeword
+		codewordToBools(value, bits);
+		refResult = refHammingDecodeType2(bits);
+		codeword = value;
+		result = dmrFECHamming15113Decode(&codeword);
+		if ((result != refResult) || (codeword != boolsToCodeword(bits)))
+		{
+			mismatches++;
+		}
+
+		// (16,11,4)
+		codewordToBools(value, bits);
+		refResult = refHammingDecodeType1(bits);
+		codeword = value;
+		result = dmrFECHamming16114Decode(&codeword);
+		if ((result != refResult) || (refResult && (codeword != boolsToCodeword(bits))))
+		{
+			mismatches++;
+		}
+	}
+
+	for (uint32_t data = 0; data < 0x800; data++)
+	{
+		for (int is16114 = 0; is16114 < 2; is16114++)
+		{
+			bool bits[16];
+			uint16_t codeword = (data << 5);
+
+			codewordToBools(codeword, bits);
+			refHammingEncode(bits, is16114);
+			if (!is16114)
+			{
+				bits[15] = false;
+			}
+
+			if (dmrFECHammingEncode(codeword, is16114) != boolsToCodeword(bits))
+			{
+				mismatches++;
+			}
+		}
+	}
+
+	printf("  Hamming (15,11,3) / (16,11,4): all the 65536 received words and 2048 data words, %u mismatches\n", mismatches);
+	HOST_CHECK(mismatches == 0);
+}
+
+static void testBPTC(void)
+{
+	uint32_t encodeMismatches = 0;
+	uint32_t decodeMismatches = 0;
+	uint32_t corrected = 0;
+
+	for (uint32_t frame = 0; frame < RANDOM_FRAMES; frame++)
+	{
+		uint8_t payload[DMR_FEC_BPTC19696_PAYLOAD_LENGTH];
+		uint8_t refBurst[BURST_LENGTH];
+		uint8_t burst[BURST_LENGTH];
+		uint8_t refDecoded[DMR_FEC_BPTC19696_PAYLOAD_LENGTH];
+		uint8_t decoded[DMR_FEC_BPTC19696_PAYLOAD_LENGTH];
+
+		randomFill(payload, sizeof(payload));
+		randomFill(refBurst, sizeof(refBurst));// Slot type and sync bits must be left as they are
+		memcpy(burst, refBurst, sizeof(burst));
+
+		refBPTCencode(payload, refBurst);
+		dmrFECBPTC19696Encode(payload, burst);
+		if (memcmp(refBurst, burst, sizeof(burst)) != 0)
+		{
+			encodeMismatches++;
+		}
+
+		// Every 8th frame is random noise, to exercise the uncorrectable paths
+		if ((frame & 0x07) == 0)
+		{
+			randomFill(burst, sizeof(burst));
+		}
+		else
+		{
+			injectBurstErrors(burst);
+		}
+
+		refBPTCdecode(burst, refDecoded);
+		dmrFECBPTC19696Decode(burst, decoded);
+		if (memcmp(refDecoded, decoded, sizeof(decoded)) != 0)
+		{
+			decodeMismatches++;
+		}
+
+		if (memcmp(payload, decoded, sizeof(decoded)) == 0)
+		{
+			corrected++;
+		}
+	}
+
+	printf("  BPTC (196,96): %u frames with 0 to 3 bit errors or noise, %u encode and %u decode mismatches (%u decoded back)\n",
+			RANDOM_FRAMES, encodeMismatches, decodeMismatches, corrected);
+	HOST_CHECK(encodeMismatches == 0);
+	HOST_CHECK(decodeMismatches == 0);
+	HOST_CHECK(corrected >= ((RANDOM_FRAMES * 7) / 8));
+}
+
+static void testEmbeddedData(void)
+{
+	uint32_t encodeMismatches = 0;
+	uint32_t decodeMismatches = 0;
+	uint32_t valid = 0;
+
+	for (uint32_t frame = 0; frame < RANDOM_FRAMES; frame++)
+	{
+		uint8_t lc[DMR_FEC_EMBEDDED_DATA_LC_LENGTH];
+		uint8_t raw[DMR_FEC_EMBEDDED_DATA_RAW_LENGTH];
+		uint8_t decoded[DMR_FEC_EMBEDDED_DATA_LC_LENGTH];
+		bool refValid;
+		bool isValid;
+
+		randomFill(lc, sizeof(lc));
+
+		for (int i = 0; i < 9; i++)
+		{
+			refByteToBooleanBitsArray(lc[i], refEmbeddedDataProcessed + (i << 3));
+		}
+
+		refEmbeddedDataEncode();
+		dmrFECEmbeddedDataEncode(lc, raw);
+
+		// The raw bits are sent in order, 32 per voice burst
+		for (int i = 0; i < 16; i++)
+		{
+			if (raw[i] != refBooleanBitsArrayToByte(refEmbeddedDataRaw + (i << 3)))
+			{
+				encodeMismatches++;
+				break;
+			}
+		}
+
+		if ((frame & 0x07) == 0)
+		{
+			randomFill(raw, sizeof(raw));
+		}
+		else
+		{
+			uint32_t errors = randomNext() % 4;
+
+			for (uint32_t i = 0; i < errors; i++)
+			{
+				uint32_t bit = randomNext() % 128;
+
+				raw[bit >> 3] ^= (0x80 >> (bit & 0x07));
+			}
+		}
+
+		for (int i = 0; i < 16; i++)
+		{
+			refByteToBooleanBitsArray(raw[i], refEmbeddedDataRaw + (i << 3));
+		}
+
+		memset(decoded, 0, sizeof(decoded));
+		refValid = refEmbeddedDataDecode();
+		isValid = dmrFECEmbeddedDataDecode(raw, decoded);
+
+		if (isValid != refValid)
+		{
+			decodeMismatches++;
+		}
+		else if (isValid)
+		{
+			valid++;
+
+			for (int i = 0; i < 9; i++)
+			{
+				if (decoded[i] != refBooleanBitsArrayToByte(refEmbeddedDataProcessed + (i << 3)))
+				{
+					decodeMismatches++;
+					break;
+				}
+			}
+		}
+	}
+
+	printf("  embedded LC: %u frames with 0 to 3 bit errors or noise, %u encode and %u decode mismatches (%u valid)\n",
+			RANDOM_FRAMES, encodeMismatches, decodeMismatches, valid);
+	HOST_CHECK(encodeMismatches == 0);
+	HOST_CHECK(decodeMismatches == 0);
+	HOST_CHECK(valid > 0);
+}
+
+static void benchmark(void)
+{
+	static uint8_t bursts[256][BURST_LENGTH];
+	uint8_t payload[DMR_FEC_BPTC19696_PAYLOAD_LENGTH];
+	uint8_t raw[DMR_FEC_EMBEDDED_DATA_RAW_LENGTH];
+	uint32_t check = 0;
+	double start;
+	double refBPTCRate;
+	double bptcRate;
+	double refEmbeddedRate;
+	double embeddedRate;
+
+	for (int i = 0; i < 256; i++)
+	{
+		randomFill(payload, sizeof(payload));
+		dmrFECBPTC19696Encode(payload, bursts[i]);
+		injectBurstErrors(bursts[i]);
+	}
+
+	// Decode then re-encode, as hotspot mode does for the LC headers and terminators
+	start = hostSeconds();
+	for (uint32_t i = 0; i < BENCHMARK_FRAMES; i++)
+	{
+		refBPTCdecode(bursts[i & 0xFF], payload);
+		refBPTCencode(payload, bursts[(i + 1) & 0xFF]);
+		check += payload[0];
+	}
+	refBPTCRate = BENCHMARK_FRAMES / (hostSeconds() - start);
+
+	start = hostSeconds();
+	for (uint32_t i = 0; i < BENCHMARK_FRAMES; i++)
+	{
+		dmrFECBPTC19696Decode(bursts[i & 0xFF], payload);
+		dmrFECBPTC19696Encode(payload, bursts[(i + 1) & 0xFF]);
+		check += payload[0];
+	}
+	bptcRate = BENCHMARK_FRAMES / (hostSeconds() - start);
+
+	start = hostSeconds();
+	for (uint32_t i = 0; i < BENCHMARK_FRAMES; i++)
+	{
+		refEmbeddedDataDecode();
+		refEmbeddedDataEncode();
+		check += refEmbeddedDataRaw[i & 0x7F];
+	}
+	refEmbeddedRate = BENCHMARK_FRAMES / (hostSeconds() - start);
+
+	memcpy(raw, bursts[0], sizeof(raw));
+	start = hostSeconds();
+	for (uint32_t i = 0; i < BENCHMARK_FRAMES; i++)
+	{
+		dmrFECEmbeddedDataDecode(raw, payload);
+		dmrFECEmbeddedDataEncode(payload, raw);
+		check += raw[i & 0x0F];
+	}
+	embeddedRate = BENCHMARK_FRAMES / (hostSeconds() - start);
+
+	printf("  BPTC (196,96) decode + encode: %.0f frames/s previously, %.0f frames/s now (x%.1f)\n", refBPTCRate, bptcRate, (bptcRate / refBPTCRate));
+	printf("  embedded LC decode + encode:   %.0f frames/s previously, %.0f frames/s now (x%.1f) [%u]\n", refEmbeddedRate, embeddedRate,
+			(embeddedRate / refEmbeddedRate), (check & 0x01));
+	HOST_CHECK(bptcRate > refBPTCRate);
+	HOST_CHECK(embeddedRate > refEmbeddedRate);
+}
+
+int main(void)
+{
+	printf("DMR FEC codecs\n");
+
+	testHamming();
+	testBPTC();
+	testEmbeddedData();
+	benchmark();
+
+	if (hostCheckFailures() != 0)
+	{
+		printf("FAILED (%d)\n", hostCheckFailures());
+		return EXIT_FAILURE;
+	}
+
+	printf("OK\n");
+	return EXIT_SUCCESS;
+}
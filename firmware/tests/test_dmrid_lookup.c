@@ -0,0 +1,514 @@
+/*
+ * Copyright (C) 2024 Roger Clark, VK3KYY / G4KYF
+ *                    Daniel Caujolle-Bert, F1RMB
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+ *    in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. Use of this source code or binary releases for commercial purposes is strictly forbidden. This includes, without limitation,
+ *    incorporation in a commercial product or incorporation into a product or project which allows commercial use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// DMR ID database lookups (dmrIDDatabase.c) against a database image in the simulated flash:
+// results checked against the image, flash transactions and SPI clocks per lookup compared with the
+// previous implementation (14 slices, then a binary search reading one ID per transaction).
+//
+// Usage: test_dmrid_lookup [trace]
+// trace: last heard IDs, one decimal DMR ID per line. A net like trace is generated if none is given.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hardware/SPI_Flash.h"
+#include "functions/dmrIDDatabase.h"
+#include "functions/codeplug.h"
+#include "flashModel.h"
+
+#define DB_ENTRIES          200000U
+#define DB_TEXT_LENGTH      12U
+#define COMPRESSED_ENTRIES  50000U
+#define TRACE_MAX_LENGTH    100000U
+#define PREVIOUS_ID_SLICES  14U
+
+typedef struct
+{
+	uint32_t id;
+	char     text[DB_TEXT_LENGTH + 1];
+} testRecord_t;
+
+typedef struct
+{
+	uint32_t lookups;
+	uint64_t transactions;
+	uint64_t clocks;
+	uint32_t maxTransactions;
+} lookupCost_t;
+
+const uint32_t VOICE_PROMPTS_FLASH_HEADER_ADDRESS = 0x8F400 + FLASH_ADDRESS_OFFSET;
+
+static const char textChars[] = " 0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz.";
+static testRecord_t records[DB_ENTRIES];
+static uint32_t numRecords;
+static uint32_t recordLength;// In the flash
+static uint32_t idLength;
+static uint32_t trace[TRACE_MAX_LENGTH];
+static uint32_t traceLength;
+static uint32_t randomState = 0x2468ACE1;
+
+
+static uint32_t randomNext(void)
+{
+	randomState ^= (randomState << 13);
+	randomState ^= (randomState >> 17);
+	randomState ^= (randomState << 5);
+
+	return randomState;
+}
+
+// Same as codeplug.c
+uint32_t bcd2int(uint32_t i)
+{
+	uint32_t result = 0;
+	int multiplier = 1;
+
+	while (i)
+	{
+		result += (i & 0x0f) * multiplier;
+		multiplier *= 10;
+		i = i >> 4;
+	}
+	return result;
+}
+
+uint32_t int2bcd(uint32_t i)
+{
+	uint32_t result = 0;
+	int shift = 0;
+
+	while (i)
+	{
+		result += (i % 10) << shift;
+		i = i / 10;
+		shift += 4;
+	}
+	return result;
+}
+
+static int recordCompare(const void *a, const void *b)
+{
+	uint32_t idA = ((const testRecord_t *)a)->id;
+	uint32_t idB = ((const testRecord_t *)b)->id;
+
+	return ((idA > idB) - (idA < idB));
+}
+
+static testRecord_t *recordFind(uint32_t id)
+{
+	testRecord_t key = { .id = id };
+
+	return bsearch(&key, records, numRecords, sizeof(testRecord_t), recordCompare);
+}
+
+// Where the record lands in the flash, as laid out by the CPS: the first storage location, then the second one
+static uint32_t recordAddress(uint32_t position, uint32_t location2)
+{
+	uint32_t area1Size = (recordLength * ((0x40000 - DMRID_HEADER_LENGTH) / recordLength));
+	uint32_t offset = (recordLength * position);
+
+	return ((offset >= area1Size) ? (location2 + (offset - area1Size)) : (DMRID_MEMORY_LOCATION_1 + DMRID_HEADER_LENGTH + offset));
+}
+
+static void compressText(const char *text, uint8_t *out)
+{
+	uint8_t codes[DB_TEXT_LENGTH];
+
+	for (uint32_t i = 0; i < DB_TEXT_LENGTH; i++)
+	{
+		codes[i] = (strchr(textChars, text[i]) - textChars);
+	}
+
+	for (uint32_t i = 0; i < DB_TEXT_LENGTH; i += 4)
+	{
+		*out++ = ((codes[i] << 2) | (codes[i + 1] >> 4));
+		*out++ = ((codes[i + 1] << 4) | (codes[i + 2] >> 2));
+		*out++ = ((codes[i + 2] << 6) | codes[i + 3]);
+	}
+}
+
+// 'compressed': 3 bytes binary IDs and 6 bits characters ("IdN"), otherwise 4 bytes BCD IDs and plain text
+static void buildDatabase(uint32_t entries, bool compressed)
+{
+	uint8_t header[12] = { 'I', 'd', (compressed ? 'N' : 'G'), 0, 0, 0, 0, 0, entries, (entries >> 8), (entries >> 16), (entries >> 24) };
+	uint32_t location2 = DMRID_MEMORY_LOCATION_2;
+
+	idLength = (compressed ? 3 : 4);
+	recordLength = (idLength + (compressed ? ((DB_TEXT_LENGTH * 6) / 8) : DB_TEXT_LENGTH));
+	header[3] = (recordLength + 0x4a);
+	numRecords = entries;
+
+	// Unique IDs. As in the real DB, they are grouped by country (3 digits prefix), some countries having many more
+	// users than others, and a lot of prefixes being unused.
+	for (uint32_t i = 0; i < entries; i++)
+	{
+		uint32_t country = (randomNext() % 64);
+
+		country = ((country * country * country) / (64 * 64));// Skewed towards the first ones
+		records[i].id = ((((country * 37) % 700) + 200) * 10000) + (randomNext() % 10000);
+	}
+	qsort(records, entries, sizeof(testRecord_t), recordCompare);
+	for (uint32_t i = 1; i < entries; i++)
+	{
+		if (records[i].id <= records[i - 1].id)
+		{
+			records[i].id = (records[i - 1].id + 1);
+		}
+	}
+
+	flashModelInit(0xFF);
+	memcpy(&flashModelMemory[DMRID_MEMORY_LOCATION_1], header, sizeof(header));
+
+	for (uint32_t i = 0; i < entries; i++)
+	{
+		uint8_t *record = &flashModelMemory[recordAddress(i, location2)];
+		uint32_t len = 4 + (randomNext() % (DB_TEXT_LENGTH - 4));
+		uint32_t storedId = (compressed ? records[i].id : int2bcd(records[i].id));
+
+		// Callsign and name, space padded
+		memset(records[i].text, ' ', DB_TEXT_LENGTH);
+		records[i].text[DB_TEXT_LENGTH] = 0;
+		for (uint32_t c = 0; c < len; c++)
+		{
+			records[i].text[c] = textChars[1 + (randomNext() % (sizeof(textChars) - 2))];
+		}
+
+		memcpy(record, &storedId, idLength);
+		if (compressed)
+		{
+			compressText(records[i].text, (record + idLength));
+			// The decoder trims the padding
+			for (int c = (DB_TEXT_LENGTH - 1); (c >= 0) && (records[i].text[c] == ' '); c--)
+			{
+				records[i].text[c] = 0;
+			}
+		}
+		else
+		{
+			memcpy((record + idLength), records[i].text, DB_TEXT_LENGTH);
+		}
+	}
+
+	HOST_CHECK(SPI_Flash_init());
+	flashModelResetStats();
+	dmrIDCacheInit();
+	HOST_CHECK(dmrIDCacheGetCount() == entries);
+}
+
+// Cost of the same lookup with the previous implementation
+static void previousLookupCost(uint32_t id, lookupCost_t *cost)
+{
+	uint32_t transactions = 0;
+	uint32_t clocks = 0;
+	uint32_t idsPerSlice = (numRecords / (PREVIOUS_ID_SLICES - 1));
+	uint32_t startPos = 0;
+	uint32_t endPos = (numRecords - 1);
+
+	// ID read, then text read on a match
+#define PREVIOUS_READ(len) do { transactions++; clocks += ((4 + (len)) * 8); } while (0)
+
+	cost->lookups++;
+
+	if ((id >= records[0].id) && (id <= records[numRecords - 1].id))
+	{
+		for (uint32_t i = 0; i < (PREVIOUS_ID_SLICES - 1); i++)
+		{
+			uint32_t sliceStart = (idsPerSlice * i);
+			uint32_t sliceEnd = ((i == (PREVIOUS_ID_SLICES - 2)) ? (numRecords - 1) : (idsPerSlice * (i + 1)));
+
+			if ((id >= records[sliceStart].id) &&
+					((i == (PREVIOUS_ID_SLICES - 2)) ? (id <= records[sliceEnd].id) : (id < records[sliceEnd].id)))
+			{
+				if (id == records[sliceStart].id)
+				{
+					PREVIOUS_READ(recordLength - idLength);
+					goto done;
+				}
+
+				startPos = sliceStart;
+				endPos = sliceEnd;
+				break;
+			}
+		}
+
+		while (startPos <= endPos)
+		{
+			uint32_t curPos = ((startPos + endPos) >> 1);
+
+			PREVIOUS_READ(idLength);
+
+			if (records[curPos].id < id)
+			{
+				startPos = (curPos + 1);
+			}
+			else if (records[curPos].id > id)
+			{
+				endPos = (curPos - 1);
+			}
+			else
+			{
+				PREVIOUS_READ(recordLength - idLength);
+				break;
+			}
+		}
+	}
+
+	done:
+	cost->transactions += transactions;
+	cost->clocks += clocks;
+	if (transactions > cost->maxTransactions)
+	{
+		cost->maxTransactions = transactions;
+	}
+}
+
+static void checkLookup(uint32_t id, lookupCost_t *cost, lookupCost_t *previousCost)
+{
+	dmrIdDataStruct_t found;
+	testRecord_t *expected = recordFind(id);
+	uint32_t transactions = flashModelStats.transactions;
+	uint64_t clocks = hostCycles;
+	bool result;
+
+	memset(&found, 0xA5, sizeof(found));
+	result = dmrIDLookup(id, &found);
+
+	transactions = (flashModelStats.transactions - transactions);
+	cost->lookups++;
+	cost->transactions += transactions;
+	cost->clocks += (hostCycles - clocks);
+	if (transactions > cost->maxTransactions)
+	{
+		cost->maxTransactions = transactions;
+	}
+
+	if (previousCost != NULL)
+	{
+		previousLookupCost(id, previousCost);
+	}
+
+	if (expected != NULL)
+	{
+		char text[DB_TEXT_LENGTH + 1];
+
+		// Plain text records are padded, not NULL terminated
+		snprintf(text, sizeof(text), "%s", expected->text);
+
+		HOST_CHECK(result);
+		HOST_CHECK(strcmp(found.text, text) == 0);
+	}
+	else
+	{
+		char text[MAX_DMR_ID_CONTACT_TEXT_LENGTH];
+
+		snprintf(text, sizeof(text), "ID:%d", id);
+		HOST_CHECK(result == false);
+		HOST_CHECK(strcmp(found.text, text) == 0);
+	}
+
+	HOST_CHECK(found.id == ((idLength == 4) ? int2bcd(id) : id));
+}
+
+static void printCost(const char *name, lookupCost_t *cost)
+{
+	printf("  %-38s %6u lookups, %5.2f flash transactions (max %u) and %7.1f SPI clocks per lookup\n", name, cost->lookups,
+			((double)cost->transactions / cost->lookups), cost->maxTransactions, ((double)cost->clocks / cost->lookups));
+}
+
+// A net: a few regulars keying up over and over, newcomers, and IDs not in the DB
+static void generateTrace(void)
+{
+	uint32_t regulars[30];
+
+	for (uint32_t i = 0; i < 30; i++)
+	{
+		regulars[i] = records[randomNext() % numRecords].id;
+	}
+
+	for (traceLength = 0; traceLength < 5000; traceLength++)
+	{
+		uint32_t r = (randomNext() % 100);
+
+		if (r < 70)
+		{
+			// Skewed towards the first ones
+			trace[traceLength] = regulars[(randomNext() % 30) * (randomNext() % 30) / 30];
+		}
+		else if (r < 95)
+		{
+			trace[traceLength] = records[randomNext() % numRecords].id;
+		}
+		else
+		{
+			trace[traceLength] = (records[randomNext() % numRecords].id + 1 + (randomNext() % 3));
+		}
+	}
+}
+
+static bool loadTrace(const char *filename)
+{
+	FILE *f = fopen(filename, "r");
+	unsigned int id;
+
+	if (f == NULL)
+	{
+		perror(filename);
+		return false;
+	}
+
+	traceLength = 0;
+	while ((traceLength < TRACE_MAX_LENGTH) && (fscanf(f, "%u", &id) == 1))
+	{
+		trace[traceLength++] = id;
+	}
+	fclose(f);
+
+	return (traceLength > 0);
+}
+
+// Records, the IDs around them and random IDs: they are nearly all different, so the recently looked up IDs cache doesn't help
+static void testAllRecords(bool compressed, uint32_t entries, uint32_t step)
+{
+	lookupCost_t cost = { 0 };
+	lookupCost_t previousCost = { 0 };
+
+	buildDatabase(entries, compressed);
+
+	for (uint32_t i = 0; i < entries; i += step)
+	{
+		checkLookup(records[i].id, &cost, &previousCost);
+		checkLookup(records[i].id - 1, &cost, &previousCost);
+		checkLookup(records[i].id + 1, &cost, &previousCost);
+		checkLookup(1000000 + (randomNext() % 9000000), &cost, &previousCost);
+	}
+	checkLookup(records[0].id, &cost, NULL);
+	checkLookup(records[entries - 1].id, &cost, NULL);
+	checkLookup(1, &cost, NULL);
+	checkLookup(16777215, &cost, NULL);
+
+	HOST_CHECK(cost.maxTransactions <= previousCost.maxTransactions);
+	HOST_CHECK((cost.transactions * 2) < previousCost.transactions);
+	HOST_CHECK(cost.clocks < previousCost.clocks);
+
+	printf("  %u entries, %s records of %u bytes\n", entries, (compressed ? "compressed" : "plain text"), recordLength);
+	printCost("lookups, previously:", &previousCost);
+	printCost("lookups, now:", &cost);
+}
+
+// Served by the recently looked up IDs cache, a lookup has to give the same result as from the flash
+static void testCachedLookups(void)
+{
+	uint32_t ids[] = { records[1234].id, (records[1234].id + 1), 1, records[4321].id };
+
+	for (uint32_t i = 0; i < (sizeof(ids) / sizeof(ids[0])); i++)
+	{
+		dmrIdDataStruct_t fromFlash;
+		dmrIdDataStruct_t fromCache;
+		uint32_t hits, misses;
+		uint32_t initHits;
+		bool resultFromFlash;
+
+		memset(&fromFlash, 0xA5, sizeof(fromFlash));
+		resultFromFlash = dmrIDLookup(ids[i], &fromFlash);
+		dmrIDCacheGetLRUStats(&initHits, &misses);
+		memset(&fromCache, 0x5A, sizeof(fromCache));
+		HOST_CHECK(dmrIDLookup(ids[i], &fromCache) == resultFromFlash);
+
+		dmrIDCacheGetLRUStats(&hits, &misses);
+		HOST_CHECK(hits == (initHits + 1));
+		HOST_CHECK(fromCache.id == fromFlash.id);
+		HOST_CHECK(strcmp(fromCache.text, fromFlash.text) == 0);
+	}
+}
+
+static void testTraceReplay(const char *filename)
+{
+	lookupCost_t cost = { 0 };
+	lookupCost_t previousCost = { 0 };
+	uint32_t hits, misses;
+	uint32_t initHits, initMisses;
+	uint32_t initTransactions;
+	double start;
+
+	flashModelResetStats();
+	buildDatabase(DB_ENTRIES, false);
+	initTransactions = flashModelStats.transactions;
+
+	if (filename != NULL)
+	{
+		if (loadTrace(filename) == false)
+		{
+			HOST_CHECK(false);
+			return;
+		}
+	}
+	else
+	{
+		generateTrace();
+	}
+
+	dmrIDCacheGetLRUStats(&initHits, &initMisses);
+	start = hostSeconds();
+	for (uint32_t i = 0; i < traceLength; i++)
+	{
+		checkLookup(trace[i], &cost, &previousCost);
+	}
+
+	dmrIDCacheGetLRUStats(&hits, &misses);
+	hits -= initHits;
+	misses -= initMisses;
+	HOST_CHECK((hits + misses) == traceLength);
+	HOST_CHECK(cost.transactions < previousCost.transactions);
+
+	printf("  last heard trace replay (%s), %u entries DB, index built with %u flash transactions\n",
+			((filename != NULL) ? filename : "generated"), DB_ENTRIES, initTransactions);
+	printCost("previously:", &previousCost);
+	printCost("now:", &cost);
+	printf("  recently looked up IDs cache: %u hits, %u misses, %.2f us per lookup on the host\n", hits, misses,
+			(((hostSeconds() - start) * 1E6) / traceLength));
+}
+
+int main(int argc, char **argv)
+{
+	printf("DMR ID database lookups\n");
+
+	testAllRecords(false, DB_ENTRIES, 97);
+	testCachedLookups();
+	testAllRecords(true, COMPRESSED_ENTRIES, 13);
+	testCachedLookups();
+	testTraceReplay((argc > 1) ? argv[1] : NULL);
+
+	if (hostCheckFailures() != 0)
+	{
+		printf("FAILED (%d)\n", hostCheckFailures());
+		return EXIT_FAILURE;
+	}
+
+	printf("OK\n");
+	return EXIT_SUCCESS;
+}
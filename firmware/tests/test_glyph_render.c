@@ -0,0 +1,338 @@
+/*
+ * Copyright (C) 2024 Roger Clark, VK3KYY / G4KYF
+ *                    Daniel Caujolle-Bert, F1RMB
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+ *    in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. Use of this source code or binary releases for commercial purposes is strictly forbidden. This includes, without limitation,
+ *    incorporation in a commercial product or incorporation into a product or project which allows commercial use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// Text rendering (displayPrintCore() in UC1701.c) with every string of the language headers, in every font size.
+// The compressed font glyphs, found through the glyph offset index and cache, are checked against the previous
+// lookup (a walk over the RLE pairs of every preceding glyph, kept below as the reference), on their own and
+// rendered in strings, then both are timed on the host.
+// Built for both charsets: the default one with all the languages, the Japanese one (LANGUAGE_BUILD_JAPANESE).
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include "hardware/UC1701.h"
+#include "user_interface/uiLocalisation.h"
+#include "user_interface/languages/english.h"
+#if defined(LANGUAGE_BUILD_JAPANESE)
+#include "user_interface/languages/japanese.h"
+#else
+#include "user_interface/languages/catalan.h"
+#include "user_interface/languages/croatian.h"
+#include "user_interface/languages/czech.h"
+#include "user_interface/languages/danish.h"
+#include "user_interface/languages/dutch.h"
+#include "user_interface/languages/finnish.h"
+#include "user_interface/languages/french.h"
+#include "user_interface/languages/german.h"
+#include "user_interface/languages/hungarian.h"
+#include "user_interface/languages/italian.h"
+#include "user_interface/languages/polish.h"
+#include "user_interface/languages/portugues_brazil.h"
+#include "user_interface/languages/portuguese.h"
+#include "user_interface/languages/romanian.h"
+#include "user_interface/languages/slovenian.h"
+#include "user_interface/languages/spanish.h"
+#include "user_interface/languages/swedish.h"
+#include "user_interface/languages/turkish.h"
+#endif
+#include "hostSupport.h"
+
+#define CHARS_PER_FONT         223 // As in the charset headers, which can only be included once (in UC1701.c)
+#define COMPRESSED_CHAR_BYTES  64
+#define BENCHMARK_PASSES       200
+
+extern const uint8_t font_16x32_compressed[];
+
+static const stringsTable_t *LANGUAGES[] =
+{
+		&englishLanguage,
+#if defined(LANGUAGE_BUILD_JAPANESE)
+		&japaneseLanguage
+#else
+		&catalanLanguage, &croatianLanguage, &czechLanguage, &danishLanguage, &dutchLanguage, &finnishLanguage,
+		&frenchLanguage, &germanLanguage, &hungarianLanguage, &italianLanguage, &polishLanguage, &portuguesBrazilLanguage,
+		&portuguesLanguage, &romanianLanguage, &slovenianLanguage, &spanishLanguage, &swedishLanguage, &turkishLanguage
+#endif
+};
+#define NUMBER_OF_LANGUAGES    (sizeof(LANGUAGES) / sizeof(LANGUAGES[0]))
+#define STRINGS_PER_LANGUAGE   ((sizeof(stringsTable_t) - offsetof(stringsTable_t, LANGUAGE_NAME)) / LANGUAGE_TEXTS_LENGTH)
+
+const stringsTable_t *currentLanguage = &englishLanguage;
+bool headerRowIsDirty = false;
+
+static uint8_t refScreen[(DISPLAY_SIZE_X * DISPLAY_SIZE_Y) >> 3];
+
+
+// Previous compressed glyph lookup
+
+static uint8_t *refGetUncompressedChar(uint8_t *dest, uint8_t *currentFont, uint8_t charOffset)
+{
+	if (charOffset < CHARS_PER_FONT)
+	{
+		uint8_t count = 0;
+		uint8_t *p = currentFont + 8; // skip the header
+		uint8_t numOfPairs = *p;
+
+		do
+		{
+			if (count == charOffset)
+			{
+				uint8_t *pSrc = p + 1;
+				uint8_t *pDest = dest;
+
+				// decode RLE8
+				while (numOfPairs > 0)
+				{
+					uint8_t l = (*(pSrc + 1) + 1);
+
+					memset(pDest, *pSrc, l);
+
+					pDest += l;
+					pSrc += 2;
+					numOfPairs--;
+				}
+
+				break;
+			}
+
+			p += ((numOfPairs * 2) + 1);
+			numOfPairs = *p;
+
+			count++;
+
+		} while (count < CHARS_PER_FONT);
+	}
+
+	return dest;
+}
+
+// Previous displayPrintCore() path for the compressed font, left aligned on a page boundary
+static void refPrintCompressed(int16_t x, int16_t y, const char *szMsg)
+{
+	uint8_t *currentFont = (uint8_t *)font_16x32_compressed;
+	int16_t startCode = currentFont[2];
+	int16_t endCode = currentFont[3];
+	int16_t charWidthPixels = currentFont[4];
+	int16_t charHeightPixels = currentFont[5];
+	int16_t sLen = strlen(szMsg);
+	uint8_t uncompressChar[COMPRESSED_CHAR_BYTES];
+
+	if ((charWidthPixels * sLen) + x > DISPLAY_SIZE_X)
+	{
+		sLen = (DISPLAY_SIZE_X - x) / charWidthPixels;
+	}
+
+	for (int16_t i = 0; i < sLen; i++)
+	{
+		if (szMsg[i] == ' ')
+		{
+			continue;
+		}
+
+		uint32_t charOffset = (szMsg[i] - startCode);
+
+		if (charOffset > endCode)
+		{
+			charOffset = ('?' - startCode);
+		}
+
+		memset(uncompressChar, 0, sizeof(uncompressChar));
+		uint8_t *currentCharData = refGetUncompressedChar(&uncompressChar[0], currentFont, charOffset);
+
+		for (int16_t row = 0; row < charHeightPixels / 8 ; row++)
+		{
+			uint8_t *readPos = (currentCharData + row * charWidthPixels);
+			uint8_t *writePos = (refScreen + x + (i * charWidthPixels) + ((y >> 3) + row) * DISPLAY_SIZE_X);
+
+			for (int16_t p = 0; p < charWidthPixels; p++)
+			{
+				*writePos++ |= *readPos++;
+			}
+		}
+	}
+}
+
+
+// Called by the display driver, the LCD isn't simulated here
+void displayTransferRows(const uint8_t *buffer, int16_t startRow, int16_t endRow, const uint8_t *startColumns, const uint8_t *endColumns)
+{
+}
+
+void uiNotificationRefresh(void)
+{
+}
+
+bool uiNotificationIsVisible(void)
+{
+	return false;
+}
+
+static const char *languageString(const stringsTable_t *language, uint32_t index)
+{
+	return (language->LANGUAGE_NAME + (index * LANGUAGE_TEXTS_LENGTH));
+}
+
+static void testCompressedGlyphs(void)
+{
+	uint8_t *screen = displayGetPrimaryScreenBuffer();
+	uint32_t glyphMismatches = 0;
+	uint32_t stringMismatches = 0;
+	uint32_t strings = 0;
+	char text[2] = { 0, 0 };
+
+	// Every glyph on its own, in reverse order so that the index and the cache don't just follow the walk
+	for (int c = (font_16x32_compressed[2] + CHARS_PER_FONT - 1); c >= font_16x32_compressed[2]; c--)
+	{
+		text[0] = c;
+
+		displayClearBuf();
+		memset(refScreen, 0, sizeof(refScreen));
+		displayPrintCore(0, 0, text, FONT_SIZE_4, TEXT_ALIGN_LEFT, false);
+		refPrintCompressed(0, 0, text);
+
+		if (memcmp(screen, refScreen, sizeof(refScreen)) != 0)
+		{
+			glyphMismatches++;
+		}
+	}
+
+	// Then all the strings, which exercise the decoded glyphs cache
+	for (uint32_t l = 0; l < NUMBER_OF_LANGUAGES; l++)
+	{
+		for (uint32_t s = 0; s < STRINGS_PER_LANGUAGE; s++)
+		{
+			const char *string = languageString(LANGUAGES[l], s);
+
+			displayClearBuf();
+			memset(refScreen, 0, sizeof(refScreen));
+			displayPrintCore(0, 16, string, FONT_SIZE_4, TEXT_ALIGN_LEFT, false);
+			refPrintCompressed(0, 16, string);
+
+			if (memcmp(screen, refScreen, sizeof(refScreen)) != 0)
+			{
+				stringMismatches++;
+			}
+
+			strings++;
+		}
+	}
+
+	printf("  compressed font: %u glyphs, %u mismatches, %u language strings, %u mismatches\n", CHARS_PER_FONT, glyphMismatches, strings, stringMismatches);
+	HOST_CHECK(glyphMismatches == 0);
+	HOST_CHECK(stringMismatches == 0);
+}
+
+static void benchmark(void)
+{
+	static const ucFont_t FONTS[] = { FONT_SIZE_1, FONT_SIZE_1_BOLD, FONT_SIZE_2, FONT_SIZE_3, FONT_SIZE_4 };
+	uint32_t chars = 0;
+	double start;
+	double refCompressed;
+	double compressed;
+	double allFonts;
+
+	for (uint32_t l = 0; l < NUMBER_OF_LANGUAGES; l++)
+	{
+		for (uint32_t s = 0; s < STRINGS_PER_LANGUAGE; s++)
+		{
+			chars += strlen(languageString(LANGUAGES[l], s));
+		}
+	}
+
+	start = hostSeconds();
+	for (uint32_t pass = 0; pass < BENCHMARK_PASSES; pass++)
+	{
+		for (uint32_t l = 0; l < NUMBER_OF_LANGUAGES; l++)
+		{
+			for (uint32_t s = 0; s < STRINGS_PER_LANGUAGE; s++)
+			{
+				refPrintCompressed(0, 16, languageString(LANGUAGES[l], s));
+			}
+		}
+	}
+	refCompressed = (hostSeconds() - start);
+
+	start = hostSeconds();
+	for (uint32_t pass = 0; pass < BENCHMARK_PASSES; pass++)
+	{
+		for (uint32_t l = 0; l < NUMBER_OF_LANGUAGES; l++)
+		{
+			for (uint32_t s = 0; s < STRINGS_PER_LANGUAGE; s++)
+			{
+				displayPrintCore(0, 16, languageString(LANGUAGES[l], s), FONT_SIZE_4, TEXT_ALIGN_LEFT, false);
+			}
+		}
+	}
+	compressed = (hostSeconds() - start);
+
+	start = hostSeconds();
+	for (uint32_t pass = 0; pass < BENCHMARK_PASSES; pass++)
+	{
+		for (uint32_t f = 0; f < (sizeof(FONTS) / sizeof(FONTS[0])); f++)
+		{
+			for (uint32_t l = 0; l < NUMBER_OF_LANGUAGES; l++)
+			{
+				for (uint32_t s = 0; s < STRINGS_PER_LANGUAGE; s++)
+				{
+					displayPrintCore(0, 16, languageString(LANGUAGES[l], s), FONTS[f], TEXT_ALIGN_LEFT, false);
+				}
+			}
+		}
+	}
+	allFonts = (hostSeconds() - start);
+
+	printf("  %u languages, %u strings of %u characters (at most 8 printed with the large font)\n", (uint32_t)NUMBER_OF_LANGUAGES,
+			(uint32_t)(NUMBER_OF_LANGUAGES * STRINGS_PER_LANGUAGE), chars);
+	printf("  large (compressed) font: %.2f us per string previously, %.2f us now\n",
+			((refCompressed * 1E6) / (BENCHMARK_PASSES * NUMBER_OF_LANGUAGES * STRINGS_PER_LANGUAGE)),
+			((compressed * 1E6) / (BENCHMARK_PASSES * NUMBER_OF_LANGUAGES * STRINGS_PER_LANGUAGE)));
+	printf("  all the 5 font sizes: %.2f us per string\n", ((allFonts * 1E6) / (BENCHMARK_PASSES * 5 * NUMBER_OF_LANGUAGES * STRINGS_PER_LANGUAGE)));
+	HOST_CHECK(compressed < refCompressed);
+}
+
+int main(void)
+{
+#if defined(LANGUAGE_BUILD_JAPANESE)
+	printf("Text rendering, Japanese charset\n");
+#else
+	printf("Text rendering\n");
+#endif
+
+	testCompressedGlyphs();
+	benchmark();
+
+	if (hostCheckFailures() != 0)
+	{
+		printf("FAILED (%d)\n", hostCheckFailures());
+		return EXIT_FAILURE;
+	}
+
+	printf("OK\n");
+	return EXIT_SUCCESS;
+}
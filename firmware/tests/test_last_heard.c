@@ -0,0 +1,296 @@
+/*
+ * Copyright (C) 2024 Roger Clark, VK3KYY / G4KYF
+ *                    Daniel Caujolle-Bert, F1RMB
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+ *    in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. Use of this source code or binary releases for commercial purposes is strictly forbidden. This includes, without limitation,
+ *    incorporation in a commercial product or incorporation into a product or project which allows commercial use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// Last heard list (lastHeardList.c): random heard/evict/update sequences, mirroring lastHeardListUpdate(), with the
+// MRU list and the DMR ID hash index checked after every step against a plain array model. Then the lookup is
+// timed against the previous linear walk of the list.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "functions/lastHeardList.h"
+#include "hostSupport.h"
+
+#define FUZZ_ROUNDS          200U
+#define FUZZ_STEPS          5000U
+#define BENCHMARK_LOOKUPS 2000000U
+
+static LinkItem_t callsList[NUM_LASTHEARD_STORED];
+static LinkItem_t *LinkHead = callsList;
+static uint32_t modelIds[NUM_LASTHEARD_STORED];// Most recently heard first, 0 when unused
+static uint32_t randomState = 0x1A57B0B5;
+
+
+static uint32_t randomNext(void)
+{
+	randomState ^= (randomState << 13);
+	randomState ^= (randomState >> 17);
+	randomState ^= (randomState << 5);
+
+	return randomState;
+}
+
+// Previous lastHeardFindInList()
+static LinkItem_t *refLastHeardFindInList(uint32_t id)
+{
+	LinkItem_t *item = LinkHead;
+
+	while (item->next != NULL)
+	{
+		if (item->id == id)
+		{
+			// found it
+			return item;
+		}
+		item = item->next;
+	}
+	return NULL;
+}
+
+// Same as lastHeardInitList()
+static void initList(void)
+{
+	LinkHead = callsList;
+
+	lastHeardListClearIndex();
+
+	for (int i = 0; i < NUM_LASTHEARD_STORED; i++)
+	{
+		memset(&callsList[i], 0, sizeof(LinkItem_t));
+		callsList[i].prev = ((i == 0) ? NULL : &callsList[i - 1]);
+		callsList[i].next = ((i < (NUM_LASTHEARD_STORED - 1)) ? &callsList[i + 1] : NULL);
+	}
+
+	memset(modelIds, 0, sizeof(modelIds));
+}
+
+// Same list operations as lastHeardListUpdate(), on a new DMR ID
+static void heard(uint32_t id)
+{
+	LinkItem_t *item = lastHeardFindInList(id);
+	int found = -1;
+
+	if (item != NULL)
+	{
+		lastHeardListMoveToHead(&LinkHead, item);
+	}
+	else
+	{
+		item = lastHeardListReuseTail(&LinkHead, id);
+	}
+	item->talkGroupOrPcId = (id ^ 0x5A5A5A);
+
+	// Model
+	for (int i = 0; i < NUM_LASTHEARD_STORED; i++)
+	{
+		if (modelIds[i] == id)
+		{
+			found = i;
+			break;
+		}
+	}
+
+	memmove(&modelIds[1], &modelIds[0], (((found >= 0) ? found : (NUM_LASTHEARD_STORED - 1)) * sizeof(uint32_t)));
+	modelIds[0] = id;
+}
+
+static uint32_t checkList(uint32_t idRange)
+{
+	uint32_t errors = 0;
+	int position = 0;
+	LinkItem_t *previous = NULL;
+
+	// MRU order and links, both ways
+	if (LinkHead->prev != NULL)
+	{
+		errors++;
+	}
+
+	for (LinkItem_t *item = LinkHead; item != NULL; item = item->next)
+	{
+		if ((position >= NUM_LASTHEARD_STORED) || (item->prev != previous) || (item->id != modelIds[position]))
+		{
+			errors++;
+			break;
+		}
+
+		if ((item->id != 0) && (item->talkGroupOrPcId != (item->id ^ 0x5A5A5A)))
+		{
+			errors++;
+		}
+
+		previous = item;
+		position++;
+	}
+
+	if (position != NUM_LASTHEARD_STORED)
+	{
+		errors++;
+	}
+
+	// Hash chains without loops (a lookup would never return), then every listed ID, and only them, is indexed
+	for (int i = 0; i < NUM_LASTHEARD_STORED; i++)
+	{
+		int chainLength = 0;
+
+		for (LinkItem_t *chained = callsList[i].hashNext; chained != NULL; chained = chained->hashNext)
+		{
+			if ((chained->id == 0) || (++chainLength >= NUM_LASTHEARD_STORED))
+			{
+				errors++;
+				break;
+			}
+		}
+	}
+
+	if (errors != 0)
+	{
+		return errors;
+	}
+
+	for (int i = 0; i < NUM_LASTHEARD_STORED; i++)
+	{
+		if ((callsList[i].id != 0) && (lastHeardFindInList(callsList[i].id) != &callsList[i]))
+		{
+			errors++;
+		}
+	}
+
+	for (uint32_t id = 0; id <= (idRange + 1); id++)
+	{
+		bool inModel = false;
+
+		for (int i = 0; (i < NUM_LASTHEARD_STORED) && (id != 0); i++)
+		{
+			inModel |= (modelIds[i] == id);
+		}
+
+		LinkItem_t *item = lastHeardFindInList(id);
+		if ((inModel != (item != NULL)) || ((item != NULL) && (item->id != id)))
+		{
+			errors++;
+		}
+	}
+
+	return errors;
+}
+
+static void testFuzz(void)
+{
+	uint32_t errors = 0;
+	uint32_t evictions = 0;
+
+	for (uint32_t round = 0; round < FUZZ_ROUNDS; round++)
+	{
+		// From a few stations coming back all the time to many more than the list holds
+		uint32_t idRange = 1 + (randomNext() % (NUM_LASTHEARD_STORED * 6));
+
+		initList();
+
+		for (uint32_t step = 0; step < FUZZ_STEPS; step++)
+		{
+			uint32_t id = 1 + (randomNext() % idRange);
+
+			if ((randomNext() % 50) == 0)
+			{
+				id = 1 + (randomNext() % 16777215);// anywhere in the 24 bits DMR ID range, colliding in the hash buckets
+			}
+
+			evictions += ((lastHeardFindInList(id) == NULL) && (modelIds[NUM_LASTHEARD_STORED - 1] != 0)) ? 1 : 0;
+			heard(id);
+
+			uint32_t stepErrors = checkList(idRange);
+			if (stepErrors != 0)
+			{
+				errors += stepErrors;
+				break;// the list can't be walked any further
+			}
+		}
+	}
+
+	printf("  %u rounds of %u stations heard, %u evictions: %u list/index errors\n", FUZZ_ROUNDS, FUZZ_STEPS, evictions, errors);
+	HOST_CHECK(evictions > 0);
+	HOST_CHECK(errors == 0);
+}
+
+static void benchmark(void)
+{
+	uint32_t ids[256];
+	uint32_t check = 0;
+	double start, refRate, rate;
+
+	initList();
+	for (uint32_t i = 0; i < NUM_LASTHEARD_STORED; i++)
+	{
+		heard(1000000 + (randomNext() % 8000000));
+	}
+
+	// Half of the lookups are for a listed station, half for a new one
+	for (uint32_t i = 0; i < 256; i++)
+	{
+		ids[i] = (((i & 0x01) != 0) ? modelIds[randomNext() % (NUM_LASTHEARD_STORED - 1)] : (1000000 + (randomNext() % 8000000)));
+	}
+
+	start = hostSeconds();
+	for (uint32_t i = 0; i < BENCHMARK_LOOKUPS; i++)
+	{
+		check += (refLastHeardFindInList(ids[i & 0xFF]) != NULL) ? 1 : 0;
+	}
+	refRate = BENCHMARK_LOOKUPS / (hostSeconds() - start);
+
+	start = hostSeconds();
+	for (uint32_t i = 0; i < BENCHMARK_LOOKUPS; i++)
+	{
+		check += (lastHeardFindInList(ids[i & 0xFF]) != NULL) ? 1 : 0;
+	}
+	rate = BENCHMARK_LOOKUPS / (hostSeconds() - start);
+
+	printf("  %u entries: %.0f lookups/s previously, %.0f lookups/s now (x%.1f) [%u]\n",
+			NUM_LASTHEARD_STORED, refRate, rate, (rate / refRate), (check & 0x01));
+	HOST_CHECK(rate > refRate);
+}
+
+int main(void)
+{
+	printf("Last heard list\n");
+
+	testFuzz();
+	if (hostCheckFailures() == 0)
+	{
+		benchmark();// it would not return over a corrupted index
+	}
+
+	if (hostCheckFailures() != 0)
+	{
+		printf("FAILED (%d)\n", hostCheckFailures());
+		return EXIT_FAILURE;
+	}
+
+	printf("OK\n");
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,407 @@
+/*
+ * Copyright (C) 2024 Roger Clark, VK3KYY / G4KYF
+ *                    Daniel Caujolle-Bert, F1RMB
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+ *    in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. Use of this source code or binary releases for commercial purposes is strictly forbidden. This includes, without limitation,
+ *    incorporation in a commercial product or incorporation into a product or project which allows commercial use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// LCD transfer (UC1701_transfer.c) against a mock GPIO port which decodes the bit banged SPI:
+// the command/data byte stream has to be identical to the previous implementation (kept below as the
+// reference) for a corpus of frames, and the interrupts masked spans are compared.
+// Time is counted in GPIO port accesses (3 per bit sent).
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "hardware/UC1701.h"
+#include "functions/settings.h"
+#include "interfaces/gpio.h"
+
+#define DISPLAY_BUFFER_SIZE    ((DISPLAY_SIZE_X * DISPLAY_SIZE_Y) >> 3)
+#define CAPTURE_MAX_LENGTH     4096U
+#define CAPTURE_DATA           0x100U // The byte was sent in data mode
+#define CAPTURE_CS_RELEASED    0x200U // Not a byte, CS went high
+#define CORPUS_FRAMES          5000U
+#define DISPLAY_CONTROLLER_X_OFFSET  4
+
+typedef struct
+{
+	uint16_t items[CAPTURE_MAX_LENGTH];
+	uint32_t length;
+	uint32_t malformed;// CS released in the middle of a byte
+} lcdCapture_t;
+
+settingsStruct_t nonVolatileSettings;
+
+static lcdCapture_t *capture;
+static uint32_t lastPins;
+static uint32_t shiftRegister;
+static uint32_t shiftCount;
+static uint32_t interruptsServiced;
+static uint32_t randomState = 0x2545F491;
+
+static void refUC1701_transfer(register uint8_t data1);
+
+
+// Previous implementation, with the interrupts masked for the whole transfer and a branch per bit
+
+static void refUC1701_setCommandMode(void)
+{
+	GPIO_Display_RS->PCOR = 1U << Pin_Display_RS;// set the command / data pin low to signify Command mode
+}
+
+static void refUC1701_setDataMode(void)
+{
+	GPIO_Display_RS->PSOR = 1U << Pin_Display_RS;// set the command / data pin low to signify Data mode
+}
+
+static void refTransferRows(const uint8_t *buffer, int16_t startRow, int16_t endRow, const uint8_t *startColumns, const uint8_t *endColumns)
+{
+	taskENTER_CRITICAL();
+	GPIO_PinWrite(GPIO_Display_CS, Pin_Display_CS, 0);// Enable CS
+
+	for(int16_t row = startRow; row < endRow; row++)
+	{
+		int16_t startColumn = (startColumns ? startColumns[row] : 0);
+		int16_t endColumn = (endColumns ? endColumns[row] : DISPLAY_SIZE_X);
+
+		if (startColumn >= endColumn)
+		{
+			continue; // This page is already in sync with the LCD
+		}
+
+		const uint8_t *rowPos = (buffer + (row * DISPLAY_SIZE_X) + startColumn);
+		uint8_t controllerColumn = (startColumn + DISPLAY_CONTROLLER_X_OFFSET);
+
+		refUC1701_setCommandMode();
+		refUC1701_transfer(0xb0 | row); // set Y
+		refUC1701_transfer(0x10 | (controllerColumn >> 4)); // set X (high MSB)
+		refUC1701_transfer(0x00 | (controllerColumn & 0x0F)); // set X (low MSB).
+
+		refUC1701_setDataMode();
+		uint8_t data1;
+		for(int16_t line = startColumn; line < endColumn; line++)
+		{
+			data1 = *rowPos;
+			for (register int i = 0; i < 8; i++)
+			{
+				GPIO_Display_SCK->PCOR = 1U << Pin_Display_SCK;
+
+				if ((data1 & 0x80) == 0U)
+				{
+					GPIO_Display_SDA->PCOR = 1U << Pin_Display_SDA;// Hopefully the compiler will optimise this to a value rather than using a shift
+				}
+				else
+				{
+					GPIO_Display_SDA->PSOR = 1U << Pin_Display_SDA;// Hopefully the compiler will optimise this to a value rather than using a shift
+				}
+
+				GPIO_Display_SCK->PSOR = 1U << Pin_Display_SCK;// Hopefully the compiler will optimise this to a value rather than using a shift
+
+				data1 = data1 << 1;
+			}
+			rowPos++;
+		}
+	}
+
+	GPIO_PinWrite(GPIO_Display_CS, Pin_Display_CS, 1);// Disable CS
+	taskEXIT_CRITICAL();
+}
+
+static void refUC1701_transfer(register uint8_t data1)
+{
+	for (register int i = 0; i < 8; i++)
+	{
+		GPIO_Display_SCK->PCOR = 1U << Pin_Display_SCK;
+
+		if ((data1 & 0x80) == 0U)
+		{
+			GPIO_Display_SDA->PCOR = 1U << Pin_Display_SDA;// Hopefully the compiler will otimise this to a value rather than using a shift
+		}
+		else
+		{
+			GPIO_Display_SDA->PSOR = 1U << Pin_Display_SDA;// Hopefully the compiler will otimise this to a value rather than using a shift
+		}
+		GPIO_Display_SCK->PSOR = 1U << Pin_Display_SCK;// Hopefully the compiler will otimise this to a value rather than using a shift
+
+		data1 = data1 << 1;
+	}
+}
+
+static void refSetContrast(uint8_t contrast)
+{
+	taskENTER_CRITICAL();
+	GPIO_PinWrite(GPIO_Display_CS, Pin_Display_CS, 0);// Enable CS
+	refUC1701_setCommandMode();
+	refUC1701_transfer(0x81);              // command to set contrast
+	refUC1701_transfer(contrast);          // set contrast
+	refUC1701_setDataMode();
+	GPIO_PinWrite(GPIO_Display_CS, Pin_Display_CS, 1);// Disable CS
+	taskEXIT_CRITICAL();
+}
+
+
+// Called by the display driver, nothing to do here
+void displayClearBuf(void)
+{
+}
+
+void displayRender(void)
+{
+}
+
+void displayLightTrigger(bool fromKeyEvent)
+{
+}
+
+void displayEnableBacklight(bool enable, int displayBacklightPercentageOff)
+{
+}
+
+// UC1701 serial interface: SDA is sampled on the SCK rising edges while CS is low, MSB first,
+// RS tells commands (low) from data (high) when the last bit is clocked in.
+static void lcdModelGpio(GPIO_Type *port)
+{
+	uint32_t pins = ((port->PDOR | port->PSOR) & ~port->PCOR);
+	bool csLow = ((pins & (1U << Pin_Display_CS)) == 0);
+
+	port->PDOR = pins;
+	port->PSOR = 0;
+	port->PCOR = 0;
+	hostCycles++;
+
+	if (capture == NULL)
+	{
+		lastPins = pins;
+		return;
+	}
+
+	if (csLow && ((lastPins & (1U << Pin_Display_SCK)) == 0) && (pins & (1U << Pin_Display_SCK)))
+	{
+		shiftRegister = (shiftRegister << 1) | ((pins >> Pin_Display_SDA) & 0x01);
+
+		if (++shiftCount == 8)
+		{
+			if (capture->length < CAPTURE_MAX_LENGTH)
+			{
+				capture->items[capture->length++] = (shiftRegister & 0xFF) | ((pins & (1U << Pin_Display_RS)) ? CAPTURE_DATA : 0);
+			}
+
+			shiftRegister = 0;
+			shiftCount = 0;
+		}
+	}
+
+	if (csLow == false && (lastPins & (1U << Pin_Display_CS)) == 0)
+	{
+		if (shiftCount != 0)
+		{
+			capture->malformed++;
+		}
+
+		if (capture->length < CAPTURE_MAX_LENGTH)
+		{
+			capture->items[capture->length++] = CAPTURE_CS_RELEASED;
+		}
+
+		shiftRegister = 0;
+		shiftCount = 0;
+	}
+
+	lastPins = pins;
+}
+
+static void lcdInterrupt(void)
+{
+	interruptsServiced++;
+}
+
+static void captureStart(lcdCapture_t *newCapture)
+{
+	newCapture->length = 0;
+	newCapture->malformed = 0;
+	shiftRegister = 0;
+	shiftCount = 0;
+	capture = newCapture;
+	hostResetCriticalStats();
+}
+
+static bool capturesAreIdentical(const lcdCapture_t *a, const lcdCapture_t *b)
+{
+	return ((a->length == b->length) && (a->length < CAPTURE_MAX_LENGTH) && (a->malformed == 0) && (b->malformed == 0) &&
+			(memcmp(a->items, b->items, (a->length * sizeof(uint16_t))) == 0));
+}
+
+static uint32_t randomNext(void)
+{
+	randomState ^= (randomState << 13);
+	randomState ^= (randomState >> 17);
+	randomState ^= (randomState << 5);
+
+	return randomState;
+}
+
+static void setup(void)
+{
+	hostGpioModel = lcdModelGpio;
+	hostGpioPort.PDOR = (1U << Pin_Display_CS) | (1U << Pin_Display_SCK);
+	capture = NULL;
+	hostGpioAccess();
+}
+
+static void testSingleBytes(void)
+{
+	static lcdCapture_t refCapture;
+	static lcdCapture_t newCapture;
+	uint32_t mismatches = 0;
+
+	for (uint32_t value = 0; value < 256; value++)
+	{
+		captureStart(&refCapture);
+		refSetContrast(value);
+		captureStart(&newCapture);
+		displaySetContrast(value);
+
+		if ((capturesAreIdentical(&refCapture, &newCapture) == false) || (newCapture.length != 3) || (newCapture.items[1] != value))
+		{
+			mismatches++;
+		}
+	}
+
+	capture = NULL;
+	printf("  every byte value (contrast command): %u mismatches\n", mismatches);
+	HOST_CHECK(mismatches == 0);
+}
+
+static void testFrameCorpus(void)
+{
+	static uint8_t frame[DISPLAY_BUFFER_SIZE];
+	static lcdCapture_t refCapture;
+	static lcdCapture_t newCapture;
+	uint8_t startColumns[DISPLAY_NUMBER_OF_ROWS];
+	uint8_t endColumns[DISPLAY_NUMBER_OF_ROWS];
+	uint64_t refMaxMasked = 0;
+	uint64_t newMaxMasked = 0;
+	uint64_t refTotal = 0;
+	uint64_t newTotal = 0;
+	uint32_t mismatches = 0;
+	uint32_t missedInterrupts = 0;
+	uint32_t bytesSent = 0;
+
+	hostInterruptHook = lcdInterrupt;
+
+	for (uint32_t f = 0; f < CORPUS_FRAMES; f++)
+	{
+		bool wholeRows = ((f % 4) == 0);
+		int16_t startRow = (wholeRows ? 0 : (randomNext() % DISPLAY_NUMBER_OF_ROWS));
+		int16_t endRow = (wholeRows ? DISPLAY_NUMBER_OF_ROWS : (startRow + 1 + (randomNext() % (DISPLAY_NUMBER_OF_ROWS - startRow))));
+		uint32_t pages = 0;
+		uint64_t start;
+
+		for (uint32_t i = 0; i < DISPLAY_BUFFER_SIZE; i++)
+		{
+			// Mostly blank screens with some text like patterns
+			frame[i] = (((f & 1) == 0) ? (randomNext() & 0xFF) : (((randomNext() % 4) == 0) ? (randomNext() & 0xFF) : 0x00));
+		}
+
+		for (int16_t row = 0; row < DISPLAY_NUMBER_OF_ROWS; row++)
+		{
+			uint8_t a = randomNext() % (DISPLAY_SIZE_X + 1);
+			uint8_t b = randomNext() % (DISPLAY_SIZE_X + 1);
+
+			// Some empty spans, as for rows in sync with the LCD
+			startColumns[row] = ((a < b) ? a : b);
+			endColumns[row] = (((randomNext() % 5) == 0) ? startColumns[row] : ((a < b) ? b : a));
+
+			if ((row >= startRow) && (row < endRow) && (wholeRows || (startColumns[row] < endColumns[row])))
+			{
+				pages++;
+			}
+		}
+
+		captureStart(&refCapture);
+		start = hostCycles;
+		refTransferRows(frame, startRow, endRow, (wholeRows ? NULL : startColumns), (wholeRows ? NULL : endColumns));
+		refTotal += (hostCycles - start);
+		if (hostCriticalMaxCycles > refMaxMasked)
+		{
+			refMaxMasked = hostCriticalMaxCycles;
+		}
+
+		interruptsServiced = 0;
+		captureStart(&newCapture);
+		start = hostCycles;
+		displayTransferRows(frame, startRow, endRow, (wholeRows ? NULL : startColumns), (wholeRows ? NULL : endColumns));
+		newTotal += (hostCycles - start);
+		if (hostCriticalMaxCycles > newMaxMasked)
+		{
+			newMaxMasked = hostCriticalMaxCycles;
+		}
+
+		// A pending interrupt gets serviced after each page addressing
+		if (interruptsServiced != pages)
+		{
+			missedInterrupts++;
+		}
+
+		if (capturesAreIdentical(&refCapture, &newCapture) == false)
+		{
+			mismatches++;
+		}
+
+		bytesSent += newCapture.length;
+	}
+
+	hostInterruptHook = NULL;
+	capture = NULL;
+
+	printf("  %u frames (whole screens and dirty column spans), %u bytes sent: %u mismatches\n", CORPUS_FRAMES, bytesSent, mismatches);
+	printf("  longest interrupts masked span: %llu GPIO accesses previously, %llu now\n", (unsigned long long)refMaxMasked, (unsigned long long)newMaxMasked);
+	printf("  GPIO accesses per frame: %.1f previously, %.1f now\n", ((double)refTotal / CORPUS_FRAMES), ((double)newTotal / CORPUS_FRAMES));
+	HOST_CHECK(mismatches == 0);
+	HOST_CHECK(missedInterrupts == 0);
+	// Only the 3 page address command bytes, and the command/data switches
+	HOST_CHECK(newMaxMasked <= ((3 * 8 * 3) + 4));
+	HOST_CHECK(newTotal <= refTotal);
+}
+
+int main(void)
+{
+	printf("LCD transfer\n");
+
+	setup();
+	testSingleBytes();
+	testFrameCorpus();
+
+	if (hostCheckFailures() != 0)
+	{
+		printf("FAILED (%d)\n", hostCheckFailures());
+		return EXIT_FAILURE;
+	}
+
+	printf("OK\n");
+	return EXIT_SUCCESS;
+}
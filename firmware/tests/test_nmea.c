@@ -0,0 +1,539 @@
+/*
+ * Copyright (C) 2024 Roger Clark, VK3KYY / G4KYF
+ *                    Daniel Caujolle-Bert, F1RMB
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+ *    in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. Use of this source code or binary releases for commercial purposes is strictly forbidden. This includes, without limitation,
+ *    incorporation in a commercial product or incorporation into a product or project which allows commercial use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// NMEA streaming parser (nmea.c): a corpus of sentences (the gps.c dummy data and a multi-constellation receiver log)
+// is fed character by character. The fields, checksum and line hash are checked against the previous line tokenizer,
+// kept below, as are the fixed point fields against strtod(). Then corrupted sentences, line noise and truncated
+// sentences, and the sentences/s of the streaming parser against the previous line buffering and tokenizing.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "functions/nmea.h"
+#include "hostSupport.h"
+
+#define STREAM_SENTENCES        20000U
+#define BENCHMARK_ROUNDS           50U
+#define REF_RX_BUFFERS_MAX          3U
+
+static const char *CORPUS[] =
+{
+		// USE_DUMMY_GPS_DATA lines, from gps.c
+		"$GNZDA,074101.000,20,09,2022,,*42",
+		"$GNGGA,074102.000,3858.1,N,14602.1,E,1,03,4.38,51.4,M,-1.5,M,,*50",
+		"$GPGSA,A,2,29,25,12,,,,,,,,,,4.49,4.38,1.00,1*16",
+		"$BDGSA,A,2,,,,,,,,,,,,,4.49,4.38,1.00,4*0D",
+		"$GPGSV,2,1,07,29,63,203,24,2,62,148,,25,61,339,24,20,33,129,*48",
+		"$GPGSV,2,2,07,12,32,18,25,26,7,220,,23,1,340,*76",
+		"$BDGSV,1,1,04,1,47,0,,4,44,22,,3,34,313,,2,12,289,*5D",
+		"$GNRMC,074102.000,A,3758.10000,N,14502.10000,E,5.000,275.00,200922,,,A*45",
+		"$GNGGA,074102.000,3858.10000,S,14502.10000,E,1,03,4.38,51.4,M,-1.5,M,,*4E",
+		"$GNRMC,074102.000,A,3758.00000,N,14502.00000,E,5.000,275.00,200922,,,A*45",
+		// Multi-constellation receiver (NMEA 4.1: GSA system ID and GSV signal ID fields)
+		"$GNRMC,101530.00,A,4807.03812,N,01131.00041,E,0.052,,170624,,,D*68",
+		"$GNVTG,,T,,M,0.052,N,0.096,K,D*30",
+		"$GNGGA,101530.00,4807.03812,N,01131.00041,E,2,12,0.71,519.3,M,47.0,M,,0000*4B",
+		"$GNGSA,A,3,05,13,15,18,20,23,24,29,,,,,1.23,0.71,1.00,1*02",
+		"$GNGSA,A,3,65,66,67,75,76,,,,,,,,1.23,0.71,1.00,2*04",
+		"$GNGSA,A,3,02,07,08,26,30,,,,,,,,1.23,0.71,1.00,3*0E",
+		"$GNGSA,A,3,11,12,19,20,,,,,,,,,1.23,0.71,1.00,4*0A",
+		"$GPGSV,4,1,13,05,37,283,41,07,04,040,,13,51,229,44,15,40,187,43,1*6F",
+		"$GPGSV,4,2,13,18,62,095,45,20,18,305,36,23,25,162,40,24,27,069,42,1*65",
+		"$GPGSV,4,3,13,29,45,298,38,30,08,330,,36,30,149,38,49,32,184,39,1*62",
+		"$GPGSV,4,4,13,10,01,004,,1*52",
+		"$GLGSV,3,1,09,65,34,045,38,66,67,108,41,67,26,167,33,74,07,332,,1*73",
+		"$GLGSV,3,2,09,75,47,294,40,76,40,218,37,81,05,022,,82,18,066,,1*7F",
+		"$GLGSV,3,3,09,88,11,126,,1*44",
+		"$GAGSV,2,1,07,02,38,061,39,07,29,245,36,08,58,297,41,26,16,099,33,7*76",
+		"$GAGSV,2,2,07,27,08,183,,30,72,151,43,36,02,330,,7*40",
+		"$GBGSV,2,1,06,11,52,139,40,12,19,079,35,19,46,221,39,20,33,290,37,1*74",
+		"$GBGSV,2,2,06,22,04,175,,44,15,031,,1*71",
+		"$GNGLL,4807.03812,N,01131.00041,E,101530.00,A,D*70",
+		"$GNZDA,101530.00,17,06,2024,00,00*7A",
+		"$GPTXT,01,01,02,ANTSTATUS=OK*3B",
+		// No fix, empty fields, southern/western hemispheres, negative altitude, lower case checksum
+		"$GPRMC,235959.000,V,,,,,,,311299,,,N*4D",
+		"$GPGGA,235959.000,,,,,0,00,99.99,,,,,,*57",
+		"$GPGSA,A,1,,,,,,,,,,,,,99.99,99.99,99.99*30",
+		"$GPGSV,1,1,00*79",
+		"$BDGSV,1,1,02,06,66,342,29,09,57,191,,0*7c",
+		"$GNRMC,000000.000,A,3351.87654,S,15112.34567,E,12.345,359.99,010125,,,A*6D",
+		"$GNGGA,000000.000,3351.87654,S,15112.34567,E,1,08,1.10,-12.7,M,21.3,M,,*77",
+		"$GNRMC,121212.000,A,5130.00000,N,00007.50000,W,,,150325,,,A,V*1E"
+};
+
+#define CORPUS_SIZE  (sizeof(CORPUS) / sizeof(CORPUS[0]))
+
+// Previous receive buffers, filled by the UART interrupt, then tokenized by gpsTick()
+typedef struct
+{
+	char    data[NMEA_LINE_LENGTH];
+	uint8_t length;
+} refReceiveBuffer_t;
+
+typedef struct
+{
+	const char *line;
+	uint8_t     length;
+	uint8_t     fieldsCount;
+	uint8_t     fieldStart[NMEA_FIELDS_MAX + 1];
+} refSentence_t;
+
+static refReceiveBuffer_t refRxBuffers[REF_RX_BUFFERS_MAX];
+static uint8_t refLinesCount = 0U;
+static uint8_t refBufferIndex = 0U;
+static uint8_t refCharPosition = 0U;
+
+static char stream[STREAM_SENTENCES * (NMEA_LINE_LENGTH + 8U)];
+static uint32_t streamLength = 0U;
+static int16_t expectedSentence[STREAM_SENTENCES];// Corpus index of each sentence of the stream, -1 if truncated
+static uint32_t streamCompleteSentences = 0U;
+static uint32_t randomState = 0xC0FFEE11;
+
+
+static uint32_t randomNext(void)
+{
+	randomState ^= (randomState << 13);
+	randomState ^= (randomState >> 17);
+	randomState ^= (randomState << 5);
+
+	return randomState;
+}
+
+static int8_t refHexDigitValue(char c)
+{
+	if ((c >= '0') && (c <= '9'))
+	{
+		return (c - '0');
+	}
+	else if ((c >= 'A') && (c <= 'F'))
+	{
+		return (c - 'A' + 10);
+	}
+	else if ((c >= 'a') && (c <= 'f'))
+	{
+		return (c - 'a' + 10);
+	}
+
+	return -1;
+}
+
+// Previous tokenizer: single pass over a received line
+static bool refTokenizeSentence(const char *line, uint8_t length, refSentence_t *sentence, uint16_t *lineHash)
+{
+	uint32_t c0 = 0;
+	uint32_t c1 = 0;
+	uint8_t checksum = 0U;
+	uint8_t checksumPosition = 0U;
+	bool fieldsOverflow = false;
+
+	sentence->line = line;
+	sentence->length = length;
+	sentence->fieldsCount = 1U;
+	sentence->fieldStart[0] = 1U; // skip '$'
+
+	for (uint8_t i = 0U; i < length; i++)
+	{
+		uint8_t c = (uint8_t)line[i];
+
+		c0 = c0 + c;
+		c1 = c1 + c0;
+
+		if ((i == 0U) || (checksumPosition != 0U))
+		{
+			continue;
+		}
+
+		if (c == '*')
+		{
+			checksumPosition = i;
+			sentence->fieldStart[sentence->fieldsCount] = (i + 1U);
+		}
+		else
+		{
+			checksum ^= c;
+
+			if (c == ',')
+			{
+				if (sentence->fieldsCount < NMEA_FIELDS_MAX)
+				{
+					sentence->fieldStart[sentence->fieldsCount++] = (i + 1U);
+				}
+				else
+				{
+					fieldsOverflow = true;
+				}
+			}
+		}
+	}
+
+	*lineHash = (uint16_t)(((c1 % 255) << 8) | (c0 % 255));
+
+	if ((line[0] != '$') || fieldsOverflow || (checksumPosition == 0U) || ((checksumPosition + 2U) >= length))
+	{
+		return false;
+	}
+
+	int8_t high = refHexDigitValue(line[checksumPosition + 1U]);
+	int8_t low = refHexDigitValue(line[checksumPosition + 2U]);
+
+	return ((high >= 0) && (low >= 0) && (checksum == ((high << 4) | low)));
+}
+
+// Previous gpsProcessChar()
+static void refProcessChar(uint8_t rxchar)
+{
+	if ((rxchar != '\r') && (refCharPosition < (NMEA_LINE_LENGTH - 1)))
+	{
+		if (rxchar >= '!') // Ignore '\n'
+		{
+			refRxBuffers[refBufferIndex].data[refCharPosition++] = rxchar;
+		}
+	}
+	else
+	{
+		refRxBuffers[refBufferIndex].data[refCharPosition] = 0;
+		refRxBuffers[refBufferIndex].length = refCharPosition;
+		refLinesCount++;
+		refBufferIndex = (refBufferIndex + 1) % REF_RX_BUFFERS_MAX;
+		refCharPosition = 0U;
+	}
+}
+
+// Feeds a whole text, returns the number of completed sentences (the last one is in sentence)
+static uint32_t feed(nmeaParser_t *parser, nmeaSentence_t *sentence, const char *text)
+{
+	uint32_t completed = 0U;
+
+	while (*text != 0)
+	{
+		if (nmeaParserProcessChar(parser, sentence, (uint8_t)*text++))
+		{
+			completed++;
+		}
+	}
+
+	return completed;
+}
+
+static uint32_t feedLine(nmeaSentence_t *sentence, const char *line)
+{
+	nmeaParser_t parser;
+	char text[2 * NMEA_LINE_LENGTH];
+
+	memset(&parser, 0xA5, sizeof(parser));
+	nmeaParserReset(&parser);
+	snprintf(text, sizeof(text), "%s\r\n", line);
+
+	return feed(&parser, sentence, text);
+}
+
+// Truncated, as the parser does
+static bool refFixedPoint(const char *field, uint8_t length, uint8_t decimals, int32_t *value)
+{
+	char text[NMEA_LINE_LENGTH];
+	char *end;
+	double v;
+
+	memcpy(text, field, length);
+	text[length] = 0;
+	v = strtod(text, &end);
+
+	if ((length == 0U) || (*end != 0) || (strchr(text, 'e') != NULL) || (strchr(text, 'E') != NULL))
+	{
+		return false;
+	}
+
+	v *= pow(10.0, decimals);
+	*value = (int32_t)((v < 0.0) ? -floor(-v + 1E-6) : floor(v + 1E-6));
+
+	return true;
+}
+
+// Each sentence of the corpus against the previous tokenizer
+static void testCorpus(void)
+{
+	uint32_t fieldsChecked = 0U, numbersChecked = 0U, mismatches = 0U;
+
+	for (uint32_t i = 0U; i < CORPUS_SIZE; i++)
+	{
+		nmeaSentence_t sentence;
+		refSentence_t refSentence;
+		uint16_t refHash;
+		uint8_t length = strlen(CORPUS[i]);
+		bool refIsValid = refTokenizeSentence(CORPUS[i], length, &refSentence, &refHash);
+
+		HOST_CHECK(feedLine(&sentence, CORPUS[i]) == 1U);
+		HOST_CHECK(refIsValid);
+
+		if ((sentence.isValid != refIsValid) || (sentence.hash != refHash) || (sentence.length != length) ||
+				(strcmp(sentence.line, CORPUS[i]) != 0) || (sentence.fieldsCount != refSentence.fieldsCount))
+		{
+			mismatches++;
+			continue;
+		}
+
+		for (uint8_t f = 0U; f < refSentence.fieldsCount; f++)
+		{
+			const char *refField = &refSentence.line[refSentence.fieldStart[f]];
+			uint8_t refFieldLength = (refSentence.fieldStart[f + 1] - refSentence.fieldStart[f] - 1);
+			int32_t value = 0, refValue = 0;
+			bool hasValue = nmeaGetFieldFixedPoint(&sentence, f, 2U, &value);
+			bool refHasValue = refFixedPoint(refField, refFieldLength, 2U, &refValue);
+
+			if ((nmeaGetFieldLength(&sentence, f) != refFieldLength) || (memcmp(nmeaGetField(&sentence, f), refField, refFieldLength) != 0) ||
+					(hasValue != refHasValue) || (hasValue && (value != refValue)))
+			{
+				mismatches++;
+			}
+
+			fieldsChecked++;
+			numbersChecked += (hasValue ? 1U : 0U);
+		}
+
+		// Past the last field
+		HOST_CHECK((nmeaGetFieldLength(&sentence, refSentence.fieldsCount) == 0U) && (*nmeaGetField(&sentence, refSentence.fieldsCount) == 0));
+	}
+
+	printf("  %u sentences, %u fields (%u numbers): %u mismatches with the previous tokenizer\n", (uint32_t)CORPUS_SIZE, fieldsChecked, numbersChecked, mismatches);
+	HOST_CHECK(mismatches == 0U);
+}
+
+// Any single character change before the checksum, or a broken checksum, invalidates the sentence
+static void testCorruption(void)
+{
+	uint32_t corrupted = 0U, accepted = 0U;
+	nmeaSentence_t sentence;
+	char line[2 * NMEA_LINE_LENGTH];
+
+	for (uint32_t n = 0U; n < 100000U; n++)
+	{
+		const char *source = CORPUS[randomNext() % CORPUS_SIZE];
+		uint8_t checksumPosition = (strchr(source, '*') - source);
+		uint8_t position = 1U + (randomNext() % (checksumPosition + 1U));// the '*' included
+		char c;
+
+		strcpy(line, source);
+
+		do
+		{
+			c = '!' + (randomNext() % ('~' - '!' + 1));
+		} while ((c == line[position]) || (c == '$'));
+
+		line[position] = c;
+
+		if (feedLine(&sentence, line) == 1U)
+		{
+			corrupted++;
+			accepted += (sentence.isValid ? 1U : 0U);
+		}
+	}
+
+	// Broken checksums, trailing characters, too many fields
+	HOST_CHECK((feedLine(&sentence, "$GPGSV,1,1,00*78") == 1U) && (sentence.isValid == false));
+	HOST_CHECK((feedLine(&sentence, "$GPGSV,1,1,00*7G") == 1U) && (sentence.isValid == false));
+	HOST_CHECK((feedLine(&sentence, "$GPGSV,1,1,00*7") == 1U) && (sentence.isValid == false));
+	HOST_CHECK((feedLine(&sentence, "$GPGSV,1,1,00") == 1U) && (sentence.isValid == false));
+	HOST_CHECK((feedLine(&sentence, "$GPGSV,1,1,00*790") == 1U) && (sentence.isValid == false));
+	HOST_CHECK((feedLine(&sentence, "$GPTXT,,,,,,,,,,,,,,,,,,,,,,,,,,,,,,*41") == 1U) && (sentence.isValid == false));
+	HOST_CHECK((feedLine(&sentence, "$GPGSV,1,1,00*79") == 1U) && sentence.isValid);
+
+	// Longer than a NMEA sentence: dropped
+	snprintf(line, sizeof(line), "$GPTXT,%0*d*00", (int)NMEA_LINE_LENGTH, 0);
+	HOST_CHECK(feedLine(&sentence, line) == 0U);
+
+	// Garbage, then a '$' restarting a sentence
+	HOST_CHECK((feedLine(&sentence, "GPGSV,1,1,00*79\r\n,*$GP$GPGSV,1,1,00*79") == 1U) && sentence.isValid && (strcmp(sentence.line, "$GPGSV,1,1,00*79") == 0));
+
+	printf("  %u sentences with a character changed: %u accepted\n", corrupted, accepted);
+	HOST_CHECK(corrupted == 100000U);
+	HOST_CHECK(accepted == 0U);
+}
+
+static void streamAppend(const char *text, uint32_t length)
+{
+	memcpy(&stream[streamLength], text, length);
+	streamLength += length;
+}
+
+// Corpus sentences, some truncated, with line noise in between (no '$')
+static void buildStream(void)
+{
+	static const char noise[] = "\r\n\t \x01\x7F\xFF,*0A!GPGGA";
+
+	streamLength = 0U;
+
+	for (uint32_t i = 0U; i < STREAM_SENTENCES; i++)
+	{
+		uint32_t index = (randomNext() % CORPUS_SIZE);
+		uint32_t length = strlen(CORPUS[index]);
+
+		if ((randomNext() % 16U) == 0U)
+		{
+			// Cut before the end of the checksum, then the next '$'
+			streamAppend(CORPUS[index], (randomNext() % (length - 1U)));
+			expectedSentence[i] = -1;
+		}
+		else
+		{
+			streamAppend(CORPUS[index], length);
+			streamAppend("\r\n", ((randomNext() & 1U) ? 2U : 1U));
+			expectedSentence[i] = index;
+		}
+
+		if ((randomNext() % 4U) == 0U)
+		{
+			uint32_t noiseLength = (randomNext() % 8U);
+
+			for (uint32_t n = 0U; n < noiseLength; n++)
+			{
+				stream[streamLength++] = noise[randomNext() % (sizeof(noise) - 1U)];
+			}
+		}
+	}
+}
+
+static void testStream(void)
+{
+	nmeaParser_t parser;
+	nmeaSentence_t sentence;
+	uint32_t valid = 0U, misplaced = 0U;
+	uint32_t s = 0U;
+
+	nmeaParserReset(&parser);
+	buildStream();
+
+	streamCompleteSentences = 0U;
+	for (uint32_t i = 0U; i < STREAM_SENTENCES; i++)
+	{
+		streamCompleteSentences += ((expectedSentence[i] >= 0) ? 1U : 0U);
+	}
+
+	for (uint32_t i = 0U; i < streamLength; i++)
+	{
+		if (nmeaParserProcessChar(&parser, &sentence, (uint8_t)stream[i]))
+		{
+			if (sentence.isValid)
+			{
+				// Next complete sentence of the stream, the noise can't fake one
+				while ((s < STREAM_SENTENCES) && (expectedSentence[s] < 0))
+				{
+					s++;
+				}
+
+				if ((s >= STREAM_SENTENCES) || (strcmp(sentence.line, CORPUS[expectedSentence[s]]) != 0))
+				{
+					misplaced++;
+				}
+
+				s++;
+				valid++;
+			}
+		}
+	}
+
+	printf("  %u bytes stream: %u of %u complete sentences recovered, %u misplaced\n", streamLength, valid, streamCompleteSentences, misplaced);
+	HOST_CHECK(valid == streamCompleteSentences);
+	HOST_CHECK(misplaced == 0U);
+}
+
+static void benchmark(void)
+{
+	nmeaParser_t parser;
+	nmeaSentence_t sentence;
+	refSentence_t refSentence;
+	uint32_t check = 0U, refSentences = 0U;
+	uint8_t refIndexProcessing = 0U;
+	double start, rate, refRate;
+
+	start = hostSeconds();
+	for (uint32_t n = 0U; n < BENCHMARK_ROUNDS; n++)
+	{
+		for (uint32_t i = 0U; i < streamLength; i++)
+		{
+			refProcessChar((uint8_t)stream[i]);
+
+			// As gpsTick() did: copy the line out of the receive buffers, then tokenize it
+			if (refLinesCount > 0U)
+			{
+				char line[NMEA_LINE_LENGTH];
+				uint8_t length = refRxBuffers[refIndexProcessing].length;
+				uint16_t hash;
+
+				memcpy(line, refRxBuffers[refIndexProcessing].data, (length + 1));
+				refLinesCount--;
+				refIndexProcessing = (refIndexProcessing + 1) % REF_RX_BUFFERS_MAX;
+
+				if ((length > 0U) && refTokenizeSentence(line, length, &refSentence, &hash))
+				{
+					check += (hash + refSentence.fieldsCount);
+					refSentences++;
+				}
+			}
+		}
+	}
+	refRate = (BENCHMARK_ROUNDS * streamCompleteSentences) / (hostSeconds() - start);
+
+	nmeaParserReset(&parser);
+	start = hostSeconds();
+	for (uint32_t n = 0U; n < BENCHMARK_ROUNDS; n++)
+	{
+		for (uint32_t i = 0U; i < streamLength; i++)
+		{
+			if (nmeaParserProcessChar(&parser, &sentence, (uint8_t)stream[i]) && sentence.isValid)
+			{
+				check += (sentence.hash + sentence.fieldsCount);
+			}
+		}
+	}
+	rate = (BENCHMARK_ROUNDS * streamCompleteSentences) / (hostSeconds() - start);
+
+	// The previous line buffering loses the sentence following a truncated one, or line noise
+	printf("  %.0f sentences/s previously (%u of %u recovered), %.0f sentences/s streaming (x%.1f) [%u]\n",
+			refRate, (refSentences / BENCHMARK_ROUNDS), streamCompleteSentences, rate, (rate / refRate), check);
+}
+
+int main(void)
+{
+	printf("NMEA streaming parser\n");
+
+	testCorpus();
+	testCorruption();
+	testStream();
+	benchmark();
+
+	if (hostCheckFailures() != 0)
+	{
+		printf("FAILED (%d)\n", hostCheckFailures());
+		return 1;
+	}
+
+	printf("OK\n");
+	return 0;
+}
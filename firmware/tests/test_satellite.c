@@ -0,0 +1,670 @@
+/*
+ * Copyright (C) 2024 Roger Clark, VK3KYY / G4KYF
+ *                    Daniel Caujolle-Bert, F1RMB
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+ *    in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. Use of this source code or binary releases for commercial purposes is strictly forbidden. This includes, without limitation,
+ *    incorporation in a commercial product or incorporation into a product or project which allows commercial use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// Satellite propagator (satellite.c) in single precision, checked against a double precision copy of the same
+// model over a week of every orbit kind: elevation, visible azimuth and Doppler. Then both are timed.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "functions/satellite.h"
+#include "hostSupport.h"
+
+#define NUM_TEST_SATELLITES            12U
+#define TEST_START_DATE_TIME   1714000000U // 2024-04-24 23:06:40 UTC, ~10 days after the element sets epoch
+#define TEST_DURATION        (7U * 86400U)
+#define TEST_TIME_STEP                  10U
+#define TEST_FREQ                 43580000U // 435.8 MHz, in 10 Hz units
+
+#define BENCHMARK_EVALUATIONS       500000U
+
+#define PASSES_DURATION            86400U
+#define PASSES_BENCHMARK_ROUNDS        20U
+#define SATELLITE_MIN_PASS_DURATION   120U // Shorter passes can fall between two samples of the horizon crossing search
+#define BATCH_TIME_STEP                60U
+
+#define OBSERVER_LAT                 -37.8f
+#define OBSERVER_LON                 145.0f
+#define OBSERVER_HEIGHT                 100
+
+// Same model constants as satellite.c
+#define REF_RE          6378.137
+#define REF_FL          (1.0 / 298.257224)
+#define REF_RP          (REF_RE * (1.0 - REF_FL))
+#define REF_XX          (REF_RE * REF_RE)
+#define REF_ZZ          (REF_RP * REF_RP)
+#define REF_YM          365.25
+#define REF_YT          365.2421970
+#define REF_WW          (2.0 * M_PI / REF_YT)
+#define REF_WE          (2.0 * M_PI + REF_WW)
+#define REF_W0          (REF_WE / 86400.0)
+#define REF_GM          3.986E5
+#define REF_J2          1.08263E-3
+#define REF_YG          2010
+#define REF_G0          99.5578
+
+typedef struct
+{
+	double		inclination;
+	double		eccentricity;
+	double		meanMotion;
+} testOrbit_t;
+
+typedef struct
+{
+	int32_t		DE;
+	double		TE;
+	double		SI;
+	double		CI;
+	double		RA;
+	double		EC;
+	double		WP;
+	double		MA;
+	double		MM;
+	double		N0;
+	double		A0;
+	double		b0;
+	double		QD;
+	double		WD;
+	double		DC;
+} refKeps_t;
+
+typedef struct
+{
+	double		Ux, Uy, Uz;
+	double		Ex, Ey;
+	double		Nx, Ny, Nz;
+	double		Ox, Oy, Oz;
+	double		VOx, VOy;
+} refObserver_t;
+
+typedef struct
+{
+	double		elevation;
+	double		azimuth;
+	int			rxFreq;
+} refResults_t;
+
+// ISS, FM birds in sun synchronous orbits, a low drag LEO, Molniya and GTO like ellipses, a MEO
+static const testOrbit_t ORBITS[NUM_TEST_SATELLITES] =
+{
+	{ 51.6416, 0.0005000, 15.49815000 },
+	{ 97.7000, 0.0012000, 14.92000000 },
+	{ 64.5560, 0.0045000, 14.81000000 },
+	{ 98.2000, 0.0001500, 14.33000000 },
+	{ 82.5000, 0.0020000, 13.74000000 },
+	{ 28.5000, 0.0100000, 15.85000000 },
+	{ 63.4000, 0.7200000,  2.00600000 },
+	{ 27.0000, 0.7300000,  2.25000000 },
+	{ 55.0000, 0.0060000,  2.00560000 },
+	{  5.0000, 0.0300000,  6.40000000 },
+	{ 43.0000, 0.0800000, 12.50000000 },
+	{ 99.0000, 0.0009000, 14.20000000 }
+};
+
+static satelliteData_t testSatellites[NUM_TEST_SATELLITES];
+static refKeps_t refKeps[NUM_TEST_SATELLITES];
+static refObserver_t refObserver;
+static uint32_t randomState = 0x5A7E11E5;
+
+
+static uint32_t randomNext(void)
+{
+	randomState ^= (randomState << 13);
+	randomState ^= (randomState >> 17);
+	randomState ^= (randomState << 5);
+
+	return randomState;
+}
+
+static double randomAngle(void)
+{
+	return ((randomNext() % 3600000U) / 10000.0);
+}
+
+// Packs the TLE fields text, two characters per byte, as the codeplug stores them
+static void compressTleData(const char *text, uint8_t *out, int len)
+{
+	static const char *COMPRESSION_LOOKUP = "0123456789. +-*";
+
+	for (int i = 0; i < len; i++)
+	{
+		out[i] = (uint8_t)(((strchr(COMPRESSION_LOOKUP, text[2 * i]) - COMPRESSION_LOOKUP) << 4) |
+				(strchr(COMPRESSION_LOOKUP, text[(2 * i) + 1]) - COMPRESSION_LOOKUP));
+	}
+}
+
+static double textField(const char *text, int start, int length)
+{
+	char field[40];
+
+	memcpy(field, &text[start], length);
+	field[length] = 0;
+
+	return atof(field);
+}
+
+static int32_t refDayFn(int year, int month, int day)
+{
+	if (month <= 2)
+	{
+		year -= 1;
+		month += 12;
+	}
+
+	return (int32_t)(year * REF_YM) + (int)((month + 1) * 30.6) + (day - 428);
+}
+
+// satelliteSetElementsTLE2Native(), in double precision
+static void refSetElements(const char *line1, const char *line2, refKeps_t *keps)
+{
+	double TE = textField(line1, 2, 12);
+	double M2 = textField(line1, 14, 10) * 2.0 * M_PI;
+	double IN = textField(line2, 0, 8) * M_PI / 180.0;
+
+	keps->RA = textField(line2, 8, 8) * M_PI / 180.0;
+	keps->EC = textField(line2, 16, 7) * 1.0e-7;
+	keps->WP = textField(line2, 23, 8) * M_PI / 180.0;
+	keps->MA = textField(line2, 31, 8) * M_PI / 180.0;
+	keps->MM = textField(line2, 39, 11) * 2.0 * M_PI;
+	keps->N0 = keps->MM / 86400.0;
+	keps->A0 = pow(REF_GM / keps->N0 / keps->N0, 1.0 / 3.0);
+	keps->DE = refDayFn((int)textField(line1, 0, 2) + 2000, 1, 0) + (int)TE;
+	keps->TE = TE - (int)TE;
+	keps->SI = sin(IN);
+	keps->CI = cos(IN);
+	keps->b0 = keps->A0 * sqrt(1.0 - keps->EC * keps->EC);
+
+	double PC = REF_RE * keps->A0 / (keps->b0 * keps->b0);
+	PC = 1.5 * REF_J2 * PC * PC * keps->MM;
+	keps->QD = -PC * keps->CI;
+	keps->WD = PC * (5.0 * keps->CI * keps->CI - 1.0) / 2.0;
+	keps->DC = -2.0 * M2 / keps->MM / 3.0;
+}
+
+// satelliteSetObserverLocation(), in double precision
+static void refSetObserver(double lat, double lon, int height)
+{
+	double latRad = lat * M_PI / 180.0;
+	double lonRad = lon * M_PI / 180.0;
+	double heightKm = height / 1000.0;
+	double D = sqrt(REF_XX * cos(latRad) * cos(latRad) + REF_ZZ * sin(latRad) * sin(latRad));
+	double Rx = REF_XX / D + heightKm;
+	double Rz = REF_ZZ / D + heightKm;
+
+	refObserver.Ux = cos(latRad) * cos(lonRad);
+	refObserver.Ex = -sin(lonRad);
+	refObserver.Nx = -sin(latRad) * cos(lonRad);
+	refObserver.Uy = cos(latRad) * sin(lonRad);
+	refObserver.Ey = cos(lonRad);
+	refObserver.Ny = -sin(latRad) * sin(lonRad);
+	refObserver.Uz = sin(latRad);
+	refObserver.Nz = cos(latRad);
+	refObserver.Ox = Rx * refObserver.Ux;
+	refObserver.Oy = Rx * refObserver.Uy;
+	refObserver.Oz = Rz * refObserver.Uz;
+	refObserver.VOx = -refObserver.Oy * REF_W0;
+	refObserver.VOy = refObserver.Ox * REF_W0;
+}
+
+// Previous satelliteCalculateForDateTimeSecs() model, in double precision
+static void refCalculate(const refKeps_t *keps, time_t_custom dateTimeSecs, refResults_t *results)
+{
+	int32_t DN = refDayFn(1970, 1, 1) + (int32_t)(dateTimeSecs / 86400U);
+	double TN = (dateTimeSecs % 86400U) / 86400.0;
+	double T = (DN - keps->DE) + (TN - keps->TE);
+	double DT = keps->DC * T / 2.0;
+	double KD = 1.0 + 4.0 * DT;
+	double KDP = 1.0 - 7.0 * DT;
+	double M = fmod(keps->MA + keps->MM * T * (1.0 - 3.0 * DT), 2.0 * M_PI);
+	double EA = M;
+	double C, S, DNOM, delta;
+
+	do
+	{
+		C = cos(EA);
+		S = sin(EA);
+		DNOM = 1.0 - keps->EC * C;
+		delta = (EA - keps->EC * S - M) / DNOM;
+		EA -= delta;
+	} while (fabs(delta) > 1.0E-12);
+
+	double A = keps->A0 * KD;
+	double B = keps->b0 * KD;
+	double Sx = A * (C - keps->EC);
+	double Vx = -A * S / DNOM * keps->N0;
+	double Sy = B * S;
+	double Vy = B * C / DNOM * keps->N0;
+
+	double AP = keps->WP + keps->WD * T * KDP;
+	double RAAN = keps->RA + keps->QD * T * KDP;
+	double CXx = cos(AP) * cos(RAAN) - sin(AP) * keps->CI * sin(RAAN);
+	double CXy = -sin(AP) * cos(RAAN) - cos(AP) * keps->CI * sin(RAAN);
+	double CYx = cos(AP) * sin(RAAN) + sin(AP) * keps->CI * cos(RAAN);
+	double CYy = -sin(AP) * sin(RAAN) + cos(AP) * keps->CI * cos(RAAN);
+	double CZx = sin(AP) * keps->SI;
+	double CZy = cos(AP) * keps->SI;
+
+	double SATx = Sx * CXx + Sy * CXy;
+	double VELx = Vx * CXx + Vy * CXy;
+	double SATy = Sx * CYx + Sy * CYy;
+	double VELy = Vx * CYx + Vy * CYy;
+	double SATz = Sx * CZx + Sy * CZy;
+	double VELz = Vx * CZx + Vy * CZy;
+
+	double GHAA = REF_G0 * M_PI / 180.0 + ((DN - refDayFn(REF_YG, 1, 0)) + TN) * REF_WE;
+	C = cos(-GHAA);
+	S = sin(-GHAA);
+	Sx = SATx * C - SATy * S;
+	Vx = VELx * C - VELy * S;
+	Sy = SATx * S + SATy * C;
+	Vy = VELx * S + VELy * C;
+
+	double Rx = Sx - refObserver.Ox;
+	double Ry = Sy - refObserver.Oy;
+	double Rz = SATz - refObserver.Oz;
+	double R = sqrt(Rx * Rx + Ry * Ry + Rz * Rz);
+
+	Rx /= R;
+	Ry /= R;
+	Rz /= R;
+
+	results->elevation = asin(Rx * refObserver.Ux + Ry * refObserver.Uy + Rz * refObserver.Uz) * 180.0 / M_PI;
+	results->azimuth = atan2(Rx * refObserver.Ex + Ry * refObserver.Ey, Rx * refObserver.Nx + Ry * refObserver.Ny + Rz * refObserver.Nz) * 180.0 / M_PI;
+	if (results->azimuth < 0.0)
+	{
+		results->azimuth += 360.0;
+	}
+
+	double rangeRate = (Vx - refObserver.VOx) * Rx + (Vy - refObserver.VOy) * Ry + VELz * Rz;
+	results->rxFreq = TEST_FREQ - (int)lround(rangeRate / 299792.0 * TEST_FREQ);
+}
+
+static void loadSatellites(void)
+{
+	for (uint32_t i = 0; i < NUM_TEST_SATELLITES; i++)
+	{
+		char line1[24 + 1];
+		char line2[56 + 1];
+		uint8_t kep1[12];
+		uint8_t kep2[28];
+		char name[8] = { 'T', 'E', 'S', 'T', (char)('A' + i), ' ', ' ', ' ' };
+
+		// Epoch 2024 day 105 to 106, TE, M2, then IN, RA, EC, WP, MA, MM, RV
+		snprintf(line1, sizeof(line1), "%02d%12.8f%10.8f", 24, 105.0 + ((randomNext() % 100000000U) / 1.0e8), ((randomNext() % 2000U) / 1.0e8));
+		snprintf(line2, sizeof(line2), "%8.4f%8.4f%07d%8.4f%8.4f%11.8f%5d ", ORBITS[i].inclination, randomAngle(), (int)lround(ORBITS[i].eccentricity * 1.0e7),
+				randomAngle(), randomAngle(), ORBITS[i].meanMotion, (int)(randomNext() % 99999U));
+
+		compressTleData(line1, kep1, sizeof(kep1));
+		compressTleData(line2, kep2, sizeof(kep2));
+
+		satelliteTLE2Native(name, kep1, kep2, &testSatellites[i]);
+		for (int f = 0; f < 3; f++)
+		{
+			testSatellites[i].freqs[f].rxFreq = TEST_FREQ;
+			testSatellites[i].freqs[f].txFreq = TEST_FREQ;
+		}
+
+		refSetElements(line1, line2, &refKeps[i]);
+	}
+
+	satelliteSetObserverLocation(OBSERVER_LAT, OBSERVER_LON, OBSERVER_HEIGHT);
+	refSetObserver(OBSERVER_LAT, OBSERVER_LON, OBSERVER_HEIGHT);
+}
+
+// Angle between the two antenna directions. The azimuth alone is meaningless close to the zenith.
+static double pointingError(const satelliteResults_t *results, const refResults_t *refResults)
+{
+	double el = results->elevation * M_PI / 180.0;
+	double az = results->azimuth * M_PI / 180.0;
+	double refEl = refResults->elevation * M_PI / 180.0;
+	double refAz = refResults->azimuth * M_PI / 180.0;
+	double cosAngle = (sin(el) * sin(refEl)) + (cos(el) * cos(refEl) * cos(az - refAz));
+
+	return (acos(fmin(cosAngle, 1.0)) * 180.0 / M_PI);
+}
+
+// The earth rotation is cached for the last calculated time, the very first calculation can't be a cache hit, even at 0 secs
+static void testEarthRotationCache(void)
+{
+	satelliteData_t satellite = testSatellites[0];
+	satelliteResults_t first;
+	satelliteResults_t again;
+
+	satelliteCalculateForDateTimeSecs(&satellite, 0, &first, SATELLITE_PREDICTION_LEVEL_TIME_EL_AND_AZ);
+
+	satellite = testSatellites[0];
+	satelliteCalculateForDateTimeSecs(&satellite, TEST_START_DATE_TIME, &again, SATELLITE_PREDICTION_LEVEL_TIME_EL_AND_AZ);
+
+	satellite = testSatellites[0];
+	satelliteCalculateForDateTimeSecs(&satellite, 0, &again, SATELLITE_PREDICTION_LEVEL_TIME_EL_AND_AZ);
+
+	printf("  first calculation at 0 secs: elevation %.3f, azimuth %.3f deg, calculated again: %.3f, %.3f deg\n",
+			first.elevation, first.azimuth, again.elevation, again.azimuth);
+	HOST_CHECK((first.elevation == again.elevation) && (first.azimuth == again.azimuth));
+}
+
+static void testAccuracy(void)
+{
+	double maxElevationError = 0.0;
+	double maxPointingError = 0.0;
+	int maxDopplerError = 0;
+	uint32_t visibleSamples = 0;
+
+	for (uint32_t i = 0; i < NUM_TEST_SATELLITES; i++)
+	{
+		double satelliteElevationError = 0.0;
+
+		for (time_t_custom t = TEST_START_DATE_TIME; t < (TEST_START_DATE_TIME + TEST_DURATION); t += TEST_TIME_STEP)
+		{
+			satelliteResults_t results;
+			refResults_t refResults;
+
+			satelliteCalculateForDateTimeSecs(&testSatellites[i], t, &results, SATELLITE_PREDICTION_LEVEL_FULL);
+			refCalculate(&refKeps[i], t, &refResults);
+
+			satelliteElevationError = fmax(satelliteElevationError, fabs(results.elevation - refResults.elevation));
+
+			// The pointing and the Doppler only matter while the satellite is visible
+			if (refResults.elevation > 0.0)
+			{
+				maxPointingError = fmax(maxPointingError, pointingError(&results, &refResults));
+				int dopplerError = abs((int)results.freqs[SATELLITE_VOICE_FREQ].rxFreq - refResults.rxFreq);
+
+				maxDopplerError = ((dopplerError > maxDopplerError) ? dopplerError : maxDopplerError);
+				visibleSamples++;
+			}
+		}
+
+		printf("  inclination %7.3f, eccentricity %.4f, %8.5f rev/day: elevation error %.3f deg\n",
+				ORBITS[i].inclination, ORBITS[i].eccentricity, ORBITS[i].meanMotion, satelliteElevationError);
+		maxElevationError = fmax(maxElevationError, satelliteElevationError);
+	}
+
+	printf("  %u days, every %u s: %u visible samples, errors vs double precision: elevation %.3f deg, pointing %.3f deg, Doppler %d Hz at %.1f MHz\n",
+			(TEST_DURATION / 86400U), TEST_TIME_STEP, visibleSamples, maxElevationError, maxPointingError, (maxDopplerError * 10), (TEST_FREQ / 100000.0));
+	HOST_CHECK(visibleSamples > 0);
+	HOST_CHECK(maxElevationError < 0.5);
+	HOST_CHECK(maxPointingError < 0.5);
+	HOST_CHECK(maxDopplerError < 15);// 150 Hz
+}
+
+// Next passes of a satellite within 24h, chained as menuSatelliteScreen.c does: each prediction starts 30 min after the previous LOS
+static uint32_t predictPasses(satelliteData_t *satellite, time_t_custom startDateTimeSecs, uint32_t *evaluations)
+{
+	predictionStateMachineData_t stateData;
+	time_t_custom limitDateTimeSecs = startDateTimeSecs + PASSES_DURATION;
+	uint32_t numPasses = 0;
+
+	memset(&satellite->predictions, 0, sizeof(satellite->predictions));
+
+	while (numPasses < NUM_SATELLITE_PREDICTIONS)
+	{
+		satellitePass_t *pass = &satellite->predictions.passes[numPasses];
+
+		stateData.state = PREDICTION_STATE_INIT_AOS;
+		while (satellitePredictNextPassFromDateTimeSecs(&stateData, satellite, startDateTimeSecs, limitDateTimeSecs, 500, pass))
+		{
+			if (stateData.state == PREDICTION_STATE_COMPLETE)
+			{
+				break;
+			}
+		}
+		*evaluations += stateData.totalIterations;
+
+		if (stateData.state != PREDICTION_STATE_COMPLETE)
+		{
+			break;
+		}
+
+		pass->valid = PREDICTION_RESULT_OK;
+		numPasses++;
+		startDateTimeSecs = pass->satelliteLOS + (30 * 60);
+	}
+
+	satellite->predictions.numPasses = numPasses;
+
+	return numPasses;
+}
+
+// Horizon crossing of a shared time grid sample, narrowed down to a second by bisection
+static time_t_custom batchRefineCrossing(satelliteData_t *satellite, time_t_custom before, time_t_custom after, bool isAOS, uint32_t *evaluations)
+{
+	while ((after - before) > 1)
+	{
+		satelliteResults_t results;
+		time_t_custom middle = before + ((after - before) / 2);
+
+		satelliteCalculateForDateTimeSecs(satellite, middle, &results, SATELLITE_PREDICTION_LEVEL_TIME_AND_ELEVATION_ONLY);
+		(*evaluations)++;
+
+		if (isAOS ? (results.elevation < 0.0f) : (results.elevation >= 0.0f))
+		{
+			before = middle;
+		}
+		else
+		{
+			after = middle;
+		}
+	}
+
+	return after;
+}
+
+// Batch alternative: all the satellites evaluated on a shared time grid, the earth rotation being computed once per sample.
+// Returns the number of passes found (the AOS and LOS are both within the duration)
+static uint32_t batchPredictPasses(time_t_custom startDateTimeSecs, uint32_t *evaluations)
+{
+	float previousElevation[NUM_TEST_SATELLITES];
+	time_t_custom aos[NUM_TEST_SATELLITES];
+	uint32_t numPasses = 0;
+
+	for (time_t_custom t = startDateTimeSecs; t <= (startDateTimeSecs + PASSES_DURATION); t += BATCH_TIME_STEP)
+	{
+		for (uint32_t i = 0; i < NUM_TEST_SATELLITES; i++)
+		{
+			satelliteResults_t results;
+
+			satelliteCalculateForDateTimeSecs(&testSatellites[i], t, &results, SATELLITE_PREDICTION_LEVEL_TIME_AND_ELEVATION_ONLY);
+			(*evaluations)++;
+
+			if (t == startDateTimeSecs)
+			{
+				aos[i] = 0;
+			}
+			else if ((previousElevation[i] < 0.0f) && (results.elevation >= 0.0f))
+			{
+				aos[i] = batchRefineCrossing(&testSatellites[i], t - BATCH_TIME_STEP, t, true, evaluations);
+			}
+			else if ((previousElevation[i] >= 0.0f) && (results.elevation < 0.0f) && (aos[i] != 0))
+			{
+				(void)batchRefineCrossing(&testSatellites[i], t - BATCH_TIME_STEP, t, false, evaluations);
+				numPasses++;
+			}
+
+			previousElevation[i] = results.elevation;
+		}
+	}
+
+	return numPasses;
+}
+
+// Predicted passes against a scan of every second, then the adaptive search (per satellite) timed against a shared time grid batch
+static void testPassPrediction(void)
+{
+	uint32_t numPasses = 0, numScannedPasses = 0, numLongPassesMissed = 0;
+	uint32_t maxTimeError = 0, maxElevationError = 0;
+	uint32_t evaluations = 0, batchEvaluations = 0, batchPasses = 0;
+	double start, rate, batchRate;
+
+	for (uint32_t i = 0; i < NUM_TEST_SATELLITES; i++)
+	{
+		uint32_t satellitePasses = predictPasses(&testSatellites[i], TEST_START_DATE_TIME, &evaluations);
+		uint32_t matched = 0;
+		time_t_custom aos = 0;
+		float maxElevation = 0.0f;
+		float previousElevation = 0.0f;
+
+		for (time_t_custom t = TEST_START_DATE_TIME; t < (TEST_START_DATE_TIME + PASSES_DURATION); t++)
+		{
+			satelliteResults_t results;
+
+			satelliteCalculateForDateTimeSecs(&testSatellites[i], t, &results, SATELLITE_PREDICTION_LEVEL_TIME_AND_ELEVATION_ONLY);
+
+			if ((t > TEST_START_DATE_TIME) && (previousElevation < 0.0f) && (results.elevation >= 0.0f))
+			{
+				aos = t;
+				maxElevation = results.elevation;
+			}
+			else if ((aos != 0) && (results.elevation >= 0.0f))
+			{
+				maxElevation = fmaxf(maxElevation, results.elevation);
+			}
+			else if ((aos != 0) && (results.elevation < 0.0f))
+			{
+				bool found = false;
+
+				numScannedPasses++;
+
+				// Every second of the pass is scanned, the nearest predicted one is matched
+				for (uint32_t p = 0; p < satellitePasses; p++)
+				{
+					satellitePass_t *pass = &testSatellites[i].predictions.passes[p];
+
+					if ((pass->satelliteAOS <= (t + 2)) && (pass->satelliteLOS >= (aos - 2)))
+					{
+						uint32_t aosError = abs((int)(pass->satelliteAOS - aos));
+						uint32_t losError = abs((int)(pass->satelliteLOS - t));
+						uint32_t elevationError = abs((int)satelliteGetMaximumElevation(&testSatellites[i], p) - (int)(maxElevation + 0.5f));
+
+						maxTimeError = ((aosError > maxTimeError) ? aosError : maxTimeError);
+						maxTimeError = ((losError > maxTimeError) ? losError : maxTimeError);
+						maxElevationError = ((elevationError > maxElevationError) ? elevationError : maxElevationError);
+						found = true;
+						matched++;
+						break;
+					}
+				}
+
+				// A pass starting within 30 min of the previous LOS isn't looked for
+				if ((found == false) && ((t - aos) >= SATELLITE_MIN_PASS_DURATION) &&
+						((matched == 0) || (aos > (testSatellites[i].predictions.passes[matched - 1].satelliteLOS + (30 * 60)))) &&
+						(matched < satellitePasses))
+				{
+					numLongPassesMissed++;
+				}
+
+				aos = 0;
+			}
+
+			previousElevation = results.elevation;
+		}
+
+		numPasses += satellitePasses;
+	}
+
+	start = hostSeconds();
+	for (uint32_t n = 0; n < PASSES_BENCHMARK_ROUNDS; n++)
+	{
+		uint32_t unused = 0;
+
+		for (uint32_t i = 0; i < NUM_TEST_SATELLITES; i++)
+		{
+			predictPasses(&testSatellites[i], TEST_START_DATE_TIME + (n * 3600U), &unused);
+		}
+	}
+	rate = PASSES_BENCHMARK_ROUNDS / (hostSeconds() - start);
+
+	start = hostSeconds();
+	for (uint32_t n = 0; n < PASSES_BENCHMARK_ROUNDS; n++)
+	{
+		uint32_t unused = 0;
+
+		batchPasses = batchPredictPasses(TEST_START_DATE_TIME + (n * 3600U), ((n == 0) ? &batchEvaluations : &unused));
+	}
+	batchRate = PASSES_BENCHMARK_ROUNDS / (hostSeconds() - start);
+
+	printf("  24h of passes: %u predicted (%u scanned), %u missed longer than %u s, AOS/LOS within %u s, maximum elevation within %u deg\n",
+			numPasses, numScannedPasses, numLongPassesMissed, SATELLITE_MIN_PASS_DURATION, maxTimeError, maxElevationError);
+	printf("  all satellites: %u evaluations and %.1f predictions/s per satellite, %u evaluations and %.1f predictions/s on a shared %u s grid (%u passes)\n",
+			evaluations, rate, batchEvaluations, batchRate, BATCH_TIME_STEP, batchPasses);
+	HOST_CHECK(numPasses > (NUM_TEST_SATELLITES * 2));
+	HOST_CHECK(numLongPassesMissed == 0);
+	HOST_CHECK(maxTimeError <= 2);
+	HOST_CHECK(maxElevationError <= 1);
+}
+
+static void benchmark(void)
+{
+	double start, refRate, rate;
+	double check = 0.0;
+
+	start = hostSeconds();
+	for (uint32_t n = 0; n < BENCHMARK_EVALUATIONS; n++)
+	{
+		refResults_t refResults;
+
+		refCalculate(&refKeps[n % NUM_TEST_SATELLITES], TEST_START_DATE_TIME + ((n / NUM_TEST_SATELLITES) * 16U), &refResults);
+		check += refResults.elevation;
+	}
+	refRate = BENCHMARK_EVALUATIONS / (hostSeconds() - start);
+
+	start = hostSeconds();
+	for (uint32_t n = 0; n < BENCHMARK_EVALUATIONS; n++)
+	{
+		satelliteResults_t results;
+
+		satelliteCalculateForDateTimeSecs(&testSatellites[n % NUM_TEST_SATELLITES], TEST_START_DATE_TIME + ((n / NUM_TEST_SATELLITES) * 16U), &results, SATELLITE_PREDICTION_LEVEL_FULL);
+		check -= results.elevation;
+	}
+	rate = BENCHMARK_EVALUATIONS / (hostSeconds() - start);
+
+	// No speed check: the host has a double precision FPU, the gain is on the target's single precision one
+	printf("  %.0f evaluations/s in double precision, %.0f evaluations/s in single precision [%u]\n", refRate, rate, ((fabs(check) < 1.0e6) ? 1U : 0U));
+}
+
+int main(void)
+{
+	printf("Satellite propagator\n");
+
+	loadSatellites();
+	testEarthRotationCache();
+	testAccuracy();
+	testPassPrediction();
+	benchmark();
+
+	if (hostCheckFailures() != 0)
+	{
+		printf("FAILED (%d)\n", hostCheckFailures());
+		return EXIT_FAILURE;
+	}
+
+	printf("OK\n");
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,452 @@
+/*
+ * Copyright (C) 2024 Roger Clark, VK3KYY / G4KYF
+ *                    Daniel Caujolle-Bert, F1RMB
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+ *    in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. Use of this source code or binary releases for commercial purposes is strictly forbidden. This includes, without limitation,
+ *    incorporation in a commercial product or incorporation into a product or project which allows commercial use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// Scan table (scanTableSetEntry(), scanTableFindNext(), scanTableSetNuisance()), as built by canCurrentZoneBeScanned() and
+// walked by scanSearchForNextChannel(), checked against the previous scan step kept below (skip bitmap, then the whole
+// channel record read, then the nuisance delete list), over a simulated 80 channels zone held in the Flash.
+// Both land on the same channels, then the scan steps are timed, and their storage accesses counted.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hardware/SPI_Flash.h"
+#include "functions/codeplug.h"
+#include "functions/settings.h"
+#include "functions/scanTable.h"
+#include "functions/trx.h"
+#include "user_interface/uiGlobals.h"
+#include "user_interface/uiLocalisation.h"
+#include "flashModel.h"
+
+#define ZONE_CHANNELS      80
+#define NUISANCE_MAX       16 // MAX_ZONE_SCAN_NUISANCE_CHANNELS
+#define CHECK_HOPS         2000
+#define BENCHMARK_HOPS     200000U
+
+static const stringsTable_t testLanguage = { .all_channels = "All Channels" };
+const stringsTable_t *currentLanguage = &testLanguage;
+struct_codeplugZone_t currentZone;
+settingsStruct_t nonVolatileSettings;
+
+static uint8_t eeprom[0x20000];
+static uint32_t randomState = 0x5CA77AB1;
+static struct_codeplugChannel_t channels[ZONE_CHANNELS];// What was written, in zone order
+static scanTableEntry_t table[SCAN_TABLE_SIZE];
+static int nuisanceDelete[NUISANCE_MAX];
+
+// Previous scan state
+static uint8_t refSkipCache[(CODEPLUG_CHANNELS_MAX + 7) / 8];
+static struct_codeplugChannel_t refNextChannelData;
+#define REF_SKIP_CACHE_SET(n)        (refSkipCache[(n) / 8] |= (1 << ((n) % 8)))
+#define REF_SKIP_CACHE_IS_SET(n)     ((refSkipCache[(n) / 8] & (1 << ((n) % 8))) != 0)
+
+
+static uint32_t randomNext(void)
+{
+	randomState ^= (randomState << 13);
+	randomState ^= (randomState >> 17);
+	randomState ^= (randomState << 5);
+
+	return randomState;
+}
+
+bool EEPROM_Read(int address, uint8_t *buf, int size)
+{
+	memcpy(buf, &eeprom[address], size);
+	return true;
+}
+
+bool EEPROM_Write(int address, uint8_t *buf, int size)
+{
+	memcpy(&eeprom[address], buf, size);
+	return true;
+}
+
+// Previous canCurrentZoneBeScanned(), for a regular zone: flag4 of each channel
+static int refCanCurrentZoneBeScanned(void)
+{
+	int enabledChannels = 0;
+
+	memset(refSkipCache, 0x00, sizeof(refSkipCache));
+
+	for (int i = 0; i < currentZone.NOT_IN_CODEPLUGDATA_numChannelsInZone; i++)
+	{
+		// Get flag4 only
+		codeplugChannelGetDataWithOffsetAndLengthForIndex(currentZone.channels[i], &refNextChannelData, CODEPLUG_CHANNEL_FLAG4_OFFSET, 1);
+
+		if (codeplugChannelGetFlag(&refNextChannelData, CHANNEL_FLAG_ZONE_SKIP) == 0)
+		{
+			enabledChannels++;
+		}
+		else
+		{
+			REF_SKIP_CACHE_SET(i);
+		}
+	}
+
+	return enabledChannels;
+}
+
+// Previous scanSearchForNextChannel(), for a regular zone: returns false when the channel is nuisance deleted,
+// the next call goes on from it
+static bool refSearchForNextChannel(int *index, int direction)
+{
+	int hops = currentZone.NOT_IN_CODEPLUGDATA_numChannelsInZone;
+	int channel;
+
+	do
+	{
+		*index = ((direction == 1) ?
+				((*index + 1) % currentZone.NOT_IN_CODEPLUGDATA_numChannelsInZone) :
+				((*index + currentZone.NOT_IN_CODEPLUGDATA_numChannelsInZone - 1) % currentZone.NOT_IN_CODEPLUGDATA_numChannelsInZone));
+	} while (REF_SKIP_CACHE_IS_SET(*index) && (--hops > 0));
+
+	channel = currentZone.channels[*index];
+	codeplugChannelGetDataForIndex(currentZone.channels[*index], &refNextChannelData);
+
+	for (int i = 0; i < NUISANCE_MAX; i++)
+	{
+		if (nuisanceDelete[i] == -1)
+		{
+			break;
+		}
+		else
+		{
+			if (nuisanceDelete[i] == channel)
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+// canCurrentZoneBeScanned(), for a regular zone
+static int buildTable(void)
+{
+	struct_codeplugChannel_t channel;
+	int enabledChannels = 0;
+
+	for (int i = 0; i < currentZone.NOT_IN_CODEPLUGDATA_numChannelsInZone; i++)
+	{
+		codeplugChannelGetDataForIndex(currentZone.channels[i], &channel);
+		scanTableSetEntry(&table[i], currentZone.channels[i], &channel, (codeplugChannelGetFlag(&channel, CHANNEL_FLAG_ZONE_SKIP) != 0));
+
+		if ((table[i].flags & SCAN_TABLE_FLAG_SKIP) == 0)
+		{
+			enabledChannels++;
+		}
+	}
+
+	for (int i = 0; (i < NUISANCE_MAX) && (nuisanceDelete[i] != -1); i++)
+	{
+		scanTableSetNuisance(table, currentZone.NOT_IN_CODEPLUGDATA_numChannelsInZone, nuisanceDelete[i]);
+	}
+
+	return enabledChannels;
+}
+
+// Random channels spread over the Flash banks, 'skipPercent' of them skipped
+static void buildZone(int skipPercent)
+{
+	bool used[CODEPLUG_CHANNELS_MAX + 1] = { false };
+
+	SPI_Flash_read(0, SPI_Flash_sectorbuffer, 1);
+	flashModelInit(0xFF);
+	memset(eeprom, 0xFF, sizeof(eeprom));
+	HOST_CHECK(SPI_Flash_init());
+
+	memset(&currentZone, 0, sizeof(currentZone));
+	currentZone.NOT_IN_CODEPLUGDATA_numChannelsInZone = currentZone.NOT_IN_CODEPLUGDATA_highestIndex = ZONE_CHANNELS;
+
+	for (int i = 0; i < ZONE_CHANNELS; i++)
+	{
+		struct_codeplugChannel_t *channel = &channels[i];
+		int index;
+
+		do
+		{
+			index = (129 + (randomNext() % (CODEPLUG_CHANNELS_MAX - 128)));// Flash only
+		} while (used[index]);
+		used[index] = true;
+		currentZone.channels[i] = index;
+
+		memset(channel, 0, sizeof(struct_codeplugChannel_t));
+		snprintf(channel->name, sizeof(channel->name), "CH%d", index);
+		channel->chMode = (((randomNext() % 2) == 0) ? RADIO_MODE_ANALOG : RADIO_MODE_DIGITAL);
+		channel->rxFreq = (14400000 + ((randomNext() % 160) * 1250));
+		channel->txFreq = (((randomNext() % 3) == 0) ? (channel->rxFreq + 60000) : channel->rxFreq);
+		channel->rxTone = (((randomNext() % 3) == 0) ? 885 : CODEPLUG_CSS_TONE_NONE);
+		channel->txTone = channel->rxTone;
+		channel->txColor = (randomNext() % 16);
+		channel->aprsConfigIndex = (((randomNext() % 10) == 0) ? 1 : 0);
+		channel->sql = (randomNext() % 22);
+		codeplugChannelSetFlag(channel, CHANNEL_FLAG_TIMESLOT_TWO, (randomNext() % 2));
+		codeplugChannelSetFlag(channel, CHANNEL_FLAG_BW_25K, (randomNext() % 2));
+		codeplugChannelSetFlag(channel, CHANNEL_FLAG_FORCE_DMO, (((randomNext() % 8) == 0) ? 1 : 0));
+		codeplugChannelSetFlag(channel, CHANNEL_FLAG_ZONE_SKIP, (((int)(randomNext() % 100) < skipPercent) ? 1 : 0));
+
+		HOST_CHECK(codeplugChannelSaveDataForIndex(index, channel));
+	}
+
+	// Keep two channels to scan
+	codeplugChannelSetFlag(&channels[0], CHANNEL_FLAG_ZONE_SKIP, 0);
+	HOST_CHECK(codeplugChannelSaveDataForIndex(currentZone.channels[0], &channels[0]));
+	codeplugChannelSetFlag(&channels[ZONE_CHANNELS / 2], CHANNEL_FLAG_ZONE_SKIP, 0);
+	HOST_CHECK(codeplugChannelSaveDataForIndex(currentZone.channels[ZONE_CHANNELS / 2], &channels[ZONE_CHANNELS / 2]));
+
+	HOST_CHECK(SPI_Flash_flush());
+
+	for (int i = 0; i < NUISANCE_MAX; i++)
+	{
+		nuisanceDelete[i] = -1;
+	}
+}
+
+// What the receiver is set to on a hop
+static void checkEntries(void)
+{
+	for (int i = 0; i < ZONE_CHANNELS; i++)
+	{
+		struct_codeplugChannel_t *channel = &channels[i];
+		scanTableEntry_t *entry = &table[i];
+		bool dmo = ((channel->rxFreq == channel->txFreq) || (codeplugChannelGetFlag(channel, CHANNEL_FLAG_FORCE_DMO) != 0));
+
+		HOST_CHECK(entry->index == currentZone.channels[i]);
+		HOST_CHECK(entry->rxFreq == channel->rxFreq);
+		HOST_CHECK(entry->rxTone == (((channel->chMode == RADIO_MODE_ANALOG) && (channel->aprsConfigIndex != 0)) ? CODEPLUG_CSS_TONE_NONE : channel->rxTone));
+		HOST_CHECK(entry->chMode == channel->chMode);
+		HOST_CHECK(entry->colourCode == channel->txColor);
+		HOST_CHECK(entry->sql == ((channel->sql > 21) ? 10 : channel->sql));
+		HOST_CHECK(((entry->flags & SCAN_TABLE_FLAG_SKIP) != 0) == (codeplugChannelGetFlag(channel, CHANNEL_FLAG_ZONE_SKIP) != 0));
+		HOST_CHECK(((entry->flags & SCAN_TABLE_FLAG_BW_25K) != 0) == (codeplugChannelGetFlag(channel, CHANNEL_FLAG_BW_25K) != 0));
+		HOST_CHECK(((entry->flags & SCAN_TABLE_FLAG_TIMESLOT_TWO) != 0) == (codeplugChannelGetFlag(channel, CHANNEL_FLAG_TIMESLOT_TWO) != 0));
+		HOST_CHECK(((entry->flags & SCAN_TABLE_FLAG_DMO) != 0) == dmo);
+	}
+}
+
+// Both scans from the same channel, with direction changes and nuisance deletes along the way
+static void testZone(int skipPercent)
+{
+	int refIndex = 0;
+	int position = 0;
+	int nuisanceIndex = 0;
+	int direction = 1;
+	int mismatches = 0;
+	int refEnabled;
+	int enabled;
+
+	buildZone(skipPercent);
+	refEnabled = refCanCurrentZoneBeScanned();
+	enabled = buildTable();
+	HOST_CHECK(enabled == refEnabled);
+	checkEntries();
+
+	for (int hop = 0; hop < CHECK_HOPS; hop++)
+	{
+		int hops = 0;
+
+		// The previous search went on at each tick, until a channel wasn't nuisance deleted
+		while ((refSearchForNextChannel(&refIndex, direction) == false) && (++hops < ZONE_CHANNELS))
+		{
+		}
+
+		position = scanTableFindNext(table, ZONE_CHANNELS, position, direction, true);
+
+		if (position != refIndex)
+		{
+			mismatches++;
+			position = refIndex;
+		}
+
+		if ((randomNext() % 16) == 0)
+		{
+			direction = -direction;
+		}
+
+		// Delete the landed channel, while two of them remain
+		if (((randomNext() % 64) == 0) && (nuisanceIndex < NUISANCE_MAX) && (nuisanceIndex < (enabled - 2)))
+		{
+			nuisanceDelete[nuisanceIndex++] = currentZone.channels[refIndex];
+			scanTableSetNuisance(table, ZONE_CHANNELS, currentZone.channels[refIndex]);
+		}
+	}
+
+	// A rebuilt table keeps the nuisance deleted channels
+	if (nuisanceIndex > 0)
+	{
+		buildTable();
+		HOST_CHECK((table[scanTableFindIndex(table, ZONE_CHANNELS, nuisanceDelete[0])].flags & SCAN_TABLE_FLAG_NUISANCE) != 0);
+	}
+
+	HOST_CHECK(mismatches == 0);
+	printf("  %2d%% skipped: %2d channels to scan, %d nuisance deleted, %d hops, %d mismatches\n", skipPercent, enabled, nuisanceIndex, CHECK_HOPS, mismatches);
+}
+
+// Windows of the All Channels zone: walking them without wrap, one window after the other, is a walk around the zone
+static void testWindows(void)
+{
+	static scanTableEntry_t zone[CODEPLUG_CHANNELS_MAX];
+	int count = 300;
+	int mismatches = 0;
+
+	for (int i = 0; i < count; i++)
+	{
+		zone[i].index = (i + 1);
+		zone[i].flags = ((((randomNext() % 100) < 60) && ((i % 97) != 0)) ? SCAN_TABLE_FLAG_SKIP : 0);
+	}
+	zone[count / 2].flags = SCAN_TABLE_FLAG_NUISANCE;
+
+	for (int direction = -1; direction <= 1; direction += 2)
+	{
+		int refPosition = 0;
+		int windowStart = 0;// Zone position of table[0]
+		int position = 0;
+
+		memcpy(table, &zone[windowStart], (SCAN_TABLE_SIZE * sizeof(scanTableEntry_t)));
+
+		for (int hop = 0; hop < 500; hop++)
+		{
+			int fills = ((count + SCAN_TABLE_SIZE - 1) / SCAN_TABLE_SIZE);
+
+			do
+			{
+				refPosition = (((refPosition + direction) + count) % count);
+			} while (zone[refPosition].flags & (SCAN_TABLE_FLAG_SKIP | SCAN_TABLE_FLAG_NUISANCE));
+
+			while (((position = scanTableFindNext(table, SCAN_TABLE_SIZE, position, direction, false)) == -1) && (fills-- > 0))
+			{
+				windowStart = (((windowStart + (direction * SCAN_TABLE_SIZE)) + count) % count);
+
+				for (int i = 0; i < SCAN_TABLE_SIZE; i++)
+				{
+					table[i] = zone[(windowStart + i) % count];
+				}
+
+				position = ((direction == 1) ? -1 : SCAN_TABLE_SIZE);
+			}
+
+			if ((position == -1) || (table[position].index != zone[refPosition].index))
+			{
+				mismatches++;
+				break;
+			}
+		}
+	}
+
+	HOST_CHECK(mismatches == 0);
+	printf("  %d channels through %d entries windows, both directions: %d mismatches\n", count, SCAN_TABLE_SIZE, mismatches);
+}
+
+static void benchmark(void)
+{
+	int refIndex = 0;
+	int position = 0;
+	uint32_t check = 0;
+	uint64_t refClocks;
+	uint64_t clocks;
+	uint32_t refTransactions;
+	uint32_t transactions;
+	uint32_t refBuildTransactions;
+	uint32_t buildTransactions;
+	uint64_t refBuildClocks;
+	uint64_t buildClocks;
+	double start;
+	double refRate;
+	double rate;
+
+	buildZone(25);
+
+	flashModelResetStats();
+	hostCycles = 0;
+	refCanCurrentZoneBeScanned();
+	refBuildTransactions = flashModelStats.transactions;
+	refBuildClocks = hostCycles;
+
+	flashModelResetStats();
+	hostCycles = 0;
+	buildTable();
+	buildTransactions = flashModelStats.transactions;
+	buildClocks = hostCycles;
+
+	flashModelResetStats();
+	hostCycles = 0;
+	start = hostSeconds();
+	for (uint32_t hop = 0; hop < BENCHMARK_HOPS; hop++)
+	{
+		refSearchForNextChannel(&refIndex, 1);
+		check += refIndex;
+	}
+	refRate = (BENCHMARK_HOPS / (hostSeconds() - start));
+	refTransactions = flashModelStats.transactions;
+	refClocks = hostCycles;
+
+	flashModelResetStats();
+	hostCycles = 0;
+	start = hostSeconds();
+	for (uint32_t hop = 0; hop < BENCHMARK_HOPS; hop++)
+	{
+		position = scanTableFindNext(table, ZONE_CHANNELS, position, 1, true);
+		check += position;
+	}
+	rate = (BENCHMARK_HOPS / (hostSeconds() - start));
+	transactions = flashModelStats.transactions;
+	clocks = hostCycles;
+
+	printf("  zone of %d channels, next channel: %.0f channels/s previously, %.0f channels/s now (x%.1f) [%u]\n", ZONE_CHANNELS, refRate, rate,
+			(rate / refRate), (check & 0x01));
+	printf("  per hop: %.2f transactions and %.0f SPI clocks previously, %.2f and %.0f now\n",
+			((double)refTransactions / BENCHMARK_HOPS), ((double)refClocks / BENCHMARK_HOPS), ((double)transactions / BENCHMARK_HOPS), ((double)clocks / BENCHMARK_HOPS));
+	printf("  scan start: %u transactions and %llu SPI clocks previously, %u and %llu now\n",
+			refBuildTransactions, (unsigned long long)refBuildClocks, buildTransactions, (unsigned long long)buildClocks);
+
+	HOST_CHECK(transactions == 0);
+	HOST_CHECK(buildTransactions == refBuildTransactions);
+	HOST_CHECK(rate > refRate);
+}
+
+int main(void)
+{
+	printf("Scan table\n");
+
+	testZone(0);
+	testZone(25);
+	testZone(90);
+	testWindows();
+	benchmark();
+
+	if (hostCheckFailures() != 0)
+	{
+		printf("FAILED (%d)\n", hostCheckFailures());
+		return EXIT_FAILURE;
+	}
+
+	printf("OK\n");
+	return EXIT_SUCCESS;
+}
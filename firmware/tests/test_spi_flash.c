@@ -0,0 +1,275 @@
+/*
+ * Copyright (C) 2024 Roger Clark, VK3KYY / G4KYF
+ *                    Daniel Caujolle-Bert, F1RMB
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+ *    in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. Use of this source code or binary releases for commercial purposes is strictly forbidden. This includes, without limitation,
+ *    incorporation in a commercial product or incorporation into a product or project which allows commercial use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// SPI_Flash.c write-back sector cache, against the simulated NOR flash:
+// data integrity, erase count and bytes programmed.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hardware/SPI_Flash.h"
+#include "flashModel.h"
+
+#define TEST_AREA_START   0x10000U
+#define TEST_AREA_SECTORS 8U
+#define TEST_AREA_SIZE    (TEST_AREA_SECTORS * FLASH_MODEL_SECTOR_SIZE)
+
+static uint8_t shadow[FLASH_MODEL_SIZE];
+static uint32_t randomState = 0x12345678;
+static uint32_t naiveErases;
+static uint64_t naiveBytesProgrammed;
+
+
+static uint32_t randomNext(void)
+{
+	randomState ^= (randomState << 13);
+	randomState ^= (randomState >> 17);
+	randomState ^= (randomState << 5);
+
+	return randomState;
+}
+
+static void randomFill(uint8_t *buf, int size)
+{
+	for (int i = 0; i < size; i++)
+	{
+		buf[i] = randomNext();
+	}
+}
+
+// Previous implementation: one erase and 16 page programs for each sector touched by each write
+static void accountNaiveWrite(uint32_t addr, int size)
+{
+	uint32_t first = (addr / FLASH_MODEL_SECTOR_SIZE);
+	uint32_t last = ((addr + size - 1) / FLASH_MODEL_SECTOR_SIZE);
+
+	naiveErases += ((last - first) + 1);
+	naiveBytesProgrammed += (((last - first) + 1) * FLASH_MODEL_SECTOR_SIZE);
+}
+
+static void write(uint32_t addr, uint8_t *buf, int size)
+{
+	HOST_CHECK(SPI_Flash_write(addr, buf, size));
+	memcpy(&shadow[addr], buf, size);
+	accountNaiveWrite(addr, size);
+}
+
+static void checkRead(uint32_t addr, int size)
+{
+	static uint8_t buf[FLASH_MODEL_SECTOR_SIZE * 2];
+
+	memset(buf, 0x5A, size);
+	HOST_CHECK(SPI_Flash_read(addr, buf, size));
+	HOST_CHECK(memcmp(buf, &shadow[addr], size) == 0);
+}
+
+// Raw page writes legitimately program over non erased data, the cache never should
+static void checkFlashContent(const char *step, bool rawPageWrites)
+{
+	HOST_CHECK(SPI_Flash_flush());
+	HOST_CHECK(flashModelIsIdle());
+
+	if (memcmp(flashModelMemory, shadow, FLASH_MODEL_SIZE) != 0)
+	{
+		fprintf(stderr, "%s: flash content mismatch\n", step);
+		HOST_CHECK(false);
+	}
+
+	HOST_CHECK(rawPageWrites || (flashModelStats.programWithoutErase == 0));
+	HOST_CHECK(flashModelStats.protocolErrors == 0);
+}
+
+static void setup(uint8_t fill)
+{
+	// The content is about to change behind the cache back: reading into the sector buffer drops the cached sector
+	SPI_Flash_read(0, SPI_Flash_sectorbuffer, 1);
+
+	flashModelInit(fill);
+	randomFill(&flashModelMemory[TEST_AREA_START], TEST_AREA_SIZE);
+	memcpy(shadow, flashModelMemory, FLASH_MODEL_SIZE);
+	HOST_CHECK(SPI_Flash_init());
+	flashModelResetStats();
+	naiveErases = 0;
+	naiveBytesProgrammed = 0;
+}
+
+static void testRead(void)
+{
+	setup(0xFF);
+
+	for (int i = 0; i < 200; i++)
+	{
+		checkRead(TEST_AREA_START + (randomNext() % (TEST_AREA_SIZE - 4096)), 1 + (randomNext() % 4096));
+	}
+
+	HOST_CHECK(flashModelStats.sectorErases == 0);
+	HOST_CHECK(flashModelStats.pagePrograms == 0);
+}
+
+// Codeplug style single byte updates (e.g. codeplugAllChannelsIndexSetUsed()) all land in one erase
+static void testCoalescedSmallWrites(void)
+{
+	setup(0xFF);
+
+	for (int i = 0; i < 200; i++)
+	{
+		uint8_t value = randomNext();
+
+		write(TEST_AREA_START + (randomNext() % FLASH_MODEL_SECTOR_SIZE), &value, 1);
+	}
+
+	checkRead(TEST_AREA_START, FLASH_MODEL_SECTOR_SIZE);
+	checkFlashContent("coalesced", false);
+	HOST_CHECK(flashModelStats.sectorErases == 1);
+
+	printf("  200 single byte writes: %u erase(s), %u bytes programmed (previously %u erases, %llu bytes)\n",
+			flashModelStats.sectorErases, flashModelStats.bytesProgrammed, naiveErases, (unsigned long long)naiveBytesProgrammed);
+}
+
+static void testUnchangedAndBitClearingWrites(void)
+{
+	uint8_t buf[300];
+
+	setup(0xFF);
+
+	// Same data: nothing is written at all
+	memcpy(buf, &shadow[TEST_AREA_START + 1000], sizeof(buf));
+	write(TEST_AREA_START + 1000, buf, sizeof(buf));
+	checkFlashContent("unchanged", false);
+	HOST_CHECK(flashModelStats.sectorErases == 0);
+	HOST_CHECK(flashModelStats.pagePrograms == 0);
+
+	// Erased area: only the two touched pages are programmed, without erase
+	memset(&flashModelMemory[TEST_AREA_START + FLASH_MODEL_SECTOR_SIZE], 0xFF, FLASH_MODEL_SECTOR_SIZE);
+	memset(&shadow[TEST_AREA_START + FLASH_MODEL_SECTOR_SIZE], 0xFF, FLASH_MODEL_SECTOR_SIZE);
+	randomFill(buf, sizeof(buf));
+	write(TEST_AREA_START + FLASH_MODEL_SECTOR_SIZE + 200, buf, sizeof(buf));
+	checkFlashContent("bit clearing", false);
+	HOST_CHECK(flashModelStats.sectorErases == 0);
+	HOST_CHECK(flashModelStats.pagePrograms == 2);
+}
+
+static void testIdleFlush(void)
+{
+	uint8_t buf[16];
+
+	setup(0xFF);
+
+	randomFill(buf, sizeof(buf));
+	write(TEST_AREA_START + 10, buf, sizeof(buf));
+
+	SPI_Flash_flushIfNeeded(false);
+	HOST_CHECK(flashModelStats.pagePrograms == 0);
+	checkRead(TEST_AREA_START, 64);// Served from the cache
+
+	hostMillis += 2000;
+	SPI_Flash_flushIfNeeded(false);
+	HOST_CHECK(flashModelStats.pagePrograms > 0);
+	HOST_CHECK(memcmp(&flashModelMemory[TEST_AREA_START], &shadow[TEST_AREA_START], FLASH_MODEL_SECTOR_SIZE) == 0);
+}
+
+// Random mix of cached writes, reads, raw page writes and erases
+static void testRandomOperations(void)
+{
+	static uint8_t buf[FLASH_MODEL_SECTOR_SIZE];
+	int operations = 20000;
+
+	setup(0xFF);
+	hostResetCriticalStats();
+
+	for (int i = 0; i < operations; i++)
+	{
+		uint32_t op = (randomNext() % 100);
+		uint32_t addr = (TEST_AREA_START + (randomNext() % (TEST_AREA_SIZE - FLASH_MODEL_SECTOR_SIZE)));
+		int size = (1 + (randomNext() % 64));
+
+		if (op < 55)
+		{
+			randomFill(buf, size);
+			write(addr, buf, size);
+		}
+		else if (op < 60)
+		{
+			// Whole sector overwrite, its previous content doesn't need to be read
+			addr &= ~(FLASH_MODEL_SECTOR_SIZE - 1);
+			randomFill(buf, FLASH_MODEL_SECTOR_SIZE);
+			write(addr, buf, FLASH_MODEL_SECTOR_SIZE);
+		}
+		else if (op < 90)
+		{
+			checkRead(addr, ((op & 1) ? size : (1 + (randomNext() % FLASH_MODEL_SECTOR_SIZE))));
+		}
+		else if (op < 94)
+		{
+			HOST_CHECK(SPI_Flash_flush());
+		}
+		else if (op < 97)
+		{
+			addr &= ~(FLASH_MODEL_PAGE_SIZE - 1);
+			randomFill(buf, FLASH_MODEL_PAGE_SIZE);
+			HOST_CHECK(SPI_Flash_writePage(addr, buf));
+			for (int j = 0; j < FLASH_MODEL_PAGE_SIZE; j++)
+			{
+				shadow[addr + j] &= buf[j];
+			}
+		}
+		else
+		{
+			addr &= ~(FLASH_MODEL_SECTOR_SIZE - 1);
+			HOST_CHECK(SPI_Flash_eraseSector(addr));
+			memset(&shadow[addr], 0xFF, FLASH_MODEL_SECTOR_SIZE);
+		}
+	}
+
+	checkFlashContent("random", true);
+
+	printf("  %d random operations: %u erases (max %u on one sector), %u bytes programmed (previously %u erases, %llu bytes)\n",
+			operations, flashModelStats.sectorErases, flashModelStats.maxSectorErases, flashModelStats.bytesProgrammed,
+			naiveErases, (unsigned long long)naiveBytesProgrammed);
+	printf("  longest interrupts masked window: %llu SPI clocks\n", (unsigned long long)hostCriticalMaxCycles);
+}
+
+int main(void)
+{
+	printf("SPI flash write-back cache\n");
+
+	testRead();
+	testCoalescedSmallWrites();
+	testUnchangedAndBitClearingWrites();
+	testIdleFlush();
+	testRandomOperations();
+
+	if (hostCheckFailures() != 0)
+	{
+		printf("FAILED (%d)\n", hostCheckFailures());
+		return EXIT_FAILURE;
+	}
+
+	printf("OK\n");
+	return EXIT_SUCCESS;
+}
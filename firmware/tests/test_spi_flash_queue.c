@@ -0,0 +1,306 @@
+/*
+ * Copyright (C) 2024 Roger Clark, VK3KYY / G4KYF
+ *                    Daniel Caujolle-Bert, F1RMB
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+ *    in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. Use of this source code or binary releases for commercial purposes is strictly forbidden. This includes, without limitation,
+ *    incorporation in a commercial product or incorporation into a product or project which allows commercial use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// SPI_Flash.c prioritised read queue, against the simulated NOR flash: higher priority reads queued by another task
+// while a large read is in progress, completion callbacks/notifications, cancellation and GPIO activity from ISRs.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hardware/SPI_Flash.h"
+#include "flashModel.h"
+
+#define TEST_AREA_START  0x20000U
+#define TEST_AREA_SIZE   0x40000U
+#define CHUNK_CLOCKS     (32U * 8U) // One READ_CHUNK_SIZE chunk
+#define COMMAND_CLOCKS   (4U * 8U)
+#define ISR_PIN          10U // Another peripheral on the same port
+
+typedef struct
+{
+	spiFlashReadRequest_t request;
+	uint8_t               data[4096];
+	uint64_t              queuedCycles;
+	uint64_t              completedCycles;
+	int                   callbacks;
+	int                   order;
+} testRead_t;
+
+static uint32_t randomState = 0x87654321;
+static uint8_t bulkBuffer[TEST_AREA_SIZE];
+static testRead_t reads[4];
+static int completions;
+static int readsToQueue;
+static uint64_t queueAtCycles;// From the start of the test
+static uint64_t startCycles;
+static int task;
+static uint32_t isrCount;
+static bool syncReadResult;
+
+
+static uint32_t randomNext(void)
+{
+	randomState ^= (randomState << 13);
+	randomState ^= (randomState >> 17);
+	randomState ^= (randomState << 5);
+
+	return randomState;
+}
+
+static void readCompleted(spiFlashReadRequest_t *request)
+{
+	testRead_t *read = (testRead_t *)request->userData;
+
+	read->completedCycles = hostCycles;
+	read->callbacks++;
+	read->order = completions++;
+}
+
+static void prepareRead(testRead_t *read, uint32_t addr, int size, spiFlashPriority_t priority)
+{
+	memset(read->data, 0x5A, sizeof(read->data));
+	memset(&read->request, 0, sizeof(read->request));
+	read->request.address = addr;
+	read->request.buffer = read->data;
+	read->request.size = size;
+	read->request.priority = priority;
+	read->request.callback = readCompleted;
+	read->request.notifyTask = &task;
+	read->request.userData = read;
+	read->callbacks = 0;
+	read->order = -1;
+}
+
+static bool readIsValid(testRead_t *read)
+{
+	return ((read->request.state == SPI_FLASH_REQUEST_COMPLETED) && (read->callbacks == 1) &&
+			(memcmp(read->data, &flashModelMemory[read->request.address], read->request.size) == 0));
+}
+
+// Higher priority task, woken up while the flash is held by the bulk read
+static void queueReads(void)
+{
+	if ((readsToQueue > 0) && ((hostCycles - startCycles) >= queueAtCycles))
+	{
+		for (int i = 0; i < readsToQueue; i++)
+		{
+			reads[i].queuedCycles = hostCycles;
+			HOST_CHECK(SPI_Flash_readAsync(&reads[i].request));
+			HOST_CHECK(reads[i].request.state == SPI_FLASH_REQUEST_PENDING);// The flash is busy
+		}
+		readsToQueue = 0;
+	}
+}
+
+// ISR driving another pin of the flash GPIO port
+static void isrToggle(void)
+{
+	if (isrCount++ & 1)
+	{
+		hostGpioAccess()->PCOR = (1U << ISR_PIN);
+	}
+	else
+	{
+		hostGpioAccess()->PSOR = (1U << ISR_PIN);
+	}
+}
+
+static void setup(void)
+{
+	flashModelInit(0xFF);
+	for (uint32_t i = TEST_AREA_START; i < (TEST_AREA_START + TEST_AREA_SIZE); i++)
+	{
+		flashModelMemory[i] = randomNext();
+	}
+	HOST_CHECK(SPI_Flash_init());
+	flashModelResetStats();
+	hostResetCriticalStats();
+	hostPreemptionHook = NULL;
+	hostInterruptHook = NULL;
+	hostNotifications = 0;
+	completions = 0;
+	readsToQueue = 0;
+	startCycles = hostCycles;
+}
+
+static void bulkRead(int size)
+{
+	memset(bulkBuffer, 0x5A, size);
+	HOST_CHECK(SPI_Flash_readWithPriority(TEST_AREA_START, bulkBuffer, size, SPI_FLASH_PRIORITY_BULK));
+	HOST_CHECK(memcmp(bulkBuffer, &flashModelMemory[TEST_AREA_START], size) == 0);
+}
+
+// A voice prompt read, queued during a CPS read, only waits for the current chunk
+static void testVoiceLatency(void)
+{
+	uint64_t latency;
+	uint64_t bound;
+
+	setup();
+	prepareRead(&reads[0], TEST_AREA_START + 0x31000, 2052, SPI_FLASH_PRIORITY_VOICE);
+	readsToQueue = 1;
+	queueAtCycles = (TEST_AREA_SIZE * 8U) / 3U;
+	hostPreemptionHook = queueReads;
+
+	bulkRead(TEST_AREA_SIZE);
+
+	HOST_CHECK(readIsValid(&reads[0]));
+	HOST_CHECK(hostNotifications == 1);
+	HOST_CHECK(flashModelIsIdle());
+	HOST_CHECK(flashModelStats.protocolErrors == 0);
+
+	latency = (reads[0].completedCycles - reads[0].queuedCycles);
+	bound = ((reads[0].request.size * 8U) + COMMAND_CLOCKS + CHUNK_CLOCKS + COMMAND_CLOCKS);
+	HOST_CHECK(latency <= bound);
+
+	printf("  voice read queued during a %u bytes bulk read: completed after %llu SPI clocks (%u for the read itself, previously up to %u)\n",
+			TEST_AREA_SIZE, (unsigned long long)latency, (reads[0].request.size * 8U) + COMMAND_CLOCKS, (TEST_AREA_SIZE + reads[0].request.size) * 8U);
+	printf("  longest interrupts masked window: %llu SPI clocks\n", (unsigned long long)hostCriticalMaxCycles);
+}
+
+// Highest priority first, FIFO within a priority, the interrupted bulk read resuming before the one queued after it
+static void testPriorityOrder(void)
+{
+	setup();
+	prepareRead(&reads[0], TEST_AREA_START + 0x1000, 4096, SPI_FLASH_PRIORITY_BULK);
+	prepareRead(&reads[1], TEST_AREA_START + 0x2345, 100, SPI_FLASH_PRIORITY_UI);
+	prepareRead(&reads[2], TEST_AREA_START + 0x3000, 1000, SPI_FLASH_PRIORITY_VOICE);
+	prepareRead(&reads[3], TEST_AREA_START + 0x4567, 33, SPI_FLASH_PRIORITY_UI);
+	readsToQueue = 4;
+	queueAtCycles = 10000;
+	hostPreemptionHook = queueReads;
+
+	bulkRead(0x8000);
+
+	for (int i = 0; i < 4; i++)
+	{
+		HOST_CHECK(readIsValid(&reads[i]));
+	}
+	HOST_CHECK(reads[2].order == 0);
+	HOST_CHECK(reads[1].order == 1);
+	HOST_CHECK(reads[3].order == 2);
+	HOST_CHECK(reads[0].order == 3);// After the synchronous bulk read, which didn't have a callback
+	HOST_CHECK(hostNotifications == 4);
+	HOST_CHECK(flashModelIsIdle());
+}
+
+static void cancelQueuedRead(void)
+{
+	if ((readsToQueue > 0) && ((hostCycles - startCycles) >= queueAtCycles))
+	{
+		queueReads();
+		HOST_CHECK(SPI_Flash_readCancel(&reads[0].request));
+		HOST_CHECK(reads[0].request.state == SPI_FLASH_REQUEST_FAILED);
+		HOST_CHECK(SPI_Flash_readCancel(&reads[0].request) == false);
+	}
+}
+
+static void testCancel(void)
+{
+	setup();
+	prepareRead(&reads[0], TEST_AREA_START, 512, SPI_FLASH_PRIORITY_VOICE);
+	readsToQueue = 1;
+	queueAtCycles = 5000;
+	hostPreemptionHook = cancelQueuedRead;
+
+	bulkRead(0x4000);
+
+	HOST_CHECK(reads[0].callbacks == 0);
+	HOST_CHECK(hostNotifications == 0);
+	HOST_CHECK(reads[0].request.state == SPI_FLASH_REQUEST_FAILED);
+}
+
+// A synchronous read from a task preempting the flash holder can't be served: it gives up after the lock timeout.
+static void syncReadWhileBusy(void)
+{
+	if ((hostCycles - startCycles) >= queueAtCycles)
+	{
+		uint32_t startMillis = hostMillis;
+
+		hostPreemptionHook = NULL;
+		syncReadResult = SPI_Flash_read(TEST_AREA_START, reads[0].data, 16);
+		HOST_CHECK((hostMillis - startMillis) >= 20);
+	}
+}
+
+static void testSyncReadTimeout(void)
+{
+	setup();
+	syncReadResult = true;
+	queueAtCycles = 5000;
+	hostPreemptionHook = syncReadWhileBusy;
+
+	bulkRead(0x4000);
+
+	HOST_CHECK(syncReadResult == false);
+	HOST_CHECK(hostPreemptionHook == NULL);
+	HOST_CHECK(flashModelIsIdle());
+	// Nothing left behind in the queue
+	bulkRead(0x100);
+}
+
+// Interrupts served between the chunks change other pins of the port
+static void testIsrGpioActivity(void)
+{
+	setup();
+	isrCount = 0;
+	hostInterruptHook = isrToggle;
+	prepareRead(&reads[0], TEST_AREA_START + 0x10000, 4096, SPI_FLASH_PRIORITY_VOICE);
+	readsToQueue = 1;
+	queueAtCycles = 20000;
+	hostPreemptionHook = queueReads;
+
+	bulkRead(0x20000);
+
+	HOST_CHECK(readIsValid(&reads[0]));
+	HOST_CHECK(isrCount > (0x20000 / 32));
+	HOST_CHECK(((hostGpioAccess()->PDOR >> ISR_PIN) & 1U) == (isrCount & 1U));
+	HOST_CHECK(flashModelStats.protocolErrors == 0);
+	HOST_CHECK(flashModelIsIdle());
+	hostInterruptHook = NULL;
+}
+
+int main(void)
+{
+	printf("SPI flash prioritised read queue\n");
+
+	testVoiceLatency();
+	testPriorityOrder();
+	testCancel();
+	testSyncReadTimeout();
+	testIsrGpioActivity();
+
+	if (hostCheckFailures() != 0)
+	{
+		printf("FAILED (%d)\n", hostCheckFailures());
+		return EXIT_FAILURE;
+	}
+
+	printf("OK\n");
+	return EXIT_SUCCESS;
+}
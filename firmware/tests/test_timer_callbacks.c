@@ -0,0 +1,500 @@
+/*
+ * Copyright (C) 2024 Roger Clark, VK3KYY / G4KYF
+ *                    Daniel Caujolle-Bert, F1RMB
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+ *    in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. Use of this source code or binary releases for commercial purposes is strictly forbidden. This includes, without limitation,
+ *    incorporation in a commercial product or incorporation into a product or project which allows commercial use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// Timer callbacks (ticks.c): a simulated PITCounter, started just before its rollover, with random adds, reschedules
+// and cancels, including from the callbacks themselves. Every handleTimerCallbacks() call is checked against a model
+// of the pending callbacks: which ones are called, in due time then insertion order, and which ones are dropped
+// for not being on their menu. Then it is timed against the previous callbacks array.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "functions/ticks.h"
+#include "user_interface/menuSystem.h"
+#include "hostSupport.h"
+
+#define CALLBACKS_MAX          16U // MAX_NUM_TIMER_CALLBACKS
+#define FUNCTIONS_COUNT        12U
+#define SIMULATION_STEPS  2000000U
+#define BENCHMARK_CALLS   2000000U
+#define REF_CALLBACKS_MAX       8U
+
+typedef struct
+{
+	bool                  used;
+	uint8_t               function;
+	int                   menuDestination;
+	uint32_t              dueTime;
+	uint32_t              order;// Model insertion order
+	timerCallbackHandle_t handle;
+} modelCallback_t;
+
+volatile uint32_t PITCounter = 0xFFFF0000U;
+
+static modelCallback_t model[CALLBACKS_MAX];
+static uint32_t modelOrder = 0;
+static int currentMenu = 0;
+static uint8_t calledLog[CALLBACKS_MAX * 2];
+static uint32_t calledCount = 0;
+static bool callbacksReAdd = false;
+static uint32_t randomState = 0x71C7AC70;
+
+// Previous callbacks array
+typedef struct
+{
+	timerCallback_t  funPtr;
+	int              menuDestination;
+	ticksTimer_t     PIT_TriggerTimer;
+} refTimerCallbackbackStruct_t;
+
+static refTimerCallbackbackStruct_t refCallbacksArray[REF_CALLBACKS_MAX];
+
+
+static uint32_t randomNext(void)
+{
+	randomState ^= (randomState << 13);
+	randomState ^= (randomState >> 17);
+	randomState ^= (randomState << 5);
+
+	return randomState;
+}
+
+int menuSystemGetCurrentMenuNumber(void)
+{
+	return currentMenu;
+}
+
+static int modelCount(void)
+{
+	int count = 0;
+
+	for (uint32_t i = 0; i < CALLBACKS_MAX; i++)
+	{
+		count += (model[i].used ? 1 : 0);
+	}
+
+	return count;
+}
+
+static int modelFind(timerCallbackHandle_t handle)
+{
+	for (uint32_t i = 0; i < CALLBACKS_MAX; i++)
+	{
+		if (model[i].used && ((model[i].handle & 0xFF) == (handle & 0xFF)))
+		{
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+static void modelAdd(timerCallbackHandle_t handle, uint8_t function, uint32_t delay, int menuDest)
+{
+	int entry = modelFind(handle);
+
+	if (entry < 0)
+	{
+		for (entry = 0; model[entry].used; entry++)
+		{
+		}
+	}
+
+	model[entry].used = true;
+	model[entry].function = function;
+	model[entry].menuDestination = menuDest;
+	model[entry].dueTime = PITCounter + delay;
+	model[entry].order = modelOrder++;
+	model[entry].handle = handle;
+}
+
+static timerCallback_t callbackFunctions[FUNCTIONS_COUNT];
+
+static void callbackCalled(uint8_t function)
+{
+	calledLog[calledCount++ % (CALLBACKS_MAX * 2)] = function;
+
+	// Added again from the callback: never called from the same handleTimerCallbacks(), even with no delay
+	if (callbacksReAdd && ((randomNext() % 4) == 0) && (modelCount() < (int)CALLBACKS_MAX))
+	{
+		uint32_t delay = randomNext() % 3;
+		timerCallbackHandle_t handle = addTimerCallbackWithHandle(callbackFunctions[function], delay, MENU_ANY, false);
+
+		HOST_CHECK(handle != TIMER_CALLBACK_INVALID_HANDLE);
+		modelAdd(handle, function, delay, MENU_ANY);
+	}
+}
+
+#define TEST_CALLBACK(n) static void testCallback##n(void) { callbackCalled(n); }
+TEST_CALLBACK(0) TEST_CALLBACK(1) TEST_CALLBACK(2) TEST_CALLBACK(3) TEST_CALLBACK(4) TEST_CALLBACK(5)
+TEST_CALLBACK(6) TEST_CALLBACK(7) TEST_CALLBACK(8) TEST_CALLBACK(9) TEST_CALLBACK(10) TEST_CALLBACK(11)
+
+static timerCallback_t callbackFunctions[FUNCTIONS_COUNT] =
+{
+		testCallback0, testCallback1, testCallback2, testCallback3, testCallback4, testCallback5,
+		testCallback6, testCallback7, testCallback8, testCallback9, testCallback10, testCallback11
+};
+
+// Previous ticksTimerHasExpired()
+static bool refTicksTimerHasExpired(ticksTimer_t *timer)
+{
+	return ((PITCounter - timer->start) >= timer->timeout);
+}
+
+// Previous handleTimerCallbacks()
+static void refHandleTimerCallbacks(void)
+{
+	int i = 0;
+
+	while((refCallbacksArray[i].funPtr != NULL) && (i < REF_CALLBACKS_MAX))
+	{
+		timerCallback_t cbFunction = NULL;
+
+		if (refTicksTimerHasExpired(&refCallbacksArray[i].PIT_TriggerTimer))
+		{
+			// Does the current menu matches the desired destination menu
+			if ((refCallbacksArray[i].menuDestination == MENU_ANY) || (refCallbacksArray[i].menuDestination == menuSystemGetCurrentMenuNumber()))
+			{
+				// Postpone the call to callback function, as it could add/delete/update a TimerCallback in its code.
+				cbFunction = refCallbacksArray[i].funPtr;
+			}
+
+			if (i != (REF_CALLBACKS_MAX - 1))
+			{
+				memmove(&refCallbacksArray[i], &refCallbacksArray[i + 1], ((REF_CALLBACKS_MAX - 1) - i) * sizeof(refTimerCallbackbackStruct_t));
+			}
+
+			refCallbacksArray[REF_CALLBACKS_MAX - 1].funPtr = NULL;
+		}
+		else
+		{
+			i++;
+		}
+
+		if (cbFunction != NULL)
+		{
+			cbFunction();
+			i = 0; // Restart from the beginning of the array
+		}
+	}
+}
+
+// Previous addTimerCallback()
+static bool refAddTimerCallback(timerCallback_t funPtr, uint32_t delayIn_mS, int menuDest, bool updateExistingCallbackTime)
+{
+	uint32_t callBackTime = delayIn_mS;
+
+	for(int i = 0; i < REF_CALLBACKS_MAX; i++)
+	{
+		if (refCallbacksArray[i].funPtr == NULL)
+		{
+			refCallbacksArray[i].funPtr = funPtr;
+			refCallbacksArray[i].menuDestination = menuDest;
+			refCallbacksArray[i].PIT_TriggerTimer.start = PITCounter;
+			refCallbacksArray[i].PIT_TriggerTimer.timeout = callBackTime;
+			return true;
+		}
+
+		if ((refCallbacksArray[i].funPtr == funPtr) && updateExistingCallbackTime)
+		{
+			refCallbacksArray[i].menuDestination = menuDest;
+			refCallbacksArray[i].PIT_TriggerTimer.start = PITCounter;
+			refCallbacksArray[i].PIT_TriggerTimer.timeout = callBackTime;
+			return true;
+		}
+
+		// callbacksArray[i] must be non-null pointer
+		if (refTicksTimerHasExpired(&refCallbacksArray[i].PIT_TriggerTimer))
+		{
+			if (i != (REF_CALLBACKS_MAX - 1))
+			{
+				// shuffle all other callbacks down in the list if there is space
+				memmove(&refCallbacksArray[i+1], &refCallbacksArray[i], ((REF_CALLBACKS_MAX - 1) - i) * sizeof(refTimerCallbackbackStruct_t));
+			}
+			refCallbacksArray[i].funPtr = funPtr;
+			refCallbacksArray[i].menuDestination = menuDest;
+			refCallbacksArray[i].PIT_TriggerTimer.start = PITCounter;
+			refCallbacksArray[i].PIT_TriggerTimer.timeout = callBackTime;
+			return true;
+		}
+	}
+	return false;
+}
+
+// Calls handleTimerCallbacks() and checks it against the model
+static uint32_t handleAndCheck(uint32_t *called, uint32_t *dropped)
+{
+	int expected[CALLBACKS_MAX];
+	int expectedCount = 0;
+	uint32_t errors = 0;
+
+	// Expired, in due time then insertion order
+	for (uint32_t i = 0; i < CALLBACKS_MAX; i++)
+	{
+		if (model[i].used && ((int32_t)(PITCounter - model[i].dueTime) >= 0))
+		{
+			int j = expectedCount++;
+
+			while ((j > 0) && (((int32_t)(model[i].dueTime - model[expected[j - 1]].dueTime) < 0) ||
+					((model[i].dueTime == model[expected[j - 1]].dueTime) && (model[i].order < model[expected[j - 1]].order))))
+			{
+				expected[j] = expected[j - 1];
+				j--;
+			}
+			expected[j] = i;
+		}
+	}
+
+	uint8_t functions[CALLBACKS_MAX];
+	uint32_t functionsCount = 0;
+
+	for (int i = 0; i < expectedCount; i++)
+	{
+		modelCallback_t *entry = &model[expected[i]];
+
+		entry->used = false;
+		if ((entry->menuDestination == MENU_ANY) || (entry->menuDestination == currentMenu))
+		{
+			functions[functionsCount++] = entry->function;
+		}
+		else
+		{
+			(*dropped)++;
+		}
+	}
+
+	calledCount = 0;
+	handleTimerCallbacks();
+
+	if (calledCount != functionsCount)
+	{
+		errors++;
+	}
+	else
+	{
+		errors += (memcmp(calledLog, functions, functionsCount) != 0) ? 1 : 0;
+	}
+	*called += calledCount;
+
+	return errors;
+}
+
+static void testSimulation(void)
+{
+	uint32_t errors = 0;
+	uint32_t called = 0;
+	uint32_t dropped = 0;
+	uint32_t rescheduled = 0;
+	uint32_t cancelled = 0;
+	uint32_t full = 0;
+	uint32_t startCounter = PITCounter;
+
+	callbacksReAdd = true;
+
+	for (uint32_t step = 0; step < SIMULATION_STEPS; step++)
+	{
+		uint32_t action = randomNext() % 100;
+		uint8_t function = randomNext() % FUNCTIONS_COUNT;
+		int menuDest = (((randomNext() % 4) == 0) ? (int)(randomNext() % 3) : MENU_ANY);
+
+		PITCounter += 1 + (((randomNext() % 8) == 0) ? (randomNext() % 20) : 0);
+
+		if ((randomNext() % 5000) == 0)
+		{
+			currentMenu = randomNext() % 3;
+		}
+
+		if (action < 4)
+		{
+			// Added (or rescheduled), a few of them much later, and all due at the same time now and then
+			bool update = ((randomNext() % 2) == 0);
+			uint32_t delay = (((randomNext() % 8) == 0) ? 50 : (randomNext() % 2000));
+			int entry = -1;
+
+			if ((randomNext() % 100) == 0)
+			{
+				delay = 0x7FFF0000 - (randomNext() % 1000000);
+			}
+
+			if (update)
+			{
+				// Lowest slot with this callback
+				for (uint32_t i = 0; i < CALLBACKS_MAX; i++)
+				{
+					if (model[i].used && (model[i].function == function) && ((entry < 0) || ((model[i].handle & 0xFF) < (model[entry].handle & 0xFF))))
+					{
+						entry = i;
+					}
+				}
+			}
+
+			timerCallbackHandle_t handle = addTimerCallbackWithHandle(callbackFunctions[function], delay, menuDest, update);
+
+			if ((entry < 0) && (modelCount() == CALLBACKS_MAX))
+			{
+				errors += (handle != TIMER_CALLBACK_INVALID_HANDLE) ? 1 : 0;
+				full++;
+			}
+			else if ((handle == TIMER_CALLBACK_INVALID_HANDLE) || ((entry >= 0) && ((handle & 0xFF) != (model[entry].handle & 0xFF))))
+			{
+				errors++;
+			}
+			else
+			{
+				rescheduled += ((entry >= 0) ? 1 : 0);
+				modelAdd(handle, function, delay, menuDest);
+			}
+		}
+		else if (action < 6)
+		{
+			// Cancelled with its handle, which is then stale
+			uint32_t i = randomNext() % CALLBACKS_MAX;
+
+			if (model[i].used)
+			{
+				errors += (cancelTimerCallbackByHandle(model[i].handle) == false) ? 1 : 0;
+				errors += (cancelTimerCallbackByHandle(model[i].handle) == true) ? 1 : 0;
+				model[i].used = false;
+				cancelled++;
+			}
+			else
+			{
+				errors += (cancelTimerCallbackByHandle(model[i].handle) == true) ? 1 : 0;
+			}
+		}
+		else if (action < 7)
+		{
+			// Cancelled by function and menu, when that is not ambiguous
+			int entry = -1;
+			int matches = 0;
+
+			for (uint32_t i = 0; i < CALLBACKS_MAX; i++)
+			{
+				if (model[i].used && (model[i].function == function) && (model[i].menuDestination == menuDest))
+				{
+					entry = i;
+					matches++;
+				}
+			}
+
+			if (matches <= 1)
+			{
+				errors += (cancelTimerCallback(callbackFunctions[function], menuDest) != (matches == 1)) ? 1 : 0;
+				if (entry >= 0)
+				{
+					model[entry].used = false;
+					cancelled++;
+				}
+			}
+		}
+
+		errors += handleAndCheck(&called, &dropped);
+	}
+
+	callbacksReAdd = false;
+	uint32_t endCounter = PITCounter;
+
+	// Flush what is left, the long delays aside
+	for (uint32_t i = 0; i < CALLBACKS_MAX; i++)
+	{
+		if (model[i].used)
+		{
+			errors += (cancelTimerCallbackByHandle(model[i].handle) == false) ? 1 : 0;
+			model[i].used = false;
+		}
+	}
+	PITCounter += 0x7FFFFFFF;
+	errors += handleAndCheck(&called, &dropped);
+
+	printf("  %u ms from 0x%08X to 0x%08X: %u called, %u dropped off their menu, %u rescheduled, %u cancelled, %u adds when full, %u errors\n",
+			(endCounter - startCounter), startCounter, endCounter, called, dropped, rescheduled, cancelled, full, errors);
+	HOST_CHECK((called > 0) && (dropped > 0) && (rescheduled > 0) && (cancelled > 0) && (full > 0));
+	HOST_CHECK(errors == 0);
+}
+
+static void benchmarkCallback(void)
+{
+}
+
+static void benchmark(void)
+{
+	uint32_t check = 0;
+	double start, refRate, rate;
+
+	// A full previous array of callbacks not due yet, then polled from the main loop every millisecond
+	for (uint32_t i = 0; i < REF_CALLBACKS_MAX; i++)
+	{
+		check += refAddTimerCallback(callbackFunctions[i], 0x70000000, MENU_ANY, false) ? 1 : 0;
+		check += (addTimerCallbackWithHandle(callbackFunctions[i], 0x70000000, MENU_ANY, false) != TIMER_CALLBACK_INVALID_HANDLE) ? 1 : 0;
+	}
+
+	start = hostSeconds();
+	for (uint32_t i = 0; i < BENCHMARK_CALLS; i++)
+	{
+		PITCounter++;
+		if ((i & 0x0F) == 0)
+		{
+			check += refAddTimerCallback(benchmarkCallback, 5, MENU_ANY, true) ? 1 : 0;
+		}
+		refHandleTimerCallbacks();
+	}
+	refRate = BENCHMARK_CALLS / (hostSeconds() - start);
+
+	start = hostSeconds();
+	for (uint32_t i = 0; i < BENCHMARK_CALLS; i++)
+	{
+		PITCounter++;
+		if ((i & 0x0F) == 0)
+		{
+			check += addTimerCallback(benchmarkCallback, 5, MENU_ANY, true) ? 1 : 0;
+		}
+		handleTimerCallbacks();
+	}
+	rate = BENCHMARK_CALLS / (hostSeconds() - start);
+
+	printf("  %u pending and one every 16 ms: %.0f polls/s previously, %.0f polls/s now (x%.1f) [%u]\n",
+			REF_CALLBACKS_MAX, refRate, rate, (rate / refRate), (check & 0x01));
+	HOST_CHECK(rate > refRate);
+}
+
+int main(void)
+{
+	printf("Timer callbacks\n");
+
+	testSimulation();
+	benchmark();
+
+	if (hostCheckFailures() != 0)
+	{
+		printf("FAILED (%d)\n", hostCheckFailures());
+		return EXIT_FAILURE;
+	}
+
+	printf("OK\n");
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,836 @@
+/* -*- mode: c; c-file-style: "k&r"; compile-command: "gcc -Wall -O2 -o telemetry_decoder telemetry_decoder.c"; -*- */
+
+/*
+ * Copyright (C) 2024 Roger Clark, VK3KYY / G4KYF
+ *                    Daniel Caujolle-Bert, F1RMB
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions and the following disclaimer
+ *    in the documentation and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * 4. Use of this source code or binary releases for commercial purposes is strictly forbidden. This includes, without limitation,
+ *    incorporation in a commercial product or incorporation into a product or project which allows commercial use.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ * USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// Reads the CPS tasks telemetry snapshot (CPS read type 12, see watchdogGetTelemetry() in wdog.c) from the radio,
+// or from a dump file, and prints it: per task CPU load and stack margin, heap, wakeups and the stack overflow record.
+// With --profiler, reads the interrupts latency profiler dump instead (CPS read type 13, USING_LATENCY_PROFILER builds,
+// see profilerGetDump() in wdog.c), and lists the sites keeping the interrupts masked the longest first.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <unistd.h>
+#include <inttypes.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <getopt.h>
+#if ! defined(_WIN32)
+#include <termios.h>
+#endif
+
+#define VERSION_MAJOR 0
+#define VERSION_MINOR 0
+#define VERSION_REV   1
+
+#if defined(_WIN32)
+#define OPEN_RO_FLAGS O_RDONLY|O_RAW
+#define OPEN_RW_FLAGS O_CREAT|O_WRONLY|O_TRUNC|O_RAW
+#else
+#define OPEN_RO_FLAGS O_RDONLY
+#define OPEN_RW_FLAGS O_CREAT|O_WRONLY|O_TRUNC
+#endif
+
+#define CPS_ACCESS_TASKS_TELEMETRY  12
+#define CPS_ACCESS_LATENCY_PROFILER 13
+#define CPS_RESPONSE_MAX_LENGTH     ((512 * 3) - 3) // COM_REQUESTBUFFER_SIZE - 3
+
+// Snapshot layout, all little endian (telemetryHeader_t and telemetryTask_t in wdog.c)
+#define TASK_NAME_LENGTH            20 // configMAX_TASK_NAME_LEN
+#define WAKEUPS_TASKS               3
+#define HEADER_V1_LENGTH            ((9 * 4) + TASK_NAME_LENGTH + 4)
+#define HEADER_V2_LENGTH            (HEADER_V1_LENGTH + (WAKEUPS_TASKS * 8))
+#define TASK_LENGTH                 (TASK_NAME_LENGTH + 12)
+#define TASKS_MAX                   ((CPS_RESPONSE_MAX_LENGTH - HEADER_V1_LENGTH) / TASK_LENGTH)
+
+// Profiler dump layout, all little endian (profilerHeader_t and profilerSiteStats_t in wdog.c)
+#define PROFILER_HEADER_LENGTH      (5 * 4)
+#define PROFILER_BUCKETS_MAX        32
+#define PROFILER_SITES_MAX          32
+#define PROFILER_THRESHOLD_US       50.0 // Default masked time flagged as an offender
+
+typedef struct
+{
+     char     name[TASK_NAME_LENGTH + 1];
+     uint32_t runTime;
+     uint32_t stackHighWaterMark;
+     uint8_t  taskNumber;
+     uint8_t  priority;
+     uint8_t  state;
+} telemetryTask_t;
+
+typedef struct
+{
+     uint32_t structVersion;
+     uint32_t coreClock;
+     uint32_t runTimeCounterShift;
+     uint32_t totalRunTime;
+     uint32_t uptime;
+     uint32_t freeHeap;
+     uint32_t minimumEverFreeHeap;
+     uint32_t stackOverflowCount;
+     uint32_t stackOverflowTime;
+     char     stackOverflowTaskName[TASK_NAME_LENGTH + 1];
+     bool     hasWakeups;// structVersion 2 and later
+     uint32_t wakeupsTotal[WAKEUPS_TASKS];
+     uint32_t wakeupsNotified[WAKEUPS_TASKS];
+     uint32_t numberOfTasks;
+     telemetryTask_t tasks[TASKS_MAX];
+} telemetry_t;
+
+typedef struct
+{
+     uint32_t count;
+     uint32_t maxCycles;
+     uint64_t totalCycles;
+     uint32_t buckets[PROFILER_BUCKETS_MAX];
+} profilerSite_t;
+
+typedef struct
+{
+     uint32_t structVersion;
+     uint32_t coreClock;
+     uint32_t numberOfSites;
+     uint32_t numberOfBuckets;
+     uint32_t bucketShift;
+     profilerSite_t sites[PROFILER_SITES_MAX];
+} profilerDump_t;
+
+static const char short_options[] = "?hd:f:o:pct:S";
+static const struct option long_options[] = {
+     { "help"             , no_argument      , 0, 'h' },
+     { "device"           , required_argument, 0, 'd' },
+     { "file"             , required_argument, 0, 'f' },
+     { "output"           , required_argument, 0, 'o' },
+     { "profiler"         , no_argument      , 0, 'p' },
+     { "clear"            , no_argument      , 0, 'c' },
+     { "threshold"        , required_argument, 0, 't' },
+     { "self-test"        , no_argument      , 0, 'S' },
+     { 0                  , no_argument      , 0,  0  }
+};
+
+static const char *wakeupsTaskNames[WAKEUPS_TASKS] = { "main", "beep", "hrc6000" };
+static const char *taskStateNames[] = { "running", "ready", "blocked", "suspended", "deleted", "invalid" };
+// profilerSite_t order (wdog.h), and what is delayed while the site runs
+static const char *profilerSiteNames[] =
+{
+     "SPI Flash read (critical)",
+     "SPI Flash page write (critical)",
+     "SPI Flash sector erase (critical)",
+     "LCD transfer (critical)",
+     "hrc6000Tick() PORTC IRQ disabled",
+     "RX audio decode (critical)",
+     "hotspot storeNetFrame()",
+     "PORTC ISR (HR-C6000)",
+     "FTM1 ISR (APRS sender)",
+     "PIT0 ISR",
+     "ADC0 ISR"
+};
+
+
+static uint32_t getLE32(const uint8_t *p)
+{
+     return (p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24));
+}
+
+static void putLE32(uint8_t *p, uint32_t value)
+{
+     p[0] = (value & 0xFF);
+     p[1] = ((value >> 8) & 0xFF);
+     p[2] = ((value >> 16) & 0xFF);
+     p[3] = ((value >> 24) & 0xFF);
+}
+
+static bool decodeTelemetry(const uint8_t *buffer, size_t length, telemetry_t *telemetry)
+{
+     size_t headerLength;
+     const uint8_t *p = buffer;
+
+     memset(telemetry, 0, sizeof(telemetry_t));
+
+     if (length < HEADER_V1_LENGTH)
+     {
+	  fprintf(stderr, "Telemetry too short: %zu bytes.\n", length);
+	  return false;
+     }
+
+     telemetry->structVersion = getLE32(p);
+     switch (telemetry->structVersion)
+     {
+     case 1:
+	  headerLength = HEADER_V1_LENGTH;
+	  break;
+
+     case 2:
+	  headerLength = HEADER_V2_LENGTH;
+	  telemetry->hasWakeups = true;
+	  break;
+
+     default:
+	  fprintf(stderr, "Unknown telemetry version %" PRIu32 ".\n", telemetry->structVersion);
+	  return false;
+     }
+
+     if (length < headerLength)
+     {
+	  fprintf(stderr, "Telemetry too short for version %" PRIu32 ": %zu bytes.\n", telemetry->structVersion, length);
+	  return false;
+     }
+
+     telemetry->coreClock = getLE32(p + 4);
+     telemetry->runTimeCounterShift = getLE32(p + 8);
+     telemetry->totalRunTime = getLE32(p + 12);
+     telemetry->uptime = getLE32(p + 16);
+     telemetry->freeHeap = getLE32(p + 20);
+     telemetry->minimumEverFreeHeap = getLE32(p + 24);
+     telemetry->stackOverflowCount = getLE32(p + 28);
+     telemetry->stackOverflowTime = getLE32(p + 32);
+     memcpy(telemetry->stackOverflowTaskName, p + 36, TASK_NAME_LENGTH);
+     p += (36 + TASK_NAME_LENGTH);
+
+     if (telemetry->hasWakeups)
+     {
+	  for (int i = 0; i < WAKEUPS_TASKS; i++)
+	  {
+	       telemetry->wakeupsTotal[i] = getLE32(p);
+	       telemetry->wakeupsNotified[i] = getLE32(p + 4);
+	       p += 8;
+	  }
+     }
+
+     telemetry->numberOfTasks = getLE32(p);
+     p += 4;
+
+     if ((telemetry->numberOfTasks > TASKS_MAX) || (length != (headerLength + (telemetry->numberOfTasks * TASK_LENGTH))))
+     {
+	  fprintf(stderr, "Telemetry length %zu doesn't match its %" PRIu32 " tasks.\n", length, telemetry->numberOfTasks);
+	  return false;
+     }
+
+     for (uint32_t i = 0; i < telemetry->numberOfTasks; i++)
+     {
+	  telemetryTask_t *task = &telemetry->tasks[i];
+
+	  memcpy(task->name, p, TASK_NAME_LENGTH);
+	  task->runTime = getLE32(p + TASK_NAME_LENGTH);
+	  task->stackHighWaterMark = getLE32(p + TASK_NAME_LENGTH + 4);
+	  task->taskNumber = p[TASK_NAME_LENGTH + 8];
+	  task->priority = p[TASK_NAME_LENGTH + 9];
+	  task->state = p[TASK_NAME_LENGTH + 10];
+	  p += TASK_LENGTH;
+     }
+
+     return true;
+}
+
+static void printTelemetry(const telemetry_t *telemetry)
+{
+     double uptime = (telemetry->uptime / 1000.0);
+     double runTimeUnit = ((double)(1U << telemetry->runTimeCounterShift) / telemetry->coreClock);// seconds
+
+     fprintf(stdout, "Version %" PRIu32 ", core clock %.1f MHz, uptime %.3f s\n", telemetry->structVersion, (telemetry->coreClock / 1e6), uptime);
+     fprintf(stdout, "Heap: %" PRIu32 " bytes free, %" PRIu32 " at the minimum\n", telemetry->freeHeap, telemetry->minimumEverFreeHeap);
+
+     if (telemetry->stackOverflowCount == 0)
+     {
+	  fprintf(stdout, "Stack overflows: none since power up\n");
+     }
+     else
+     {
+	  fprintf(stdout, "Stack overflows: %" PRIu32 " since power up, the last one in '%s' at %.3f s (then reset)\n",
+		  telemetry->stackOverflowCount, telemetry->stackOverflowTaskName, (telemetry->stackOverflowTime / 1000.0));
+     }
+
+     if (telemetry->hasWakeups)
+     {
+	  fprintf(stdout, "Wakeups since power up:\n");
+	  for (int i = 0; i < WAKEUPS_TASKS; i++)
+	  {
+	       fprintf(stdout, "  %-8s %10" PRIu32 " (%8.1f/s), %5.1f%% notified\n", wakeupsTaskNames[i], telemetry->wakeupsTotal[i],
+		       ((uptime > 0) ? (telemetry->wakeupsTotal[i] / uptime) : 0.0),
+		       ((telemetry->wakeupsTotal[i] > 0) ? ((100.0 * telemetry->wakeupsNotified[i]) / telemetry->wakeupsTotal[i]) : 0.0));
+	  }
+     }
+
+     fprintf(stdout, "Tasks:\n");
+     fprintf(stdout, "  %2s %-*s %-9s %4s %6s %12s %11s\n", "#", TASK_NAME_LENGTH, "Name", "State", "Prio", "CPU", "Run time", "Stack free");
+     for (uint32_t i = 0; i < telemetry->numberOfTasks; i++)
+     {
+	  const telemetryTask_t *task = &telemetry->tasks[i];
+
+	  fprintf(stdout, "  %2u %-*s %-9s %4u %5.1f%% %10.3f s %5" PRIu32 " bytes\n", task->taskNumber, TASK_NAME_LENGTH, task->name,
+		  taskStateNames[(task->state < 5) ? task->state : 5], task->priority,
+		  ((telemetry->totalRunTime > 0) ? ((100.0 * task->runTime) / telemetry->totalRunTime) : 0.0),
+		  (task->runTime * runTimeUnit), task->stackHighWaterMark);
+     }
+}
+
+static bool decodeProfilerDump(const uint8_t *buffer, size_t length, profilerDump_t *dump)
+{
+     const uint8_t *p = buffer;
+     size_t siteLength;
+
+     memset(dump, 0, sizeof(profilerDump_t));
+
+     if (length < PROFILER_HEADER_LENGTH)
+     {
+	  fprintf(stderr, "Profiler dump too short: %zu bytes.\n", length);
+	  return false;
+     }
+
+     dump->structVersion = getLE32(p);
+     dump->coreClock = getLE32(p + 4);
+     dump->numberOfSites = getLE32(p + 8);
+     dump->numberOfBuckets = getLE32(p + 12);
+     dump->bucketShift = getLE32(p + 16);
+     p += PROFILER_HEADER_LENGTH;
+
+     if (dump->structVersion != 1)
+     {
+	  fprintf(stderr, "Unknown profiler dump version %" PRIu32 ".\n", dump->structVersion);
+	  return false;
+     }
+
+     if ((dump->numberOfSites > PROFILER_SITES_MAX) || (dump->numberOfBuckets == 0) || (dump->numberOfBuckets > PROFILER_BUCKETS_MAX) ||
+	 (dump->bucketShift > 16) || (dump->coreClock == 0))
+     {
+	  fprintf(stderr, "Invalid profiler dump header.\n");
+	  return false;
+     }
+
+     siteLength = (16 + (dump->numberOfBuckets * 4));
+     if (length != (PROFILER_HEADER_LENGTH + (dump->numberOfSites * siteLength)))
+     {
+	  fprintf(stderr, "Profiler dump length %zu doesn't match its %" PRIu32 " sites.\n", length, dump->numberOfSites);
+	  return false;
+     }
+
+     for (uint32_t i = 0; i < dump->numberOfSites; i++)
+     {
+	  profilerSite_t *site = &dump->sites[i];
+
+	  site->count = getLE32(p);
+	  site->maxCycles = getLE32(p + 4);
+	  site->totalCycles = (getLE32(p + 8) | ((uint64_t)getLE32(p + 12) << 32));
+	  for (uint32_t b = 0; b < dump->numberOfBuckets; b++)
+	  {
+	       site->buckets[b] = getLE32(p + 16 + (b * 4));
+	  }
+	  p += siteLength;
+     }
+
+     return true;
+}
+
+// Upper bound, in cycles, of the histogram bucket holding the given percentile (the max for the last bucket)
+static uint32_t profilerPercentile(const profilerDump_t *dump, const profilerSite_t *site, double percentile)
+{
+     uint64_t target = (uint64_t)((site->count * percentile) / 100.0);
+     uint64_t cumulated = 0;
+
+     for (uint32_t b = 0; b < dump->numberOfBuckets; b++)
+     {
+	  cumulated += site->buckets[b];
+
+	  if ((cumulated > target) || (cumulated == site->count))
+	  {
+	       if (b < (dump->numberOfBuckets - 1))
+	       {
+		    uint32_t upper = (1U << (dump->bucketShift + b));
+
+		    return ((upper < site->maxCycles) ? upper : site->maxCycles);
+	       }
+	       break;
+	  }
+     }
+
+     return site->maxCycles;
+}
+
+// Fills order with the sites indexes, the longest max first, and returns how many exceed the threshold
+static uint32_t profilerSortOffenders(const profilerDump_t *dump, uint32_t *order, double thresholdUs)
+{
+     uint32_t offenders = 0;
+
+     for (uint32_t i = 0; i < dump->numberOfSites; i++)
+     {
+	  uint32_t j = i;
+
+	  while ((j > 0) && (dump->sites[order[j - 1]].maxCycles < dump->sites[i].maxCycles))
+	  {
+	       order[j] = order[j - 1];
+	       j--;
+	  }
+	  order[j] = i;
+
+	  offenders += (((dump->sites[i].maxCycles * 1e6) / dump->coreClock) > thresholdUs) ? 1 : 0;
+     }
+
+     return offenders;
+}
+
+static void printProfilerDump(const profilerDump_t *dump, double thresholdUs)
+{
+     uint32_t order[PROFILER_SITES_MAX];
+     uint32_t offenders = profilerSortOffenders(dump, order, thresholdUs);
+     double cyclesToUs = (1e6 / dump->coreClock);
+
+     fprintf(stdout, "Latency profiler, core clock %.1f MHz, %" PRIu32 " sites, longest first:\n", (dump->coreClock / 1e6), dump->numberOfSites);
+     fprintf(stdout, "  %-34s %10s %10s %10s %10s %10s\n", "Site", "Count", "Mean us", "p99 us", "Max us", "Total ms");
+     for (uint32_t i = 0; i < dump->numberOfSites; i++)
+     {
+	  const profilerSite_t *site = &dump->sites[order[i]];
+	  double maxUs = (site->maxCycles * cyclesToUs);
+	  char unknownName[32];
+	  const char *name = unknownName;
+
+	  if (order[i] < (sizeof(profilerSiteNames) / sizeof(profilerSiteNames[0])))
+	  {
+	       name = profilerSiteNames[order[i]];
+	  }
+	  else
+	  {
+	       snprintf(unknownName, sizeof(unknownName), "site #%" PRIu32, order[i]);
+	  }
+
+	  if (site->count == 0)
+	  {
+	       fprintf(stdout, "  %-34s %10s\n", name, "-");
+	       continue;
+	  }
+
+	  fprintf(stdout, "  %-34s %10" PRIu32 " %10.2f %10.2f %10.2f %10.3f%s\n", name, site->count,
+		  ((site->totalCycles * cyclesToUs) / site->count), (profilerPercentile(dump, site, 99.0) * cyclesToUs), maxUs,
+		  ((site->totalCycles * cyclesToUs) / 1000.0), ((maxUs > thresholdUs) ? " <- OFFENDER" : ""));
+     }
+
+     if (offenders > 0)
+     {
+	  fprintf(stdout, "%" PRIu32 " site(s) over %.1f us\n", offenders, thresholdUs);
+     }
+     else
+     {
+	  fprintf(stdout, "No site over %.1f us\n", thresholdUs);
+     }
+}
+
+static bool readFromFile(const char *filename, uint8_t *buffer, size_t *length)
+{
+     int fd = -1;
+     ssize_t r;
+
+     if ((fd = open(filename, OPEN_RO_FLAGS)) == -1)
+     {
+	  perror("open");
+	  return false;
+     }
+
+     if ((r = read(fd, buffer, (CPS_RESPONSE_MAX_LENGTH + 1))) == -1)
+     {
+	  perror("read");
+	  close(fd);
+	  return false;
+     }
+
+     close(fd);
+     *length = r;
+     return true;
+}
+
+static bool writeToFile(const char *filename, const uint8_t *buffer, size_t length)
+{
+     int fd = -1;
+
+     if ((fd = open(filename, OPEN_RW_FLAGS, S_IRUSR|S_IWUSR|S_IRGRP|S_IWGRP)) == -1)
+     {
+	  perror("open");
+	  return false;
+     }
+
+     if (write(fd, buffer, length) != (ssize_t)length)
+     {
+	  perror("write");
+	  close(fd);
+	  return false;
+     }
+
+     if (close(fd) == -1)
+     {
+	  perror("close");
+	  return false;
+     }
+
+     return true;
+}
+
+#if ! defined(_WIN32)
+// Reads exactly length bytes, or fails after about a second without data
+static bool serialRead(int fd, uint8_t *buffer, size_t length)
+{
+     size_t done = 0;
+
+     while (done < length)
+     {
+	  ssize_t r = read(fd, (buffer + done), (length - done));
+
+	  if (r <= 0)
+	  {
+	       if (r == -1)
+	       {
+		    perror("read");
+	       }
+	       return false;
+	  }
+
+	  done += r;
+     }
+
+     return true;
+}
+
+// CPS read command: 'R', area, address (32 bits, big endian), length (16 bits, big endian).
+// The radio answers 'R', length (16 bits, big endian) and the data, or '-' on failure.
+static bool readFromRadio(const char *device, uint8_t area, uint32_t address, uint8_t *buffer, size_t *length)
+{
+     uint8_t command[8] = { 'R', area, ((address >> 24) & 0xFF), ((address >> 16) & 0xFF), ((address >> 8) & 0xFF), (address & 0xFF),
+			    ((CPS_RESPONSE_MAX_LENGTH >> 8) & 0xFF), (CPS_RESPONSE_MAX_LENGTH & 0xFF) };
+     uint8_t response[3];
+     struct termios tio;
+     bool ok = false;
+     int fd = -1;
+
+     if ((fd = open(device, O_RDWR | O_NOCTTY)) == -1)
+     {
+	  perror("open");
+	  return false;
+     }
+
+     if (tcgetattr(fd, &tio) == -1)
+     {
+	  perror("tcgetattr");
+	  close(fd);
+	  return false;
+     }
+
+     cfmakeraw(&tio);
+     cfsetspeed(&tio, B115200);// USB CDC, the speed is ignored
+     tio.c_cc[VMIN] = 0;
+     tio.c_cc[VTIME] = 10;// 1 s
+     tcsetattr(fd, TCSANOW, &tio);
+     tcflush(fd, TCIOFLUSH);
+
+     if (write(fd, command, sizeof(command)) != sizeof(command))
+     {
+	  perror("write");
+     }
+     else if (serialRead(fd, response, 1) == false)
+     {
+	  fprintf(stderr, "No answer from the radio.\n");
+     }
+     else if (response[0] != 'R')
+     {
+	  fprintf(stderr, "The radio refused the read (is the firmware too old, or built without USING_LATENCY_PROFILER?).\n");
+     }
+     else if (serialRead(fd, &response[1], 2) == false)
+     {
+	  fprintf(stderr, "Truncated answer from the radio.\n");
+     }
+     else
+     {
+	  *length = ((response[1] << 8) | response[2]);
+
+	  if ((*length > CPS_RESPONSE_MAX_LENGTH) || (serialRead(fd, buffer, *length) == false))
+	  {
+	       fprintf(stderr, "Truncated answer from the radio.\n");
+	  }
+	  else
+	  {
+	       ok = true;
+	  }
+     }
+
+     close(fd);
+     return ok;
+}
+#endif
+
+// Encodes snapshots the way the firmware does, and checks they decode back, truncated or corrupted ones being rejected
+static bool selfTest(void)
+{
+     uint8_t buffer[CPS_RESPONSE_MAX_LENGTH + 1];
+     int failures = 0;
+
+     for (uint32_t version = 1; version <= 2; version++)
+     {
+	  telemetry_t telemetry;
+	  uint32_t numberOfTasks = 6;
+	  size_t headerLength = ((version == 1) ? HEADER_V1_LENGTH : HEADER_V2_LENGTH);
+	  size_t length = headerLength + (numberOfTasks * TASK_LENGTH);
+	  uint8_t *p = buffer;
+
+	  memset(buffer, 0, sizeof(buffer));
+	  putLE32(p, version);
+	  for (uint32_t i = 1; i < 9; i++)
+	  {
+	       putLE32((p + (i * 4)), (0x01020300 + i));
+	  }
+	  memcpy((p + 36), "hrc6000", 7);
+	  p += (36 + TASK_NAME_LENGTH);
+
+	  if (version >= 2)
+	  {
+	       for (uint32_t i = 0; i < (WAKEUPS_TASKS * 2); i++)
+	       {
+		    putLE32(p, (0xA0000000 + i));
+		    p += 4;
+	       }
+	  }
+
+	  putLE32(p, numberOfTasks);
+	  p += 4;
+
+	  for (uint32_t i = 0; i < numberOfTasks; i++)
+	  {
+	       memset(p, ('a' + i), TASK_NAME_LENGTH - 1);
+	       putLE32((p + TASK_NAME_LENGTH), (0x100000 * i));
+	       putLE32((p + TASK_NAME_LENGTH + 4), (64 + i));
+	       p[TASK_NAME_LENGTH + 8] = (i + 1);
+	       p[TASK_NAME_LENGTH + 9] = (4 - (i % 4));
+	       p[TASK_NAME_LENGTH + 10] = (i % 5);
+	       p += TASK_LENGTH;
+	  }
+
+	  if ((decodeTelemetry(buffer, length, &telemetry) == false) ||
+	      (telemetry.structVersion != version) || (telemetry.coreClock != 0x01020301) || (telemetry.stackOverflowTime != 0x01020308) ||
+	      (strcmp(telemetry.stackOverflowTaskName, "hrc6000") != 0) || (telemetry.hasWakeups != (version >= 2)) ||
+	      ((version >= 2) && ((telemetry.wakeupsTotal[0] != 0xA0000000) || (telemetry.wakeupsNotified[2] != 0xA0000005))) ||
+	      (telemetry.numberOfTasks != numberOfTasks) || (strlen(telemetry.tasks[5].name) != (TASK_NAME_LENGTH - 1)) ||
+	      (telemetry.tasks[5].name[0] != 'f') || (telemetry.tasks[5].runTime != 0x500000) || (telemetry.tasks[5].stackHighWaterMark != 69) ||
+	      (telemetry.tasks[5].taskNumber != 6) || (telemetry.tasks[5].priority != 3) || (telemetry.tasks[5].state != 0))
+	  {
+	       fprintf(stderr, "  version %" PRIu32 " snapshot not decoded back.\n", version);
+	       failures++;
+	  }
+	  else
+	  {
+	       fprintf(stdout, "  version %" PRIu32 " snapshot of %" PRIu32 " tasks decoded back\n", version, numberOfTasks);
+	  }
+
+	  fprintf(stdout, "  the errors below are expected:\n");
+	  fflush(stdout);
+	  failures += decodeTelemetry(buffer, (length - 1), &telemetry) ? 1 : 0;
+	  failures += decodeTelemetry(buffer, (headerLength - 4), &telemetry) ? 1 : 0;
+	  putLE32(buffer, 3);
+	  failures += decodeTelemetry(buffer, length, &telemetry) ? 1 : 0;
+     }
+
+     // Profiler dump: a short and frequent site, a rare long one, an unused one
+     {
+	  profilerDump_t dump;
+	  uint32_t order[PROFILER_SITES_MAX];
+	  uint32_t numberOfSites = 3;
+	  uint32_t numberOfBuckets = 16;
+	  size_t siteLength = (16 + (numberOfBuckets * 4));
+	  size_t length = PROFILER_HEADER_LENGTH + (numberOfSites * siteLength);
+	  uint8_t *p = buffer;
+
+	  memset(buffer, 0, sizeof(buffer));
+	  putLE32(p, 1);
+	  putLE32((p + 4), 120000000);
+	  putLE32((p + 8), numberOfSites);
+	  putLE32((p + 12), numberOfBuckets);
+	  putLE32((p + 16), 6);
+	  p += PROFILER_HEADER_LENGTH;
+
+	  // 1000 calls, 990 under 64 cycles, 10 in [128, 256), max 200
+	  putLE32(p, 1000);
+	  putLE32((p + 4), 200);
+	  putLE32((p + 8), 40000);
+	  putLE32((p + 16), 990);
+	  putLE32((p + 16 + (2 * 4)), 10);
+	  p += siteLength;
+
+	  // 2 calls over 2^20 cycles (last bucket), max 12000000 (100 ms), total over 32 bits
+	  putLE32(p, 2);
+	  putLE32((p + 4), 12000000);
+	  putLE32((p + 8), 0x00000010);
+	  putLE32((p + 12), 0x00000001);
+	  putLE32((p + 16 + ((numberOfBuckets - 1) * 4)), 2);
+
+	  if ((decodeProfilerDump(buffer, length, &dump) == false) ||
+	      (dump.sites[1].totalCycles != 0x100000010ULL) || (dump.sites[0].buckets[2] != 10) ||
+	      (profilerPercentile(&dump, &dump.sites[0], 50.0) != 64) || (profilerPercentile(&dump, &dump.sites[0], 99.5) != 200) ||
+	      (profilerPercentile(&dump, &dump.sites[1], 99.0) != 12000000) ||
+	      (profilerSortOffenders(&dump, order, PROFILER_THRESHOLD_US) != 1) || (order[0] != 1) || (order[1] != 0) || (order[2] != 2))
+	  {
+	       fprintf(stderr, "  profiler dump not decoded back.\n");
+	       failures++;
+	  }
+	  else
+	  {
+	       fprintf(stdout, "  profiler dump of %" PRIu32 " sites decoded back, percentiles and offenders found\n", numberOfSites);
+	  }
+
+	  fprintf(stdout, "  the errors below are expected:\n");
+	  fflush(stdout);
+	  failures += decodeProfilerDump(buffer, (length + 4), &dump) ? 1 : 0;
+	  putLE32((buffer + 12), 33);
+	  failures += decodeProfilerDump(buffer, length, &dump) ? 1 : 0;
+     }
+
+     fprintf(stdout, "%s\n", ((failures == 0) ? "OK" : "FAILED"));
+
+     return (failures == 0);
+}
+
+static void displayHelp(void)
+{
+     fprintf(stdout, "\n");
+     fprintf(stdout, "      --device, -d <device>                     : Read the telemetry from the radio, in CPS mode (e.g. /dev/ttyACM0).\n");
+     fprintf(stdout, "      --file, -f <file>                         : Decode a telemetry dump file.\n");
+     fprintf(stdout, "      --output, -o <file>                       : Also save the data read from the radio to a dump file.\n");
+     fprintf(stdout, "      --profiler, -p                            : Latency profiler dump instead of the tasks telemetry.\n");
+     fprintf(stdout, "      --clear, -c                               : Clear the profiler statistics once read from the radio.\n");
+     fprintf(stdout, "      --threshold, -t <us>                      : Flag the profiler sites over this time (default: %.0f us).\n", PROFILER_THRESHOLD_US);
+     fprintf(stdout, "      --self-test, -S                           : Check the decoder.\n");
+     fprintf(stdout, "\n");
+}
+
+int main(int argc, char **argv)
+{
+     uint8_t buffer[CPS_RESPONSE_MAX_LENGTH + 1];
+     size_t length = 0;
+     telemetry_t telemetry;
+     profilerDump_t dump;
+     bool profiler = false;
+     bool clear = false;
+     double thresholdUs = PROFILER_THRESHOLD_US;
+     const char *device = NULL;
+     const char *inputFile = NULL;
+     const char *outputFile = NULL;
+     int  c = '?';
+     int  option_index = 0;
+
+     fprintf(stdout, "telemetry_decoder v%u.%u.%u (c) 2024 Roger Clark, VK3KYY / G4KYF, Daniel Caujolle-Bert, F1RMB.\n", VERSION_MAJOR, VERSION_MINOR, VERSION_REV);
+
+     opterr = 0;
+     while((c = getopt_long(argc, argv, short_options, long_options, &option_index)) != EOF)
+     {
+	  switch (c)
+	  {
+	  case 'd':
+	       device = optarg;
+	       break;
+
+	  case 'f':
+	       inputFile = optarg;
+	       break;
+
+	  case 'o':
+	       outputFile = optarg;
+	       break;
+
+	  case 'p':
+	       profiler = true;
+	       break;
+
+	  case 'c':
+	       clear = true;
+	       break;
+
+	  case 't':
+	       thresholdUs = atof(optarg);
+	       break;
+
+	  case 'S':
+	       return (selfTest() ? EXIT_SUCCESS : EXIT_FAILURE);
+
+	  case 'h':
+	  default:
+	       displayHelp();
+	       return EXIT_SUCCESS;
+	  }
+     }
+
+     if (inputFile != NULL)
+     {
+	  if (readFromFile(inputFile, buffer, &length) == false)
+	  {
+	       return EXIT_FAILURE;
+	  }
+     }
+     else if (device != NULL)
+     {
+#if defined(_WIN32)
+	  fprintf(stderr, "Reading from the radio isn't supported on this platform, please use a dump file.\n");
+	  return EXIT_FAILURE;
+#else
+	  if (readFromRadio(device, (profiler ? CPS_ACCESS_LATENCY_PROFILER : CPS_ACCESS_TASKS_TELEMETRY), ((profiler && clear) ? 1 : 0), buffer, &length) == false)
+	  {
+	       return EXIT_FAILURE;
+	  }
+
+	  if ((outputFile != NULL) && (writeToFile(outputFile, buffer, length) == false))
+	  {
+	       return EXIT_FAILURE;
+	  }
+#endif
+     }
+     else
+     {
+	  displayHelp();
+	  return EXIT_FAILURE;
+     }
+
+     if (profiler)
+     {
+	  if (decodeProfilerDump(buffer, length, &dump) == false)
+	  {
+	       return EXIT_FAILURE;
+	  }
+
+	  printProfilerDump(&dump, thresholdUs);
+     }
+     else
+     {
+	  if (decodeTelemetry(buffer, length, &telemetry) == false)
+	  {
+	       return EXIT_FAILURE;
+	  }
+
+	  printTelemetry(&telemetry);
+     }
+
+     return EXIT_SUCCESS;
+}